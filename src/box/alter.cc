@@ -187,6 +187,11 @@ index_opts_decode(struct index_opts *opts, const char *map,
 			  BOX_INDEX_FIELD_OPTS, "distance must be either "\
 			  "'euclid' or 'manhattan'");
 	}
+	if (opts->layout == hash_index_layout_MAX) {
+		tnt_raise(ClientError, ER_WRONG_INDEX_OPTIONS,
+			  BOX_INDEX_FIELD_OPTS, "layout must be either "\
+			  "'chained' or 'open'");
+	}
 	if (opts->page_size <= 0 || (opts->range_size > 0 &&
 				     opts->page_size > opts->range_size)) {
 		tnt_raise(ClientError, ER_WRONG_INDEX_OPTIONS,
@@ -262,11 +267,18 @@ index_def_new_from_tuple(struct tuple *tuple, struct space *space)
 		if (key_def != NULL)
 			key_def_delete(key_def);
 	});
+	/*
+	 * Parts of a functional index refer to the key returned
+	 * by the index function so the space format doesn't
+	 * apply to them.
+	 */
+	bool for_func_index = opts.func_id > 0;
 	if (key_def_decode_parts(part_def, part_count, &parts,
-				 space->def->fields,
-				 space->def->field_count, &fiber()->gc) != 0)
+				 for_func_index ? NULL : space->def->fields,
+				 for_func_index ? 0 : space->def->field_count,
+				 &fiber()->gc) != 0)
 		diag_raise();
-	key_def = key_def_new(part_def, part_count);
+	key_def = key_def_new(part_def, part_count, for_func_index);
 	if (key_def == NULL)
 		diag_raise();
 	struct index_def *index_def =
@@ -295,6 +307,11 @@ space_opts_decode(struct space_opts *opts, const char *map,
 	if (opts_decode(opts, space_opts_reg, &map, ER_WRONG_SPACE_OPTIONS,
 			BOX_SPACE_FIELD_OPTS, region) != 0)
 		diag_raise();
+	if (opts->compression == space_compression_MAX) {
+		tnt_raise(ClientError, ER_WRONG_SPACE_OPTIONS,
+			  BOX_SPACE_FIELD_OPTS, "compression must be either "\
+			  "'none' or 'zstd'");
+	}
 	if (opts->sql != NULL) {
 		char *sql = strdup(opts->sql);
 		if (sql == NULL) {
@@ -1813,6 +1830,14 @@ on_replace_dd_space(struct trigger * /* trigger */, void *event)
 			tnt_raise(ClientError, ER_ALTER_SPACE,
 				  space_name(old_space),
 				  "replication group is immutable");
+		if (def->opts.compression != old_space->def->opts.compression) {
+			struct index *pk = space_index(old_space, 0);
+			if (pk != NULL && index_size(pk) > 0)
+				tnt_raise(ClientError, ER_ALTER_SPACE,
+					  space_name(old_space),
+					  "can not change compression of "
+					  "a non-empty space");
+		}
 		if (def->opts.is_view != old_space->def->opts.is_view)
 			tnt_raise(ClientError, ER_ALTER_SPACE,
 				  space_name(old_space),
@@ -2421,13 +2446,34 @@ func_def_new_from_tuple(const struct tuple *tuple)
 			  tt_cstr(name, BOX_INVALID_NAME_MAX),
 			  "function name is too long");
 	identifier_check_xc(name, len);
-	struct func_def *def = (struct func_def *) malloc(func_def_sizeof(len));
+	uint32_t body_len = 0;
+	const char *body = NULL;
+	if (tuple_field_count(tuple) > BOX_FUNC_FIELD_BODY) {
+		body = tuple_field_str_xc(tuple, BOX_FUNC_FIELD_BODY,
+					  &body_len);
+	}
+	size_t def_size = func_def_sizeof(len, body_len);
+	struct func_def *def = (struct func_def *) malloc(def_size);
 	if (def == NULL)
-		tnt_raise(OutOfMemory, func_def_sizeof(len), "malloc", "def");
+		tnt_raise(OutOfMemory, def_size, "malloc", "def");
 	auto def_guard = make_scoped_guard([=] { free(def); });
 	func_def_get_ids_from_tuple(tuple, &def->fid, &def->uid);
 	memcpy(def->name, name, len);
 	def->name[len] = 0;
+	if (body_len > 0) {
+		def->body = def->name + len + 1;
+		memcpy(def->body, body, body_len);
+		def->body[body_len] = 0;
+	} else {
+		def->body = NULL;
+	}
+	if (tuple_field_count(tuple) > BOX_FUNC_FIELD_IS_DETERMINISTIC) {
+		def->is_deterministic =
+			tuple_field_bool_xc(tuple,
+					    BOX_FUNC_FIELD_IS_DETERMINISTIC);
+	} else {
+		def->is_deterministic = false;
+	}
 	if (tuple_field_count(tuple) > BOX_FUNC_FIELD_SETUID)
 		def->setuid = tuple_field_u32_xc(tuple, BOX_FUNC_FIELD_SETUID);
 	else
@@ -2444,10 +2490,36 @@ func_def_new_from_tuple(const struct tuple *tuple)
 		/* Lua is the default. */
 		def->language = FUNC_LANGUAGE_LUA;
 	}
+	if (def->body != NULL && def->language != FUNC_LANGUAGE_LUA) {
+		tnt_raise(ClientError, ER_CREATE_FUNCTION, def->name,
+			  "only Lua functions can have a body");
+	}
 	def_guard.is_active = false;
 	return def;
 }
 
+/**
+ * A space_foreach() callback that checks if a space has
+ * a functional index using the given function.
+ */
+static int
+space_has_func_index(struct space *space, void *arg)
+{
+	uint32_t fid = *(uint32_t *) arg;
+	for (uint32_t i = 0; i < space->index_count; i++) {
+		if (space->index[i]->def->opts.func_id == fid)
+			return 1;
+	}
+	return 0;
+}
+
+/** Check if a function is used by a functional index. */
+static bool
+func_is_used_by_index(uint32_t fid)
+{
+	return space_foreach(space_has_func_index, &fid) != 0;
+}
+
 /** Remove a function from function cache */
 static void
 func_cache_remove_func(struct trigger * /* trigger */, void *event)
@@ -2511,6 +2583,11 @@ on_replace_dd_func(struct trigger * /* trigger */, void *event)
 				  (unsigned) old_func->def->uid,
 				  "function has grants");
 		}
+		if (func_is_used_by_index(fid)) {
+			tnt_raise(ClientError, ER_DROP_FUNCTION,
+				  (unsigned) fid,
+				  "function is used by a functional index");
+		}
 		struct trigger *on_commit =
 			txn_alter_trigger_new(func_cache_remove_func, NULL);
 		txn_on_commit(txn, on_commit);
@@ -2519,6 +2596,21 @@ on_replace_dd_func(struct trigger * /* trigger */, void *event)
 		auto def_guard = make_scoped_guard([=] { free(def); });
 		access_check_ddl(def->name, def->fid, def->uid, SC_FUNCTION,
 				 PRIV_A);
+		/*
+		 * Keys of functional indexes are computed by the
+		 * function so it can't be changed while it is in
+		 * use.
+		 */
+		const struct func_def *old_def = old_func->def;
+		if ((def->language != old_def->language ||
+		     def->is_deterministic != old_def->is_deterministic ||
+		     (def->body == NULL) != (old_def->body == NULL) ||
+		     (def->body != NULL &&
+		      strcmp(def->body, old_def->body) != 0)) &&
+		    func_is_used_by_index(fid)) {
+			tnt_raise(ClientError, ER_CREATE_FUNCTION, def->name,
+				  "function is used by a functional index");
+		}
 		struct trigger *on_commit =
 			txn_alter_trigger_new(func_cache_replace_func, NULL);
 		txn_on_commit(txn, on_commit);
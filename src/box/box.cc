@@ -477,6 +477,35 @@ box_check_wal_mode(const char *mode_name)
 	return (enum wal_mode) mode;
 }
 
+static void
+box_check_memtx_arena_opts(struct tuple_arena_opts *opts)
+{
+	const char *pages = cfg_gets("memtx_huge_pages");
+	assert(pages != NULL); /* checked in Lua */
+	int type = strindex(tuple_arena_pages_strs, pages,
+			    tuple_arena_pages_MAX);
+	if (type == tuple_arena_pages_MAX)
+		tnt_raise(ClientError, ER_CFG, "memtx_huge_pages", pages);
+	opts->pages = (enum tuple_arena_pages) type;
+
+	const char *policy = cfg_gets("memtx_numa_policy");
+	assert(policy != NULL); /* checked in Lua */
+	type = strindex(tuple_arena_numa_policy_strs, policy,
+			tuple_arena_numa_policy_MAX);
+	if (type == tuple_arena_numa_policy_MAX)
+		tnt_raise(ClientError, ER_CFG, "memtx_numa_policy", policy);
+	opts->numa_policy = (enum tuple_arena_numa_policy) type;
+
+	const char *nodes = cfg_gets("memtx_numa_nodes");
+	opts->numa_nodes = 0;
+	if (nodes != NULL &&
+	    tuple_arena_parse_numa_nodes(nodes, &opts->numa_nodes) != 0) {
+		tnt_raise(ClientError, ER_CFG, "memtx_numa_nodes",
+			  tt_sprintf("expected a list of nodes less than %d, "
+				     "like '0-1,3'", TUPLE_ARENA_NUMA_NODE_MAX));
+	}
+}
+
 static void
 box_check_readahead(int readahead)
 {
@@ -488,6 +517,48 @@ box_check_readahead(int readahead)
 	}
 }
 
+static int
+box_check_net_read_threads(int threads)
+{
+	if (threads < 0 || threads > IPROTO_READ_THREADS_MAX) {
+		tnt_raise(ClientError, ER_CFG, "net_read_threads",
+			  tt_sprintf("the value must be between 0 and %d",
+				     IPROTO_READ_THREADS_MAX));
+	}
+	return threads;
+}
+
+static double
+box_check_net_read_view_period(double period)
+{
+	if (period <= 0) {
+		tnt_raise(ClientError, ER_CFG, "net_read_view_period",
+			  "the value must be greater than 0");
+	}
+	return period;
+}
+
+static int
+box_check_memtx_snap_threads(int threads)
+{
+	if (threads < 1 || threads > MEMTX_SNAP_THREADS_MAX) {
+		tnt_raise(ClientError, ER_CFG, "memtx_snap_threads",
+			  tt_sprintf("the value must be between 1 and %d",
+				     MEMTX_SNAP_THREADS_MAX));
+	}
+	return threads;
+}
+
+static double
+box_check_memtx_defrag_threshold(double threshold)
+{
+	if (threshold < 0 || threshold > 1) {
+		tnt_raise(ClientError, ER_CFG, "memtx_defrag_threshold",
+			  "the value must be between 0 and 1");
+	}
+	return threshold;
+}
+
 static void
 box_check_checkpoint_count(int checkpoint_count)
 {
@@ -594,12 +665,18 @@ box_check_config()
 	box_check_replication_sync_lag();
 	box_check_replication_sync_timeout();
 	box_check_readahead(cfg_geti("readahead"));
+	box_check_net_read_threads(cfg_geti("net_read_threads"));
+	box_check_net_read_view_period(cfg_getd("net_read_view_period"));
 	box_check_checkpoint_count(cfg_geti("checkpoint_count"));
 	box_check_wal_max_rows(cfg_geti64("rows_per_wal"));
 	box_check_wal_max_size(cfg_geti64("wal_max_size"));
 	box_check_wal_mode(cfg_gets("wal_mode"));
 	box_check_memtx_memory(cfg_geti64("memtx_memory"));
+	struct tuple_arena_opts arena_opts;
+	box_check_memtx_arena_opts(&arena_opts);
 	box_check_memtx_min_tuple_size(cfg_geti64("memtx_min_tuple_size"));
+	box_check_memtx_snap_threads(cfg_geti("memtx_snap_threads"));
+	box_check_memtx_defrag_threshold(cfg_getd("memtx_defrag_threshold"));
 	box_check_vinyl_options();
 }
 
@@ -785,6 +862,27 @@ box_set_memtx_max_tuple_size(void)
 			cfg_geti("memtx_max_tuple_size"));
 }
 
+void
+box_set_memtx_defrag_threshold(void)
+{
+	struct memtx_engine *memtx;
+	memtx = (struct memtx_engine *)engine_by_name("memtx");
+	assert(memtx != NULL);
+	memtx_engine_set_defrag_threshold(memtx,
+		box_check_memtx_defrag_threshold(
+			cfg_getd("memtx_defrag_threshold")));
+}
+
+void
+box_set_memtx_snap_threads(void)
+{
+	struct memtx_engine *memtx;
+	memtx = (struct memtx_engine *)engine_by_name("memtx");
+	assert(memtx != NULL);
+	memtx_engine_set_snap_threads(memtx,
+		box_check_memtx_snap_threads(cfg_geti("memtx_snap_threads")));
+}
+
 void
 box_set_too_long_threshold(void)
 {
@@ -855,6 +953,15 @@ box_set_vinyl_cache(void)
 	vinyl_engine_set_cache(vinyl, cfg_geti64("vinyl_cache"));
 }
 
+void
+box_set_vinyl_page_cache(void)
+{
+	struct vinyl_engine *vinyl;
+	vinyl = (struct vinyl_engine *)engine_by_name("vinyl");
+	assert(vinyl != NULL);
+	vinyl_engine_set_page_cache(vinyl, cfg_geti64("vinyl_page_cache"));
+}
+
 void
 box_set_vinyl_timeout(void)
 {
@@ -874,6 +981,13 @@ box_set_net_msg_max(void)
 				IPROTO_FIBER_POOL_SIZE_FACTOR);
 }
 
+void
+box_set_net_read_view_period(void)
+{
+	double period = cfg_getd("net_read_view_period");
+	iproto_set_read_view_period(box_check_net_read_view_period(period));
+}
+
 /* }}} configuration bindings */
 
 /**
@@ -1130,6 +1244,26 @@ box_delete(uint32_t space_id, uint32_t index_id, const char *key,
 	return box_process1(&request, result);
 }
 
+int
+box_delete_range(uint32_t space_id, uint32_t index_id,
+		 const char *begin, const char *begin_end,
+		 const char *end, const char *end_end)
+{
+	mp_tuple_assert(begin, begin_end);
+	mp_tuple_assert(end, end_end);
+	struct request request;
+	memset(&request, 0, sizeof(request));
+	request.type = IPROTO_DELETE_RANGE;
+	request.space_id = space_id;
+	request.index_id = index_id;
+	request.key = begin;
+	request.key_end = begin_end;
+	/** The end of the range is passed in request tuple. */
+	request.tuple = end;
+	request.tuple_end = end_end;
+	return box_process1(&request, NULL);
+}
+
 int
 box_update(uint32_t space_id, uint32_t index_id, const char *key,
 	   const char *key_end, const char *ops, const char *ops_end,
@@ -1673,13 +1807,17 @@ engine_init()
 	 * so it must be registered first.
 	 */
 	struct memtx_engine *memtx;
+	struct tuple_arena_opts arena_opts;
+	box_check_memtx_arena_opts(&arena_opts);
 	memtx = memtx_engine_new_xc(cfg_gets("memtx_dir"),
 				    cfg_geti("force_recovery"),
-				    cfg_getd("memtx_memory"),
+				    cfg_getd("memtx_memory"), &arena_opts,
 				    cfg_geti("memtx_min_tuple_size"),
 				    cfg_getd("slab_alloc_factor"));
 	engine_register((struct engine *)memtx);
 	box_set_memtx_max_tuple_size();
+	box_set_memtx_snap_threads();
+	box_set_memtx_defrag_threshold();
 
 	struct sysview_engine *sysview = sysview_engine_new_xc();
 	engine_register((struct engine *)sysview);
@@ -1693,9 +1831,12 @@ engine_init()
 				    cfg_geti("vinyl_read_threads"),
 				    cfg_geti("vinyl_write_threads"),
 				    cfg_geti("force_recovery"));
+	vinyl_engine_set_io_uring(vinyl, cfg_getb("vinyl_io_uring"),
+				  cfg_getb("vinyl_io_uring_direct"));
 	engine_register((struct engine *)vinyl);
 	box_set_vinyl_max_tuple_size();
 	box_set_vinyl_cache();
+	box_set_vinyl_page_cache();
 	box_set_vinyl_timeout();
 }
 
@@ -2087,6 +2228,9 @@ box_cfg_xc(void)
 
 	box_set_net_msg_max();
 	box_set_readahead();
+	box_set_net_read_view_period();
+	iproto_start_readers(
+		box_check_net_read_threads(cfg_geti("net_read_threads")));
 	box_set_too_long_threshold();
 	box_set_replication_timeout();
 	box_set_replication_connect_timeout();
@@ -201,9 +201,12 @@ void box_set_checkpoint_interval(void);
 void box_set_checkpoint_wal_threshold(void);
 void box_set_memtx_memory(void);
 void box_set_memtx_max_tuple_size(void);
+void box_set_memtx_snap_threads(void);
+void box_set_memtx_defrag_threshold(void);
 void box_set_vinyl_memory(void);
 void box_set_vinyl_max_tuple_size(void);
 void box_set_vinyl_cache(void);
+void box_set_vinyl_page_cache(void);
 void box_set_vinyl_timeout(void);
 void box_set_replication_timeout(void);
 void box_set_replication_connect_timeout(void);
@@ -212,6 +215,7 @@ void box_set_replication_sync_lag(void);
 void box_set_replication_sync_timeout(void);
 void box_set_replication_skip_conflict(void);
 void box_set_net_msg_max(void);
+void box_set_net_read_view_period(void);
 
 extern "C" {
 #endif /* defined(__cplusplus) */
@@ -319,6 +323,35 @@ API_EXPORT int
 box_delete(uint32_t space_id, uint32_t index_id, const char *key,
 	   const char *key_end, box_tuple_t **result);
 
+/**
+ * Execute a DELETE_RANGE request: delete all tuples whose keys
+ * are greater than or equal to \a begin and less than \a end.
+ * Both keys may be partial. An empty \a end means that the
+ * range is not bounded from above.
+ *
+ * The range is deleted with a single statement only if the
+ * primary key is the only index of the space. Otherwise the
+ * keys are looked up and deleted one by one in every index,
+ * which takes as many writes as deleting them with DELETE.
+ * Spaces with on_replace or before_replace triggers don't
+ * support the request.
+ *
+ * \param space_id space identifier
+ * \param index_id index identifier, must be 0 (primary key)
+ * \param begin encoded key in MsgPack Array format ([part1, part2, ...]).
+ * \param begin_end the end of encoded \a begin.
+ * \param end encoded key in MsgPack Array format ([part1, part2, ...]).
+ * \param end_end the end of encoded \a end.
+ * \retval -1 on error (check box_error_last())
+ * \retval 0 on success
+ * \sa \code box.space[space_id].index[index_id]:delete_range(begin, end)
+ * \endcode
+ */
+API_EXPORT int
+box_delete_range(uint32_t space_id, uint32_t index_id,
+		 const char *begin, const char *begin_end,
+		 const char *end, const char *end_end);
+
 /**
  * Execute an UPDATE request.
  *
@@ -380,6 +380,7 @@ func_new(struct func_def *def)
 	func->owner_credentials.auth_token = BOX_USER_MAX; /* invalid value */
 	func->func = NULL;
 	func->module = NULL;
+	func->lua_ref = LUA_NOREF;
 	return func;
 }
 
@@ -397,6 +398,10 @@ func_unload(struct func *func)
 	}
 	func->module = NULL;
 	func->func = NULL;
+	if (func->lua_ref != LUA_NOREF) {
+		luaL_unref(tarantool_L, LUA_REGISTRYINDEX, func->lua_ref);
+		func->lua_ref = LUA_NOREF;
+	}
 }
 
 /**
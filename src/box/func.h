@@ -74,6 +74,13 @@ struct func {
 	 * dynamic library for the C callback.
 	 */
 	struct module *module;
+	/**
+	 * For persistent Lua functions, a reference to the
+	 * function object compiled from func_def::body in
+	 * the Lua registry or LUA_NOREF if the body hasn't
+	 * been compiled yet.
+	 */
+	int lua_ref;
 	/**
 	 * Authentication id of the owner of the function,
 	 * used for set-user-id functions.
@@ -59,24 +59,40 @@ struct func_def {
 	 * invocation.
 	 */
 	bool setuid;
+	/**
+	 * True if the function always returns the same result
+	 * for the same arguments and has no side effects. Only
+	 * such functions may compute keys of functional indexes.
+	 */
+	bool is_deterministic;
 	/**
 	 * The language of the stored function.
 	 */
 	enum func_language language;
+	/**
+	 * Source code of a persistent Lua function, stored after
+	 * the name, or NULL if the function is defined outside
+	 * of the database.
+	 */
+	char *body;
 	/** Function name. */
 	char name[0];
 };
 
 /**
  * @param name_len length of func_def->name
+ * @param body_len length of func_def->body or 0
  * @returns size in bytes needed to allocate for struct func_def
  * for a function of length @a a name_len.
  */
 static inline size_t
-func_def_sizeof(uint32_t name_len)
+func_def_sizeof(uint32_t name_len, uint32_t body_len)
 {
 	/* +1 for '\0' name terminating. */
-	return sizeof(struct func_def) + name_len + 1;
+	size_t size = sizeof(struct func_def) + name_len + 1;
+	if (body_len > 0)
+		size += body_len + 1;
+	return size;
 }
 
 /**
@@ -0,0 +1,137 @@
+/*
+ * Copyright 2010-2019, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include "func_key.h"
+
+#include "error.h"
+#include "fiber.h"
+#include "func.h"
+#include "index_def.h"
+#include "key_def.h"
+#include "schema.h"
+#include "tuple.h"
+#include "lua/call.h"
+#include "small/region.h"
+#include "msgpuck.h"
+
+const char *
+func_key_extract(struct key_def *key_def, uint32_t func_id,
+		 const char *index_name, struct tuple *tuple,
+		 uint32_t *key_size)
+{
+	assert(key_def->for_func_index);
+	struct func *func = func_by_id(func_id);
+	if (func == NULL) {
+		diag_set(ClientError, ER_NO_SUCH_FUNCTION, int2str(func_id));
+		return NULL;
+	}
+	if (func->def->body == NULL || !func->def->is_deterministic) {
+		diag_set(ClientError, ER_UNSUPPORTED, "Functional index",
+			 "functions that are not persistent and deterministic");
+		return NULL;
+	}
+	struct region *region = &fiber()->gc;
+	const char *data, *data_end;
+	if (box_lua_func_call(func, tuple, &data, &data_end) != 0)
+		return NULL;
+	if (mp_typeof(*data) != MP_ARRAY) {
+		diag_set(ClientError, ER_PROC_LUA,
+			 tt_sprintf("Functional index '%s': function '%s' "
+				    "must return an array", index_name,
+				    func->def->name));
+		return NULL;
+	}
+	uint32_t field_count = mp_decode_array(&data);
+	const char **fields = region_alloc(region, (field_count + 1) *
+					   sizeof(*fields));
+	if (fields == NULL) {
+		diag_set(OutOfMemory, (field_count + 1) * sizeof(*fields),
+			 "region", "fields");
+		return NULL;
+	}
+	for (uint32_t i = 0; i < field_count; i++) {
+		fields[i] = data;
+		mp_next(&data);
+	}
+	fields[field_count] = data;
+	/*
+	 * Rearrange the returned values in the order of key
+	 * parts, since a part may refer to any of them.
+	 */
+	uint32_t part_count = key_def->part_count;
+	size_t size = mp_sizeof_array(part_count);
+	for (uint32_t i = 0; i < part_count; i++) {
+		uint32_t fieldno = key_def->parts[i].fieldno;
+		size += fieldno < field_count ?
+			    fields[fieldno + 1] - fields[fieldno] :
+			    mp_sizeof_nil();
+	}
+	char *key = region_alloc(region, size);
+	if (key == NULL) {
+		diag_set(OutOfMemory, size, "region", "key");
+		return NULL;
+	}
+	char *key_end = mp_encode_array(key, part_count);
+	for (uint32_t i = 0; i < part_count; i++) {
+		uint32_t fieldno = key_def->parts[i].fieldno;
+		if (fieldno < field_count) {
+			size_t field_size = fields[fieldno + 1] -
+					    fields[fieldno];
+			memcpy(key_end, fields[fieldno], field_size);
+			key_end += field_size;
+		} else {
+			key_end = mp_encode_nil(key_end);
+		}
+	}
+	assert(key_end == key + size);
+	const char *parts = key;
+	mp_decode_array(&parts);
+	if (key_validate_parts(key_def, parts, part_count, true) != 0)
+		return NULL;
+	*key_size = key_end - key;
+	return key;
+}
+
+struct tuple *
+func_key_new(struct index_def *index_def, struct tuple_format *format,
+	     struct tuple *tuple)
+{
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	struct tuple *key_tuple = NULL;
+	uint32_t key_size;
+	const char *key = func_key_extract(index_def->key_def,
+					   index_def->opts.func_id,
+					   index_def->name, tuple, &key_size);
+	if (key != NULL)
+		key_tuple = tuple_new(format, key, key + key_size);
+	region_truncate(region, region_svp);
+	return key_tuple;
+}
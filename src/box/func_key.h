@@ -0,0 +1,90 @@
+#ifndef TARANTOOL_BOX_FUNC_KEY_H_INCLUDED
+#define TARANTOOL_BOX_FUNC_KEY_H_INCLUDED
+/*
+ * Copyright 2010-2019, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+struct index_def;
+struct key_def;
+struct tuple;
+struct tuple_format;
+
+/**
+ * Compute the key of a functional index for a tuple.
+ *
+ * The index function is called with the tuple as the only
+ * argument and must return an array. A part of the index key
+ * definition refers to an element of that array by its field
+ * number, a missing element is treated as nil. The extracted
+ * key is validated against the key definition and returned as
+ * a tuple of the given format, so that it can be referenced
+ * by index entries and iterators independently of the source
+ * tuple. The format is supposed to have no fields and defines
+ * the memory the key is allocated from.
+ *
+ * @param index_def Functional index definition.
+ * @param format Format of the key tuple.
+ * @param tuple Tuple to compute the key for.
+ * @retval not NULL Key tuple, not referenced.
+ * @retval NULL Error, diag is set.
+ */
+struct tuple *
+func_key_new(struct index_def *index_def, struct tuple_format *format,
+	     struct tuple *tuple);
+
+/**
+ * Compute the key of a functional index for a tuple, see
+ * func_key_new(), and return it as a MessagePack array
+ * allocated on the fiber region. The caller is supposed to
+ * truncate the region after use.
+ *
+ * @param key_def Functional index key definition.
+ * @param func_id Identifier of the index function.
+ * @param index_name Index name, used for error reporting.
+ * @param tuple Tuple to compute the key for.
+ * @param[out] key_size Size of the returned key.
+ * @retval not NULL Key.
+ * @retval NULL Error, diag is set.
+ */
+const char *
+func_key_extract(struct key_def *key_def, uint32_t func_id,
+		 const char *index_name, struct tuple *tuple,
+		 uint32_t *key_size);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
+
+#endif /* TARANTOOL_BOX_FUNC_KEY_H_INCLUDED */
@@ -156,6 +156,11 @@ box_tuple_extract_key(const box_tuple_t *tuple, uint32_t space_id,
 	struct index *index = index_find(space, index_id);
 	if (index == NULL)
 		return NULL;
+	if (index->def->key_def->is_multikey) {
+		diag_set(UnsupportedIndexFeature, index->def,
+			 "key extraction from a multikey index");
+		return NULL;
+	}
 	return tuple_extract_key(tuple, index->def->key_def, key_size);
 }
 
@@ -250,6 +255,65 @@ box_index_get(uint32_t space_id, uint32_t index_id, const char *key,
 	return 0;
 }
 
+int
+box_index_get_many(uint32_t space_id, uint32_t index_id, const char *keys,
+		   const char *keys_end, box_tuple_t **results)
+{
+	assert(keys != NULL && keys_end != NULL && results != NULL);
+	mp_tuple_assert(keys, keys_end);
+	struct space *space;
+	struct index *index;
+	if (check_index(space_id, index_id, &space, &index) != 0)
+		return -1;
+	if (!index->def->opts.is_unique) {
+		diag_set(ClientError, ER_MORE_THAN_ONE_TUPLE);
+		return -1;
+	}
+	uint32_t key_count = mp_decode_array(&keys);
+	if (key_count == 0)
+		return 0;
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	size_t size = key_count * sizeof(const char *);
+	const char **key_array = (const char **)region_alloc(region, size);
+	if (key_array == NULL) {
+		diag_set(OutOfMemory, size, "region_alloc", "key_array");
+		return -1;
+	}
+	uint32_t part_count = index->def->key_def->part_count;
+	for (uint32_t i = 0; i < key_count; i++) {
+		if (mp_typeof(*keys) != MP_ARRAY) {
+			diag_set(IllegalParams,
+				 "get_many: key must be an array");
+			goto fail;
+		}
+		uint32_t key_part_count = mp_decode_array(&keys);
+		if (exact_key_validate(index->def->key_def, keys,
+				       key_part_count) != 0)
+			goto fail;
+		key_array[i] = keys;
+		for (uint32_t j = 0; j < key_part_count; j++)
+			mp_next(&keys);
+	}
+	/* Start transaction in the engine. */
+	struct txn *txn;
+	if (txn_begin_ro_stmt(space, &txn) != 0)
+		goto fail;
+	if (index_get_many(index, key_array, key_count, part_count,
+			   results) != 0) {
+		txn_rollback_stmt();
+		goto fail;
+	}
+	txn_commit_ro_stmt(txn);
+	region_truncate(region, region_svp);
+	/* Count statistics. */
+	rmean_collect(rmean_box, IPROTO_SELECT, key_count);
+	return 0;
+fail:
+	region_truncate(region, region_svp);
+	return -1;
+}
+
 int
 box_index_min(uint32_t space_id, uint32_t index_id, const char *key,
 	      const char *key_end, box_tuple_t **result)
@@ -662,6 +726,25 @@ generic_index_get(struct index *index, const char *key,
 	return -1;
 }
 
+int
+generic_index_get_many(struct index *index, const char **keys,
+		       uint32_t key_count, uint32_t part_count,
+		       struct tuple **results)
+{
+	for (uint32_t i = 0; i < key_count; i++) {
+		if (index_get(index, keys[i], part_count, &results[i]) != 0) {
+			for (uint32_t j = 0; j < i; j++) {
+				if (results[j] != NULL)
+					tuple_unref(results[j]);
+			}
+			return -1;
+		}
+		if (results[i] != NULL)
+			tuple_ref(results[i]);
+	}
+	return 0;
+}
+
 int
 generic_index_replace(struct index *index, struct tuple *old_tuple,
 		      struct tuple *new_tuple, enum dup_replace_mode mode,
@@ -211,6 +211,25 @@ box_tuple_extract_key(const box_tuple_t *tuple, uint32_t space_id,
 
 /** \endcond public */
 
+/**
+ * Get tuples from a unique index by several keys at once.
+ *
+ * \param space_id space identifier
+ * \param index_id index identifier
+ * \param keys encoded MsgPack Array of keys, each in MsgPack
+ *        Array format ([[part1, part2, ...], ...]).
+ * \param keys_end the end of encoded \a keys
+ * \param[out] results array of the size of \a keys, filled with
+ *        found tuples or NULL. Found tuples are referenced and
+ *        must be unreferenced by the caller.
+ * \retval -1 on error (check box_error_last())
+ * \retval 0 on success
+ * \sa \code box.space[space_id].index[index_id]:get_many(keys) \endcode
+ */
+int
+box_index_get_many(uint32_t space_id, uint32_t index_id, const char *keys,
+		   const char *keys_end, box_tuple_t **results);
+
 /**
  * Index statistics (index:stat())
  *
@@ -411,6 +430,16 @@ struct index_vtab {
 			 const char *key, uint32_t part_count);
 	int (*get)(struct index *index, const char *key,
 		   uint32_t part_count, struct tuple **result);
+	/**
+	 * Look up several full keys at once. Each key has
+	 * @part_count parts, with the array header already
+	 * decoded. Found tuples are stored in @results at the
+	 * position of their key and referenced, NULL is stored
+	 * for keys that were not found.
+	 */
+	int (*get_many)(struct index *index, const char **keys,
+			uint32_t key_count, uint32_t part_count,
+			struct tuple **results);
 	int (*replace)(struct index *index, struct tuple *old_tuple,
 		       struct tuple *new_tuple, enum dup_replace_mode mode,
 		       struct tuple **result);
@@ -595,6 +624,14 @@ index_get(struct index *index, const char *key,
 	return index->vtab->get(index, key, part_count, result);
 }
 
+static inline int
+index_get_many(struct index *index, const char **keys, uint32_t key_count,
+	       uint32_t part_count, struct tuple **results)
+{
+	return index->vtab->get_many(index, keys, key_count, part_count,
+				     results);
+}
+
 static inline int
 index_replace(struct index *index, struct tuple *old_tuple,
 	      struct tuple *new_tuple, enum dup_replace_mode mode,
@@ -677,6 +714,8 @@ int generic_index_random(struct index *, uint32_t, struct tuple **);
 ssize_t generic_index_count(struct index *, enum iterator_type,
 			    const char *, uint32_t);
 int generic_index_get(struct index *, const char *, uint32_t, struct tuple **);
+int generic_index_get_many(struct index *, const char **, uint32_t, uint32_t,
+			   struct tuple **);
 int generic_index_replace(struct index *, struct tuple *, struct tuple *,
 			  enum dup_replace_mode, struct tuple **);
 struct snapshot_iterator *generic_index_create_snapshot_iterator(struct index *);
@@ -38,16 +38,20 @@ const char *index_type_strs[] = { "HASH", "TREE", "BITSET", "RTREE" };
 
 const char *rtree_index_distance_type_strs[] = { "EUCLID", "MANHATTAN" };
 
+const char *hash_index_layout_strs[] = { "CHAINED", "OPEN" };
+
 const struct index_opts index_opts_default = {
 	/* .unique              = */ true,
 	/* .dimension           = */ 2,
 	/* .distance            = */ RTREE_INDEX_DISTANCE_TYPE_EUCLID,
+	/* .layout              = */ HASH_INDEX_LAYOUT_CHAINED,
 	/* .range_size          = */ 0,
 	/* .page_size           = */ 8192,
 	/* .run_count_per_level = */ 2,
 	/* .run_size_ratio      = */ 3.5,
 	/* .bloom_fpr           = */ 0.05,
 	/* .lsn                 = */ 0,
+	/* .func_id             = */ 0,
 	/* .stat                = */ NULL,
 };
 
@@ -56,12 +60,15 @@ const struct opt_def index_opts_reg[] = {
 	OPT_DEF("dimension", OPT_INT64, struct index_opts, dimension),
 	OPT_DEF_ENUM("distance", rtree_index_distance_type, struct index_opts,
 		     distance, NULL),
+	OPT_DEF_ENUM("layout", hash_index_layout, struct index_opts,
+		     layout, NULL),
 	OPT_DEF("range_size", OPT_INT64, struct index_opts, range_size),
 	OPT_DEF("page_size", OPT_INT64, struct index_opts, page_size),
 	OPT_DEF("run_count_per_level", OPT_INT64, struct index_opts, run_count_per_level),
 	OPT_DEF("run_size_ratio", OPT_FLOAT, struct index_opts, run_size_ratio),
 	OPT_DEF("bloom_fpr", OPT_FLOAT, struct index_opts, bloom_fpr),
 	OPT_DEF("lsn", OPT_INT64, struct index_opts, lsn),
+	OPT_DEF("func", OPT_UINT32, struct index_opts, func_id),
 	OPT_END,
 };
 
@@ -244,6 +251,28 @@ index_def_cmp(const struct index_def *key1, const struct index_def *key2)
 			    key2->key_def->parts, key2->key_def->part_count);
 }
 
+/**
+ * Check that a key part with [*] in its path refers to the same
+ * array as the other multikey parts of the key definition.
+ */
+static bool
+index_def_part_is_valid_multikey(const struct key_def *key_def,
+				 const struct key_part *part)
+{
+	if (part->path == NULL)
+		return true;
+	uint32_t multikey_path_len =
+		json_path_multikey_offset(part->path, part->path_len,
+					  TUPLE_INDEX_BASE);
+	if (multikey_path_len == part->path_len)
+		return true;
+	return part->fieldno == key_def->multikey_fieldno &&
+	       json_path_cmp(part->path, multikey_path_len,
+			     key_def->multikey_path,
+			     key_def->multikey_path_len,
+			     TUPLE_INDEX_BASE) == 0;
+}
+
 bool
 index_def_is_valid(struct index_def *index_def, const char *space_name)
 
@@ -263,6 +292,24 @@ index_def_is_valid(struct index_def *index_def, const char *space_name)
 			 space_name, "part count must be positive");
 		return false;
 	}
+	if (index_def->iid == 0 && index_def->key_def->is_multikey) {
+		diag_set(ClientError, ER_MODIFY_INDEX, index_def->name,
+			 space_name, "primary key cannot be multikey");
+		return false;
+	}
+	if (index_def->key_def->for_func_index) {
+		if (index_def->iid == 0) {
+			diag_set(ClientError, ER_MODIFY_INDEX, index_def->name,
+				 space_name, "primary key cannot be functional");
+			return false;
+		}
+		if (index_def->key_def->has_json_paths) {
+			diag_set(ClientError, ER_MODIFY_INDEX, index_def->name,
+				 space_name, "functional index parts cannot "
+				 "have JSON paths");
+			return false;
+		}
+	}
 	if (index_def->key_def->part_count > BOX_INDEX_PART_MAX) {
 		diag_set(ClientError, ER_MODIFY_INDEX, index_def->name,
 			 space_name, "too many key parts");
@@ -275,6 +322,14 @@ index_def_is_valid(struct index_def *index_def, const char *space_name)
 				 space_name, "field no is too big");
 			return false;
 		}
+		struct key_def *key_def = index_def->key_def;
+		if (!index_def_part_is_valid_multikey(key_def,
+						      &key_def->parts[i])) {
+			diag_set(ClientError, ER_MODIFY_INDEX, index_def->name,
+				 space_name, "all multikey parts must refer "
+				 "to the same array");
+			return false;
+		}
 		for (uint32_t j = 0; j < i; j++) {
 			/*
 			 * Courtesy to a user who could have made
@@ -58,6 +58,15 @@ enum rtree_index_distance_type {
 };
 extern const char *rtree_index_distance_type_strs[];
 
+enum hash_index_layout {
+	/* Chained hash table, see salad/light.h */
+	HASH_INDEX_LAYOUT_CHAINED,
+	/* Open addressing hash table, see salad/light_swiss.h */
+	HASH_INDEX_LAYOUT_OPEN,
+	hash_index_layout_MAX
+};
+extern const char *hash_index_layout_strs[];
+
 /** Simple alias to represent logarithm metrics. */
 typedef int16_t log_est_t;
 
@@ -135,6 +144,10 @@ struct index_opts {
 	 * RTREE distance type.
 	 */
 	enum rtree_index_distance_type distance;
+	/**
+	 * Memtx HASH table layout.
+	 */
+	enum hash_index_layout layout;
 	/**
 	 * Vinyl index options.
 	 */
@@ -157,6 +170,11 @@ struct index_opts {
 	 * LSN from the time of index creation.
 	 */
 	int64_t lsn;
+	/**
+	 * Identifier of the function computing keys of a
+	 * functional index or 0 if the index isn't functional.
+	 */
+	uint32_t func_id;
 	/**
 	 * SQL specific statistics concerning tuples
 	 * distribution for query planer. It is automatically
@@ -196,6 +214,8 @@ index_opts_cmp(const struct index_opts *o1, const struct index_opts *o2)
 		return o1->dimension < o2->dimension ? -1 : 1;
 	if (o1->distance != o2->distance)
 		return o1->distance < o2->distance ? -1 : 1;
+	if (o1->layout != o2->layout)
+		return o1->layout < o2->layout ? -1 : 1;
 	if (o1->range_size != o2->range_size)
 		return o1->range_size < o2->range_size ? -1 : 1;
 	if (o1->page_size != o2->page_size)
@@ -207,6 +227,8 @@ index_opts_cmp(const struct index_opts *o1, const struct index_opts *o2)
 		return o1->run_size_ratio < o2->run_size_ratio ? -1 : 1;
 	if (o1->bloom_fpr != o2->bloom_fpr)
 		return o1->bloom_fpr < o2->bloom_fpr ? -1 : 1;
+	if (o1->func_id != o2->func_id)
+		return o1->func_id < o2->func_id ? -1 : 1;
 	return 0;
 }
 
@@ -40,6 +40,7 @@
 
 #include "version.h"
 #include "fiber.h"
+#include "fiber_cond.h"
 #include "cbus.h"
 #include "say.h"
 #include "sio.h"
@@ -48,6 +49,7 @@
 #include "scoped_guard.h"
 #include "memory.h"
 #include "random.h"
+#include "salad/stailq.h"
 
 #include "port.h"
 #include "box.h"
@@ -61,6 +63,8 @@
 #include "rmean.h"
 #include "execute.h"
 #include "errinj.h"
+#include "select_view.h"
+#include "user_def.h"
 
 enum {
 	IPROTO_SALT_SIZE = 32,
@@ -107,6 +111,20 @@ struct iproto_kharon {
 	struct iproto_wpos wpos;
 };
 
+/**
+ * A reply to a SELECT request produced by a reader thread.
+ * It's written to the socket by the iproto thread bypassing
+ * the connection output buffers, which belong to tx.
+ */
+struct iproto_read_reply {
+	/** Link in iproto_connection::read_replies. */
+	struct stailq_entry in_read_replies;
+	/** Size of the reply. */
+	size_t size;
+	/** Encoded reply, header and body. */
+	char data[0];
+};
+
 /**
  * Network readahead. A signed integer to avoid
  * automatic type coercion to an unsigned type.
@@ -213,6 +231,16 @@ struct iproto_msg
 	 * and the connection must be closed.
 	 */
 	bool close_connection;
+	/**
+	 * Credentials of the session user, used by a reader
+	 * thread to check access, see iproto_msg_reader().
+	 */
+	struct credentials credentials;
+	/**
+	 * Reply to a SELECT request produced by a reader thread
+	 * or NULL if the request must be executed in tx.
+	 */
+	struct iproto_read_reply *read_reply;
 };
 
 static struct mempool iproto_msg_pool;
@@ -230,6 +258,13 @@ static void
 iproto_msg_decode(struct iproto_msg *msg, const char **pos, const char *reqend,
 		  bool *stop_input);
 
+/**
+ * Send a request to a reader thread. Returns false if the
+ * request must be executed in the tx thread.
+ */
+static bool
+iproto_msg_send_to_reader(struct iproto_msg *msg);
+
 static inline void
 iproto_msg_delete(struct iproto_msg *msg)
 {
@@ -402,6 +437,28 @@ struct iproto_connection
 	 * connections.
 	 */
 	int long_poll_count;
+	/**
+	 * Number of requests of this connection sent to the tx
+	 * thread and not yet completed. While it's non-zero,
+	 * SELECT requests aren't sent to reader threads, because
+	 * tx may be changing the session state they depend on,
+	 * e.g. credentials.
+	 */
+	int tx_msg_count;
+	/**
+	 * Replies produced by reader threads and waiting to be
+	 * written to the socket, see iproto_flush_reads().
+	 */
+	struct stailq read_replies;
+	/** How much of the first reply in read_replies is written. */
+	size_t read_reply_offset;
+	/**
+	 * True if the last iproto_flush() didn't write all
+	 * the data available in the output buffer. Replies of
+	 * reader threads aren't written then so as not to
+	 * interleave them with a partially written tx reply.
+	 */
+	bool is_flush_partial;
 	struct ev_io input;
 	struct ev_io output;
 	/** Logical session. */
@@ -768,7 +825,10 @@ err_msgpack:
 		 * This can't throw, but should not be
 		 * done in case of exception.
 		 */
-		cpipe_push_input(&tx_pipe, &msg->base);
+		if (!iproto_msg_send_to_reader(msg)) {
+			con->tx_msg_count++;
+			cpipe_push_input(&tx_pipe, &msg->base);
+		}
 		n_requests++;
 		/* Request is parsed */
 		assert(reqend > reqstart);
@@ -974,6 +1034,76 @@ iproto_flush(struct iproto_connection *con)
 	return -1;
 }
 
+/**
+ * Write replies produced by reader threads to the socket.
+ * Return values are the same as of iproto_flush().
+ */
+static int
+iproto_flush_reads(struct iproto_connection *con)
+{
+	if (stailq_empty(&con->read_replies)) {
+		/* Nothing to do. */
+		return 1;
+	}
+	struct iovec iov[SMALL_OBUF_IOV_MAX];
+	int iovcnt = 0;
+	size_t offset = con->read_reply_offset;
+	struct iproto_read_reply *reply;
+	stailq_foreach_entry(reply, &con->read_replies, in_read_replies) {
+		iov[iovcnt].iov_base = reply->data + offset;
+		iov[iovcnt].iov_len = reply->size - offset;
+		offset = 0;
+		if (++iovcnt == lengthof(iov))
+			break;
+	}
+	ssize_t nwr = sio_writev(con->output.fd, iov, iovcnt);
+	if (nwr < 0) {
+		if (! sio_wouldblock(errno))
+			diag_raise();
+		return -1;
+	}
+	/* Count statistics */
+	rmean_collect(rmean_net, IPROTO_SENT, nwr);
+	size_t written = nwr;
+	while (!stailq_empty(&con->read_replies)) {
+		reply = stailq_first_entry(&con->read_replies,
+					   struct iproto_read_reply,
+					   in_read_replies);
+		size_t left = reply->size - con->read_reply_offset;
+		if (written < left) {
+			con->read_reply_offset += written;
+			return -1;
+		}
+		written -= left;
+		con->read_reply_offset = 0;
+		stailq_shift(&con->read_replies);
+		free(reply);
+	}
+	return 0;
+}
+
+/**
+ * Write both replies produced by tx and by reader threads.
+ * A reply is never interleaved with another one.
+ */
+static int
+iproto_connection_flush(struct iproto_connection *con)
+{
+	int rc;
+	if (!con->is_flush_partial) {
+		rc = iproto_flush_reads(con);
+		if (rc <= 0)
+			return rc;
+	}
+	rc = iproto_flush(con);
+	con->is_flush_partial = rc < 0;
+	if (rc > 0 && !stailq_empty(&con->read_replies)) {
+		/* Replies postponed by a partial flush. */
+		return 0;
+	}
+	return rc;
+}
+
 static void
 iproto_connection_on_output(ev_loop *loop, struct ev_io *watcher,
 			    int /* revents */)
@@ -982,7 +1112,7 @@ iproto_connection_on_output(ev_loop *loop, struct ev_io *watcher,
 
 	try {
 		int rc;
-		while ((rc = iproto_flush(con)) <= 0) {
+		while ((rc = iproto_connection_flush(con)) <= 0) {
 			if (rc != 0) {
 				ev_io_start(loop, &con->output);
 				return;
@@ -1023,6 +1153,10 @@ iproto_connection_new(int fd)
 	iproto_wpos_create(&con->wend, con->tx.p_obuf);
 	con->parse_size = 0;
 	con->long_poll_count = 0;
+	con->tx_msg_count = 0;
+	stailq_create(&con->read_replies);
+	con->read_reply_offset = 0;
+	con->is_flush_partial = false;
 	con->session = NULL;
 	rlist_create(&con->in_stop_list);
 	/* It may be very awkward to allocate at close. */
@@ -1052,6 +1186,10 @@ iproto_connection_delete(struct iproto_connection *con)
 	       con->obuf[0].iov[0].iov_base == NULL);
 	assert(con->obuf[1].pos == 0 &&
 	       con->obuf[1].iov[0].iov_base == NULL);
+	struct iproto_read_reply *reply, *next;
+	stailq_foreach_entry_safe(reply, next, &con->read_replies,
+				  in_read_replies)
+		free(reply);
 	mempool_free(&iproto_connection_pool, con);
 }
 
@@ -1134,6 +1272,7 @@ static const struct cmsg_hop *dml_route[IPROTO_TYPE_STAT_MAX] = {
 	call_route,                             /* IPROTO_CALL */
 	sql_route,                              /* IPROTO_EXECUTE */
 	NULL,                                   /* IPROTO_NOP */
+	process1_route,                         /* IPROTO_DELETE_RANGE */
 };
 
 static const struct cmsg_hop join_route[] = {
@@ -1175,6 +1314,7 @@ iproto_msg_decode(struct iproto_msg *msg, const char **pos, const char *reqend,
 	case IPROTO_UPDATE:
 	case IPROTO_DELETE:
 	case IPROTO_UPSERT:
+	case IPROTO_DELETE_RANGE:
 		if (xrow_decode_dml(&msg->header, &msg->dml,
 				    dml_request_key_map(type)))
 			goto error;
@@ -1702,6 +1842,8 @@ net_send_msg(struct cmsg *m)
 	struct iproto_msg *msg = (struct iproto_msg *) m;
 	struct iproto_connection *con = msg->connection;
 
+	assert(con->tx_msg_count > 0);
+	con->tx_msg_count--;
 	if (msg->len != 0) {
 		/* Discard request (see iproto_enqueue_batch()). */
 		msg->p_ibuf->rpos += msg->len;
@@ -1740,6 +1882,8 @@ net_end_join(struct cmsg *m)
 	struct iproto_msg *msg = (struct iproto_msg *) m;
 	struct iproto_connection *con = msg->connection;
 
+	assert(con->tx_msg_count > 0);
+	con->tx_msg_count--;
 	msg->p_ibuf->rpos += msg->len;
 	iproto_msg_delete(msg);
 
@@ -1758,6 +1902,8 @@ net_end_subscribe(struct cmsg *m)
 	struct iproto_msg *msg = (struct iproto_msg *) m;
 	struct iproto_connection *con = msg->connection;
 
+	assert(con->tx_msg_count > 0);
+	con->tx_msg_count--;
 	msg->p_ibuf->rpos += msg->len;
 	iproto_msg_delete(msg);
 
@@ -1766,6 +1912,230 @@ net_end_subscribe(struct cmsg *m)
 	iproto_connection_close(con);
 }
 
+/* {{{ Reader threads */
+
+/**
+ * A thread executing SELECT requests against the current
+ * select view, bypassing the tx thread.
+ */
+struct iproto_reader {
+	/** Reader thread. */
+	struct cord cord;
+	/** Pipe from the iproto thread to the reader. */
+	struct cpipe reader_pipe;
+	/** Pipe from the reader to the iproto thread. */
+	struct cpipe net_pipe;
+	/** Route of requests sent to the reader. */
+	struct cmsg_hop route[2];
+	/** Reference to the select view used by the reader. */
+	struct select_view_ref *view_ref;
+	/** Buffer used by the reader for encoding replies. */
+	struct obuf out;
+};
+
+/** Reader thread pool. */
+static struct iproto_reader *readers;
+/** Number of reader threads. */
+static int reader_count;
+/**
+ * References to select views held by reader threads, one
+ * per reader. Checked by tx before deleting an old view.
+ */
+static struct select_view_ref *reader_view_refs;
+/**
+ * Number of readers the iproto thread may send requests
+ * to, set once pipes to the readers have been created.
+ */
+static int net_reader_count;
+/** Reader to send the next request to. Used by iproto thread. */
+static int net_next_reader;
+/** How often the select view is refreshed, in seconds. */
+static double read_view_period = 0.1;
+/** Loop of the tx thread, woken up by readers releasing a view. */
+static struct ev_loop *read_view_loop;
+/** Sent by a reader thread when it releases an old view. */
+static struct ev_async read_view_released;
+/** Signaled in tx when a reader releases an old view. */
+static struct fiber_cond read_view_cond;
+
+static bool
+iproto_msg_send_to_reader(struct iproto_msg *msg)
+{
+	struct iproto_connection *con = msg->connection;
+	if (net_reader_count == 0 || msg->base.hop != select_route ||
+	    con->session == NULL || con->tx_msg_count != 0)
+		return false;
+	struct iproto_reader *reader = &readers[net_next_reader];
+	net_next_reader = (net_next_reader + 1) % net_reader_count;
+	/*
+	 * Session credentials are only changed by requests
+	 * executed in tx, and there's none at the moment.
+	 */
+	msg->credentials = con->session->credentials;
+	msg->read_reply = NULL;
+	cmsg_init(&msg->base, reader->route);
+	cpipe_push(&reader->reader_pipe, &msg->base);
+	return true;
+}
+
+/** Copy a reply encoded in a reader thread buffer. */
+static struct iproto_read_reply *
+iproto_read_reply_new(struct obuf *out)
+{
+	size_t size = obuf_size(out);
+	struct iproto_read_reply *reply = (struct iproto_read_reply *)
+		malloc(sizeof(*reply) + size);
+	if (reply == NULL)
+		return NULL;
+	reply->size = size;
+	char *pos = reply->data;
+	int iovcnt = obuf_iovcnt(out);
+	for (int i = 0; i < iovcnt; i++) {
+		memcpy(pos, out->iov[i].iov_base, out->iov[i].iov_len);
+		pos += out->iov[i].iov_len;
+	}
+	assert(pos == reply->data + size);
+	return reply;
+}
+
+/**
+ * Execute a SELECT request against the current select view
+ * in a reader thread. If the request can't be served from
+ * the view, no reply is set and the iproto thread forwards
+ * the request to tx, see net_end_read().
+ */
+static void
+reader_process_select(struct cmsg *m)
+{
+	struct iproto_msg *msg = (struct iproto_msg *) m;
+	struct iproto_reader *reader =
+		container_of(cord(), struct iproto_reader, cord);
+	struct obuf *out = &reader->out;
+	struct obuf_svp svp;
+	uint32_t count;
+	struct select_view *view = select_view_acquire(reader->view_ref);
+	if (view == NULL)
+		goto out;
+	uint32_t view_schema_version;
+	view_schema_version = select_view_schema_version(view);
+	if (msg->header.schema_version != 0 &&
+	    msg->header.schema_version != view_schema_version)
+		goto out;
+	obuf_reset(out);
+	if (iproto_prepare_select(out, &svp) != 0) {
+		diag_clear(diag_get());
+		goto out;
+	}
+	if (select_view_select(view, &msg->credentials, &msg->dml,
+			       out, &count) != 0)
+		goto out;
+	iproto_reply_select(out, &svp, msg->header.sync,
+			    view_schema_version, count);
+	msg->read_reply = iproto_read_reply_new(out);
+out:
+	if (select_view_release(reader->view_ref))
+		ev_async_send(read_view_loop, &read_view_released);
+}
+
+/**
+ * Complete a SELECT request sent to a reader thread: queue
+ * the reply for writing to the socket or forward the request
+ * to tx if the reader couldn't serve it.
+ */
+static void
+net_end_read(struct cmsg *m)
+{
+	struct iproto_msg *msg = (struct iproto_msg *) m;
+	struct iproto_connection *con = msg->connection;
+	struct iproto_read_reply *reply = msg->read_reply;
+
+	if (reply == NULL) {
+		cmsg_init(&msg->base, select_route);
+		msg->wpos = con->wpos;
+		con->tx_msg_count++;
+		cpipe_push(&tx_pipe, &msg->base);
+		return;
+	}
+	/* Discard request (see iproto_enqueue_batch()). */
+	msg->p_ibuf->rpos += msg->len;
+	if (evio_has_fd(&con->output)) {
+		stailq_add_tail_entry(&con->read_replies, reply,
+				      in_read_replies);
+		if (! ev_is_active(&con->output))
+			ev_feed_event(con->loop, &con->output, EV_WRITE);
+	} else {
+		free(reply);
+		if (iproto_connection_is_idle(con))
+			iproto_connection_close(con);
+	}
+	iproto_msg_delete(msg);
+}
+
+/** Reader thread function. */
+static int
+iproto_reader_f(va_list ap)
+{
+	struct iproto_reader *reader = va_arg(ap, struct iproto_reader *);
+	struct cbus_endpoint endpoint;
+
+	obuf_create(&reader->out, &cord()->slabc, iproto_readahead);
+	cpipe_create(&reader->net_pipe, "net");
+	cbus_endpoint_create(&endpoint, cord_name(cord()),
+			     fiber_schedule_cb, fiber());
+	cbus_loop(&endpoint);
+	cbus_endpoint_destroy(&endpoint, cbus_process);
+	cpipe_destroy(&reader->net_pipe);
+	obuf_destroy(&reader->out);
+	return 0;
+}
+
+/**
+ * Replace the current select view with a new one and delete
+ * the old view once reader threads are done with it.
+ */
+static void
+iproto_refresh_read_view(void)
+{
+	struct select_view *view = select_view_new();
+	/*
+	 * If we failed to create a new view, stop using the
+	 * old one so as not to return arbitrarily stale data:
+	 * requests will be executed in tx until we succeed.
+	 */
+	if (view == NULL)
+		diag_log();
+	struct select_view *old = select_view_publish(view);
+	if (old == NULL)
+		return;
+	while (select_view_is_acquired(old, reader_view_refs, reader_count))
+		fiber_cond_wait(&read_view_cond);
+	select_view_delete(old);
+}
+
+static void
+iproto_read_view_released_cb(ev_loop *loop, struct ev_async *watcher,
+			     int events)
+{
+	(void) loop;
+	(void) watcher;
+	(void) events;
+	fiber_cond_broadcast(&read_view_cond);
+}
+
+/** Fiber refreshing the select view used by reader threads. */
+static int
+iproto_read_view_f(va_list /* ap */)
+{
+	while (!fiber_is_cancelled()) {
+		if (box_is_configured())
+			iproto_refresh_read_view();
+		fiber_sleep(read_view_period);
+	}
+	return 0;
+}
+
+/* }}} */
+
 /**
  * Handshake a connection: invoke the on-connect trigger
  * and possibly authenticate. Try to send the client an error
@@ -2037,7 +2407,8 @@ iproto_init()
 /** Available iproto configuration changes. */
 enum iproto_cfg_op {
 	IPROTO_CFG_MSG_MAX,
-	IPROTO_CFG_LISTEN
+	IPROTO_CFG_LISTEN,
+	IPROTO_CFG_READERS,
 };
 
 /**
@@ -2056,6 +2427,9 @@ struct iproto_cfg_msg: public cbus_call_msg
 
 		/** New iproto max message count. */
 		int iproto_msg_max;
+
+		/** Number of started reader threads. */
+		int reader_count;
 	};
 };
 
@@ -2089,6 +2463,14 @@ iproto_do_cfg_f(struct cbus_call_msg *m)
 			     evio_service_listen(&binary) != 0))
 				diag_raise();
 			break;
+		case IPROTO_CFG_READERS:
+			for (int i = 0; i < cfg_msg->reader_count; i++) {
+				struct iproto_reader *reader = &readers[i];
+				cpipe_create(&reader->reader_pipe,
+					     cord_name(&reader->cord));
+			}
+			net_reader_count = cfg_msg->reader_count;
+			break;
 		default:
 			unreachable();
 		}
@@ -2148,9 +2530,64 @@ iproto_set_msg_max(int new_iproto_msg_max)
 	cpipe_set_max_input(&net_pipe, new_iproto_msg_max / 2);
 }
 
+void
+iproto_start_readers(int count)
+{
+	assert(reader_count == 0);
+	if (count == 0)
+		return;
+	readers = (struct iproto_reader *) calloc(count, sizeof(*readers));
+	reader_view_refs = (struct select_view_ref *)
+		calloc(count, sizeof(*reader_view_refs));
+	if (readers == NULL || reader_view_refs == NULL)
+		panic("failed to allocate iproto reader thread pool");
+
+	read_view_loop = loop();
+	fiber_cond_create(&read_view_cond);
+	ev_async_init(&read_view_released, iproto_read_view_released_cb);
+	ev_async_start(read_view_loop, &read_view_released);
+
+	for (int i = 0; i < count; i++) {
+		struct iproto_reader *reader = &readers[i];
+		reader->route[0].f = reader_process_select;
+		reader->route[0].pipe = &reader->net_pipe;
+		reader->route[1].f = net_end_read;
+		reader->route[1].pipe = NULL;
+		reader->view_ref = &reader_view_refs[i];
+		char name[FIBER_NAME_MAX];
+
+		snprintf(name, sizeof(name), "iproto.reader.%d", i);
+		if (cord_costart(&reader->cord, name,
+				 iproto_reader_f, reader) != 0)
+			panic("failed to start iproto reader thread");
+	}
+	reader_count = count;
+
+	struct iproto_cfg_msg cfg_msg;
+	iproto_cfg_msg_create(&cfg_msg, IPROTO_CFG_READERS);
+	cfg_msg.reader_count = count;
+	iproto_do_cfg(&cfg_msg);
+
+	struct fiber *f = fiber_new("select_view", iproto_read_view_f);
+	if (f == NULL)
+		diag_raise();
+	fiber_start(f);
+}
+
+void
+iproto_set_read_view_period(double period)
+{
+	read_view_period = period;
+}
+
 void
 iproto_free()
 {
+	for (int i = 0; i < reader_count; i++) {
+		struct iproto_reader *reader = &readers[i];
+		tt_pthread_cancel(reader->cord.id);
+		tt_pthread_join(reader->cord.id, NULL);
+	}
 	tt_pthread_cancel(net_cord.id);
 	tt_pthread_join(net_cord.id, NULL);
 	/*
@@ -52,6 +52,8 @@ enum {
 	 * processing stops until some new fibers are freed up.
 	 */
 	IPROTO_FIBER_POOL_SIZE_FACTOR = 5,
+	/** The maximal value for net_read_threads. */
+	IPROTO_READ_THREADS_MAX = 64,
 };
 
 extern unsigned iproto_readahead;
@@ -86,6 +88,19 @@ iproto_listen(const char *uri);
 void
 iproto_set_msg_max(int iproto_msg_max);
 
+/**
+ * Start threads executing SELECT requests against a read
+ * view of memtx spaces, which is periodically refreshed.
+ * Requests that can't be served from the view are executed
+ * in the tx thread as usual.
+ */
+void
+iproto_start_readers(int count);
+
+/** Set how often the read view used by reader threads is refreshed. */
+void
+iproto_set_read_view_period(double period);
+
 void
 iproto_free();
 
@@ -202,6 +202,8 @@ enum iproto_type {
 	IPROTO_EXECUTE = 11,
 	/** No operation. Treated as DML, used to bump LSN. */
 	IPROTO_NOP = 12,
+	/** Delete all tuples in a key range [key, tuple). */
+	IPROTO_DELETE_RANGE = 13,
 	/** The maximum typecode used for box.stat() */
 	IPROTO_TYPE_STAT_MAX,
 
@@ -222,6 +224,10 @@ enum iproto_type {
 	VY_INDEX_PAGE_INFO = 101,
 	/** Vinyl row index stored in .run file */
 	VY_RUN_ROW_INDEX = 102,
+	/** Vinyl bloom filter partition stored in .index file */
+	VY_INDEX_BLOOM = 103,
+	/** Vinyl DELETE_RANGE statements stored in .run file */
+	VY_RUN_RANGE_DELETES = 104,
 
 	/** Non-final response type. */
 	IPROTO_CHUNK = 128,
@@ -243,11 +249,14 @@ static inline const char *
 iproto_type_name(uint32_t type)
 {
 	/*
-	 * Sic: iptoto_type_strs[IPROTO_NOP] is NULL
+	 * Sic: iptoto_type_strs[IPROTO_NOP] and
+	 * iproto_type_strs[IPROTO_DELETE_RANGE] are NULL
 	 * to suppress box.stat() output.
 	 */
 	if (type == IPROTO_NOP)
 		return "NOP";
+	if (type == IPROTO_DELETE_RANGE)
+		return "DELETE_RANGE";
 
 	if (type < IPROTO_TYPE_STAT_MAX)
 		return iproto_type_strs[type];
@@ -259,6 +268,10 @@ iproto_type_name(uint32_t type)
 		return "PAGEINFO";
 	case VY_RUN_ROW_INDEX:
 		return "ROWINDEX";
+	case VY_INDEX_BLOOM:
+		return "BLOOM";
+	case VY_RUN_RANGE_DELETES:
+		return "RANGEDELETES";
 	default:
 		return NULL;
 	}
@@ -282,7 +295,8 @@ static inline bool
 iproto_type_is_dml(uint32_t type)
 {
 	return (type >= IPROTO_SELECT && type <= IPROTO_DELETE) ||
-		type == IPROTO_UPSERT || type == IPROTO_NOP;
+		type == IPROTO_UPSERT || type == IPROTO_NOP ||
+		type == IPROTO_DELETE_RANGE;
 }
 
 /**
@@ -364,6 +378,13 @@ enum vy_run_info_key {
 	VY_RUN_INFO_BLOOM = 7,
 	/** Number of statements of each type (map). */
 	VY_RUN_INFO_STMT_STAT = 8,
+	/**
+	 * First pages of bloom filter partitions (array).
+	 * Partitions follow page info in separate transactions.
+	 */
+	VY_RUN_INFO_BLOOM_PARTITIONS = 9,
+	/** DELETE_RANGE statements: array of [lsn, begin, end]. */
+	VY_RUN_INFO_RANGE_DELETES = 10,
 	/** The last key in this enum + 1 */
 	VY_RUN_INFO_KEY_MAX
 };
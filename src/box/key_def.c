@@ -104,6 +104,10 @@ key_def_dup(const struct key_def *src)
 		size_t path_offset = src->parts[i].path - (char *)src;
 		res->parts[i].path = (char *)res + path_offset;
 	}
+	if (src->multikey_path != NULL) {
+		size_t path_offset = src->multikey_path - (char *)src;
+		res->multikey_path = (char *)res + path_offset;
+	}
 	return res;
 }
 
@@ -122,6 +126,9 @@ key_def_swap(struct key_def *old_def, struct key_def *new_def)
 		SWAP(old_def->parts[i].path, new_def->parts[i].path);
 	}
 	SWAP(*old_def, *new_def);
+	/* Same as above, the multikey path points to a part path. */
+	assert(old_def->multikey_path_len == new_def->multikey_path_len);
+	SWAP(old_def->multikey_path, new_def->multikey_path);
 }
 
 void
@@ -164,6 +171,15 @@ key_def_set_part(struct key_def *def, uint32_t part_no, uint32_t fieldno,
 		*path_pool += path_len;
 		memcpy(def->parts[part_no].path, path, path_len);
 		def->parts[part_no].path_len = path_len;
+		uint32_t multikey_path_len =
+			json_path_multikey_offset(path, path_len,
+						  TUPLE_INDEX_BASE);
+		if (multikey_path_len < path_len && !def->is_multikey) {
+			def->is_multikey = true;
+			def->multikey_fieldno = fieldno;
+			def->multikey_path = def->parts[part_no].path;
+			def->multikey_path_len = multikey_path_len;
+		}
 	} else {
 		def->parts[part_no].path = NULL;
 		def->parts[part_no].path_len = 0;
@@ -172,7 +188,8 @@ key_def_set_part(struct key_def *def, uint32_t part_no, uint32_t fieldno,
 }
 
 struct key_def *
-key_def_new(const struct key_part_def *parts, uint32_t part_count)
+key_def_new(const struct key_part_def *parts, uint32_t part_count,
+	    bool for_func_index)
 {
 	size_t sz = 0;
 	for (uint32_t i = 0; i < part_count; i++)
@@ -186,6 +203,8 @@ key_def_new(const struct key_part_def *parts, uint32_t part_count)
 
 	def->part_count = part_count;
 	def->unique_part_count = part_count;
+	def->for_func_index = for_func_index;
+	def->func_index_part_count = for_func_index ? part_count : 0;
 
 	/* A pointer to the JSON paths data in the new key_def. */
 	char *path_pool = (char *)def + key_def_sizeof(part_count, 0);
@@ -209,6 +228,12 @@ key_def_new(const struct key_part_def *parts, uint32_t part_count)
 				 &path_pool, TUPLE_OFFSET_SLOT_NIL, 0);
 	}
 	assert(path_pool == (char *)def + sz);
+	/*
+	 * The index function may read any tuple field so any
+	 * change of a tuple may change its functional key.
+	 */
+	if (for_func_index)
+		def->column_mask = COLUMN_MASK_FULL;
 	key_def_set_func(def);
 	return def;
 }
@@ -322,7 +347,12 @@ void
 key_def_update_optionality(struct key_def *def, uint32_t min_field_count)
 {
 	def->has_optional_parts = false;
-	for (uint32_t i = 0; i < def->part_count; ++i) {
+	/*
+	 * Functional key parts are never absent, the key is
+	 * validated when it is extracted.
+	 */
+	for (uint32_t i = def->func_index_part_count;
+	     i < def->part_count; ++i) {
 		struct key_part *part = &def->parts[i];
 		def->has_optional_parts |=
 			(min_field_count < part->fieldno + 1 ||
@@ -499,6 +529,25 @@ key_def_decode_parts_166(struct key_part_def *parts, uint32_t part_count,
 	return 0;
 }
 
+/**
+ * Return the number of array index placeholders [*] in
+ * a valid JSON path.
+ */
+static int
+key_part_path_multikey_count(const char *path, uint32_t path_len)
+{
+	int count = 0;
+	struct json_lexer lexer;
+	struct json_token token;
+	json_lexer_create(&lexer, path, path_len, TUPLE_INDEX_BASE);
+	while (json_lexer_next_token(&lexer, &token) == 0 &&
+	       token.type != JSON_TOKEN_END) {
+		if (token.type == JSON_TOKEN_ANY)
+			count++;
+	}
+	return count;
+}
+
 int
 key_def_decode_parts(struct key_part_def *parts, uint32_t part_count,
 		     const char **data, const struct field_def *fields,
@@ -584,6 +633,15 @@ key_def_decode_parts(struct key_part_def *parts, uint32_t part_count,
 				 i + TUPLE_INDEX_BASE, "invalid path");
 			return -1;
 		}
+		if (part->path != NULL &&
+		    key_part_path_multikey_count(part->path,
+						 strlen(part->path)) > 1) {
+			diag_set(ClientError, ER_WRONG_INDEX_OPTIONS,
+				 i + TUPLE_INDEX_BASE,
+				 "no more than one array index placeholder "
+				 "[*] is allowed in JSON path");
+			return -1;
+		}
 	}
 	return 0;
 }
@@ -615,6 +673,12 @@ key_def_find(const struct key_def *key_def, const struct key_part *to_find)
 bool
 key_def_contains(const struct key_def *first, const struct key_def *second)
 {
+	/*
+	 * Parts of a functional index refer to the key returned
+	 * by the index function, not to tuple fields.
+	 */
+	if (first->for_func_index || second->for_func_index)
+		return false;
 	const struct key_part *part = second->parts;
 	const struct key_part *end = part + second->part_count;
 	for (; part != end; part++) {
@@ -631,6 +695,12 @@ static bool
 key_def_can_merge(const struct key_def *key_def,
 		  const struct key_part *to_merge)
 {
+	/*
+	 * Parts of a functional index don't refer to tuple
+	 * fields so they can't duplicate primary key parts.
+	 */
+	if (key_def->for_func_index)
+		return true;
 	const struct key_part *part = key_def_find(key_def, to_merge);
 	if (part == NULL)
 		return true;
@@ -676,6 +746,8 @@ key_def_merge(const struct key_def *first, const struct key_def *second)
 	new_def->is_nullable = first->is_nullable || second->is_nullable;
 	new_def->has_optional_parts = first->has_optional_parts ||
 				      second->has_optional_parts;
+	new_def->for_func_index = first->for_func_index;
+	new_def->func_index_part_count = first->func_index_part_count;
 
 	/* JSON paths data in the new key_def. */
 	char *path_pool = (char *)new_def + key_def_sizeof(new_part_count, 0);
@@ -705,6 +777,8 @@ key_def_merge(const struct key_def *first, const struct key_def *second)
 				 part->offset_slot_cache, part->format_epoch);
 	}
 	assert(path_pool == (char *)new_def + sz);
+	if (new_def->for_func_index)
+		new_def->column_mask = COLUMN_MASK_FULL;
 	key_def_set_func(new_def);
 	return new_def;
 }
@@ -732,15 +806,23 @@ key_def_find_pk_in_cmp_def(const struct key_def *cmp_def,
 	 * parts in a secondary key.
 	 */
 	for (uint32_t i = 0; i < pk_def->part_count; i++) {
+		parts[i].path = NULL;
+		if (cmp_def->for_func_index) {
+			/*
+			 * key_def_merge() appends all primary key
+			 * parts to the parts of a functional key.
+			 */
+			parts[i].fieldno = cmp_def->func_index_part_count + i;
+			continue;
+		}
 		const struct key_part *part = key_def_find(cmp_def,
 							   &pk_def->parts[i]);
 		assert(part != NULL);
 		parts[i].fieldno = part - cmp_def->parts;
-		parts[i].path = NULL;
 	}
 
 	/* Finally, allocate the new key definition. */
-	extracted_def = key_def_new(parts, pk_def->part_count);
+	extracted_def = key_def_new(parts, pk_def->part_count, false);
 out:
 	region_truncate(region, region_svp);
 	return extracted_def;
@@ -36,6 +36,7 @@
 #include <msgpuck.h>
 #include "field_def.h"
 #include "coll_id.h"
+#include <limits.h>
 
 #if defined(__cplusplus)
 extern "C" {
@@ -137,6 +138,30 @@ typedef int (*tuple_compare_with_key_t)(const struct tuple *tuple_a,
 typedef int (*tuple_compare_t)(const struct tuple *tuple_a,
 			       const struct tuple *tuple_b,
 			       struct key_def *key_def);
+/** @copydoc tuple_compare_multikey() */
+typedef int (*tuple_compare_multikey_t)(const struct tuple *tuple_a,
+					int multikey_idx_a,
+					const struct tuple *tuple_b,
+					int multikey_idx_b,
+					struct key_def *key_def);
+/** @copydoc tuple_compare_with_key_multikey() */
+typedef int (*tuple_compare_with_key_multikey_t)(const struct tuple *tuple,
+						 int multikey_idx,
+						 const char *key,
+						 uint32_t part_count,
+						 struct key_def *key_def);
+/** @copydoc tuple_compare_func() */
+typedef int (*tuple_compare_func_t)(const struct tuple *tuple_a,
+				    const char *func_key_a,
+				    const struct tuple *tuple_b,
+				    const char *func_key_b,
+				    struct key_def *key_def);
+/** @copydoc tuple_compare_with_key_func() */
+typedef int (*tuple_compare_with_key_func_t)(const struct tuple *tuple,
+					     const char *func_key,
+					     const char *key,
+					     uint32_t part_count,
+					     struct key_def *key_def);
 /** @copydoc tuple_extract_key() */
 typedef char *(*tuple_extract_key_t)(const struct tuple *tuple,
 				     struct key_def *key_def,
@@ -153,12 +178,63 @@ typedef uint32_t (*tuple_hash_t)(const struct tuple *tuple,
 typedef uint32_t (*key_hash_t)(const char *key,
 				struct key_def *key_def);
 
+/**
+ * Tuple comparison hint. A hint is an unsigned integer computed
+ * from the first key part of a tuple or a key such that
+ *
+ *   hint(t1) < hint(t2) => t1 < t2
+ *   hint(t1) > hint(t2) => t1 > t2
+ *
+ * i.e. a hint can be used to compare two tuples without looking
+ * at their MsgPack data. Only if hints are equal the tuples have
+ * to be compared with the full comparator. See tuple_compare.cc
+ * for the hint layout.
+ */
+typedef uint64_t hint_t;
+
+/**
+ * Reserved value to use when a comparison hint is undefined,
+ * e.g. for a key with zero parts. Comparing to HINT_NONE always
+ * falls back on the full comparator.
+ */
+#define HINT_NONE ((hint_t)UINT64_MAX)
+
+/** Hint layout, see tuple_compare.cc. */
+#define HINT_BITS		(sizeof(hint_t) * CHAR_BIT)
+#define HINT_CLASS_BITS		4
+#define HINT_VALUE_BITS		(HINT_BITS - HINT_CLASS_BITS)
+
+/** Max value that can be stored in a hint. */
+#define HINT_VALUE_MAX		((1ULL << HINT_VALUE_BITS) - 1)
+
+/** @copydoc tuple_hint() */
+typedef hint_t (*tuple_hint_t)(const struct tuple *tuple,
+			       struct key_def *key_def);
+/** @copydoc key_hint() */
+typedef hint_t (*key_hint_t)(const char *key, uint32_t part_count,
+			     struct key_def *key_def);
+
+/**
+ * Multikey index position to pass to field accessors when
+ * the field isn't looked up in a multikey array. JSON path
+ * tokens [*] resolve to nothing in this case.
+ */
+#define MULTIKEY_NONE -1
+
 /* Definition of a multipart key. */
 struct key_def {
 	/** @see tuple_compare() */
 	tuple_compare_t tuple_compare;
 	/** @see tuple_compare_with_key() */
 	tuple_compare_with_key_t tuple_compare_with_key;
+	/** @see tuple_compare_multikey() */
+	tuple_compare_multikey_t tuple_compare_multikey;
+	/** @see tuple_compare_with_key_multikey() */
+	tuple_compare_with_key_multikey_t tuple_compare_with_key_multikey;
+	/** @see tuple_compare_func() */
+	tuple_compare_func_t tuple_compare_func;
+	/** @see tuple_compare_with_key_func() */
+	tuple_compare_with_key_func_t tuple_compare_with_key_func;
 	/** @see tuple_extract_key() */
 	tuple_extract_key_t tuple_extract_key;
 	/** @see tuple_extract_key_raw() */
@@ -167,6 +243,22 @@ struct key_def {
 	tuple_hash_t tuple_hash;
 	/** @see key_hash() */
 	key_hash_t key_hash;
+	/** @see tuple_hint() */
+	tuple_hint_t tuple_hint;
+	/** @see key_hint() */
+	key_hint_t key_hint;
+	/**
+	 * True if hints grow monotonically with keys and are
+	 * distributed like the keys themselves, i.e. the first
+	 * key part is an integer. Such hints can be used for
+	 * interpolation search.
+	 */
+	bool has_ordinal_hints;
+	/**
+	 * True if equal hints mean equal keys, unless they are
+	 * saturated, see hint_is_exact().
+	 */
+	bool has_exact_hints;
 	/**
 	 * Minimal part count which always is unique. For example,
 	 * if a secondary index is unique, then
@@ -184,6 +276,35 @@ struct key_def {
 	 * fields assumed to be MP_NIL.
 	 */
 	bool has_optional_parts;
+	/**
+	 * True if some key part has a JSON path with the array
+	 * index placeholder [*]. A tuple has as many keys in
+	 * such an index as there are elements in the array
+	 * referred to by multikey_fieldno and multikey_path.
+	 */
+	bool is_multikey;
+	/** Number of the field holding the multikey array. */
+	uint32_t multikey_fieldno;
+	/**
+	 * JSON path to the multikey array relative to
+	 * multikey_fieldno, i.e. the part of a multikey key part
+	 * path preceding [*]. Points to the path of the key part
+	 * so it isn't 0-terminated.
+	 */
+	const char *multikey_path;
+	/** The length of multikey_path. */
+	uint32_t multikey_path_len;
+	/**
+	 * True if the key definition belongs to a functional
+	 * index. The first func_index_part_count parts of such
+	 * a key definition refer to fields of the key returned
+	 * by the index function rather than to tuple fields.
+	 * The rest are primary key parts appended by
+	 * key_def_merge().
+	 */
+	bool for_func_index;
+	/** Number of parts referring to the functional key. */
+	uint32_t func_index_part_count;
 	/** Key fields mask. @sa column_mask.h for details. */
 	uint64_t column_mask;
 	/** The size of the 'parts' array. */
@@ -280,10 +401,12 @@ key_def_sizeof(uint32_t part_count, uint32_t path_pool_size)
 
 /**
  * Allocate a new key_def with the given part count
- * and initialize its parts.
+ * and initialize its parts. If @a for_func_index is set,
+ * the parts refer to fields of a functional index key.
  */
 struct key_def *
-key_def_new(const struct key_part_def *parts, uint32_t part_count);
+key_def_new(const struct key_part_def *parts, uint32_t part_count,
+	    bool for_func_index);
 
 /**
  * Dump part definitions of the given key def.
@@ -575,6 +698,148 @@ tuple_compare_with_key(const struct tuple *tuple, const char *key,
 	return key_def->tuple_compare_with_key(tuple, key, part_count, key_def);
 }
 
+/**
+ * Compare keys stored in a multikey index.
+ * @param tuple_a first tuple
+ * @param multikey_idx_a position of the key in the multikey
+ *                       array of @a tuple_a
+ * @param tuple_b second tuple
+ * @param multikey_idx_b position of the key in the multikey
+ *                       array of @a tuple_b
+ * @param key_def multikey key definition
+ * @retval 0  if key_a == key_b
+ * @retval <0 if key_a < key_b
+ * @retval >0 if key_a > key_b
+ */
+static inline int
+tuple_compare_multikey(const struct tuple *tuple_a, int multikey_idx_a,
+		       const struct tuple *tuple_b, int multikey_idx_b,
+		       struct key_def *key_def)
+{
+	assert(key_def->is_multikey);
+	return key_def->tuple_compare_multikey(tuple_a, multikey_idx_a,
+					       tuple_b, multikey_idx_b,
+					       key_def);
+}
+
+/**
+ * Compare a key stored in a multikey index with a search key.
+ * @param tuple tuple
+ * @param multikey_idx position of the key in the multikey array
+ *                     of @a tuple
+ * @param key key parts without MessagePack array header
+ * @param part_count the number of parts in @a key
+ * @param key_def multikey key definition
+ * @retval 0  if key_fields(tuple) == parts(key)
+ * @retval <0 if key_fields(tuple) < parts(key)
+ * @retval >0 if key_fields(tuple) > parts(key)
+ */
+static inline int
+tuple_compare_with_key_multikey(const struct tuple *tuple, int multikey_idx,
+				const char *key, uint32_t part_count,
+				struct key_def *key_def)
+{
+	assert(key_def->is_multikey);
+	return key_def->tuple_compare_with_key_multikey(tuple, multikey_idx,
+							key, part_count,
+							key_def);
+}
+
+/**
+ * Compare two tuples stored in a functional index.
+ * @param tuple_a first tuple
+ * @param func_key_a functional key of @a tuple_a
+ * @param tuple_b second tuple
+ * @param func_key_b functional key of @a tuple_b
+ * @param key_def functional index key definition
+ * @retval 0  if key_fields(tuple_a) == key_fields(tuple_b)
+ * @retval <0 if key_fields(tuple_a) < key_fields(tuple_b)
+ * @retval >0 if key_fields(tuple_a) > key_fields(tuple_b)
+ */
+static inline int
+tuple_compare_func(const struct tuple *tuple_a, const char *func_key_a,
+		   const struct tuple *tuple_b, const char *func_key_b,
+		   struct key_def *key_def)
+{
+	assert(key_def->for_func_index);
+	return key_def->tuple_compare_func(tuple_a, func_key_a,
+					   tuple_b, func_key_b, key_def);
+}
+
+/**
+ * Compare a tuple stored in a functional index with a search
+ * key.
+ * @param tuple tuple
+ * @param func_key functional key of @a tuple
+ * @param key key parts without MessagePack array header
+ * @param part_count the number of parts in @a key
+ * @param key_def functional index key definition
+ * @retval 0  if key_fields(tuple) == parts(key)
+ * @retval <0 if key_fields(tuple) < parts(key)
+ * @retval >0 if key_fields(tuple) > parts(key)
+ */
+static inline int
+tuple_compare_with_key_func(const struct tuple *tuple, const char *func_key,
+			    const char *key, uint32_t part_count,
+			    struct key_def *key_def)
+{
+	assert(key_def->for_func_index);
+	return key_def->tuple_compare_with_key_func(tuple, func_key, key,
+						    part_count, key_def);
+}
+
+/**
+ * Compute a comparison hint for a tuple.
+ * @param tuple - tuple to compute the hint for
+ * @param key_def - key_def used for tuple comparison
+ * @return - hint value
+ */
+static inline hint_t
+tuple_hint(const struct tuple *tuple, struct key_def *key_def)
+{
+	return key_def->tuple_hint(tuple, key_def);
+}
+
+/**
+ * Compute a comparison hint for a key.
+ * @param key - key parts without MessagePack array header
+ * @param part_count - the number of parts in @a key
+ * @param key_def - key_def used for tuple comparison
+ * @return - hint value, HINT_NONE if @a part_count is 0
+ */
+static inline hint_t
+key_hint(const char *key, uint32_t part_count, struct key_def *key_def)
+{
+	return key_def->key_hint(key, part_count, key_def);
+}
+
+/**
+ * Compare two comparison hints.
+ * @retval 0  if the hints are equal or either of them is
+ *            HINT_NONE, i.e. a full comparison is required
+ * @retval <0 if hint_a < hint_b
+ * @retval >0 if hint_a > hint_b
+ */
+static inline int
+hint_cmp(hint_t hint_a, hint_t hint_b)
+{
+	if (hint_a == hint_b || hint_a == HINT_NONE || hint_b == HINT_NONE)
+		return 0;
+	return hint_a < hint_b ? -1 : 1;
+}
+
+/**
+ * Return true if two keys with hint @a hint are equal without
+ * comparing them, i.e. the key definition has exact hints and
+ * the hint value isn't saturated.
+ */
+static inline bool
+hint_is_exact(hint_t hint, struct key_def *key_def)
+{
+	hint_t val = hint & HINT_VALUE_MAX;
+	return key_def->has_exact_hints && val != 0 && val != HINT_VALUE_MAX;
+}
+
 /**
  * Compute hash of a tuple field.
  * @param ph1 - pointer to running hash
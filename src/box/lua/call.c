@@ -31,6 +31,7 @@
 #include "box/lua/call.h"
 #include "box/call.h"
 #include "box/error.h"
+#include "box/func.h"
 #include "fiber.h"
 
 #include "lua/utils.h"
@@ -459,6 +460,130 @@ box_lua_eval(struct call_request *request, struct port *port)
 	return box_process_lua(request, port, execute_lua_eval);
 }
 
+/**
+ * Global names available to persistent Lua functions. Such
+ * functions are executed in a sandbox so that they can't
+ * access the database or yield.
+ */
+static const char *func_lua_sandbox_globals[] = {
+	"assert", "error", "ipairs", "next", "pairs", "pcall", "select",
+	"tonumber", "tostring", "type", "unpack", "xpcall", "bit", "math",
+	"string", "table", "utf8", NULL
+};
+
+/**
+ * Compile the body of a persistent Lua function and save
+ * a reference to the function object in func::lua_ref.
+ * The body is an expression evaluating to a function, e.g.
+ * "function(tuple) return {tuple[2]:lower()} end".
+ */
+static void
+func_lua_load(lua_State *L, struct func *func)
+{
+	assert(func->lua_ref == LUA_NOREF);
+	assert(func->def->body != NULL);
+	lua_pushliteral(L, "return ");
+	lua_pushstring(L, func->def->body);
+	lua_concat(L, 2);
+	size_t code_len;
+	const char *code = lua_tolstring(L, -1, &code_len);
+	if (luaL_loadbuffer(L, code, code_len, func->def->name) != 0) {
+		diag_set(ClientError, ER_LOAD_FUNCTION, func->def->name,
+			 lua_tostring(L, -1));
+		luaT_error(L);
+	}
+	lua_newtable(L);
+	for (const char **name = func_lua_sandbox_globals;
+	     *name != NULL; name++) {
+		lua_getfield(L, LUA_GLOBALSINDEX, *name);
+		lua_setfield(L, -2, *name);
+	}
+	lua_setfenv(L, -2);
+	lua_call(L, 0, 1);
+	if (!lua_isfunction(L, -1)) {
+		diag_set(ClientError, ER_LOAD_FUNCTION, func->def->name,
+			 "function body must evaluate to a function");
+		luaT_error(L);
+	}
+	func->lua_ref = luaL_ref(L, LUA_REGISTRYINDEX);
+	lua_pop(L, 1);
+}
+
+struct func_lua_call_ctx {
+	/** Function to call. */
+	struct func *func;
+	/** The only argument of the function. */
+	struct tuple *tuple;
+	/** MsgPack array of returned values. */
+	const char *data;
+	/** End of @a data. */
+	const char *data_end;
+};
+
+static int
+execute_lua_func_call(lua_State *L)
+{
+	struct func_lua_call_ctx *ctx = (struct func_lua_call_ctx *)
+		lua_topointer(L, 1);
+	lua_settop(L, 0);
+	struct func *func = ctx->func;
+	if (func->lua_ref == LUA_NOREF)
+		func_lua_load(L, func);
+	lua_rawgeti(L, LUA_REGISTRYINDEX, func->lua_ref);
+	luaT_pushtuple(L, ctx->tuple);
+	lua_call(L, 1, LUA_MULTRET);
+
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	struct mpstream stream;
+	mpstream_init(&stream, region, region_reserve_cb, region_alloc_cb,
+		      luamp_error, L);
+	struct luaL_serializer *cfg = luaL_msgpack_default;
+	int count = lua_gettop(L);
+	if (count == 1 && lua_istable(L, 1)) {
+		/* A single table is returned as is. */
+		luamp_encode(L, cfg, &stream, 1);
+	} else {
+		mpstream_encode_array(&stream, count);
+		for (int i = 1; i <= count; i++)
+			luamp_encode(L, cfg, &stream, i);
+	}
+	mpstream_flush(&stream);
+	size_t size = region_used(region) - region_svp;
+	ctx->data = (const char *) region_join(region, size);
+	if (ctx->data == NULL) {
+		diag_set(OutOfMemory, size, "region", "data");
+		luaT_error(L);
+	}
+	ctx->data_end = ctx->data + size;
+	return 0;
+}
+
+int
+box_lua_func_call(struct func *func, struct tuple *tuple,
+		  const char **data, const char **data_end)
+{
+	assert(func->def->language == FUNC_LANGUAGE_LUA);
+	struct func_lua_call_ctx ctx;
+	ctx.func = func;
+	ctx.tuple = tuple;
+	/*
+	 * Use the global state, since the function runs in
+	 * a sandbox and so can't yield.
+	 */
+	struct lua_State *L = tarantool_L;
+	int top = lua_gettop(L);
+	if (lua_cpcall(L, execute_lua_func_call, &ctx) != 0) {
+		luaT_toerror(L);
+		lua_settop(L, top);
+		return -1;
+	}
+	lua_settop(L, top);
+	*data = ctx.data;
+	*data_end = ctx.data_end;
+	return 0;
+}
+
 static int
 lbox_module_reload(lua_State *L)
 {
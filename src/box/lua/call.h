@@ -53,6 +53,22 @@ box_lua_call(struct call_request *request, struct port *port);
 int
 box_lua_eval(struct call_request *request, struct port *port);
 
+struct func;
+struct tuple;
+
+/**
+ * Call a persistent Lua function, i.e. one with a body stored
+ * in the _func space, passing @a tuple as the only argument.
+ * Returned values are encoded on the fiber region as a MsgPack
+ * array, a single returned table is encoded as is.
+ *
+ * @retval 0 Success, @a data points to the result.
+ * @retval -1 Error, diag is set.
+ */
+int
+box_lua_func_call(struct func *func, struct tuple *tuple,
+		  const char **data, const char **data_end);
+
 #if defined(__cplusplus)
 } /* extern "C" */
 #endif /* defined(__cplusplus) */
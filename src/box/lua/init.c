@@ -59,6 +59,7 @@
 #include "box/lua/console.h"
 #include "box/lua/tuple.h"
 #include "box/lua/sql.h"
+#include "box/lua/read_view.h"
 
 extern char session_lua[],
 	tuple_lua[],
@@ -307,6 +308,7 @@ box_lua_init(struct lua_State *L)
 	box_lua_ctl_init(L);
 	box_lua_session_init(L);
 	box_lua_xlog_init(L);
+	box_lua_read_view_init(L);
 	box_lua_sql_init(L);
 	luaopen_net_box(L);
 	lua_pop(L, 1);
@@ -27,6 +27,11 @@ local default_cfg = {
     memtx_memory        = 256 * 1024 *1024,
     memtx_min_tuple_size = 16,
     memtx_max_tuple_size = 1024 * 1024,
+    memtx_snap_threads  = 1,
+    memtx_defrag_threshold = 0,
+    memtx_huge_pages    = 'off',
+    memtx_numa_policy   = 'default',
+    memtx_numa_nodes    = nil,
     slab_alloc_factor   = 1.05,
     work_dir            = nil,
     memtx_dir           = ".",
@@ -35,9 +40,12 @@ local default_cfg = {
     vinyl_dir           = '.',
     vinyl_memory        = 128 * 1024 * 1024,
     vinyl_cache         = 128 * 1024 * 1024,
+    vinyl_page_cache    = 0,
     vinyl_max_tuple_size = 1024 * 1024,
     vinyl_read_threads  = 1,
     vinyl_write_threads = 4,
+    vinyl_io_uring      = false,
+    vinyl_io_uring_direct = false,
     vinyl_timeout       = 60,
     vinyl_run_count_per_level = 2,
     vinyl_run_size_ratio      = 3.5,
@@ -81,6 +89,8 @@ local default_cfg = {
     feedback_host         = "https://feedback.tarantool.io",
     feedback_interval     = 3600,
     net_msg_max           = 768,
+    net_read_threads      = 0,
+    net_read_view_period  = 0.1,
 }
 
 -- types of available options
@@ -90,6 +100,11 @@ local template_cfg = {
     memtx_memory        = 'number',
     memtx_min_tuple_size  = 'number',
     memtx_max_tuple_size  = 'number',
+    memtx_snap_threads    = 'number',
+    memtx_defrag_threshold = 'number',
+    memtx_huge_pages      = 'string',
+    memtx_numa_policy     = 'string',
+    memtx_numa_nodes      = 'string',
     slab_alloc_factor   = 'number',
     work_dir            = 'string',
     memtx_dir            = 'string',
@@ -97,9 +112,12 @@ local template_cfg = {
     vinyl_dir           = 'string',
     vinyl_memory        = 'number',
     vinyl_cache               = 'number',
+    vinyl_page_cache          = 'number',
     vinyl_max_tuple_size      = 'number',
     vinyl_read_threads        = 'number',
     vinyl_write_threads       = 'number',
+    vinyl_io_uring            = 'boolean',
+    vinyl_io_uring_direct     = 'boolean',
     vinyl_timeout             = 'number',
     vinyl_run_count_per_level = 'number',
     vinyl_run_size_ratio      = 'number',
@@ -144,6 +162,8 @@ local template_cfg = {
     feedback_host         = 'string',
     feedback_interval     = 'number',
     net_msg_max           = 'number',
+    net_read_threads      = 'number',
+    net_read_view_period  = 'number',
 }
 
 local function normalize_uri(port)
@@ -224,9 +244,12 @@ local dynamic_cfg = {
     read_only               = private.cfg_set_read_only,
     memtx_memory            = private.cfg_set_memtx_memory,
     memtx_max_tuple_size    = private.cfg_set_memtx_max_tuple_size,
+    memtx_snap_threads      = private.cfg_set_memtx_snap_threads,
+    memtx_defrag_threshold  = private.cfg_set_memtx_defrag_threshold,
     vinyl_memory            = private.cfg_set_vinyl_memory,
     vinyl_max_tuple_size    = private.cfg_set_vinyl_max_tuple_size,
     vinyl_cache             = private.cfg_set_vinyl_cache,
+    vinyl_page_cache        = private.cfg_set_vinyl_page_cache,
     vinyl_timeout           = private.cfg_set_vinyl_timeout,
     checkpoint_count        = private.cfg_set_checkpoint_count,
     checkpoint_interval     = private.cfg_set_checkpoint_interval,
@@ -250,15 +273,19 @@ local dynamic_cfg = {
     instance_uuid           = check_instance_uuid,
     replicaset_uuid         = check_replicaset_uuid,
     net_msg_max             = private.cfg_set_net_msg_max,
+    net_read_view_period    = private.cfg_set_net_read_view_period,
 }
 
 local dynamic_cfg_skip_at_load = {
     listen                  = true,
     memtx_memory            = true,
     memtx_max_tuple_size    = true,
+    memtx_snap_threads      = true,
+    memtx_defrag_threshold  = true,
     vinyl_memory            = true,
     vinyl_max_tuple_size    = true,
     vinyl_cache             = true,
+    vinyl_page_cache        = true,
     vinyl_timeout           = true,
     too_long_threshold      = true,
     replication             = true,
@@ -274,6 +301,7 @@ local dynamic_cfg_skip_at_load = {
     instance_uuid           = true,
     replicaset_uuid         = true,
     net_msg_max             = true,
+    net_read_view_period    = true,
     readahead               = true,
 }
 
@@ -77,6 +77,16 @@ local function decode_count(raw_data)
     local response, raw_end = decode(raw_data)
     return response[IPROTO_DATA_KEY][1], raw_end
 end
+local function decode_get_many(raw_data)
+    local response, raw_end = decode(raw_data)
+    local result = {}
+    for i, tuple in pairs(response[IPROTO_DATA_KEY][1]) do
+        if tuple ~= nil then
+            result[i] = box.tuple.new(tuple)
+        end
+    end
+    return result, raw_end
+end
 local function decode_push(raw_data)
     local response, raw_end = decode(raw_data)
     return response[IPROTO_DATA_KEY][1], raw_end
@@ -98,6 +108,7 @@ local method_encoder = {
     min     = internal.encode_select,
     max     = internal.encode_select,
     count   = internal.encode_call,
+    get_many = internal.encode_call,
     -- inject raw data into connection, used by console and tests
     inject = function(buf, id, bytes)
         local ptr = buf:reserve(#bytes)
@@ -122,6 +133,7 @@ local method_decoder = {
     min     = decode_get,
     max     = decode_get,
     count   = decode_count,
+    get_many = decode_get_many,
     inject  = decode_data,
     push    = decode_push,
 }
@@ -1344,6 +1356,11 @@ space_metatable = function(remote)
         return check_primary_index(self):get(key, opts)
     end
 
+    function methods:get_many(keys, opts)
+        check_space_arg(self, 'get_many')
+        return check_primary_index(self):get_many(keys, opts)
+    end
+
     function methods:format(format)
         if format == nil then
             return self._format
@@ -1378,6 +1395,16 @@ index_metatable = function(remote)
                                self.id, box.index.EQ, 0, 2, key))
     end
 
+    function methods:get_many(keys, opts)
+        check_index_arg(self, 'get_many')
+        if opts and opts.buffer then
+            error("index:get_many() doesn't support `buffer` argument")
+        end
+        local code = string.format('box.space.%s.index.%s:get_many',
+                                   self.space.name, self.name)
+        return remote:_request('get_many', opts, code, { keys })
+    end
+
     function methods:min(key, opts)
         check_index_arg(self, 'min')
         if opts and opts.buffer then
@@ -0,0 +1,313 @@
+
+/*
+ * Copyright 2010-2019, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include "box/lua/read_view.h"
+
+#include <strings.h>
+
+#include <lua.h>
+#include <lauxlib.h>
+#include <lualib.h>
+
+#include "diag.h"
+#include "fiber.h"
+#include "lua/utils.h"
+
+#include "box/box.h"
+#include "box/engine.h"
+#include "box/iterator_type.h"
+#include "box/memtx_engine.h"
+#include "box/memtx_tree.h"
+#include "box/schema.h"
+#include "box/lua/misc.h"
+#include "box/lua/tuple.h"
+
+static const char *read_view_typename = "box.read_view";
+static const char *read_view_iterator_typename = "box.read_view.iterator";
+
+static struct memtx_read_view **
+lbox_check_read_view(struct lua_State *L, int idx, const char *usage)
+{
+	if (lua_gettop(L) < idx)
+		luaL_error(L, "usage: %s", usage);
+	return (struct memtx_read_view **)luaL_checkudata(L, idx,
+							read_view_typename);
+}
+
+/**
+ * box.read_view() - create a consistent read view of all
+ * memtx spaces.
+ */
+static int
+lbox_read_view_new(struct lua_State *L)
+{
+	struct memtx_engine *memtx =
+		(struct memtx_engine *)engine_by_name("memtx");
+	assert(memtx != NULL);
+	struct memtx_read_view *rv = memtx_read_view_new(memtx);
+	if (rv == NULL)
+		return luaT_error(L);
+	struct memtx_read_view **ptr = (struct memtx_read_view **)
+		lua_newuserdata(L, sizeof(*ptr));
+	*ptr = rv;
+	luaL_getmetatable(L, read_view_typename);
+	lua_setmetatable(L, -2);
+	return 1;
+}
+
+static int
+lbox_read_view_close(struct lua_State *L)
+{
+	struct memtx_read_view **ptr =
+		lbox_check_read_view(L, 1, "read_view:close()");
+	if (*ptr != NULL) {
+		memtx_read_view_delete(*ptr);
+		*ptr = NULL;
+	}
+	return 0;
+}
+
+static int
+lbox_read_view_iterator_gc(struct lua_State *L)
+{
+	struct memtx_tree_view_iterator **ptr =
+		(struct memtx_tree_view_iterator **)luaL_checkudata(L, 1,
+					read_view_iterator_typename);
+	if (*ptr != NULL) {
+		memtx_tree_view_iterator_delete(*ptr);
+		*ptr = NULL;
+	}
+	return 0;
+}
+
+/**
+ * Iterator function returned by read_view:pairs().
+ * Upvalues are the read view and the index iterator.
+ */
+static int
+lbox_read_view_iterate(struct lua_State *L)
+{
+	struct memtx_read_view **ptr = (struct memtx_read_view **)
+		lua_touserdata(L, lua_upvalueindex(1));
+	struct memtx_tree_view_iterator **it =
+		(struct memtx_tree_view_iterator **)
+		lua_touserdata(L, lua_upvalueindex(2));
+	if (*ptr == NULL)
+		return luaL_error(L, "read view is closed");
+	if (*it == NULL)
+		return 0;
+	struct tuple *tuple = memtx_tree_view_iterator_next(*it);
+	if (tuple == NULL) {
+		memtx_tree_view_iterator_delete(*it);
+		*it = NULL;
+		return 0;
+	}
+	lua_pushinteger(L, lua_tointeger(L, 2) + 1);
+	/*
+	 * The tuple may have been deleted from the space, but
+	 * it is safe to reference it as long as the view is
+	 * open. The reference keeps it alive after the view
+	 * is closed, so no copy is needed.
+	 */
+	luaT_pushtuple(L, tuple);
+	return 2;
+}
+
+/**
+ * Get the id of a space or an index passed to read_view:pairs()
+ * by id, name or object. For an index, @a space_id is the id of
+ * the space it belongs to. Returns BOX_ID_NIL and sets diag if
+ * there's no space or index with the given name.
+ */
+static uint32_t
+lbox_read_view_check_id(struct lua_State *L, int idx, uint32_t space_id,
+			const char *usage)
+{
+	if (lua_istable(L, idx)) {
+		lua_getfield(L, idx, "id");
+		lua_replace(L, idx);
+	}
+	if (lua_type(L, idx) == LUA_TNUMBER)
+		return lua_tointeger(L, idx);
+	if (lua_type(L, idx) != LUA_TSTRING)
+		luaL_error(L, "usage: %s", usage);
+	size_t len;
+	const char *name = lua_tolstring(L, idx, &len);
+	if (space_id == BOX_ID_NIL) {
+		uint32_t id = box_space_id_by_name(name, len);
+		if (id == BOX_ID_NIL)
+			diag_set(ClientError, ER_NO_SUCH_SPACE, name);
+		return id;
+	}
+	uint32_t id = box_index_id_by_name(space_id, name, len);
+	if (id == BOX_ID_NIL) {
+		struct space *space = space_by_id(space_id);
+		diag_set(ClientError, ER_NO_SUCH_INDEX_NAME, name,
+			 space != NULL ? space_name(space) :
+			 int2str(space_id));
+	}
+	return id;
+}
+
+/**
+ * Get the iterator type passed to read_view:pairs() either as
+ * is or in an option table, like index:pairs() accepts it.
+ * Returns -1 and sets diag if the type is unknown.
+ */
+static int
+lbox_read_view_check_iterator(struct lua_State *L, int idx,
+			      enum iterator_type *type)
+{
+	*type = ITER_EQ;
+	if (lua_istable(L, idx)) {
+		lua_getfield(L, idx, "iterator");
+		lua_replace(L, idx);
+	}
+	if (lua_isnil(L, idx) || lua_isnone(L, idx))
+		return 0;
+	if (lua_type(L, idx) == LUA_TNUMBER) {
+		lua_Integer n = lua_tointeger(L, idx);
+		if (n >= 0 && n < iterator_type_MAX) {
+			*type = (enum iterator_type)n;
+			return 0;
+		}
+	} else if (lua_type(L, idx) == LUA_TSTRING) {
+		const char *name = lua_tostring(L, idx);
+		for (int i = 0; i < iterator_type_MAX; i++) {
+			if (strcasecmp(name, iterator_type_strs[i]) == 0) {
+				*type = (enum iterator_type)i;
+				return 0;
+			}
+		}
+	}
+	diag_set(ClientError, ER_ITERATOR_TYPE, luaT_tolstring(L, idx, NULL));
+	return -1;
+}
+
+/**
+ * read_view:pairs(space, [index, [key, [opts]]]) - iterate over
+ * tuples of an index matching a key as they were when the read
+ * view was created, like index:pairs() does. The space and the
+ * index may be given by id, name or object. The index defaults
+ * to the primary one, the key to an empty one. The iterator type
+ * is given in opts either as is or in the 'iterator' field.
+ *
+ * Any number of iterators may be open over the same view.
+ */
+static int
+lbox_read_view_pairs(struct lua_State *L)
+{
+	static const char usage[] =
+		"read_view:pairs(space, [index, [key, [opts]]])";
+	struct memtx_read_view **ptr = lbox_check_read_view(L, 1, usage);
+	if (*ptr == NULL)
+		return luaL_error(L, "read view is closed");
+	if (lua_gettop(L) < 2)
+		return luaL_error(L, "usage: %s", usage);
+	lua_settop(L, 5);
+	uint32_t space_id = lbox_read_view_check_id(L, 2, BOX_ID_NIL, usage);
+	if (space_id == BOX_ID_NIL)
+		return luaT_error(L);
+	uint32_t index_id = 0;
+	if (!lua_isnil(L, 3)) {
+		index_id = lbox_read_view_check_id(L, 3, space_id, usage);
+		if (index_id == BOX_ID_NIL)
+			return luaT_error(L);
+	}
+	enum iterator_type type;
+	if (lbox_read_view_check_iterator(L, 5, &type) != 0)
+		return luaT_error(L);
+	struct memtx_tree_view *view =
+		memtx_read_view_index(*ptr, space_id, index_id);
+	if (view == NULL)
+		return luaT_error(L);
+
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	const char *key = NULL;
+	uint32_t part_count = 0;
+	if (!lua_isnil(L, 4)) {
+		size_t key_len;
+		key = lbox_encode_tuple_on_gc(L, 4, &key_len);
+		part_count = mp_decode_array(&key);
+	}
+	struct memtx_tree_view_iterator **it =
+		(struct memtx_tree_view_iterator **)
+		lua_newuserdata(L, sizeof(*it));
+	*it = memtx_tree_view_iterator_new(view, type, key, part_count);
+	region_truncate(region, region_svp);
+	if (*it == NULL)
+		return luaT_error(L);
+	luaL_getmetatable(L, read_view_iterator_typename);
+	lua_setmetatable(L, -2);
+
+	lua_pushvalue(L, 1);
+	lua_insert(L, -2);
+	lua_pushcclosure(L, lbox_read_view_iterate, 2);
+	lua_pushnil(L);
+	lua_pushinteger(L, 0);
+	return 3;
+}
+
+static int
+lbox_read_view_tostring(struct lua_State *L)
+{
+	struct memtx_read_view **ptr = lbox_check_read_view(L, 1, "");
+	lua_pushstring(L, *ptr != NULL ? "read view" : "read view: closed");
+	return 1;
+}
+
+void
+box_lua_read_view_init(struct lua_State *L)
+{
+	static const struct luaL_Reg read_view_meta[] = {
+		{"__gc", lbox_read_view_close},
+		{"__tostring", lbox_read_view_tostring},
+		{"pairs", lbox_read_view_pairs},
+		{"close", lbox_read_view_close},
+		{NULL, NULL}
+	};
+	luaL_register_type(L, read_view_typename, read_view_meta);
+
+	static const struct luaL_Reg read_view_iterator_meta[] = {
+		{"__gc", lbox_read_view_iterator_gc},
+		{NULL, NULL}
+	};
+	luaL_register_type(L, read_view_iterator_typename,
+			   read_view_iterator_meta);
+
+	static const struct luaL_Reg boxlib[] = {
+		{"read_view", lbox_read_view_new},
+		{NULL, NULL}
+	};
+	luaL_register(L, "box", boxlib);
+	lua_pop(L, 1);
+}
@@ -431,6 +431,8 @@ box.schema.space.create = function(name, options)
         format = 'table',
         is_local = 'boolean',
         temporary = 'boolean',
+        compression = 'string',
+        field_offset_step = 'number',
     }
     local options_defaults = {
         engine = 'memtx',
@@ -475,6 +477,8 @@ box.schema.space.create = function(name, options)
     local space_options = setmap({
         group_id = options.is_local and 1 or nil,
         temporary = options.temporary and true or nil,
+        compression = options.compression,
+        field_offset_step = options.field_offset_step,
     })
     _space:insert{id, uid, name, options.engine, options.field_count,
         space_options, format}
@@ -756,6 +760,7 @@ local index_options = {
     unique = 'boolean',
     dimension = 'number',
     distance = 'string',
+    layout = 'string',
     run_count_per_level = 'number',
     run_size_ratio = 'number',
     range_size = 'number',
@@ -773,6 +778,7 @@ local alter_index_template = {
     type = 'string',
     parts = 'table',
     sequence = 'boolean, number, string',
+    func = 'number, string',
 }
 for k, v in pairs(index_options) do
     alter_index_template[k] = v
@@ -785,6 +791,34 @@ end
 local create_index_template = table.deepcopy(alter_index_template)
 create_index_template.if_not_exists = "boolean"
 
+--
+-- Find the function of a functional index by name or id and
+-- check that it can be used to compute index keys, i.e. it is
+-- a persistent deterministic Lua function. Returns the
+-- function id.
+--
+local function func_index_resolve(func, index_name, space_name)
+    local _vfunc = box.space[box.schema.VFUNC_ID]
+    local tuple
+    if type(func) == 'string' then
+        tuple = _vfunc.index.name:get{func}
+    else
+        tuple = _vfunc:get{func}
+    end
+    if tuple == nil then
+        box.error(box.error.NO_SUCH_FUNCTION, func)
+    end
+    local BODY = 6
+    local IS_DETERMINISTIC = 7
+    if tuple[BODY] == nil or tuple[BODY] == '' or
+       tuple[IS_DETERMINISTIC] ~= true then
+        box.error(box.error.MODIFY_INDEX, index_name, space_name,
+                  "function of a functional index must be persistent "..
+                  "and deterministic")
+    end
+    return tuple[1]
+end
+
 box.schema.index.create = function(space_id, name, options)
     check_param(space_id, 'space_id', 'number')
     check_param(name, 'name', 'string')
@@ -853,6 +887,13 @@ box.schema.index.create = function(space_id, name, options)
             end
         end
     end
+    local func_id
+    if options.func ~= nil then
+        func_id = func_index_resolve(options.func, name, space.name)
+        -- Parts of a functional index refer to the function
+        -- result, not to the space format.
+        format = {}
+    end
     local parts, parts_can_be_simplified =
         update_index_parts(format, options.parts)
     -- create_index() options contains type, parts, etc,
@@ -861,11 +902,13 @@ box.schema.index.create = function(space_id, name, options)
             dimension = options.dimension,
             unique = options.unique,
             distance = options.distance,
+            layout = options.layout,
             page_size = options.page_size,
             range_size = options.range_size,
             run_count_per_level = options.run_count_per_level,
             run_size_ratio = options.run_size_ratio,
             bloom_fpr = options.bloom_fpr,
+            func = func_id,
     }
     local field_type_aliases = {
         num = 'unsigned'; -- Deprecated since 1.7.2
@@ -1018,6 +1061,13 @@ box.schema.index.alter = function(space_id, index_id, options)
             index_opts[k] = options[k]
         end
     end
+    if options.func ~= nil then
+        index_opts.func = func_index_resolve(options.func, options.name,
+                                             space.name)
+    end
+    if index_opts.func ~= nil then
+        format = {}
+    end
     if options.parts then
         local parts_can_be_simplified
         parts, parts_can_be_simplified =
@@ -1366,6 +1416,18 @@ base_index_mt.get_luac = function(index, key)
     return internal.get(index.space_id, index.id, key)
 end
 
+base_index_mt.get_many = function(index, keys)
+    check_index_arg(index, 'get_many')
+    if type(keys) ~= 'table' then
+        box.error(box.error.PROC_LUA, "Usage: index:get_many({key, ...})")
+    end
+    local key_list = {}
+    for i = 1, #keys do
+        key_list[i] = keify(keys[i])
+    end
+    return internal.get_many(index.space_id, index.id, key_list)
+end
+
 local function check_select_opts(opts, key_is_nil)
     local offset = 0
     local limit = 4294967295
@@ -1419,6 +1481,11 @@ base_index_mt.delete = function(index, key)
     check_index_arg(index, 'delete')
     return internal.delete(index.space_id, index.id, keify(key));
 end
+base_index_mt.delete_range = function(index, begin_key, end_key)
+    check_index_arg(index, 'delete_range')
+    return internal.delete_range(index.space_id, index.id,
+                                 keify(begin_key), keify(end_key));
+end
 
 base_index_mt.stat = function(index)
     return internal.stat(index.space_id, index.id);
@@ -1485,6 +1552,10 @@ space_mt.get = function(space, key)
     check_space_arg(space, 'get')
     return check_primary_index(space):get(key)
 end
+space_mt.get_many = function(space, keys)
+    check_space_arg(space, 'get_many')
+    return check_primary_index(space):get_many(keys)
+end
 space_mt.select = function(space, key, opts)
     check_space_arg(space, 'select')
     return check_primary_index(space):select(key, opts)
@@ -1516,6 +1587,10 @@ space_mt.delete = function(space, key)
     check_space_arg(space, 'delete')
     return check_primary_index(space):delete(key)
 end
+space_mt.delete_range = function(space, begin_key, end_key)
+    check_space_arg(space, 'delete_range')
+    return check_primary_index(space):delete_range(begin_key, end_key)
+end
 -- Assumes that spaceno has a TREE (NUM) primary key
 -- inserts a tuple after getting the next value of the
 -- primary key and returns it back to the user
@@ -1981,7 +2056,9 @@ box.schema.func.create = function(name, opts)
     opts = opts or {}
     check_param_table(opts, { setuid = 'boolean',
                               if_not_exists = 'boolean',
-                              language = 'string'})
+                              language = 'string',
+                              body = 'string',
+                              is_deterministic = 'boolean'})
     local _func = box.space[box.schema.FUNC_ID]
     local _vfunc = box.space[box.schema.VFUNC_ID]
     local func = _vfunc.index.name:get{name}
@@ -1994,7 +2071,14 @@ box.schema.func.create = function(name, opts)
     opts = update_param_table(opts, { setuid = false, language = 'lua'})
     opts.language = string.upper(opts.language)
     opts.setuid = opts.setuid and 1 or 0
-    _func:auto_increment{session.euid(), name, opts.setuid, opts.language}
+    local tuple = {session.euid(), name, opts.setuid, opts.language}
+    -- Optional fields are appended only if set, so that
+    -- definitions of ordinary functions don't change.
+    if opts.body ~= nil or opts.is_deterministic ~= nil then
+        table.insert(tuple, opts.body or '')
+        table.insert(tuple, opts.is_deterministic or false)
+    end
+    _func:auto_increment(tuple)
 end
 
 box.schema.func.drop = function(name, opts)
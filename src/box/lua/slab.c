@@ -228,6 +228,26 @@ lbox_slab_info(struct lua_State *L)
 	lua_pushstring(L, ratio_buf);
 	lua_settable(L, -3);
 
+	/*
+	 * Size of pages backing the arena and the number of
+	 * huge pages in use, see box.cfg.memtx_huge_pages.
+	 */
+	struct tuple_arena_page_stat page_stat;
+	tuple_arena_page_stat(&memtx->arena, &memtx->arena_opts, &page_stat);
+
+	lua_pushstring(L, "arena_page_size");
+	luaL_pushuint64(L, page_stat.page_size);
+	lua_settable(L, -3);
+
+	lua_pushstring(L, "arena_huge_pages");
+	luaL_pushuint64(L, page_stat.huge_pages);
+	lua_settable(L, -3);
+
+	lua_pushstring(L, "arena_numa_policy");
+	lua_pushstring(L, tuple_arena_numa_policy_strs[
+			memtx->arena_opts.numa_policy]);
+	lua_settable(L, -3);
+
 	return 1;
 }
 
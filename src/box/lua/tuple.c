@@ -40,6 +40,7 @@
 
 #include "box/tuple.h"
 #include "box/tuple_convert.h"
+#include "box/tuple_compression.h"
 #include "box/errcode.h"
 #include "json/json.h"
 #include "mpstream.h"
@@ -255,10 +256,16 @@ luamp_encode_tuple(struct lua_State *L, struct luaL_serializer *cfg,
 void
 tuple_to_mpstream(struct tuple *tuple, struct mpstream *stream)
 {
-	size_t bsize = box_tuple_bsize(tuple);
-	char *ptr = mpstream_reserve(stream, bsize);
-	box_tuple_to_buf(tuple, ptr, bsize);
-	mpstream_advance(stream, bsize);
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	uint32_t bsize;
+	const char *data = tuple_data_range_decompressed(tuple, &bsize);
+	if (data == NULL) {
+		stream->error(stream->error_ctx);
+		return;
+	}
+	mpstream_memcpy(stream, data, bsize);
+	region_truncate(region, region_svp);
 }
 
 /* A MsgPack extensions handler that supports tuples */
@@ -275,6 +282,24 @@ luamp_encode_extension_box(struct lua_State *L, int idx,
 	return MP_EXT;
 }
 
+/* A MsgPack extensions handler that decompresses tuple fields */
+static void
+luamp_decode_extension_box(struct lua_State *L, const char **data)
+{
+	if (!mp_is_compressed(*data)) {
+		luaL_error(L, "msgpack.decode: unsupported extension: %u",
+			   (unsigned char) **data);
+	}
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	uint32_t size;
+	const char *field = mp_decompress(data, &size);
+	if (field == NULL)
+		luaT_error(L);
+	luamp_decode(L, luaL_msgpack_default, &field);
+	region_truncate(region, region_svp);
+}
+
 /**
  * Convert a tuple into lua table. Named fields are stored as
  * {name = value} pairs. Not named fields are stored as
@@ -539,6 +564,7 @@ box_lua_tuple_init(struct lua_State *L)
 	lua_pop(L, 1);
 
 	luamp_set_encode_extension(luamp_encode_extension_box);
+	luamp_set_decode_extension(luamp_decode_extension_box);
 
 	/*
 	 * Create special serializer for box.tuple.new().
@@ -36,9 +36,11 @@
 #include <small/mempool.h>
 
 #include "fiber.h"
+#include "cbus.h"
 #include "errinj.h"
 #include "coio_file.h"
 #include "tuple.h"
+#include "tuple_compression.h"
 #include "txn.h"
 #include "memtx_tree.h"
 #include "iproto_constants.h"
@@ -106,16 +108,81 @@ memtx_init_txn(struct txn *txn)
 
 struct memtx_tuple {
 	/*
-	 * sic: the header of the tuple is used
-	 * to store a free list pointer in smfree_delayed.
+	 * sic: the header of the tuple is used to link
+	 * the tuple into a garbage list after it has been
+	 * deleted, see memtx_tuple_set_next_garbage().
 	 * Please don't change it without understanding
-	 * how smfree_delayed and snapshotting COW works.
+	 * how read views and snapshotting COW work.
 	 */
 	/** Snapshot generation version. */
 	uint32_t version;
+	/**
+	 * High bits of the garbage list link, see
+	 * memtx_tuple_set_next_garbage(). Takes what would
+	 * otherwise be padding at the end of the struct.
+	 */
+	uint16_t garbage_link_hi;
 	struct tuple base;
 };
 
+/**
+ * Return the size of memory allocated for a tuple. The field
+ * map may be longer than tuple_format::field_map_size, see
+ * tuple_format::offset_step.
+ */
+static inline size_t
+memtx_tuple_size(struct memtx_tuple *memtx_tuple)
+{
+	return sizeof(struct memtx_tuple) - sizeof(struct tuple) +
+	       tuple_size(&memtx_tuple->base);
+}
+
+/**
+ * Tuples deleted while memtx_engine::snapshot_version was equal
+ * to @version. They may be visible from read views created
+ * before, so they are freed only when all such views have been
+ * closed, see memtx_engine_free_garbage().
+ */
+struct memtx_tuple_garbage {
+	/** Link in memtx_engine::tuple_garbage. */
+	struct stailq_entry in_tuple_garbage;
+	/** Value of memtx_engine::snapshot_version. */
+	uint32_t version;
+	/** Deleted tuples, see memtx_tuple_next_garbage(). */
+	struct memtx_tuple *first;
+};
+
+/**
+ * Link a deleted tuple to the next one in a garbage list. The
+ * link is stored in the version, which is of no use after
+ * deletion, and garbage_link_hi, while the tuple size, format
+ * and data are left intact for read view readers. User space
+ * pointers fit in 48 bits on all supported platforms.
+ *
+ * The list holds a reference to the tuple so that a read view
+ * reader may reference it as well, see box.read_view(), without
+ * deleting it once again when the reference is dropped.
+ */
+static inline void
+memtx_tuple_set_next_garbage(struct memtx_tuple *tuple,
+			     struct memtx_tuple *next)
+{
+	uint64_t link = (uintptr_t)next;
+	assert(link >> 48 == 0);
+	assert(tuple->base.refs == 0);
+	tuple->version = (uint32_t)link;
+	tuple->garbage_link_hi = (uint16_t)(link >> 32);
+	tuple->base.refs = 1;
+}
+
+static inline struct memtx_tuple *
+memtx_tuple_next_garbage(struct memtx_tuple *tuple)
+{
+	uint64_t link = (uint64_t)tuple->garbage_link_hi << 32 |
+			tuple->version;
+	return (struct memtx_tuple *)(uintptr_t)link;
+}
+
 enum {
 	OBJSIZE_MIN = 16,
 	SLAB_SIZE = 16 * 1024 * 1024,
@@ -135,11 +202,24 @@ memtx_end_build_primary_key(struct space *space, void *param)
 	return 0;
 }
 
+static int
+memtx_build_secondary_key_f(va_list ap)
+{
+	struct index *index = va_arg(ap, struct index *);
+	struct index *pk = va_arg(ap, struct index *);
+	return index_build(index, pk);
+}
+
 /**
  * Secondary indexes are built in bulk after all data is
  * recovered. This function enables secondary keys on a space.
  * Data dictionary spaces are an exception, they are fully
  * built right from the start.
+ *
+ * Each secondary index is built in its own fiber. Indexes
+ * are independent of each other and the expensive part of
+ * a build (sorting) is done in coio threads, so this way
+ * indexes of the same space are sorted in parallel.
  */
 static int
 memtx_build_secondary_keys(struct space *space, void *param)
@@ -159,10 +239,27 @@ memtx_build_secondary_keys(struct space *space, void *param)
 				 space_name(space));
 		}
 
+		struct fiber *fibers[BOX_INDEX_MAX];
+		uint32_t fiber_count = 0;
+		int rc = 0;
 		for (uint32_t j = 1; j < space->index_count; j++) {
-			if (index_build(space->index[j], pk) < 0)
-				return -1;
+			struct fiber *f = fiber_new("build_index",
+					memtx_build_secondary_key_f);
+			if (f == NULL) {
+				rc = -1;
+				break;
+			}
+			fiber_set_joinable(f, true);
+			fibers[fiber_count++] = f;
+			fiber_start(f, space->index[j], pk);
 		}
+		/* Wait for all started builds even if some failed. */
+		for (uint32_t j = 0; j < fiber_count; j++) {
+			if (fiber_join(fibers[j]) != 0)
+				rc = -1;
+		}
+		if (rc != 0)
+			return -1;
 
 		if (n_tuples > 0) {
 			say_info("Space '%s': done", space_name(space));
@@ -176,6 +273,11 @@ static void
 memtx_engine_shutdown(struct engine *engine)
 {
 	struct memtx_engine *memtx = (struct memtx_engine *)engine;
+	/* Deleted tuples are freed along with the allocator. */
+	struct memtx_tuple_garbage *garbage, *next;
+	stailq_foreach_entry_safe(garbage, next, &memtx->tuple_garbage,
+				  in_tuple_garbage)
+		free(garbage);
 	mempool_destroy(&memtx->iterator_pool);
 	if (mempool_is_initialized(&memtx->rtree_iterator_pool))
 		mempool_destroy(&memtx->rtree_iterator_pool);
@@ -192,44 +294,312 @@ static int
 memtx_engine_recover_snapshot_row(struct memtx_engine *memtx,
 				  struct xrow_header *row);
 
-int
-memtx_engine_recover_snapshot(struct memtx_engine *memtx,
-			      const struct vclock *vclock)
+/**
+ * Snapshot recovery is pipelined: each snapshot file is read by
+ * a separate thread, which decompresses and decodes rows and
+ * sends them to tx in batches over cbus. Tx only has to allocate
+ * tuples and insert them into primary keys. The main snapshot
+ * file, which holds the schema, is loaded first, then all its
+ * chunks are loaded in parallel, see box.cfg.memtx_snap_threads.
+ */
+
+/** Max number of rows a snapshot reader sends to tx at once. */
+enum { MEMTX_SNAP_BATCH_SIZE = 512 };
+
+/** Max number of row batches a snapshot reader may allocate. */
+enum { MEMTX_SNAP_BATCH_COUNT = 4 };
+
+struct memtx_snap_loader;
+
+/** A snapshot row decoded by a reader thread. */
+struct memtx_snap_row {
+	struct xrow_header header;
+	struct request request;
+};
+
+/** A batch of rows sent by a reader thread to tx. */
+struct memtx_snap_batch {
+	struct cmsg base;
+	struct memtx_snap_reader *reader;
+	/** Set by tx if the reader must stop reading. */
+	bool stop;
+	/** Link in memtx_snap_reader::free_batches. */
+	struct stailq_entry in_free;
+	/** Copies of row bodies, allocated by the reader. */
+	struct region data;
+	int row_count;
+	struct memtx_snap_row rows[MEMTX_SNAP_BATCH_SIZE];
+};
+
+/** A thread reading one snapshot file. */
+struct memtx_snap_reader {
+	struct memtx_snap_loader *loader;
+	char filename[PATH_MAX];
+	/** Number of the chunk file, 0 for the main file. */
+	uint32_t chunk_no;
+	/**
+	 * Number of additional chunk files, read from
+	 * the header of the main file.
+	 */
+	uint32_t chunk_count;
+	struct cord cord;
+	/** Reader endpoint, receives batches returned by tx. */
+	char endpoint_name[FIBER_NAME_MAX];
+	struct cbus_endpoint endpoint;
+	/** Pipe to tx, used by the reader thread. */
+	struct cpipe tx_pipe;
+	/** Pipe to the reader, used by tx. */
+	struct cpipe reader_pipe;
+	/** Apply a batch in tx and return it to the reader. */
+	struct cmsg_hop batch_route[2];
+	/** Tell tx that the reader has sent all its rows. */
+	struct cmsg_hop done_route[1];
+	struct cmsg done_msg;
+	/** Batches not sent to tx, used by the reader thread. */
+	struct stailq free_batches;
+	/** Number of allocated batches. */
+	int batch_count;
+	/** Number of batches sent to tx and not returned yet. */
+	int batches_in_flight;
+	/** Set if tx asked the reader to stop. */
+	bool is_stopped;
+};
+
+/** Tx side of snapshot recovery. */
+struct memtx_snap_loader {
+	struct memtx_engine *memtx;
+	const struct vclock *vclock;
+	/** Tx endpoint, receives batches sent by readers. */
+	struct cbus_endpoint endpoint;
+	/** Number of readers that haven't sent all rows yet. */
+	int active_readers;
+	/** Number of rows loaded so far. */
+	uint64_t row_count;
+	/** Set on the first error, which is stored in @diag. */
+	bool is_failed;
+	struct diag diag;
+};
+
+static int
+memtx_engine_apply_snapshot_request(struct memtx_engine *memtx,
+				    struct request *request);
+
+static void
+memtx_snap_loader_fail(struct memtx_snap_loader *loader)
 {
-	/* Process existing snapshot */
-	say_info("recovery start");
-	int64_t signature = vclock_sum(vclock);
-	const char *filename = xdir_format_filename(&memtx->snap_dir,
-						    signature, NONE);
+	if (!loader->is_failed) {
+		loader->is_failed = true;
+		diag_move(diag_get(), &loader->diag);
+	}
+}
+
+/** Apply a batch of rows sent by a reader. Called in tx. */
+static void
+memtx_snap_batch_apply(struct cmsg *msg)
+{
+	struct memtx_snap_batch *batch = (struct memtx_snap_batch *)msg;
+	struct memtx_snap_loader *loader = batch->reader->loader;
+	struct memtx_engine *memtx = loader->memtx;
+	for (int i = 0; i < batch->row_count && !loader->is_failed; i++) {
+		struct request *request = &batch->rows[i].request;
+		if (memtx_engine_apply_snapshot_request(memtx, request) != 0) {
+			if (!memtx->force_recovery) {
+				memtx_snap_loader_fail(loader);
+				break;
+			}
+			say_error("can't apply row: ");
+			diag_log();
+		}
+		if (++loader->row_count % 100000 == 0) {
+			say_info("%.1fM rows processed",
+				 loader->row_count / 1000000.);
+		}
+	}
+	batch->stop = loader->is_failed;
+}
+
+/** Take back a batch applied by tx. Called in the reader. */
+static void
+memtx_snap_batch_return(struct cmsg *msg)
+{
+	struct memtx_snap_batch *batch = (struct memtx_snap_batch *)msg;
+	struct memtx_snap_reader *reader = batch->reader;
+	if (batch->stop)
+		reader->is_stopped = true;
+	region_truncate(&batch->data, 0);
+	batch->row_count = 0;
+	stailq_add_entry(&reader->free_batches, batch, in_free);
+	reader->batches_in_flight--;
+}
+
+/** A reader has sent all its rows. Called in tx. */
+static void
+memtx_snap_reader_done(struct cmsg *msg)
+{
+	struct memtx_snap_reader *reader =
+		container_of(msg, struct memtx_snap_reader, done_msg);
+	reader->loader->active_readers--;
+}
+
+static void
+memtx_snap_reader_create(struct memtx_snap_reader *reader,
+			 struct memtx_snap_loader *loader, uint32_t chunk_no)
+{
+	struct memtx_engine *memtx = loader->memtx;
+	reader->loader = loader;
+	reader->chunk_no = chunk_no;
+	reader->chunk_count = 0;
+	snprintf(reader->filename, sizeof(reader->filename), "%s",
+		 xdir_format_chunk_filename(&memtx->snap_dir,
+					    vclock_sum(loader->vclock),
+					    chunk_no, NONE));
+	snprintf(reader->endpoint_name, sizeof(reader->endpoint_name),
+		 "snapshot_reader.%u", (unsigned)chunk_no);
+	reader->batch_route[0].f = memtx_snap_batch_apply;
+	reader->batch_route[0].pipe = &reader->reader_pipe;
+	reader->batch_route[1].f = memtx_snap_batch_return;
+	reader->batch_route[1].pipe = NULL;
+	reader->done_route[0].f = memtx_snap_reader_done;
+	reader->done_route[0].pipe = NULL;
+	cmsg_init(&reader->done_msg, reader->done_route);
+	stailq_create(&reader->free_batches);
+	reader->batch_count = 0;
+	reader->batches_in_flight = 0;
+	reader->is_stopped = false;
+}
+
+/**
+ * Get a batch to fill with rows. Waits for tx to return a batch
+ * if all of them are in flight. Returns NULL if tx asked to stop
+ * or on memory allocation error.
+ */
+static struct memtx_snap_batch *
+memtx_snap_reader_get_batch(struct memtx_snap_reader *reader)
+{
+	while (true) {
+		cbus_process(&reader->endpoint);
+		if (reader->is_stopped)
+			return NULL;
+		if (!stailq_empty(&reader->free_batches)) {
+			return stailq_shift_entry(&reader->free_batches,
+					struct memtx_snap_batch, in_free);
+		}
+		if (reader->batch_count < MEMTX_SNAP_BATCH_COUNT)
+			break;
+		fiber_yield();
+	}
+	struct memtx_snap_batch *batch = malloc(sizeof(*batch));
+	if (batch == NULL) {
+		diag_set(OutOfMemory, sizeof(*batch), "malloc",
+			 "struct memtx_snap_batch");
+		return NULL;
+	}
+	cmsg_init(&batch->base, reader->batch_route);
+	batch->reader = reader;
+	batch->stop = false;
+	region_create(&batch->data, &cord()->slabc);
+	batch->row_count = 0;
+	reader->batch_count++;
+	return batch;
+}
+
+static void
+memtx_snap_reader_send_batch(struct memtx_snap_reader *reader,
+			     struct memtx_snap_batch *batch)
+{
+	if (batch->row_count == 0) {
+		stailq_add_entry(&reader->free_batches, batch, in_free);
+		return;
+	}
+	reader->batches_in_flight++;
+	cpipe_push(&reader->tx_pipe, &batch->base);
+}
+
+/**
+ * Decode a row and append it to a batch. The row body is copied,
+ * because the cursor reuses its buffer for the next rows.
+ */
+static int
+memtx_snap_batch_add_row(struct memtx_snap_batch *batch,
+			 struct xrow_header *row)
+{
+	assert(row->bodycnt == 1); /* always 1 for read */
+	if (row->type != IPROTO_INSERT) {
+		diag_set(ClientError, ER_UNKNOWN_REQUEST_TYPE,
+			 (uint32_t) row->type);
+		return -1;
+	}
+	size_t size = row->body[0].iov_len;
+	char *body = region_alloc(&batch->data, size);
+	if (body == NULL) {
+		diag_set(OutOfMemory, size, "region", "snapshot row");
+		return -1;
+	}
+	memcpy(body, row->body[0].iov_base, size);
+	struct memtx_snap_row *entry = &batch->rows[batch->row_count];
+	entry->header = *row;
+	entry->header.body[0].iov_base = body;
+	if (xrow_decode_dml(&entry->header, &entry->request,
+			    dml_request_key_map(row->type)) != 0)
+		return -1;
+	batch->row_count++;
+	return 0;
+}
 
-	say_info("recovering from `%s'", filename);
+/** Read the snapshot file and send its rows to tx. */
+static int
+memtx_snap_reader_read(struct memtx_snap_reader *reader)
+{
+	struct memtx_snap_loader *loader = reader->loader;
+	bool force_recovery = loader->memtx->force_recovery;
+	int64_t signature = vclock_sum(loader->vclock);
+
+	say_info("recovering from `%s'", reader->filename);
 	struct xlog_cursor cursor;
-	if (xlog_cursor_open(&cursor, filename) < 0)
+	if (xlog_cursor_open(&cursor, reader->filename) < 0)
+		return -1;
+
+	if (reader->chunk_no == 0) {
+		reader->chunk_count = cursor.meta.chunk_count;
+	} else if (vclock_compare(&cursor.meta.vclock, loader->vclock) != 0) {
+		xlog_cursor_close(&cursor, false);
+		diag_set(XlogError, "snapshot chunk `%s' doesn't match "
+			 "the snapshot", reader->filename);
 		return -1;
+	}
 
 	int rc;
 	struct xrow_header row;
-	uint64_t row_count = 0;
-	while ((rc = xlog_cursor_next(&cursor, &row,
-				      memtx->force_recovery)) == 0) {
+	struct memtx_snap_batch *batch = NULL;
+	while ((rc = xlog_cursor_next(&cursor, &row, force_recovery)) == 0) {
+		if (batch == NULL) {
+			batch = memtx_snap_reader_get_batch(reader);
+			if (batch == NULL) {
+				rc = reader->is_stopped ? 0 : -1;
+				break;
+			}
+		}
 		row.lsn = signature;
-		rc = memtx_engine_recover_snapshot_row(memtx, &row);
-		if (rc < 0) {
-			if (!memtx->force_recovery)
+		if (memtx_snap_batch_add_row(batch, &row) != 0) {
+			if (!force_recovery) {
+				rc = -1;
 				break;
+			}
 			say_error("can't apply row: ");
 			diag_log();
 		}
-		++row_count;
-		if (row_count % 100000 == 0) {
-			say_info("%.1fM rows processed",
-				 row_count / 1000000.);
-			fiber_yield_timeout(0);
+		if (batch->row_count == MEMTX_SNAP_BATCH_SIZE) {
+			memtx_snap_reader_send_batch(reader, batch);
+			batch = NULL;
 		}
 	}
+	if (batch != NULL)
+		memtx_snap_reader_send_batch(reader, batch);
 	xlog_cursor_close(&cursor, false);
 	if (rc < 0)
 		return -1;
+	if (reader->is_stopped)
+		return 0;
 
 	/**
 	 * We should never try to read snapshots with no EOF
@@ -237,11 +607,140 @@ memtx_engine_recover_snapshot(struct memtx_engine *memtx,
 	 * should not be trusted.
 	 */
 	if (!xlog_cursor_is_eof(&cursor))
-		panic("snapshot `%s' has no EOF marker", filename);
+		panic("snapshot `%s' has no EOF marker", reader->filename);
+
+	return 0;
+}
+
+static int
+memtx_snap_reader_f(va_list ap)
+{
+	struct memtx_snap_reader *reader =
+		va_arg(ap, struct memtx_snap_reader *);
+	cbus_endpoint_create(&reader->endpoint, reader->endpoint_name,
+			     fiber_schedule_cb, fiber());
+	cpipe_create(&reader->tx_pipe, reader->loader->endpoint.name);
+	/* Deliver each batch right away to keep tx busy. */
+	cpipe_set_max_input(&reader->tx_pipe, 1);
+
+	int rc = memtx_snap_reader_read(reader);
+
+	/* Batches refer to the reader memory, wait for all of them. */
+	while (reader->batches_in_flight > 0) {
+		cbus_process(&reader->endpoint);
+		if (reader->batches_in_flight > 0)
+			fiber_yield();
+	}
+	cpipe_push(&reader->tx_pipe, &reader->done_msg);
+	cpipe_destroy(&reader->tx_pipe);
+	cbus_endpoint_destroy(&reader->endpoint, cbus_process);
+
+	struct memtx_snap_batch *batch, *next;
+	stailq_foreach_entry_safe(batch, next, &reader->free_batches,
+				  in_free) {
+		region_destroy(&batch->data);
+		free(batch);
+	}
+	return rc;
+}
 
+/**
+ * Load snapshot files with one reader thread per file and
+ * wait until all of them are loaded.
+ */
+static int
+memtx_snap_loader_run(struct memtx_snap_loader *loader,
+		      struct memtx_snap_reader *readers, int reader_count)
+{
+	cbus_endpoint_create(&loader->endpoint, "snapshot_loader",
+			     fiber_schedule_cb, fiber());
+	int started = 0;
+	for (; started < reader_count; started++) {
+		struct memtx_snap_reader *reader = &readers[started];
+		if (cord_costart(&reader->cord, reader->endpoint_name,
+				 memtx_snap_reader_f, reader) != 0) {
+			/* Readers started so far will be stopped. */
+			memtx_snap_loader_fail(loader);
+			break;
+		}
+		cpipe_create(&reader->reader_pipe, reader->endpoint_name);
+	}
+	loader->active_readers = started;
+	while (loader->active_readers > 0) {
+		cbus_process(&loader->endpoint);
+		if (loader->active_readers > 0)
+			fiber_yield();
+	}
+	for (int i = 0; i < started; i++)
+		cpipe_destroy(&readers[i].reader_pipe);
+	cbus_endpoint_destroy(&loader->endpoint, cbus_process);
+	for (int i = 0; i < started; i++) {
+		if (cord_cojoin(&readers[i].cord) != 0)
+			memtx_snap_loader_fail(loader);
+	}
+	if (loader->is_failed) {
+		diag_move(&loader->diag, diag_get());
+		return -1;
+	}
 	return 0;
 }
 
+int
+memtx_engine_recover_snapshot(struct memtx_engine *memtx,
+			      const struct vclock *vclock)
+{
+	/* Process existing snapshot */
+	say_info("recovery start");
+	struct memtx_snap_loader loader;
+	loader.memtx = memtx;
+	loader.vclock = vclock;
+	loader.active_readers = 0;
+	loader.row_count = 0;
+	loader.is_failed = false;
+	diag_create(&loader.diag);
+
+	int rc = -1;
+	/*
+	 * Readers are big, so allocate one for each possible
+	 * chunk file at once.
+	 */
+	size_t size = sizeof(struct memtx_snap_reader) *
+		      MEMTX_SNAP_THREADS_MAX;
+	struct memtx_snap_reader *readers = malloc(size);
+	if (readers == NULL) {
+		diag_set(OutOfMemory, size, "malloc",
+			 "struct memtx_snap_reader");
+		goto out;
+	}
+	memtx_snap_reader_create(&readers[0], &loader, 0);
+	if (memtx_snap_loader_run(&loader, &readers[0], 1) != 0)
+		goto out;
+	/*
+	 * The main file contains the schema and must be loaded
+	 * first. The other chunks store tuples of user spaces
+	 * in no particular order, which is fine since primary
+	 * keys are sorted after loading.
+	 */
+	uint32_t chunk_count = readers[0].chunk_count;
+	if (chunk_count >= MEMTX_SNAP_THREADS_MAX) {
+		diag_set(XlogError, "snapshot `%s' has too many chunks",
+			 readers[0].filename);
+		goto out;
+	}
+	if (chunk_count > 0) {
+		for (uint32_t i = 1; i <= chunk_count; i++)
+			memtx_snap_reader_create(&readers[i], &loader, i);
+		if (memtx_snap_loader_run(&loader, &readers[1],
+					  chunk_count) != 0)
+			goto out;
+	}
+	rc = 0;
+out:
+	free(readers);
+	diag_destroy(&loader.diag);
+	return rc;
+}
+
 static int
 memtx_engine_recover_snapshot_row(struct memtx_engine *memtx,
 				  struct xrow_header *row)
@@ -256,7 +755,15 @@ memtx_engine_recover_snapshot_row(struct memtx_engine *memtx,
 	struct request request;
 	if (xrow_decode_dml(row, &request, dml_request_key_map(row->type)) != 0)
 		return -1;
-	struct space *space = space_cache_find(request.space_id);
+	return memtx_engine_apply_snapshot_request(memtx, &request);
+}
+
+/** Insert a decoded snapshot row into its space. */
+static int
+memtx_engine_apply_snapshot_request(struct memtx_engine *memtx,
+				    struct request *request)
+{
+	struct space *space = space_cache_find(request->space_id);
 	if (space == NULL)
 		return -1;
 	/* memtx snapshot must contain only memtx spaces */
@@ -265,7 +772,7 @@ memtx_engine_recover_snapshot_row(struct memtx_engine *memtx,
 		return -1;
 	}
 	/* no access checks here - applier always works with admin privs */
-	if (space_apply_initial_join_row(space, &request) != 0)
+	if (space_apply_initial_join_row(space, request) != 0)
 		return -1;
 	/*
 	 * Don't let gc pool grow too much. Yet to
@@ -417,6 +924,22 @@ memtx_engine_begin_statement(struct engine *engine, struct txn *txn)
 	return 0;
 }
 
+static void
+memtx_engine_commit(struct engine *engine, struct txn *txn)
+{
+	(void)engine;
+	/*
+	 * Tuples deleted by the transaction won't be put back
+	 * so functional indexes don't need their keys anymore.
+	 */
+	struct txn_stmt *stmt;
+	stailq_foreach_entry(stmt, &txn->stmts, next) {
+		if (stmt->engine_savepoint != NULL && stmt->old_tuple != NULL)
+			memtx_space_forget_func_keys(stmt->space,
+						     stmt->old_tuple);
+	}
+}
+
 static void
 memtx_engine_rollback_statement(struct engine *engine, struct txn *txn,
 				struct txn_stmt *stmt)
@@ -451,6 +974,9 @@ memtx_engine_rollback_statement(struct engine *engine, struct txn *txn,
 			panic("failed to rollback change");
 		}
 	}
+	memtx_space_rollback_build(space, stmt);
+	if (stmt->new_tuple != NULL)
+		memtx_space_forget_func_keys(space, stmt->new_tuple);
 
 	memtx_space_update_bsize(space, stmt->new_tuple, stmt->old_tuple);
 	if (stmt->old_tuple != NULL)
@@ -506,7 +1032,7 @@ checkpoint_write_row(struct xlog *l, struct xrow_header *row)
 	if (errinj != NULL && errinj->dparam > 0)
 		usleep(errinj->dparam * 1000000);
 
-	static ev_tstamp last = 0;
+	static __thread ev_tstamp last = 0;
 	if (last == 0) {
 		ev_now_update(loop());
 		last = ev_now(loop());
@@ -565,12 +1091,58 @@ struct checkpoint_entry {
 	struct rlist link;
 };
 
+/**
+ * Max number of tuples a snapshot writer takes from
+ * the iterators shared with other writers at once.
+ */
+enum { CHECKPOINT_BATCH_SIZE = 256 };
+
+/** A tuple taken by a snapshot writer, see checkpoint_take_rows(). */
+struct checkpoint_row {
+	struct space *space;
+	const char *data;
+	uint32_t size;
+};
+
+/**
+ * A thread writing an additional chunk of a snapshot,
+ * see box.cfg.memtx_snap_threads.
+ */
+struct checkpoint_writer {
+	struct checkpoint *ckpt;
+	/** Number of the chunk file written by this thread. */
+	uint32_t chunk_no;
+	struct cord cord;
+};
+
 struct checkpoint {
 	/**
-	 * List of MemTX spaces to snapshot, with consistent
-	 * read view iterators.
+	 * List of MemTX system spaces to snapshot, with
+	 * consistent read view iterators. They are written
+	 * to the main snapshot file so that the schema is
+	 * recovered before any user data.
+	 */
+	struct rlist system_entries;
+	/**
+	 * List of MemTX user spaces to snapshot, with
+	 * consistent read view iterators. The iterators
+	 * are shared by all snapshot writers.
 	 */
 	struct rlist entries;
+	/**
+	 * Entry of @entries the writers take tuples from,
+	 * NULL if all tuples have been taken.
+	 */
+	struct checkpoint_entry *next_entry;
+	/** Protects @next_entry and its iterator. */
+	pthread_mutex_t mutex;
+	/**
+	 * Number of threads writing the snapshot, each to
+	 * its own file. The main file is written by the
+	 * checkpoint cord, the others by @writers.
+	 */
+	int writer_count;
+	struct checkpoint_writer *writers;
 	uint64_t snap_io_rate_limit;
 	struct cord cord;
 	bool waiting_for_snap_thread;
@@ -582,18 +1154,37 @@ struct checkpoint {
 	 * checkpoint already exists.
 	 */
 	bool touch;
+	/** Memory pinned for the frozen indexes. */
+	struct memtx_read_view_version read_view;
 };
 
 static struct checkpoint *
-checkpoint_new(const char *snap_dirname, uint64_t snap_io_rate_limit)
+checkpoint_new(const char *snap_dirname, uint64_t snap_io_rate_limit,
+	       int writer_count)
 {
+	assert(writer_count >= 1);
 	struct checkpoint *ckpt = malloc(sizeof(*ckpt));
 	if (ckpt == NULL) {
 		diag_set(OutOfMemory, sizeof(*ckpt), "malloc",
 			 "struct checkpoint");
 		return NULL;
 	}
+	ckpt->writers = NULL;
+	if (writer_count > 1) {
+		size_t size = sizeof(*ckpt->writers) * (writer_count - 1);
+		ckpt->writers = malloc(size);
+		if (ckpt->writers == NULL) {
+			diag_set(OutOfMemory, size, "malloc",
+				 "struct checkpoint_writer");
+			free(ckpt);
+			return NULL;
+		}
+	}
+	ckpt->writer_count = writer_count;
+	rlist_create(&ckpt->system_entries);
 	rlist_create(&ckpt->entries);
+	ckpt->next_entry = NULL;
+	tt_pthread_mutex_init(&ckpt->mutex, NULL);
 	ckpt->waiting_for_snap_thread = false;
 	xdir_create(&ckpt->dir, snap_dirname, SNAP, &INSTANCE_UUID);
 	ckpt->snap_io_rate_limit = snap_io_rate_limit;
@@ -606,11 +1197,17 @@ static void
 checkpoint_delete(struct checkpoint *ckpt)
 {
 	struct checkpoint_entry *entry, *tmp;
+	rlist_foreach_entry_safe(entry, &ckpt->system_entries, link, tmp) {
+		entry->iterator->free(entry->iterator);
+		free(entry);
+	}
 	rlist_foreach_entry_safe(entry, &ckpt->entries, link, tmp) {
 		entry->iterator->free(entry->iterator);
 		free(entry);
 	}
+	tt_pthread_mutex_destroy(&ckpt->mutex);
 	xdir_destroy(&ckpt->dir);
+	free(ckpt->writers);
 	free(ckpt);
 }
 
@@ -632,7 +1229,10 @@ checkpoint_add_space(struct space *sp, void *data)
 			 "malloc", "struct checkpoint_entry");
 		return -1;
 	}
-	rlist_add_tail_entry(&ckpt->entries, entry, link);
+	if (space_is_system(sp))
+		rlist_add_tail_entry(&ckpt->system_entries, entry, link);
+	else
+		rlist_add_tail_entry(&ckpt->entries, entry, link);
 
 	entry->space = sp;
 	entry->iterator = index_create_snapshot_iterator(pk);
@@ -642,87 +1242,236 @@ checkpoint_add_space(struct space *sp, void *data)
 	return 0;
 };
 
+/**
+ * Take up to CHECKPOINT_BATCH_SIZE tuples of user spaces for
+ * writing. The tuples are taken in the order of spaces and
+ * their primary keys, so a big space is spread over all
+ * snapshot writers. Returns the number of tuples stored in
+ * @a rows, 0 if there are no tuples left.
+ */
 static int
-checkpoint_f(va_list ap)
+checkpoint_take_rows(struct checkpoint *ckpt, struct checkpoint_row *rows)
 {
-	struct checkpoint *ckpt = va_arg(ap, struct checkpoint *);
-
-	if (ckpt->touch) {
-		if (xdir_touch_xlog(&ckpt->dir, &ckpt->vclock) == 0)
-			return 0;
-		/*
-		 * Failed to touch an existing snapshot, create
-		 * a new one.
-		 */
-		ckpt->touch = false;
+	int count = 0;
+	tt_pthread_mutex_lock(&ckpt->mutex);
+	struct checkpoint_entry *entry = ckpt->next_entry;
+	while (entry != NULL && count < CHECKPOINT_BATCH_SIZE) {
+		struct snapshot_iterator *it = entry->iterator;
+		struct checkpoint_row *row = &rows[count];
+		row->data = it->next(it, &row->size);
+		if (row->data == NULL) {
+			entry = rlist_next_entry(entry, link);
+			if (&entry->link == &ckpt->entries)
+				entry = NULL;
+			continue;
+		}
+		row->space = entry->space;
+		count++;
 	}
+	ckpt->next_entry = entry;
+	tt_pthread_mutex_unlock(&ckpt->mutex);
+	return count;
+}
 
+/**
+ * Write chunk @a chunk_no of a snapshot. The main file (chunk 0)
+ * gets all system spaces, the tuples of user spaces are written
+ * to whichever chunk takes them first.
+ */
+static int
+checkpoint_write_chunk(struct checkpoint *ckpt, uint32_t chunk_no)
+{
 	struct xlog snap;
-	if (xdir_create_xlog(&ckpt->dir, &snap, &ckpt->vclock) != 0)
+	if (xdir_create_snap_chunk(&ckpt->dir, &snap, &ckpt->vclock,
+				   chunk_no, ckpt->writer_count - 1) != 0)
 		return -1;
 
-	snap.rate_limit = ckpt->snap_io_rate_limit;
+	snap.rate_limit = ckpt->snap_io_rate_limit / ckpt->writer_count;
 
 	say_info("saving snapshot `%s'", snap.filename);
-	struct checkpoint_entry *entry;
-	rlist_foreach_entry(entry, &ckpt->entries, link) {
-		uint32_t size;
-		const char *data;
-		struct snapshot_iterator *it = entry->iterator;
-		for (data = it->next(it, &size); data != NULL;
-		     data = it->next(it, &size)) {
-			if (checkpoint_write_tuple(&snap, entry->space,
-					data, size) != 0) {
-				xlog_close(&snap, false);
-				return -1;
+	if (chunk_no == 0) {
+		struct checkpoint_entry *entry;
+		rlist_foreach_entry(entry, &ckpt->system_entries, link) {
+			uint32_t size;
+			const char *data;
+			struct snapshot_iterator *it = entry->iterator;
+			for (data = it->next(it, &size); data != NULL;
+			     data = it->next(it, &size)) {
+				if (checkpoint_write_tuple(&snap, entry->space,
+						data, size) != 0)
+					goto fail;
 			}
 		}
 	}
-	if (xlog_flush(&snap) < 0) {
-		xlog_close(&snap, false);
-		return -1;
+	struct checkpoint_row rows[CHECKPOINT_BATCH_SIZE];
+	int count;
+	while ((count = checkpoint_take_rows(ckpt, rows)) > 0) {
+		for (int i = 0; i < count; i++) {
+			if (checkpoint_write_tuple(&snap, rows[i].space,
+					rows[i].data, rows[i].size) != 0)
+				goto fail;
+		}
 	}
+	if (xlog_flush(&snap) < 0)
+		goto fail;
 	xlog_close(&snap, false);
 	say_info("done");
 	return 0;
+fail:
+	xlog_close(&snap, false);
+	return -1;
 }
 
 static int
-memtx_engine_begin_checkpoint(struct engine *engine)
+checkpoint_writer_f(va_list ap)
 {
-	struct memtx_engine *memtx = (struct memtx_engine *)engine;
-
-	assert(memtx->checkpoint == NULL);
-	memtx->checkpoint = checkpoint_new(memtx->snap_dir.dirname,
-					   memtx->snap_io_rate_limit);
-	if (memtx->checkpoint == NULL)
-		return -1;
-
-	if (space_foreach(checkpoint_add_space, memtx->checkpoint) != 0) {
-		checkpoint_delete(memtx->checkpoint);
-		memtx->checkpoint = NULL;
-		return -1;
-	}
-
-	/* increment snapshot version; set tuple deletion to delayed mode */
-	memtx->snapshot_version++;
-	small_alloc_setopt(&memtx->alloc, SMALL_DELAYED_FREE_MODE, true);
-	return 0;
+	struct checkpoint_writer *writer =
+		va_arg(ap, struct checkpoint_writer *);
+	return checkpoint_write_chunk(writer->ckpt, writer->chunk_no);
 }
 
 static int
-memtx_engine_wait_checkpoint(struct engine *engine,
-			     const struct vclock *vclock)
+checkpoint_f(va_list ap)
 {
-	struct memtx_engine *memtx = (struct memtx_engine *)engine;
+	struct checkpoint *ckpt = va_arg(ap, struct checkpoint *);
 
-	assert(memtx->checkpoint != NULL);
-	/*
-	 * If a snapshot already exists, do not create a new one.
-	 */
-	struct vclock last;
-	if (xdir_last_vclock(&memtx->snap_dir, &last) >= 0 &&
-	    vclock_compare(&last, vclock) == 0) {
+	if (ckpt->touch) {
+		if (xdir_touch_xlog(&ckpt->dir, &ckpt->vclock) == 0)
+			return 0;
+		/*
+		 * Failed to touch an existing snapshot, create
+		 * a new one.
+		 */
+		ckpt->touch = false;
+	}
+
+	if (!rlist_empty(&ckpt->entries)) {
+		ckpt->next_entry = rlist_first_entry(&ckpt->entries,
+					struct checkpoint_entry, link);
+	}
+	/*
+	 * Start a thread per each additional chunk and write
+	 * the main file in this one.
+	 */
+	int rc = 0;
+	int started = 0;
+	for (; started < ckpt->writer_count - 1; started++) {
+		struct checkpoint_writer *writer = &ckpt->writers[started];
+		writer->ckpt = ckpt;
+		writer->chunk_no = started + 1;
+		if (cord_costart(&writer->cord,
+				 tt_sprintf("snapshot.%u", writer->chunk_no),
+				 checkpoint_writer_f, writer) != 0) {
+			rc = -1;
+			break;
+		}
+	}
+	if (rc == 0 && checkpoint_write_chunk(ckpt, 0) != 0)
+		rc = -1;
+	/* Wait for all started writers even if some failed. */
+	for (int i = 0; i < started; i++) {
+		if (cord_cojoin(&ckpt->writers[i].cord) != 0)
+			rc = -1;
+	}
+	return rc;
+}
+
+int
+memtx_engine_enter_read_view(struct memtx_engine *memtx,
+			     struct memtx_read_view_version *rv)
+{
+	/*
+	 * Tuples deleted while the view is open go to a new
+	 * garbage list. Allocate it now, because tuple deletion
+	 * can't fail.
+	 */
+	struct memtx_tuple_garbage *garbage = malloc(sizeof(*garbage));
+	if (garbage == NULL) {
+		diag_set(OutOfMemory, sizeof(*garbage), "malloc",
+			 "struct memtx_tuple_garbage");
+		return -1;
+	}
+	/* Tuples allocated after this point aren't in the view. */
+	rv->version = ++memtx->snapshot_version;
+	rlist_add_tail_entry(&memtx->read_views, rv, in_read_views);
+	garbage->version = memtx->snapshot_version;
+	garbage->first = NULL;
+	stailq_add_tail_entry(&memtx->tuple_garbage, garbage,
+			      in_tuple_garbage);
+	return 0;
+}
+
+void
+memtx_engine_leave_read_view(struct memtx_engine *memtx,
+			     struct memtx_read_view_version *rv)
+{
+	rlist_del_entry(rv, in_read_views);
+	/* Free tuples and indexes visible only from this view. */
+	if (!stailq_empty(&memtx->tuple_garbage) ||
+	    !stailq_empty(&memtx->gc_queue))
+		fiber_wakeup(memtx->gc_fiber);
+}
+
+/**
+ * Return true if an object freed when memtx_engine::
+ * snapshot_version was equal to @a version may still be read
+ * through an open read view.
+ */
+static inline bool
+memtx_engine_version_is_pinned(struct memtx_engine *memtx,
+			       uint32_t version)
+{
+	if (rlist_empty(&memtx->read_views))
+		return false;
+	struct memtx_read_view_version *oldest =
+		rlist_first_entry(&memtx->read_views,
+				  struct memtx_read_view_version,
+				  in_read_views);
+	/* Versions may wrap around. */
+	return (int32_t)(version - oldest->version) >= 0;
+}
+
+static int
+memtx_engine_begin_checkpoint(struct engine *engine)
+{
+	struct memtx_engine *memtx = (struct memtx_engine *)engine;
+
+	assert(memtx->checkpoint == NULL);
+	memtx->checkpoint = checkpoint_new(memtx->snap_dir.dirname,
+					   memtx->snap_io_rate_limit,
+					   memtx->snap_threads);
+	if (memtx->checkpoint == NULL)
+		return -1;
+
+	if (space_foreach(checkpoint_add_space, memtx->checkpoint) != 0) {
+		checkpoint_delete(memtx->checkpoint);
+		memtx->checkpoint = NULL;
+		return -1;
+	}
+
+	/* increment snapshot version; delay freeing deleted tuples */
+	if (memtx_engine_enter_read_view(memtx,
+					 &memtx->checkpoint->read_view) != 0) {
+		checkpoint_delete(memtx->checkpoint);
+		memtx->checkpoint = NULL;
+		return -1;
+	}
+	return 0;
+}
+
+static int
+memtx_engine_wait_checkpoint(struct engine *engine,
+			     const struct vclock *vclock)
+{
+	struct memtx_engine *memtx = (struct memtx_engine *)engine;
+
+	assert(memtx->checkpoint != NULL);
+	/*
+	 * If a snapshot already exists, do not create a new one.
+	 */
+	struct vclock last;
+	if (xdir_last_vclock(&memtx->snap_dir, &last) >= 0 &&
+	    vclock_compare(&last, vclock) == 0) {
 		memtx->checkpoint->touch = true;
 	}
 	vclock_copy(&memtx->checkpoint->vclock, vclock);
@@ -754,16 +1503,11 @@ memtx_engine_commit_checkpoint(struct engine *engine,
 	/* waitCheckpoint() must have been done. */
 	assert(!memtx->checkpoint->waiting_for_snap_thread);
 
-	small_alloc_setopt(&memtx->alloc, SMALL_DELAYED_FREE_MODE, false);
+	memtx_engine_leave_read_view(memtx, &memtx->checkpoint->read_view);
 
 	if (!memtx->checkpoint->touch) {
 		int64_t lsn = vclock_sum(&memtx->checkpoint->vclock);
 		struct xdir *dir = &memtx->checkpoint->dir;
-		/* rename snapshot on completion */
-		char to[PATH_MAX];
-		snprintf(to, sizeof(to), "%s",
-			 xdir_format_filename(dir, lsn, NONE));
-		char *from = xdir_format_filename(dir, lsn, INPROGRESS);
 #ifndef NDEBUG
 		struct errinj *delay = errinj(ERRINJ_SNAP_COMMIT_DELAY,
 					       ERRINJ_BOOL);
@@ -772,9 +1516,21 @@ memtx_engine_commit_checkpoint(struct engine *engine,
 				fiber_sleep(0.001);
 		}
 #endif
-		int rc = coio_rename(from, to);
-		if (rc != 0)
-			panic("can't rename .snap.inprogress");
+		/*
+		 * Rename snapshot on completion. The main file
+		 * goes last: once it appears, all chunks listed
+		 * in its header must be in place.
+		 */
+		for (int i = memtx->checkpoint->writer_count - 1; i >= 0; i--) {
+			char to[PATH_MAX];
+			snprintf(to, sizeof(to), "%s",
+				 xdir_format_chunk_filename(dir, lsn, i, NONE));
+			char *from = xdir_format_chunk_filename(dir, lsn, i,
+								INPROGRESS);
+			int rc = coio_rename(from, to);
+			if (rc != 0)
+				panic("can't rename .snap.inprogress");
+		}
 	}
 
 	struct vclock last;
@@ -803,14 +1559,16 @@ memtx_engine_abort_checkpoint(struct engine *engine)
 		memtx->checkpoint->waiting_for_snap_thread = false;
 	}
 
-	small_alloc_setopt(&memtx->alloc, SMALL_DELAYED_FREE_MODE, false);
+	memtx_engine_leave_read_view(memtx, &memtx->checkpoint->read_view);
 
-	/** Remove garbage .inprogress file. */
-	char *filename =
-		xdir_format_filename(&memtx->checkpoint->dir,
-				     vclock_sum(&memtx->checkpoint->vclock),
-				     INPROGRESS);
-	(void) coio_unlink(filename);
+	/** Remove garbage .inprogress files. */
+	for (int i = 0; i < memtx->checkpoint->writer_count; i++) {
+		char *filename =
+			xdir_format_chunk_filename(&memtx->checkpoint->dir,
+					vclock_sum(&memtx->checkpoint->vclock),
+					i, INPROGRESS);
+		(void) coio_unlink(filename);
+	}
 
 	checkpoint_delete(memtx->checkpoint);
 	memtx->checkpoint = NULL;
@@ -829,9 +1587,189 @@ memtx_engine_backup(struct engine *engine, const struct vclock *vclock,
 		    engine_backup_cb cb, void *cb_arg)
 {
 	struct memtx_engine *memtx = (struct memtx_engine *)engine;
+	int64_t signature = vclock_sum(vclock);
 	char *filename = xdir_format_filename(&memtx->snap_dir,
-					      vclock_sum(vclock), NONE);
-	return cb(filename, cb_arg);
+					      signature, NONE);
+	if (cb(filename, cb_arg) != 0)
+		return -1;
+	/* Chunks of a snapshot written by several threads. */
+	for (uint32_t chunk_no = 1; ; chunk_no++) {
+		filename = xdir_format_chunk_filename(&memtx->snap_dir,
+						signature, chunk_no, NONE);
+		if (access(filename, F_OK) != 0)
+			break;
+		if (cb(filename, cb_arg) != 0)
+			return -1;
+	}
+	return 0;
+}
+
+/** An index in a read view. */
+struct memtx_read_view_index {
+	/** Index type or index_type_MAX if there's no index. */
+	enum index_type type;
+	/** Frozen index, NULL unless the index is a TREE. */
+	struct memtx_tree_view *view;
+};
+
+/** A space in a read view. */
+struct memtx_read_view_entry {
+	/** Space id. */
+	uint32_t space_id;
+	/** Space name, used for error reporting. */
+	char *name;
+	/** Indexes of the space, by index id. */
+	struct memtx_read_view_index *index;
+	/** Number of entries in the index array. */
+	uint32_t index_count;
+};
+
+struct memtx_read_view {
+	struct memtx_engine *memtx;
+	/** Memory pinned for the frozen indexes. */
+	struct memtx_read_view_version version;
+	/** Spaces in the view, sorted by id. */
+	struct memtx_read_view_entry *entries;
+	uint32_t entry_count;
+	uint32_t entry_capacity;
+};
+
+static int
+memtx_read_view_add_space(struct space *space, void *data)
+{
+	struct memtx_read_view *rv = (struct memtx_read_view *)data;
+	/* Tuples of temporary spaces are freed immediately. */
+	if (!space_is_memtx(space) || space_is_temporary(space))
+		return 0;
+	if (space->index_count == 0)
+		return 0;
+	if (rv->entry_count == rv->entry_capacity) {
+		uint32_t capacity = MAX(rv->entry_capacity * 2, 16);
+		size_t size = capacity * sizeof(*rv->entries);
+		struct memtx_read_view_entry *entries =
+			realloc(rv->entries, size);
+		if (entries == NULL) {
+			diag_set(OutOfMemory, size, "realloc",
+				 "struct memtx_read_view_entry");
+			return -1;
+		}
+		rv->entries = entries;
+		rv->entry_capacity = capacity;
+	}
+	uint32_t index_count = space->index_id_max + 1;
+	struct memtx_read_view_index *index =
+		calloc(index_count, sizeof(*index));
+	if (index == NULL) {
+		diag_set(OutOfMemory, index_count * sizeof(*index),
+			 "calloc", "struct memtx_read_view_index");
+		return -1;
+	}
+	char *name = strdup(space_name(space));
+	if (name == NULL) {
+		diag_set(OutOfMemory, strlen(space_name(space)) + 1,
+			 "strdup", "space name");
+		free(index);
+		return -1;
+	}
+	struct memtx_read_view_entry *entry = &rv->entries[rv->entry_count++];
+	entry->space_id = space_id(space);
+	entry->name = name;
+	entry->index = index;
+	entry->index_count = index_count;
+	for (uint32_t i = 0; i < index_count; i++)
+		index[i].type = index_type_MAX;
+	for (uint32_t i = 0; i < space->index_count; i++) {
+		struct index *idx = space->index[i];
+		index[idx->def->iid].type = idx->def->type;
+		if (idx->def->type != TREE)
+			continue;
+		index[idx->def->iid].view = memtx_tree_view_new(idx);
+		if (index[idx->def->iid].view == NULL)
+			return -1;
+	}
+	return 0;
+}
+
+static int
+memtx_read_view_entry_cmp(const void *a, const void *b)
+{
+	uint32_t id_a = ((const struct memtx_read_view_entry *)a)->space_id;
+	uint32_t id_b = ((const struct memtx_read_view_entry *)b)->space_id;
+	return id_a < id_b ? -1 : id_a > id_b;
+}
+
+struct memtx_read_view *
+memtx_read_view_new(struct memtx_engine *memtx)
+{
+	struct memtx_read_view *rv = calloc(1, sizeof(*rv));
+	if (rv == NULL) {
+		diag_set(OutOfMemory, sizeof(*rv), "calloc",
+			 "struct memtx_read_view");
+		return NULL;
+	}
+	rv->memtx = memtx;
+	if (memtx_engine_enter_read_view(memtx, &rv->version) != 0) {
+		free(rv);
+		return NULL;
+	}
+	/*
+	 * Freezing an index doesn't yield, so all spaces are
+	 * frozen at the same point of time.
+	 */
+	if (space_foreach(memtx_read_view_add_space, rv) != 0) {
+		memtx_read_view_delete(rv);
+		return NULL;
+	}
+	/* User spaces are visited in no particular order. */
+	qsort(rv->entries, rv->entry_count, sizeof(*rv->entries),
+	      memtx_read_view_entry_cmp);
+	return rv;
+}
+
+void
+memtx_read_view_delete(struct memtx_read_view *rv)
+{
+	for (uint32_t i = 0; i < rv->entry_count; i++) {
+		struct memtx_read_view_entry *entry = &rv->entries[i];
+		for (uint32_t j = 0; j < entry->index_count; j++) {
+			if (entry->index[j].view != NULL)
+				memtx_tree_view_delete(entry->index[j].view);
+		}
+		free(entry->index);
+		free(entry->name);
+	}
+	/* The frozen indexes must be deleted before memory is unpinned. */
+	memtx_engine_leave_read_view(rv->memtx, &rv->version);
+	free(rv->entries);
+	free(rv);
+}
+
+struct memtx_tree_view *
+memtx_read_view_index(struct memtx_read_view *rv, uint32_t space_id,
+		      uint32_t index_id)
+{
+	struct memtx_read_view_entry key;
+	key.space_id = space_id;
+	struct memtx_read_view_entry *entry =
+		bsearch(&key, rv->entries, rv->entry_count,
+			sizeof(*rv->entries), memtx_read_view_entry_cmp);
+	if (entry == NULL) {
+		diag_set(ClientError, ER_NO_SUCH_SPACE, int2str(space_id));
+		return NULL;
+	}
+	if (index_id >= entry->index_count ||
+	    entry->index[index_id].type == index_type_MAX) {
+		diag_set(ClientError, ER_NO_SUCH_INDEX_ID, index_id,
+			 entry->name);
+		return NULL;
+	}
+	struct memtx_read_view_index *index = &entry->index[index_id];
+	if (index->view == NULL) {
+		diag_set(ClientError, ER_UNSUPPORTED, "Read view",
+			 tt_sprintf("%s index", index_type_strs[index->type]));
+		return NULL;
+	}
+	return index->view;
 }
 
 /** Used to pass arguments to memtx_initial_join_f */
@@ -841,6 +1779,32 @@ struct memtx_join_arg {
 	struct xstream *stream;
 };
 
+/** Feed rows of an open snapshot file to a stream. */
+static int
+memtx_join_send_file(struct xlog_cursor *cursor, struct xstream *stream)
+{
+	int rc;
+	struct xrow_header row;
+	while ((rc = xlog_cursor_next(cursor, &row, true)) == 0) {
+		rc = xstream_write(stream, &row);
+		if (rc < 0)
+			break;
+	}
+	xlog_cursor_close(cursor, false);
+	if (rc < 0)
+		return -1;
+
+	/**
+	 * We should never try to read snapshots with no EOF
+	 * marker - such snapshots are very likely corrupted and
+	 * should not be trusted.
+	 */
+	/* TODO: replace panic with diag_set() */
+	if (!xlog_cursor_is_eof(cursor))
+		panic("snapshot `%s' has no EOF marker", cursor->name);
+	return 0;
+}
+
 /**
  * Invoked from a thread to feed snapshot rows.
  */
@@ -860,29 +1824,23 @@ memtx_initial_join_f(va_list ap)
 	xdir_create(&dir, snap_dirname, SNAP, &INSTANCE_UUID);
 	struct xlog_cursor cursor;
 	int rc = xdir_open_cursor(&dir, checkpoint_lsn, &cursor);
-	xdir_destroy(&dir);
 	if (rc < 0)
-		return -1;
-
-	struct xrow_header row;
-	while ((rc = xlog_cursor_next(&cursor, &row, true)) == 0) {
-		rc = xstream_write(stream, &row);
-		if (rc < 0)
-			break;
+		goto out;
+
+	uint32_t chunk_count = cursor.meta.chunk_count;
+	rc = memtx_join_send_file(&cursor, stream);
+	/* The schema is in the main file, so send chunks after it. */
+	for (uint32_t chunk_no = 1; rc == 0 && chunk_no <= chunk_count;
+	     chunk_no++) {
+		const char *filename = xdir_format_chunk_filename(&dir,
+					checkpoint_lsn, chunk_no, NONE);
+		rc = xlog_cursor_open(&cursor, filename);
+		if (rc == 0)
+			rc = memtx_join_send_file(&cursor, stream);
 	}
-	xlog_cursor_close(&cursor, false);
-	if (rc < 0)
-		return -1;
-
-	/**
-	 * We should never try to read snapshots with no EOF
-	 * marker - such snapshots are very likely corrupted and
-	 * should not be trusted.
-	 */
-	/* TODO: replace panic with diag_set() */
-	if (!xlog_cursor_is_eof(&cursor))
-		panic("snapshot `%s' has no EOF marker", cursor.name);
-	return 0;
+out:
+	xdir_destroy(&dir);
+	return rc < 0 ? -1 : 0;
 }
 
 static int
@@ -933,7 +1891,7 @@ static const struct engine_vtab memtx_engine_vtab = {
 	/* .begin = */ memtx_engine_begin,
 	/* .begin_statement = */ memtx_engine_begin_statement,
 	/* .prepare = */ memtx_engine_prepare,
-	/* .commit = */ generic_engine_commit,
+	/* .commit = */ memtx_engine_commit,
 	/* .rollback_statement = */ memtx_engine_rollback_statement,
 	/* .rollback = */ memtx_engine_rollback,
 	/* .switch_to_ro = */ generic_engine_switch_to_ro,
@@ -952,6 +1910,57 @@ static const struct engine_vtab memtx_engine_vtab = {
 	/* .check_space_def = */ generic_engine_check_space_def,
 };
 
+/** Return a tuple to the allocator and unreference its format. */
+static void
+memtx_tuple_free(struct memtx_engine *memtx, struct tuple_format *format,
+		 struct memtx_tuple *memtx_tuple)
+{
+	size_t total = memtx_tuple_size(memtx_tuple);
+	tuple_format_unref(format);
+	smfree(&memtx->alloc, memtx_tuple, total);
+}
+
+/**
+ * Free at most @a limit tuples deleted while read views were
+ * open that aren't visible from any open view anymore. Return
+ * true if there are more such tuples to free.
+ */
+static bool
+memtx_engine_free_garbage(struct memtx_engine *memtx, int limit)
+{
+	while (!stailq_empty(&memtx->tuple_garbage)) {
+		struct memtx_tuple_garbage *garbage =
+			stailq_first_entry(&memtx->tuple_garbage,
+					   struct memtx_tuple_garbage,
+					   in_tuple_garbage);
+		if (memtx_engine_version_is_pinned(memtx, garbage->version))
+			return false;
+		while (garbage->first != NULL) {
+			if (limit-- == 0)
+				return true;
+			struct memtx_tuple *memtx_tuple = garbage->first;
+			garbage->first = memtx_tuple_next_garbage(memtx_tuple);
+			struct tuple *tuple = &memtx_tuple->base;
+			if (tuple->refs == 1) {
+				memtx_tuple_free(memtx, tuple_format(tuple),
+						 memtx_tuple);
+				continue;
+			}
+			/*
+			 * The tuple is still referenced by a read
+			 * view reader. Drop the reference of the
+			 * garbage list: the tuple will be deleted
+			 * as usual when the reader releases it.
+			 */
+			memtx_tuple->version = memtx->snapshot_version;
+			tuple_unref(tuple);
+		}
+		stailq_shift(&memtx->tuple_garbage);
+		free(garbage);
+	}
+	return false;
+}
+
 /**
  * Run one iteration of garbage collection. Set @stop if
  * there is no more objects to free.
@@ -959,6 +1968,20 @@ static const struct engine_vtab memtx_engine_vtab = {
 static void
 memtx_engine_run_gc(struct memtx_engine *memtx, bool *stop)
 {
+	/*
+	 * Free tuples in batches to keep latency low.
+	 * Use smaller batches in debug mode.
+	 */
+#ifdef NDEBUG
+	enum { GARBAGE_BATCH_SIZE = 1000 };
+#else
+	enum { GARBAGE_BATCH_SIZE = 10 };
+#endif
+	if (memtx_engine_free_garbage(memtx, GARBAGE_BATCH_SIZE)) {
+		*stop = false;
+		return;
+	}
+
 	*stop = stailq_empty(&memtx->gc_queue);
 	if (*stop)
 		return;
@@ -967,6 +1990,17 @@ memtx_engine_run_gc(struct memtx_engine *memtx, bool *stop)
 					struct memtx_gc_task, link);
 	bool task_done;
 	task->vtab->run(task, &task_done);
+	if (task_done && memtx_engine_version_is_pinned(memtx,
+							 task->version)) {
+		/*
+		 * The index may still be read through a frozen
+		 * view. It will be destroyed when all read views
+		 * created before it was dropped are closed, see
+		 * memtx_engine_leave_read_view().
+		 */
+		*stop = true;
+		return;
+	}
 	if (task_done) {
 		stailq_shift(&memtx->gc_queue);
 		task->vtab->free(task);
@@ -999,10 +2033,581 @@ memtx_engine_gc_f(va_list va)
 	return 0;
 }
 
+/**
+ * Tuples counted by the defragmenter in a slab of the tuple
+ * allocator.
+ */
+struct memtx_defrag_slab {
+	/** Address of the slab. */
+	uintptr_t addr;
+	/** Number of tuples stored in the slab. */
+	uint32_t used;
+	/** Max number of tuples the slab can store. */
+	uint32_t capacity;
+};
+
+#define mh_name _memtx_defrag_slab
+#define mh_key_t uintptr_t
+#define mh_node_t struct memtx_defrag_slab
+#define mh_arg_t void *
+#define mh_hash(a, arg) ((uint32_t)((a)->addr >> 12))
+#define mh_hash_key(a, arg) ((uint32_t)((a) >> 12))
+#define mh_cmp(a, b, arg) ((a)->addr != (b)->addr)
+#define mh_cmp_key(a, b, arg) ((a) != (b)->addr)
+#define MH_SOURCE 1
+#include "salad/mhash.h"
+
+/** A size class of the tuple allocator. */
+struct memtx_defrag_pool {
+	/** Size of objects allocated from the pool. */
+	uint32_t objsize;
+	/** Size of slabs the pool allocates objects from. */
+	uint32_t slabsize;
+};
+
+/**
+ * State of the tuple defragmenter.
+ *
+ * A defragmentation cycle makes two passes over memtx spaces
+ * in the primary key order. The first pass counts tuples stored
+ * in each slab. The second one moves tuples out of slabs whose
+ * utilization turned out to be below memtx_engine::
+ * defrag_threshold. A pool allocates objects from the slab at
+ * the lowest address that has free space, so a tuple is moved
+ * only if its new copy lands in a slab at a lower address:
+ * this way tuples drift to the beginning of the arena, and
+ * slabs at higher addresses are emptied and returned to the
+ * slab cache, where they can be reused for tuples of other
+ * sizes and index extents.
+ *
+ * Slab utilization is counted while the tx thread keeps on
+ * modifying data, so it's only an estimate, but that's fine
+ * as it only affects what tuples are moved.
+ */
+struct memtx_defrag {
+	struct memtx_engine *memtx;
+	/** Set while a defragmentation cycle is in progress. */
+	bool is_active;
+	/** Set on the second, relocating, pass of a cycle. */
+	bool is_relocating;
+	/** Ids of memtx spaces to process in this cycle. */
+	uint32_t *space_ids;
+	uint32_t space_count;
+	uint32_t space_capacity;
+	/** Index of the space being processed in space_ids. */
+	uint32_t space_pos;
+	/**
+	 * Primary index of the space being processed. If it
+	 * changes, the rest of the space is skipped.
+	 */
+	struct index *pk;
+	/** Key of the last processed tuple, NULL at start. */
+	char *key;
+	size_t key_capacity;
+	/** Size classes of the allocator sorted by objsize. */
+	struct memtx_defrag_pool *pools;
+	uint32_t pool_count;
+	uint32_t pool_capacity;
+	/** Set if pools couldn't be listed for lack of memory. */
+	bool is_pool_list_broken;
+	/** Tuples counted in each slab, keyed by slab address. */
+	struct mh_memtx_defrag_slab_t *slabs;
+	/** Number of tuples moved in this cycle. */
+	size_t relocated;
+	/** Number of tuples moved in the last finished cycle. */
+	size_t last_relocated;
+	/** Memory used by tuples when the last cycle finished. */
+	size_t last_used;
+};
+
+enum {
+	/** Seconds between checks if defragmentation is needed. */
+	MEMTX_DEFRAG_CHECK_PERIOD = 1,
+};
+
+static void
+memtx_defrag_create(struct memtx_defrag *defrag, struct memtx_engine *memtx)
+{
+	memset(defrag, 0, sizeof(*defrag));
+	defrag->memtx = memtx;
+}
+
+static void
+memtx_defrag_destroy(struct memtx_defrag *defrag)
+{
+	if (defrag->slabs != NULL)
+		mh_memtx_defrag_slab_delete(defrag->slabs);
+	free(defrag->pools);
+	free(defrag->key);
+	free(defrag->space_ids);
+}
+
+static int
+memtx_defrag_add_pool(const struct mempool_stats *stats, void *ctx)
+{
+	struct memtx_defrag *defrag = (struct memtx_defrag *)ctx;
+	if (stats->slabcount == 0)
+		return 0;
+	if (defrag->pool_count == defrag->pool_capacity) {
+		uint32_t capacity = MAX(defrag->pool_capacity * 2, 64);
+		struct memtx_defrag_pool *pools = realloc(defrag->pools,
+						capacity * sizeof(*pools));
+		if (pools == NULL) {
+			diag_set(OutOfMemory, capacity * sizeof(*pools),
+				 "realloc", "defrag->pools");
+			defrag->is_pool_list_broken = true;
+			return 1;
+		}
+		defrag->pools = pools;
+		defrag->pool_capacity = capacity;
+	}
+	struct memtx_defrag_pool *pool = &defrag->pools[defrag->pool_count++];
+	pool->objsize = stats->objsize;
+	pool->slabsize = stats->slabsize;
+	return 0;
+}
+
+static int
+memtx_defrag_pool_cmp(const void *a, const void *b)
+{
+	const struct memtx_defrag_pool *pool_a = a;
+	const struct memtx_defrag_pool *pool_b = b;
+	return pool_a->objsize < pool_b->objsize ? -1 :
+	       pool_a->objsize > pool_b->objsize;
+}
+
+/**
+ * Refresh the list of allocator size classes. Pools are created
+ * and destroyed on demand so this is done before each step.
+ */
+static int
+memtx_defrag_update_pools(struct memtx_defrag *defrag)
+{
+	struct small_stats totals;
+	defrag->pool_count = 0;
+	defrag->is_pool_list_broken = false;
+	small_stats(&defrag->memtx->alloc, &totals,
+		    memtx_defrag_add_pool, defrag);
+	if (defrag->is_pool_list_broken)
+		return -1;
+	qsort(defrag->pools, defrag->pool_count, sizeof(*defrag->pools),
+	      memtx_defrag_pool_cmp);
+	return 0;
+}
+
+/**
+ * Find the slab the given tuple is stored in. Slabs are aligned
+ * by their size so the address of a slab is derived from the
+ * address of the tuple and the slab size of the pool serving
+ * objects of the tuple size, which is the smallest pool that
+ * fits the tuple. Return 0 if the tuple is too big to be
+ * allocated from a pool.
+ */
+static uintptr_t
+memtx_defrag_slab_addr(struct memtx_defrag *defrag,
+		       struct memtx_tuple *memtx_tuple, uint32_t *capacity)
+{
+	size_t total = memtx_tuple_size(memtx_tuple);
+	uint32_t begin = 0, end = defrag->pool_count;
+	while (begin != end) {
+		uint32_t mid = begin + (end - begin) / 2;
+		if (defrag->pools[mid].objsize < total)
+			begin = mid + 1;
+		else
+			end = mid;
+	}
+	if (begin == defrag->pool_count)
+		return 0;
+	struct memtx_defrag_pool *pool = &defrag->pools[begin];
+	*capacity = pool->slabsize / pool->objsize;
+	return (uintptr_t)memtx_tuple & ~((uintptr_t)pool->slabsize - 1);
+}
+
+/**
+ * Return the usage counter of the slab storing the given tuple
+ * or NULL if the slab hasn't been seen on the counting pass.
+ */
+static struct memtx_defrag_slab *
+memtx_defrag_find_slab(struct memtx_defrag *defrag,
+		       struct memtx_tuple *memtx_tuple)
+{
+	uint32_t capacity;
+	uintptr_t addr = memtx_defrag_slab_addr(defrag, memtx_tuple,
+						&capacity);
+	if (addr == 0)
+		return NULL;
+	mh_int_t k = mh_memtx_defrag_slab_find(defrag->slabs, addr, NULL);
+	if (k == mh_end(defrag->slabs))
+		return NULL;
+	return mh_memtx_defrag_slab_node(defrag->slabs, k);
+}
+
+/** Account a tuple in the usage counter of its slab. */
+static int
+memtx_defrag_count(struct memtx_defrag *defrag, struct tuple *tuple)
+{
+	struct memtx_tuple *memtx_tuple =
+		container_of(tuple, struct memtx_tuple, base);
+	struct memtx_defrag_slab *slab = memtx_defrag_find_slab(defrag,
+								memtx_tuple);
+	if (slab != NULL) {
+		slab->used++;
+		return 0;
+	}
+	struct memtx_defrag_slab node;
+	node.addr = memtx_defrag_slab_addr(defrag, memtx_tuple,
+					   &node.capacity);
+	if (node.addr == 0)
+		return 0;
+	node.used = 1;
+	if (mh_memtx_defrag_slab_put(defrag->slabs, &node, NULL,
+				     NULL) == mh_end(defrag->slabs)) {
+		diag_set(OutOfMemory, 0, "mh_memtx_defrag_slab_put",
+			 "struct memtx_defrag_slab");
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * Move a tuple out of its slab if the slab is sparse. Only
+ * tuples referenced by nothing but the space are moved: any
+ * other reference (a transaction statement, a Lua object, an
+ * index iterator) may be used to access the tuple later.
+ * Readers of read views aren't affected, because the old copy
+ * is freed the same way as a deleted tuple, see
+ * memtx_tuple_delete(). Return -1 and set diag on error,
+ * 1 if the allocator is out of memory, 0 otherwise.
+ */
+static int
+memtx_defrag_relocate(struct memtx_defrag *defrag, struct space *space,
+		      struct tuple *tuple)
+{
+	struct memtx_engine *memtx = defrag->memtx;
+	struct memtx_tuple *memtx_tuple =
+		container_of(tuple, struct memtx_tuple, base);
+	if (tuple->refs != 1)
+		return 0;
+	struct memtx_defrag_slab *src = memtx_defrag_find_slab(defrag,
+							       memtx_tuple);
+	if (src == NULL ||
+	    src->used >= src->capacity * memtx->defrag_threshold)
+		return 0;
+	struct tuple_format *format = tuple_format(tuple);
+	size_t total = memtx_tuple_size(memtx_tuple);
+	struct memtx_tuple *new_memtx_tuple = smalloc(&memtx->alloc, total);
+	if (new_memtx_tuple == NULL)
+		return 1;
+	struct memtx_defrag_slab *dst = memtx_defrag_find_slab(defrag,
+							new_memtx_tuple);
+	if (dst == NULL || dst->addr >= src->addr) {
+		/* The move wouldn't help to free the slab. */
+		smfree(&memtx->alloc, new_memtx_tuple, total);
+		return 0;
+	}
+	memcpy(new_memtx_tuple, memtx_tuple, total);
+	new_memtx_tuple->version = memtx->snapshot_version;
+	struct tuple *new_tuple = &new_memtx_tuple->base;
+	new_tuple->refs = 0;
+	tuple_format_ref(format);
+	struct tuple *old_tuple;
+	if (memtx_space_replace_all_keys(space, tuple, new_tuple,
+					 DUP_REPLACE, &old_tuple) != 0) {
+		memtx_tuple_free(memtx, format, new_memtx_tuple);
+		return -1;
+	}
+	assert(old_tuple == tuple);
+	tuple_unref(old_tuple);
+	src->used--;
+	dst->used++;
+	defrag->relocated++;
+	return 0;
+}
+
+/** Check if a space has a functional index. */
+static bool
+memtx_space_has_func_index(struct space *space)
+{
+	for (uint32_t i = 0; i < space->index_count; i++) {
+		if (space->index[i]->def->key_def->for_func_index)
+			return true;
+	}
+	return false;
+}
+
+/**
+ * Return true if tuples of the given space may be moved. While
+ * the space is being recovered or its primary key is rebuilt,
+ * not all of its indexes are updated on replace. Moving a tuple
+ * of a space with a functional index would call the function
+ * to compute the keys of the copy.
+ */
+static bool
+memtx_defrag_space_is_eligible(struct memtx_defrag *defrag,
+			       struct space *space)
+{
+	struct memtx_space *memtx_space = (struct memtx_space *)space;
+	return space->engine == &defrag->memtx->base &&
+	       memtx_space->replace == memtx_space_replace_all_keys &&
+	       !memtx_space_has_func_index(space);
+}
+
+static int
+memtx_defrag_add_space(struct space *space, void *ctx)
+{
+	struct memtx_defrag *defrag = (struct memtx_defrag *)ctx;
+	if (space_is_system(space) ||
+	    !memtx_defrag_space_is_eligible(defrag, space))
+		return 0;
+	if (defrag->space_count == defrag->space_capacity) {
+		uint32_t capacity = MAX(defrag->space_capacity * 2, 16);
+		uint32_t *ids = realloc(defrag->space_ids,
+					capacity * sizeof(*ids));
+		if (ids == NULL) {
+			diag_set(OutOfMemory, capacity * sizeof(*ids),
+				 "realloc", "defrag->space_ids");
+			return -1;
+		}
+		defrag->space_ids = ids;
+		defrag->space_capacity = capacity;
+	}
+	defrag->space_ids[defrag->space_count++] = space_id(space);
+	return 0;
+}
+
+static int
+memtx_defrag_check_pool(const struct mempool_stats *stats, void *ctx)
+{
+	struct memtx_defrag *defrag = (struct memtx_defrag *)ctx;
+	/* A pool with one slab can't be compacted. */
+	if (stats->slabcount > 1 && stats->totals.used <
+	    stats->totals.total * defrag->memtx->defrag_threshold)
+		defrag->is_active = true;
+	return 0;
+}
+
+/**
+ * Start a defragmentation cycle if there is a pool that uses
+ * less than memtx_engine::defrag_threshold of its memory.
+ * Return false if there's nothing to do.
+ */
+static bool
+memtx_defrag_start(struct memtx_defrag *defrag)
+{
+	struct memtx_engine *memtx = defrag->memtx;
+	if (memtx->state != MEMTX_OK)
+		return false;
+	struct small_stats totals;
+	small_stats(&memtx->alloc, &totals, memtx_defrag_check_pool, defrag);
+	if (!defrag->is_active)
+		return false;
+	/*
+	 * Tuples that couldn't be moved last time won't move
+	 * now unless something has changed since then.
+	 */
+	if (defrag->last_relocated == 0 && totals.used == defrag->last_used) {
+		defrag->is_active = false;
+		return false;
+	}
+	if (defrag->slabs == NULL) {
+		defrag->slabs = mh_memtx_defrag_slab_new();
+		if (defrag->slabs == NULL) {
+			diag_set(OutOfMemory, sizeof(*defrag->slabs),
+				 "malloc", "struct mh_memtx_defrag_slab_t");
+			goto fail;
+		}
+	}
+	mh_memtx_defrag_slab_clear(defrag->slabs);
+	defrag->space_count = 0;
+	if (space_foreach(memtx_defrag_add_space, defrag) != 0)
+		goto fail;
+	defrag->space_pos = 0;
+	defrag->pk = NULL;
+	defrag->is_relocating = false;
+	defrag->relocated = 0;
+	return true;
+fail:
+	diag_log();
+	defrag->is_active = false;
+	return false;
+}
+
+static void
+memtx_defrag_stop(struct memtx_defrag *defrag)
+{
+	struct small_stats totals;
+	small_stats(&defrag->memtx->alloc, &totals,
+		    small_stats_noop_cb, NULL);
+	if (defrag->relocated > 0) {
+		say_info("memtx defragmentation moved %zu tuples, "
+			 "%zu bytes of %zu are in use", defrag->relocated,
+			 totals.used, totals.total);
+	}
+	defrag->last_relocated = defrag->relocated;
+	defrag->last_used = totals.used;
+	defrag->is_active = false;
+}
+
+/** Proceed to the next space of the cycle. */
+static void
+memtx_defrag_next_space(struct memtx_defrag *defrag)
+{
+	defrag->space_pos++;
+	defrag->pk = NULL;
+	free(defrag->key);
+	defrag->key = NULL;
+	defrag->key_capacity = 0;
+	if (defrag->space_pos < defrag->space_count)
+		return;
+	if (defrag->is_relocating) {
+		memtx_defrag_stop(defrag);
+		return;
+	}
+	defrag->is_relocating = true;
+	defrag->space_pos = 0;
+}
+
+/** Remember the key of the last processed tuple. */
+static int
+memtx_defrag_set_key(struct memtx_defrag *defrag, struct tuple *tuple)
+{
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	uint32_t key_size;
+	const char *key = tuple_extract_key(tuple, defrag->pk->def->key_def,
+					    &key_size);
+	if (key == NULL)
+		return -1;
+	if (key_size > defrag->key_capacity) {
+		char *buf = realloc(defrag->key, key_size);
+		if (buf == NULL) {
+			diag_set(OutOfMemory, key_size, "realloc",
+				 "defrag->key");
+			region_truncate(region, region_svp);
+			return -1;
+		}
+		defrag->key = buf;
+		defrag->key_capacity = key_size;
+	}
+	memcpy(defrag->key, key, key_size);
+	region_truncate(region, region_svp);
+	return 0;
+}
+
+/**
+ * Process the next batch of tuples. The tx thread doesn't
+ * yield while a batch is processed, so tuples of the batch
+ * can't be deleted under our feet.
+ */
+static void
+memtx_defrag_step(struct memtx_defrag *defrag)
+{
+	/* Use smaller batches in debug mode. */
+#ifdef NDEBUG
+	enum { DEFRAG_BATCH_SIZE = 1000 };
+#else
+	enum { DEFRAG_BATCH_SIZE = 10 };
+#endif
+	struct space *space = NULL;
+	while (defrag->is_active) {
+		if (defrag->space_pos < defrag->space_count) {
+			uint32_t id = defrag->space_ids[defrag->space_pos];
+			space = space_by_id(id);
+			if (space != NULL &&
+			    memtx_defrag_space_is_eligible(defrag, space) &&
+			    (defrag->pk == NULL ||
+			     defrag->pk == space->index[0]))
+				break;
+			space = NULL;
+		}
+		memtx_defrag_next_space(defrag);
+	}
+	if (space == NULL)
+		return;
+	if (memtx_defrag_update_pools(defrag) != 0)
+		goto fail;
+
+	struct index *pk = space->index[0];
+	defrag->pk = pk;
+	struct iterator *it;
+	if (defrag->key != NULL) {
+		it = index_create_iterator(pk, ITER_GT, defrag->key,
+					   pk->def->key_def->part_count);
+	} else {
+		it = index_create_iterator(pk, ITER_ALL, NULL, 0);
+	}
+	if (it == NULL)
+		goto fail;
+	struct tuple *batch[DEFRAG_BATCH_SIZE];
+	int count = 0, rc = 0;
+	struct tuple *tuple;
+	while (count < DEFRAG_BATCH_SIZE &&
+	       (rc = iterator_next(it, &tuple)) == 0 && tuple != NULL)
+		batch[count++] = tuple;
+	iterator_delete(it);
+	if (rc != 0)
+		goto fail;
+	if (count > 0 && memtx_defrag_set_key(defrag, batch[count - 1]) != 0)
+		goto fail;
+
+	for (int i = 0; i < count; i++) {
+		if (!defrag->is_relocating) {
+			rc = memtx_defrag_count(defrag, batch[i]);
+		} else {
+			rc = memtx_defrag_relocate(defrag, space, batch[i]);
+			if (rc > 0) {
+				/*
+				 * Out of memory. Skip the rest of
+				 * the batch, memory may be freed by
+				 * the time the next one is processed.
+				 */
+				return;
+			}
+		}
+		if (rc != 0)
+			goto fail;
+	}
+	if (count < DEFRAG_BATCH_SIZE)
+		memtx_defrag_next_space(defrag);
+	return;
+fail:
+	diag_log();
+	memtx_defrag_stop(defrag);
+}
+
+static int
+memtx_engine_defrag_f(va_list va)
+{
+	struct memtx_engine *memtx = va_arg(va, struct memtx_engine *);
+	struct memtx_defrag defrag;
+	memtx_defrag_create(&defrag, memtx);
+	while (!fiber_is_cancelled()) {
+		if (memtx->defrag_threshold == 0) {
+			if (defrag.is_active)
+				memtx_defrag_stop(&defrag);
+			fiber_yield_timeout(TIMEOUT_INFINITY);
+			continue;
+		}
+		if (!defrag.is_active && !memtx_defrag_start(&defrag)) {
+			fiber_yield_timeout(MEMTX_DEFRAG_CHECK_PERIOD);
+			continue;
+		}
+		memtx_defrag_step(&defrag);
+		/*
+		 * Yield after each step so as not to block
+		 * tx thread for too long.
+		 */
+		fiber_sleep(0);
+	}
+	memtx_defrag_destroy(&defrag);
+	return 0;
+}
+
 struct memtx_engine *
 memtx_engine_new(const char *snap_dirname, bool force_recovery,
-		 uint64_t tuple_arena_max_size, uint32_t objsize_min,
-		 float alloc_factor)
+		 uint64_t tuple_arena_max_size,
+		 const struct tuple_arena_opts *arena_opts,
+		 uint32_t objsize_min, float alloc_factor)
 {
 	struct memtx_engine *memtx = calloc(1, sizeof(*memtx));
 	if (memtx == NULL) {
@@ -1045,9 +2650,16 @@ memtx_engine_new(const char *snap_dirname, bool force_recovery,
 	}
 
 	stailq_create(&memtx->gc_queue);
+	rlist_create(&memtx->build_list);
+	rlist_create(&memtx->read_views);
+	stailq_create(&memtx->tuple_garbage);
 	memtx->gc_fiber = fiber_new("memtx.gc", memtx_engine_gc_f);
 	if (memtx->gc_fiber == NULL)
 		goto fail;
+	memtx->defrag_fiber = fiber_new("memtx.defrag",
+					memtx_engine_defrag_f);
+	if (memtx->defrag_fiber == NULL)
+		goto fail;
 
 	/* Apply lowest allowed objsize bound. */
 	if (objsize_min < OBJSIZE_MIN)
@@ -1055,8 +2667,9 @@ memtx_engine_new(const char *snap_dirname, bool force_recovery,
 
 	/* Initialize tuple allocator. */
 	quota_init(&memtx->quota, tuple_arena_max_size);
+	memtx->arena_opts = *arena_opts;
 	tuple_arena_create(&memtx->arena, &memtx->quota, tuple_arena_max_size,
-			   SLAB_SIZE, "memtx");
+			   SLAB_SIZE, &memtx->arena_opts, "memtx");
 	slab_cache_create(&memtx->slab_cache, &memtx->arena);
 	small_alloc_create(&memtx->alloc, &memtx->slab_cache,
 			   objsize_min, alloc_factor);
@@ -1072,12 +2685,14 @@ memtx_engine_new(const char *snap_dirname, bool force_recovery,
 
 	memtx->state = MEMTX_INITIALIZED;
 	memtx->max_tuple_size = MAX_TUPLE_SIZE;
+	memtx->snap_threads = 1;
 	memtx->force_recovery = force_recovery;
 
 	memtx->base.vtab = &memtx_engine_vtab;
 	memtx->base.name = "memtx";
 
 	fiber_start(memtx->gc_fiber, memtx);
+	fiber_start(memtx->defrag_fiber, memtx);
 	return memtx;
 fail:
 	xdir_destroy(&memtx->snap_dir);
@@ -1089,6 +2704,7 @@ void
 memtx_engine_schedule_gc(struct memtx_engine *memtx,
 			 struct memtx_gc_task *task)
 {
+	task->version = memtx->snapshot_version;
 	stailq_add_tail_entry(&memtx->gc_queue, task, link);
 	fiber_wakeup(memtx->gc_fiber);
 }
@@ -1099,6 +2715,13 @@ memtx_engine_set_snap_io_rate_limit(struct memtx_engine *memtx, double limit)
 	memtx->snap_io_rate_limit = limit * 1024 * 1024;
 }
 
+void
+memtx_engine_set_snap_threads(struct memtx_engine *memtx, int threads)
+{
+	assert(threads >= 1 && threads <= MEMTX_SNAP_THREADS_MAX);
+	memtx->snap_threads = threads;
+}
+
 int
 memtx_engine_set_memory(struct memtx_engine *memtx, size_t size)
 {
@@ -1117,6 +2740,15 @@ memtx_engine_set_max_tuple_size(struct memtx_engine *memtx, size_t max_size)
 	memtx->max_tuple_size = max_size;
 }
 
+void
+memtx_engine_set_defrag_threshold(struct memtx_engine *memtx,
+				  double threshold)
+{
+	memtx->defrag_threshold = threshold;
+	if (threshold > 0)
+		fiber_wakeup(memtx->defrag_fiber);
+}
+
 struct tuple *
 memtx_tuple_new(struct tuple_format *format, const char *data, const char *end)
 {
@@ -1125,6 +2757,9 @@ memtx_tuple_new(struct tuple_format *format, const char *data, const char *end)
 	struct tuple *tuple = NULL;
 	struct region *region = &fiber()->gc;
 	size_t region_svp = region_used(region);
+	if (format->is_compressed &&
+	    tuple_compress_data(format, &data, &end) != 0)
+		goto end;
 	uint32_t *field_map, field_map_size;
 	if (tuple_field_map_create(format, data, true, &field_map,
 				   &field_map_size) != 0)
@@ -1182,17 +2817,27 @@ memtx_tuple_delete(struct tuple_format *format, struct tuple *tuple)
 	struct memtx_engine *memtx = (struct memtx_engine *)format->engine;
 	say_debug("%s(%p)", __func__, tuple);
 	assert(tuple->refs == 0);
-	size_t total = sizeof(struct memtx_tuple) + format->field_map_size +
-		tuple->bsize;
-	tuple_format_unref(format);
 	struct memtx_tuple *memtx_tuple =
 		container_of(tuple, struct memtx_tuple, base);
-	if (memtx->alloc.free_mode != SMALL_DELAYED_FREE ||
+	if (!memtx_engine_has_read_views(memtx) ||
 	    memtx_tuple->version == memtx->snapshot_version ||
-	    format->is_temporary)
-		smfree(&memtx->alloc, memtx_tuple, total);
-	else
-		smfree_delayed(&memtx->alloc, memtx_tuple, total);
+	    format->is_temporary) {
+		memtx_tuple_free(memtx, format, memtx_tuple);
+		return;
+	}
+	/*
+	 * The tuple may be visible from an open read view.
+	 * Put it to the garbage list of the current version.
+	 * The format stays referenced till the tuple is freed
+	 * so that the tuple can still be decoded.
+	 */
+	struct memtx_tuple_garbage *garbage =
+		stailq_last_entry(&memtx->tuple_garbage,
+				  struct memtx_tuple_garbage,
+				  in_tuple_garbage);
+	assert(garbage->version == memtx->snapshot_version);
+	memtx_tuple_set_next_garbage(memtx_tuple, garbage->first);
+	garbage->first = memtx_tuple;
 }
 
 struct tuple_format_vtab memtx_tuple_format_vtab = {
@@ -1290,6 +2935,10 @@ memtx_index_def_change_requires_rebuild(struct index *index,
 		return true;
 	if (!old_def->opts.is_unique && new_def->opts.is_unique)
 		return true;
+	if (old_def->opts.func_id != new_def->opts.func_id)
+		return true;
+	if (old_def->opts.layout != new_def->opts.layout)
+		return true;
 
 	const struct key_def *old_cmp_def, *new_cmp_def;
 	if (index_depends_on_pk(index)) {
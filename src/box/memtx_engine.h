@@ -39,6 +39,7 @@
 
 #include "engine.h"
 #include "xlog.h"
+#include "tuple.h" /* struct tuple_arena_opts */
 #include "salad/stailq.h"
 
 #if defined(__cplusplus)
@@ -95,6 +96,9 @@ extern struct mempool memtx_index_extent_pool;
  */
 #define MEMTX_ITERATOR_SIZE (152)
 
+/** Max number of threads writing a snapshot, box.cfg.memtx_snap_threads. */
+enum { MEMTX_SNAP_THREADS_MAX = 64 };
+
 struct memtx_engine {
 	struct engine base;
 	/** Engine recovery state. */
@@ -105,6 +109,11 @@ struct memtx_engine {
 	struct xdir snap_dir;
 	/** Limit disk usage of checkpointing (bytes per second). */
 	uint64_t snap_io_rate_limit;
+	/**
+	 * Number of threads writing a snapshot. If greater
+	 * than one, the snapshot is split into as many files.
+	 */
+	int snap_threads;
 	/** Skip invalid snapshot records if this flag is set. */
 	bool force_recovery;
 	/** Common quota for tuples and indexes. */
@@ -116,6 +125,11 @@ struct memtx_engine {
 	 * is reflected in box.slab.info(), @sa lua/slab.c.
 	 */
 	struct slab_arena arena;
+	/**
+	 * Memory placement options the arena was actually
+	 * created with, see tuple_arena_create().
+	 */
+	struct tuple_arena_opts arena_opts;
 	/** Slab cache for allocating tuples. */
 	struct slab_cache slab_cache;
 	/** Tuple allocator. */
@@ -135,8 +149,20 @@ struct memtx_engine {
 	void *reserved_extents;
 	/** Maximal allowed tuple size, box.cfg.memtx_max_tuple_size. */
 	size_t max_tuple_size;
-	/** Incremented with each next snapshot. */
+	/** Incremented with each next snapshot or read view. */
 	uint32_t snapshot_version;
+	/**
+	 * Open read views, including the one used by checkpoint,
+	 * ordered by version, linked by
+	 * memtx_read_view_version::in_read_views.
+	 */
+	struct rlist read_views;
+	/**
+	 * Tuples deleted while read views were open, grouped by
+	 * snapshot_version at the time of deletion, oldest first.
+	 * See memtx_tuple_delete().
+	 */
+	struct stailq tuple_garbage;
 	/** Memory pool for rtree index iterator. */
 	struct mempool rtree_iterator_pool;
 	/**
@@ -155,6 +181,19 @@ struct memtx_engine {
 	 * memtx_gc_task::link.
 	 */
 	struct stailq gc_queue;
+	/**
+	 * Fiber relocating tuples out of sparsely used slabs,
+	 * see memtx_engine_set_defrag_threshold().
+	 */
+	struct fiber *defrag_fiber;
+	/** box.cfg.memtx_defrag_threshold, 0 if disabled. */
+	double defrag_threshold;
+	/**
+	 * States of index builds done by ALTER requests that
+	 * haven't completed yet, linked by memtx_build_ctx::link.
+	 * See memtx_space_build_index().
+	 */
+	struct rlist build_list;
 };
 
 struct memtx_gc_task;
@@ -177,6 +216,12 @@ struct memtx_gc_task {
 	struct stailq_entry link;
 	/** Virtual function table. */
 	const struct memtx_gc_task_vtab *vtab;
+	/**
+	 * memtx_engine::snapshot_version when the task was
+	 * scheduled. The task isn't freed until all read views
+	 * created before are closed.
+	 */
+	uint32_t version;
 };
 
 /**
@@ -189,6 +234,7 @@ memtx_engine_schedule_gc(struct memtx_engine *memtx,
 struct memtx_engine *
 memtx_engine_new(const char *snap_dirname, bool force_recovery,
 		 uint64_t tuple_arena_max_size,
+		 const struct tuple_arena_opts *arena_opts,
 		 uint32_t objsize_min, float alloc_factor);
 
 int
@@ -201,9 +247,96 @@ memtx_engine_set_snap_io_rate_limit(struct memtx_engine *memtx, double limit);
 int
 memtx_engine_set_memory(struct memtx_engine *memtx, size_t size);
 
+void
+memtx_engine_set_snap_threads(struct memtx_engine *memtx, int threads);
+
 void
 memtx_engine_set_max_tuple_size(struct memtx_engine *memtx, size_t max_size);
 
+/**
+ * Set the slab utilization below which tuples are moved out
+ * of a slab so that it can be returned to the arena and reused
+ * for tuples of another size or index extents. Only tuples
+ * referenced by nothing but their space are moved, a few at
+ * a time, while the tx thread has nothing else to do. Zero
+ * disables defragmentation.
+ */
+void
+memtx_engine_set_defrag_threshold(struct memtx_engine *memtx,
+				  double threshold);
+
+/**
+ * A version of memtx memory pinned by a read view, see
+ * memtx_engine_enter_read_view().
+ */
+struct memtx_read_view_version {
+	/** memtx_engine::snapshot_version assigned to the view. */
+	uint32_t version;
+	/** Link in memtx_engine::read_views. */
+	struct rlist in_read_views;
+};
+
+/**
+ * Pin the current state of memtx memory for a read view:
+ * tuples and indexes deleted from now on are not freed until
+ * the view is closed with memtx_engine_leave_read_view(), so
+ * indexes frozen right after this call can be read while tx
+ * goes on modifying them. Returns -1 and sets diag on error.
+ */
+int
+memtx_engine_enter_read_view(struct memtx_engine *memtx,
+			     struct memtx_read_view_version *rv);
+
+/** Unpin memory pinned by memtx_engine_enter_read_view(). */
+void
+memtx_engine_leave_read_view(struct memtx_engine *memtx,
+			     struct memtx_read_view_version *rv);
+
+/** Return true if there is at least one read view open. */
+static inline bool
+memtx_engine_has_read_views(struct memtx_engine *memtx)
+{
+	return !rlist_empty(&memtx->read_views);
+}
+
+/**
+ * A consistent read view of all memtx spaces, except
+ * temporary ones. TREE indexes are frozen with
+ * memtx_tree_view_new(), so the view doesn't copy any data and
+ * doesn't block writers. A frozen index may be read with any
+ * number of iterators, see memtx_tree_view_iterator_new(),
+ * while the tx thread yields.
+ *
+ * Tuples freed while a read view is open are not returned
+ * to the allocator till it is closed, so a long living read
+ * view may increase memory consumption. A tuple returned by
+ * a read view iterator may be referenced, in which case it
+ * outlives the view.
+ */
+struct memtx_read_view;
+struct memtx_tree_view;
+
+/**
+ * Create a read view of memtx spaces.
+ * Returns NULL and sets diag on error.
+ */
+struct memtx_read_view *
+memtx_read_view_new(struct memtx_engine *memtx);
+
+/** Close a read view. */
+void
+memtx_read_view_delete(struct memtx_read_view *rv);
+
+/**
+ * Return index @a index_id of space @a space_id frozen in
+ * a read view. The index is valid until the view is closed.
+ * Returns NULL and sets diag if there's no such space or
+ * index in the view or the index isn't a TREE.
+ */
+struct memtx_tree_view *
+memtx_read_view_index(struct memtx_read_view *rv, uint32_t space_id,
+		      uint32_t index_id);
+
 /** Allocate a memtx tuple. @sa tuple_new(). */
 struct tuple *
 memtx_tuple_new(struct tuple_format *format, const char *data, const char *end);
@@ -257,11 +390,12 @@ memtx_index_def_change_requires_rebuild(struct index *index,
 static inline struct memtx_engine *
 memtx_engine_new_xc(const char *snap_dirname, bool force_recovery,
 		    uint64_t tuple_arena_max_size,
+		    const struct tuple_arena_opts *arena_opts,
 		    uint32_t objsize_min, float alloc_factor)
 {
 	struct memtx_engine *memtx;
 	memtx = memtx_engine_new(snap_dirname, force_recovery,
-				 tuple_arena_max_size,
+				 tuple_arena_max_size, arena_opts,
 				 objsize_min, alloc_factor);
 	if (memtx == NULL)
 		diag_raise();
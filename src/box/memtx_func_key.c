@@ -0,0 +1,133 @@
+/*
+ * Copyright 2010-2019, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include "memtx_func_key.h"
+
+#include "assoc.h"
+#include "diag.h"
+#include "func_key.h"
+#include "memtx_engine.h"
+#include "tuple.h"
+#include "tuple_format.h"
+
+int
+memtx_func_key_map_create(struct memtx_func_key_map *map,
+			  struct memtx_engine *memtx)
+{
+	map->hash = mh_i64ptr_new();
+	if (map->hash == NULL) {
+		diag_set(OutOfMemory, sizeof(*map->hash), "malloc",
+			 "functional index key map");
+		return -1;
+	}
+	map->format = tuple_format_new(&memtx_tuple_format_vtab, memtx,
+				       NULL, 0, NULL, 0, 0, NULL,
+				       false, false);
+	if (map->format == NULL) {
+		mh_i64ptr_delete(map->hash);
+		return -1;
+	}
+	tuple_format_ref(map->format);
+	map->key_bsize = 0;
+	return 0;
+}
+
+void
+memtx_func_key_map_destroy(struct memtx_func_key_map *map)
+{
+	struct mh_i64ptr_t *h = map->hash;
+	mh_int_t k;
+	mh_foreach(h, k) {
+		struct mh_i64ptr_node_t *node = mh_i64ptr_node(h, k);
+		tuple_unref((struct tuple *)(uintptr_t)node->key);
+		tuple_unref((struct tuple *)node->val);
+	}
+	mh_i64ptr_delete(h);
+	tuple_format_unref(map->format);
+}
+
+struct tuple *
+memtx_func_key_map_find(struct memtx_func_key_map *map,
+			struct tuple *tuple)
+{
+	struct mh_i64ptr_t *h = map->hash;
+	mh_int_t k = mh_i64ptr_find(h, (uintptr_t)tuple, NULL);
+	if (k == mh_end(h))
+		return NULL;
+	return mh_i64ptr_node(h, k)->val;
+}
+
+struct tuple *
+memtx_func_key_map_get(struct memtx_func_key_map *map,
+		       struct index_def *index_def, struct tuple *tuple,
+		       bool *is_new)
+{
+	struct tuple *key = memtx_func_key_map_find(map, tuple);
+	if (key != NULL) {
+		*is_new = false;
+		return key;
+	}
+	key = func_key_new(index_def, map->format, tuple);
+	if (key == NULL)
+		return NULL;
+	tuple_ref(key);
+	struct mh_i64ptr_node_t node = { (uintptr_t)tuple, key };
+	if (mh_i64ptr_put(map->hash, &node, NULL, NULL) == mh_end(map->hash)) {
+		diag_set(OutOfMemory, 0, "mh_i64ptr_put", "mh_i64ptr_node_t");
+		tuple_unref(key);
+		return NULL;
+	}
+	tuple_ref(tuple);
+	map->key_bsize += tuple_size(key);
+	*is_new = true;
+	return key;
+}
+
+void
+memtx_func_key_map_delete(struct memtx_func_key_map *map,
+			  struct tuple *tuple)
+{
+	struct mh_i64ptr_t *h = map->hash;
+	mh_int_t k = mh_i64ptr_find(h, (uintptr_t)tuple, NULL);
+	if (k == mh_end(h))
+		return;
+	struct tuple *key = mh_i64ptr_node(h, k)->val;
+	mh_i64ptr_del(h, k, NULL);
+	assert(map->key_bsize >= tuple_size(key));
+	map->key_bsize -= tuple_size(key);
+	tuple_unref(key);
+	tuple_unref(tuple);
+}
+
+size_t
+memtx_func_key_map_bsize(struct memtx_func_key_map *map)
+{
+	return map->key_bsize + mh_i64ptr_memsize(map->hash);
+}
@@ -0,0 +1,117 @@
+#ifndef TARANTOOL_BOX_MEMTX_FUNC_KEY_H_INCLUDED
+#define TARANTOOL_BOX_MEMTX_FUNC_KEY_H_INCLUDED
+/*
+ * Copyright 2010-2019, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include <stdbool.h>
+#include <stddef.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+struct index_def;
+struct memtx_engine;
+struct mh_i64ptr_t;
+struct tuple;
+struct tuple_format;
+
+/**
+ * Keys of a memtx functional index.
+ *
+ * Computing a key takes a call of the index function, which may
+ * fail, so a key is computed only once, when a tuple is inserted
+ * into the index for the first time, and then stored in this map.
+ * The key is kept after the tuple is deleted from the index until
+ * the statement that deleted it is committed or rolled back, see
+ * memtx_space_forget_func_keys(). This way putting a tuple back to
+ * the index on rollback doesn't call the function and can't fail.
+ *
+ * Keys are allocated from the memtx arena so they are subject to
+ * the memtx quota.
+ */
+struct memtx_func_key_map {
+	/**
+	 * Tuple -> key. Both the tuple and the key are
+	 * referenced by the map, so that a tuple can't be
+	 * freed and replaced with another one at the same
+	 * address while its key is stored here.
+	 */
+	struct mh_i64ptr_t *hash;
+	/** Format of keys. */
+	struct tuple_format *format;
+	/** Total size of stored keys. */
+	size_t key_bsize;
+};
+
+/**
+ * Initialize a key map.
+ * @retval  0 Success.
+ * @retval -1 Memory error, diag is set.
+ */
+int
+memtx_func_key_map_create(struct memtx_func_key_map *map,
+			  struct memtx_engine *memtx);
+
+/** Release all keys stored in a map and free it. */
+void
+memtx_func_key_map_destroy(struct memtx_func_key_map *map);
+
+/** Return the key stored for a tuple or NULL if there's none. */
+struct tuple *
+memtx_func_key_map_find(struct memtx_func_key_map *map,
+			struct tuple *tuple);
+
+/**
+ * Return the key of a tuple. If it isn't stored in the map yet,
+ * compute it by calling the function of the given index and add
+ * it to the map, in which case @a is_new is set.
+ * @retval not NULL Key tuple, referenced by the map.
+ * @retval NULL Error, diag is set.
+ */
+struct tuple *
+memtx_func_key_map_get(struct memtx_func_key_map *map,
+		       struct index_def *index_def, struct tuple *tuple,
+		       bool *is_new);
+
+/** Drop the key of a tuple from a map, if any. */
+void
+memtx_func_key_map_delete(struct memtx_func_key_map *map,
+			  struct tuple *tuple);
+
+/** Return the amount of memory used by a map, including keys. */
+size_t
+memtx_func_key_map_bsize(struct memtx_func_key_map *map);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
+
+#endif /* TARANTOOL_BOX_MEMTX_FUNC_KEY_H_INCLUDED */
@@ -37,20 +37,56 @@
 #include "space.h"
 #include "schema.h" /* space_cache_find() */
 #include "errinj.h"
+#include "memtx_func_key.h"
 
 #include <small/mempool.h>
 
+/** Argument of hash table comparison functions. */
+struct memtx_hash_cmp_arg {
+	/** Index key definition. */
+	struct key_def *key_def;
+	/**
+	 * Keys of tuples stored in a functional index or NULL
+	 * if the index isn't functional. Tuples of a functional
+	 * index are hashed and compared by their stored keys.
+	 */
+	struct memtx_func_key_map *func_keys;
+};
+
+/** Return the key of a tuple stored in a functional index. */
+static inline const char *
+memtx_hash_func_key(struct memtx_hash_cmp_arg *arg, struct tuple *tuple)
+{
+	struct tuple *key = memtx_func_key_map_find(arg->func_keys, tuple);
+	assert(key != NULL);
+	return tuple_data(key);
+}
+
 static inline bool
 memtx_hash_equal(struct tuple *tuple_a, struct tuple *tuple_b,
-		 struct key_def *key_def)
+		 struct memtx_hash_cmp_arg *arg)
 {
-	return tuple_compare(tuple_a, tuple_b, key_def) == 0;
+	if (arg->func_keys != NULL) {
+		return tuple_compare_func(tuple_a,
+					  memtx_hash_func_key(arg, tuple_a),
+					  tuple_b,
+					  memtx_hash_func_key(arg, tuple_b),
+					  arg->key_def) == 0;
+	}
+	return tuple_compare(tuple_a, tuple_b, arg->key_def) == 0;
 }
 
 static inline bool
 memtx_hash_equal_key(struct tuple *tuple, const char *key,
-		     struct key_def *key_def)
+		     struct memtx_hash_cmp_arg *arg)
 {
+	struct key_def *key_def = arg->key_def;
+	if (arg->func_keys != NULL) {
+		return tuple_compare_with_key_func(tuple,
+					memtx_hash_func_key(arg, tuple),
+					key, key_def->part_count,
+					key_def) == 0;
+	}
 	return tuple_compare_with_key(tuple, key, key_def->part_count,
 				      key_def) == 0;
 }
@@ -58,11 +94,12 @@ memtx_hash_equal_key(struct tuple *tuple, const char *key,
 #define LIGHT_NAME _index
 #define LIGHT_DATA_TYPE struct tuple *
 #define LIGHT_KEY_TYPE const char *
-#define LIGHT_CMP_ARG_TYPE struct key_def *
+#define LIGHT_CMP_ARG_TYPE struct memtx_hash_cmp_arg *
 #define LIGHT_EQUAL(a, b, c) memtx_hash_equal(a, b, c)
 #define LIGHT_EQUAL_KEY(a, b, c) memtx_hash_equal_key(a, b, c)
 
 #include "salad/light.h"
+#include "salad/light_swiss.h"
 
 #undef LIGHT_NAME
 #undef LIGHT_DATA_TYPE
@@ -71,19 +108,219 @@ memtx_hash_equal_key(struct tuple *tuple, const char *key,
 #undef LIGHT_EQUAL
 #undef LIGHT_EQUAL_KEY
 
+/**
+ * Hash table of a memtx HASH index. The layout is chosen per
+ * index with the 'layout' index option. Positions returned by
+ * lookup functions are opaque and only valid until the table
+ * is modified next time.
+ */
+struct memtx_hash_table {
+	enum hash_index_layout layout;
+	union {
+		struct light_index_core chained;
+		struct light_swiss_index_core open;
+	};
+};
+
+struct memtx_hash_table_iterator {
+	union {
+		struct light_index_iterator chained;
+		struct light_swiss_index_iterator open;
+	};
+};
+
+/** Equals both light_index_end and light_swiss_index_end. */
+static const uint32_t memtx_hash_table_end = 0xFFFFFFFF;
+
+static void
+memtx_hash_table_create(struct memtx_hash_table *table,
+			enum hash_index_layout layout,
+			struct memtx_engine *memtx,
+			struct memtx_hash_cmp_arg *arg)
+{
+	table->layout = layout;
+	if (layout == HASH_INDEX_LAYOUT_OPEN) {
+		light_swiss_index_create(&table->open, MEMTX_EXTENT_SIZE,
+					 memtx_index_extent_alloc,
+					 memtx_index_extent_free,
+					 memtx, arg);
+	} else {
+		light_index_create(&table->chained, MEMTX_EXTENT_SIZE,
+				   memtx_index_extent_alloc,
+				   memtx_index_extent_free,
+				   memtx, arg);
+	}
+}
+
+static void
+memtx_hash_table_destroy(struct memtx_hash_table *table)
+{
+	if (table->layout == HASH_INDEX_LAYOUT_OPEN)
+		light_swiss_index_destroy(&table->open);
+	else
+		light_index_destroy(&table->chained);
+}
+
+static inline uint32_t
+memtx_hash_table_count(const struct memtx_hash_table *table)
+{
+	if (table->layout == HASH_INDEX_LAYOUT_OPEN)
+		return table->open.count;
+	return table->chained.count;
+}
+
+static inline matras_id_t
+memtx_hash_table_extent_count(const struct memtx_hash_table *table)
+{
+	if (table->layout == HASH_INDEX_LAYOUT_OPEN)
+		return light_swiss_index_extent_count(&table->open);
+	return matras_extent_count(&table->chained.mtable);
+}
+
+static inline uint32_t
+memtx_hash_table_find_key(const struct memtx_hash_table *table,
+			  uint32_t hash, const char *key)
+{
+	if (table->layout == HASH_INDEX_LAYOUT_OPEN)
+		return light_swiss_index_find_key(&table->open, hash, key);
+	return light_index_find_key(&table->chained, hash, key);
+}
+
+static inline struct tuple *
+memtx_hash_table_get(struct memtx_hash_table *table, uint32_t pos)
+{
+	if (table->layout == HASH_INDEX_LAYOUT_OPEN)
+		return light_swiss_index_get(&table->open, pos);
+	return light_index_get(&table->chained, pos);
+}
+
+static inline uint32_t
+memtx_hash_table_replace(struct memtx_hash_table *table, uint32_t hash,
+			 struct tuple *tuple, struct tuple **replaced)
+{
+	if (table->layout == HASH_INDEX_LAYOUT_OPEN)
+		return light_swiss_index_replace(&table->open, hash, tuple,
+						 replaced);
+	return light_index_replace(&table->chained, hash, tuple, replaced);
+}
+
+static inline uint32_t
+memtx_hash_table_insert(struct memtx_hash_table *table, uint32_t hash,
+			struct tuple *tuple)
+{
+	if (table->layout == HASH_INDEX_LAYOUT_OPEN)
+		return light_swiss_index_insert(&table->open, hash, tuple);
+	return light_index_insert(&table->chained, hash, tuple);
+}
+
+static inline int
+memtx_hash_table_delete(struct memtx_hash_table *table, uint32_t pos)
+{
+	if (table->layout == HASH_INDEX_LAYOUT_OPEN)
+		return light_swiss_index_delete(&table->open, pos);
+	return light_index_delete(&table->chained, pos);
+}
+
+static inline int
+memtx_hash_table_delete_value(struct memtx_hash_table *table, uint32_t hash,
+			      struct tuple *tuple)
+{
+	if (table->layout == HASH_INDEX_LAYOUT_OPEN)
+		return light_swiss_index_delete_value(&table->open, hash,
+						      tuple);
+	return light_index_delete_value(&table->chained, hash, tuple);
+}
+
+static inline struct tuple *
+memtx_hash_table_random(struct memtx_hash_table *table, uint32_t rnd)
+{
+	if (table->layout == HASH_INDEX_LAYOUT_OPEN) {
+		uint32_t pos = light_swiss_index_random(&table->open, rnd);
+		if (pos == light_swiss_index_end)
+			return NULL;
+		return light_swiss_index_get(&table->open, pos);
+	}
+	struct light_index_core *hash_table = &table->chained;
+	if (hash_table->count == 0)
+		return NULL;
+	rnd %= (hash_table->table_size);
+	while (!light_index_pos_valid(hash_table, rnd)) {
+		rnd++;
+		rnd %= (hash_table->table_size);
+	}
+	return light_index_get(hash_table, rnd);
+}
+
+static inline void
+memtx_hash_table_iterator_begin(const struct memtx_hash_table *table,
+				struct memtx_hash_table_iterator *itr)
+{
+	if (table->layout == HASH_INDEX_LAYOUT_OPEN)
+		light_swiss_index_iterator_begin(&table->open, &itr->open);
+	else
+		light_index_iterator_begin(&table->chained, &itr->chained);
+}
+
+static inline void
+memtx_hash_table_iterator_key(const struct memtx_hash_table *table,
+			      struct memtx_hash_table_iterator *itr,
+			      uint32_t hash, const char *key)
+{
+	if (table->layout == HASH_INDEX_LAYOUT_OPEN)
+		light_swiss_index_iterator_key(&table->open, &itr->open,
+					       hash, key);
+	else
+		light_index_iterator_key(&table->chained, &itr->chained,
+					 hash, key);
+}
+
+static inline struct tuple **
+memtx_hash_table_iterator_get_and_next(const struct memtx_hash_table *table,
+				       struct memtx_hash_table_iterator *itr)
+{
+	if (table->layout == HASH_INDEX_LAYOUT_OPEN)
+		return light_swiss_index_iterator_get_and_next(&table->open,
+							       &itr->open);
+	return light_index_iterator_get_and_next(&table->chained,
+						 &itr->chained);
+}
+
+static inline void
+memtx_hash_table_iterator_freeze(struct memtx_hash_table *table,
+				 struct memtx_hash_table_iterator *itr)
+{
+	if (table->layout == HASH_INDEX_LAYOUT_OPEN)
+		light_swiss_index_iterator_freeze(&table->open, &itr->open);
+	else
+		light_index_iterator_freeze(&table->chained, &itr->chained);
+}
+
+static inline void
+memtx_hash_table_iterator_destroy(struct memtx_hash_table *table,
+				  struct memtx_hash_table_iterator *itr)
+{
+	if (table->layout == HASH_INDEX_LAYOUT_OPEN)
+		light_swiss_index_iterator_destroy(&table->open, &itr->open);
+	else
+		light_index_iterator_destroy(&table->chained, &itr->chained);
+}
+
 struct memtx_hash_index {
 	struct index base;
-	struct light_index_core hash_table;
+	struct memtx_hash_table hash_table;
+	struct memtx_hash_cmp_arg cmp_arg;
 	struct memtx_gc_task gc_task;
-	struct light_index_iterator gc_iterator;
+	struct memtx_hash_table_iterator gc_iterator;
+	/** Keys of tuples stored in a functional index. */
+	struct memtx_func_key_map func_keys;
 };
 
 /* {{{ MemtxHash Iterators ****************************************/
 
 struct hash_iterator {
 	struct iterator base; /* Must be the first member. */
-	struct light_index_core *hash_table;
-	struct light_index_iterator iterator;
+	struct memtx_hash_table *hash_table;
+	struct memtx_hash_table_iterator iterator;
 	/** Memory pool the iterator was allocated from. */
 	struct mempool *pool;
 };
@@ -105,8 +342,8 @@ hash_iterator_ge(struct iterator *ptr, struct tuple **ret)
 {
 	assert(ptr->free == hash_iterator_free);
 	struct hash_iterator *it = (struct hash_iterator *) ptr;
-	struct tuple **res = light_index_iterator_get_and_next(it->hash_table,
-							       &it->iterator);
+	struct tuple **res = memtx_hash_table_iterator_get_and_next(
+		it->hash_table, &it->iterator);
 	*ret = res != NULL ? *res : NULL;
 	return 0;
 }
@@ -117,11 +354,11 @@ hash_iterator_gt(struct iterator *ptr, struct tuple **ret)
 	assert(ptr->free == hash_iterator_free);
 	ptr->next = hash_iterator_ge;
 	struct hash_iterator *it = (struct hash_iterator *) ptr;
-	struct tuple **res = light_index_iterator_get_and_next(it->hash_table,
-							       &it->iterator);
+	struct tuple **res = memtx_hash_table_iterator_get_and_next(
+		it->hash_table, &it->iterator);
 	if (res != NULL)
-		res = light_index_iterator_get_and_next(it->hash_table,
-							&it->iterator);
+		res = memtx_hash_table_iterator_get_and_next(it->hash_table,
+							     &it->iterator);
 	*ret = res != NULL ? *res : NULL;
 	return 0;
 }
@@ -147,7 +384,9 @@ hash_iterator_eq(struct iterator *it, struct tuple **ret)
 static void
 memtx_hash_index_free(struct memtx_hash_index *index)
 {
-	light_index_destroy(&index->hash_table);
+	memtx_hash_table_destroy(&index->hash_table);
+	if (index->cmp_arg.func_keys != NULL)
+		memtx_func_key_map_destroy(&index->func_keys);
 	free(index);
 }
 
@@ -166,12 +405,13 @@ memtx_hash_index_gc_run(struct memtx_gc_task *task, bool *done)
 
 	struct memtx_hash_index *index = container_of(task,
 			struct memtx_hash_index, gc_task);
-	struct light_index_core *hash = &index->hash_table;
-	struct light_index_iterator *itr = &index->gc_iterator;
+	struct memtx_hash_table *hash = &index->hash_table;
+	struct memtx_hash_table_iterator *itr = &index->gc_iterator;
 
 	struct tuple **res;
 	unsigned int loops = 0;
-	while ((res = light_index_iterator_get_and_next(hash, itr)) != NULL) {
+	while ((res = memtx_hash_table_iterator_get_and_next(hash,
+							     itr)) != NULL) {
 		tuple_unref(*res);
 		if (++loops >= YIELD_LOOPS) {
 			*done = false;
@@ -206,8 +446,8 @@ memtx_hash_index_destroy(struct index *base)
 		 * background task in order not to block tx thread.
 		 */
 		index->gc_task.vtab = &memtx_hash_index_gc_vtab;
-		light_index_iterator_begin(&index->hash_table,
-					   &index->gc_iterator);
+		memtx_hash_table_iterator_begin(&index->hash_table,
+						&index->gc_iterator);
 		memtx_engine_schedule_gc(memtx, &index->gc_task);
 	} else {
 		/*
@@ -222,39 +462,32 @@ static void
 memtx_hash_index_update_def(struct index *base)
 {
 	struct memtx_hash_index *index = (struct memtx_hash_index *)base;
-	index->hash_table.arg = index->base.def->key_def;
+	index->cmp_arg.key_def = index->base.def->key_def;
 }
 
 static ssize_t
 memtx_hash_index_size(struct index *base)
 {
 	struct memtx_hash_index *index = (struct memtx_hash_index *)base;
-	return index->hash_table.count;
+	return memtx_hash_table_count(&index->hash_table);
 }
 
 static ssize_t
 memtx_hash_index_bsize(struct index *base)
 {
 	struct memtx_hash_index *index = (struct memtx_hash_index *)base;
-	return matras_extent_count(&index->hash_table.mtable) *
+	size_t bsize = memtx_hash_table_extent_count(&index->hash_table) *
 					MEMTX_EXTENT_SIZE;
+	if (index->cmp_arg.func_keys != NULL)
+		bsize += memtx_func_key_map_bsize(&index->func_keys);
+	return bsize;
 }
 
 static int
 memtx_hash_index_random(struct index *base, uint32_t rnd, struct tuple **result)
 {
 	struct memtx_hash_index *index = (struct memtx_hash_index *)base;
-	struct light_index_core *hash_table = &index->hash_table;
-
-	*result = NULL;
-	if (hash_table->count == 0)
-		return 0;
-	rnd %= (hash_table->table_size);
-	while (!light_index_pos_valid(hash_table, rnd)) {
-		rnd++;
-		rnd %= (hash_table->table_size);
-	}
-	*result = light_index_get(hash_table, rnd);
+	*result = memtx_hash_table_random(&index->hash_table, rnd);
 	return 0;
 }
 
@@ -279,46 +512,109 @@ memtx_hash_index_get(struct index *base, const char *key,
 
 	*result = NULL;
 	uint32_t h = key_hash(key, base->def->key_def);
-	uint32_t k = light_index_find_key(&index->hash_table, h, key);
-	if (k != light_index_end)
-		*result = light_index_get(&index->hash_table, k);
+	uint32_t k = memtx_hash_table_find_key(&index->hash_table, h, key);
+	if (k != memtx_hash_table_end)
+		*result = memtx_hash_table_get(&index->hash_table, k);
+	return 0;
+}
+
+/** Hash the stored key of a tuple of a functional index. */
+static inline uint32_t
+memtx_hash_func_key_hash(struct key_def *key_def, struct tuple *key)
+{
+	const char *data = tuple_data(key);
+	mp_decode_array(&data);
+	return key_hash(data, key_def);
+}
+
+/**
+ * Compute the hash of a tuple inserted into an index. The key of
+ * a tuple inserted into a functional index is computed and stored
+ * unless it is stored already, in which case @a is_new_key is set.
+ */
+static int
+memtx_hash_index_tuple_hash(struct memtx_hash_index *index,
+			    struct tuple *tuple, uint32_t *hash,
+			    bool *is_new_key)
+{
+	struct key_def *key_def = index->base.def->key_def;
+	if (index->cmp_arg.func_keys == NULL) {
+		*hash = tuple_hash(tuple, key_def);
+		return 0;
+	}
+	struct tuple *key = memtx_func_key_map_get(&index->func_keys,
+						   index->base.def, tuple,
+						   is_new_key);
+	if (key == NULL)
+		return -1;
+	*hash = memtx_hash_func_key_hash(key_def, key);
 	return 0;
 }
 
+/**
+ * Look up the stored key of a tuple of a functional index and
+ * return its hash. Returns false if no key is stored, i.e. the
+ * tuple has never been inserted into the index.
+ */
+static bool
+memtx_hash_index_find_func_hash(struct memtx_hash_index *index,
+				struct tuple *tuple, uint32_t *hash)
+{
+	struct tuple *key = memtx_func_key_map_find(&index->func_keys, tuple);
+	if (key == NULL)
+		return false;
+	*hash = memtx_hash_func_key_hash(index->base.def->key_def, key);
+	return true;
+}
+
+void
+memtx_hash_index_forget_func_key(struct index *base, struct tuple *tuple)
+{
+	struct memtx_hash_index *index = (struct memtx_hash_index *)base;
+	assert(base->def->type == HASH && index->cmp_arg.func_keys != NULL);
+	memtx_func_key_map_delete(&index->func_keys, tuple);
+}
+
 static int
 memtx_hash_index_replace(struct index *base, struct tuple *old_tuple,
 			 struct tuple *new_tuple, enum dup_replace_mode mode,
 			 struct tuple **result)
 {
 	struct memtx_hash_index *index = (struct memtx_hash_index *)base;
-	struct light_index_core *hash_table = &index->hash_table;
+	struct memtx_hash_table *hash_table = &index->hash_table;
+	bool is_new_key = false;
 
 	if (new_tuple) {
-		uint32_t h = tuple_hash(new_tuple, base->def->key_def);
+		uint32_t h;
+		if (memtx_hash_index_tuple_hash(index, new_tuple, &h,
+						&is_new_key) != 0)
+			return -1;
 		struct tuple *dup_tuple = NULL;
-		uint32_t pos = light_index_replace(hash_table, h, new_tuple,
-						   &dup_tuple);
-		if (pos == light_index_end)
-			pos = light_index_insert(hash_table, h, new_tuple);
+		uint32_t pos = memtx_hash_table_replace(hash_table, h, new_tuple,
+							&dup_tuple);
+		if (pos == memtx_hash_table_end)
+			pos = memtx_hash_table_insert(hash_table, h, new_tuple);
 
 		ERROR_INJECT(ERRINJ_INDEX_ALLOC,
 		{
-			light_index_delete(hash_table, pos);
-			pos = light_index_end;
+			memtx_hash_table_delete(hash_table, pos);
+			pos = memtx_hash_table_end;
 		});
 
-		if (pos == light_index_end) {
-			diag_set(OutOfMemory, (ssize_t)hash_table->count,
+		if (pos == memtx_hash_table_end) {
+			diag_set(OutOfMemory,
+				 (ssize_t)memtx_hash_table_count(hash_table),
 				 "hash_table", "key");
-			return -1;
+			goto fail;
 		}
 		uint32_t errcode = replace_check_dup(old_tuple,
 						     dup_tuple, mode);
 		if (errcode) {
-			light_index_delete(hash_table, pos);
+			memtx_hash_table_delete(hash_table, pos);
 			if (dup_tuple) {
-				uint32_t pos = light_index_insert(hash_table, h, dup_tuple);
-				if (pos == light_index_end) {
+				uint32_t pos = memtx_hash_table_insert(hash_table,
+								       h, dup_tuple);
+				if (pos == memtx_hash_table_end) {
 					panic("Failed to allocate memory in "
 					      "recover of int hash_table");
 				}
@@ -327,7 +623,7 @@ memtx_hash_index_replace(struct index *base, struct tuple *old_tuple,
 			if (sp != NULL)
 				diag_set(ClientError, errcode, base->def->name,
 					 space_name(sp));
-			return -1;
+			goto fail;
 		}
 
 		if (dup_tuple) {
@@ -337,12 +633,31 @@ memtx_hash_index_replace(struct index *base, struct tuple *old_tuple,
 	}
 
 	if (old_tuple) {
-		uint32_t h = tuple_hash(old_tuple, base->def->key_def);
-		int res = light_index_delete_value(hash_table, h, old_tuple);
-		assert(res == 0); (void) res;
+		uint32_t h;
+		/*
+		 * The key may be missing if the tuple has never
+		 * been inserted into the index, e.g. on rollback
+		 * of a failed statement.
+		 */
+		bool is_stored = true;
+		if (index->cmp_arg.func_keys == NULL)
+			h = tuple_hash(old_tuple, base->def->key_def);
+		else
+			is_stored = memtx_hash_index_find_func_hash(index,
+								    old_tuple,
+								    &h);
+		if (is_stored) {
+			int res = memtx_hash_table_delete_value(hash_table, h,
+								old_tuple);
+			assert(res == 0); (void) res;
+		}
 	}
 	*result = old_tuple;
 	return 0;
+fail:
+	if (is_new_key)
+		memtx_func_key_map_delete(&index->func_keys, new_tuple);
+	return -1;
 }
 
 static struct iterator *
@@ -364,26 +679,27 @@ memtx_hash_index_create_iterator(struct index *base, enum iterator_type type,
 	it->pool = &memtx->iterator_pool;
 	it->base.free = hash_iterator_free;
 	it->hash_table = &index->hash_table;
-	light_index_iterator_begin(it->hash_table, &it->iterator);
+	memtx_hash_table_iterator_begin(it->hash_table, &it->iterator);
 
 	switch (type) {
 	case ITER_GT:
 		if (part_count != 0) {
-			light_index_iterator_key(it->hash_table, &it->iterator,
+			memtx_hash_table_iterator_key(it->hash_table,
+					&it->iterator,
 					key_hash(key, base->def->key_def), key);
 			it->base.next = hash_iterator_gt;
 		} else {
-			light_index_iterator_begin(it->hash_table, &it->iterator);
+			memtx_hash_table_iterator_begin(it->hash_table, &it->iterator);
 			it->base.next = hash_iterator_ge;
 		}
 		break;
 	case ITER_ALL:
-		light_index_iterator_begin(it->hash_table, &it->iterator);
+		memtx_hash_table_iterator_begin(it->hash_table, &it->iterator);
 		it->base.next = hash_iterator_ge;
 		break;
 	case ITER_EQ:
 		assert(part_count > 0);
-		light_index_iterator_key(it->hash_table, &it->iterator,
+		memtx_hash_table_iterator_key(it->hash_table, &it->iterator,
 				key_hash(key, base->def->key_def), key);
 		it->base.next = hash_iterator_eq;
 		break;
@@ -398,8 +714,8 @@ memtx_hash_index_create_iterator(struct index *base, enum iterator_type type,
 
 struct hash_snapshot_iterator {
 	struct snapshot_iterator base;
-	struct light_index_core *hash_table;
-	struct light_index_iterator iterator;
+	struct memtx_hash_table *hash_table;
+	struct memtx_hash_table_iterator iterator;
 };
 
 /**
@@ -413,7 +729,7 @@ hash_snapshot_iterator_free(struct snapshot_iterator *iterator)
 	assert(iterator->free == hash_snapshot_iterator_free);
 	struct hash_snapshot_iterator *it =
 		(struct hash_snapshot_iterator *) iterator;
-	light_index_iterator_destroy(it->hash_table, &it->iterator);
+	memtx_hash_table_iterator_destroy(it->hash_table, &it->iterator);
 	free(iterator);
 }
 
@@ -428,8 +744,8 @@ hash_snapshot_iterator_next(struct snapshot_iterator *iterator, uint32_t *size)
 	assert(iterator->free == hash_snapshot_iterator_free);
 	struct hash_snapshot_iterator *it =
 		(struct hash_snapshot_iterator *) iterator;
-	struct tuple **res = light_index_iterator_get_and_next(it->hash_table,
-							       &it->iterator);
+	struct tuple **res = memtx_hash_table_iterator_get_and_next(
+		it->hash_table, &it->iterator);
 	if (res == NULL)
 		return NULL;
 	return tuple_data_range(*res, size);
@@ -455,8 +771,8 @@ memtx_hash_index_create_snapshot_iterator(struct index *base)
 	it->base.next = hash_snapshot_iterator_next;
 	it->base.free = hash_snapshot_iterator_free;
 	it->hash_table = &index->hash_table;
-	light_index_iterator_begin(it->hash_table, &it->iterator);
-	light_index_iterator_freeze(it->hash_table, &it->iterator);
+	memtx_hash_table_iterator_begin(it->hash_table, &it->iterator);
+	memtx_hash_table_iterator_freeze(it->hash_table, &it->iterator);
 	return (struct snapshot_iterator *) it;
 }
 
@@ -477,6 +793,7 @@ static const struct index_vtab memtx_hash_index_vtab = {
 	/* .random = */ memtx_hash_index_random,
 	/* .count = */ memtx_hash_index_count,
 	/* .get = */ memtx_hash_index_get,
+	/* .get_many = */ generic_index_get_many,
 	/* .replace = */ memtx_hash_index_replace,
 	/* .create_iterator = */ memtx_hash_index_create_iterator,
 	/* .create_snapshot_iterator = */
@@ -506,9 +823,17 @@ memtx_hash_index_new(struct memtx_engine *memtx, struct index_def *def)
 		return NULL;
 	}
 
-	light_index_create(&index->hash_table, MEMTX_EXTENT_SIZE,
-			   memtx_index_extent_alloc, memtx_index_extent_free,
-			   memtx, index->base.def->key_def);
+	if (def->key_def->for_func_index) {
+		if (memtx_func_key_map_create(&index->func_keys, memtx) != 0) {
+			index_def_delete(index->base.def);
+			free(index);
+			return NULL;
+		}
+		index->cmp_arg.func_keys = &index->func_keys;
+	}
+	index->cmp_arg.key_def = index->base.def->key_def;
+	memtx_hash_table_create(&index->hash_table, def->opts.layout, memtx,
+				&index->cmp_arg);
 	return &index->base;
 }
 
@@ -38,10 +38,18 @@ extern "C" {
 struct index;
 struct index_def;
 struct memtx_engine;
+struct tuple;
 
 struct index *
 memtx_hash_index_new(struct memtx_engine *memtx, struct index_def *def);
 
+/**
+ * Drop the stored key of a tuple that has been deleted from
+ * a functional HASH index, see struct memtx_func_key_map.
+ */
+void
+memtx_hash_index_forget_func_key(struct index *index, struct tuple *tuple);
+
 #if defined(__cplusplus)
 } /* extern "C" */
 #endif /* defined(__cplusplus) */
@@ -241,6 +241,60 @@ memtx_rtree_index_replace(struct index *base, struct tuple *old_tuple,
 	return 0;
 }
 
+static void
+memtx_rtree_index_begin_build(struct index *base)
+{
+	struct memtx_rtree_index *index = (struct memtx_rtree_index *)base;
+	assert(rtree_number_of_records(&index->tree) == 0);
+	(void)index;
+}
+
+static int
+memtx_rtree_index_reserve(struct index *base, uint32_t size_hint)
+{
+	struct memtx_rtree_index *index = (struct memtx_rtree_index *)base;
+	if (rtree_build_reserve(&index->tree, size_hint) != 0) {
+		diag_set(OutOfMemory, size_hint * index->tree.page_branch_size,
+			 "memtx_rtree_index", "reserve");
+		return -1;
+	}
+	/* Diag is set by memtx_index_extent_alloc(). */
+	return rtree_build_reserve_pages(&index->tree, size_hint);
+}
+
+static int
+memtx_rtree_index_build_next(struct index *base, struct tuple *tuple)
+{
+	struct memtx_rtree_index *index = (struct memtx_rtree_index *)base;
+	struct rtree_rect rect;
+	if (extract_rectangle(&rect, tuple, base->def) != 0)
+		return -1;
+	/*
+	 * Reserve index pages for the new record along with the
+	 * records added so far, so that end_build, which can't
+	 * fail, doesn't run out of memory. Diag is set by
+	 * memtx_index_extent_alloc().
+	 */
+	if (rtree_build_reserve_pages(&index->tree,
+				      index->tree.build_size + 1) != 0)
+		return -1;
+	if (rtree_build_next(&index->tree, &rect, tuple) != 0) {
+		diag_set(OutOfMemory, index->tree.build_capacity * 2 *
+			 index->tree.page_branch_size,
+			 "memtx_rtree_index", "build_next");
+		return -1;
+	}
+	return 0;
+}
+
+static void
+memtx_rtree_index_end_build(struct index *base)
+{
+	struct memtx_rtree_index *index = (struct memtx_rtree_index *)base;
+	/* All pages are reserved by build_next, see above. */
+	rtree_build_end(&index->tree);
+}
+
 static struct iterator *
 memtx_rtree_index_create_iterator(struct index *base,  enum iterator_type type,
 				  const char *key, uint32_t part_count)
@@ -324,6 +378,7 @@ static const struct index_vtab memtx_rtree_index_vtab = {
 	/* .random = */ generic_index_random,
 	/* .count = */ memtx_rtree_index_count,
 	/* .get = */ memtx_rtree_index_get,
+	/* .get_many = */ generic_index_get_many,
 	/* .replace = */ memtx_rtree_index_replace,
 	/* .create_iterator = */ memtx_rtree_index_create_iterator,
 	/* .create_snapshot_iterator = */
@@ -331,10 +386,10 @@ static const struct index_vtab memtx_rtree_index_vtab = {
 	/* .stat = */ generic_index_stat,
 	/* .compact = */ generic_index_compact,
 	/* .reset_stat = */ generic_index_reset_stat,
-	/* .begin_build = */ generic_index_begin_build,
-	/* .reserve = */ generic_index_reserve,
-	/* .build_next = */ generic_index_build_next,
-	/* .end_build = */ generic_index_end_build,
+	/* .begin_build = */ memtx_rtree_index_begin_build,
+	/* .reserve = */ memtx_rtree_index_reserve,
+	/* .build_next = */ memtx_rtree_index_build_next,
+	/* .end_build = */ memtx_rtree_index_end_build,
 };
 
 struct index *
@@ -34,6 +34,7 @@
 #include "txn.h"
 #include "tuple.h"
 #include "tuple_update.h"
+#include "tuple_compression.h"
 #include "xrow.h"
 #include "memtx_hash.h"
 #include "memtx_tree.h"
@@ -43,9 +44,13 @@
 #include "column_mask.h"
 #include "sequence.h"
 
+static void
+memtx_space_delete_builds(struct space *space);
+
 static void
 memtx_space_destroy(struct space *space)
 {
+	memtx_space_delete_builds(space);
 	free(space);
 }
 
@@ -235,6 +240,10 @@ memtx_space_replace_primary_key(struct space *space, struct tuple *old_tuple,
  * Otherwise, it's taken into account only for the
  * primary key.
  */
+static void
+memtx_space_forward_build(struct space *space, struct tuple *old_tuple,
+			  struct tuple *new_tuple);
+
 int
 memtx_space_replace_all_keys(struct space *space, struct tuple *old_tuple,
 			     struct tuple *new_tuple,
@@ -278,6 +287,8 @@ memtx_space_replace_all_keys(struct space *space, struct tuple *old_tuple,
 	memtx_space_update_bsize(space, old_tuple, new_tuple);
 	if (new_tuple != NULL)
 		tuple_ref(new_tuple);
+	if (!rlist_empty(&memtx->build_list))
+		memtx_space_forward_build(space, old_tuple, new_tuple);
 	*result = old_tuple;
 	return 0;
 
@@ -293,6 +304,9 @@ rollback:
 			panic("failed to rollback change");
 		}
 	}
+	/* The new tuple isn't stored in any index. */
+	if (new_tuple != NULL)
+		memtx_space_forget_func_keys(space, new_tuple);
 	return -1;
 }
 
@@ -338,6 +352,9 @@ memtx_space_execute_replace(struct space *space, struct txn *txn,
 	struct memtx_space *memtx_space = (struct memtx_space *)space;
 	struct txn_stmt *stmt = txn_current_stmt(txn);
 	enum dup_replace_mode mode = dup_replace_mode(request->type);
+	if (space->format->is_compressed &&
+	    mp_check_compression(request->tuple, request->tuple_end) != 0)
+		return -1;
 	stmt->new_tuple = memtx_tuple_new(space->format, request->tuple,
 					  request->tuple_end);
 	if (stmt->new_tuple == NULL)
@@ -401,6 +418,15 @@ memtx_space_execute_update(struct space *space, struct txn *txn,
 		return 0;
 	}
 
+	/*
+	 * Compressed fields of the old tuple are carried over to
+	 * the new one as is, but update operations may not add
+	 * any, see mp_check_compression().
+	 */
+	if (space->format->is_compressed &&
+	    mp_check_compression(request->tuple, request->tuple_end) != 0)
+		return -1;
+
 	/* Update the tuple; legacy, request ops are in request->tuple */
 	uint32_t new_size = 0, bsize;
 	const char *old_data = tuple_data_range(old_tuple, &bsize);
@@ -437,6 +463,10 @@ memtx_space_execute_upsert(struct space *space, struct txn *txn,
 	 */
 	if (tuple_validate_raw(space->format, request->tuple))
 		return -1;
+	if (space->format->is_compressed &&
+	    (mp_check_compression(request->tuple, request->tuple_end) != 0 ||
+	     mp_check_compression(request->ops, request->ops_end) != 0))
+		return -1;
 
 	struct index *index = index_find_unique(space, 0);
 	if (index == NULL)
@@ -630,6 +660,19 @@ memtx_space_check_index_def(struct space *space, struct index_def *index_def)
 			return -1;
 		}
 	}
+	if (index_def->key_def->is_multikey && index_def->type != TREE) {
+		diag_set(ClientError, ER_UNSUPPORTED,
+			 index_type_strs[index_def->type],
+			 "multikey indexes");
+		return -1;
+	}
+	if (index_def->key_def->for_func_index &&
+	    index_def->type != TREE && index_def->type != HASH) {
+		diag_set(ClientError, ER_UNSUPPORTED,
+			 index_type_strs[index_def->type],
+			 "functional indexes");
+		return -1;
+	}
 	switch (index_def->type) {
 	case HASH:
 		if (! index_def->opts.is_unique) {
@@ -852,10 +895,255 @@ memtx_init_ephemeral_space(struct space *space)
 	memtx_space_add_primary_key(space);
 }
 
+/* {{{ Index build */
+
+/**
+ * Yield after inserting this many tuples into an index that is
+ * being built so as not to stall the tx thread for too long.
+ * Yield more often in debug mode.
+ */
+#if defined(NDEBUG)
+enum { MEMTX_BUILD_YIELD_LOOPS = 1000 };
+#else
+enum { MEMTX_BUILD_YIELD_LOOPS = 10 };
+#endif
+
+/**
+ * State of an index build that may yield.
+ *
+ * Since the build yields, the space may be modified concurrently
+ * so changes made to it are forwarded to the new index. This must
+ * go on until the ALTER that built the index has completed all its
+ * builds (otherwise an index built earlier would miss changes done
+ * while other indexes are being built), and rolled back changes
+ * must be undone in the new index as well. That's why the state is
+ * linked in memtx_engine::build_list and is only destroyed along
+ * with either the altered space or the space the index was built
+ * for, whichever is dropped first when the ALTER ends.
+ */
+struct memtx_build_ctx {
+	/** Link in memtx_engine::build_list. */
+	struct rlist link;
+	/** Space the index is built from. */
+	struct space *space;
+	/** Index under construction. */
+	struct index *index;
+	/** Format to check new tuples against. */
+	struct tuple_format *format;
+	/** Definition of the primary key of the altered space. */
+	struct key_def *cmp_def;
+	/**
+	 * The last tuple inserted into the new index by the build
+	 * loop or NULL if no tuple has been inserted yet. Changes
+	 * of tuples following it in the primary key aren't forwarded
+	 * to the new index, because the build loop will pick them
+	 * up anyway.
+	 */
+	struct tuple *cursor;
+	/** Set when the build loop is over. */
+	bool is_done;
+	/** Set in case a build error occurred. */
+	bool is_failed;
+	/** Container for storing errors. */
+	struct diag diag;
+};
+
+static void
+memtx_build_ctx_delete(struct memtx_build_ctx *ctx)
+{
+	if (ctx->cursor != NULL)
+		tuple_unref(ctx->cursor);
+	diag_destroy(&ctx->diag);
+	rlist_del_entry(ctx, link);
+	free(ctx);
+}
+
+/**
+ * Return true if the build loop has already inserted into
+ * the new index a tuple with the same primary key as @tuple.
+ */
+static bool
+memtx_build_ctx_is_processed(struct memtx_build_ctx *ctx,
+			     struct tuple *tuple)
+{
+	if (ctx->is_done)
+		return true;
+	return ctx->cursor != NULL &&
+	       tuple_compare(tuple, ctx->cursor, ctx->cmp_def) <= 0;
+}
+
+/**
+ * Replace @old_tuple with @new_tuple in the index being built.
+ */
+static int
+memtx_build_ctx_replace(struct memtx_build_ctx *ctx,
+			struct tuple *old_tuple, struct tuple *new_tuple)
+{
+	struct tuple *unused;
+	if (index_replace(ctx->index, old_tuple, new_tuple,
+			  DUP_INSERT, &unused) != 0)
+		return -1;
+	/*
+	 * All tuples stored in a memtx space must be
+	 * referenced by the primary index.
+	 */
+	if (ctx->index->def->iid == 0) {
+		if (new_tuple != NULL)
+			tuple_ref(new_tuple);
+		if (unused != NULL)
+			tuple_unref(unused);
+	}
+	return 0;
+}
+
+/**
+ * Forward a change of a space to indexes that are being built
+ * from it. Called right after the change is applied to the space
+ * indexes, so that a change is in a new index if and only if its
+ * primary key is behind the build cursor: the build loop picks up
+ * changes of tuples ahead of the cursor by itself. This is what
+ * memtx_space_rollback_build() relies upon.
+ *
+ * Doing this in an on_replace trigger would break the invariant,
+ * because the trigger doesn't run if a trigger that precedes it
+ * fails, while the change is rolled back all the same.
+ */
+static void
+memtx_space_forward_build(struct space *space, struct tuple *old_tuple,
+			  struct tuple *new_tuple)
+{
+	struct memtx_engine *memtx = (struct memtx_engine *)space->engine;
+	struct memtx_build_ctx *ctx;
+	rlist_foreach_entry(ctx, &memtx->build_list, link) {
+		/*
+		 * The index is maintained by the new space
+		 * after the ALTER is done.
+		 */
+		if (ctx->space != space || ctx->is_failed)
+			continue;
+		struct tuple *tuple = new_tuple != NULL ?
+				      new_tuple : old_tuple;
+		if (!memtx_build_ctx_is_processed(ctx, tuple))
+			continue;
+		/* Check new tuples for conformity to the new format. */
+		if ((new_tuple == NULL ||
+		     tuple_validate(ctx->format, new_tuple) == 0) &&
+		    memtx_build_ctx_replace(ctx, old_tuple, new_tuple) == 0)
+			continue;
+		/*
+		 * Don't fail the change, fail the build instead:
+		 * the error is reported by the ALTER.
+		 */
+		ctx->is_failed = true;
+		diag_move(diag_get(), &ctx->diag);
+	}
+}
+
+/** Drop the stored key of a tuple from a functional index. */
+static void
+memtx_index_forget_func_key(struct index *index, struct tuple *tuple)
+{
+	if (!index->def->key_def->for_func_index)
+		return;
+	switch (index->def->type) {
+	case TREE:
+		memtx_tree_index_forget_func_key(index, tuple);
+		break;
+	case HASH:
+		memtx_hash_index_forget_func_key(index, tuple);
+		break;
+	default:
+		unreachable();
+	}
+}
+
+void
+memtx_space_forget_func_keys(struct space *space, struct tuple *tuple)
+{
+	/* The primary key can't be functional. */
+	for (uint32_t i = 1; i < space->index_count; i++)
+		memtx_index_forget_func_key(space->index[i], tuple);
+	struct memtx_engine *memtx = (struct memtx_engine *)space->engine;
+	struct memtx_build_ctx *ctx;
+	rlist_foreach_entry(ctx, &memtx->build_list, link) {
+		if (ctx->space == space)
+			memtx_index_forget_func_key(ctx->index, tuple);
+	}
+}
+
+void
+memtx_space_rollback_build(struct space *space, struct txn_stmt *stmt)
+{
+	struct memtx_engine *memtx = (struct memtx_engine *)space->engine;
+	struct memtx_build_ctx *ctx;
+	rlist_foreach_entry(ctx, &memtx->build_list, link) {
+		if (ctx->space != space || ctx->is_failed)
+			continue;
+		struct tuple *tuple = stmt->new_tuple != NULL ?
+				      stmt->new_tuple : stmt->old_tuple;
+		if (!memtx_build_ctx_is_processed(ctx, tuple))
+			continue;
+		/*
+		 * Don't spoil the error that caused the rollback,
+		 * if any.
+		 */
+		struct diag diag;
+		diag_create(&diag);
+		diag_move(diag_get(), &diag);
+		if (memtx_build_ctx_replace(ctx, stmt->new_tuple,
+					    stmt->old_tuple) != 0) {
+			ctx->is_failed = true;
+			diag_move(diag_get(), &ctx->diag);
+		}
+		diag_move(&diag, diag_get());
+		diag_destroy(&diag);
+	}
+}
+
+/**
+ * Destroy states of all builds the given space is involved in,
+ * either as the altered space or as the owner of a new index.
+ */
+static void
+memtx_space_delete_builds(struct space *space)
+{
+	struct memtx_engine *memtx = (struct memtx_engine *)space->engine;
+	struct memtx_build_ctx *ctx, *tmp;
+	rlist_foreach_entry_safe(ctx, &memtx->build_list, link, tmp) {
+		bool is_involved = ctx->space == space;
+		for (uint32_t i = 0; i < space->index_count; i++) {
+			if (space->index[i] == ctx->index)
+				is_involved = true;
+		}
+		if (is_involved)
+			memtx_build_ctx_delete(ctx);
+	}
+}
+
+/**
+ * Check if a change forwarded to any index that is being built
+ * or has been built from the given space failed. If it did, move
+ * the error to the diagnostics area and return -1.
+ */
+static int
+memtx_space_check_builds(struct space *space)
+{
+	struct memtx_engine *memtx = (struct memtx_engine *)space->engine;
+	struct memtx_build_ctx *ctx;
+	rlist_foreach_entry(ctx, &memtx->build_list, link) {
+		if (ctx->space == space && ctx->is_failed) {
+			diag_move(&ctx->diag, diag_get());
+			return -1;
+		}
+	}
+	return 0;
+}
+
 static int
 memtx_space_build_index(struct space *src_space, struct index *new_index,
 			struct tuple_format *new_format)
 {
+	struct memtx_engine *memtx = (struct memtx_engine *)src_space->engine;
 	/**
 	 * If it's a secondary key, and we're not building them
 	 * yet (i.e. it's snapshot recovery for memtx), do nothing.
@@ -876,10 +1164,49 @@ memtx_space_build_index(struct space *src_space, struct index *new_index,
 		return -1;
 	}
 
+	/*
+	 * Yield periodically so as not to stall the tx thread.
+	 * Don't do that during recovery, and unless the primary
+	 * key is ordered: the build loop relies on the order to
+	 * tell which concurrent changes it is yet to see.
+	 *
+	 * Note, unlike secondary keys built on recovery, see
+	 * memtx_build_secondary_keys(), the index isn't built
+	 * in bulk from a sorted array here. Tuples are inserted
+	 * one by one, because each of them has to be checked
+	 * against the new format and for duplicates, and because
+	 * the index must be usable by concurrent changes forwarded
+	 * to it by the time the build loop yields. Hence there's
+	 * nothing to sort in parallel: the build costs the tx
+	 * thread throughput, but doesn't block it.
+	 */
+	struct memtx_build_ctx *ctx = NULL;
+	if (memtx->state == MEMTX_OK && pk->def->type == TREE &&
+	    index_size(pk) > 0) {
+		ctx = malloc(sizeof(*ctx));
+		if (ctx == NULL) {
+			diag_set(OutOfMemory, sizeof(*ctx),
+				 "malloc", "struct memtx_build_ctx");
+			return -1;
+		}
+		ctx->space = src_space;
+		ctx->index = new_index;
+		ctx->format = new_format;
+		ctx->cmp_def = pk->def->cmp_def;
+		ctx->cursor = NULL;
+		ctx->is_done = false;
+		ctx->is_failed = false;
+		diag_create(&ctx->diag);
+		rlist_add_tail_entry(&memtx->build_list, ctx, link);
+	}
+
 	/* Now deal with any kind of add index during normal operation. */
 	struct iterator *it = index_create_iterator(pk, ITER_ALL, NULL, 0);
-	if (it == NULL)
+	if (it == NULL) {
+		if (ctx != NULL)
+			memtx_build_ctx_delete(ctx);
 		return -1;
+	}
 
 	/*
 	 * The index has to be built tuple by tuple, since
@@ -890,6 +1217,7 @@ memtx_space_build_index(struct space *src_space, struct index *new_index,
 	 */
 	/* Build the new index. */
 	int rc;
+	int loops = 0;
 	struct tuple *tuple;
 	while ((rc = iterator_next(it, &tuple)) == 0 && tuple != NULL) {
 		/*
@@ -915,11 +1243,50 @@ memtx_space_build_index(struct space *src_space, struct index *new_index,
 		 */
 		if (new_index->def->iid == 0)
 			tuple_ref(tuple);
+		if (ctx == NULL)
+			continue;
+		/*
+		 * Remember the last inserted tuple so that
+		 * memtx_space_forward_build() can tell whether the build
+		 * loop has already passed a concurrently changed
+		 * tuple. Note, we must not yield between reading
+		 * the tuple and moving the cursor.
+		 */
+		tuple_ref(tuple);
+		if (ctx->cursor != NULL)
+			tuple_unref(ctx->cursor);
+		ctx->cursor = tuple;
+		if (++loops % MEMTX_BUILD_YIELD_LOOPS == 0) {
+			fiber_sleep(0);
+			rc = memtx_space_check_builds(src_space);
+			if (rc != 0)
+				break;
+		}
 	}
 	iterator_delete(it);
-	return rc;
+	if (ctx == NULL)
+		return rc;
+
+	if (rc == 0)
+		rc = memtx_space_check_builds(src_space);
+	if (rc != 0) {
+		memtx_build_ctx_delete(ctx);
+		return -1;
+	}
+	/*
+	 * Keep forwarding changes to the new index until the
+	 * ALTER is over, see memtx_build_ctx.
+	 */
+	ctx->is_done = true;
+	if (ctx->cursor != NULL) {
+		tuple_unref(ctx->cursor);
+		ctx->cursor = NULL;
+	}
+	return 0;
 }
 
+/* }}} Index build */
+
 static int
 memtx_space_prepare_alter(struct space *old_space, struct space *new_space)
 {
@@ -948,6 +1315,7 @@ static const struct space_vtab memtx_space_vtab = {
 	/* .execute_delete = */ memtx_space_execute_delete,
 	/* .execute_update = */ memtx_space_execute_update,
 	/* .execute_upsert = */ memtx_space_execute_upsert,
+	/* .execute_delete_range = */ generic_space_execute_delete_range,
 	/* .ephemeral_replace = */ memtx_space_ephemeral_replace,
 	/* .ephemeral_delete = */ memtx_space_ephemeral_delete,
 	/* .ephemeral_rowid_next = */ memtx_space_ephemeral_rowid_next,
@@ -998,6 +1366,11 @@ memtx_space_new(struct memtx_engine *memtx,
 		free(memtx_space);
 		return NULL;
 	}
+	format->is_compressed =
+		def->opts.compression != SPACE_COMPRESSION_NONE;
+	/* A format without fields has no field map to store anchors. */
+	if (tuple_format_field_count(format) > 0)
+		format->offset_step = def->opts.field_offset_step;
 	tuple_format_ref(format);
 
 	if (space_create((struct space *)memtx_space, (struct engine *)memtx,
@@ -37,6 +37,7 @@ extern "C" {
 #endif /* defined(__cplusplus) */
 
 struct memtx_engine;
+struct txn_stmt;
 
 struct memtx_space {
 	struct space base;
@@ -84,6 +85,23 @@ int
 memtx_space_replace_all_keys(struct space *, struct tuple *, struct tuple *,
 			     enum dup_replace_mode, struct tuple **);
 
+/**
+ * Drop keys stored for a tuple by functional indexes of a space,
+ * including indexes that are being built. Called when the tuple
+ * is known to have been deleted from all indexes for good, i.e.
+ * when the statement that deleted it is committed or the one
+ * that inserted it is rolled back. See struct memtx_func_key_map.
+ */
+void
+memtx_space_forget_func_keys(struct space *space, struct tuple *tuple);
+
+/**
+ * Undo the effect of a rolled back statement on indexes that
+ * are being built from the space, see memtx_space_build_index().
+ */
+void
+memtx_space_rollback_build(struct space *space, struct txn_stmt *stmt);
+
 struct space *
 memtx_space_new(struct memtx_engine *memtx,
 		struct space_def *def, struct rlist *key_list);
@@ -35,7 +35,9 @@
 #include "errinj.h"
 #include "memory.h"
 #include "fiber.h"
+#include "coio_task.h"
 #include "tuple.h"
+#include "memtx_func_key.h"
 #include <third_party/qsort_arg.h>
 #include <small/mempool.h>
 
@@ -47,6 +49,8 @@ struct memtx_tree_key_data {
 	const char *key;
 	/** Number of msgpacked search fields. */
 	uint32_t part_count;
+	/** Comparison hint, see tuple_hint(). */
+	hint_t hint;
 };
 
 /**
@@ -55,8 +59,23 @@ struct memtx_tree_key_data {
 struct memtx_tree_data {
 	/* Tuple that this node is represents. */
 	struct tuple *tuple;
+	/**
+	 * Comparison hint, see tuple_hint(). In a multikey
+	 * index, the position of the key in the multikey array
+	 * of the tuple is stored here instead. In a functional
+	 * index, this is a pointer to the key of the tuple
+	 * stored in memtx_tree_index::func_keys.
+	 */
+	hint_t hint;
 };
 
+/** Return the key tuple of a functional index entry. */
+static inline struct tuple *
+memtx_tree_data_func_key(const struct memtx_tree_data *data)
+{
+	return (struct tuple *)(uintptr_t)data->hint;
+}
+
 /**
  * Test whether BPS tree elements are identical i.e. represent
  * the same tuple at the same position in the tree.
@@ -69,17 +88,101 @@ static bool
 memtx_tree_data_identical(const struct memtx_tree_data *a,
 			  const struct memtx_tree_data *b)
 {
-	return a->tuple == b->tuple;
+	return a->tuple == b->tuple && a->hint == b->hint;
+}
+
+/**
+ * Compare two BPS tree elements. Hints are compared first,
+ * tuples are compared only if the hints are equal.
+ */
+static inline int
+memtx_tree_data_compare(const struct memtx_tree_data *a,
+			const struct memtx_tree_data *b,
+			struct key_def *key_def)
+{
+	if (key_def->is_multikey) {
+		return tuple_compare_multikey(a->tuple, (int)a->hint,
+					      b->tuple, (int)b->hint,
+					      key_def);
+	}
+	if (key_def->for_func_index) {
+		return tuple_compare_func(a->tuple,
+				tuple_data(memtx_tree_data_func_key(a)),
+				b->tuple,
+				tuple_data(memtx_tree_data_func_key(b)),
+				key_def);
+	}
+	int rc = hint_cmp(a->hint, b->hint);
+	if (rc != 0)
+		return rc;
+	if (a->hint == b->hint && hint_is_exact(a->hint, key_def))
+		return 0;
+	return tuple_compare(a->tuple, b->tuple, key_def);
+}
+
+/**
+ * Compare a BPS tree element with a search key. Hints are
+ * compared first, the key is compared only if the hints are
+ * equal.
+ */
+static inline int
+memtx_tree_data_compare_with_key(const struct memtx_tree_data *a,
+				 const struct memtx_tree_key_data *key,
+				 struct key_def *key_def)
+{
+	if (key_def->is_multikey) {
+		return tuple_compare_with_key_multikey(a->tuple, (int)a->hint,
+						       key->key,
+						       key->part_count,
+						       key_def);
+	}
+	if (key_def->for_func_index) {
+		return tuple_compare_with_key_func(a->tuple,
+				tuple_data(memtx_tree_data_func_key(a)),
+				key->key, key->part_count, key_def);
+	}
+	int rc = hint_cmp(a->hint, key->hint);
+	if (rc != 0)
+		return rc;
+	if (a->hint == key->hint && hint_is_exact(a->hint, key_def))
+		return 0;
+	return tuple_compare_with_key(a->tuple, key->key, key->part_count,
+				      key_def);
+}
+
+/**
+ * Return the ordinal of a BPS tree element used for
+ * interpolation search, see BPS_TREE_ELEM_ORD.
+ */
+static inline uint64_t
+memtx_tree_data_ord(const struct memtx_tree_data *data,
+		    struct key_def *key_def)
+{
+	return key_def->has_ordinal_hints ? data->hint : HINT_NONE;
+}
+
+/**
+ * Return the ordinal of a search key used for interpolation
+ * search, see BPS_TREE_KEY_ORD.
+ */
+static inline uint64_t
+memtx_tree_key_data_ord(const struct memtx_tree_key_data *key,
+			struct key_def *key_def)
+{
+	return key_def->has_ordinal_hints ? key->hint : HINT_NONE;
 }
 
 #define BPS_TREE_NAME memtx_tree
 #define BPS_TREE_BLOCK_SIZE (512)
 #define BPS_TREE_EXTENT_SIZE MEMTX_EXTENT_SIZE
 #define BPS_TREE_COMPARE(a, b, arg)\
-	tuple_compare((&a)->tuple, (&b)->tuple, arg)
+	memtx_tree_data_compare(&a, &b, arg)
 #define BPS_TREE_COMPARE_KEY(a, b, arg)\
-	tuple_compare_with_key((&a)->tuple, (b)->key, (b)->part_count, arg)
+	memtx_tree_data_compare_with_key(&a, b, arg)
 #define BPS_TREE_IDENTICAL(a, b) memtx_tree_data_identical(&a, &b)
+#define BPS_TREE_ELEM_ORD(elem, arg) memtx_tree_data_ord(&elem, arg)
+#define BPS_TREE_KEY_ORD(key, arg) memtx_tree_key_data_ord(key, arg)
+#define BPS_TREE_ORD_NONE HINT_NONE
 #define bps_tree_elem_t struct memtx_tree_data
 #define bps_tree_key_t struct memtx_tree_key_data *
 #define bps_tree_arg_t struct key_def *
@@ -92,6 +195,9 @@ memtx_tree_data_identical(const struct memtx_tree_data *a,
 #undef BPS_TREE_COMPARE
 #undef BPS_TREE_COMPARE_KEY
 #undef BPS_TREE_IDENTICAL
+#undef BPS_TREE_ELEM_ORD
+#undef BPS_TREE_KEY_ORD
+#undef BPS_TREE_ORD_NONE
 #undef bps_tree_elem_t
 #undef bps_tree_key_t
 #undef bps_tree_arg_t
@@ -103,6 +209,8 @@ struct memtx_tree_index {
 	size_t build_array_size, build_array_alloc_size;
 	struct memtx_gc_task gc_task;
 	struct memtx_tree_iterator gc_iterator;
+	/** Keys of tuples stored in a functional index. */
+	struct memtx_func_key_map func_keys;
 };
 
 /* {{{ Utilities. *************************************************/
@@ -113,7 +221,7 @@ memtx_tree_qcompare(const void* a, const void *b, void *c)
 	const struct memtx_tree_data *data_a = a;
 	const struct memtx_tree_data *data_b = b;
 	struct key_def *key_def = c;
-	return tuple_compare(data_a->tuple, data_b->tuple, key_def);
+	return memtx_tree_data_compare(data_a, data_b, key_def);
 }
 
 /* {{{ MemtxTree Iterators ****************************************/
@@ -123,6 +231,12 @@ struct tree_iterator {
 	struct index_def *index_def;
 	struct memtx_tree_iterator tree_iterator;
 	enum iterator_type type;
+	/**
+	 * Set if the iterator belongs to a functional index.
+	 * Cached, because the index definition may be gone by
+	 * the time the iterator is freed.
+	 */
+	bool is_func_index;
 	struct memtx_tree_key_data key_data;
 	struct memtx_tree_data current;
 	/** Memory pool the iterator was allocated from. */
@@ -143,13 +257,37 @@ tree_iterator(struct iterator *it)
 	return (struct tree_iterator *) it;
 }
 
+/**
+ * Remember the tree element the iterator is positioned at.
+ * Both the tuple and, in a functional index, its key tuple are
+ * referenced, because the iterator uses the element to restore
+ * its position in case the tree is modified.
+ */
+static inline void
+tree_iterator_set_current(struct tree_iterator *it,
+			  const struct memtx_tree_data *res)
+{
+	tuple_ref(res->tuple);
+	if (it->is_func_index)
+		tuple_ref(memtx_tree_data_func_key(res));
+	it->current = *res;
+}
+
+/** Release the element set by tree_iterator_set_current(). */
+static inline void
+tree_iterator_unref_current(struct tree_iterator *it)
+{
+	tuple_unref(it->current.tuple);
+	if (it->is_func_index)
+		tuple_unref(memtx_tree_data_func_key(&it->current));
+}
+
 static void
 tree_iterator_free(struct iterator *iterator)
 {
 	struct tree_iterator *it = tree_iterator(iterator);
-	struct tuple *tuple = it->current.tuple;
-	if (tuple != NULL)
-		tuple_unref(tuple);
+	if (it->current.tuple != NULL)
+		tree_iterator_unref_current(it);
 	mempool_free(it->pool, it);
 }
 
@@ -175,7 +313,7 @@ tree_iterator_next(struct iterator *iterator, struct tuple **ret)
 	} else {
 		memtx_tree_iterator_next(it->tree, &it->tree_iterator);
 	}
-	tuple_unref(it->current.tuple);
+	tree_iterator_unref_current(it);
 	struct memtx_tree_data *res =
 		memtx_tree_iterator_get_elem(it->tree, &it->tree_iterator);
 	if (res == NULL) {
@@ -184,8 +322,7 @@ tree_iterator_next(struct iterator *iterator, struct tuple **ret)
 		*ret = NULL;
 	} else {
 		*ret = res->tuple;
-		tuple_ref(*ret);
-		it->current = *res;
+		tree_iterator_set_current(it, res);
 	}
 	return 0;
 }
@@ -202,7 +339,7 @@ tree_iterator_prev(struct iterator *iterator, struct tuple **ret)
 			memtx_tree_lower_bound_elem(it->tree, it->current, NULL);
 	}
 	memtx_tree_iterator_prev(it->tree, &it->tree_iterator);
-	tuple_unref(it->current.tuple);
+	tree_iterator_unref_current(it);
 	struct memtx_tree_data *res =
 		memtx_tree_iterator_get_elem(it->tree, &it->tree_iterator);
 	if (!res) {
@@ -211,8 +348,7 @@ tree_iterator_prev(struct iterator *iterator, struct tuple **ret)
 		*ret = NULL;
 	} else {
 		*ret = res->tuple;
-		tuple_ref(*ret);
-		it->current = *res;
+		tree_iterator_set_current(it, res);
 	}
 	return 0;
 }
@@ -230,21 +366,19 @@ tree_iterator_next_equal(struct iterator *iterator, struct tuple **ret)
 	} else {
 		memtx_tree_iterator_next(it->tree, &it->tree_iterator);
 	}
-	tuple_unref(it->current.tuple);
+	tree_iterator_unref_current(it);
 	struct memtx_tree_data *res =
 		memtx_tree_iterator_get_elem(it->tree, &it->tree_iterator);
 	/* Use user key def to save a few loops. */
 	if (res == NULL ||
-	    tuple_compare_with_key(res->tuple, it->key_data.key,
-				   it->key_data.part_count,
-				   it->index_def->key_def) != 0) {
+	    memtx_tree_data_compare_with_key(res, &it->key_data,
+					     it->index_def->key_def) != 0) {
 		iterator->next = tree_iterator_dummie;
 		it->current.tuple = NULL;
 		*ret = NULL;
 	} else {
 		*ret = res->tuple;
-		tuple_ref(*ret);
-		it->current = *res;
+		tree_iterator_set_current(it, res);
 	}
 	return 0;
 }
@@ -261,21 +395,19 @@ tree_iterator_prev_equal(struct iterator *iterator, struct tuple **ret)
 			memtx_tree_lower_bound_elem(it->tree, it->current, NULL);
 	}
 	memtx_tree_iterator_prev(it->tree, &it->tree_iterator);
-	tuple_unref(it->current.tuple);
+	tree_iterator_unref_current(it);
 	struct memtx_tree_data *res =
 		memtx_tree_iterator_get_elem(it->tree, &it->tree_iterator);
 	/* Use user key def to save a few loops. */
 	if (res == NULL ||
-	    tuple_compare_with_key(res->tuple, it->key_data.key,
-				   it->key_data.part_count,
-				   it->index_def->key_def) != 0) {
+	    memtx_tree_data_compare_with_key(res, &it->key_data,
+					     it->index_def->key_def) != 0) {
 		iterator->next = tree_iterator_dummie;
 		it->current.tuple = NULL;
 		*ret = NULL;
 	} else {
 		*ret = res->tuple;
-		tuple_ref(*ret);
-		it->current = *res;
+		tree_iterator_set_current(it, res);
 	}
 	return 0;
 }
@@ -359,8 +491,7 @@ tree_iterator_start(struct iterator *iterator, struct tuple **ret)
 	if (!res)
 		return 0;
 	*ret = res->tuple;
-	tuple_ref(*ret);
-	it->current = *res;
+	tree_iterator_set_current(it, res);
 	tree_iterator_set_next_method(it);
 	return 0;
 }
@@ -389,6 +520,8 @@ memtx_tree_index_cmp_def(struct memtx_tree_index *index)
 static void
 memtx_tree_index_free(struct memtx_tree_index *index)
 {
+	if (index->base.def->key_def->for_func_index)
+		memtx_func_key_map_destroy(&index->func_keys);
 	memtx_tree_destroy(&index->tree);
 	free(index->build_array);
 	free(index);
@@ -439,6 +572,19 @@ static const struct memtx_gc_task_vtab memtx_tree_index_gc_vtab = {
 	.free = memtx_tree_index_gc_free,
 };
 
+static void
+memtx_tree_index_gc_run_nop(struct memtx_gc_task *task, bool *done)
+{
+	(void)task;
+	*done = true;
+}
+
+/** Used to delay freeing a secondary index till read views close. */
+static const struct memtx_gc_task_vtab memtx_tree_index_gc_free_vtab = {
+	.run = memtx_tree_index_gc_run_nop,
+	.free = memtx_tree_index_gc_free,
+};
+
 static void
 memtx_tree_index_destroy(struct index *base)
 {
@@ -453,6 +599,14 @@ memtx_tree_index_destroy(struct index *base)
 		index->gc_task.vtab = &memtx_tree_index_gc_vtab;
 		index->gc_iterator = memtx_tree_iterator_first(&index->tree);
 		memtx_engine_schedule_gc(memtx, &index->gc_task);
+	} else if (memtx_engine_has_read_views(memtx)) {
+		/*
+		 * Secondary index that may be frozen in a read
+		 * view, see memtx_tree_view_new(). Free it when
+		 * the view is closed.
+		 */
+		index->gc_task.vtab = &memtx_tree_index_gc_free_vtab;
+		memtx_engine_schedule_gc(memtx, &index->gc_task);
 	} else {
 		/*
 		 * Secondary index. Destruction is fast, no need to
@@ -488,7 +642,10 @@ static ssize_t
 memtx_tree_index_bsize(struct index *base)
 {
 	struct memtx_tree_index *index = (struct memtx_tree_index *)base;
-	return memtx_tree_mem_used(&index->tree);
+	size_t bsize = memtx_tree_mem_used(&index->tree);
+	if (base->def->key_def->for_func_index)
+		bsize += memtx_func_key_map_bsize(&index->func_keys);
+	return bsize;
 }
 
 static int
@@ -519,20 +676,228 @@ memtx_tree_index_get(struct index *base, const char *key,
 	struct memtx_tree_key_data key_data;
 	key_data.key = key;
 	key_data.part_count = part_count;
+	key_data.hint = key_hint(key, part_count, index->tree.arg);
 	struct memtx_tree_data *res = memtx_tree_find(&index->tree, &key_data);
 	*result = res != NULL ? res->tuple : NULL;
 	return 0;
 }
 
+/**
+ * Undo insertion of the first @a count keys of @a new_tuple into
+ * a multikey index and restore the keys of @a dup_tuple that
+ * have been replaced by them.
+ */
+static void
+memtx_tree_index_replace_multikey_rollback(struct memtx_tree_index *index,
+					   struct tuple *new_tuple,
+					   struct tuple *dup_tuple,
+					   uint32_t count)
+{
+	struct key_def *cmp_def = index->tree.arg;
+	struct memtx_tree_data data;
+	data.tuple = new_tuple;
+	for (uint32_t i = 0; i < count; i++) {
+		data.hint = i;
+		memtx_tree_delete_identical(&index->tree, data);
+	}
+	if (dup_tuple == NULL)
+		return;
+	data.tuple = dup_tuple;
+	uint32_t dup_count = tuple_multikey_count(dup_tuple, cmp_def);
+	for (uint32_t i = 0; i < dup_count; i++) {
+		data.hint = i;
+		memtx_tree_insert(&index->tree, data, NULL);
+	}
+}
+
+/**
+ * Replace a tuple in a multikey index. Unlike a regular index,
+ * a tuple has as many entries in a multikey index as there are
+ * elements in its multikey array. Equal keys of the same tuple
+ * are stored only once.
+ */
+static int
+memtx_tree_index_replace_multikey(struct index *base, struct tuple *old_tuple,
+				  struct tuple *new_tuple,
+				  enum dup_replace_mode mode,
+				  struct tuple **result)
+{
+	struct memtx_tree_index *index = (struct memtx_tree_index *)base;
+	struct key_def *cmp_def = index->tree.arg;
+	*result = NULL;
+	if (new_tuple != NULL) {
+		/*
+		 * All keys of the new tuple may replace keys of
+		 * at most one tuple, which is then checked
+		 * against the replace mode as usual.
+		 */
+		struct tuple *dup_tuple = NULL;
+		struct memtx_tree_data conflict_data = { NULL, 0 };
+		struct memtx_tree_data new_data, dup_data;
+		new_data.tuple = new_tuple;
+		uint32_t count = tuple_multikey_count(new_tuple, cmp_def);
+		uint32_t i;
+		for (i = 0; i < count; i++) {
+			new_data.hint = i;
+			dup_data.tuple = NULL;
+			if (memtx_tree_insert(&index->tree, new_data,
+					      &dup_data) != 0) {
+				memtx_tree_index_replace_multikey_rollback(
+					index, new_tuple, dup_tuple, i);
+				diag_set(OutOfMemory, MEMTX_EXTENT_SIZE,
+					 "memtx_tree_index", "replace");
+				return -1;
+			}
+			/* Skip keys repeated in the array. */
+			if (dup_data.tuple == NULL ||
+			    dup_data.tuple == new_tuple)
+				continue;
+			if (dup_tuple == NULL) {
+				dup_tuple = dup_data.tuple;
+			} else if (dup_tuple != dup_data.tuple) {
+				conflict_data = dup_data;
+				break;
+			}
+		}
+		uint32_t errcode = conflict_data.tuple != NULL ?
+				   ER_TUPLE_FOUND :
+				   replace_check_dup(old_tuple, dup_tuple,
+						     mode);
+		if (errcode) {
+			if (conflict_data.tuple != NULL)
+				i++;
+			memtx_tree_index_replace_multikey_rollback(
+				index, new_tuple, dup_tuple, MIN(i, count));
+			if (conflict_data.tuple != NULL)
+				memtx_tree_insert(&index->tree, conflict_data,
+						  NULL);
+			struct space *sp = space_cache_find(base->def->space_id);
+			if (sp != NULL)
+				diag_set(ClientError, errcode, base->def->name,
+					 space_name(sp));
+			return -1;
+		}
+		*result = dup_tuple;
+	}
+	if (old_tuple != NULL) {
+		/*
+		 * Keys of the old tuple that have been replaced
+		 * with keys of the new one are not identical to
+		 * the tree entries anymore and are left intact.
+		 */
+		struct memtx_tree_data old_data;
+		old_data.tuple = old_tuple;
+		uint32_t count = tuple_multikey_count(old_tuple, cmp_def);
+		for (uint32_t i = 0; i < count; i++) {
+			old_data.hint = i;
+			memtx_tree_delete_identical(&index->tree, old_data);
+		}
+		if (*result == NULL)
+			*result = old_tuple;
+	}
+	return 0;
+}
+
+/**
+ * Replace a tuple in a functional index. Every entry points to
+ * the key of its tuple stored in the index key map, so tuples
+ * are compared without calling the index function. The function
+ * is only called for a tuple that has never been inserted into
+ * the index, so this can't fail when a change is rolled back.
+ */
+static int
+memtx_tree_index_replace_func(struct index *base, struct tuple *old_tuple,
+			      struct tuple *new_tuple,
+			      enum dup_replace_mode mode,
+			      struct tuple **result)
+{
+	struct memtx_tree_index *index = (struct memtx_tree_index *)base;
+	struct memtx_func_key_map *keys = &index->func_keys;
+	bool is_new_key = false;
+	if (new_tuple != NULL) {
+		struct tuple *key = memtx_func_key_map_get(keys, base->def,
+							   new_tuple,
+							   &is_new_key);
+		if (key == NULL)
+			return -1;
+		struct memtx_tree_data new_data;
+		new_data.tuple = new_tuple;
+		new_data.hint = (hint_t)(uintptr_t)key;
+		struct memtx_tree_data dup_data;
+		dup_data.tuple = NULL;
+		if (memtx_tree_insert(&index->tree, new_data,
+				      &dup_data) != 0) {
+			diag_set(OutOfMemory, MEMTX_EXTENT_SIZE,
+				 "memtx_tree_index", "replace");
+			goto fail;
+		}
+		uint32_t errcode = replace_check_dup(old_tuple,
+						     dup_data.tuple, mode);
+		if (errcode) {
+			memtx_tree_delete(&index->tree, new_data);
+			if (dup_data.tuple != NULL)
+				memtx_tree_insert(&index->tree, dup_data, NULL);
+			struct space *sp = space_cache_find(base->def->space_id);
+			if (sp != NULL)
+				diag_set(ClientError, errcode, base->def->name,
+					 space_name(sp));
+			goto fail;
+		}
+		if (dup_data.tuple != NULL) {
+			*result = dup_data.tuple;
+			return 0;
+		}
+	}
+	if (old_tuple != NULL) {
+		/*
+		 * The key may be missing if the tuple has never
+		 * been inserted into the index, e.g. on rollback
+		 * of a failed statement.
+		 */
+		struct tuple *key = memtx_func_key_map_find(keys, old_tuple);
+		if (key != NULL) {
+			struct memtx_tree_data old_data;
+			old_data.tuple = old_tuple;
+			old_data.hint = (hint_t)(uintptr_t)key;
+			memtx_tree_delete(&index->tree, old_data);
+		}
+	}
+	*result = old_tuple;
+	return 0;
+fail:
+	if (is_new_key)
+		memtx_func_key_map_delete(keys, new_tuple);
+	return -1;
+}
+
+void
+memtx_tree_index_forget_func_key(struct index *base, struct tuple *tuple)
+{
+	struct memtx_tree_index *index = (struct memtx_tree_index *)base;
+	assert(base->def->type == TREE && base->def->key_def->for_func_index);
+	memtx_func_key_map_delete(&index->func_keys, tuple);
+}
+
 static int
 memtx_tree_index_replace(struct index *base, struct tuple *old_tuple,
 			 struct tuple *new_tuple, enum dup_replace_mode mode,
 			 struct tuple **result)
 {
 	struct memtx_tree_index *index = (struct memtx_tree_index *)base;
+	struct key_def *cmp_def = index->tree.arg;
+	if (cmp_def->is_multikey) {
+		return memtx_tree_index_replace_multikey(base, old_tuple,
+							 new_tuple, mode,
+							 result);
+	}
+	if (cmp_def->for_func_index) {
+		return memtx_tree_index_replace_func(base, old_tuple,
+						     new_tuple, mode, result);
+	}
 	if (new_tuple) {
 		struct memtx_tree_data new_data;
 		new_data.tuple = new_tuple;
+		new_data.hint = tuple_hint(new_tuple, cmp_def);
 		struct memtx_tree_data dup_data;
 		dup_data.tuple = NULL;
 
@@ -565,6 +930,7 @@ memtx_tree_index_replace(struct index *base, struct tuple *old_tuple,
 	if (old_tuple) {
 		struct memtx_tree_data old_data;
 		old_data.tuple = old_tuple;
+		old_data.hint = tuple_hint(old_tuple, cmp_def);
 		memtx_tree_delete(&index->tree, old_data);
 	}
 	*result = old_tuple;
@@ -605,8 +971,10 @@ memtx_tree_index_create_iterator(struct index *base, enum iterator_type type,
 	it->base.next = tree_iterator_start;
 	it->base.free = tree_iterator_free;
 	it->type = type;
+	it->is_func_index = base->def->key_def->for_func_index;
 	it->key_data.key = key;
 	it->key_data.part_count = part_count;
+	it->key_data.hint = key_hint(key, part_count, index->tree.arg);
 	it->index_def = base->def;
 	it->tree = &index->tree;
 	it->tree_iterator = memtx_tree_invalid_iterator();
@@ -640,10 +1008,13 @@ memtx_tree_index_reserve(struct index *base, uint32_t size_hint)
 	return 0;
 }
 
+/**
+ * Append an entry to the array of tuples used to build an index.
+ */
 static int
-memtx_tree_index_build_next(struct index *base, struct tuple *tuple)
+memtx_tree_index_build_array_append(struct memtx_tree_index *index,
+				    struct tuple *tuple, hint_t hint)
 {
-	struct memtx_tree_index *index = (struct memtx_tree_index *)base;
 	if (index->build_array == NULL) {
 		index->build_array = malloc(MEMTX_EXTENT_SIZE);
 		if (index->build_array == NULL) {
@@ -671,16 +1042,138 @@ memtx_tree_index_build_next(struct index *base, struct tuple *tuple)
 	struct memtx_tree_data *elem =
 		&index->build_array[index->build_array_size++];
 	elem->tuple = tuple;
+	elem->hint = hint;
 	return 0;
 }
 
-static void
-memtx_tree_index_end_build(struct index *base)
+static int
+memtx_tree_index_build_next(struct index *base, struct tuple *tuple)
 {
 	struct memtx_tree_index *index = (struct memtx_tree_index *)base;
+	struct key_def *cmp_def = index->tree.arg;
+	if (cmp_def->for_func_index) {
+		bool unused;
+		struct tuple *key = memtx_func_key_map_get(&index->func_keys,
+							   base->def, tuple,
+							   &unused);
+		if (key == NULL)
+			return -1;
+		return memtx_tree_index_build_array_append(index, tuple,
+						(hint_t)(uintptr_t)key);
+	}
+	if (!cmp_def->is_multikey) {
+		return memtx_tree_index_build_array_append(index, tuple,
+						tuple_hint(tuple, cmp_def));
+	}
+	uint32_t count = tuple_multikey_count(tuple, cmp_def);
+	for (uint32_t i = 0; i < count; i++) {
+		if (memtx_tree_index_build_array_append(index, tuple, i) != 0)
+			return -1;
+	}
+	return 0;
+}
+
+/**
+ * A multikey array of a tuple may contain equal keys, while the
+ * tree must not. Remove such duplicates from the sorted array,
+ * keeping only the first entry of each.
+ */
+static void
+memtx_tree_index_build_array_deduplicate(struct memtx_tree_index *index)
+{
+	if (index->build_array_size == 0)
+		return;
 	struct key_def *cmp_def = memtx_tree_index_cmp_def(index);
+	size_t w_idx = 0;
+	for (size_t r_idx = 1; r_idx < index->build_array_size; r_idx++) {
+		if (index->build_array[w_idx].tuple !=
+		    index->build_array[r_idx].tuple ||
+		    memtx_tree_data_compare(&index->build_array[w_idx],
+					    &index->build_array[r_idx],
+					    cmp_def) != 0) {
+			index->build_array[++w_idx] =
+				index->build_array[r_idx];
+		}
+	}
+	index->build_array_size = w_idx + 1;
+}
+
+static void
+memtx_tree_index_sort_build_array(struct memtx_tree_index *index,
+				  struct key_def *cmp_def)
+{
 	qsort_arg(index->build_array, index->build_array_size,
 		  sizeof(index->build_array[0]), memtx_tree_qcompare, cmp_def);
+}
+
+static ssize_t
+memtx_tree_index_sort_build_array_f(va_list ap)
+{
+	struct memtx_tree_index *index = va_arg(ap, struct memtx_tree_index *);
+	struct key_def *cmp_def = va_arg(ap, struct key_def *);
+	memtx_tree_index_sort_build_array(index, cmp_def);
+	return 0;
+}
+
+/**
+ * Check if tuples can be compared with the given key definition
+ * outside the tx thread. Comparison of strings with an ICU
+ * collation is done by a collator shared by all users of the
+ * collation, and ICU doesn't guarantee that a collator may be
+ * used by a few threads at a time.
+ */
+static bool
+memtx_tree_index_can_sort_async(struct key_def *cmp_def)
+{
+	for (uint32_t i = 0; i < cmp_def->part_count; i++) {
+		if (cmp_def->parts[i].coll != NULL)
+			return false;
+	}
+	return true;
+}
+
+static void
+memtx_tree_index_end_build(struct index *base)
+{
+	/*
+	 * Don't bother offloading small arrays: the thread hop
+	 * costs more than sorting itself.
+	 */
+	enum { ASYNC_SORT_THRESHOLD = 64 * 1024 };
+
+	struct memtx_tree_index *index = (struct memtx_tree_index *)base;
+	struct key_def *cmp_def = memtx_tree_index_cmp_def(index);
+	/*
+	 * Sorting is the most expensive part of building a tree
+	 * index so it is done in a coio thread. The calling fiber
+	 * yields until the array is sorted, which lets the tx
+	 * thread proceed with other indexes meanwhile, see
+	 * memtx_build_secondary_keys(). The tree itself is built
+	 * in the tx thread, because memtx extent allocator isn't
+	 * thread safe.
+	 *
+	 * Comparators only read tuples, which are not modified
+	 * while the index is being built, and tuple formats, which
+	 * may be looked up from any thread. The key definition is
+	 * not read-only though: comparison of JSON path parts
+	 * caches field offset slots in it. So the coio thread is
+	 * given a private copy of the key definition.
+	 */
+	bool is_sorted = false;
+	if (index->build_array_size >= ASYNC_SORT_THRESHOLD &&
+	    memtx_tree_index_can_sort_async(cmp_def)) {
+		struct key_def *copy = key_def_dup(cmp_def);
+		if (copy != NULL) {
+			is_sorted = coio_call(
+				memtx_tree_index_sort_build_array_f,
+				index, copy) == 0;
+			key_def_delete(copy);
+		}
+	}
+	if (!is_sorted)
+		memtx_tree_index_sort_build_array(index, cmp_def);
+	if (index->tree.arg->is_multikey)
+		memtx_tree_index_build_array_deduplicate(index);
 	memtx_tree_build(&index->tree, index->build_array,
 			 index->build_array_size);
 
@@ -746,6 +1239,265 @@ memtx_tree_index_create_snapshot_iterator(struct index *base)
 	return (struct snapshot_iterator *) it;
 }
 
+/* {{{ Frozen index ************************************************/
+
+struct memtx_tree_view {
+	/**
+	 * Copy of the index tree made right after @view was
+	 * created. The head of its memory is the same as @view,
+	 * so the tree functions read the frozen data.
+	 */
+	struct memtx_tree tree;
+	/** The tree of the index that was frozen. */
+	struct memtx_tree *origin;
+	/** Read view of the tree memory. */
+	struct matras_view view;
+	/** Copy of the index key definition. */
+	struct key_def *key_def;
+};
+
+struct memtx_tree_view *
+memtx_tree_view_new(struct index *base)
+{
+	struct memtx_tree_index *index = (struct memtx_tree_index *)base;
+	assert(base->def->type == TREE);
+	struct memtx_tree_view *view = malloc(sizeof(*view));
+	if (view == NULL) {
+		diag_set(OutOfMemory, sizeof(*view), "malloc",
+			 "struct memtx_tree_view");
+		return NULL;
+	}
+	/*
+	 * The index definition may be altered or freed while
+	 * the view is in use, so copy the key definitions.
+	 */
+	view->key_def = key_def_dup(base->def->key_def);
+	if (view->key_def == NULL)
+		goto fail;
+	struct key_def *cmp_def = key_def_dup(index->tree.arg);
+	if (cmp_def == NULL)
+		goto fail_key_def;
+	view->origin = &index->tree;
+	matras_create_read_view(&index->tree.matras, &view->view);
+	view->tree = index->tree;
+	view->tree.matras.head = view->view;
+	view->tree.arg = cmp_def;
+	return view;
+fail_key_def:
+	key_def_delete(view->key_def);
+fail:
+	free(view);
+	return NULL;
+}
+
+void
+memtx_tree_view_delete(struct memtx_tree_view *view)
+{
+	matras_destroy_read_view(&view->origin->matras, &view->view);
+	key_def_delete(view->tree.arg);
+	key_def_delete(view->key_def);
+	free(view);
+}
+
+/**
+ * Check a search key against the index definition the same
+ * way key_validate() does, but without setting diag.
+ */
+static bool
+memtx_tree_view_key_is_valid(struct memtx_tree_view *view, const char *key,
+			     uint32_t part_count)
+{
+	struct key_def *key_def = view->key_def;
+	if (part_count > key_def->part_count)
+		return false;
+	for (uint32_t i = 0; i < part_count; i++) {
+		const struct key_part *part = &key_def->parts[i];
+		if (!field_mp_type_is_compatible(part->type, mp_typeof(*key),
+						 key_part_is_nullable(part)))
+			return false;
+		mp_next(&key);
+	}
+	return true;
+}
+
+/**
+ * Position a tree iterator over a frozen index to the first
+ * tuple matching a key like tree_iterator_start() does. The key
+ * must be valid for the index. Returns false if there is no
+ * matching tuple.
+ */
+static bool
+memtx_tree_view_start(struct memtx_tree_view *view, enum iterator_type type,
+		      struct memtx_tree_key_data *key_data,
+		      struct memtx_tree_iterator *itr)
+{
+	const struct memtx_tree *tree = &view->tree;
+	bool is_reverse = iterator_type_is_reverse(type);
+	if (key_data->key == NULL) {
+		*itr = is_reverse ? memtx_tree_iterator_last(tree) :
+				    memtx_tree_iterator_first(tree);
+		return true;
+	}
+	bool exact = false;
+	if (type == ITER_ALL || type == ITER_EQ ||
+	    type == ITER_GE || type == ITER_LT) {
+		*itr = memtx_tree_lower_bound(tree, key_data, &exact);
+		if (type == ITER_EQ && !exact)
+			return false;
+	} else {
+		*itr = memtx_tree_upper_bound(tree, key_data, &exact);
+		if (type == ITER_REQ && !exact)
+			return false;
+	}
+	if (is_reverse)
+		memtx_tree_iterator_prev(tree, itr);
+	return true;
+}
+
+/**
+ * Return the tuple at the position of a tree iterator over
+ * a frozen index and advance the iterator. Returns NULL if
+ * there are no more tuples matching the key.
+ */
+static struct tuple *
+memtx_tree_view_next(struct memtx_tree_view *view, enum iterator_type type,
+		     struct memtx_tree_key_data *key_data,
+		     struct memtx_tree_iterator *itr)
+{
+	const struct memtx_tree *tree = &view->tree;
+	struct memtx_tree_data *res = memtx_tree_iterator_get_elem(tree, itr);
+	if (res == NULL)
+		return NULL;
+	if ((type == ITER_EQ || type == ITER_REQ) &&
+	    memtx_tree_data_compare_with_key(res, key_data,
+					     view->key_def) != 0)
+		return NULL;
+	/* The tree is frozen, so no need to restore the position. */
+	if (iterator_type_is_reverse(type))
+		memtx_tree_iterator_prev(tree, itr);
+	else
+		memtx_tree_iterator_next(tree, itr);
+	return res->tuple;
+}
+
+int
+memtx_tree_view_select(struct memtx_tree_view *view, enum iterator_type type,
+		       const char *key, uint32_t part_count,
+		       uint32_t offset, uint32_t limit,
+		       memtx_tree_view_select_cb cb, void *arg)
+{
+	if (type > ITER_GT ||
+	    !memtx_tree_view_key_is_valid(view, key, part_count))
+		return -1;
+	if (part_count == 0) {
+		/* See memtx_tree_index_create_iterator(). */
+		type = iterator_type_is_reverse(type) ? ITER_LE : ITER_GE;
+		key = NULL;
+	}
+	struct memtx_tree_key_data key_data;
+	key_data.key = key;
+	key_data.part_count = part_count;
+	key_data.hint = key_hint(key, part_count, view->tree.arg);
+	struct memtx_tree_iterator itr;
+	if (!memtx_tree_view_start(view, type, &key_data, &itr))
+		return 0;
+	struct tuple *tuple;
+	while (limit > 0 &&
+	       (tuple = memtx_tree_view_next(view, type, &key_data,
+					     &itr)) != NULL) {
+		if (offset > 0) {
+			offset--;
+			continue;
+		}
+		if (cb(tuple, arg) != 0)
+			return -1;
+		limit--;
+	}
+	return 0;
+}
+
+struct memtx_tree_view_iterator {
+	/** Frozen index to iterate over. */
+	struct memtx_tree_view *view;
+	/** Iterator type. */
+	enum iterator_type type;
+	/** Search key, points to the memory following the struct. */
+	struct memtx_tree_key_data key_data;
+	/** Position in the frozen tree. */
+	struct memtx_tree_iterator tree_iterator;
+	/** Set if there are no more tuples to return. */
+	bool is_eof;
+};
+
+struct memtx_tree_view_iterator *
+memtx_tree_view_iterator_new(struct memtx_tree_view *view,
+			     enum iterator_type type,
+			     const char *key, uint32_t part_count)
+{
+	if (type > ITER_GT) {
+		diag_set(ClientError, ER_UNSUPPORTED, "TREE index",
+			 "requested iterator type");
+		return NULL;
+	}
+	if (part_count > view->key_def->part_count) {
+		diag_set(ClientError, ER_KEY_PART_COUNT,
+			 view->key_def->part_count, part_count);
+		return NULL;
+	}
+	if (key_validate_parts(view->key_def, key, part_count, true) != 0)
+		return NULL;
+	const char *key_end = key;
+	for (uint32_t i = 0; i < part_count; i++)
+		mp_next(&key_end);
+	size_t key_size = key_end - key;
+	struct memtx_tree_view_iterator *it;
+	size_t size = sizeof(*it) + key_size;
+	it = malloc(size);
+	if (it == NULL) {
+		diag_set(OutOfMemory, size, "malloc",
+			 "struct memtx_tree_view_iterator");
+		return NULL;
+	}
+	if (part_count == 0) {
+		/* See memtx_tree_index_create_iterator(). */
+		type = iterator_type_is_reverse(type) ? ITER_LE : ITER_GE;
+		it->key_data.key = NULL;
+	} else {
+		char *key_copy = (char *)(it + 1);
+		memcpy(key_copy, key, key_size);
+		it->key_data.key = key_copy;
+	}
+	it->view = view;
+	it->type = type;
+	it->key_data.part_count = part_count;
+	it->key_data.hint = key_hint(it->key_data.key, part_count,
+				     view->tree.arg);
+	it->is_eof = !memtx_tree_view_start(view, type, &it->key_data,
+					    &it->tree_iterator);
+	return it;
+}
+
+struct tuple *
+memtx_tree_view_iterator_next(struct memtx_tree_view_iterator *it)
+{
+	if (it->is_eof)
+		return NULL;
+	struct tuple *tuple = memtx_tree_view_next(it->view, it->type,
+						   &it->key_data,
+						   &it->tree_iterator);
+	if (tuple == NULL)
+		it->is_eof = true;
+	return tuple;
+}
+
+void
+memtx_tree_view_iterator_delete(struct memtx_tree_view_iterator *it)
+{
+	free(it);
+}
+
+/* }}} */
+
 static const struct index_vtab memtx_tree_index_vtab = {
 	/* .destroy = */ memtx_tree_index_destroy,
 	/* .commit_create = */ generic_index_commit_create,
@@ -763,6 +1515,7 @@ static const struct index_vtab memtx_tree_index_vtab = {
 	/* .random = */ memtx_tree_index_random,
 	/* .count = */ memtx_tree_index_count,
 	/* .get = */ memtx_tree_index_get,
+	/* .get_many = */ generic_index_get_many,
 	/* .replace = */ memtx_tree_index_replace,
 	/* .create_iterator = */ memtx_tree_index_create_iterator,
 	/* .create_snapshot_iterator = */
@@ -792,6 +1545,12 @@ memtx_tree_index_new(struct memtx_engine *memtx, struct index_def *def)
 		return NULL;
 	}
 
+	if (def->key_def->for_func_index &&
+	    memtx_func_key_map_create(&index->func_keys, memtx) != 0) {
+		index_def_delete(index->base.def);
+		free(index);
+		return NULL;
+	}
 	struct key_def *cmp_def = memtx_tree_index_cmp_def(index);
 	memtx_tree_create(&index->tree, cmp_def, memtx_index_extent_alloc,
 			  memtx_index_extent_free, memtx);
@@ -31,6 +31,9 @@
  * SUCH DAMAGE.
  */
 
+#include <stdint.h>
+#include "iterator_type.h"
+
 #if defined(__cplusplus)
 extern "C" {
 #endif /* defined(__cplusplus) */
@@ -38,10 +41,85 @@ extern "C" {
 struct index;
 struct index_def;
 struct memtx_engine;
+struct tuple;
 
 struct index *
 memtx_tree_index_new(struct memtx_engine *memtx, struct index_def *def);
 
+/**
+ * Drop the stored key of a tuple that has been deleted from
+ * a functional TREE index, see struct memtx_func_key_map.
+ */
+void
+memtx_tree_index_forget_func_key(struct index *index, struct tuple *tuple);
+
+/**
+ * A frozen copy of a memtx TREE index. It shares memory with
+ * the index, which goes on being modified in the tx thread,
+ * and can be searched from any thread. The memory must be
+ * pinned with memtx_engine_enter_read_view() for as long as
+ * the copy is in use.
+ */
+struct memtx_tree_view;
+
+/**
+ * Freeze a TREE index. Returns NULL and sets diag on error.
+ */
+struct memtx_tree_view *
+memtx_tree_view_new(struct index *index);
+
+/** Destroy a frozen index. Must be called in the tx thread. */
+void
+memtx_tree_view_delete(struct memtx_tree_view *view);
+
+/** Called by memtx_tree_view_select() for each found tuple. */
+typedef int
+(*memtx_tree_view_select_cb)(struct tuple *tuple, void *arg);
+
+/**
+ * Find tuples matching a key in a frozen index, skip the first
+ * @a offset of them and pass at most @a limit others to @a cb,
+ * like box_select() does. May be called from any thread.
+ * The found tuples must not be referenced. Returns -1 if
+ * the iterator type or the key isn't valid for the index or
+ * @a cb failed. Never sets diag itself.
+ */
+int
+memtx_tree_view_select(struct memtx_tree_view *view, enum iterator_type type,
+		       const char *key, uint32_t part_count,
+		       uint32_t offset, uint32_t limit,
+		       memtx_tree_view_select_cb cb, void *arg);
+
+/** Iterator over a frozen TREE index. */
+struct memtx_tree_view_iterator;
+
+/**
+ * Create an iterator over tuples of a frozen index matching
+ * a key, like index_create_iterator() does. The key is copied.
+ * The view must outlive the iterator. Unlike the iterators of
+ * a live index, the iterator stays valid when the tx thread
+ * modifies the index. Returns NULL and sets diag if the key or
+ * the iterator type isn't valid for the index.
+ */
+struct memtx_tree_view_iterator *
+memtx_tree_view_iterator_new(struct memtx_tree_view *view,
+			     enum iterator_type type,
+			     const char *key, uint32_t part_count);
+
+/**
+ * Return the next tuple of a frozen index iterator or NULL if
+ * there are no more tuples. The tuple may have been deleted
+ * from the index since the view was created, but it stays
+ * valid as long as the memory of the view is pinned. In the tx
+ * thread, the tuple may be referenced to outlive the view.
+ */
+struct tuple *
+memtx_tree_view_iterator_next(struct memtx_tree_view_iterator *it);
+
+/** Destroy a frozen index iterator. */
+void
+memtx_tree_view_iterator_delete(struct memtx_tree_view_iterator *it);
+
 #if defined(__cplusplus)
 } /* extern "C" */
 #endif /* defined(__cplusplus) */
@@ -89,6 +89,9 @@ space_cache_find(uint32_t id)
 	return NULL;
 }
 
+struct func *
+func_by_id(uint32_t fid);
+
 struct func *
 func_by_name(const char *name, uint32_t name_len);
 
@@ -175,11 +178,6 @@ func_cache_replace(struct func_def *def);
 void
 func_cache_delete(uint32_t fid);
 
-struct func;
-
-struct func *
-func_by_id(uint32_t fid);
-
 static inline struct func *
 func_cache_find(uint32_t fid)
 {
@@ -0,0 +1,337 @@
+/*
+ * Copyright 2010-2019, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include "select_view.h"
+
+#include <stdlib.h>
+#include <pmatomic.h>
+#include <small/obuf.h>
+#include <msgpuck.h>
+
+#include "diag.h"
+#include "engine.h"
+#include "memtx_engine.h"
+#include "memtx_tree.h"
+#include "space.h"
+#include "schema.h"
+#include "tuple.h"
+#include "user_def.h"
+#include "xrow.h"
+
+/** A space included in a select view. */
+struct select_view_space {
+	/** Space id. */
+	uint32_t id;
+	/** Id of the space owner. */
+	uint32_t owner_uid;
+	/** Access to the space granted to users, by auth token. */
+	user_access_t access[BOX_USER_MAX];
+	/** Size of the index array, max index id + 1. */
+	uint32_t index_count;
+	/**
+	 * Frozen indexes of the space by index id, NULL if
+	 * the index is missing or can't be used by a view.
+	 */
+	struct memtx_tree_view **index;
+};
+
+struct select_view {
+	/** Memtx engine the view belongs to. */
+	struct memtx_engine *memtx;
+	/** Pins tuples and index memory used by the view. */
+	struct memtx_read_view_version version;
+	/** Schema version at the time the view was created. */
+	uint32_t schema_version;
+	/** Access to all spaces granted to users, by auth token. */
+	user_access_t space_access[BOX_USER_MAX];
+	/** Spaces included in the view, sorted by id. */
+	struct select_view_space *spaces;
+	/** Number of entries in the space array. */
+	uint32_t space_count;
+	/** Number of entries allocated for the space array. */
+	uint32_t space_capacity;
+};
+
+/** The view returned by select_view_acquire(). */
+static struct select_view *current_view;
+
+/**
+ * Check if an index can be searched by a reader thread.
+ * Collations aren't used, because they may keep state that
+ * isn't safe to access from a thread other than tx. Neither
+ * are JSON paths: looking them up updates the offset slot
+ * cache of key parts, which are shared by all readers.
+ */
+static bool
+select_view_index_is_supported(struct index *index)
+{
+	struct key_def *key_def = index->def->key_def;
+	if (index->def->type != TREE || key_def->is_multikey ||
+	    key_def->for_func_index)
+		return false;
+	struct key_def *cmp_def = index->def->cmp_def;
+	if (cmp_def->has_json_paths)
+		return false;
+	for (uint32_t i = 0; i < cmp_def->part_count; i++) {
+		if (cmp_def->parts[i].coll != NULL)
+			return false;
+	}
+	return true;
+}
+
+static int
+select_view_add_space(struct space *space, void *arg)
+{
+	struct select_view *view = (struct select_view *)arg;
+	if (!space_is_memtx(space) || space_is_temporary(space))
+		return 0;
+	/*
+	 * Tuples of compressed spaces would have to be
+	 * decompressed before being sent, which needs the
+	 * fiber region and may fail.
+	 */
+	if (space->format->is_compressed)
+		return 0;
+	if (view->space_count == view->space_capacity) {
+		uint32_t capacity = MAX(view->space_capacity * 2, 16);
+		size_t size = capacity * sizeof(*view->spaces);
+		struct select_view_space *spaces = realloc(view->spaces, size);
+		if (spaces == NULL) {
+			diag_set(OutOfMemory, size, "realloc", "spaces");
+			return -1;
+		}
+		view->spaces = spaces;
+		view->space_capacity = capacity;
+	}
+	uint32_t index_count = space->index_id_max + 1;
+	struct memtx_tree_view **index = calloc(index_count, sizeof(*index));
+	if (index == NULL) {
+		diag_set(OutOfMemory, index_count * sizeof(*index),
+			 "calloc", "index");
+		return -1;
+	}
+	struct select_view_space *entry = &view->spaces[view->space_count++];
+	entry->id = space_id(space);
+	entry->owner_uid = space->def->uid;
+	for (int i = 0; i < BOX_USER_MAX; i++)
+		entry->access[i] = space->access[i].effective;
+	entry->index_count = index_count;
+	entry->index = index;
+	for (uint32_t i = 0; i < space->index_count; i++) {
+		struct index *idx = space->index[i];
+		if (!select_view_index_is_supported(idx))
+			continue;
+		index[idx->def->iid] = memtx_tree_view_new(idx);
+		if (index[idx->def->iid] == NULL)
+			return -1;
+	}
+	return 0;
+}
+
+static int
+select_view_space_cmp(const void *a, const void *b)
+{
+	uint32_t id_a = ((const struct select_view_space *)a)->id;
+	uint32_t id_b = ((const struct select_view_space *)b)->id;
+	return id_a < id_b ? -1 : id_a > id_b;
+}
+
+struct select_view *
+select_view_new(void)
+{
+	struct select_view *view = calloc(1, sizeof(*view));
+	if (view == NULL) {
+		diag_set(OutOfMemory, sizeof(*view), "calloc", "view");
+		return NULL;
+	}
+	view->memtx = (struct memtx_engine *)engine_by_name("memtx");
+	/*
+	 * Pin the memory before freezing indexes so that none
+	 * of the tuples they point to is freed.
+	 */
+	if (memtx_engine_enter_read_view(view->memtx, &view->version) != 0) {
+		free(view);
+		return NULL;
+	}
+	view->schema_version = schema_version;
+	struct access *access = entity_access_get(SC_SPACE);
+	for (int i = 0; i < BOX_USER_MAX; i++)
+		view->space_access[i] = access[i].effective;
+	if (space_foreach(select_view_add_space, view) != 0) {
+		select_view_delete(view);
+		return NULL;
+	}
+	qsort(view->spaces, view->space_count, sizeof(*view->spaces),
+	      select_view_space_cmp);
+	return view;
+}
+
+void
+select_view_delete(struct select_view *view)
+{
+	for (uint32_t i = 0; i < view->space_count; i++) {
+		struct select_view_space *space = &view->spaces[i];
+		for (uint32_t j = 0; j < space->index_count; j++) {
+			if (space->index[j] != NULL)
+				memtx_tree_view_delete(space->index[j]);
+		}
+		free(space->index);
+	}
+	free(view->spaces);
+	memtx_engine_leave_read_view(view->memtx, &view->version);
+	free(view);
+}
+
+uint32_t
+select_view_schema_version(const struct select_view *view)
+{
+	return view->schema_version;
+}
+
+static struct select_view_space *
+select_view_find_space(struct select_view *view, uint32_t id)
+{
+	struct select_view_space key;
+	key.id = id;
+	return bsearch(&key, view->spaces, view->space_count,
+		       sizeof(*view->spaces), select_view_space_cmp);
+}
+
+/**
+ * Check if a user may read a space. Follows access_check_space(),
+ * but uses access rights stored in the view.
+ */
+static bool
+select_view_check_access(struct select_view *view,
+			 struct select_view_space *space,
+			 const struct credentials *cr)
+{
+	/* Any space access also requires global USAGE privilege. */
+	user_access_t access = (PRIV_R | PRIV_U) & ~cr->universal_access;
+	access &= ~view->space_access[cr->auth_token];
+	if (access == 0)
+		return true;
+	if (access & PRIV_U)
+		return false;
+	return space->owner_uid == cr->uid ||
+	       (access & ~space->access[cr->auth_token]) == 0;
+}
+
+struct select_view_dump_ctx {
+	struct obuf *out;
+	uint32_t count;
+};
+
+static int
+select_view_dump_tuple(struct tuple *tuple, void *arg)
+{
+	struct select_view_dump_ctx *ctx = (struct select_view_dump_ctx *)arg;
+	if (obuf_dup(ctx->out, tuple_data(tuple), tuple->bsize) !=
+	    tuple->bsize)
+		return -1;
+	ctx->count++;
+	return 0;
+}
+
+int
+select_view_select(struct select_view *view, const struct credentials *cr,
+		   const struct request *request, struct obuf *out,
+		   uint32_t *count)
+{
+	if (request->iterator >= iterator_type_MAX)
+		return -1;
+	struct select_view_space *space =
+		select_view_find_space(view, request->space_id);
+	if (space == NULL || request->index_id >= space->index_count ||
+	    space->index[request->index_id] == NULL)
+		return -1;
+	if (!select_view_check_access(view, space, cr))
+		return -1;
+	const char *key = request->key;
+	uint32_t part_count = key != NULL ? mp_decode_array(&key) : 0;
+	struct select_view_dump_ctx ctx = { out, 0 };
+	if (memtx_tree_view_select(space->index[request->index_id],
+				   (enum iterator_type)request->iterator,
+				   key, part_count, request->offset,
+				   request->limit, select_view_dump_tuple,
+				   &ctx) != 0)
+		return -1;
+	*count = ctx.count;
+	return 0;
+}
+
+struct select_view *
+select_view_publish(struct select_view *view)
+{
+	return pm_atomic_exchange(&current_view, view);
+}
+
+struct select_view *
+select_view_acquire(struct select_view_ref *ref)
+{
+	struct select_view *view;
+	do {
+		view = pm_atomic_load(&current_view);
+		/*
+		 * Announce the view before checking that it's
+		 * still current: a view replaced after this
+		 * point won't be deleted while we're using it,
+		 * see select_view_is_acquired().
+		 */
+		pm_atomic_store(&ref->view, view);
+	} while (pm_atomic_load(&current_view) != view);
+	return view;
+}
+
+bool
+select_view_release(struct select_view_ref *ref)
+{
+	struct select_view *view = pm_atomic_load(&ref->view);
+	if (view == NULL)
+		return false;
+	pm_atomic_store(&ref->view, NULL);
+	/*
+	 * If the view has been replaced before the reference
+	 * was cleared, the tx thread may have seen the view
+	 * acquired and be waiting for it to be released.
+	 */
+	return pm_atomic_load(&current_view) != view;
+}
+
+bool
+select_view_is_acquired(struct select_view *view,
+			struct select_view_ref *refs, int count)
+{
+	for (int i = 0; i < count; i++) {
+		if (pm_atomic_load(&refs[i].view) == view)
+			return true;
+	}
+	return false;
+}
@@ -0,0 +1,138 @@
+#ifndef TARANTOOL_BOX_SELECT_VIEW_H_INCLUDED
+#define TARANTOOL_BOX_SELECT_VIEW_H_INCLUDED
+/*
+ * Copyright 2010-2019, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+struct credentials;
+struct request;
+struct obuf;
+
+/**
+ * An immutable snapshot of memtx spaces used for serving
+ * IPROTO_SELECT requests outside the tx thread. It consists
+ * of frozen copies of TREE indexes and of access rights as
+ * they were at the time the view was created, so a reader
+ * thread can execute a request against it without touching
+ * any state owned by the tx thread.
+ */
+struct select_view;
+
+/**
+ * A reference to the current select view held by a reader
+ * thread, see select_view_acquire(). Each thread must use
+ * its own reference.
+ */
+struct select_view_ref {
+	struct select_view *view;
+};
+
+/**
+ * Create a view of the current state of memtx spaces.
+ * Must be called in the tx thread. Returns NULL and sets
+ * diag on error.
+ */
+struct select_view *
+select_view_new(void);
+
+/**
+ * Destroy a select view. Must be called in the tx thread
+ * after making sure the view isn't used by reader threads,
+ * see select_view_is_acquired().
+ */
+void
+select_view_delete(struct select_view *view);
+
+/** Return the schema version the view was created at. */
+uint32_t
+select_view_schema_version(const struct select_view *view);
+
+/**
+ * Execute a SELECT request against a view on behalf of
+ * a user with the given credentials: append found tuples to
+ * @a out and store their number in @a count. May be called
+ * from any thread.
+ *
+ * Returns -1 if the request can't be served from the view,
+ * e.g. the space or the index isn't in the view, the key is
+ * invalid or access is denied, in which case the request
+ * should be executed in the tx thread, which will report an
+ * error if any. Never sets diag. On failure @a out may hold
+ * some data appended by this function, it's up to the caller
+ * to roll it back.
+ */
+int
+select_view_select(struct select_view *view, const struct credentials *cr,
+		   const struct request *request, struct obuf *out,
+		   uint32_t *count);
+
+/**
+ * Make @a view, which may be NULL, the current view returned
+ * by select_view_acquire() and return the previous current
+ * view. Must be called in the tx thread.
+ */
+struct select_view *
+select_view_publish(struct select_view *view);
+
+/**
+ * Return the current view and store it in @a ref so that it
+ * isn't deleted until select_view_release() is called.
+ * Returns NULL if there's no current view. May be called
+ * from any thread.
+ */
+struct select_view *
+select_view_acquire(struct select_view_ref *ref);
+
+/**
+ * Release a view acquired with select_view_acquire().
+ * Returns true if the view isn't current anymore, in which
+ * case the tx thread may be waiting for it to be released
+ * in order to delete it and should be woken up.
+ */
+bool
+select_view_release(struct select_view_ref *ref);
+
+/** Check if a view is acquired by any of @a count references. */
+bool
+select_view_is_acquired(struct select_view *view,
+			struct select_view_ref *refs, int count);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
+
+#endif /* TARANTOOL_BOX_SELECT_VIEW_H_INCLUDED */
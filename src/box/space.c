@@ -469,6 +469,18 @@ int
 space_execute_dml(struct space *space, struct txn *txn,
 		  struct request *request, struct tuple **result)
 {
+	if (unlikely(request->type == IPROTO_DELETE_RANGE) &&
+	    space->run_triggers &&
+	    (!rlist_empty(&space->before_replace) ||
+	     !rlist_empty(&space->on_replace))) {
+		/*
+		 * A range deletion doesn't produce the deleted
+		 * tuples, so there's nothing to pass to triggers.
+		 */
+		diag_set(ClientError, ER_UNSUPPORTED,
+			 "Space with triggers", "delete_range()");
+		return -1;
+	}
 	if (unlikely(space->sequence != NULL) &&
 	    (request->type == IPROTO_INSERT ||
 	     request->type == IPROTO_REPLACE)) {
@@ -525,6 +537,12 @@ space_execute_dml(struct space *space, struct txn *txn,
 		if (space->vtab->execute_upsert(space, txn, request) != 0)
 			return -1;
 		break;
+	case IPROTO_DELETE_RANGE:
+		*result = NULL;
+		if (space->vtab->execute_delete_range(space, txn,
+						      request) != 0)
+			return -1;
+		break;
 	default:
 		*result = NULL;
 	}
@@ -549,6 +567,17 @@ generic_space_apply_initial_join_row(struct space *space,
 	return 0;
 }
 
+int
+generic_space_execute_delete_range(struct space *space, struct txn *txn,
+				   struct request *request)
+{
+	(void)txn;
+	(void)request;
+	diag_set(ClientError, ER_UNSUPPORTED, space->engine->name,
+		 "delete_range()");
+	return -1;
+}
+
 int
 generic_space_ephemeral_replace(struct space *space, const char *tuple,
 				const char *tuple_end)
@@ -66,6 +66,12 @@ struct space_vtab {
 	int (*execute_update)(struct space *, struct txn *,
 			      struct request *, struct tuple **result);
 	int (*execute_upsert)(struct space *, struct txn *, struct request *);
+	/**
+	 * Delete all tuples whose primary key is in the range
+	 * [request->key, request->tuple).
+	 */
+	int (*execute_delete_range)(struct space *, struct txn *,
+				    struct request *);
 
 	int (*ephemeral_replace)(struct space *, const char *, const char *);
 
@@ -457,6 +463,8 @@ space_fill_index_map(struct space *space);
  */
 size_t generic_space_bsize(struct space *);
 int generic_space_apply_initial_join_row(struct space *, struct request *);
+int generic_space_execute_delete_range(struct space *, struct txn *,
+				       struct request *);
 int generic_space_ephemeral_replace(struct space *, const char *, const char *);
 int generic_space_ephemeral_delete(struct space *, const char *);
 int generic_space_ephemeral_rowid_next(struct space *, uint64_t *);
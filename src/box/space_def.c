@@ -50,11 +50,15 @@ static int
 checks_array_decode(const char **str, uint32_t len, char *opt, uint32_t errcode,
 		    uint32_t field_no);
 
+const char *space_compression_strs[] = { "none", "zstd" };
+
 const struct space_opts space_opts_default = {
 	/* .group_id = */ 0,
 	/* .is_temporary = */ false,
 	/* .is_ephemeral = */ false,
 	/* .view = */ false,
+	/* .compression = */ SPACE_COMPRESSION_NONE,
+	/* .field_offset_step = */ 0,
 	/* .sql        = */ NULL,
 	/* .checks     = */ NULL,
 };
@@ -63,6 +67,10 @@ const struct opt_def space_opts_reg[] = {
 	OPT_DEF("group_id", OPT_UINT32, struct space_opts, group_id),
 	OPT_DEF("temporary", OPT_BOOL, struct space_opts, is_temporary),
 	OPT_DEF("view", OPT_BOOL, struct space_opts, is_view),
+	OPT_DEF_ENUM("compression", space_compression, struct space_opts,
+		     compression, NULL),
+	OPT_DEF("field_offset_step", OPT_UINT32, struct space_opts,
+		field_offset_step),
 	OPT_DEF("sql", OPT_STRPTR, struct space_opts, sql),
 	OPT_DEF_ARRAY("checks", struct space_opts, checks,
 		      checks_array_decode),
@@ -42,6 +42,17 @@ extern "C" {
 
 struct ExprList;
 
+/** Compression of tuple fields stored in a memtx space. */
+enum space_compression {
+	/** Tuples are stored as is. */
+	SPACE_COMPRESSION_NONE = 0,
+	/** Big non-indexed fields are compressed with zstd. */
+	SPACE_COMPRESSION_ZSTD,
+	space_compression_MAX
+};
+
+extern const char *space_compression_strs[];
+
 /** Space options */
 struct space_opts {
 	/**
@@ -69,6 +80,18 @@ struct space_opts {
 	 * this flag can't be changed after space creation.
 	 */
 	bool is_view;
+	/**
+	 * Compression of big tuple fields which are not used
+	 * by any index. Supported by memtx only.
+	 */
+	enum space_compression compression;
+	/**
+	 * If not 0, tuples store offsets of every N-th field
+	 * so that any field of a wide tuple can be found without
+	 * skipping all fields preceding it, see tuple_format::
+	 * offset_step. Supported by memtx only.
+	 */
+	uint32_t field_offset_step;
 	/** SQL statement that produced this space. */
 	char *sql;
 	/** SQL Checks expressions list. */
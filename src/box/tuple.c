@@ -30,6 +30,14 @@
  */
 #include "tuple.h"
 
+#include <limits.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+
 #include "trivia/util.h"
 #include "memory.h"
 #include "fiber.h"
@@ -37,6 +45,7 @@
 #include "small/small.h"
 
 #include "tuple_update.h"
+#include "tuple_compression.h"
 #include "coll_id_cache.h"
 
 static struct mempool tuple_iterator_pool;
@@ -129,7 +138,7 @@ tuple_validate_raw(struct tuple_format *format, const char *tuple)
 	uint32_t *field_map, field_map_size;
 	int rc = tuple_field_map_create(format, tuple, true, &field_map,
 					&field_map_size);
-	assert(rc != 0 || field_map_size == format->field_map_size);
+	assert(rc != 0 || field_map_size >= format->field_map_size);
 	region_truncate(region, region_svp);
 	return rc;
 }
@@ -323,11 +332,181 @@ tuple_init(field_name_hash_f hash)
 	return 0;
 }
 
+const char *tuple_arena_pages_strs[] = {
+	/* [TUPLE_ARENA_PAGES_OFF]		= */ "off",
+	/* [TUPLE_ARENA_PAGES_TRANSPARENT]	= */ "transparent",
+	/* [TUPLE_ARENA_PAGES_2M]		= */ "2M",
+	/* [TUPLE_ARENA_PAGES_1G]		= */ "1G",
+};
+
+const char *tuple_arena_numa_policy_strs[] = {
+	/* [TUPLE_ARENA_NUMA_DEFAULT]		= */ "default",
+	/* [TUPLE_ARENA_NUMA_BIND]		= */ "bind",
+	/* [TUPLE_ARENA_NUMA_INTERLEAVE]	= */ "interleave",
+};
+
+int
+tuple_arena_parse_numa_nodes(const char *str, uint64_t *nodes)
+{
+	*nodes = 0;
+	const char *pos = str;
+	do {
+		char *end;
+		unsigned long first = strtoul(pos, &end, 10);
+		unsigned long last = first;
+		if (end == pos)
+			return -1;
+		pos = end;
+		if (*pos == '-') {
+			last = strtoul(++pos, &end, 10);
+			if (end == pos || last < first)
+				return -1;
+			pos = end;
+		}
+		if (last >= TUPLE_ARENA_NUMA_NODE_MAX)
+			return -1;
+		for (unsigned long node = first; node <= last; node++)
+			*nodes |= 1ULL << node;
+	} while (*pos++ == ',');
+	return *--pos == '\0' ? 0 : -1;
+}
+
+/** Size of huge pages of the given type or 0 for regular pages. */
+static size_t
+tuple_arena_huge_page_size(enum tuple_arena_pages pages)
+{
+	switch (pages) {
+	case TUPLE_ARENA_PAGES_TRANSPARENT:
+	case TUPLE_ARENA_PAGES_2M:
+		return 2 * 1024 * 1024;
+	case TUPLE_ARENA_PAGES_1G:
+		return 1024 * 1024 * 1024;
+	default:
+		return 0;
+	}
+}
+
+/**
+ * Map an arena backed by explicitly reserved huge pages.
+ * The arena size must be a multiple of the page size.
+ */
+static int
+tuple_arena_create_hugetlb(struct slab_arena *arena, struct quota *quota,
+			   size_t prealloc, uint32_t slab_size,
+			   enum tuple_arena_pages pages)
+{
+#if defined(MAP_HUGETLB)
+	enum { HUGE_SHIFT = 26 }; /* MAP_HUGE_SHIFT */
+	int log2_page_size = pages == TUPLE_ARENA_PAGES_1G ? 30 : 21;
+	return slab_arena_create(arena, quota, prealloc, slab_size,
+				 MAP_PRIVATE | MAP_HUGETLB |
+				 (log2_page_size << HUGE_SHIFT));
+#else
+	(void)arena;
+	(void)quota;
+	(void)prealloc;
+	(void)slab_size;
+	(void)pages;
+	errno = ENOTSUP;
+	return -1;
+#endif
+}
+
+/** Bit mask of online NUMA nodes or 0 if unknown. */
+static uint64_t
+tuple_arena_online_numa_nodes(void)
+{
+	uint64_t nodes = 0;
+	char buf[256];
+	FILE *f = fopen("/sys/devices/system/node/online", "r");
+	if (f == NULL)
+		return 0;
+	if (fgets(buf, sizeof(buf), f) != NULL) {
+		buf[strcspn(buf, "\n")] = '\0';
+		if (tuple_arena_parse_numa_nodes(buf, &nodes) != 0)
+			nodes = 0;
+	}
+	fclose(f);
+	return nodes;
+}
+
+/**
+ * Apply NUMA memory policy to an arena. The policy only
+ * affects pages that haven't been touched yet, so it must
+ * be set right after the arena is mapped.
+ */
+static int
+tuple_arena_set_numa_policy(struct slab_arena *arena,
+			    const struct tuple_arena_opts *opts)
+{
+#if defined(__linux__) && defined(SYS_mbind)
+	enum { MPOL_BIND_ = 2, MPOL_INTERLEAVE_ = 3 }; /* numaif.h */
+	enum { LONG_BITS = sizeof(unsigned long) * CHAR_BIT };
+	uint64_t nodes = opts->numa_nodes;
+	if (nodes == 0)
+		nodes = tuple_arena_online_numa_nodes();
+	if (nodes == 0) {
+		errno = ENODEV;
+		return -1;
+	}
+	unsigned long mask[TUPLE_ARENA_NUMA_NODE_MAX / LONG_BITS + 1];
+	memset(mask, 0, sizeof(mask));
+	for (int node = 0; node < TUPLE_ARENA_NUMA_NODE_MAX; node++) {
+		if (nodes & (1ULL << node))
+			mask[node / LONG_BITS] |= 1UL << (node % LONG_BITS);
+	}
+	int mode = opts->numa_policy == TUPLE_ARENA_NUMA_BIND ?
+		   MPOL_BIND_ : MPOL_INTERLEAVE_;
+	/* The kernel ignores the last bit of the mask. */
+	return syscall(SYS_mbind, arena->arena, arena->prealloc, mode,
+		       mask, TUPLE_ARENA_NUMA_NODE_MAX + 1, 0) == 0 ? 0 : -1;
+#else
+	(void)arena;
+	(void)opts;
+	errno = ENOTSUP;
+	return -1;
+#endif
+}
+
 void
 tuple_arena_create(struct slab_arena *arena, struct quota *quota,
 		   uint64_t arena_max_size, uint32_t slab_size,
-		   const char *arena_name)
+		   struct tuple_arena_opts *opts, const char *arena_name)
 {
+	struct tuple_arena_opts default_opts = {
+		/* .pages = */ TUPLE_ARENA_PAGES_OFF,
+		/* .numa_policy = */ TUPLE_ARENA_NUMA_DEFAULT,
+		/* .numa_nodes = */ 0,
+	};
+	if (opts == NULL)
+		opts = &default_opts;
+	/*
+	 * Explicit huge pages are reserved when the arena is
+	 * mapped. If there are not enough of them, fall back on
+	 * smaller pages, down to transparent huge pages, which
+	 * are allocated by the kernel on the best effort basis.
+	 */
+	while (opts->pages == TUPLE_ARENA_PAGES_2M ||
+	       opts->pages == TUPLE_ARENA_PAGES_1G) {
+		/* The mapping must consist of whole pages. */
+		size_t page_size = tuple_arena_huge_page_size(opts->pages);
+		size_t prealloc = small_align(arena_max_size,
+					      MAX(page_size, slab_size));
+		say_info("mapping %zu bytes for %s tuple arena "
+			 "using %s huge pages...", prealloc, arena_name,
+			 tuple_arena_pages_strs[opts->pages]);
+		if (tuple_arena_create_hugetlb(arena, quota, prealloc,
+					       slab_size, opts->pages) == 0)
+			goto numa;
+		enum tuple_arena_pages fallback =
+			opts->pages == TUPLE_ARENA_PAGES_1G ?
+			TUPLE_ARENA_PAGES_2M : TUPLE_ARENA_PAGES_TRANSPARENT;
+		say_warn("failed to map %s huge pages for %s tuple arena: %s, "
+			 "falling back on %s pages", tuple_arena_pages_strs[
+			 opts->pages], arena_name, strerror(errno),
+			 tuple_arena_pages_strs[fallback]);
+		opts->pages = fallback;
+	}
 	/*
 	 * Ensure that quota is a multiple of slab_size, to
 	 * have accurate value of quota_used_ratio.
@@ -348,6 +527,70 @@ tuple_arena_create(struct slab_arena *arena, struct quota *quota,
 				       " tuple arena", prealloc, arena_name);
 		}
 	}
+	if (opts->pages == TUPLE_ARENA_PAGES_TRANSPARENT) {
+#if defined(MADV_HUGEPAGE)
+		if (madvise(arena->arena, arena->prealloc,
+			    MADV_HUGEPAGE) != 0) {
+			say_syserror("failed to enable transparent huge pages "
+				     "for %s tuple arena", arena_name);
+			opts->pages = TUPLE_ARENA_PAGES_OFF;
+		}
+#else
+		say_warn("transparent huge pages are not supported");
+		opts->pages = TUPLE_ARENA_PAGES_OFF;
+#endif
+	}
+numa:
+	if (opts->numa_policy != TUPLE_ARENA_NUMA_DEFAULT &&
+	    tuple_arena_set_numa_policy(arena, opts) != 0) {
+		say_syserror("failed to set NUMA memory policy '%s' "
+			     "for %s tuple arena",
+			     tuple_arena_numa_policy_strs[opts->numa_policy],
+			     arena_name);
+		opts->numa_policy = TUPLE_ARENA_NUMA_DEFAULT;
+	}
+}
+
+void
+tuple_arena_page_stat(struct slab_arena *arena,
+		      const struct tuple_arena_opts *opts,
+		      struct tuple_arena_page_stat *stat)
+{
+	stat->page_size = tuple_arena_huge_page_size(opts->pages);
+	stat->huge_pages = 0;
+	if (stat->page_size == 0) {
+		stat->page_size = sysconf(_SC_PAGESIZE);
+		return;
+	}
+	/*
+	 * Sum up huge pages of all mappings overlapping with
+	 * the arena. Note, we don't look at mappings of regular
+	 * pages, because walking their page tables may take long.
+	 */
+	FILE *f = fopen("/proc/self/smaps", "r");
+	if (f == NULL)
+		return;
+	uintptr_t arena_start = (uintptr_t)arena->arena;
+	uintptr_t arena_end = arena_start + arena->prealloc;
+	bool is_arena = false;
+	size_t huge_size_kb = 0;
+	char line[256];
+	while (fgets(line, sizeof(line), f) != NULL) {
+		unsigned long start, end;
+		size_t size_kb;
+		if (sscanf(line, "%lx-%lx ", &start, &end) == 2) {
+			is_arena = start < arena_end && end > arena_start;
+			continue;
+		}
+		if (!is_arena)
+			continue;
+		if (sscanf(line, "AnonHugePages: %zu kB", &size_kb) == 1 ||
+		    sscanf(line, "Private_Hugetlb: %zu kB", &size_kb) == 1 ||
+		    sscanf(line, "Shared_Hugetlb: %zu kB", &size_kb) == 1)
+			huge_size_kb += size_kb;
+	}
+	fclose(f);
+	stat->huge_pages = huge_size_kb * 1024 / stat->page_size;
 }
 
 void
@@ -373,6 +616,8 @@ tuple_free(void)
 	coll_id_cache_destroy();
 
 	bigref_list_destroy();
+
+	tuple_compression_free();
 }
 
 /* {{{ tuple_field_* getters */
@@ -393,8 +638,7 @@ tuple_field_go_to_index(const char **field, uint64_t index)
 		uint32_t count = mp_decode_array(field);
 		if (index >= count)
 			return -1;
-		for (; index > 0; --index)
-			mp_next(field);
+		mp_scan_skip(field, index);
 		return 0;
 	} else if (type == MP_MAP) {
 		index += TUPLE_INDEX_BASE;
@@ -455,7 +699,8 @@ tuple_field_go_to_key(const char **field, const char *key, int len)
 }
 
 int
-tuple_go_to_path(const char **data, const char *path, uint32_t path_len)
+tuple_go_to_path(const char **data, const char *path, uint32_t path_len,
+		 int multikey_idx)
 {
 	int rc;
 	struct json_lexer lexer;
@@ -463,6 +708,13 @@ tuple_go_to_path(const char **data, const char *path, uint32_t path_len)
 	json_lexer_create(&lexer, path, path_len, TUPLE_INDEX_BASE);
 	while ((rc = json_lexer_next_token(&lexer, &token)) == 0) {
 		switch (token.type) {
+		case JSON_TOKEN_ANY:
+			if (multikey_idx == MULTIKEY_NONE) {
+				rc = -1;
+				break;
+			}
+			rc = tuple_field_go_to_index(data, multikey_idx);
+			break;
 		case JSON_TOKEN_NUM:
 			rc = tuple_field_go_to_index(data, token.num);
 			break;
@@ -481,6 +733,22 @@ tuple_go_to_path(const char **data, const char *path, uint32_t path_len)
 	return rc != 0 ? -1 : 0;
 }
 
+uint32_t
+tuple_multikey_count(const struct tuple *tuple, struct key_def *key_def)
+{
+	assert(key_def->is_multikey);
+	const char *array = tuple_field(tuple, key_def->multikey_fieldno);
+	if (array != NULL &&
+	    tuple_go_to_path(&array, key_def->multikey_path,
+			     key_def->multikey_path_len, MULTIKEY_NONE) != 0) {
+		/* The path has been validated in key_def_decode_parts. */
+		unreachable();
+	}
+	if (array == NULL || mp_typeof(*array) != MP_ARRAY)
+		return 0;
+	return mp_decode_array(&array);
+}
+
 const char *
 tuple_field_raw_by_full_path(struct tuple_format *format, const char *tuple,
 			     const uint32_t *field_map, const char *path,
@@ -527,7 +795,9 @@ tuple_field_raw_by_full_path(struct tuple_format *format, const char *tuple,
 		break;
 	}
 	default:
-		assert(token.type == JSON_TOKEN_END);
+		/* A multikey path doesn't refer to a single field. */
+		assert(token.type == JSON_TOKEN_END ||
+		       token.type == JSON_TOKEN_ANY);
 		return NULL;
 	}
 	return tuple_field_raw_by_path(format, tuple, field_map, fieldno,
@@ -589,11 +859,16 @@ box_tuple_bsize(const box_tuple_t *tuple)
 ssize_t
 tuple_to_buf(const struct tuple *tuple, char *buf, size_t size)
 {
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
 	uint32_t bsize;
-	const char *data = tuple_data_range(tuple, &bsize);
+	const char *data = tuple_data_range_decompressed(tuple, &bsize);
+	if (data == NULL)
+		return -1;
 	if (likely(bsize <= size)) {
 		memcpy(buf, data, bsize);
 	}
+	region_truncate(region, region_svp);
 	return bsize;
 }
 
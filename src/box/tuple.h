@@ -34,6 +34,7 @@
 #include "say.h"
 #include "diag.h"
 #include "error.h"
+#include "mp_scan.h"
 #include "uuid/tt_uuid.h" /* tuple_field_uuid */
 #include "tuple_format.h"
 
@@ -59,17 +60,92 @@ tuple_init(field_name_hash_f hash);
 void
 tuple_free(void);
 
+/** Pages backing a tuple arena, see box.cfg.memtx_huge_pages. */
+enum tuple_arena_pages {
+	/** Regular pages. */
+	TUPLE_ARENA_PAGES_OFF,
+	/** Transparent huge pages, see madvise(MADV_HUGEPAGE). */
+	TUPLE_ARENA_PAGES_TRANSPARENT,
+	/** Explicitly reserved 2 MB huge pages, see MAP_HUGETLB. */
+	TUPLE_ARENA_PAGES_2M,
+	/** Explicitly reserved 1 GB huge pages. */
+	TUPLE_ARENA_PAGES_1G,
+	tuple_arena_pages_MAX,
+};
+
+extern const char *tuple_arena_pages_strs[];
+
+/** NUMA memory policy of a tuple arena, see set_mempolicy(2). */
+enum tuple_arena_numa_policy {
+	/** Allocate memory on the node the CPU touching it is on. */
+	TUPLE_ARENA_NUMA_DEFAULT,
+	/** Allocate memory only on the given nodes. */
+	TUPLE_ARENA_NUMA_BIND,
+	/** Spread memory over the given nodes page by page. */
+	TUPLE_ARENA_NUMA_INTERLEAVE,
+	tuple_arena_numa_policy_MAX,
+};
+
+extern const char *tuple_arena_numa_policy_strs[];
+
+enum {
+	/** Max number of NUMA nodes a tuple arena can use. */
+	TUPLE_ARENA_NUMA_NODE_MAX = 64,
+};
+
+/** Memory placement options of a tuple arena. */
+struct tuple_arena_opts {
+	/** Type of pages backing the arena. */
+	enum tuple_arena_pages pages;
+	/** NUMA memory policy. */
+	enum tuple_arena_numa_policy numa_policy;
+	/**
+	 * Bit mask of NUMA nodes the policy applies to,
+	 * 0 means all online nodes.
+	 */
+	uint64_t numa_nodes;
+};
+
+/**
+ * Parse a list of NUMA nodes, like "0-2,5", into a bit mask.
+ * Returns -1 if the list is malformed or a node id is equal to
+ * or greater than TUPLE_ARENA_NUMA_NODE_MAX.
+ */
+int
+tuple_arena_parse_numa_nodes(const char *str, uint64_t *nodes);
+
 /**
  * Initialize tuples arena.
  * @param arena[out] Arena to initialize.
  * @param quota Arena's quota.
  * @param arena_max_size Maximal size of @arena.
+ * @param opts[in][out] Memory placement options, may be NULL.
+ *        If huge pages or NUMA policy can't be used, a warning
+ *        is logged, and the options are updated to reflect
+ *        what was actually applied.
  * @param arena_name Name of @arena for logs.
  */
 void
 tuple_arena_create(struct slab_arena *arena, struct quota *quota,
 		   uint64_t arena_max_size, uint32_t slab_size,
-		   const char *arena_name);
+		   struct tuple_arena_opts *opts, const char *arena_name);
+
+/** Page usage of a tuple arena. */
+struct tuple_arena_page_stat {
+	/** Size of pages backing the arena. */
+	size_t page_size;
+	/** Number of huge pages currently backing the arena. */
+	size_t huge_pages;
+};
+
+/**
+ * Get page usage of a tuple arena created with the given
+ * options. Huge pages are counted by /proc/self/smaps.
+ */
+void
+tuple_arena_page_stat(struct slab_arena *arena,
+		      const struct tuple_arena_opts *opts,
+		      struct tuple_arena_page_stat *stat);
 
 void
 tuple_arena_destroy(struct slab_arena *arena);
@@ -508,11 +584,15 @@ tuple_field_count(const struct tuple *tuple)
  *                      with NULL.
  * @param path The path to process.
  * @param path_len The length of the @path.
+ * @param multikey_idx The array index to substitute for the
+ *                     placeholder [*] in @path, MULTIKEY_NONE
+ *                     if the path has no placeholder.
  * @retval 0 On success.
  * @retval -1 In case of error in JSON path.
  */
 int
-tuple_go_to_path(const char **data, const char *path, uint32_t path_len);
+tuple_go_to_path(const char **data, const char *path, uint32_t path_len,
+		 int multikey_idx);
 
 /**
  * Get tuple field by field index and relative JSON path.
@@ -563,17 +643,32 @@ offset_slot_access:
 			return NULL;
 		tuple += field_map[offset_slot];
 	} else {
-		uint32_t field_count;
+		uint32_t field_count, anchor;
+		const char *data;
 parse:
 		ERROR_INJECT(ERRINJ_TUPLE_FIELD, return NULL);
+		data = tuple;
 		field_count = mp_decode_array(&tuple);
 		if (unlikely(fieldno >= field_count))
 			return NULL;
-		for (uint32_t k = 0; k < fieldno; k++)
-			mp_next(&tuple);
+		/*
+		 * Skip fields starting from the closest anchor,
+		 * see tuple_format::offset_step.
+		 */
+		anchor = format->offset_step == 0 ? 0 :
+			 MIN(fieldno / format->offset_step,
+			     (uint32_t)TUPLE_OFFSET_ANCHOR_MAX);
+		if (anchor > 0) {
+			int32_t slot = -(int32_t)(format->field_map_size /
+						  sizeof(uint32_t)) -
+				       (int32_t)anchor;
+			tuple = data + field_map[slot];
+			fieldno -= anchor * format->offset_step;
+		}
+		mp_scan_skip(&tuple, fieldno);
 		if (path != NULL &&
-		    unlikely(tuple_go_to_path(&tuple, path,
-						    path_len) != 0))
+		    unlikely(tuple_go_to_path(&tuple, path, path_len,
+					      MULTIKEY_NONE) != 0))
 			return NULL;
 	}
 	return tuple;
@@ -659,6 +754,45 @@ tuple_field_raw_by_part(struct tuple_format *format, const char *data,
 				       &part->offset_slot_cache);
 }
 
+/**
+ * Get a tuple field pointed to by a multikey index part.
+ * The placeholder [*] in the part path is resolved to the
+ * element @a multikey_idx of the multikey array. Fields in
+ * multikey arrays have no offset slots, so the path is
+ * always decoded starting from the top-level field.
+ * @param format Tuple format.
+ * @param data A pointer to MessagePack array.
+ * @param field_map A pointer to the LAST element of field map.
+ * @param part Index part to use.
+ * @param multikey_idx Position in the multikey array.
+ * @retval Field data if the field exists or NULL.
+ */
+static inline const char *
+tuple_field_raw_by_part_multikey(struct tuple_format *format,
+				 const char *data, const uint32_t *field_map,
+				 struct key_part *part, int multikey_idx)
+{
+	if (part->path == NULL)
+		return tuple_field_raw(format, data, field_map, part->fieldno);
+	const char *field = tuple_field_raw(format, data, field_map,
+					    part->fieldno);
+	if (field == NULL ||
+	    unlikely(tuple_go_to_path(&field, part->path, part->path_len,
+				      multikey_idx) != 0))
+		return NULL;
+	return field;
+}
+
+/**
+ * Get the number of keys a tuple has in a multikey index,
+ * i.e. the number of elements in its multikey array.
+ * @param tuple Tuple to inspect.
+ * @param key_def Multikey key definition.
+ * @retval Size of the multikey array, 0 if it is absent.
+ */
+uint32_t
+tuple_multikey_count(const struct tuple *tuple, struct key_def *key_def);
+
 /**
  * Get a field refereed by index @part in tuple.
  * @param tuple Tuple to get the field from.
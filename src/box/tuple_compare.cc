@@ -33,6 +33,7 @@
 #include "coll/coll.h"
 #include "trivia/util.h" /* NOINLINE */
 #include <math.h>
+#include <limits.h>
 
 /* {{{ tuple_compare */
 
@@ -364,7 +365,7 @@ mp_compare_scalar_coll(const char *field_a, const char *field_b,
  * @retval <0 if field_a < field_b
  * @retval >0 if field_a > field_b
  */
-static int
+static inline int
 tuple_compare_field(const char *field_a, const char *field_b,
 		    int8_t type, struct coll *coll)
 {
@@ -394,7 +395,7 @@ tuple_compare_field(const char *field_a, const char *field_b,
 	}
 }
 
-static int
+static inline int
 tuple_compare_field_with_hint(const char *field_a, enum mp_type a_type,
 			      const char *field_b, enum mp_type b_type,
 			      int8_t type, struct coll *coll)
@@ -425,12 +426,36 @@ tuple_compare_field_with_hint(const char *field_a, enum mp_type a_type,
 	}
 }
 
-template<bool is_nullable, bool has_optional_parts, bool has_json_paths>
+/**
+ * Get a tuple field pointed to by a key part. In case of
+ * a multikey index, the field is looked up in the element
+ * @a multikey_idx of the multikey array.
+ */
+template<bool has_json_paths, bool is_multikey>
+static inline const char *
+tuple_field_raw_by_part_tpl(struct tuple_format *format, const char *data,
+			    const uint32_t *field_map, struct key_part *part,
+			    int multikey_idx)
+{
+	if (is_multikey) {
+		return tuple_field_raw_by_part_multikey(format, data,
+							field_map, part,
+							multikey_idx);
+	}
+	if (has_json_paths)
+		return tuple_field_raw_by_part(format, data, field_map, part);
+	return tuple_field_raw(format, data, field_map, part->fieldno);
+}
+
+template<bool is_nullable, bool has_optional_parts, bool has_json_paths,
+	 bool is_multikey>
 static inline int
-tuple_compare_slowpath(const struct tuple *tuple_a, const struct tuple *tuple_b,
-		       struct key_def *key_def)
+tuple_compare_slowpath_impl(const struct tuple *tuple_a, int multikey_idx_a,
+			    const struct tuple *tuple_b, int multikey_idx_b,
+			    struct key_def *key_def)
 {
 	assert(has_json_paths == key_def->has_json_paths);
+	assert(is_multikey == key_def->is_multikey);
 	assert(!has_optional_parts || is_nullable);
 	assert(is_nullable == key_def->is_nullable);
 	assert(has_optional_parts == key_def->has_optional_parts);
@@ -476,17 +501,14 @@ tuple_compare_slowpath(const struct tuple *tuple_a, const struct tuple *tuple_b,
 		end = part + key_def->part_count;
 
 	for (; part < end; part++) {
-		if (has_json_paths) {
-			field_a = tuple_field_raw_by_part(format_a, tuple_a_raw,
-							  field_map_a, part);
-			field_b = tuple_field_raw_by_part(format_b, tuple_b_raw,
-							  field_map_b, part);
-		} else {
-			field_a = tuple_field_raw(format_a, tuple_a_raw,
-						  field_map_a, part->fieldno);
-			field_b = tuple_field_raw(format_b, tuple_b_raw,
-						  field_map_b, part->fieldno);
-		}
+		field_a = tuple_field_raw_by_part_tpl<has_json_paths,
+						      is_multikey>(
+				format_a, tuple_a_raw, field_map_a, part,
+				multikey_idx_a);
+		field_b = tuple_field_raw_by_part_tpl<has_json_paths,
+						      is_multikey>(
+				format_b, tuple_b_raw, field_map_b, part,
+				multikey_idx_b);
 		assert(has_optional_parts ||
 		       (field_a != NULL && field_b != NULL));
 		if (! is_nullable) {
@@ -533,17 +555,14 @@ tuple_compare_slowpath(const struct tuple *tuple_a, const struct tuple *tuple_b,
 	 */
 	end = key_def->parts + key_def->part_count;
 	for (; part < end; ++part) {
-		if (has_json_paths) {
-			field_a = tuple_field_raw_by_part(format_a, tuple_a_raw,
-							  field_map_a, part);
-			field_b = tuple_field_raw_by_part(format_b, tuple_b_raw,
-							  field_map_b, part);
-		} else {
-			field_a = tuple_field_raw(format_a, tuple_a_raw,
-						  field_map_a, part->fieldno);
-			field_b = tuple_field_raw(format_b, tuple_b_raw,
-						  field_map_b, part->fieldno);
-		}
+		field_a = tuple_field_raw_by_part_tpl<has_json_paths,
+						      is_multikey>(
+				format_a, tuple_a_raw, field_map_a, part,
+				multikey_idx_a);
+		field_b = tuple_field_raw_by_part_tpl<has_json_paths,
+						      is_multikey>(
+				format_b, tuple_b_raw, field_map_b, part,
+				multikey_idx_b);
 		/*
 		 * Extended parts are primary, and they can not
 		 * be absent or be NULLs.
@@ -558,11 +577,39 @@ tuple_compare_slowpath(const struct tuple *tuple_a, const struct tuple *tuple_b,
 }
 
 template<bool is_nullable, bool has_optional_parts, bool has_json_paths>
+static int
+tuple_compare_slowpath(const struct tuple *tuple_a, const struct tuple *tuple_b,
+		       struct key_def *key_def)
+{
+	return tuple_compare_slowpath_impl<is_nullable, has_optional_parts,
+					   has_json_paths, false>
+			(tuple_a, MULTIKEY_NONE, tuple_b, MULTIKEY_NONE,
+			 key_def);
+}
+
+template<bool is_nullable, bool has_optional_parts>
+static int
+tuple_compare_multikey_slowpath(const struct tuple *tuple_a,
+				int multikey_idx_a,
+				const struct tuple *tuple_b,
+				int multikey_idx_b, struct key_def *key_def)
+{
+	return tuple_compare_slowpath_impl<is_nullable, has_optional_parts,
+					   true, true>
+			(tuple_a, multikey_idx_a, tuple_b, multikey_idx_b,
+			 key_def);
+}
+
+template<bool is_nullable, bool has_optional_parts, bool has_json_paths,
+	 bool is_multikey>
 static inline int
-tuple_compare_with_key_slowpath(const struct tuple *tuple, const char *key,
-				uint32_t part_count, struct key_def *key_def)
+tuple_compare_with_key_slowpath_impl(const struct tuple *tuple,
+				     int multikey_idx, const char *key,
+				     uint32_t part_count,
+				     struct key_def *key_def)
 {
 	assert(has_json_paths == key_def->has_json_paths);
+	assert(is_multikey == key_def->is_multikey);
 	assert(!has_optional_parts || is_nullable);
 	assert(is_nullable == key_def->is_nullable);
 	assert(has_optional_parts == key_def->has_optional_parts);
@@ -575,13 +622,10 @@ tuple_compare_with_key_slowpath(const struct tuple *tuple, const char *key,
 	enum mp_type a_type, b_type;
 	if (likely(part_count == 1)) {
 		const char *field;
-		if (has_json_paths) {
-			field = tuple_field_raw_by_part(format, tuple_raw,
-							field_map, part);
-		} else {
-			field = tuple_field_raw(format, tuple_raw, field_map,
-						part->fieldno);
-		}
+		field = tuple_field_raw_by_part_tpl<has_json_paths,
+						    is_multikey>(
+				format, tuple_raw, field_map, part,
+				multikey_idx);
 		if (! is_nullable) {
 			return tuple_compare_field(field, key, part->type,
 						   part->coll);
@@ -606,13 +650,10 @@ tuple_compare_with_key_slowpath(const struct tuple *tuple, const char *key,
 	int rc;
 	for (; part < end; ++part, mp_next(&key)) {
 		const char *field;
-		if (has_json_paths) {
-			field = tuple_field_raw_by_part(format, tuple_raw,
-							field_map, part);
-		} else {
-			field = tuple_field_raw(format, tuple_raw, field_map,
-						part->fieldno);
-		}
+		field = tuple_field_raw_by_part_tpl<has_json_paths,
+						    is_multikey>(
+				format, tuple_raw, field_map, part,
+				multikey_idx);
 		if (! is_nullable) {
 			rc = tuple_compare_field(field, key, part->type,
 						 part->coll);
@@ -642,6 +683,30 @@ tuple_compare_with_key_slowpath(const struct tuple *tuple, const char *key,
 	return 0;
 }
 
+template<bool is_nullable, bool has_optional_parts, bool has_json_paths>
+static int
+tuple_compare_with_key_slowpath(const struct tuple *tuple, const char *key,
+				uint32_t part_count, struct key_def *key_def)
+{
+	return tuple_compare_with_key_slowpath_impl<is_nullable,
+						    has_optional_parts,
+						    has_json_paths, false>
+			(tuple, MULTIKEY_NONE, key, part_count, key_def);
+}
+
+template<bool is_nullable, bool has_optional_parts>
+static int
+tuple_compare_with_key_multikey_slowpath(const struct tuple *tuple,
+					 int multikey_idx, const char *key,
+					 uint32_t part_count,
+					 struct key_def *key_def)
+{
+	return tuple_compare_with_key_slowpath_impl<is_nullable,
+						    has_optional_parts,
+						    true, true>
+			(tuple, multikey_idx, key, part_count, key_def);
+}
+
 template<bool is_nullable>
 static inline int
 key_compare_parts(const char *key_a, const char *key_b, uint32_t part_count,
@@ -757,6 +822,113 @@ key_compare(const char *key_a, const char *key_b, struct key_def *key_def)
 	}
 }
 
+/**
+ * Compare primary key parts of two tuples stored in a
+ * functional index, i.e. parts of @a key_def following the
+ * functional key parts.
+ */
+static inline int
+func_index_compare_pk_parts(const struct tuple *tuple_a,
+			    const struct tuple *tuple_b,
+			    struct key_def *key_def)
+{
+	struct tuple_format *format_a = tuple_format(tuple_a);
+	struct tuple_format *format_b = tuple_format(tuple_b);
+	const char *tuple_a_raw = tuple_data(tuple_a);
+	const char *tuple_b_raw = tuple_data(tuple_b);
+	const uint32_t *field_map_a = tuple_field_map(tuple_a);
+	const uint32_t *field_map_b = tuple_field_map(tuple_b);
+	struct key_part *part = key_def->parts + key_def->func_index_part_count;
+	struct key_part *end = key_def->parts + key_def->part_count;
+	for (; part < end; part++) {
+		const char *field_a = tuple_field_raw_by_part(format_a,
+					tuple_a_raw, field_map_a, part);
+		const char *field_b = tuple_field_raw_by_part(format_b,
+					tuple_b_raw, field_map_b, part);
+		assert(field_a != NULL && field_b != NULL);
+		int rc = tuple_compare_field(field_a, field_b, part->type,
+					     part->coll);
+		if (rc != 0)
+			return rc;
+	}
+	return 0;
+}
+
+/**
+ * Check if a functional key has NULL in any of its first
+ * @a part_count parts.
+ */
+static inline bool
+func_key_has_null(const char *key, uint32_t part_count)
+{
+	for (uint32_t i = 0; i < part_count; i++, mp_next(&key)) {
+		if (mp_typeof(*key) == MP_NIL)
+			return true;
+	}
+	return false;
+}
+
+template<bool is_nullable>
+static int
+tuple_compare_func(const struct tuple *tuple_a, const char *func_key_a,
+		   const struct tuple *tuple_b, const char *func_key_b,
+		   struct key_def *key_def)
+{
+	assert(key_def->for_func_index);
+	assert(is_nullable == key_def->is_nullable);
+	uint32_t key_part_count = key_def->func_index_part_count;
+	mp_decode_array(&func_key_a);
+	mp_decode_array(&func_key_b);
+	int rc = key_compare_parts<is_nullable>(func_key_a, func_key_b,
+						key_part_count, key_def);
+	if (rc != 0 || key_def->part_count == key_part_count)
+		return rc;
+	/*
+	 * Tuples with equal keys are duplicates in a unique
+	 * index unless the keys contain NULL, see
+	 * tuple_compare_slowpath().
+	 */
+	if (key_def->unique_part_count == key_part_count &&
+	    (!is_nullable || !func_key_has_null(func_key_a, key_part_count)))
+		return 0;
+	return func_index_compare_pk_parts(tuple_a, tuple_b, key_def);
+}
+
+template<bool is_nullable>
+static int
+tuple_compare_with_key_func(const struct tuple *tuple, const char *func_key,
+			    const char *key, uint32_t part_count,
+			    struct key_def *key_def)
+{
+	assert(key_def->for_func_index);
+	assert(is_nullable == key_def->is_nullable);
+	assert(part_count <= key_def->part_count);
+	uint32_t key_part_count = key_def->func_index_part_count;
+	mp_decode_array(&func_key);
+	uint32_t cmp_part_count = MIN(part_count, key_part_count);
+	int rc = key_compare_parts<is_nullable>(func_key, key, cmp_part_count,
+						key_def);
+	if (rc != 0 || part_count <= key_part_count)
+		return rc;
+	/* The search key contains primary key parts too. */
+	for (uint32_t i = 0; i < key_part_count; i++)
+		mp_next(&key);
+	struct tuple_format *format = tuple_format(tuple);
+	const char *tuple_raw = tuple_data(tuple);
+	const uint32_t *field_map = tuple_field_map(tuple);
+	struct key_part *part = key_def->parts + key_part_count;
+	struct key_part *end = key_def->parts + part_count;
+	for (; part < end; part++, mp_next(&key)) {
+		const char *field = tuple_field_raw_by_part(format, tuple_raw,
+							    field_map, part);
+		assert(field != NULL);
+		rc = tuple_compare_field(field, key, part->type, part->coll);
+		if (rc != 0)
+			return rc;
+	}
+	return 0;
+}
+
 template <bool is_nullable, bool has_optional_parts>
 static int
 tuple_compare_sequential(const struct tuple *tuple_a,
@@ -976,6 +1148,285 @@ struct TupleCompare<0, TYPE, MORE_TYPES...> {
 };
 } /* end of anonymous namespace */
 
+/* {{{ Comparators composed of part types */
+
+/**
+ * Max number of leading key parts whose types are compiled
+ * into a comparator. The rest of the parts are compared with
+ * a switch by type: they are reached only if the leading
+ * parts are equal.
+ */
+enum { TYPED_PART_COUNT_MAX = 2 };
+
+/** Part type is not known at compile time. */
+enum { FIELD_TYPE_RUNTIME = field_type_MAX };
+
+/**
+ * Compare a key part of two tuples. If TYPE isn't
+ * FIELD_TYPE_RUNTIME, it is the part type and the comparison
+ * of the part is inlined into the caller.
+ */
+template <bool is_nullable, int TYPE>
+static inline int
+tuple_compare_part(const struct tuple *tuple_a, const struct tuple *tuple_b,
+		   struct key_part *part, bool *was_null_met)
+{
+	assert(TYPE == FIELD_TYPE_RUNTIME || TYPE == part->type);
+	int8_t type = TYPE != FIELD_TYPE_RUNTIME ? TYPE : part->type;
+	const char *field_a = tuple_field(tuple_a, part->fieldno);
+	const char *field_b = tuple_field(tuple_b, part->fieldno);
+	if (!is_nullable) {
+		assert(field_a != NULL && field_b != NULL);
+		return tuple_compare_field(field_a, field_b, type, part->coll);
+	}
+	/* An absent optional field is treated as NULL. */
+	enum mp_type a_type = field_a != NULL ? mp_typeof(*field_a) : MP_NIL;
+	enum mp_type b_type = field_b != NULL ? mp_typeof(*field_b) : MP_NIL;
+	if (a_type == MP_NIL) {
+		if (b_type != MP_NIL)
+			return -1;
+		*was_null_met = true;
+		return 0;
+	}
+	if (b_type == MP_NIL)
+		return 1;
+	return tuple_compare_field_with_hint(field_a, a_type, field_b, b_type,
+					     type, part->coll);
+}
+
+template <bool is_nullable, int ...TYPES>
+struct TypedPartsCompare {
+	static int
+	compare(const struct tuple *, const struct tuple *,
+		struct key_part *, bool *)
+	{
+		return 0;
+	}
+};
+
+template <bool is_nullable, int TYPE, int ...MORE_TYPES>
+struct TypedPartsCompare<is_nullable, TYPE, MORE_TYPES...> {
+	static inline int
+	compare(const struct tuple *tuple_a, const struct tuple *tuple_b,
+		struct key_part *part, bool *was_null_met)
+	{
+		int rc = tuple_compare_part<is_nullable, TYPE>(tuple_a, tuple_b,
+							      part,
+							      was_null_met);
+		if (rc != 0)
+			return rc;
+		return TypedPartsCompare<is_nullable, MORE_TYPES...>::
+			compare(tuple_a, tuple_b, part + 1, was_null_met);
+	}
+};
+
+/**
+ * tuple_compare() for a key def whose leading parts have
+ * types TYPES. Semantics are the same as of
+ * tuple_compare_slowpath().
+ */
+template <bool is_nullable, int ...TYPES>
+static int
+tuple_compare_typed(const struct tuple *tuple_a, const struct tuple *tuple_b,
+		    struct key_def *key_def)
+{
+	assert(is_nullable == key_def->is_nullable);
+	assert(!key_def->has_json_paths);
+	bool was_null_met = false;
+	struct key_part *part = key_def->parts;
+	int rc = TypedPartsCompare<is_nullable, TYPES...>::
+		compare(tuple_a, tuple_b, part, &was_null_met);
+	if (rc != 0)
+		return rc;
+	part += sizeof...(TYPES);
+	struct key_part *end = key_def->parts + (is_nullable ?
+						 key_def->unique_part_count :
+						 key_def->part_count);
+	for (; part < end; part++) {
+		rc = tuple_compare_part<is_nullable, FIELD_TYPE_RUNTIME>(
+				tuple_a, tuple_b, part, &was_null_met);
+		if (rc != 0)
+			return rc;
+	}
+	if (!is_nullable || !was_null_met)
+		return 0;
+	/* Keys contain NULLs, compare the extended parts. */
+	end = key_def->parts + key_def->part_count;
+	for (; part < end; part++) {
+		rc = tuple_compare_part<false, FIELD_TYPE_RUNTIME>(
+				tuple_a, tuple_b, part, NULL);
+		if (rc != 0)
+			return rc;
+	}
+	return 0;
+}
+
+/** @copydoc tuple_compare_part() */
+template <bool is_nullable, int TYPE>
+static inline int
+tuple_compare_with_key_part(const struct tuple *tuple, const char *key,
+			    struct key_part *part)
+{
+	assert(TYPE == FIELD_TYPE_RUNTIME || TYPE == part->type);
+	int8_t type = TYPE != FIELD_TYPE_RUNTIME ? TYPE : part->type;
+	const char *field = tuple_field(tuple, part->fieldno);
+	if (!is_nullable) {
+		assert(field != NULL);
+		return tuple_compare_field(field, key, type, part->coll);
+	}
+	enum mp_type a_type = field != NULL ? mp_typeof(*field) : MP_NIL;
+	enum mp_type b_type = mp_typeof(*key);
+	if (a_type == MP_NIL)
+		return b_type == MP_NIL ? 0 : -1;
+	if (b_type == MP_NIL)
+		return 1;
+	return tuple_compare_field_with_hint(field, a_type, key, b_type,
+					     type, part->coll);
+}
+
+template <bool is_nullable, int ...TYPES>
+struct TypedPartsCompareWithKey {
+	/* Compare the parts following the typed ones. */
+	static int
+	compare(const struct tuple *tuple, const char *key,
+		uint32_t part_count, struct key_part *part)
+	{
+		for (; part_count > 0; part_count--, part++, mp_next(&key)) {
+			int rc = tuple_compare_with_key_part<
+					is_nullable, FIELD_TYPE_RUNTIME>(
+					tuple, key, part);
+			if (rc != 0)
+				return rc;
+		}
+		return 0;
+	}
+};
+
+template <bool is_nullable, int TYPE, int ...MORE_TYPES>
+struct TypedPartsCompareWithKey<is_nullable, TYPE, MORE_TYPES...> {
+	static inline int
+	compare(const struct tuple *tuple, const char *key,
+		uint32_t part_count, struct key_part *part)
+	{
+		if (part_count == 0)
+			return 0;
+		int rc = tuple_compare_with_key_part<is_nullable, TYPE>(
+				tuple, key, part);
+		if (rc != 0 || part_count == 1)
+			return rc;
+		mp_next(&key);
+		return TypedPartsCompareWithKey<is_nullable, MORE_TYPES...>::
+			compare(tuple, key, part_count - 1, part + 1);
+	}
+};
+
+/**
+ * tuple_compare_with_key() for a key def whose leading parts
+ * have types TYPES.
+ */
+template <bool is_nullable, int ...TYPES>
+static int
+tuple_compare_with_key_typed(const struct tuple *tuple, const char *key,
+			     uint32_t part_count, struct key_def *key_def)
+{
+	assert(is_nullable == key_def->is_nullable);
+	assert(!key_def->has_json_paths);
+	assert(key != NULL || part_count == 0);
+	assert(part_count <= key_def->part_count);
+	return TypedPartsCompareWithKey<is_nullable, TYPES...>::
+		compare(tuple, key, part_count, key_def->parts);
+}
+
+struct typed_comparators {
+	tuple_compare_t compare;
+	tuple_compare_with_key_t compare_with_key;
+};
+
+/**
+ * Instantiate typed comparators for the types of the first
+ * @a count parts of a key def, picking the template argument
+ * for one part at a time.
+ */
+template <bool is_nullable, int COUNT, int ...TYPES>
+struct TypedComparatorsSelector {
+	static struct typed_comparators
+	select(const struct key_def *def, uint32_t count)
+	{
+		if (count == COUNT) {
+			return {
+				tuple_compare_typed<is_nullable, TYPES...>,
+				tuple_compare_with_key_typed<is_nullable,
+							     TYPES...>,
+			};
+		}
+		switch (def->parts[COUNT].type) {
+#define SELECT(type) \
+		case type: \
+			return TypedComparatorsSelector<is_nullable, \
+							COUNT + 1, \
+							TYPES..., type>:: \
+				select(def, count);
+		SELECT(FIELD_TYPE_UNSIGNED)
+		SELECT(FIELD_TYPE_STRING)
+		SELECT(FIELD_TYPE_NUMBER)
+		SELECT(FIELD_TYPE_INTEGER)
+		SELECT(FIELD_TYPE_BOOLEAN)
+		SELECT(FIELD_TYPE_SCALAR)
+#undef SELECT
+		default:
+			unreachable();
+			return {NULL, NULL};
+		}
+	}
+};
+
+template <bool is_nullable, int ...TYPES>
+struct TypedComparatorsSelector<is_nullable, TYPED_PART_COUNT_MAX, TYPES...> {
+	static struct typed_comparators
+	select(const struct key_def *def, uint32_t count)
+	{
+		(void)def;
+		assert(count == TYPED_PART_COUNT_MAX);
+		(void)count;
+		return {
+			tuple_compare_typed<is_nullable, TYPES...>,
+			tuple_compare_with_key_typed<is_nullable, TYPES...>,
+		};
+	}
+};
+
+/**
+ * Return typed comparators for @a count leading parts of
+ * @a def or {NULL, NULL} if some of them have a type that
+ * has no order or the key def needs special field lookups.
+ */
+static struct typed_comparators
+typed_comparators_create(const struct key_def *def, uint32_t count)
+{
+	count = MIN(count, (uint32_t)TYPED_PART_COUNT_MAX);
+	if (count == 0 || def->has_json_paths || def->is_multikey ||
+	    def->for_func_index)
+		return {NULL, NULL};
+	for (uint32_t i = 0; i < count; i++) {
+		switch (def->parts[i].type) {
+		case FIELD_TYPE_UNSIGNED:
+		case FIELD_TYPE_STRING:
+		case FIELD_TYPE_NUMBER:
+		case FIELD_TYPE_INTEGER:
+		case FIELD_TYPE_BOOLEAN:
+		case FIELD_TYPE_SCALAR:
+			break;
+		default:
+			return {NULL, NULL};
+		}
+	}
+	if (def->is_nullable)
+		return TypedComparatorsSelector<true, 0>::select(def, count);
+	return TypedComparatorsSelector<false, 0>::select(def, count);
+}
+
+/* }}} Comparators composed of part types */
+
 struct comparator_signature {
 	tuple_compare_t f;
 	uint32_t p[64];
@@ -1016,13 +1467,38 @@ static const tuple_compare_t compare_slowpath_funcs[] = {
 	tuple_compare_slowpath<true, true, true>
 };
 
+static const tuple_compare_multikey_t compare_multikey_slowpath_funcs[] = {
+	tuple_compare_multikey_slowpath<false, false>,
+	tuple_compare_multikey_slowpath<true, false>,
+	tuple_compare_multikey_slowpath<false, true>,
+	tuple_compare_multikey_slowpath<true, true>
+};
+
+static tuple_compare_multikey_t
+tuple_compare_multikey_create(const struct key_def *def)
+{
+	int cmp_func_idx = (def->is_nullable ? 1 : 0) +
+			   2 * (def->has_optional_parts ? 1 : 0);
+	return compare_multikey_slowpath_funcs[cmp_func_idx];
+}
+
 static tuple_compare_t
 tuple_compare_create(const struct key_def *def)
 {
 	int cmp_func_idx = (def->is_nullable ? 1 : 0) +
 			   2 * (def->has_optional_parts ? 1 : 0) +
 			   4 * (def->has_json_paths ? 1 : 0);
+	/*
+	 * Parts past unique_part_count of a nullable key are
+	 * compared only if the key has NULLs, so they can't be
+	 * typed.
+	 */
+	tuple_compare_t typed = typed_comparators_create(def,
+			def->is_nullable ? def->unique_part_count :
+			def->part_count).compare;
 	if (def->is_nullable) {
+		if (typed != NULL)
+			return typed;
 		if (key_def_is_sequential(def)) {
 			if (def->has_optional_parts)
 				return tuple_compare_sequential<true, true>;
@@ -1049,6 +1525,8 @@ tuple_compare_create(const struct key_def *def)
 				return cmp_arr[k].f;
 		}
 	}
+	if (typed != NULL)
+		return typed;
 	return key_def_is_sequential(def) ?
 	       tuple_compare_sequential<false, false> :
 	       compare_slowpath_funcs[cmp_func_idx];
@@ -1244,13 +1722,33 @@ static const tuple_compare_with_key_t compare_with_key_slowpath_funcs[] = {
 	tuple_compare_with_key_slowpath<true, true, true>
 };
 
+static const tuple_compare_with_key_multikey_t
+compare_with_key_multikey_slowpath_funcs[] = {
+	tuple_compare_with_key_multikey_slowpath<false, false>,
+	tuple_compare_with_key_multikey_slowpath<true, false>,
+	tuple_compare_with_key_multikey_slowpath<false, true>,
+	tuple_compare_with_key_multikey_slowpath<true, true>
+};
+
+static tuple_compare_with_key_multikey_t
+tuple_compare_with_key_multikey_create(const struct key_def *def)
+{
+	int cmp_func_idx = (def->is_nullable ? 1 : 0) +
+			   2 * (def->has_optional_parts ? 1 : 0);
+	return compare_with_key_multikey_slowpath_funcs[cmp_func_idx];
+}
+
 static tuple_compare_with_key_t
 tuple_compare_with_key_create(const struct key_def *def)
 {
 	int cmp_func_idx = (def->is_nullable ? 1 : 0) +
 			   2 * (def->has_optional_parts ? 1 : 0) +
 			   4 * (def->has_json_paths ? 1 : 0);
+	tuple_compare_with_key_t typed = typed_comparators_create(def,
+			def->part_count).compare_with_key;
 	if (def->is_nullable) {
+		if (typed != NULL)
+			return typed;
 		if (key_def_is_sequential(def)) {
 			if (def->has_optional_parts) {
 				return tuple_compare_with_key_sequential<true,
@@ -1283,6 +1781,8 @@ tuple_compare_with_key_create(const struct key_def *def)
 				return cmp_wk_arr[k].f;
 		}
 	}
+	if (typed != NULL)
+		return typed;
 	return key_def_is_sequential(def) ?
 	       tuple_compare_with_key_sequential<false, false> :
 	       compare_with_key_slowpath_funcs[cmp_func_idx];
@@ -1290,9 +1790,426 @@ tuple_compare_with_key_create(const struct key_def *def)
 
 /* }}} tuple_compare_with_key */
 
+/* {{{ tuple_hint */
+
+/**
+ * A comparison hint is an unsigned integer number that has
+ * the following layout:
+ *
+ *     [         class         |         value         ]
+ *      <-- HINT_CLASS_BITS --> <-- HINT_VALUE_BITS -->
+ *      <----------------- HINT_BITS ----------------->
+ *
+ * For simplicity we construct it using the first key part only.
+ * The class is the MsgPack class of the field (see enum mp_class)
+ * so that fields of different classes compare the same way as
+ * they do in a scalar index. The value is an order preserving
+ * function of the field value truncated to HINT_VALUE_BITS:
+ * integers and floating point numbers are mapped to the same
+ * integer scale, strings and binary blobs are represented with
+ * their leading bytes. Values that don't fit in the value bits
+ * saturate, hence equal hints don't mean equal fields.
+ *
+ * Since the layout doesn't depend on the field type, a hint
+ * stays valid if the type of the indexed field is changed to
+ * a compatible one (e.g. unsigned => integer => number =>
+ * scalar) without rebuilding the index. Hints of collated
+ * strings carry the class only, because collation order can't
+ * be deduced from the string bytes.
+ */
+/** Min/max integer that can be stored in a hint w/o overflow. */
+#define HINT_VALUE_INT_MAX	((1LL << (HINT_VALUE_BITS - 1)) - 1)
+#define HINT_VALUE_INT_MIN	(-(1LL << (HINT_VALUE_BITS - 1)))
+
+/**
+ * Min/max double that can be converted to a hint without
+ * overflow. Both bounds are powers of two so they are
+ * represented precisely.
+ */
+#define HINT_VALUE_DOUBLE_MAX	(-(double)HINT_VALUE_INT_MIN)
+#define HINT_VALUE_DOUBLE_MIN	((double)HINT_VALUE_INT_MIN)
+
+static_assert(MP_CLASS_MAP < (1 << HINT_CLASS_BITS),
+	      "all MsgPack classes must fit in a hint");
+
+static inline hint_t
+hint_create(enum mp_class c, uint64_t val)
+{
+	assert(val <= HINT_VALUE_MAX);
+	return ((hint_t)c << HINT_VALUE_BITS) | val;
+}
+
+static inline hint_t
+hint_nil(void)
+{
+	return hint_create(MP_CLASS_NIL, 0);
+}
+
+static inline hint_t
+hint_bool(bool b)
+{
+	return hint_create(MP_CLASS_BOOL, b ? 1 : 0);
+}
+
+static inline hint_t
+hint_uint(uint64_t u)
+{
+	uint64_t val = (u > (uint64_t)HINT_VALUE_INT_MAX ? HINT_VALUE_MAX :
+			u - (uint64_t)HINT_VALUE_INT_MIN);
+	return hint_create(MP_CLASS_NUMBER, val);
+}
+
+static inline hint_t
+hint_int(int64_t i)
+{
+	uint64_t val;
+	if (i > HINT_VALUE_INT_MAX)
+		val = HINT_VALUE_MAX;
+	else if (i < HINT_VALUE_INT_MIN)
+		val = 0;
+	else
+		val = (uint64_t)(i - HINT_VALUE_INT_MIN);
+	return hint_create(MP_CLASS_NUMBER, val);
+}
+
+static inline hint_t
+hint_double(double f)
+{
+	/*
+	 * NaN is less than any number, see mp_compare_number(),
+	 * so it shares the lowest hint with -inf and all values
+	 * below HINT_VALUE_DOUBLE_MIN. The value is rounded down
+	 * so that a double compares to an integer the same way
+	 * its hint compares to the integer's one.
+	 */
+	uint64_t val;
+	if (isnan(f) || f < HINT_VALUE_DOUBLE_MIN)
+		val = 0;
+	else if (f >= HINT_VALUE_DOUBLE_MAX)
+		val = HINT_VALUE_MAX;
+	else
+		val = (uint64_t)((int64_t)floor(f) - HINT_VALUE_INT_MIN);
+	return hint_create(MP_CLASS_NUMBER, val);
+}
+
+static inline uint64_t
+hint_str_raw(const char *s, uint32_t len)
+{
+	/*
+	 * Strings are compared with memcmp() so we take the
+	 * leading bytes in big-endian order and drop the bits
+	 * that don't fit in the hint. A shorter string is padded
+	 * with zeros, which is consistent with the comparator:
+	 * a prefix is less than or equal to the whole string.
+	 */
+	uint64_t val = 0;
+	uint32_t process_len = MIN(len, sizeof(val));
+	for (uint32_t i = 0; i < process_len; i++) {
+		val <<= CHAR_BIT;
+		val |= (unsigned char)s[i];
+	}
+	val <<= CHAR_BIT * (sizeof(val) - process_len);
+	return val >> HINT_CLASS_BITS;
+}
+
+static inline hint_t
+hint_str(const char *s, uint32_t len)
+{
+	return hint_create(MP_CLASS_STR, hint_str_raw(s, len));
+}
+
+static inline hint_t
+hint_str_coll(const char *s, uint32_t len, struct coll *coll)
+{
+	(void)s;
+	(void)len;
+	(void)coll;
+	/* Collation order is opaque, use the class only. */
+	return hint_create(MP_CLASS_STR, 0);
+}
+
+static inline hint_t
+hint_bin(const char *s, uint32_t len)
+{
+	return hint_create(MP_CLASS_BIN, hint_str_raw(s, len));
+}
+
+static inline hint_t
+field_hint_boolean(const char *field)
+{
+	assert(mp_typeof(*field) == MP_BOOL);
+	return hint_bool(mp_decode_bool(&field));
+}
+
+static inline hint_t
+field_hint_unsigned(const char *field)
+{
+	assert(mp_typeof(*field) == MP_UINT);
+	return hint_uint(mp_decode_uint(&field));
+}
+
+static inline hint_t
+field_hint_integer(const char *field)
+{
+	switch (mp_typeof(*field)) {
+	case MP_UINT:
+		return hint_uint(mp_decode_uint(&field));
+	case MP_INT:
+		return hint_int(mp_decode_int(&field));
+	default:
+		unreachable();
+	}
+	return HINT_NONE;
+}
+
+static inline hint_t
+field_hint_number(const char *field)
+{
+	switch (mp_typeof(*field)) {
+	case MP_FLOAT:
+		return hint_double(mp_decode_float(&field));
+	case MP_DOUBLE:
+		return hint_double(mp_decode_double(&field));
+	case MP_UINT:
+		return hint_uint(mp_decode_uint(&field));
+	case MP_INT:
+		return hint_int(mp_decode_int(&field));
+	default:
+		unreachable();
+	}
+	return HINT_NONE;
+}
+
+static inline hint_t
+field_hint_string(const char *field, struct coll *coll)
+{
+	assert(mp_typeof(*field) == MP_STR);
+	uint32_t len;
+	const char *s = mp_decode_str(&field, &len);
+	return coll == NULL ? hint_str(s, len) : hint_str_coll(s, len, coll);
+}
+
+static inline hint_t
+field_hint_scalar(const char *field, struct coll *coll)
+{
+	uint32_t len;
+	const char *s;
+	switch (mp_typeof(*field)) {
+	case MP_BOOL:
+		return hint_bool(mp_decode_bool(&field));
+	case MP_UINT:
+		return hint_uint(mp_decode_uint(&field));
+	case MP_INT:
+		return hint_int(mp_decode_int(&field));
+	case MP_FLOAT:
+		return hint_double(mp_decode_float(&field));
+	case MP_DOUBLE:
+		return hint_double(mp_decode_double(&field));
+	case MP_STR:
+		s = mp_decode_str(&field, &len);
+		return coll == NULL ? hint_str(s, len) :
+		       hint_str_coll(s, len, coll);
+	case MP_BIN:
+		s = mp_decode_bin(&field, &len);
+		return hint_bin(s, len);
+	default:
+		unreachable();
+	}
+	return HINT_NONE;
+}
+
+template <enum field_type type, bool is_nullable>
+static inline hint_t
+field_hint(const char *field, struct coll *coll)
+{
+	if (is_nullable && mp_typeof(*field) == MP_NIL)
+		return hint_nil();
+	switch (type) {
+	case FIELD_TYPE_BOOLEAN:
+		return field_hint_boolean(field);
+	case FIELD_TYPE_UNSIGNED:
+		return field_hint_unsigned(field);
+	case FIELD_TYPE_INTEGER:
+		return field_hint_integer(field);
+	case FIELD_TYPE_NUMBER:
+		return field_hint_number(field);
+	case FIELD_TYPE_STRING:
+		return field_hint_string(field, coll);
+	case FIELD_TYPE_SCALAR:
+		return field_hint_scalar(field, coll);
+	default:
+		unreachable();
+	}
+	return HINT_NONE;
+}
+
+/**
+ * Compute a hint for a field of any type. Unlike tuple fields,
+ * search keys may come from places that don't validate them
+ * against the field type strictly (e.g. SQL), so we don't rely
+ * on the key part type here. Since the hint layout doesn't
+ * depend on the field type, the result is the same.
+ */
+static hint_t
+field_hint_any(const char *field, struct coll *coll)
+{
+	switch (mp_typeof(*field)) {
+	case MP_NIL:
+		return hint_nil();
+	case MP_BOOL:
+	case MP_UINT:
+	case MP_INT:
+	case MP_FLOAT:
+	case MP_DOUBLE:
+	case MP_STR:
+	case MP_BIN:
+		return field_hint_scalar(field, coll);
+	default:
+		return HINT_NONE;
+	}
+}
+
+static hint_t
+key_hint_impl(const char *key, uint32_t part_count, struct key_def *key_def)
+{
+	if (part_count == 0)
+		return HINT_NONE;
+	return field_hint_any(key, key_def->parts->coll);
+}
+
+template <enum field_type type, bool is_nullable>
+static hint_t
+tuple_hint_impl(const struct tuple *tuple, struct key_def *key_def)
+{
+	struct key_part *part = key_def->parts;
+	const char *field = tuple_field_by_part(tuple, part);
+	/* An absent optional field is treated as NULL. */
+	if (is_nullable && field == NULL)
+		return hint_nil();
+	assert(field != NULL);
+	return field_hint<type, is_nullable>(field, part->coll);
+}
+
+static hint_t
+key_hint_default(const char *key, uint32_t part_count, struct key_def *key_def)
+{
+	(void)key;
+	(void)part_count;
+	(void)key_def;
+	return HINT_NONE;
+}
+
+static hint_t
+tuple_hint_default(const struct tuple *tuple, struct key_def *key_def)
+{
+	(void)tuple;
+	(void)key_def;
+	return HINT_NONE;
+}
+
+template <enum field_type type, bool is_nullable>
+static void
+key_def_set_hint_func(struct key_def *def)
+{
+	def->key_hint = key_hint_impl;
+	def->tuple_hint = tuple_hint_impl<type, is_nullable>;
+}
+
+template <enum field_type type>
+static void
+key_def_set_hint_func(struct key_def *def)
+{
+	if (key_part_is_nullable(def->parts))
+		key_def_set_hint_func<type, true>(def);
+	else
+		key_def_set_hint_func<type, false>(def);
+}
+
+/**
+ * Hints of an integer field are the field values shifted to the
+ * unsigned range unless they saturate, so they can be used for
+ * interpolation search. If the key consists of a single integer
+ * part, equal unsaturated hints mean equal keys.
+ */
+static void
+key_def_set_integer_hint_flags(struct key_def *def)
+{
+	def->has_ordinal_hints = true;
+	def->has_exact_hints = def->part_count == 1 &&
+			       !key_part_is_nullable(def->parts);
+}
+
+static void
+key_def_set_hint_func(struct key_def *def)
+{
+	def->key_hint = key_hint_default;
+	def->tuple_hint = tuple_hint_default;
+	def->has_ordinal_hints = false;
+	def->has_exact_hints = false;
+	/*
+	 * A tuple has many keys in a multikey index, hence
+	 * a single hint per tuple makes no sense. A functional
+	 * index stores a pointer to the key instead of a hint.
+	 */
+	if (def->part_count == 0 || def->is_multikey ||
+	    def->for_func_index)
+		return;
+	switch (def->parts->type) {
+	case FIELD_TYPE_BOOLEAN:
+		key_def_set_hint_func<FIELD_TYPE_BOOLEAN>(def);
+		break;
+	case FIELD_TYPE_UNSIGNED:
+		key_def_set_hint_func<FIELD_TYPE_UNSIGNED>(def);
+		key_def_set_integer_hint_flags(def);
+		break;
+	case FIELD_TYPE_INTEGER:
+		key_def_set_hint_func<FIELD_TYPE_INTEGER>(def);
+		key_def_set_integer_hint_flags(def);
+		break;
+	case FIELD_TYPE_NUMBER:
+		key_def_set_hint_func<FIELD_TYPE_NUMBER>(def);
+		break;
+	case FIELD_TYPE_STRING:
+		key_def_set_hint_func<FIELD_TYPE_STRING>(def);
+		break;
+	case FIELD_TYPE_SCALAR:
+		key_def_set_hint_func<FIELD_TYPE_SCALAR>(def);
+		break;
+	default:
+		/* Invalid key definition or type that has no order. */
+		break;
+	}
+}
+
+/* }}} tuple_hint */
+
 void
 key_def_set_compare_func(struct key_def *def)
 {
 	def->tuple_compare = tuple_compare_create(def);
 	def->tuple_compare_with_key = tuple_compare_with_key_create(def);
+	if (def->is_multikey) {
+		def->tuple_compare_multikey =
+			tuple_compare_multikey_create(def);
+		def->tuple_compare_with_key_multikey =
+			tuple_compare_with_key_multikey_create(def);
+	} else {
+		def->tuple_compare_multikey = NULL;
+		def->tuple_compare_with_key_multikey = NULL;
+	}
+	if (def->for_func_index) {
+		if (def->is_nullable) {
+			def->tuple_compare_func = tuple_compare_func<true>;
+			def->tuple_compare_with_key_func =
+				tuple_compare_with_key_func<true>;
+		} else {
+			def->tuple_compare_func = tuple_compare_func<false>;
+			def->tuple_compare_with_key_func =
+				tuple_compare_with_key_func<false>;
+		}
+	} else {
+		def->tuple_compare_func = NULL;
+		def->tuple_compare_with_key_func = NULL;
+	}
+	key_def_set_hint_func(def);
 }
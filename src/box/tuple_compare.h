@@ -37,7 +37,8 @@ extern "C" {
 struct key_def;
 
 /**
- * Initialize comparator functions for the key_def.
+ * Initialize comparator and comparison hint functions
+ * for the key_def.
  * @param key_def key definition
  */
 void
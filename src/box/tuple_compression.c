@@ -0,0 +1,360 @@
+/*
+ * Copyright 2010-2019, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include "tuple_compression.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <msgpuck.h>
+#include <small/region.h>
+#include <zstd.h>
+
+#include "diag.h"
+#include "errcode.h"
+#include "fiber.h"
+#include "tuple_format.h"
+
+/** Level used for compressing tuple fields, the same as in xlog. */
+enum { TUPLE_COMPRESSION_LEVEL = 3 };
+
+/** Compression context of the current thread. */
+static __thread ZSTD_CCtx *tuple_zctx;
+/** Decompression context of the current thread. */
+static __thread ZSTD_DCtx *tuple_zdctx;
+
+static ZSTD_CCtx *
+tuple_get_zctx(void)
+{
+	if (tuple_zctx == NULL) {
+		tuple_zctx = ZSTD_createCCtx();
+		if (tuple_zctx == NULL)
+			diag_set(OutOfMemory, sizeof(tuple_zctx), "malloc",
+				 "zstd context");
+	}
+	return tuple_zctx;
+}
+
+static ZSTD_DCtx *
+tuple_get_zdctx(void)
+{
+	if (tuple_zdctx == NULL) {
+		tuple_zdctx = ZSTD_createDCtx();
+		if (tuple_zdctx == NULL)
+			diag_set(OutOfMemory, sizeof(tuple_zdctx), "malloc",
+				 "zstd context");
+	}
+	return tuple_zdctx;
+}
+
+void
+tuple_compression_free(void)
+{
+	if (tuple_zctx != NULL)
+		ZSTD_freeCCtx(tuple_zctx);
+	if (tuple_zdctx != NULL)
+		ZSTD_freeDCtx(tuple_zdctx);
+	tuple_zctx = NULL;
+	tuple_zdctx = NULL;
+}
+
+/**
+ * Return true if field @a fieldno of format @a format may be
+ * compressed, i.e. it is not indexed and is not typed.
+ */
+static bool
+tuple_field_is_compressible(struct tuple_format *format, uint32_t fieldno)
+{
+	if (fieldno >= tuple_format_field_count(format))
+		return true;
+	struct tuple_field *field = tuple_format_field(format, fieldno);
+	return field->type == FIELD_TYPE_ANY && !field->is_key_part &&
+	       json_token_is_leaf(&field->token);
+}
+
+/**
+ * Return the extension type of the MsgPack extension value
+ * @a data points to.
+ */
+static int8_t
+mp_ext_type(const char *data)
+{
+	switch ((uint8_t)data[0]) {
+	case 0xd4: case 0xd5: case 0xd6: case 0xd7: case 0xd8:
+		/* fixext 1/2/4/8/16 */
+		return (int8_t)data[1];
+	case 0xc7:
+		/* ext 8 */
+		return (int8_t)data[2];
+	case 0xc8:
+		/* ext 16 */
+		return (int8_t)data[3];
+	case 0xc9:
+		/* ext 32 */
+		return (int8_t)data[5];
+	default:
+		unreachable();
+		return 0;
+	}
+}
+
+int
+mp_check_compression(const char *data, const char *data_end)
+{
+	/*
+	 * Values are scanned in the order they are encoded:
+	 * array and map headers are skipped, so the elements
+	 * follow as ordinary values.
+	 */
+	const char *pos = data;
+	while (pos < data_end) {
+		switch (mp_typeof(*pos)) {
+		case MP_ARRAY:
+			mp_decode_array(&pos);
+			break;
+		case MP_MAP:
+			mp_decode_map(&pos);
+			break;
+		case MP_EXT:
+			if (mp_ext_type(pos) == MP_COMPRESSION) {
+				diag_set(ClientError, ER_INVALID_MSGPACK,
+					 "reserved extension type");
+				return -1;
+			}
+			mp_next(&pos);
+			break;
+		default:
+			mp_next(&pos);
+			break;
+		}
+	}
+	return 0;
+}
+
+/**
+ * Try to compress a field of size @a size into @a out.
+ * Returns the size of the compressed field or 0 if the
+ * compressed field would not be smaller than the original one.
+ */
+static size_t
+mp_compress(ZSTD_CCtx *zctx, const char *field, uint32_t size, char *out)
+{
+	uint32_t header_size = MP_COMPRESSION_HEADER_SIZE +
+			       mp_sizeof_uint(size);
+	if (size <= header_size)
+		return 0;
+	char *pos = mp_encode_uint(out + MP_COMPRESSION_HEADER_SIZE, size);
+	/*
+	 * Limit the output to the original size: if zstd fails
+	 * to fit, the field is not worth compressing.
+	 */
+	size_t zsize = ZSTD_compressCCtx(zctx, pos, size - header_size,
+					 field, size, TUPLE_COMPRESSION_LEVEL);
+	if (ZSTD_isError(zsize))
+		return 0;
+	uint32_t len = pos + zsize - (out + MP_COMPRESSION_HEADER_SIZE);
+	pos = mp_store_u8(out, 0xc9);
+	pos = mp_store_u32(pos, len);
+	mp_store_u8(pos, MP_COMPRESSION);
+	return MP_COMPRESSION_HEADER_SIZE + len;
+}
+
+int
+tuple_compress_data(struct tuple_format *format, const char **data,
+		    const char **data_end)
+{
+	assert(format->is_compressed);
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	size_t size = *data_end - *data;
+	const char *pos = *data;
+	uint32_t field_count = mp_decode_array(&pos);
+	/* Compressed fields are never larger than the originals. */
+	char *buf = NULL;
+	char *wpos = NULL;
+	const char *copied = *data;
+	bool is_compressed = false;
+	ZSTD_CCtx *zctx = NULL;
+	for (uint32_t i = 0; i < field_count; i++) {
+		const char *field = pos;
+		mp_next(&pos);
+		uint32_t field_size = pos - field;
+		if (field_size < TUPLE_COMPRESSION_MIN_FIELD_SIZE ||
+		    mp_typeof(*field) == MP_EXT ||
+		    !tuple_field_is_compressible(format, i))
+			continue;
+		if (buf == NULL) {
+			zctx = tuple_get_zctx();
+			if (zctx == NULL)
+				return -1;
+			buf = region_alloc(region, size);
+			if (buf == NULL) {
+				diag_set(OutOfMemory, size, "region",
+					 "compressed tuple");
+				return -1;
+			}
+			wpos = buf;
+		}
+		memcpy(wpos, copied, field - copied);
+		wpos += field - copied;
+		size_t zsize = mp_compress(zctx, field, field_size, wpos);
+		if (zsize == 0) {
+			copied = field;
+			continue;
+		}
+		wpos += zsize;
+		copied = pos;
+		is_compressed = true;
+	}
+	if (!is_compressed) {
+		/* Nothing was worth compressing. */
+		region_truncate(region, region_svp);
+		return 0;
+	}
+	memcpy(wpos, copied, *data_end - copied);
+	wpos += *data_end - copied;
+	assert((size_t)(wpos - buf) <= size);
+	*data = buf;
+	*data_end = wpos;
+	return 0;
+}
+
+const char *
+mp_decompress(const char **data, uint32_t *size)
+{
+	assert(mp_is_compressed(*data));
+	const char *pos = *data + 1;
+	uint32_t len = mp_load_u32(&pos);
+	pos++; /* extension type */
+	const char *end = pos + len;
+	if (len == 0 || mp_typeof(*pos) != MP_UINT ||
+	    mp_check_uint(pos, end) > 0) {
+		diag_set(ClientError, ER_DECOMPRESSION,
+			 "invalid compressed field");
+		return NULL;
+	}
+	uint64_t raw_size = mp_decode_uint(&pos);
+	if (raw_size == 0 || raw_size > UINT32_MAX) {
+		diag_set(ClientError, ER_DECOMPRESSION,
+			 "invalid compressed field");
+		return NULL;
+	}
+	ZSTD_DCtx *zdctx = tuple_get_zdctx();
+	if (zdctx == NULL)
+		return NULL;
+	char *raw = region_alloc(&fiber()->gc, raw_size);
+	if (raw == NULL) {
+		diag_set(OutOfMemory, raw_size, "region", "compressed field");
+		return NULL;
+	}
+	size_t rc = ZSTD_decompressDCtx(zdctx, raw, raw_size,
+					pos, end - pos);
+	if (ZSTD_isError(rc)) {
+		diag_set(ClientError, ER_DECOMPRESSION, ZSTD_getErrorName(rc));
+		return NULL;
+	}
+	if (rc != raw_size) {
+		diag_set(ClientError, ER_DECOMPRESSION,
+			 "invalid compressed field size");
+		return NULL;
+	}
+	/*
+	 * The field is going to be decoded or sent to clients
+	 * as is, make sure it's a single valid MsgPack value.
+	 */
+	const char *check = raw;
+	if (mp_check(&check, raw + raw_size) != 0 ||
+	    check != raw + raw_size) {
+		diag_set(ClientError, ER_DECOMPRESSION,
+			 "invalid MsgPack in compressed field");
+		return NULL;
+	}
+	*data = end;
+	*size = raw_size;
+	return raw;
+}
+
+const char *
+tuple_decompress_data(const char *data, const char *data_end,
+		      uint32_t *size)
+{
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	const char *pos = data;
+	uint32_t field_count = mp_decode_array(&pos);
+	/*
+	 * Uncompressed fields are copied in batches, the
+	 * pieces are joined together in the end.
+	 */
+	const char *copied = data;
+	for (uint32_t i = 0; i < field_count; i++) {
+		if (!mp_is_compressed(pos)) {
+			mp_next(&pos);
+			continue;
+		}
+		size_t copy_size = pos - copied;
+		char *buf = region_alloc(region, copy_size);
+		if (buf == NULL) {
+			diag_set(OutOfMemory, copy_size, "region",
+				 "decompressed tuple");
+			goto fail;
+		}
+		memcpy(buf, copied, copy_size);
+		uint32_t field_size;
+		if (mp_decompress(&pos, &field_size) == NULL)
+			goto fail;
+		copied = pos;
+	}
+	if (copied == data) {
+		*size = data_end - data;
+		return data;
+	}
+	size_t copy_size = data_end - copied;
+	char *buf = region_alloc(region, copy_size);
+	if (buf == NULL) {
+		diag_set(OutOfMemory, copy_size, "region",
+			 "decompressed tuple");
+		goto fail;
+	}
+	memcpy(buf, copied, copy_size);
+	size_t total = region_used(region) - region_svp;
+	char *res = region_join(region, total);
+	if (res == NULL) {
+		diag_set(OutOfMemory, total, "region", "decompressed tuple");
+		goto fail;
+	}
+	*size = total;
+	return res;
+fail:
+	region_truncate(region, region_svp);
+	return NULL;
+}
@@ -0,0 +1,160 @@
+#ifndef TARANTOOL_BOX_TUPLE_COMPRESSION_H_INCLUDED
+#define TARANTOOL_BOX_TUPLE_COMPRESSION_H_INCLUDED
+/*
+ * Copyright 2010-2019, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "tuple.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+/**
+ * Compression of tuples stored in a space with the compression
+ * option set.
+ *
+ * A field is compressed only if it is not used by any index,
+ * has no type constraint and is big enough for compression to
+ * pay off. Such a field is replaced with a MsgPack extension
+ * value of type MP_COMPRESSION:
+ *
+ *   ext32 header | MP_UINT raw size | zstd frame
+ *
+ * The tuple itself stays a valid MsgPack array, index keys are
+ * kept as is, so indexes work without decompression. Each field
+ * is a self-contained zstd frame, so it can be decompressed
+ * independently of the rest of the tuple.
+ */
+
+/**
+ * MsgPack extension type of a compressed field. It is private
+ * to memtx, so it's far from the types other MsgPack extensions
+ * (e.g. decimal) use. Values of this type supplied by users are
+ * rejected, see mp_check_compression().
+ */
+enum { MP_COMPRESSION = 100 };
+
+/** Fields smaller than this are never compressed. */
+enum { TUPLE_COMPRESSION_MIN_FIELD_SIZE = 128 };
+
+/** Size of an ext32 header: 0xc9, 4-byte length, type. */
+enum { MP_COMPRESSION_HEADER_SIZE = 6 };
+
+/** Return true if @a data points to a compressed field. */
+static inline bool
+mp_is_compressed(const char *data)
+{
+	return (uint8_t)data[0] == 0xc9 &&
+	       (int8_t)data[MP_COMPRESSION_HEADER_SIZE - 1] == MP_COMPRESSION;
+}
+
+/**
+ * Check that MsgPack @a data supplied by a user doesn't contain
+ * values of type MP_COMPRESSION at any nesting level. Only memtx
+ * may store such values, otherwise a user could make it feed
+ * arbitrary data to the decompressor.
+ * @param data Valid MsgPack.
+ * @param data_end End of @a data.
+ *
+ * @retval  0 Success.
+ * @retval -1 A value of type MP_COMPRESSION was found, diag is set.
+ */
+int
+mp_check_compression(const char *data, const char *data_end);
+
+/**
+ * Compress fields of a tuple of format @a format.
+ * @param format Format of the tuple, must have is_compressed set.
+ * @param[in][out] data Tuple data. Replaced with a copy allocated
+ *        on the fiber region if any field was compressed.
+ * @param[in][out] data_end End of the tuple data.
+ *
+ * @retval  0 Success.
+ * @retval -1 Memory or compression error.
+ */
+int
+tuple_compress_data(struct tuple_format *format, const char **data,
+		    const char **data_end);
+
+/**
+ * Decompress a field compressed with tuple_compress_data().
+ * The decompressed field is checked to be exactly one valid
+ * MsgPack value.
+ * @param[in][out] data Compressed field, must be valid MsgPack.
+ *        Advanced to the next MsgPack value on success.
+ * @param[out] size Size of the decompressed field.
+ *
+ * @retval not NULL Decompressed field allocated on the fiber
+ *         region.
+ * @retval NULL Memory or decompression error.
+ */
+const char *
+mp_decompress(const char **data, uint32_t *size);
+
+/**
+ * Decompress all fields of a tuple.
+ * @param data Tuple data.
+ * @param data_end End of the tuple data.
+ * @param[out] size Size of the decompressed tuple data.
+ *
+ * @retval not NULL Decompressed tuple data. Either @a data if
+ *         there are no compressed fields or a copy allocated
+ *         on the fiber region.
+ * @retval NULL Memory or decompression error.
+ */
+const char *
+tuple_decompress_data(const char *data, const char *data_end,
+		      uint32_t *size);
+
+/**
+ * Return data of @a tuple with all fields decompressed.
+ * \sa tuple_decompress_data().
+ */
+static inline const char *
+tuple_data_range_decompressed(const struct tuple *tuple, uint32_t *size)
+{
+	const char *data = tuple_data_range(tuple, size);
+	if (likely(!tuple_format(tuple)->is_compressed))
+		return data;
+	return tuple_decompress_data(data, data + *size, size);
+}
+
+/** Free compression contexts of the current thread. */
+void
+tuple_compression_free(void);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
+
+#endif /* TARANTOOL_BOX_TUPLE_COMPRESSION_H_INCLUDED */
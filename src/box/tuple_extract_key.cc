@@ -309,8 +309,8 @@ tuple_extract_key_slowpath_raw(const char *data, const char *data_end,
 		const char *src = field;
 		const char *src_end = field_end;
 		if (has_json_paths && part->path != NULL) {
-			if (tuple_go_to_path(&src, part->path,
-						   part->path_len) != 0) {
+			if (tuple_go_to_path(&src, part->path, part->path_len,
+					     MULTIKEY_NONE) != 0) {
 				/*
 				 * The path must be correct as
 				 * it has already been validated
@@ -371,15 +371,14 @@ key_def_set_extract_func(struct key_def *key_def)
 			key_def->tuple_extract_key_raw =
 				tuple_extract_key_sequential_raw<false>;
 		}
-	} else {
-		int func_idx =
-			(key_def_contains_sequential_parts(key_def) ? 1 : 0) +
-			2 * (key_def->has_optional_parts ? 1 : 0) +
-			4 * (key_def->has_json_paths ? 1 : 0);
-		key_def->tuple_extract_key =
-			extract_key_slowpath_funcs[func_idx];
-		assert(!key_def->has_optional_parts || key_def->is_nullable);
+		return;
 	}
+	int func_idx =
+		(key_def_contains_sequential_parts(key_def) ? 1 : 0) +
+		2 * (key_def->has_optional_parts ? 1 : 0) +
+		4 * (key_def->has_json_paths ? 1 : 0);
+	key_def->tuple_extract_key = extract_key_slowpath_funcs[func_idx];
+	assert(!key_def->has_optional_parts || key_def->is_nullable);
 	if (key_def->has_optional_parts) {
 		assert(key_def->is_nullable);
 		if (key_def->has_json_paths) {
@@ -31,6 +31,7 @@
 #include "bit/bit.h"
 #include "fiber.h"
 #include "json/json.h"
+#include "mp_scan.h"
 #include "tuple_format.h"
 #include "coll_id_cache.h"
 
@@ -43,6 +44,16 @@ static intptr_t recycled_format_ids = FORMAT_ID_NIL;
 static uint32_t formats_size = 0, formats_capacity = 0;
 static uint64_t formats_epoch = 0;
 
+/**
+ * Old versions of the tuple_formats table, replaced as it grew.
+ * They are freed only on shutdown, because tuple_format_by_id()
+ * may be called by threads reading frozen memtx indexes while
+ * the table grows, see select_view.c. The table size doubles on
+ * each growth, so a few slots are enough.
+ */
+static struct tuple_format **retired_formats[32];
+static int retired_format_count = 0;
+
 /**
  * Find in format1::fields the field by format2_field's JSON path.
  * Routine uses fiber region for temporal path allocation and
@@ -176,6 +187,22 @@ tuple_field_path(const struct tuple_field *field)
 	return path;
 }
 
+/**
+ * Return the multikey array element field (the one with
+ * the [*] token) the given field belongs to or NULL if the
+ * field isn't stored in a multikey array.
+ */
+static struct tuple_field *
+tuple_field_multikey_element(struct tuple_field *field)
+{
+	struct json_token *token = &field->token;
+	for (; token->parent != NULL; token = token->parent) {
+		if (token->type == JSON_TOKEN_ANY)
+			return container_of(token, struct tuple_field, token);
+	}
+	return NULL;
+}
+
 /**
  * Look up field metadata by identifier.
  *
@@ -233,9 +260,17 @@ tuple_format_add_field(struct tuple_format *format, uint32_t fieldno,
 	json_lexer_create(&lexer, path, path_len, TUPLE_INDEX_BASE);
 	while ((rc = json_lexer_next_token(&lexer, &field->token)) == 0 &&
 	       field->token.type != JSON_TOKEN_END) {
-		if (field->token.type == JSON_TOKEN_ANY) {
-			diag_set(ClientError, ER_UNSUPPORTED,
-				"Tarantool", "multikey indexes");
+		/*
+		 * An array may be either indexed by [*] or by
+		 * exact positions, but not both.
+		 */
+		if (!json_token_is_leaf(&parent->token) &&
+		    json_token_is_multikey(&parent->token) !=
+		    (field->token.type == JSON_TOKEN_ANY)) {
+			diag_set(ClientError, ER_UNSUPPORTED, "Tarantool",
+				 tt_sprintf("multikey and regular JSON paths "
+					    "to the same array %s",
+					    tuple_field_path(parent)));
 			goto fail;
 		}
 		enum field_type expected_type =
@@ -354,10 +389,13 @@ tuple_format_use_key_part(struct tuple_format *format, uint32_t field_count,
 	 * In the tuple, store only offsets necessary to access
 	 * fields of non-sequential keys. First field is always
 	 * simply accessible, so we don't store an offset for it.
+	 * A field in a multikey array has as many offsets as
+	 * there are array elements so it can't have a slot.
 	 */
 	if (field->offset_slot == TUPLE_OFFSET_SLOT_NIL &&
 	    is_sequential == false &&
-	    (part->fieldno > 0 || part->path != NULL)) {
+	    (part->fieldno > 0 || part->path != NULL) &&
+	    tuple_field_multikey_element(field) == NULL) {
 		*current_slot = *current_slot - 1;
 		field->offset_slot = *current_slot;
 	}
@@ -411,8 +449,15 @@ tuple_format_create(struct tuple_format *format, struct key_def * const *keys,
 	for (uint16_t key_no = 0; key_no < key_count; ++key_no) {
 		const struct key_def *key_def = keys[key_no];
 		bool is_sequential = key_def_is_sequential(key_def);
-		const struct key_part *part = key_def->parts;
-		const struct key_part *parts_end = part + key_def->part_count;
+		/*
+		 * Parts of a functional index refer to the key
+		 * returned by the index function, not to tuple
+		 * fields, so they don't affect the format.
+		 */
+		const struct key_part *part = key_def->parts +
+					      key_def->func_index_part_count;
+		const struct key_part *parts_end = key_def->parts +
+						   key_def->part_count;
 
 		for (; part < parts_end; part++) {
 			if (tuple_format_use_key_part(format, field_count, part,
@@ -449,9 +494,25 @@ tuple_format_create(struct tuple_format *format, struct key_def * const *keys,
 		 * by setting the corresponding bit in the bitmap
 		 * of required fields.
 		 */
-		if (json_token_is_leaf(&field->token) &&
-		    !tuple_field_is_nullable(field))
+		if (!json_token_is_leaf(&field->token) ||
+		    tuple_field_is_nullable(field))
+			continue;
+		/*
+		 * Fields of multikey array elements are checked
+		 * for each element separately on tuple creation,
+		 * see tuple_field_map_create(). Require the array
+		 * itself here.
+		 */
+		struct tuple_field *element =
+			tuple_field_multikey_element(field);
+		if (element != NULL) {
+			struct tuple_field *array =
+				container_of(element->token.parent,
+					     struct tuple_field, token);
+			bit_set(format->required_fields, array->id);
+		} else {
 			bit_set(format->required_fields, field->id);
+		}
 	}
 	format->hash = tuple_format_hash(format);
 	return 0;
@@ -470,14 +531,21 @@ tuple_format_register(struct tuple_format *format)
 						formats_capacity * 2 : 16;
 			struct tuple_format **formats;
 			formats = (struct tuple_format **)
-				realloc(tuple_formats, new_capacity *
-						       sizeof(tuple_formats[0]));
+				malloc(new_capacity * sizeof(tuple_formats[0]));
 			if (formats == NULL) {
 				diag_set(OutOfMemory,
 					 sizeof(struct tuple_format), "malloc",
 					 "tuple_formats");
 				return -1;
 			}
+			if (tuple_formats != NULL) {
+				assert(retired_format_count <
+				       (int)lengthof(retired_formats));
+				memcpy(formats, tuple_formats, formats_capacity *
+				       sizeof(tuple_formats[0]));
+				retired_formats[retired_format_count++] =
+					tuple_formats;
+			}
 
 			formats_capacity = new_capacity;
 			tuple_formats = formats;
@@ -534,8 +602,10 @@ tuple_format_alloc(struct key_def * const *keys, uint16_t key_count,
 	/* find max max field no */
 	for (uint16_t key_no = 0; key_no < key_count; ++key_no) {
 		const struct key_def *key_def = keys[key_no];
-		const struct key_part *part = key_def->parts;
-		const struct key_part *pend = part + key_def->part_count;
+		const struct key_part *part = key_def->parts +
+					      key_def->func_index_part_count;
+		const struct key_part *pend = key_def->parts +
+					      key_def->part_count;
 		for (; part < pend; part++) {
 			index_field_count = MAX(index_field_count,
 						part->fieldno + 1);
@@ -701,6 +771,8 @@ tuple_format_new(struct tuple_format_vtab *vtab, void *engine,
 	format->engine = engine;
 	format->is_temporary = is_temporary;
 	format->is_ephemeral = is_ephemeral;
+	format->is_compressed = false;
+	format->offset_step = 0;
 	format->exact_field_count = exact_field_count;
 	format->epoch = ++formats_epoch;
 	if (tuple_format_create(format, keys, key_count, space_fields,
@@ -765,6 +837,48 @@ tuple_format1_can_store_format2_tuples(struct tuple_format *format1,
 	return true;
 }
 
+/**
+ * Mark non-nullable leaf fields of a multikey array element
+ * as required. Required fields of array elements are not set
+ * in tuple_format::required_fields, because the number of
+ * elements varies from tuple to tuple. Instead, they are set
+ * when an element is met in a tuple and checked when the
+ * element has been parsed.
+ */
+static void
+tuple_field_multikey_set_required(struct tuple_field *element,
+				  void *required_fields)
+{
+	struct tuple_field *field;
+	json_tree_foreach_entry_preorder(field, &element->token,
+					 struct tuple_field, token) {
+		if (json_token_is_leaf(&field->token) &&
+		    !tuple_field_is_nullable(field))
+			bit_set(required_fields, field->id);
+	}
+}
+
+/**
+ * Check that all required fields of a multikey array element
+ * have been met in the element. On failure, set diag and
+ * return -1.
+ */
+static int
+tuple_field_multikey_check_required(struct json_token *element,
+				    void *required_fields)
+{
+	struct tuple_field *field;
+	json_tree_foreach_entry_preorder(field, element,
+					 struct tuple_field, token) {
+		if (bit_test(required_fields, field->id)) {
+			diag_set(ClientError, ER_FIELD_MISSING,
+				 tuple_field_path(field));
+			return -1;
+		}
+	}
+	return 0;
+}
+
 /** @sa declaration for details. */
 int
 tuple_field_map_create(struct tuple_format *format, const char *tuple,
@@ -776,8 +890,12 @@ tuple_field_map_create(struct tuple_format *format, const char *tuple,
 		*field_map_size = 0;
 		return 0; /* Nothing to initialize */
 	}
+	const char *pos = tuple;
+	uint32_t field_count = mp_decode_array(&pos);
+	uint32_t anchor_count = tuple_format_anchor_count(format, field_count);
 	struct region *region = &fiber()->gc;
-	*field_map_size = format->field_map_size;
+	*field_map_size = format->field_map_size +
+			  anchor_count * sizeof(uint32_t);
 	*field_map = region_alloc(region, *field_map_size);
 	if (*field_map == NULL) {
 		diag_set(OutOfMemory, *field_map_size, "region_alloc",
@@ -785,11 +903,12 @@ tuple_field_map_create(struct tuple_format *format, const char *tuple,
 		return -1;
 	}
 	*field_map = (uint32_t *)((char *)*field_map + *field_map_size);
+	/* Anchors go after offset slots, see tuple_format::offset_step. */
+	uint32_t *anchors = *field_map - format->field_map_size /
+					 sizeof(uint32_t);
 
-	const char *pos = tuple;
 	int rc = 0;
 	/* Check to see if the tuple has a sufficient number of fields. */
-	uint32_t field_count = mp_decode_array(&pos);
 	if (validate && format->exact_field_count > 0 &&
 	    format->exact_field_count != field_count) {
 		diag_set(ClientError, ER_EXACT_FIELD_COUNT,
@@ -829,6 +948,45 @@ tuple_field_map_create(struct tuple_format *format, const char *tuple,
 	 * which key fields are absent in tuple_field().
 	 */
 	memset((char *)*field_map - *field_map_size, 0, *field_map_size);
+	if (format->fields_depth == 1) {
+		/*
+		 * The format has no JSON paths, so only offsets
+		 * of top-level fields are needed. Find them all
+		 * in one pass of the MessagePack scanner.
+		 */
+		size_t offsets_sz = defined_field_count * sizeof(uint32_t);
+		uint32_t *offsets = region_alloc(region, offsets_sz);
+		if (offsets == NULL) {
+			diag_set(OutOfMemory, offsets_sz, "region", "offsets");
+			goto error;
+		}
+		pos = mp_scan_offsets(pos, defined_field_count, tuple,
+				      offsets);
+		for (uint32_t i = 0; i < defined_field_count; i++) {
+			if (anchor_count > 0 && i > 0 &&
+			    i % format->offset_step == 0 &&
+			    i / format->offset_step <= anchor_count)
+				anchors[-(i / format->offset_step)] =
+					offsets[i];
+			struct tuple_field *field =
+				tuple_format_field(format, i);
+			assert(field != NULL);
+			if (validate &&
+			    !field_mp_type_is_compatible(field->type,
+					mp_typeof(tuple[offsets[i]]),
+					tuple_field_is_nullable(field))) {
+				diag_set(ClientError, ER_FIELD_TYPE,
+					 tuple_field_path(field),
+					 field_type_strs[field->type]);
+				goto error;
+			}
+			if (field->offset_slot != TUPLE_OFFSET_SLOT_NIL)
+				(*field_map)[field->offset_slot] = offsets[i];
+			if (required_fields != NULL)
+				bit_clear(required_fields, field->id);
+		}
+		goto finish;
+	}
 	/*
 	 * Prepare mp stack of the size equal to the maximum depth
 	 * of the indexed field in the format::fields tree
@@ -861,6 +1019,11 @@ tuple_field_map_create(struct tuple_format *format, const char *tuple,
 			mp_stack_pop(&stack);
 			if (mp_stack_is_empty(&stack))
 				goto finish;
+			if (required_fields != NULL &&
+			    parent->type == JSON_TOKEN_ANY &&
+			    tuple_field_multikey_check_required(parent,
+							required_fields) != 0)
+				goto error;
 			parent = parent->parent;
 		}
 		/*
@@ -873,6 +1036,12 @@ tuple_field_map_create(struct tuple_format *format, const char *tuple,
 		case MP_ARRAY:
 			token.type = JSON_TOKEN_NUM;
 			token.num = idx;
+			if (anchor_count > 0 &&
+			    parent == &format->fields.root && idx > 0 &&
+			    idx % format->offset_step == 0 &&
+			    idx / format->offset_step <= anchor_count)
+				anchors[-(idx / format->offset_step)] =
+					pos - tuple;
 			break;
 		case MP_MAP:
 			if (mp_typeof(*pos) != MP_STR) {
@@ -912,6 +1081,10 @@ tuple_field_map_create(struct tuple_format *format, const char *tuple,
 			}
 			if (field->offset_slot != TUPLE_OFFSET_SLOT_NIL)
 				(*field_map)[field->offset_slot] = pos - tuple;
+			if (required_fields != NULL &&
+			    field->token.type == JSON_TOKEN_ANY)
+				tuple_field_multikey_set_required(field,
+							required_fields);
 			if (required_fields != NULL)
 				bit_clear(required_fields, field->id);
 		}
@@ -931,9 +1104,28 @@ tuple_field_map_create(struct tuple_format *format, const char *tuple,
 			parent = &field->token;
 		} else {
 			mp_next(&pos);
+			if (required_fields != NULL && field != NULL &&
+			    field->token.type == JSON_TOKEN_ANY &&
+			    tuple_field_multikey_check_required(&field->token,
+							required_fields) != 0)
+				goto error;
 		}
 	}
 finish:
+	/*
+	 * Fields past the ones parsed above are only needed
+	 * to set anchors.
+	 */
+	if (anchor_count > 0) {
+		uint32_t step = format->offset_step;
+		uint32_t i = defined_field_count;
+		for (uint32_t a = MAX(DIV_ROUND_UP(i, step), 1u);
+		     a <= anchor_count; a++) {
+			mp_scan_skip(&pos, a * step - i);
+			i = a * step;
+			anchors[-a] = pos - tuple;
+		}
+	}
 	/*
 	 * Check the required field bitmap for missing fields.
 	 */
@@ -971,7 +1163,8 @@ tuple_format_min_field_count(struct key_def * const *keys, uint16_t key_count,
 	}
 	for (uint32_t i = 0; i < key_count; ++i) {
 		const struct key_def *kd = keys[i];
-		for (uint32_t j = 0; j < kd->part_count; ++j) {
+		for (uint32_t j = kd->func_index_part_count;
+		     j < kd->part_count; ++j) {
 			const struct key_part *kp = &kd->parts[j];
 			if (!key_part_is_nullable(kp) &&
 			    kp->fieldno + 1 > min_field_count)
@@ -1012,6 +1205,8 @@ tuple_format_free()
 		}
 	}
 	free(tuple_formats);
+	for (int i = 0; i < retired_format_count; i++)
+		free(retired_formats[i]);
 	mh_tuple_format_delete(tuple_formats_hash);
 }
 
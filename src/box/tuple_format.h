@@ -168,6 +168,24 @@ struct tuple_format {
 	 * be shared with other ephemeral spaces.
 	 */
 	bool is_ephemeral;
+	/**
+	 * Big fields which are not used by any index are
+	 * compressed before a tuple of this format is stored,
+	 * see tuple_compression.h.
+	 */
+	bool is_compressed;
+	/**
+	 * If not 0, the field map of a tuple of this format is
+	 * followed by offsets of top-level fields number step,
+	 * 2 * step, and so on till the end of the tuple, called
+	 * anchors. A field that has no offset slot is looked up
+	 * starting from the closest anchor preceding it rather
+	 * than from the beginning of the tuple, so access to any
+	 * field of a wide tuple takes at most step - 1 skips.
+	 * Anchors make the field map of a tuple longer than
+	 * field_map_size, see tuple_format_anchor_count().
+	 */
+	uint32_t offset_step;
 	/**
 	 * Size of field map of tuple in bytes.
 	 * \sa struct tuple
@@ -227,6 +245,24 @@ tuple_format_field_count(struct tuple_format *format)
 	return root->children != NULL ? root->max_child_idx + 1 : 0;
 }
 
+/** Max number of anchors in a tuple, see tuple_format::offset_step. */
+enum { TUPLE_OFFSET_ANCHOR_MAX = 4096 };
+
+/**
+ * Return the number of anchors stored in the field map of
+ * a tuple with @a field_count fields, see tuple_format::
+ * offset_step. Fields past the last anchor are looked up
+ * starting from it.
+ */
+static inline uint32_t
+tuple_format_anchor_count(struct tuple_format *format, uint32_t field_count)
+{
+	if (format->offset_step == 0 || field_count == 0)
+		return 0;
+	return MIN((field_count - 1) / format->offset_step,
+		   (uint32_t)TUPLE_OFFSET_ANCHOR_MAX);
+}
+
 /**
  * Return meta information of a tuple field given a format,
  * field index and path.
@@ -389,16 +425,19 @@ box_tuple_format_unref(box_tuple_format_t *format);
  * @param field_map[out] The pointer to store field map
  *                       allocation.
  * @param field_map_size[out] The pointer to variable to store
- *                            field map size.
+ *                            field map size. It exceeds
+ *                            tuple_format::field_map_size by
+ *                            the size of anchors, if any.
  *
  * @retval  0 Success.
  * @retval -1 Format error.
- *            +-------------------+
- * Result:    | offN | ... | off1 |
- *            +-------------------+
- *                                ^
- *                             field_map
+ *            +----------------------------------------+
+ * Result:    | anchorM | ... | anchor1 | offN | ... | off1 |
+ *            +----------------------------------------+
+ *                                                   ^
+ *                                                field_map
  * tuple + off_i = indexed_field_i;
+ * tuple + anchor_j = field number j * tuple_format::offset_step.
  */
 int
 tuple_field_map_create(struct tuple_format *format, const char *tuple,
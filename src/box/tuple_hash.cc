@@ -199,6 +199,8 @@ struct hasher_signature {
 static const hasher_signature hash_arr[] = {
 	HASHER(FIELD_TYPE_UNSIGNED)
 	HASHER(FIELD_TYPE_STRING)
+	HASHER(FIELD_TYPE_INTEGER)
+	HASHER(FIELD_TYPE_BOOLEAN)
 	HASHER(FIELD_TYPE_UNSIGNED, FIELD_TYPE_UNSIGNED)
 	HASHER(FIELD_TYPE_STRING  , FIELD_TYPE_UNSIGNED)
 	HASHER(FIELD_TYPE_UNSIGNED, FIELD_TYPE_STRING)
@@ -219,6 +221,23 @@ template <bool has_optional_parts, bool has_json_paths>
 uint32_t
 tuple_hash_slowpath(const struct tuple *tuple, struct key_def *key_def);
 
+/**
+ * Return the type of part @a i of @a key_def to look up in
+ * hash_arr. Integers and booleans are hashed as is, like
+ * field_hash<FIELD_TYPE_UNSIGNED>() does in a multipart key,
+ * so they share its hashers. Only a single unsigned part is
+ * hashed differently, see KeyHash<FIELD_TYPE_UNSIGNED>.
+ */
+static inline uint32_t
+hash_type(const struct key_def *key_def, uint32_t i)
+{
+	enum field_type type = key_def->parts[i].type;
+	if (key_def->part_count > 1 &&
+	    (type == FIELD_TYPE_INTEGER || type == FIELD_TYPE_BOOLEAN))
+		return FIELD_TYPE_UNSIGNED;
+	return type;
+}
+
 uint32_t
 key_hash_slowpath(const char *key, struct key_def *key_def);
 
@@ -246,7 +265,7 @@ key_def_set_hash_func(struct key_def *key_def) {
 	for (uint32_t k = 0; k < sizeof(hash_arr) / sizeof(hash_arr[0]); k++) {
 		uint32_t i = 0;
 		for (; i < key_def->part_count; i++) {
-			if (key_def->parts[i].type != hash_arr[k].p[i]) {
+			if (hash_type(key_def, i) != hash_arr[k].p[i]) {
 				break;
 			}
 		}
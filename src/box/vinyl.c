@@ -280,6 +280,18 @@ vy_info_append_regulator(struct vy_env *env, struct info_handler *h)
 	info_table_end(h); /* regulator */
 }
 
+static void
+vy_info_append_page_cache(struct vy_env *env, struct info_handler *h)
+{
+	struct vy_page_cache *cache = &env->run_env.page_cache;
+
+	info_table_begin(h, "page_cache");
+	info_append_int(h, "used", cache->mem_used);
+	info_append_int(h, "hit", cache->hit);
+	info_append_int(h, "miss", cache->miss);
+	info_table_end(h); /* page_cache */
+}
+
 static void
 vy_info_append_tx(struct vy_env *env, struct info_handler *h)
 {
@@ -337,6 +349,7 @@ vinyl_engine_stat(struct vinyl_engine *vinyl, struct info_handler *h)
 	vy_info_append_disk(env, h);
 	vy_info_append_scheduler(env, h);
 	vy_info_append_regulator(env, h);
+	vy_info_append_page_cache(env, h);
 	info_end(h);
 }
 
@@ -596,6 +609,16 @@ vinyl_engine_check_space_def(struct space_def *def)
 			 def->name, "engine does not support temporary flag");
 		return -1;
 	}
+	if (def->opts.compression != SPACE_COMPRESSION_NONE) {
+		diag_set(ClientError, ER_ALTER_SPACE,
+			 def->name, "engine does not support compression");
+		return -1;
+	}
+	if (def->opts.field_offset_step != 0) {
+		diag_set(ClientError, ER_ALTER_SPACE,
+			 def->name, "engine does not support field_offset_step");
+		return -1;
+	}
 	return 0;
 }
 
@@ -687,6 +710,11 @@ vinyl_space_check_index_def(struct space *space, struct index_def *index_def)
 		diag_set(ClientError, ER_NULLABLE_PRIMARY, space_name(space));
 		return -1;
 	}
+	if (index_def->key_def->is_multikey) {
+		diag_set(ClientError, ER_UNSUPPORTED, "Vinyl",
+			 "multikey indexes");
+		return -1;
+	}
 	/* Check that there are no ANY, ARRAY, MAP parts */
 	for (uint32_t i = 0; i < index_def->key_def->part_count; i++) {
 		struct key_part *part = &index_def->key_def->parts[i];
@@ -983,6 +1011,8 @@ vinyl_index_def_change_requires_rebuild(struct index *index,
 
 	if (!old_def->opts.is_unique && new_def->opts.is_unique)
 		return true;
+	if (old_def->opts.func_id != new_def->opts.func_id)
+		return true;
 
 	assert(index_depends_on_pk(index));
 	const struct key_def *old_cmp_def = old_def->cmp_def;
@@ -1328,8 +1358,25 @@ vy_get_by_secondary_tuple(struct vy_lsm *lsm, struct vy_tx *tx,
 		goto out;
 	}
 
-	if (*result == NULL ||
-	    vy_stmt_compare(*result, tuple, lsm->cmp_def) != 0) {
+	bool is_stale = *result == NULL;
+	if (!is_stale && vy_lsm_is_func(lsm)) {
+		/*
+		 * A functional index stores keys returned by the
+		 * index function so we have to call the function
+		 * to check if the tuple matches the statement.
+		 */
+		struct tuple *stmt = vy_lsm_func_stmt_new(lsm, *result, true);
+		if (stmt == NULL) {
+			tuple_unref(*result);
+			rc = -1;
+			goto out;
+		}
+		is_stale = vy_stmt_compare(stmt, tuple, lsm->cmp_def) != 0;
+		tuple_unref(stmt);
+	} else if (!is_stale) {
+		is_stale = vy_stmt_compare(*result, tuple, lsm->cmp_def) != 0;
+	}
+	if (is_stale) {
 		/*
 		 * If a tuple read from a secondary index doesn't
 		 * match the tuple corresponding to it in the
@@ -1503,6 +1550,21 @@ vy_check_is_unique_primary(struct vy_tx *tx, const struct vy_read_view **rv,
 	return 0;
 }
 
+/** Return true if a key statement has a NULL part. */
+static bool
+vy_stmt_key_contains_null(const struct tuple *key)
+{
+	assert(vy_stmt_is_key(key));
+	const char *data = tuple_data(key);
+	uint32_t part_count = mp_decode_array(&data);
+	for (uint32_t i = 0; i < part_count; i++) {
+		if (mp_typeof(*data) == MP_NIL)
+			return true;
+		mp_next(&data);
+	}
+	return false;
+}
+
 /**
  * Check if insertion of a new tuple violates unique constraint
  * of a secondary index.
@@ -1527,13 +1589,25 @@ vy_check_is_unique_secondary(struct vy_tx *tx, const struct vy_read_view **rv,
 
 	if (!lsm->check_is_unique)
 		return 0;
-	if (lsm->key_def->is_nullable &&
-	    tuple_key_contains_null(stmt, lsm->key_def))
-		return 0;
-	struct tuple *key = vy_stmt_extract_key(stmt, lsm->key_def,
-						lsm->env->key_format);
-	if (key == NULL)
-		return -1;
+	struct tuple *key;
+	if (vy_lsm_is_func(lsm)) {
+		key = vy_lsm_func_stmt_new(lsm, (struct tuple *)stmt, false);
+		if (key == NULL)
+			return -1;
+		if (lsm->key_def->is_nullable &&
+		    vy_stmt_key_contains_null(key)) {
+			tuple_unref(key);
+			return 0;
+		}
+	} else {
+		if (lsm->key_def->is_nullable &&
+		    tuple_key_contains_null(stmt, lsm->key_def))
+			return 0;
+		key = vy_stmt_extract_key(stmt, lsm->key_def,
+					  lsm->env->key_format);
+		if (key == NULL)
+			return -1;
+	}
 	struct tuple *found;
 	int rc = vy_get(lsm, tx, rv, key, &found);
 	tuple_unref(key);
@@ -1661,6 +1735,49 @@ vy_unique_key_validate(struct vy_lsm *lsm, const char *key,
 	return key_validate_parts(lsm->cmp_def, key, part_count, false);
 }
 
+/**
+ * Return true if a space has a functional index.
+ *
+ * Such a space never uses deferred DELETEs, because a DELETE
+ * generated on primary index compaction only has indexed fields
+ * of the deleted tuple while the index function needs the whole
+ * tuple to compute the key to delete.
+ */
+static bool
+vy_space_has_func_index(struct space *space)
+{
+	for (uint32_t i = 1; i < space->index_count; i++) {
+		if (vy_lsm_is_func(vy_lsm(space->index[i])))
+			return true;
+	}
+	return false;
+}
+
+/**
+ * Add a statement generated for a tuple to the write set of
+ * an LSM tree. A functional index stores keys returned by its
+ * function rather than tuples, so the statement written to it
+ * is computed from the full tuple, which is passed in @a tuple,
+ * because @a stmt may be a surrogate DELETE lacking fields the
+ * function needs. Other LSM trees get @a stmt as is.
+ */
+static int
+vy_tx_set_for_tuple(struct vy_tx *tx, struct vy_lsm *lsm,
+		    struct tuple *stmt, struct tuple *tuple,
+		    uint64_t column_mask)
+{
+	if (!vy_lsm_is_func(lsm))
+		return vy_tx_set_with_colmask(tx, lsm, stmt, column_mask);
+	struct tuple *func_stmt = vy_lsm_func_stmt_new(lsm, tuple, true);
+	if (func_stmt == NULL)
+		return -1;
+	vy_stmt_set_type(func_stmt, vy_stmt_type(stmt));
+	vy_stmt_set_flags(func_stmt, vy_stmt_flags(stmt) & VY_STMT_UPDATE);
+	int rc = vy_tx_set_with_colmask(tx, lsm, func_stmt, column_mask);
+	tuple_unref(func_stmt);
+	return rc;
+}
+
 /**
  * Execute DELETE in a vinyl space.
  * @param env     Vinyl environment.
@@ -1696,8 +1813,11 @@ vy_delete(struct vy_env *env, struct vy_tx *tx, struct txn_stmt *stmt,
 	 * - if the space has on_replace triggers and need to pass
 	 *   to them the old tuple.
 	 * - if deletion is done by a secondary index.
+	 * - if the space has a functional index, see
+	 *   vy_space_has_func_index().
 	 */
-	if (lsm->index_id > 0 || !rlist_empty(&space->on_replace)) {
+	if (lsm->index_id > 0 || !rlist_empty(&space->on_replace) ||
+	    vy_space_has_func_index(space)) {
 		if (vy_get_by_raw_key(lsm, tx, vy_tx_read_view(tx),
 				      key, part_count, &stmt->old_tuple) != 0)
 			return -1;
@@ -1715,7 +1835,9 @@ vy_delete(struct vy_env *env, struct vy_tx *tx, struct txn_stmt *stmt,
 			struct vy_lsm *lsm = vy_lsm(space->index[i]);
 			if (vy_is_committed_one(env, lsm))
 				continue;
-			rc = vy_tx_set(tx, lsm, delete);
+			rc = vy_tx_set_for_tuple(tx, lsm, delete,
+						 stmt->old_tuple,
+						 COLUMN_MASK_FULL);
 			if (rc != 0)
 				break;
 		}
@@ -1733,6 +1855,130 @@ vy_delete(struct vy_env *env, struct vy_tx *tx, struct txn_stmt *stmt,
 	return rc;
 }
 
+/**
+ * Delete all tuples in the range [@begin, @end) of the primary
+ * key one by one. Used when the space has secondary indexes,
+ * because a range deletion can't be propagated to them.
+ *
+ * Note, this reads every tuple in the range and writes a DELETE
+ * per tuple to each index, i.e. costs as much as deleting the
+ * keys with separate requests: a large range produces a storm
+ * of writes, dumps and compactions that a range tombstone in
+ * the primary index is meant to avoid.
+ */
+static int
+vy_delete_range_by_key(struct vy_env *env, struct vy_tx *tx,
+		       struct space *space, struct tuple *begin,
+		       const char *end)
+{
+	struct vy_lsm *pk = vy_lsm(space->index[0]);
+	const char *tmp = end;
+	bool is_unbounded = mp_decode_array(&tmp) == 0;
+	struct vy_read_iterator itr;
+	vy_read_iterator_open(&itr, pk, tx, ITER_GE, begin,
+			      vy_tx_read_view(tx));
+	int rc;
+	struct tuple *tuple;
+	while ((rc = vy_read_iterator_next(&itr, &tuple)) == 0) {
+		if (tuple == NULL)
+			break;
+		if (!is_unbounded &&
+		    vy_stmt_compare_with_raw_key(tuple, end,
+						 pk->cmp_def) >= 0)
+			break;
+		struct tuple *delete;
+		delete = vy_stmt_new_surrogate_delete(pk->mem_format, tuple);
+		if (delete == NULL) {
+			rc = -1;
+			break;
+		}
+		for (uint32_t i = 0; i < space->index_count; i++) {
+			struct vy_lsm *lsm = vy_lsm(space->index[i]);
+			if (vy_is_committed_one(env, lsm))
+				continue;
+			rc = vy_tx_set_for_tuple(tx, lsm, delete, tuple,
+						 COLUMN_MASK_FULL);
+			if (rc != 0)
+				break;
+		}
+		tuple_unref(delete);
+		if (rc != 0)
+			break;
+	}
+	vy_read_iterator_close(&itr);
+	return rc;
+}
+
+/**
+ * Execute DELETE_RANGE in a vinyl space.
+ * @param env     Vinyl environment.
+ * @param tx      Current transaction.
+ * @param space   Vinyl space.
+ * @param request Request with the range bounds: the request key
+ *                is the beginning of the range, the request tuple
+ *                is the end of the range.
+ *
+ * @retval  0 Success
+ * @retval -1 Invalid key or memory error.
+ */
+static int
+vy_delete_range(struct vy_env *env, struct vy_tx *tx, struct space *space,
+		struct request *request)
+{
+	if (vy_is_committed(env, space))
+		return 0;
+	if (request->index_id != 0) {
+		diag_set(ClientError, ER_UNSUPPORTED, "Vinyl",
+			 "delete_range() by a secondary index");
+		return -1;
+	}
+	struct vy_lsm *pk = vy_lsm_find(space, 0);
+	if (pk == NULL)
+		return -1;
+	struct index_def *def = space->index[0]->def;
+	const char *key = request->key;
+	uint32_t begin_part_count = mp_decode_array(&key);
+	if (key_validate(def, ITER_GE, key, begin_part_count) != 0)
+		return -1;
+	key = request->tuple;
+	uint32_t end_part_count = mp_decode_array(&key);
+	if (key_validate(def, ITER_GE, key, end_part_count) != 0)
+		return -1;
+	/*
+	 * Nothing to do if the range is empty. Note, keys matching
+	 * the end of the range are excluded so [{1}, {1, 2}) is not
+	 * empty while [{1, 2}, {1}) is.
+	 */
+	if (end_part_count > 0) {
+		int cmp = key_compare(request->key, request->tuple,
+				      pk->cmp_def);
+		if (cmp > 0 || (cmp == 0 &&
+				end_part_count <= begin_part_count))
+			return 0;
+	}
+	int rc;
+	if (space->index_count > 1) {
+		struct tuple *begin = vy_key_from_msgpack(pk->env->key_format,
+							  request->key);
+		if (begin == NULL)
+			return -1;
+		rc = vy_delete_range_by_key(env, tx, space, begin,
+					    request->tuple);
+		tuple_unref(begin);
+		return rc;
+	}
+	struct tuple *range_delete;
+	range_delete = vy_stmt_new_delete_range(pk->env->key_format,
+						request->key, request->key_end,
+						request->tuple,
+						request->tuple_end);
+	if (range_delete == NULL)
+		return -1;
+	rc = vy_tx_delete_range(tx, pk, range_delete);
+	tuple_unref(range_delete);
+	return rc;
+}
+
 /**
  * We do not allow changes of the primary key during update.
  *
@@ -1798,11 +2044,11 @@ vy_perform_update(struct vy_env *env, struct vy_tx *tx, struct txn_stmt *stmt,
 		struct vy_lsm *lsm = vy_lsm(space->index[i]);
 		if (vy_is_committed_one(env, lsm))
 			continue;
-		if (vy_tx_set_with_colmask(tx, lsm, delete,
-					   column_mask) != 0)
+		if (vy_tx_set_for_tuple(tx, lsm, delete, stmt->old_tuple,
+					column_mask) != 0)
 			goto error;
-		if (vy_tx_set_with_colmask(tx, lsm, stmt->new_tuple,
-					   column_mask) != 0)
+		if (vy_tx_set_for_tuple(tx, lsm, stmt->new_tuple,
+					stmt->new_tuple, column_mask) != 0)
 			goto error;
 	}
 	tuple_unref(delete);
@@ -1908,7 +2154,8 @@ vy_insert_first_upsert(struct vy_env *env, struct vy_tx *tx,
 		return -1;
 	for (uint32_t i = 1; i < space->index_count; ++i) {
 		struct vy_lsm *lsm = vy_lsm(space->index[i]);
-		if (vy_tx_set(tx, lsm, stmt) != 0)
+		if (vy_tx_set_for_tuple(tx, lsm, stmt, stmt,
+					COLUMN_MASK_FULL) != 0)
 			return -1;
 	}
 	return 0;
@@ -2170,7 +2417,8 @@ vy_insert(struct vy_env *env, struct vy_tx *tx, struct txn_stmt *stmt,
 		struct vy_lsm *lsm = vy_lsm(space->index[iid]);
 		if (vy_is_committed_one(env, lsm))
 			continue;
-		if (vy_tx_set(tx, lsm, stmt->new_tuple) != 0)
+		if (vy_tx_set_for_tuple(tx, lsm, stmt->new_tuple,
+					stmt->new_tuple, COLUMN_MASK_FULL) != 0)
 			return -1;
 	}
 	return 0;
@@ -2219,9 +2467,11 @@ vy_replace(struct vy_env *env, struct vy_tx *tx, struct txn_stmt *stmt,
 	/*
 	 * Get the overwritten tuple from the primary index if
 	 * the space has on_replace triggers, in which case we
-	 * need to pass the old tuple to trigger callbacks.
+	 * need to pass the old tuple to trigger callbacks, or
+	 * a functional index, see vy_space_has_func_index().
 	 */
-	if (!rlist_empty(&space->on_replace)) {
+	if (!rlist_empty(&space->on_replace) ||
+	    vy_space_has_func_index(space)) {
 		if (vy_get(pk, tx, vy_tx_read_view(tx),
 			   stmt->new_tuple, &stmt->old_tuple) != 0)
 			return -1;
@@ -2260,11 +2510,14 @@ vy_replace(struct vy_env *env, struct vy_tx *tx, struct txn_stmt *stmt,
 		if (vy_is_committed_one(env, lsm))
 			continue;
 		if (delete != NULL) {
-			rc = vy_tx_set(tx, lsm, delete);
+			rc = vy_tx_set_for_tuple(tx, lsm, delete,
+						 stmt->old_tuple,
+						 COLUMN_MASK_FULL);
 			if (rc != 0)
 				break;
 		}
-		rc = vy_tx_set(tx, lsm, stmt->new_tuple);
+		rc = vy_tx_set_for_tuple(tx, lsm, stmt->new_tuple,
+					 stmt->new_tuple, COLUMN_MASK_FULL);
 		if (rc != 0)
 			break;
 	}
@@ -2327,6 +2580,15 @@ vinyl_space_execute_upsert(struct space *space, struct txn *txn,
 	return vy_upsert(env, tx, stmt, space, request);
 }
 
+static int
+vinyl_space_execute_delete_range(struct space *space, struct txn *txn,
+				 struct request *request)
+{
+	struct vy_env *env = vy_env(space->engine);
+	struct vy_tx *tx = txn->engine_tx;
+	return vy_delete_range(env, tx, space, request);
+}
+
 static int
 vinyl_engine_begin(struct engine *engine, struct txn *txn)
 {
@@ -2655,6 +2917,19 @@ vinyl_engine_set_cache(struct vinyl_engine *vinyl, size_t quota)
 	vy_cache_env_set_quota(&vinyl->env->cache_env, quota);
 }
 
+void
+vinyl_engine_set_io_uring(struct vinyl_engine *vinyl, bool enable,
+			  bool direct)
+{
+	vy_run_env_set_io_uring(&vinyl->env->run_env, enable, direct);
+}
+
+void
+vinyl_engine_set_page_cache(struct vinyl_engine *vinyl, size_t quota)
+{
+	vy_run_env_set_page_cache(&vinyl->env->run_env, quota);
+}
+
 int
 vinyl_engine_set_memory(struct vinyl_engine *vinyl, size_t size)
 {
@@ -2940,7 +3215,8 @@ vy_prepare_send_slice(struct vy_join_ctx *ctx,
 	run = vy_run_new(&ctx->env->run_env, slice_info->run->id);
 	if (run == NULL)
 		goto out;
-	if (vy_run_recover(run, ctx->env->path, ctx->space_id, 0) != 0)
+	if (vy_run_recover(run, ctx->env->path, ctx->space_id, 0,
+			   ctx->env->lsm_env.key_format) != 0)
 		goto out;
 
 	if (slice_info->begin != NULL) {
@@ -3082,7 +3358,7 @@ vy_send_lsm(struct vy_join_ctx *ctx, struct vy_lsm_recovery_info *lsm_info)
 
 	/* Create key definition and tuple format. */
 	ctx->key_def = key_def_new(lsm_info->key_parts,
-				   lsm_info->key_part_count);
+				   lsm_info->key_part_count, false);
 	if (ctx->key_def == NULL)
 		goto out;
 	ctx->format = vy_stmt_format_new(&ctx->env->stmt_env, &ctx->key_def, 1,
@@ -3883,6 +4159,257 @@ vinyl_index_get(struct index *index, const char *key,
 	return 0;
 }
 
+/**
+ * Max number of fibers used by vinyl_index_get_many() to look up
+ * keys in parallel, including the calling fiber.
+ */
+enum { VY_GET_MANY_FIBERS = 16 };
+
+/** Key looked up by vinyl_index_get_many(). */
+struct vy_get_many_entry {
+	/** Key statement. */
+	struct tuple *key;
+	/** Definition used for sorting keys. */
+	struct key_def *key_def;
+	/** Position of the key in the request. */
+	uint32_t pos;
+	/** Set if the key is equal to the previous one. */
+	bool is_dup;
+	/** Found tuple, referenced. */
+	struct tuple *result;
+};
+
+/** State shared by fibers executing vinyl_index_get_many(). */
+struct vy_get_many_ctx {
+	struct vy_lsm *lsm;
+	struct vy_tx *tx;
+	const struct vy_read_view **rv;
+	/** Keys sorted in the index order. */
+	struct vy_get_many_entry *entries;
+	uint32_t entry_count;
+	/** Index of the next entry to look up. */
+	uint32_t next;
+	/** Set in case a lookup failed. */
+	bool is_failed;
+	/** Container for storing errors. */
+	struct diag diag;
+};
+
+static int
+vy_get_many_entry_cmp(const void *a_raw, const void *b_raw)
+{
+	const struct vy_get_many_entry *a = a_raw;
+	const struct vy_get_many_entry *b = b_raw;
+	int rc = vy_stmt_compare(a->key, b->key, a->key_def);
+	if (rc != 0)
+		return rc;
+	/* Keep duplicates in the request order. */
+	return a->pos < b->pos ? -1 : a->pos > b->pos;
+}
+
+/**
+ * Look up full keys with a single batched point lookup, see
+ * vy_point_lookup_many(), which checks bloom filters of each
+ * run for all keys at once and reads each page only once.
+ */
+static int
+vy_get_many_batch(struct vy_get_many_ctx *ctx)
+{
+	struct vy_lsm *lsm = ctx->lsm;
+	struct region *region = &fiber()->gc;
+	size_t size = ctx->entry_count * (sizeof(struct tuple *) * 2 +
+					  sizeof(struct vy_get_many_entry *));
+	struct tuple **keys = region_alloc(region, size);
+	if (keys == NULL) {
+		diag_set(OutOfMemory, size, "region", "keys");
+		return -1;
+	}
+	struct tuple **results = keys + ctx->entry_count;
+	struct vy_get_many_entry **entries =
+		(struct vy_get_many_entry **)(results + ctx->entry_count);
+	uint32_t key_count = 0;
+	for (uint32_t i = 0; i < ctx->entry_count; i++) {
+		struct vy_get_many_entry *entry = &ctx->entries[i];
+		if (entry->is_dup)
+			continue;
+		if (ctx->tx != NULL &&
+		    vy_tx_track_point(ctx->tx, lsm, entry->key) != 0)
+			return -1;
+		keys[key_count] = entry->key;
+		entries[key_count] = entry;
+		key_count++;
+	}
+	if (vy_point_lookup_many(lsm, ctx->tx, ctx->rv, keys, key_count,
+				 results) != 0)
+		return -1;
+	int rc = 0;
+	for (uint32_t i = 0; i < key_count; i++) {
+		struct tuple *tuple = results[i];
+		struct vy_get_many_entry *entry = entries[i];
+		if (rc == 0 && lsm->index_id > 0 && tuple != NULL) {
+			rc = vy_get_by_secondary_tuple(lsm, ctx->tx, ctx->rv,
+						       tuple, &entry->result);
+			tuple_unref(tuple);
+		} else if (rc == 0) {
+			entry->result = tuple;
+		} else if (tuple != NULL) {
+			tuple_unref(tuple);
+		}
+		if (rc == 0 && (*ctx->rv)->vlsn == INT64_MAX)
+			vy_cache_add(&lsm->cache, entry->result, NULL,
+				     entry->key, ITER_EQ);
+	}
+	return rc;
+}
+
+/**
+ * Look up keys one by one until there are no keys left.
+ * Executed by the calling fiber and helper fibers so that
+ * disk reads issued for different keys overlap. Used for
+ * keys that lack primary key parts and so can't be looked
+ * up with vy_get_many_batch().
+ */
+static void
+vy_get_many_run(struct vy_get_many_ctx *ctx)
+{
+	while (!ctx->is_failed && ctx->next < ctx->entry_count) {
+		struct vy_get_many_entry *entry = &ctx->entries[ctx->next++];
+		if (entry->is_dup)
+			continue;
+		if (vy_get(ctx->lsm, ctx->tx, ctx->rv, entry->key,
+			   &entry->result) != 0) {
+			if (!ctx->is_failed) {
+				ctx->is_failed = true;
+				diag_move(diag_get(), &ctx->diag);
+			}
+			break;
+		}
+	}
+}
+
+static int
+vy_get_many_f(va_list ap)
+{
+	struct vy_get_many_ctx *ctx = va_arg(ap, struct vy_get_many_ctx *);
+	vy_get_many_run(ctx);
+	return 0;
+}
+
+static int
+vinyl_index_get_many(struct index *index, const char **keys,
+		     uint32_t key_count, uint32_t part_count,
+		     struct tuple **results)
+{
+	assert(index->def->opts.is_unique);
+	assert(index->def->key_def->part_count == part_count);
+
+	struct vy_lsm *lsm = vy_lsm(index);
+	struct vy_env *env = vy_env(index->engine);
+	struct vy_tx *tx = in_txn() ? in_txn()->engine_tx : NULL;
+	const struct vy_read_view **rv = (tx != NULL ? vy_tx_read_view(tx) :
+					  &env->xm->p_global_read_view);
+
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	size_t size = key_count * sizeof(struct vy_get_many_entry);
+	struct vy_get_many_entry *entries = region_alloc(region, size);
+	if (entries == NULL) {
+		diag_set(OutOfMemory, size, "region", "entries");
+		return -1;
+	}
+	struct vy_get_many_ctx ctx;
+	ctx.lsm = lsm;
+	ctx.tx = tx;
+	ctx.rv = rv;
+	ctx.entries = entries;
+	ctx.entry_count = 0;
+	ctx.next = 0;
+	ctx.is_failed = false;
+	diag_create(&ctx.diag);
+
+	int rc = -1;
+	for (uint32_t i = 0; i < key_count; i++) {
+		struct vy_get_many_entry *entry = &entries[i];
+		entry->key = vy_key_new(lsm->env->key_format, keys[i],
+					part_count);
+		if (entry->key == NULL)
+			goto out;
+		entry->key_def = lsm->key_def;
+		entry->pos = i;
+		entry->is_dup = false;
+		entry->result = NULL;
+		ctx.entry_count++;
+	}
+	/*
+	 * Look up keys in the index order so that neighbouring
+	 * keys are likely to share ranges, pages and cache
+	 * entries. Equal keys are looked up only once.
+	 */
+	qsort(entries, key_count, sizeof(*entries), vy_get_many_entry_cmp);
+	uint32_t unique_count = 1;
+	for (uint32_t i = 1; i < key_count; i++) {
+		if (vy_stmt_compare(entries[i - 1].key, entries[i].key,
+				    lsm->key_def) == 0)
+			entries[i].is_dup = true;
+		else
+			unique_count++;
+	}
+	if (key_count > 0 &&
+	    vy_stmt_is_full_key(entries[0].key, lsm->cmp_def)) {
+		if (vy_get_many_batch(&ctx) != 0)
+			goto out;
+		goto done;
+	}
+	/*
+	 * Keys of a unique secondary index lack primary key parts
+	 * and have to be looked up with the read iterator, which
+	 * yields while waiting for disk reads, so spread the keys
+	 * among several fibers to keep reader threads busy.
+	 */
+	struct fiber *fibers[VY_GET_MANY_FIBERS - 1];
+	uint32_t fiber_count = MIN(unique_count,
+				  (uint32_t)VY_GET_MANY_FIBERS) - 1;
+	for (uint32_t i = 0; i < fiber_count; i++) {
+		fibers[i] = fiber_new("vinyl.get_many", vy_get_many_f);
+		if (fibers[i] == NULL) {
+			fiber_count = i;
+			ctx.is_failed = true;
+			diag_move(diag_get(), &ctx.diag);
+			break;
+		}
+		fiber_set_joinable(fibers[i], true);
+		fiber_start(fibers[i], &ctx);
+	}
+	vy_get_many_run(&ctx);
+	for (uint32_t i = 0; i < fiber_count; i++)
+		fiber_join(fibers[i]);
+	if (ctx.is_failed) {
+		diag_move(&ctx.diag, diag_get());
+		goto out;
+	}
+done:;
+	struct tuple *result = NULL;
+	for (uint32_t i = 0; i < key_count; i++) {
+		struct vy_get_many_entry *entry = &entries[i];
+		if (!entry->is_dup)
+			result = entry->result;
+		else if (result != NULL)
+			tuple_ref(result);
+		results[entry->pos] = result;
+		entry->result = NULL;
+	}
+	rc = 0;
+out:
+	for (uint32_t i = 0; i < ctx.entry_count; i++) {
+		if (entries[i].result != NULL)
+			tuple_unref(entries[i].result);
+		tuple_unref(entries[i].key);
+	}
+	diag_destroy(&ctx.diag);
+	region_truncate(region, region_svp);
+	return rc;
+}
+
 /*** }}} Cursor */
 
 /* {{{ Index build */
@@ -3905,6 +4432,38 @@ struct vy_build_ctx {
 	struct diag diag;
 };
 
+/**
+ * Extract the key of a tuple stored in a secondary index, i.e.
+ * the secondary key parts followed by the primary key parts.
+ */
+static struct tuple *
+vy_build_extract_key(struct vy_lsm *lsm, struct tuple *tuple)
+{
+	if (vy_lsm_is_func(lsm))
+		return vy_lsm_func_stmt_new(lsm, tuple, true);
+	return vy_stmt_extract_key(tuple, lsm->cmp_def, lsm->env->key_format);
+}
+
+/**
+ * Create an INSERT statement for a tuple that is inserted into
+ * the index that is being built. @a format is the format of
+ * the altered space.
+ */
+static struct tuple *
+vy_build_new_insert(struct vy_lsm *lsm, struct tuple_format *format,
+		    struct tuple *tuple)
+{
+	if (vy_lsm_is_func(lsm)) {
+		struct tuple *insert = vy_lsm_func_stmt_new(lsm, tuple, true);
+		if (insert != NULL)
+			vy_stmt_set_type(insert, IPROTO_INSERT);
+		return insert;
+	}
+	uint32_t data_len;
+	const char *data = tuple_data_range(tuple, &data_len);
+	return vy_stmt_new_insert(format, data, data + data_len);
+}
+
 /**
  * This is an on_replace trigger callback that forwards DML requests
  * to the index that is currently being built.
@@ -3936,8 +4495,8 @@ vy_build_on_replace(struct trigger *trigger, void *event)
 
 	/* Forward the statement to the new LSM tree. */
 	if (stmt->old_tuple != NULL) {
-		struct tuple *delete = vy_stmt_extract_key(stmt->old_tuple,
-					lsm->cmp_def, lsm->env->key_format);
+		struct tuple *delete = vy_build_extract_key(lsm,
+							    stmt->old_tuple);
 		if (delete == NULL)
 			goto err;
 		vy_stmt_set_type(delete, IPROTO_DELETE);
@@ -3947,10 +4506,8 @@ vy_build_on_replace(struct trigger *trigger, void *event)
 			goto err;
 	}
 	if (stmt->new_tuple != NULL) {
-		uint32_t data_len;
-		const char *data = tuple_data_range(stmt->new_tuple, &data_len);
-		struct tuple *insert = vy_stmt_new_insert(format, data,
-							  data + data_len);
+		struct tuple *insert = vy_build_new_insert(lsm, format,
+							   stmt->new_tuple);
 		if (insert == NULL)
 			goto err;
 		int rc = vy_tx_set(tx, lsm, insert);
@@ -4008,6 +4565,16 @@ vy_build_insert_tuple(struct vy_env *env, struct vy_lsm *lsm,
 						 data + data_len);
 	if (stmt == NULL)
 		return -1;
+	/* A functional index stores keys, not tuples. */
+	struct tuple *index_stmt = stmt;
+	if (vy_lsm_is_func(lsm)) {
+		index_stmt = vy_lsm_func_stmt_new(lsm, stmt, true);
+		if (index_stmt == NULL) {
+			tuple_unref(stmt);
+			return -1;
+		}
+		vy_stmt_set_type(index_stmt, IPROTO_REPLACE);
+	}
 
 	/*
 	 * Check unique constraint if necessary.
@@ -4033,13 +4600,17 @@ vy_build_insert_tuple(struct vy_env *env, struct vy_lsm *lsm,
 					  space_name, index_name, lsm, stmt);
 	vy_mem_unpin(mem);
 	if (rc != 0) {
+		if (index_stmt != stmt)
+			tuple_unref(index_stmt);
 		tuple_unref(stmt);
 		return -1;
 	}
 
 	/* Insert the new tuple into the in-memory index. */
 	size_t mem_used_before = lsregion_used(&env->mem_env.allocator);
-	rc = vy_build_insert_stmt(lsm, mem, stmt, lsn);
+	rc = vy_build_insert_stmt(lsm, mem, index_stmt, lsn);
+	if (index_stmt != stmt)
+		tuple_unref(index_stmt);
 	tuple_unref(stmt);
 
 	/* Consume memory quota. Throttle if it is exceeded. */
@@ -4078,18 +4649,15 @@ vy_build_recover_stmt(struct vy_lsm *lsm, struct vy_lsm *pk,
 	struct tuple *delete = NULL;
 	struct tuple *insert = NULL;
 	if (old_tuple != NULL) {
-		delete = vy_stmt_extract_key(old_tuple, lsm->cmp_def,
-					     lsm->env->key_format);
+		delete = vy_build_extract_key(lsm, old_tuple);
 		if (delete == NULL)
 			return -1;
 		vy_stmt_set_type(delete, IPROTO_DELETE);
 	}
 	enum iproto_type type = vy_stmt_type(mem_stmt);
 	if (type == IPROTO_REPLACE || type == IPROTO_INSERT) {
-		uint32_t data_len;
-		const char *data = tuple_data_range(mem_stmt, &data_len);
-		insert = vy_stmt_new_insert(lsm->mem_format,
-					    data, data + data_len);
+		insert = vy_build_new_insert(lsm, lsm->mem_format,
+					     (struct tuple *)mem_stmt);
 		if (insert == NULL)
 			return -1;
 	} else if (type == IPROTO_UPSERT) {
@@ -4097,10 +4665,7 @@ vy_build_recover_stmt(struct vy_lsm *lsm, struct vy_lsm *pk,
 							  pk->cmp_def, true);
 		if (new_tuple == NULL)
 			return -1;
-		uint32_t data_len;
-		const char *data = tuple_data_range(new_tuple, &data_len);
-		insert = vy_stmt_new_insert(lsm->mem_format,
-					    data, data + data_len);
+		insert = vy_build_new_insert(lsm, lsm->mem_format, new_tuple);
 		tuple_unref(new_tuple);
 		if (insert == NULL)
 			return -1;
@@ -4416,6 +4981,15 @@ vy_deferred_delete_on_replace(struct trigger *trigger, void *event)
 		struct vy_lsm *lsm = vy_lsm(space->index[i]);
 		if (vy_is_committed_one(env, lsm))
 			continue;
+		/*
+		 * A deferred DELETE lacks fields needed to compute
+		 * a functional key. It was generated for a tuple
+		 * overwritten before the functional index was built
+		 * anyway, because a space with a functional index
+		 * doesn't defer DELETEs, so the tuple isn't there.
+		 */
+		if (vy_lsm_is_func(lsm))
+			continue;
 		/*
 		 * As usual, rotate the active in-memory index if
 		 * schema was changed or dump was triggered. Do it
@@ -4522,6 +5096,7 @@ static const struct space_vtab vinyl_space_vtab = {
 	/* .execute_delete = */ vinyl_space_execute_delete,
 	/* .execute_update = */ vinyl_space_execute_update,
 	/* .execute_upsert = */ vinyl_space_execute_upsert,
+	/* .execute_delete_range = */ vinyl_space_execute_delete_range,
 	/* .ephemeral_replace = */ generic_space_ephemeral_replace,
 	/* .ephemeral_delete = */ generic_space_ephemeral_delete,
 	/* .ephemeral_rowid_next = */ generic_space_ephemeral_rowid_next,
@@ -4554,6 +5129,7 @@ static const struct index_vtab vinyl_index_vtab = {
 	/* .random = */ generic_index_random,
 	/* .count = */ generic_index_count,
 	/* .get = */ vinyl_index_get,
+	/* .get_many = */ vinyl_index_get_many,
 	/* .replace = */ generic_index_replace,
 	/* .create_iterator = */ vinyl_index_create_iterator,
 	/* .create_snapshot_iterator = */
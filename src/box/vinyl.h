@@ -57,6 +57,20 @@ vinyl_engine_stat(struct vinyl_engine *vinyl, struct info_handler *handler);
 void
 vinyl_engine_set_cache(struct vinyl_engine *vinyl, size_t quota);
 
+/**
+ * Make vinyl use io_uring for reading runs, with O_DIRECT if
+ * @a direct is set. Must be called before recovery.
+ */
+void
+vinyl_engine_set_io_uring(struct vinyl_engine *vinyl, bool enable,
+			  bool direct);
+
+/**
+ * Update vinyl page cache size.
+ */
+void
+vinyl_engine_set_page_cache(struct vinyl_engine *vinyl, size_t quota);
+
 /**
  * Update vinyl memory size.
  */
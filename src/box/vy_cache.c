@@ -429,10 +429,37 @@ vy_cache_get(struct vy_cache *cache, const struct tuple *key)
 	return (*entry)->stmt;
 }
 
+/**
+ * Invalidate all cached statements covered by a DELETE_RANGE.
+ */
+static void
+vy_cache_on_range_delete(struct vy_cache *cache, const struct tuple *stmt)
+{
+	assert(vy_stmt_type(stmt) == IPROTO_DELETE_RANGE);
+	while (true) {
+		struct vy_cache_tree_iterator itr;
+		itr = vy_cache_tree_lower_bound(&cache->cache_tree,
+						stmt, NULL);
+		struct vy_cache_entry **entry =
+			vy_cache_tree_iterator_get_elem(&cache->cache_tree,
+							&itr);
+		if (entry == NULL ||
+		    !vy_stmt_is_covered((*entry)->stmt, stmt,
+					cache->cmp_def))
+			break;
+		vy_cache_on_write(cache, (*entry)->stmt, NULL);
+	}
+}
+
 void
 vy_cache_on_write(struct vy_cache *cache, const struct tuple *stmt,
 		  struct tuple **deleted)
 {
+	if (vy_stmt_type(stmt) == IPROTO_DELETE_RANGE) {
+		assert(deleted == NULL);
+		vy_cache_on_range_delete(cache, stmt);
+		return;
+	}
 	vy_cache_gc(cache->env);
 	bool exact = false;
 	struct vy_cache_tree_iterator itr;
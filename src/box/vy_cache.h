@@ -213,7 +213,8 @@ struct tuple *
 vy_cache_get(struct vy_cache *cache, const struct tuple *key);
 
 /**
- * Invalidate possibly cached value due to its overwriting
+ * Invalidate possibly cached value due to its overwriting.
+ * A DELETE_RANGE statement invalidates all values it covers.
  * @param cache - pointer to tuple cache.
  * @param stmt - overwritten statement.
  * @param[out] deleted - If not NULL, then is set to deleted
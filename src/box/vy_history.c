@@ -60,6 +60,38 @@ vy_history_append_stmt(struct vy_history *history, struct tuple *stmt)
 	return 0;
 }
 
+int
+vy_history_apply_range_delete(struct vy_history *history,
+			      const struct tuple *key,
+			      const struct tuple *range_delete,
+			      struct key_def *cmp_def)
+{
+	/*
+	 * Create the DELETE before trimming the history, because
+	 * the key may be one of the statements stored in it.
+	 */
+	struct tuple *delete_stmt = vy_stmt_new_covered_delete(key,
+						range_delete, cmp_def);
+	if (delete_stmt == NULL)
+		return -1;
+	int64_t lsn = vy_stmt_lsn(range_delete);
+	while (!rlist_empty(&history->stmts)) {
+		struct vy_history_node *node = rlist_last_entry(
+				&history->stmts, struct vy_history_node, link);
+		if (vy_stmt_lsn(node->stmt) >= lsn)
+			break;
+		rlist_del_entry(node, link);
+		if (node->is_refable)
+			tuple_unref(node->stmt);
+		mempool_free(history->pool, node);
+	}
+	int rc = 0;
+	if (!vy_history_is_terminal(history))
+		rc = vy_history_append_stmt(history, delete_stmt);
+	tuple_unref(delete_stmt);
+	return rc;
+}
+
 void
 vy_history_cleanup(struct vy_history *history)
 {
@@ -141,6 +141,20 @@ vy_history_splice(struct vy_history *dst, struct vy_history *src)
 int
 vy_history_append_stmt(struct vy_history *history, struct tuple *stmt);
 
+/**
+ * Apply a DELETE_RANGE statement covering the key of @key
+ * to a history list: drop all statements older than the
+ * range deletion and, unless the history is terminal after
+ * that, append a DELETE for the key (see
+ * vy_stmt_new_covered_delete()).
+ * Returns 0 on success, -1 on memory allocation error.
+ */
+int
+vy_history_apply_range_delete(struct vy_history *history,
+			      const struct tuple *key,
+			      const struct tuple *range_delete,
+			      struct key_def *cmp_def);
+
 /**
  * Release all statements stored in the given history and
  * reinitialize the history list.
@@ -39,6 +39,8 @@
 
 #include "diag.h"
 #include "errcode.h"
+#include "fiber.h"
+#include "func_key.h"
 #include "histogram.h"
 #include "index_def.h"
 #include "say.h"
@@ -147,6 +149,10 @@ vy_lsm_new(struct vy_lsm_env *lsm_env, struct vy_cache_env *cache_env,
 
 	lsm->cmp_def = cmp_def;
 	lsm->key_def = key_def;
+	if (vy_lsm_is_func(lsm)) {
+		/* See the comment to vy_lsm::mem_format. */
+		format = lsm_env->key_format;
+	}
 	if (index_def->iid == 0) {
 		/*
 		 * Disk tuples can be returned to an user from a
@@ -229,6 +235,44 @@ fail:
 	return NULL;
 }
 
+struct tuple *
+vy_lsm_func_stmt_new(struct vy_lsm *lsm, struct tuple *tuple, bool with_pk)
+{
+	assert(vy_lsm_is_func(lsm));
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	struct tuple *stmt = NULL;
+	uint32_t key_size;
+	const char *key = func_key_extract(lsm->key_def, lsm->opts.func_id,
+					   vy_lsm_name(lsm), tuple, &key_size);
+	if (key == NULL)
+		goto out;
+	const char *key_end = key + key_size;
+	uint32_t part_count = mp_decode_array(&key);
+	if (!with_pk) {
+		stmt = vy_key_new(lsm->env->key_format, key, part_count);
+		goto out;
+	}
+	uint32_t pk_size;
+	const char *pk = tuple_extract_key(tuple, lsm->pk->key_def, &pk_size);
+	if (pk == NULL)
+		goto out;
+	const char *pk_end = pk + pk_size;
+	part_count += mp_decode_array(&pk);
+	size_t size = (key_end - key) + (pk_end - pk);
+	char *data = region_alloc(region, size);
+	if (data == NULL) {
+		diag_set(OutOfMemory, size, "region", "data");
+		goto out;
+	}
+	memcpy(data, key, key_end - key);
+	memcpy(data + (key_end - key), pk, pk_end - pk);
+	stmt = vy_key_new(lsm->env->key_format, data, part_count);
+out:
+	region_truncate(region, region_svp);
+	return stmt;
+}
+
 static struct vy_range *
 vy_range_tree_free_cb(vy_range_tree_t *t, struct vy_range *range, void *arg)
 {
@@ -366,12 +410,14 @@ vy_lsm_recover_run(struct vy_lsm *lsm, struct vy_run_recovery_info *run_info,
 	run->dump_lsn = run_info->dump_lsn;
 	run->dump_count = run_info->dump_count;
 	if (vy_run_recover(run, lsm->env->path,
-			   lsm->space_id, lsm->index_id) != 0 &&
+			   lsm->space_id, lsm->index_id,
+			   lsm->env->key_format) != 0 &&
 	    (!force_recovery ||
 	     vy_run_rebuild_index(run, lsm->env->path,
 				  lsm->space_id, lsm->index_id,
 				  lsm->cmp_def, lsm->key_def,
-				  lsm->disk_format, &lsm->opts) != 0)) {
+				  lsm->disk_format, lsm->env->key_format,
+				  &lsm->opts) != 0)) {
 		vy_run_unref(run);
 		return NULL;
 	}
@@ -904,6 +950,8 @@ vy_lsm_set(struct vy_lsm *lsm, struct vy_mem *mem,
 		diag_set(ClientError, ER_TRANSACTION_CONFLICT);
 		return -1;
 	}
+	if (vy_stmt_type(*region_stmt) == IPROTO_DELETE_RANGE)
+		return vy_mem_insert_range_delete(mem, *region_stmt);
 	if (vy_stmt_type(*region_stmt) != IPROTO_UPSERT)
 		return vy_mem_insert(mem, *region_stmt);
 	else
@@ -983,10 +1031,13 @@ vy_lsm_commit_upsert(struct vy_lsm *lsm, struct vy_mem *mem,
 
 	/*
 	 * If there are no other mems and runs and n_upserts == 0,
-	 * then we can turn the UPSERT into the REPLACE.
+	 * then we can turn the UPSERT into the REPLACE. Note, we
+	 * can't do that if the older statement may be covered by
+	 * a range deletion.
 	 */
 	if (n_upserts == 0 &&
 	    lsm->stat.memory.count.rows == lsm->mem->count.rows &&
+	    lsm->mem->range_delete_count == 0 &&
 	    lsm->run_count == 0) {
 		older = vy_mem_older_lsn(mem, stmt);
 		assert(older == NULL || vy_stmt_type(older) != IPROTO_UPSERT);
@@ -1044,7 +1095,9 @@ vy_lsm_commit_stmt(struct vy_lsm *lsm, struct vy_mem *mem,
 {
 	vy_mem_commit_stmt(mem, stmt);
 
-	lsm->stat.memory.count.rows++;
+	/* Range deletions aren't stored in the tree. */
+	if (vy_stmt_type(stmt) != IPROTO_DELETE_RANGE)
+		lsm->stat.memory.count.rows++;
 
 	if (vy_stmt_type(stmt) == IPROTO_UPSERT)
 		vy_lsm_commit_upsert(lsm, mem, stmt);
@@ -226,7 +226,13 @@ struct vy_lsm {
 	 * tuples.
 	 */
 	struct tuple_format *disk_format;
-	/** Tuple format of the space this LSM tree belongs to. */
+	/**
+	 * Tuple format of the space this LSM tree belongs to.
+	 * An LSM tree of a functional index stores keys computed
+	 * by the index function rather than tuples so it uses
+	 * the key format for in-memory statements as well, see
+	 * vy_lsm_func_stmt_new().
+	 */
 	struct tuple_format *mem_format;
 	/**
 	 * If this LSM tree is for a secondary index, the following
@@ -347,6 +353,32 @@ vy_lsm_new(struct vy_lsm_env *lsm_env, struct vy_cache_env *cache_env,
 void
 vy_lsm_delete(struct vy_lsm *lsm);
 
+/** Return true if an LSM tree is for a functional index. */
+static inline bool
+vy_lsm_is_func(struct vy_lsm *lsm)
+{
+	return lsm->key_def->for_func_index;
+}
+
+/**
+ * Create a statement for a functional index LSM tree.
+ *
+ * Statements of a functional index are key statements that
+ * consist of the key returned by the index function for
+ * @a tuple followed by the primary key parts of @a tuple,
+ * so they are compared by the index cmp_def as they are.
+ * If @a with_pk is unset, only the functional key is returned,
+ * which is suitable for lookups.
+ *
+ * The statement type isn't set, the caller is supposed to
+ * set it with vy_stmt_set_type() if necessary.
+ *
+ * @retval not NULL Key statement.
+ * @retval NULL Memory error or the index function failed.
+ */
+struct tuple *
+vy_lsm_func_stmt_new(struct vy_lsm *lsm, struct tuple *tuple, bool with_pk);
+
 /**
  * Return true if the LSM tree has no statements, neither on disk
  * nor in memory.
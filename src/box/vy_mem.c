@@ -31,6 +31,7 @@
 #include "vy_mem.h"
 
 #include <stdlib.h>
+#include <string.h>
 
 #include <trivia/util.h>
 #include <small/lsregion.h>
@@ -54,7 +55,7 @@ vy_mem_env_create(struct vy_mem_env *env, size_t memory)
 	/* Vinyl memory is limited by vy_quota. */
 	quota_init(&env->quota, QUOTA_MAX);
 	tuple_arena_create(&env->arena, &env->quota, memory,
-			   SLAB_SIZE, "vinyl");
+			   SLAB_SIZE, NULL, "vinyl");
 	lsregion_create(&env->allocator, &env->arena);
 	env->tree_extent_size = 0;
 }
@@ -125,6 +126,7 @@ void
 vy_mem_delete(struct vy_mem *index)
 {
 	index->env->tree_extent_size -= index->tree_extent_size;
+	free(index->range_deletes);
 	tuple_format_unref(index->format);
 	fiber_cond_destroy(&index->pin_cond);
 	TRASH(index);
@@ -234,6 +236,35 @@ vy_mem_insert(struct vy_mem *mem, const struct tuple *stmt)
 	return 0;
 }
 
+int
+vy_mem_insert_range_delete(struct vy_mem *mem, const struct tuple *stmt)
+{
+	assert(vy_stmt_type(stmt) == IPROTO_DELETE_RANGE);
+	/* The statement must be from a lsregion. */
+	assert(!vy_stmt_is_refable(stmt));
+	if (mem->range_delete_count == mem->range_delete_capacity) {
+		uint32_t capacity = MAX(mem->range_delete_capacity * 2, 8U);
+		size_t size = capacity * sizeof(*mem->range_deletes);
+		const struct tuple **range_deletes = realloc(
+				mem->range_deletes, size);
+		if (range_deletes == NULL) {
+			diag_set(OutOfMemory, size, "realloc",
+				 "range deletes");
+			return -1;
+		}
+		mem->range_deletes = range_deletes;
+		mem->range_delete_capacity = capacity;
+	}
+	mem->range_deletes[mem->range_delete_count++] = stmt;
+	mem->count.bytes += tuple_size(stmt);
+	/*
+	 * All iterators must recheck the statements they are
+	 * positioned at, because they may be covered now.
+	 */
+	mem->version++;
+	return 0;
+}
+
 void
 vy_mem_commit_stmt(struct vy_mem *mem, const struct tuple *stmt)
 {
@@ -261,6 +292,18 @@ vy_mem_rollback_stmt(struct vy_mem *mem, const struct tuple *stmt)
 {
 	/* This is the statement we've inserted before. */
 	assert(!vy_stmt_is_refable(stmt));
+	if (vy_stmt_type(stmt) == IPROTO_DELETE_RANGE) {
+		uint32_t i = mem->range_delete_count;
+		while (i > 0 && mem->range_deletes[i - 1] != stmt)
+			i--;
+		assert(i > 0);
+		memmove(&mem->range_deletes[i - 1], &mem->range_deletes[i],
+			(mem->range_delete_count - i) *
+			sizeof(*mem->range_deletes));
+		mem->range_delete_count--;
+		mem->version++;
+		return;
+	}
 	int rc = vy_mem_tree_delete(&mem->tree, stmt);
 	assert(rc == 0);
 	(void) rc;
@@ -166,6 +166,18 @@ struct vy_mem {
 	size_t tree_extent_size;
 	/** Number of statements. */
 	struct vy_stmt_counter count;
+	/**
+	 * DELETE_RANGE statements inserted into this in-memory
+	 * index, in order of insertion. They are not stored in
+	 * the tree, because they don't have a key of their own.
+	 * Instead, readers check if a statement returned by the
+	 * tree is covered by any of them.
+	 */
+	const struct tuple **range_deletes;
+	/** Number of DELETE_RANGE statements. */
+	uint32_t range_delete_count;
+	/** Number of allocated entries in @range_deletes. */
+	uint32_t range_delete_capacity;
 	/**
 	 * Max LSN covered by this in-memory tree.
 	 *
@@ -301,6 +313,43 @@ vy_mem_insert(struct vy_mem *mem, const struct tuple *stmt);
 int
 vy_mem_insert_upsert(struct vy_mem *mem, const struct tuple *stmt);
 
+/**
+ * Insert a DELETE_RANGE statement into the mem.
+ *
+ * @param mem Mem to insert to.
+ * @param stmt DELETE_RANGE statement to insert.
+ *
+ * @retval  0 Success.
+ * @retval -1 Memory error.
+ */
+int
+vy_mem_insert_range_delete(struct vy_mem *mem, const struct tuple *stmt);
+
+/**
+ * Return the newest DELETE_RANGE statement visible from read
+ * view @vlsn that covers @stmt or NULL if there's no such one.
+ */
+static inline const struct tuple *
+vy_mem_find_range_delete(struct vy_mem *mem, const struct tuple *stmt,
+			 int64_t vlsn)
+{
+	if (mem->range_delete_count == 0)
+		return NULL;
+	return vy_stmt_find_range_delete(mem->range_deletes,
+					 mem->range_delete_count,
+					 stmt, vlsn, mem->cmp_def);
+}
+
+/**
+ * Return true if the in-memory level doesn't store
+ * any statements.
+ */
+static inline bool
+vy_mem_is_empty(struct vy_mem *mem)
+{
+	return mem->tree.size == 0 && mem->range_delete_count == 0;
+}
+
 /**
  * Confirm insertion of a statement into the in-memory level.
  * @param mem        vy_mem.
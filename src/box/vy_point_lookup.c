@@ -61,11 +61,25 @@ vy_point_lookup_scan_txw(struct vy_lsm *lsm, struct vy_tx *tx,
 	struct txv *txv =
 		write_set_search_key(&tx->write_set, lsm, key);
 	assert(txv == NULL || txv->lsm == lsm);
-	if (txv == NULL)
+	if (txv != NULL) {
+		vy_stmt_counter_acct_tuple(&lsm->stat.txw.iterator.get,
+					   txv->stmt);
+		if (vy_history_append_stmt(history, txv->stmt) != 0)
+			return -1;
+		/*
+		 * A range deletion can't overwrite a statement
+		 * of the same transaction that is still in the
+		 * write set, see vy_tx_delete_range().
+		 */
+		if (vy_history_is_terminal(history))
+			return 0;
+	}
+	const struct tuple *range_delete =
+		vy_tx_find_range_delete(tx, lsm, key);
+	if (range_delete == NULL)
 		return 0;
-	vy_stmt_counter_acct_tuple(&lsm->stat.txw.iterator.get,
-				   txv->stmt);
-	return vy_history_append_stmt(history, txv->stmt);
+	return vy_history_apply_range_delete(history, key, range_delete,
+					     lsm->cmp_def);
 }
 
 /**
@@ -103,8 +117,19 @@ vy_point_lookup_scan_mem(struct vy_lsm *lsm, struct vy_mem *mem,
 	int rc = vy_mem_iterator_next(&mem_itr, &mem_history);
 	vy_history_splice(history, &mem_history);
 	vy_mem_iterator_close(&mem_itr);
-	return rc;
-
+	if (rc != 0)
+		return rc;
+	/*
+	 * Note, we must check range deletions even if the history
+	 * is terminal, because they may overwrite statements that
+	 * were found in the same mem.
+	 */
+	const struct tuple *range_delete =
+		vy_mem_find_range_delete(mem, key, (*rv)->vlsn);
+	if (range_delete == NULL)
+		return 0;
+	return vy_history_apply_range_delete(history, key, range_delete,
+					     lsm->cmp_def);
 }
 
 /**
@@ -150,7 +175,15 @@ vy_point_lookup_scan_slice(struct vy_lsm *lsm, struct vy_slice *slice,
 	int rc = vy_run_iterator_next(&run_itr, &slice_history);
 	vy_history_splice(history, &slice_history);
 	vy_run_iterator_close(&run_itr);
-	return rc;
+	if (rc != 0)
+		return rc;
+	const struct tuple *range_delete =
+		vy_run_find_range_delete(slice->run, key, (*rv)->vlsn,
+					 lsm->cmp_def);
+	if (range_delete == NULL)
+		return 0;
+	return vy_history_apply_range_delete(history, key, range_delete,
+					     lsm->cmp_def);
 }
 
 /**
@@ -296,6 +329,268 @@ done:
 	return 0;
 }
 
+/** State of a key looked up by vy_point_lookup_many(). */
+struct vy_point_lookup_entry {
+	/** Key to look up. */
+	struct tuple *key;
+	/** Statements found in txw and cache. */
+	struct vy_history history;
+	/** Statements found in mems. */
+	struct vy_history mem_history;
+	/** Statements found in runs. */
+	struct vy_history disk_history;
+	/** Set if the key doesn't need to be looked up on disk. */
+	bool is_done;
+};
+
+/**
+ * Scan slices for all keys that haven't been found in memory.
+ * Keys that fall in the same range are looked up together: for
+ * each slice of the range, bloom filters are checked for all
+ * keys first, then pages are read in order, see
+ * vy_slice_lookup_many(). The slices of a range are pinned
+ * before the first slice scan, just like in
+ * vy_point_lookup_scan_slices().
+ */
+static int
+vy_point_lookup_scan_slices_many(struct vy_lsm *lsm,
+				 const struct vy_read_view **rv,
+				 struct vy_point_lookup_entry *entries,
+				 uint32_t entry_count)
+{
+	struct region *region = &fiber()->gc;
+	size_t size = entry_count * (sizeof(struct tuple *) +
+				     sizeof(struct vy_history *));
+	struct tuple **keys = region_alloc(region, size);
+	if (keys == NULL) {
+		diag_set(OutOfMemory, size, "region", "keys array");
+		return -1;
+	}
+	struct vy_history **histories =
+		(struct vy_history **)(keys + entry_count);
+
+	uint32_t next = 0;
+	while (next < entry_count) {
+		if (entries[next].is_done) {
+			next++;
+			continue;
+		}
+		/* Collect keys stored in the same range. */
+		struct vy_range *range = vy_range_tree_find_by_key(
+			&lsm->range_tree, ITER_EQ, entries[next].key);
+		assert(range != NULL);
+		uint32_t begin = next;
+		while (next < entry_count &&
+		       (range->end == NULL ||
+			vy_stmt_compare(entries[next].key, range->end,
+					lsm->cmp_def) < 0))
+			next++;
+
+		int slice_count = range->slice_count;
+		size = slice_count * sizeof(struct vy_slice *);
+		struct vy_slice **slices = region_alloc(region, size);
+		if (slices == NULL) {
+			diag_set(OutOfMemory, size, "region", "slices array");
+			return -1;
+		}
+		int i = 0;
+		struct vy_slice *slice;
+		rlist_foreach_entry(slice, &range->slices, in_range) {
+			vy_slice_pin(slice);
+			slices[i++] = slice;
+		}
+		assert(i == slice_count);
+		int rc = 0;
+		for (i = 0; i < slice_count; i++) {
+			slice = slices[i];
+			uint32_t key_count = 0;
+			for (uint32_t j = begin; rc == 0 && j < next; j++) {
+				struct vy_point_lookup_entry *e = &entries[j];
+				if (e->is_done ||
+				    vy_history_is_terminal(&e->disk_history))
+					continue;
+				keys[key_count] = e->key;
+				histories[key_count] = &e->disk_history;
+				key_count++;
+			}
+			if (rc == 0)
+				rc = vy_slice_lookup_many(slice,
+						&lsm->stat.disk.iterator, rv,
+						lsm->cmp_def, lsm->key_def,
+						lsm->disk_format, keys,
+						histories, key_count);
+			for (uint32_t j = 0; rc == 0 && j < key_count; j++) {
+				const struct tuple *range_delete =
+					vy_run_find_range_delete(slice->run,
+							keys[j], (*rv)->vlsn,
+							lsm->cmp_def);
+				if (range_delete != NULL)
+					rc = vy_history_apply_range_delete(
+						histories[j], keys[j],
+						range_delete, lsm->cmp_def);
+			}
+			vy_slice_unpin(slice);
+		}
+		if (rc != 0)
+			return -1;
+	}
+	return 0;
+}
+
+int
+vy_point_lookup_many(struct vy_lsm *lsm, struct vy_tx *tx,
+		     const struct vy_read_view **rv, struct tuple **keys,
+		     uint32_t key_count, struct tuple **results)
+{
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	size_t size = key_count * sizeof(struct vy_point_lookup_entry);
+	struct vy_point_lookup_entry *entries = region_alloc(region, size);
+	if (entries == NULL) {
+		diag_set(OutOfMemory, size, "region", "entries");
+		return -1;
+	}
+	double start_time = ev_monotonic_now(loop());
+	int rc = 0;
+	uint32_t i;
+
+	lsm->stat.lookup += key_count;
+
+	for (i = 0; i < key_count; i++) {
+		struct vy_point_lookup_entry *e = &entries[i];
+		/* All key parts must be set for a point lookup. */
+		assert(vy_stmt_is_full_key(keys[i], lsm->cmp_def));
+		assert(i == 0 || vy_stmt_compare(keys[i - 1], keys[i],
+						 lsm->cmp_def) < 0);
+		e->key = keys[i];
+		e->is_done = false;
+		vy_history_create(&e->history, &lsm->env->history_node_pool);
+		vy_history_create(&e->mem_history,
+				  &lsm->env->history_node_pool);
+		vy_history_create(&e->disk_history,
+				  &lsm->env->history_node_pool);
+		results[i] = NULL;
+	}
+
+	for (i = 0; rc == 0 && i < key_count; i++) {
+		struct vy_point_lookup_entry *e = &entries[i];
+		rc = vy_point_lookup_scan_txw(lsm, tx, e->key, &e->history);
+		if (rc != 0 || vy_history_is_terminal(&e->history)) {
+			e->is_done = true;
+			continue;
+		}
+		rc = vy_point_lookup_scan_cache(lsm, rv, e->key, &e->history);
+		if (rc != 0 || vy_history_is_terminal(&e->history))
+			e->is_done = true;
+	}
+	if (rc != 0)
+		goto done;
+
+restart:
+	for (i = 0; rc == 0 && i < key_count; i++) {
+		struct vy_point_lookup_entry *e = &entries[i];
+		if (e->is_done)
+			continue;
+		rc = vy_point_lookup_scan_mems(lsm, rv, e->key,
+					       &e->mem_history);
+		if (rc != 0 || vy_history_is_terminal(&e->mem_history))
+			e->is_done = true;
+	}
+	if (rc != 0)
+		goto done;
+
+	/* Save version before yield */
+	uint32_t mem_version = lsm->mem->version;
+	uint32_t mem_list_version = lsm->mem_list_version;
+
+	rc = vy_point_lookup_scan_slices_many(lsm, rv, entries, key_count);
+	if (rc != 0)
+		goto done;
+
+	ERROR_INJECT(ERRINJ_VY_POINT_ITER_WAIT, {
+		while (mem_list_version == lsm->mem_list_version)
+			fiber_sleep(0.01);
+		/* Turn of the injection to avoid infinite loop */
+		errinj(ERRINJ_VY_POINT_ITER_WAIT, ERRINJ_BOOL)->bparam = false;
+	});
+
+	if (mem_list_version != lsm->mem_list_version) {
+		/*
+		 * Mem list was changed during yield, reread the
+		 * history of all keys, see vy_point_lookup().
+		 */
+		for (i = 0; i < key_count; i++) {
+			struct vy_point_lookup_entry *e = &entries[i];
+			if (vy_history_is_terminal(&e->history))
+				continue;
+			e->is_done = false;
+			vy_history_cleanup(&e->mem_history);
+			vy_history_cleanup(&e->disk_history);
+		}
+		goto restart;
+	}
+
+	if (mem_version != lsm->mem->version) {
+		/*
+		 * Rescan the memory level if its version changed
+		 * while we were reading disk, because there may be
+		 * new statements matching the search keys.
+		 */
+		for (i = 0; rc == 0 && i < key_count; i++) {
+			struct vy_point_lookup_entry *e = &entries[i];
+			if (vy_history_is_terminal(&e->history))
+				continue;
+			vy_history_cleanup(&e->mem_history);
+			rc = vy_point_lookup_scan_mems(lsm, rv, e->key,
+						       &e->mem_history);
+			if (rc == 0 &&
+			    vy_history_is_terminal(&e->mem_history))
+				vy_history_cleanup(&e->disk_history);
+		}
+	}
+
+done:
+	for (i = 0; i < key_count; i++) {
+		struct vy_point_lookup_entry *e = &entries[i];
+		vy_history_splice(&e->history, &e->mem_history);
+		vy_history_splice(&e->history, &e->disk_history);
+		if (rc == 0) {
+			int upserts_applied;
+			rc = vy_history_apply(&e->history, lsm->cmp_def,
+					      false, &upserts_applied,
+					      &results[i]);
+			lsm->stat.upsert.applied += upserts_applied;
+		}
+		vy_history_cleanup(&e->history);
+	}
+	region_truncate(region, region_svp);
+
+	if (rc != 0) {
+		for (i = 0; i < key_count; i++) {
+			if (results[i] != NULL)
+				tuple_unref(results[i]);
+			results[i] = NULL;
+		}
+		return -1;
+	}
+
+	for (i = 0; i < key_count; i++) {
+		if (results[i] != NULL)
+			vy_stmt_counter_acct_tuple(&lsm->stat.get, results[i]);
+	}
+
+	double latency = ev_monotonic_now(loop()) - start_time;
+	latency_collect(&lsm->stat.latency, latency);
+
+	if (latency > lsm->env->too_long_threshold) {
+		say_warn_ratelimited("%s: get_many(%u keys) "
+				     "took too long: %.3f sec",
+				     vy_lsm_name(lsm), (unsigned)key_count,
+				     latency);
+	}
+	return 0;
+}
+
 int
 vy_point_lookup_mem(struct vy_lsm *lsm, const struct vy_read_view **rv,
 		    struct tuple *key, struct tuple **ret)
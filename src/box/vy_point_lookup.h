@@ -46,6 +46,7 @@
  */
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #if defined(__cplusplus)
 extern "C" {
@@ -71,6 +72,26 @@ vy_point_lookup(struct vy_lsm *lsm, struct vy_tx *tx,
 		const struct vy_read_view **rv,
 		struct tuple *key, struct tuple **ret);
 
+/**
+ * Look up tuples for a batch of keys, each of which has all index
+ * parts. The keys must be sorted in the index order and unique.
+ * The tuple found for keys[i] is returned in results[i] (NULL if
+ * there is none) with its reference counter elevated.
+ *
+ * This function works just like vy_point_lookup() called for each
+ * key, except that keys stored in the same range are looked up on
+ * disk together: bloom filters of a run are checked for all keys
+ * before any page of the run is read and a page shared by several
+ * keys is read only once.
+ *
+ * Like vy_point_lookup(), this function doesn't track the results
+ * in the transaction read set.
+ */
+int
+vy_point_lookup_many(struct vy_lsm *lsm, struct vy_tx *tx,
+		     const struct vy_read_view **rv, struct tuple **keys,
+		     uint32_t key_count, struct tuple **results);
+
 /**
  * Look up a tuple by key in memory.
  *
@@ -782,6 +782,28 @@ vy_read_iterator_next_range(struct vy_read_iterator *itr)
 	vy_read_iterator_add_disk(itr);
 }
 
+/**
+ * Find the newest DELETE_RANGE statement stored in source @src_id
+ * that covers @key and is visible from the iterator read view.
+ * The cache never stores covered keys so it is not checked.
+ */
+static const struct tuple *
+vy_read_iterator_find_range_delete(struct vy_read_iterator *itr,
+				   uint32_t src_id, const struct tuple *key)
+{
+	struct vy_read_src *src = &itr->src[src_id];
+	int64_t vlsn = (*itr->read_view)->vlsn;
+	if (itr->tx != NULL && src_id == itr->txw_src)
+		return vy_tx_find_range_delete(itr->tx, itr->lsm, key);
+	if (src_id >= itr->mem_src && src_id < itr->disk_src)
+		return vy_mem_find_range_delete(src->mem_iterator.mem,
+						key, vlsn);
+	if (src_id >= itr->disk_src)
+		return vy_run_find_range_delete(src->run_iterator.slice->run,
+						key, vlsn, itr->lsm->cmp_def);
+	return NULL;
+}
+
 /**
  * Get a resultant statement for the current key.
  * Returns 0 on success, -1 on error.
@@ -794,14 +816,45 @@ vy_read_iterator_apply_history(struct vy_read_iterator *itr,
 	struct vy_history history;
 	vy_history_create(&history, &lsm->env->history_node_pool);
 
+	/* Find the key the iterator is positioned at. */
+	struct tuple *key = NULL;
 	for (uint32_t i = 0; i < itr->src_count; i++) {
+		struct vy_read_src *src = &itr->src[i];
+		if (src->front_id == itr->front_id) {
+			key = vy_history_last_stmt(&src->history);
+			if (vy_stmt_is_refable(key))
+				tuple_ref(key);
+			break;
+		}
+	}
+
+	for (uint32_t i = 0; i < itr->src_count && key != NULL; i++) {
 		struct vy_read_src *src = &itr->src[i];
 		if (src->front_id == itr->front_id) {
 			vy_history_splice(&history, &src->history);
 			if (vy_history_is_terminal(&history))
 				break;
 		}
+		/*
+		 * A range deletion hides all older statements for
+		 * the key, even if the source itself doesn't store
+		 * the key.
+		 */
+		const struct tuple *range_delete =
+			vy_read_iterator_find_range_delete(itr, i, key);
+		if (range_delete != NULL &&
+		    vy_history_apply_range_delete(&history, key, range_delete,
+						  lsm->cmp_def) != 0) {
+			if (vy_stmt_is_refable(key))
+				tuple_unref(key);
+			vy_history_cleanup(&history);
+			return -1;
+		}
+		if (vy_history_is_terminal(&history))
+			break;
 	}
+	if (key != NULL && vy_stmt_is_refable(key))
+		tuple_unref(key);
 
 	int upserts_applied = 0;
 	int rc = vy_history_apply(&history, lsm->cmp_def,
@@ -106,9 +106,55 @@ vy_read_interval_should_merge(const struct vy_read_interval *l,
 		return l_parts >= r_parts;
 }
 
+/**
+ * Return the next transaction that read a key deleted by
+ * a DELETE_RANGE statement. Since the statement covers an
+ * interval rather than a point, interval boundaries are
+ * compared conservatively: a read interval that merely touches
+ * the deleted range is considered conflicting.
+ */
+static struct vy_tx *
+vy_tx_conflict_iterator_next_range(struct vy_tx_conflict_iterator *it)
+{
+	struct vy_read_interval *curr, *left, *right;
+	const char *end = vy_stmt_delete_range_end(it->stmt);
+	const char *tmp = end;
+	bool is_unbounded = mp_decode_array(&tmp) == 0;
+	while ((curr = vy_lsm_read_set_walk_next(&it->tree_walk, it->tree_dir,
+						 &left, &right)) != NULL) {
+		struct key_def *cmp_def = curr->lsm->cmp_def;
+		const struct vy_read_interval *last = curr->subtree_last;
+
+		if (vy_stmt_compare(last->right, it->stmt, cmp_def) < 0) {
+			/*
+			 * The range starts to the right of the rightmost
+			 * interval in the subtree.
+			 */
+			it->tree_dir = 0;
+			continue;
+		}
+		bool left_of_end = is_unbounded ||
+			vy_stmt_compare_with_raw_key(curr->left, end,
+						     cmp_def) <= 0;
+		/*
+		 * If the current interval starts after the range
+		 * ends, so does the whole right subtree.
+		 */
+		it->tree_dir = left_of_end ? RB_WALK_LEFT | RB_WALK_RIGHT :
+					     RB_WALK_LEFT;
+		if (left_of_end &&
+		    vy_stmt_compare(curr->right, it->stmt, cmp_def) >= 0)
+			break;
+	}
+	return curr != NULL ? curr->tx : NULL;
+}
+
 struct vy_tx *
 vy_tx_conflict_iterator_next(struct vy_tx_conflict_iterator *it)
 {
+	if (vy_stmt_type(it->stmt) == IPROTO_DELETE_RANGE)
+		return vy_tx_conflict_iterator_next_range(it);
+
 	struct vy_read_interval *curr, *left, *right;
 	while ((curr = vy_lsm_read_set_walk_next(&it->tree_walk, it->tree_dir,
 						 &left, &right)) != NULL) {
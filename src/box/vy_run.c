@@ -30,6 +30,7 @@
  */
 #include "vy_run.h"
 
+#include <fcntl.h>
 #include <zstd.h>
 
 #include "fiber.h"
@@ -38,6 +39,8 @@
 #include "cbus.h"
 #include "memory.h"
 #include "coio_file.h"
+#include "coio_task.h"
+#include "uring.h"
 
 #include "replication.h"
 #include "tuple_bloom.h"
@@ -52,12 +55,44 @@ static const uint64_t vy_page_info_key_map = (1 << VY_PAGE_INFO_OFFSET) |
 					     (1 << VY_PAGE_INFO_MIN_KEY) |
 					     (1 << VY_PAGE_INFO_ROW_INDEX_OFFSET);
 
+/**
+ * Runs having more pages than this get a partitioned bloom
+ * filter, see struct vy_run_bloom_partition.
+ */
+enum { VY_RUN_BLOOM_PARTITION_PAGES = 256 };
+
 static const uint64_t vy_run_info_key_map = (1 << VY_RUN_INFO_MIN_KEY) |
 					    (1 << VY_RUN_INFO_MAX_KEY) |
 					    (1 << VY_RUN_INFO_MIN_LSN) |
 					    (1 << VY_RUN_INFO_MAX_LSN) |
 					    (1 << VY_RUN_INFO_PAGE_COUNT);
 
+/** Key of a page in the page cache. */
+struct vy_page_cache_key {
+	int64_t run_id;
+	uint32_t page_no;
+};
+
+static inline uint32_t
+vy_page_cache_hash(int64_t run_id, uint32_t page_no)
+{
+	uint64_t h = (uint64_t)run_id * 0x9E3779B97F4A7C15ULL + page_no;
+	return (uint32_t)(h ^ (h >> 32));
+}
+
+#define mh_name _vy_page_cache
+#define mh_key_t const struct vy_page_cache_key *
+#define mh_node_t struct vy_page *
+#define mh_arg_t void *
+#define mh_hash(a, arg) (vy_page_cache_hash((*(a))->run_id, (*(a))->page_no))
+#define mh_hash_key(a, arg) (vy_page_cache_hash((a)->run_id, (a)->page_no))
+#define mh_cmp(a, b, arg) ((*(a))->run_id != (*(b))->run_id || \
+			   (*(a))->page_no != (*(b))->page_no)
+#define mh_cmp_key(a, b, arg) ((a)->run_id != (*(b))->run_id || \
+			       (a)->page_no != (*(b))->page_no)
+#define MH_SOURCE 1
+#include "salad/mhash.h"
+
 /** xlog meta type for .run files */
 #define XLOG_META_TYPE_RUN "RUN"
 
@@ -71,9 +106,29 @@ const char *vy_file_suffix[] = {
 	"run" inprogress_suffix, 	/* VY_FILE_RUN_INPROGRESS */
 };
 
+enum {
+	/** Max number of io_uring reads in flight per reader thread. */
+	VY_RUN_READER_QUEUE_DEPTH = 128,
+	/** Alignment of file offsets and buffers for O_DIRECT. */
+	VY_RUN_DIRECT_IO_ALIGN = 4096,
+};
+
+/**
+ * How long a reader thread keeps retrying to submit reads to
+ * io_uring before failing them, in seconds.
+ */
+static const double VY_RUN_READER_SUBMIT_TIMEOUT = 1;
+/** Delay between attempts to submit reads to io_uring. */
+static const double VY_RUN_READER_SUBMIT_RETRY_DELAY = 0.01;
+
 /**
  * We read runs in background threads so as not to stall tx.
  * This structure represents such a thread.
+ *
+ * If io_uring is enabled, a reader thread doesn't block on
+ * each read. Instead it submits reads to the ring in batches,
+ * once per event loop iteration, and decodes pages as reads
+ * complete, so that many reads can be in flight at a time.
  */
 struct vy_run_reader {
 	/** Thread that processes read requests. */
@@ -82,6 +137,24 @@ struct vy_run_reader {
 	struct cpipe reader_pipe;
 	/** Pipe from the reader thread to tx. */
 	struct cpipe tx_pipe;
+	/** io_uring used for reads, ring.fd is -1 if disabled. */
+	struct uring ring;
+	/** Watcher of ring completions. */
+	struct ev_io ring_ev;
+	/** Watcher submitting queued reads to the ring. */
+	struct ev_prepare submit_ev;
+	/**
+	 * Timer waking up the event loop to retry submission
+	 * after io_uring failed to accept reads.
+	 */
+	struct ev_timer retry_ev;
+	/**
+	 * Time of the first of consecutive failures to submit
+	 * reads to io_uring, 0 if the last submission succeeded.
+	 */
+	double submit_fail_time;
+	/** Read tasks waiting for space in the ring. */
+	struct stailq queue;
 };
 
 /** Cbus task for vinyl page read. */
@@ -94,8 +167,30 @@ struct vy_page_read_task {
 	struct vy_run *run;
 	/** [out] resulting vinyl page */
 	struct vy_page *page;
+	/** Reader thread the task is sent to (io_uring). */
+	struct vy_run_reader *reader;
+	/** File to read from (io_uring). */
+	int fd;
+	/** Offset to read at (io_uring). */
+	uint64_t offset;
+	/** Buffer to read to, freed with the task (io_uring). */
+	struct iovec iov;
+	/** Offset of the page data in the buffer (io_uring). */
+	size_t buf_offset;
+	/** Link in vy_run_reader::queue. */
+	struct stailq_entry in_queue;
 };
 
+static void
+vy_run_reader_complete_cb(struct ev_loop *loop, struct ev_io *ev, int events);
+
+static void
+vy_run_reader_submit_cb(struct ev_loop *loop, struct ev_prepare *ev,
+			int events);
+
+static void
+vy_run_reader_retry_cb(struct ev_loop *loop, struct ev_timer *ev, int events);
+
 /** Destructor for env->zdctx_key thread-local variable */
 static void
 vy_free_zdctx(void *arg)
@@ -114,12 +209,59 @@ vy_run_reader_f(va_list ap)
 	cpipe_create(&reader->tx_pipe, "tx_prio");
 	cbus_endpoint_create(&endpoint, cord_name(cord()),
 			     fiber_schedule_cb, fiber());
+	if (reader->ring.fd >= 0) {
+		ev_io_init(&reader->ring_ev, vy_run_reader_complete_cb,
+			   reader->ring.efd, EV_READ);
+		reader->ring_ev.data = reader;
+		ev_io_start(loop(), &reader->ring_ev);
+		ev_prepare_init(&reader->submit_ev, vy_run_reader_submit_cb);
+		reader->submit_ev.data = reader;
+		ev_prepare_start(loop(), &reader->submit_ev);
+		ev_timer_init(&reader->retry_ev, vy_run_reader_retry_cb,
+			      VY_RUN_READER_SUBMIT_RETRY_DELAY, 0);
+		reader->retry_ev.data = reader;
+		reader->submit_fail_time = 0;
+	}
 	cbus_loop(&endpoint);
+	if (reader->ring.fd >= 0) {
+		ev_io_stop(loop(), &reader->ring_ev);
+		ev_prepare_stop(loop(), &reader->submit_ev);
+		ev_timer_stop(loop(), &reader->retry_ev);
+	}
 	cbus_endpoint_destroy(&endpoint, cbus_process);
 	cpipe_destroy(&reader->tx_pipe);
 	return 0;
 }
 
+/**
+ * Set up io_uring for all reader threads. On failure io_uring
+ * is disabled and reader threads fall back on blocking reads.
+ */
+static void
+vy_run_env_create_rings(struct vy_run_env *env)
+{
+	for (int i = 0; i < env->reader_pool_size; i++) {
+		struct vy_run_reader *reader = &env->reader_pool[i];
+		stailq_create(&reader->queue);
+		reader->ring.fd = -1;
+	}
+	if (!env->use_io_uring)
+		return;
+	for (int i = 0; i < env->reader_pool_size; i++) {
+		struct vy_run_reader *reader = &env->reader_pool[i];
+		if (uring_create(&reader->ring,
+				 VY_RUN_READER_QUEUE_DEPTH) != 0) {
+			diag_log();
+			say_warn("failed to set up io_uring for vinyl "
+				 "reads, falling back on blocking reads");
+			for (int j = 0; j < i; j++)
+				uring_destroy(&env->reader_pool[j].ring);
+			env->use_io_uring = false;
+			return;
+		}
+	}
+}
+
 /** Start run reader threads. */
 static void
 vy_run_env_start_readers(struct vy_run_env *env)
@@ -132,6 +274,7 @@ vy_run_env_start_readers(struct vy_run_env *env)
 	if (env->reader_pool == NULL)
 		panic("failed to allocate vinyl reader thread pool");
 
+	vy_run_env_create_rings(env);
 	for (int i = 0; i < env->reader_pool_size; i++) {
 		struct vy_run_reader *reader = &env->reader_pool[i];
 		char name[FIBER_NAME_MAX];
@@ -153,10 +296,164 @@ vy_run_env_stop_readers(struct vy_run_env *env)
 		struct vy_run_reader *reader = &env->reader_pool[i];
 		tt_pthread_cancel(reader->cord.id);
 		tt_pthread_join(reader->cord.id, NULL);
+		if (reader->ring.fd >= 0)
+			uring_destroy(&reader->ring);
 	}
 	free(env->reader_pool);
 }
 
+static void
+vy_page_delete(struct vy_page *page)
+{
+	uint32_t *row_index = page->row_index;
+	char *data = page->data;
+#if !defined(NDEBUG)
+	memset(row_index, '#', sizeof(uint32_t) * page->row_count);
+	memset(data, '#', page->unpacked_size);
+	memset(page, '#', sizeof(*page));
+#endif /* !defined(NDEBUG) */
+	free(row_index);
+	free(data);
+	free(page);
+}
+
+static inline void
+vy_page_ref(struct vy_page *page)
+{
+	assert(page->refs > 0);
+	page->refs++;
+}
+
+static inline void
+vy_page_unref(struct vy_page *page)
+{
+	assert(page->refs > 0);
+	if (--page->refs == 0)
+		vy_page_delete(page);
+}
+
+/** Memory accounted to a page stored in the page cache. */
+static inline size_t
+vy_page_cache_size(struct vy_page *page)
+{
+	return sizeof(*page) + page->row_count * sizeof(uint32_t) +
+	       page->unpacked_size;
+}
+
+static void
+vy_page_cache_create(struct vy_page_cache *cache)
+{
+	cache->hash = mh_vy_page_cache_new();
+	if (cache->hash == NULL)
+		panic("failed to allocate vinyl page cache");
+	rlist_create(&cache->lru);
+	cache->mem_used = 0;
+	cache->mem_quota = 0;
+	cache->hit = 0;
+	cache->miss = 0;
+}
+
+static void
+vy_page_cache_destroy(struct vy_page_cache *cache)
+{
+	struct vy_page *page, *tmp;
+	rlist_foreach_entry_safe(page, &cache->lru, in_lru, tmp)
+		vy_page_unref(page);
+	mh_vy_page_cache_delete(cache->hash);
+}
+
+/** Remove a page from the page cache and drop its reference. */
+static void
+vy_page_cache_remove(struct vy_page_cache *cache, struct vy_page *page)
+{
+	struct vy_page_cache_key key = { page->run_id, page->page_no };
+	mh_int_t k = mh_vy_page_cache_find(cache->hash, &key, NULL);
+	assert(k != mh_end(cache->hash));
+	mh_vy_page_cache_del(cache->hash, k, NULL);
+	rlist_del_entry(page, in_lru);
+	assert(cache->mem_used >= vy_page_cache_size(page));
+	cache->mem_used -= vy_page_cache_size(page);
+	vy_page_unref(page);
+}
+
+/** Evict least recently used pages until the quota is met. */
+static void
+vy_page_cache_evict(struct vy_page_cache *cache)
+{
+	while (cache->mem_used > cache->mem_quota) {
+		assert(!rlist_empty(&cache->lru));
+		struct vy_page *page = rlist_last_entry(&cache->lru,
+							struct vy_page, in_lru);
+		vy_page_cache_remove(cache, page);
+	}
+}
+
+/**
+ * Look up a page in the page cache. Returns a referenced page
+ * or NULL if the page isn't cached.
+ */
+static struct vy_page *
+vy_page_cache_get(struct vy_page_cache *cache, int64_t run_id,
+		  uint32_t page_no)
+{
+	if (cache->mem_quota == 0)
+		return NULL;
+	struct vy_page_cache_key key = { run_id, page_no };
+	mh_int_t k = mh_vy_page_cache_find(cache->hash, &key, NULL);
+	if (k == mh_end(cache->hash)) {
+		cache->miss++;
+		return NULL;
+	}
+	struct vy_page *page = *mh_vy_page_cache_node(cache->hash, k);
+	rlist_move_entry(&cache->lru, page, in_lru);
+	vy_page_ref(page);
+	cache->hit++;
+	return page;
+}
+
+/**
+ * Store a page in the page cache. Failure to do so isn't
+ * critical, because the page can always be read from disk
+ * again, so the function just returns false in this case.
+ */
+static bool
+vy_page_cache_put(struct vy_page_cache *cache, struct vy_page *page)
+{
+	size_t size = vy_page_cache_size(page);
+	if (size > cache->mem_quota)
+		return false;
+	/*
+	 * The same page may have been read and cached by another
+	 * fiber while this one was waiting for the disk.
+	 */
+	struct vy_page_cache_key key = { page->run_id, page->page_no };
+	if (mh_vy_page_cache_find(cache->hash, &key, NULL) !=
+	    mh_end(cache->hash))
+		return false;
+	if (mh_vy_page_cache_put(cache->hash, (const struct vy_page **)&page,
+				 NULL, NULL) == mh_end(cache->hash))
+		return false;
+	rlist_add_entry(&cache->lru, page, in_lru);
+	vy_page_ref(page);
+	cache->mem_used += size;
+	vy_page_cache_evict(cache);
+	return true;
+}
+
+/** Evict all pages of a run from the page cache. */
+static void
+vy_page_cache_purge_run(struct vy_page_cache *cache, struct vy_run *run)
+{
+	for (uint32_t page_no = 0; page_no < run->info.page_count; page_no++) {
+		struct vy_page_cache_key key = { run->id, page_no };
+		mh_int_t k = mh_vy_page_cache_find(cache->hash, &key, NULL);
+		if (k == mh_end(cache->hash))
+			continue;
+		vy_page_cache_remove(cache,
+				     *mh_vy_page_cache_node(cache->hash, k));
+	}
+}
+
 /**
  * Initialize vinyl run environment
  */
@@ -168,6 +465,7 @@ vy_run_env_create(struct vy_run_env *env, int read_threads)
 	tt_pthread_key_create(&env->zdctx_key, vy_free_zdctx);
 	mempool_create(&env->read_task_pool, cord_slab_cache(),
 		       sizeof(struct vy_page_read_task));
+	vy_page_cache_create(&env->page_cache);
 }
 
 /**
@@ -178,10 +476,33 @@ vy_run_env_destroy(struct vy_run_env *env)
 {
 	if (env->reader_pool != NULL)
 		vy_run_env_stop_readers(env);
+	vy_page_cache_destroy(&env->page_cache);
 	mempool_destroy(&env->read_task_pool);
 	tt_pthread_key_delete(env->zdctx_key);
 }
 
+void
+vy_run_env_set_io_uring(struct vy_run_env *env, bool enable, bool direct)
+{
+	assert(env->reader_pool == NULL);
+#if !defined(O_DIRECT)
+	if (enable && direct) {
+		say_warn("O_DIRECT is not supported, vinyl will use "
+			 "buffered reads");
+	}
+	direct = false;
+#endif
+	env->use_io_uring = enable;
+	env->use_direct_io = enable && direct;
+}
+
+void
+vy_run_env_set_page_cache(struct vy_run_env *env, size_t quota)
+{
+	env->page_cache.mem_quota = quota;
+	vy_page_cache_evict(&env->page_cache);
+}
+
 /**
  * Enable coio reads for a vinyl run environment.
  */
@@ -233,6 +554,8 @@ vy_run_new(struct vy_run_env *env, int64_t id)
 	run->id = id;
 	run->dump_lsn = -1;
 	run->fd = -1;
+	run->index_fd = -1;
+	run->direct_fd = -1;
 	run->refs = 1;
 	rlist_create(&run->in_lsm);
 	rlist_create(&run->in_unused);
@@ -255,6 +578,20 @@ vy_run_clear(struct vy_run *run)
 		tuple_bloom_delete(run->info.bloom);
 		run->info.bloom = NULL;
 	}
+	for (uint32_t i = 0; i < run->info.bloom_partition_count; i++) {
+		struct vy_run_bloom_partition *partition;
+		partition = &run->info.bloom_partitions[i];
+		if (partition->bloom != NULL)
+			tuple_bloom_delete(partition->bloom);
+	}
+	free(run->info.bloom_partitions);
+	run->info.bloom_partitions = NULL;
+	run->info.bloom_partition_count = 0;
+	for (uint32_t i = 0; i < run->info.range_delete_count; i++)
+		tuple_unref((struct tuple *)run->info.range_deletes[i]);
+	free(run->info.range_deletes);
+	run->info.range_deletes = NULL;
+	run->info.range_delete_count = 0;
 	free(run->info.min_key);
 	run->info.min_key = NULL;
 	free(run->info.max_key);
@@ -267,15 +604,47 @@ vy_run_delete(struct vy_run *run)
 	assert(run->refs == 0);
 	if (run->fd >= 0 && close(run->fd) < 0)
 		say_syserror("close failed");
+	if (run->index_fd >= 0 && close(run->index_fd) < 0)
+		say_syserror("close failed");
+	if (run->direct_fd >= 0 && close(run->direct_fd) < 0)
+		say_syserror("close failed");
+	if (run->has_cached_pages)
+		vy_page_cache_purge_run(&run->env->page_cache, run);
 	vy_run_clear(run);
 	TRASH(run);
 	free(run);
 }
 
+int
+vy_run_set_range_deletes(struct vy_run *run, struct tuple **range_deletes,
+			 uint32_t count)
+{
+	assert(run->info.range_deletes == NULL);
+	if (count == 0)
+		return 0;
+	size_t size = count * sizeof(*run->info.range_deletes);
+	run->info.range_deletes = malloc(size);
+	if (run->info.range_deletes == NULL) {
+		diag_set(OutOfMemory, size, "malloc", "range deletes");
+		return -1;
+	}
+	for (uint32_t i = 0; i < count; i++) {
+		tuple_ref(range_deletes[i]);
+		run->info.range_deletes[i] = range_deletes[i];
+	}
+	run->info.range_delete_count = count;
+	return 0;
+}
+
 size_t
 vy_run_bloom_size(struct vy_run *run)
 {
-	return run->info.bloom == NULL ? 0 : tuple_bloom_size(run->info.bloom);
+	size_t size = 0;
+	if (run->info.bloom != NULL)
+		size += tuple_bloom_size(run->info.bloom);
+	for (uint32_t i = 0; i < run->info.bloom_partition_count; i++)
+		size += run->info.bloom_partitions[i].bloom_size;
+	return size;
 }
 
 /**
@@ -564,12 +933,119 @@ vy_stmt_stat_decode(struct vy_stmt_stat *stat, const char **data)
 	}
 }
 
+/**
+ * Decode the list of bloom filter partitions stored in
+ * the run metadata. Only the first page of each partition
+ * is stored there, the rest is filled on recovery.
+ */
+static int
+vy_run_info_decode_bloom_partitions(struct vy_run_info *run_info,
+				    const char **data)
+{
+	uint32_t count = mp_decode_array(data);
+	if (count == 0)
+		return 0;
+	size_t size = count * sizeof(*run_info->bloom_partitions);
+	run_info->bloom_partitions = calloc(1, size);
+	if (run_info->bloom_partitions == NULL) {
+		diag_set(OutOfMemory, size, "malloc",
+			 "struct vy_run_bloom_partition");
+		return -1;
+	}
+	run_info->bloom_partition_count = count;
+	for (uint32_t i = 0; i < count; i++) {
+		struct vy_run_bloom_partition *partition;
+		partition = &run_info->bloom_partitions[i];
+		partition->first_page_no = mp_decode_uint(data);
+	}
+	return 0;
+}
+
+/**
+ * Decode a bloom filter partition from xrow.
+ *
+ * @param xrow xrow to decode
+ * @param filename File name for error reporting.
+ * @param[out] bloom_size size of the encoded bloom filter
+ *
+ * @retval pointer to the encoded bloom filter
+ * @retval NULL error (check diag)
+ */
+static const char *
+vy_bloom_partition_decode(const struct xrow_header *xrow,
+			  const char *filename, uint32_t *bloom_size)
+{
+	if (xrow->type != VY_INDEX_BLOOM) {
+		diag_set(ClientError, ER_INVALID_INDEX_FILE, filename,
+			 tt_sprintf("Wrong xrow type (expected %d, got %u)",
+				    VY_INDEX_BLOOM, (unsigned)xrow->type));
+		return NULL;
+	}
+	const char *pos = xrow->body->iov_base;
+	const char *bloom = NULL;
+	uint32_t map_size = mp_decode_map(&pos);
+	for (uint32_t map_item = 0; map_item < map_size; map_item++) {
+		uint32_t key = mp_decode_uint(&pos);
+		const char *value = pos;
+		mp_next(&pos);
+		if (key == VY_RUN_INFO_BLOOM) {
+			bloom = value;
+			*bloom_size = pos - value;
+		}
+	}
+	if (bloom == NULL) {
+		diag_set(ClientError, ER_INVALID_INDEX_FILE, filename,
+			 tt_sprintf("Can't decode bloom filter partition: "
+				    "missing mandatory key %s",
+				    vy_run_info_key_name(VY_RUN_INFO_BLOOM)));
+	}
+	return bloom;
+}
+
+/**
+ * Decode DELETE_RANGE statements stored in the run info.
+ * Each of them is encoded as [lsn, begin, end].
+ */
+static int
+vy_run_info_decode_range_deletes(struct vy_run_info *run_info,
+				 const char **data,
+				 struct tuple_format *key_format)
+{
+	uint32_t count = mp_decode_array(data);
+	run_info->range_deletes = calloc(count,
+					 sizeof(*run_info->range_deletes));
+	if (run_info->range_deletes == NULL) {
+		diag_set(OutOfMemory, count * sizeof(struct tuple *),
+			 "malloc", "range deletes");
+		return -1;
+	}
+	for (uint32_t i = 0; i < count; i++) {
+		uint32_t size = mp_decode_array(data);
+		assert(size == 3);
+		(void)size;
+		int64_t lsn = mp_decode_uint(data);
+		const char *begin = *data;
+		mp_next(data);
+		const char *end = *data;
+		mp_next(data);
+		struct tuple *stmt = vy_stmt_new_delete_range(key_format,
+					begin, end, end, *data);
+		if (stmt == NULL)
+			return -1;
+		vy_stmt_set_lsn(stmt, lsn);
+		run_info->range_deletes[i] = stmt;
+		run_info->range_delete_count++;
+	}
+	return 0;
+}
+
 /**
  * Decode the run metadata from xrow.
  *
  * @param xrow xrow to decode
  * @param[out] run_info the run information
  * @param filename File name for error reporting.
+ * @param key_format Format of DELETE_RANGE statements.
  *
  * @retval  0 success
  * @retval -1 error (check diag)
@@ -577,7 +1053,7 @@ vy_stmt_stat_decode(struct vy_stmt_stat *stat, const char **data)
 int
 vy_run_info_decode(struct vy_run_info *run_info,
 		   const struct xrow_header *xrow,
-		   const char *filename)
+		   const char *filename, struct tuple_format *key_format)
 {
 	assert(xrow->type == VY_INDEX_RUN_INFO);
 	/* decode run */
@@ -628,6 +1104,16 @@ vy_run_info_decode(struct vy_run_info *run_info,
 		case VY_RUN_INFO_STMT_STAT:
 			vy_stmt_stat_decode(&run_info->stmt_stat, &pos);
 			break;
+		case VY_RUN_INFO_BLOOM_PARTITIONS:
+			if (vy_run_info_decode_bloom_partitions(run_info,
+								&pos) != 0)
+				return -1;
+			break;
+		case VY_RUN_INFO_RANGE_DELETES:
+			if (vy_run_info_decode_range_deletes(run_info, &pos,
+							     key_format) != 0)
+				return -1;
+			break;
 		default:
 			mp_next(&pos); /* unknown key, ignore */
 			break;
@@ -655,6 +1141,9 @@ vy_page_new(const struct vy_page_info *page_info)
 	}
 	page->unpacked_size = page_info->unpacked_size;
 	page->row_count = page_info->row_count;
+	page->run_id = -1;
+	page->refs = 1;
+	rlist_create(&page->in_lru);
 	page->row_index = calloc(page_info->row_count, sizeof(uint32_t));
 	if (page->row_index == NULL) {
 		diag_set(OutOfMemory, page_info->row_count * sizeof(uint32_t),
@@ -674,21 +1163,6 @@ vy_page_new(const struct vy_page_info *page_info)
 	return page;
 }
 
-static void
-vy_page_delete(struct vy_page *page)
-{
-	uint32_t *row_index = page->row_index;
-	char *data = page->data;
-#if !defined(NDEBUG)
-	memset(row_index, '#', sizeof(uint32_t) * page->row_count);
-	memset(data, '#', page->unpacked_size);
-	memset(page, '#', sizeof(*page));
-#endif /* !defined(NDEBUG) */
-	free(row_index);
-	free(data);
-	free(page);
-}
-
 static int
 vy_page_xrow(struct vy_page *page, uint32_t stmt_no,
 	     struct xrow_header *xrow)
@@ -733,9 +1207,9 @@ vy_run_iterator_stop(struct vy_run_iterator *itr)
 		itr->curr_stmt = NULL;
 	}
 	if (itr->curr_page != NULL) {
-		vy_page_delete(itr->curr_page);
+		vy_page_unref(itr->curr_page);
 		if (itr->prev_page != NULL)
-			vy_page_delete(itr->prev_page);
+			vy_page_unref(itr->prev_page);
 		itr->curr_page = itr->prev_page = NULL;
 	}
 	itr->search_ended = true;
@@ -782,6 +1256,62 @@ vy_run_filename(struct vy_run *run)
 	return buf;
 }
 
+/** Return the name of a run index file. */
+static inline const char *
+vy_run_index_filename(struct vy_run *run)
+{
+	char *buf = tt_static_buf();
+	vy_run_snprint_filename(buf, TT_STATIC_BUF_LEN, run->id,
+				VY_FILE_INDEX);
+	return buf;
+}
+
+/**
+ * Decode a page read from vinyl xlog data file.
+ *
+ * @retval 0 on success
+ * @retval -1 on error, check diag
+ */
+static int
+vy_page_decode(struct vy_page *page, const struct vy_page_info *page_info,
+	       const char *data, ZSTD_DStream *zdctx)
+{
+	/* decode xlog tx */
+	const char *data_pos = data;
+	const char *data_end = data + page_info->size;
+	char *rows = page->data;
+	char *rows_end = rows + page_info->unpacked_size;
+	if (xlog_tx_decode(data, data_end, rows, rows_end, zdctx) != 0)
+		return -1;
+
+	struct xrow_header xrow;
+	data_pos = page->data + page_info->row_index_offset;
+	data_end = page->data + page_info->unpacked_size;
+	if (xrow_header_decode(&xrow, &data_pos, data_end, true) == -1)
+		return -1;
+	if (xrow.type != VY_RUN_ROW_INDEX) {
+		diag_set(ClientError, ER_INVALID_RUN_FILE,
+			 tt_sprintf("Wrong row index type "
+				    "(expected %d, got %u)",
+				    VY_RUN_ROW_INDEX, (unsigned)xrow.type));
+		return -1;
+	}
+	if (vy_row_index_decode(page->row_index, page->row_count, &xrow) != 0)
+		return -1;
+	return 0;
+}
+
+/** Log an error that occurred while reading a page. */
+static void
+vy_page_read_log_error(struct vy_run *run,
+		       const struct vy_page_info *page_info)
+{
+	diag_log();
+	say_error("error reading %s@%llu:%u", vy_run_filename(run),
+		  (unsigned long long)page_info->offset,
+		  (unsigned)page_info->size);
+}
+
 /**
  * Read a page requests from vinyl xlog data file.
  *
@@ -818,27 +1348,7 @@ vy_page_read(struct vy_page *page, const struct vy_page_info *page_info,
 	if (inj != NULL && inj->dparam > 0)
 		usleep(inj->dparam * 1000000);
 
-	/* decode xlog tx */
-	const char *data_pos = data;
-	const char *data_end = data + readen;
-	char *rows = page->data;
-	char *rows_end = rows + page_info->unpacked_size;
-	if (xlog_tx_decode(data, data_end, rows, rows_end, zdctx) != 0)
-		goto error;
-
-	struct xrow_header xrow;
-	data_pos = page->data + page_info->row_index_offset;
-	data_end = page->data + page_info->unpacked_size;
-	if (xrow_header_decode(&xrow, &data_pos, data_end, true) == -1)
-		goto error;
-	if (xrow.type != VY_RUN_ROW_INDEX) {
-		diag_set(ClientError, ER_INVALID_RUN_FILE,
-			 tt_sprintf("Wrong row index type "
-				    "(expected %d, got %u)",
-				    VY_RUN_ROW_INDEX, (unsigned)xrow.type));
-		goto error;
-	}
-	if (vy_row_index_decode(page->row_index, page->row_count, &xrow) != 0)
+	if (vy_page_decode(page, page_info, data, zdctx) != 0)
 		goto error;
 	region_truncate(&fiber()->gc, region_svp);
 	ERROR_INJECT(ERRINJ_VY_READ_PAGE, {
@@ -847,10 +1357,7 @@ vy_page_read(struct vy_page *page, const struct vy_page_info *page_info,
 	return 0;
 error:
 	region_truncate(&fiber()->gc, region_svp);
-	diag_log();
-	say_error("error reading %s@%llu:%u", vy_run_filename(run),
-		  (unsigned long long)page_info->offset,
-		  (unsigned)page_info->size);
+	vy_page_read_log_error(run, page_info);
 	return -1;
 }
 
@@ -894,40 +1401,274 @@ vy_page_read_cb_free(struct cbus_call_msg *base)
 {
 	struct vy_page_read_task *task = (struct vy_page_read_task *)base;
 	struct vy_run_env *env = task->run->env;
+	free(task->iov.iov_base);
 	vy_page_delete(task->page);
 	vy_run_unref(task->run);
 	mempool_free(&env->read_task_pool, task);
 	return 0;
 }
 
+/** Pass a read task to the ring of a reader thread. */
+static void
+vy_run_reader_prep_read(struct vy_run_reader *reader,
+			struct vy_page_read_task *task)
+{
+	uring_prep_readv(&reader->ring, task->fd, &task->iov, 1,
+			 task->offset, task);
+}
+
 /**
- * Read a page from disk given its number.
- * The function caches two most recently read pages.
+ * Submit a page read to the ring, called in the reader thread.
+ * The read is passed to the kernel along with other reads
+ * queued during the same event loop iteration.
+ */
+static void
+vy_page_read_submit(struct cmsg *base)
+{
+	struct vy_page_read_task *task = (struct vy_page_read_task *)base;
+	struct vy_run_reader *reader = task->reader;
+	if (!stailq_empty(&reader->queue) || !uring_has_space(&reader->ring)) {
+		stailq_add_tail_entry(&reader->queue, task, in_queue);
+		return;
+	}
+	vy_run_reader_prep_read(reader, task);
+}
+
+/**
+ * Wake up the fiber waiting for a page read, called in tx.
+ * If the fiber is gone, free the task.
+ */
+static void
+vy_page_read_done(struct cmsg *base)
+{
+	struct cbus_call_msg *msg = (struct cbus_call_msg *)base;
+	if (msg->caller == NULL) {
+		vy_page_read_cb_free(msg);
+		return;
+	}
+	msg->complete = true;
+	fiber_wakeup(msg->caller);
+}
+
+/**
+ * Decode a page whose read has completed and send the result
+ * back to tx, called in the reader thread.
+ */
+static void
+vy_page_read_complete(void *user_data, int res, void *arg)
+{
+	struct vy_page_read_task *task = user_data;
+	struct vy_run_reader *reader = arg;
+	const struct vy_page_info *page_info = &task->page_info;
+	int rc = -1;
+	if (res < 0) {
+		errno = -res;
+		diag_set(SystemError, "failed to read from file");
+	} else if ((size_t)res < task->buf_offset + page_info->size) {
+		diag_set(ClientError, ER_INVALID_RUN_FILE,
+			 "Unexpected end of file");
+	} else {
+		ZSTD_DStream *zdctx = vy_env_get_zdctx(task->run->env);
+		if (zdctx != NULL) {
+			const char *data = (char *)task->iov.iov_base +
+					   task->buf_offset;
+			rc = vy_page_decode(task->page, page_info,
+					    data, zdctx);
+		}
+	}
+	struct cbus_call_msg *msg = &task->base;
+	msg->rc = rc;
+	if (rc != 0) {
+		vy_page_read_log_error(task->run, page_info);
+		diag_move(diag_get(), &msg->diag);
+	}
+	cmsg_init(cmsg(msg), &msg->route[1]);
+	cpipe_push(&reader->tx_pipe, cmsg(msg));
+}
+
+static void
+vy_run_reader_complete_cb(struct ev_loop *loop, struct ev_io *ev, int events)
+{
+	(void)loop;
+	(void)events;
+	struct vy_run_reader *reader = ev->data;
+	uring_reap(&reader->ring, vy_page_read_complete, reader);
+	while (!stailq_empty(&reader->queue) &&
+	       uring_has_space(&reader->ring)) {
+		struct vy_page_read_task *task;
+		task = stailq_shift_entry(&reader->queue,
+					  struct vy_page_read_task, in_queue);
+		vy_run_reader_prep_read(reader, task);
+	}
+}
+
+static void
+vy_run_reader_submit_cb(struct ev_loop *loop, struct ev_prepare *ev,
+			int events)
+{
+	(void)loop;
+	(void)events;
+	struct vy_run_reader *reader = ev->data;
+	if (uring_submit(&reader->ring) == 0) {
+		reader->submit_fail_time = 0;
+		return;
+	}
+	int save_errno = errno;
+	double now = ev_monotonic_now(loop);
+	if (reader->submit_fail_time == 0)
+		reader->submit_fail_time = now;
+	if ((save_errno == EAGAIN || save_errno == EBUSY ||
+	     save_errno == ENOMEM) &&
+	    now - reader->submit_fail_time < VY_RUN_READER_SUBMIT_TIMEOUT) {
+		/*
+		 * The kernel is short of resources. The reads stay
+		 * in the ring, retry to submit them on the next loop
+		 * iteration. Make sure there is one even if nothing
+		 * else happens.
+		 */
+		say_warn_ratelimited("failed to submit vinyl reads: %s, "
+				     "will retry", strerror(save_errno));
+		if (!ev_is_active(&reader->retry_ev))
+			ev_timer_start(loop, &reader->retry_ev);
+		return;
+	}
+	/*
+	 * Give up and fail all reads that haven't been passed to
+	 * the kernel, including those waiting for space in the
+	 * ring, so that the fibers waiting for them get an error.
+	 */
+	diag_log();
+	say_error("failed to submit vinyl reads, cancelling them");
+	reader->submit_fail_time = 0;
+	uring_cancel(&reader->ring, -save_errno, vy_page_read_complete,
+		     reader);
+	while (!stailq_empty(&reader->queue)) {
+		struct vy_page_read_task *task;
+		task = stailq_shift_entry(&reader->queue,
+					  struct vy_page_read_task, in_queue);
+		vy_page_read_complete(task, -save_errno, reader);
+	}
+}
+
+static void
+vy_run_reader_retry_cb(struct ev_loop *loop, struct ev_timer *ev, int events)
+{
+	(void)loop;
+	(void)ev;
+	(void)events;
+	/* Nothing to do, vy_run_reader_submit_cb() will retry. */
+}
+
+/**
+ * Return the file descriptor of a run data file opened with
+ * O_DIRECT, opening it on demand, or -1 if it can't be opened.
+ */
+static int
+vy_run_direct_fd(struct vy_run *run)
+{
+#if defined(O_DIRECT)
+	if (run->direct_fd < 0) {
+		run->direct_fd = open(tt_sprintf("/proc/self/fd/%d", run->fd),
+				      O_RDONLY | O_DIRECT);
+		if (run->direct_fd < 0) {
+			say_warn_ratelimited("failed to open %s with "
+					     "O_DIRECT: %s",
+					     vy_run_filename(run),
+					     strerror(errno));
+		}
+	}
+	return run->direct_fd;
+#else
+	(void)run;
+	return -1;
+#endif
+}
+
+/**
+ * Read a page with io_uring of the given reader thread.
+ * Like cbus_call(), the function returns -1 without waiting
+ * for the read to complete if the fiber is cancelled, in which
+ * case the task is freed on completion.
+ *
+ * @retval 0 success
+ * @retval -1 error, check task->base.complete
+ */
+static int
+vy_run_reader_read(struct vy_run_reader *reader,
+		   struct vy_page_read_task *task)
+{
+	struct vy_run *run = task->run;
+	const struct vy_page_info *page_info = &task->page_info;
+	int direct_fd = run->env->use_direct_io ? vy_run_direct_fd(run) : -1;
+	size_t size;
+	void *buf;
+	if (direct_fd >= 0) {
+		/* O_DIRECT requires aligned offsets and buffers. */
+		const size_t align = VY_RUN_DIRECT_IO_ALIGN;
+		task->fd = direct_fd;
+		task->offset = page_info->offset & ~(uint64_t)(align - 1);
+		task->buf_offset = page_info->offset - task->offset;
+		size = (task->buf_offset + page_info->size + align - 1) &
+		       ~(align - 1);
+		if (posix_memalign(&buf, align, size) != 0)
+			buf = NULL;
+	} else {
+		task->fd = run->fd;
+		task->offset = page_info->offset;
+		task->buf_offset = 0;
+		size = page_info->size;
+		buf = malloc(size);
+	}
+	if (buf == NULL) {
+		diag_set(OutOfMemory, size, "malloc", "page read buffer");
+		task->base.complete = true;
+		return -1;
+	}
+	task->iov.iov_base = buf;
+	task->iov.iov_len = size;
+	task->reader = reader;
+
+	struct cbus_call_msg *msg = &task->base;
+	diag_create(&msg->diag);
+	msg->caller = fiber();
+	msg->complete = false;
+	msg->rc = 0;
+	msg->route[0].f = vy_page_read_submit;
+	msg->route[0].pipe = NULL;
+	msg->route[1].f = vy_page_read_done;
+	msg->route[1].pipe = NULL;
+	cmsg_init(cmsg(msg), msg->route);
+	cpipe_push(&reader->reader_pipe, cmsg(msg));
+
+	fiber_yield_timeout(TIMEOUT_INFINITY);
+	if (!msg->complete) {
+		/* The task will be freed on completion. */
+		msg->caller = NULL;
+		if (fiber_is_cancelled())
+			diag_set(FiberIsCancelled);
+		else
+			diag_set(TimedOut);
+		return -1;
+	}
+	if (msg->rc != 0)
+		diag_move(&msg->diag, diag_get());
+	return msg->rc;
+}
+
+/**
+ * Read a page of the run iterated by the given iterator from
+ * disk. The page is returned with the reference counter set to 1.
  *
  * @retval 0 success
  * @retval -1 critical error
  */
 static NODISCARD int
-vy_run_iterator_load_page(struct vy_run_iterator *itr, uint32_t page_no,
+vy_run_iterator_read_page(struct vy_run_iterator *itr, uint32_t page_no,
 			  struct vy_page **result)
 {
 	struct vy_slice *slice = itr->slice;
 	struct vy_run_env *env = slice->run->env;
 
-	/* Check cache */
-	if (itr->curr_page != NULL) {
-		if (itr->curr_page->page_no == page_no) {
-			*result = itr->curr_page;
-			return 0;
-		}
-		if (itr->prev_page != NULL &&
-		    itr->prev_page->page_no == page_no) {
-			SWAP(itr->prev_page, itr->curr_page);
-			*result = itr->curr_page;
-			return 0;
-		}
-	}
-
 	/* Allocate buffers */
 	struct vy_page_info *page_info = vy_run_page_info(slice->run, page_no);
 	struct vy_page *page = vy_page_new(page_info);
@@ -955,16 +1696,22 @@ vy_run_iterator_load_page(struct vy_run_iterator *itr, uint32_t page_no,
 		task->run = slice->run;
 		task->page_info = *page_info;
 		task->page = page;
+		task->iov.iov_base = NULL;
 		vy_run_ref(task->run);
 
 		/* Post task to the reader thread. */
-		rc = cbus_call(&reader->reader_pipe, &reader->tx_pipe,
-			       &task->base, vy_page_read_cb,
-			       vy_page_read_cb_free, TIMEOUT_INFINITY);
+		if (reader->ring.fd >= 0) {
+			rc = vy_run_reader_read(reader, task);
+		} else {
+			rc = cbus_call(&reader->reader_pipe, &reader->tx_pipe,
+				       &task->base, vy_page_read_cb,
+				       vy_page_read_cb_free, TIMEOUT_INFINITY);
+		}
 		if (!task->base.complete)
 			return -1; /* timed out or cancelled */
 
 		vy_run_unref(task->run);
+		free(task->iov.iov_base);
 		mempool_free(&env->read_task_pool, task);
 
 		if (rc != 0) {
@@ -987,13 +1734,8 @@ vy_run_iterator_load_page(struct vy_run_iterator *itr, uint32_t page_no,
 			return -1;
 		}
 	}
-
-	/* Update cache */
-	if (itr->prev_page != NULL)
-		vy_page_delete(itr->prev_page);
-	itr->prev_page = itr->curr_page;
-	itr->curr_page = page;
 	page->page_no = page_no;
+	page->run_id = slice->run->id;
 
 	/* Update read statistics. */
 	itr->stat->read.rows += page_info->row_count;
@@ -1005,6 +1747,61 @@ vy_run_iterator_load_page(struct vy_run_iterator *itr, uint32_t page_no,
 	return 0;
 }
 
+/**
+ * Load a page given its number. The page is looked up among
+ * the two most recently loaded pages kept by the iterator, then
+ * in the page cache of the vinyl environment, and only then it
+ * is read from disk.
+ *
+ * @retval 0 success
+ * @retval -1 critical error
+ */
+static NODISCARD int
+vy_run_iterator_load_page(struct vy_run_iterator *itr, uint32_t page_no,
+			  struct vy_page **result)
+{
+	struct vy_slice *slice = itr->slice;
+	struct vy_page_cache *cache = &slice->run->env->page_cache;
+
+	/* Check cache */
+	if (itr->curr_page != NULL) {
+		if (itr->curr_page->page_no == page_no) {
+			*result = itr->curr_page;
+			return 0;
+		}
+		if (itr->prev_page != NULL &&
+		    itr->prev_page->page_no == page_no) {
+			SWAP(itr->prev_page, itr->curr_page);
+			*result = itr->curr_page;
+			return 0;
+		}
+	}
+
+	/*
+	 * The page cache is shared by all iterators and may only
+	 * be accessed from the tx thread.
+	 */
+	bool use_cache = cord_is_main();
+	struct vy_page *page = NULL;
+	if (use_cache)
+		page = vy_page_cache_get(cache, slice->run->id, page_no);
+	if (page == NULL) {
+		if (vy_run_iterator_read_page(itr, page_no, &page) != 0)
+			return -1;
+		if (use_cache && vy_page_cache_put(cache, page))
+			slice->run->has_cached_pages = true;
+	}
+
+	/* Update cache */
+	if (itr->prev_page != NULL)
+		vy_page_unref(itr->prev_page);
+	itr->prev_page = itr->curr_page;
+	itr->curr_page = page;
+
+	*result = page;
+	return 0;
+}
+
 /**
  * Read key and lsn by a given wide position.
  * For the first record in a page reads the result from the page
@@ -1231,6 +2028,152 @@ vy_run_iterator_find_lsn(struct vy_run_iterator *itr,
 	return 0;
 }
 
+/**
+ * Read a bloom filter partition from the run index file.
+ * Called in a coio thread.
+ */
+static ssize_t
+vy_run_read_bloom_partition_f(va_list ap)
+{
+	struct vy_run *run = va_arg(ap, struct vy_run *);
+	struct vy_run_bloom_partition *partition =
+		va_arg(ap, struct vy_run_bloom_partition *);
+	struct tuple_bloom **result = va_arg(ap, struct tuple_bloom **);
+
+	ZSTD_DStream *zdctx = vy_env_get_zdctx(run->env);
+	if (zdctx == NULL)
+		return -1;
+	size_t size = partition->size + partition->unpacked_size;
+	char *data = malloc(size);
+	if (data == NULL) {
+		diag_set(OutOfMemory, size, "malloc", "bloom partition");
+		return -1;
+	}
+	char *rows = data + partition->size;
+	char *rows_end = rows + partition->unpacked_size;
+	const char *filename = vy_run_index_filename(run);
+	ssize_t rc = -1;
+	ssize_t readen = fio_pread(run->index_fd, data, partition->size,
+				   partition->offset);
+	if (readen < 0) {
+		diag_set(SystemError, "failed to read from file");
+		goto out;
+	}
+	if (readen != (ssize_t)partition->size) {
+		diag_set(ClientError, ER_INVALID_INDEX_FILE, filename,
+			 "Unexpected end of file");
+		goto out;
+	}
+	if (xlog_tx_decode(data, rows, rows, rows_end, zdctx) != 0)
+		goto out;
+	struct xrow_header xrow;
+	const char *pos = rows;
+	if (xrow_header_decode(&xrow, &pos, rows_end, true) != 0)
+		goto out;
+	uint32_t bloom_size;
+	pos = vy_bloom_partition_decode(&xrow, filename, &bloom_size);
+	if (pos == NULL)
+		goto out;
+	*result = tuple_bloom_decode(&pos);
+	if (*result != NULL)
+		rc = 0;
+out:
+	free(data);
+	return rc;
+}
+
+/**
+ * Load a bloom filter partition of a recovered run.
+ * The caller must pin the run, because this function yields.
+ */
+static int
+vy_run_load_bloom_partition(struct vy_run *run,
+			    struct vy_run_bloom_partition *partition)
+{
+	assert(run->index_fd >= 0);
+	struct tuple_bloom *bloom;
+	if (coio_call(vy_run_read_bloom_partition_f, run,
+		      partition, &bloom) != 0) {
+		diag_log();
+		say_error("error reading bloom filter of %s@%llu:%u",
+			  vy_run_index_filename(run),
+			  (unsigned long long)partition->offset,
+			  (unsigned)partition->size);
+		return -1;
+	}
+	if (partition->bloom != NULL) {
+		/* Loaded by another fiber while we were waiting. */
+		tuple_bloom_delete(bloom);
+		return 0;
+	}
+	partition->bloom = bloom;
+	return 0;
+}
+
+/**
+ * Check if a run may store statements matching a given key
+ * using its bloom filter. For a partitioned bloom filter, only
+ * partitions covering pages where the key may be found are
+ * checked. Partitions that have not been loaded yet are read
+ * from disk, which may yield.
+ *
+ * @retval 0 success, @a maybe_has is set
+ * @retval -1 read error
+ */
+static NODISCARD int
+vy_run_iterator_bloom_maybe_has(struct vy_run_iterator *itr,
+				const struct tuple *key, bool *maybe_has)
+{
+	struct vy_run *run = itr->slice->run;
+	struct vy_run_info *info = &run->info;
+	*maybe_has = true;
+	if (info->bloom != NULL) {
+		*maybe_has = vy_stmt_bloom_maybe_has(info->bloom, key,
+						     itr->key_def);
+		return 0;
+	}
+
+	bool unused;
+	uint32_t first = vy_page_index_find_page(run, key, itr->cmp_def,
+						 ITER_GE, &unused);
+	uint32_t last = vy_page_index_find_page(run, key, itr->cmp_def,
+						ITER_LE, &unused);
+	if (last >= info->page_count)
+		last = first;
+
+	/* Find the partition covering the first page. */
+	struct vy_run_bloom_partition *partitions = info->bloom_partitions;
+	uint32_t count = info->bloom_partition_count;
+	uint32_t lo = 0, hi = count;
+	while (hi - lo > 1) {
+		uint32_t mid = lo + (hi - lo) / 2;
+		if (partitions[mid].first_page_no <= first)
+			lo = mid;
+		else
+			hi = mid;
+	}
+	for (uint32_t i = lo; i < count; i++) {
+		struct vy_run_bloom_partition *partition = &partitions[i];
+		if (partition->first_page_no > last)
+			break;
+		if (partition->bloom == NULL) {
+			/*
+			 * Loading is done with coio and so is only
+			 * possible in the tx thread.
+			 */
+			if (!cord_is_main())
+				return 0;
+			if (vy_run_load_bloom_partition(run, partition) != 0)
+				return -1;
+		}
+		if (vy_stmt_bloom_maybe_has(partition->bloom, key,
+					    itr->key_def))
+			return 0;
+	}
+	*maybe_has = false;
+	return 0;
+}
+
 static NODISCARD int
 vy_run_iterator_do_seek(struct vy_run_iterator *itr,
 			enum iterator_type iterator_type,
@@ -1240,15 +2183,26 @@ vy_run_iterator_do_seek(struct vy_run_iterator *itr,
 
 	*ret = NULL;
 
-	struct tuple_bloom *bloom = run->info.bloom;
-	struct key_def *key_def = itr->key_def;
-	if (iterator_type == ITER_EQ && bloom != NULL &&
-	    !vy_stmt_bloom_maybe_has(bloom, key, key_def)) {
-		itr->search_ended = true;
-		itr->stat->bloom_hit++;
+	if (run->info.page_count == 0) {
+		/* The run stores nothing but range deletions. */
+		vy_run_iterator_stop(itr);
 		return 0;
 	}
 
+	bool has_bloom = run->info.bloom != NULL ||
+			 run->info.bloom_partition_count > 0;
+	if (iterator_type == ITER_EQ && has_bloom) {
+		bool maybe_has;
+		if (vy_run_iterator_bloom_maybe_has(itr, key,
+						    &maybe_has) != 0)
+			return -1;
+		if (!maybe_has) {
+			itr->search_ended = true;
+			itr->stat->bloom_hit++;
+			return 0;
+		}
+	}
+
 	itr->stat->lookup++;
 
 	struct vy_run_iterator_pos end_pos = {run->info.page_count, 0};
@@ -1268,7 +2222,7 @@ vy_run_iterator_do_seek(struct vy_run_iterator *itr,
 	}
 	if (iterator_type == ITER_EQ && !equal_found) {
 		vy_run_iterator_stop(itr);
-		if (bloom != NULL)
+		if (has_bloom)
 			itr->stat->bloom_miss++;
 		return 0;
 	}
@@ -1386,6 +2340,49 @@ vy_run_iterator_seek(struct vy_run_iterator *itr,
 	return 0;
 }
 
+/**
+ * Position the iterator to the newest visible statement for
+ * a given key. Unlike vy_run_iterator_seek(), the bloom filter
+ * is not checked, because the caller has done it already, and
+ * the pages loaded by the iterator are kept if the key is not
+ * found so that they can be reused for the next key.
+ *
+ * @retval 0 success or not found (*ret == NULL)
+ * @retval -1 read or memory error
+ */
+static NODISCARD int
+vy_run_iterator_lookup(struct vy_run_iterator *itr,
+		       const struct tuple *key, struct tuple **ret)
+{
+	struct vy_run *run = itr->slice->run;
+	bool has_bloom = run->info.bloom != NULL ||
+			 run->info.bloom_partition_count > 0;
+
+	*ret = NULL;
+	itr->key = key;
+	itr->search_started = true;
+	itr->search_ended = false;
+	itr->stat->lookup++;
+
+	bool equal_found = false;
+	if (vy_run_iterator_search(itr, ITER_EQ, key, &itr->curr_pos,
+				   &equal_found) != 0)
+		return -1;
+	if (itr->search_ended || !equal_found) {
+		itr->search_ended = true;
+		if (has_bloom)
+			itr->stat->bloom_miss++;
+		return 0;
+	}
+	if (itr->curr_stmt != NULL) {
+		tuple_unref(itr->curr_stmt);
+		itr->curr_stmt = NULL;
+	}
+	if (vy_run_iterator_read(itr, itr->curr_pos, &itr->curr_stmt) != 0)
+		return -1;
+	return vy_run_iterator_find_lsn(itr, ITER_EQ, key, ret);
+}
+
 /* }}} vy_run_iterator vy_run_iterator support functions */
 
 /* {{{ vy_run_iterator API implementation */
@@ -1594,6 +2591,86 @@ vy_run_iterator_close(struct vy_run_iterator *itr)
 	TRASH(itr);
 }
 
+NODISCARD int
+vy_slice_lookup_many(struct vy_slice *slice,
+		     struct vy_run_iterator_stat *stat,
+		     const struct vy_read_view **rv,
+		     struct key_def *cmp_def, struct key_def *key_def,
+		     struct tuple_format *format, struct tuple **keys,
+		     struct vy_history **histories, uint32_t key_count)
+{
+	struct vy_run *run = slice->run;
+	if (key_count == 0 || run->info.page_count == 0)
+		return 0;
+
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	size_t size = key_count * sizeof(uint32_t);
+	uint32_t *found = region_alloc(region, size);
+	if (found == NULL) {
+		diag_set(OutOfMemory, size, "region", "key array");
+		return -1;
+	}
+
+	int rc = -1;
+	struct vy_run_iterator itr;
+	vy_run_iterator_open(&itr, stat, slice, ITER_EQ, keys[0], rv,
+			     cmp_def, key_def, format);
+	/*
+	 * Check all keys against the slice boundaries and the
+	 * bloom filter before reading any page, so that keys
+	 * the run can't store cost no disk access at all.
+	 */
+	bool has_bloom = run->info.bloom != NULL ||
+			 run->info.bloom_partition_count > 0;
+	uint32_t found_count = 0;
+	for (uint32_t i = 0; i < key_count; i++) {
+		struct tuple *key = keys[i];
+		if (slice->begin != NULL &&
+		    vy_stmt_compare(key, slice->begin, cmp_def) < 0)
+			continue;
+		if (slice->end != NULL &&
+		    vy_stmt_compare(key, slice->end, cmp_def) >= 0)
+			continue;
+		if (has_bloom) {
+			bool maybe_has;
+			if (vy_run_iterator_bloom_maybe_has(&itr, key,
+							    &maybe_has) != 0)
+				goto out;
+			if (!maybe_has) {
+				stat->bloom_hit++;
+				continue;
+			}
+		}
+		found[found_count++] = i;
+	}
+	/*
+	 * The keys are sorted so the pages are visited in order
+	 * and a page that stores several of the keys is loaded
+	 * only once: it stays in the iterator page cache until
+	 * the iterator moves past it.
+	 */
+	for (uint32_t i = 0; i < found_count; i++) {
+		struct vy_history *history = histories[found[i]];
+		struct tuple *stmt;
+		if (vy_run_iterator_lookup(&itr, keys[found[i]], &stmt) != 0)
+			goto out;
+		while (stmt != NULL) {
+			if (vy_history_append_stmt(history, stmt) != 0)
+				goto out;
+			if (vy_history_is_terminal(history))
+				break;
+			if (vy_run_iterator_next_lsn(&itr, &stmt) != 0)
+				goto out;
+		}
+	}
+	rc = 0;
+out:
+	vy_run_iterator_close(&itr);
+	region_truncate(region, region_svp);
+	return rc;
+}
+
 /* }}} vy_run_iterator API implementation */
 
 /** Account a page to run statistics. */
@@ -1610,9 +2687,54 @@ vy_run_acct_page(struct vy_run *run, struct vy_page_info *page)
 	run->count.pages++;
 }
 
+/**
+ * Read the positions of bloom filter partitions that follow
+ * page info in the index file. The partitions themselves are
+ * loaded on demand, see vy_run_load_bloom_partition().
+ */
+static int
+vy_run_recover_bloom_partitions(struct vy_run *run,
+				struct xlog_cursor *cursor,
+				const char *path)
+{
+	for (uint32_t i = 0; i < run->info.bloom_partition_count; i++) {
+		struct vy_run_bloom_partition *partition;
+		partition = &run->info.bloom_partitions[i];
+		struct xrow_header xrow;
+		off_t offset = xlog_cursor_pos(cursor);
+		int rc = xlog_cursor_next_tx(cursor);
+		if (rc == 0)
+			rc = xlog_cursor_next_row(cursor, &xrow);
+		if (rc != 0) {
+			if (rc > 0)
+				diag_set(ClientError, ER_INVALID_INDEX_FILE,
+					 path, "Unexpected end of file");
+			return -1;
+		}
+		uint32_t page_no = partition->first_page_no;
+		if (page_no >= run->info.page_count ||
+		    (i == 0 && page_no != 0) ||
+		    (i > 0 && page_no <= partition[-1].first_page_no)) {
+			diag_set(ClientError, ER_INVALID_INDEX_FILE, path,
+				 tt_sprintf("Invalid bloom filter partition "
+					    "(first page %u)",
+					    (unsigned)page_no));
+			return -1;
+		}
+		if (vy_bloom_partition_decode(&xrow, path,
+					      &partition->bloom_size) == NULL)
+			return -1;
+		partition->offset = offset;
+		partition->size = xlog_cursor_pos(cursor) - offset;
+		partition->unpacked_size = cursor->tx_cursor.size;
+	}
+	return 0;
+}
+
 int
 vy_run_recover(struct vy_run *run, const char *dir,
-	       uint32_t space_id, uint32_t iid)
+	       uint32_t space_id, uint32_t iid,
+	       struct tuple_format *key_format)
 {
 	char path[PATH_MAX];
 	vy_run_snprint_path(path, sizeof(path), dir,
@@ -1661,7 +2783,7 @@ vy_run_recover(struct vy_run *run, const char *dir,
 		goto fail_close;
 	}
 
-	if (vy_run_info_decode(&run->info, &xrow, path) != 0)
+	if (vy_run_info_decode(&run->info, &xrow, path, key_format) != 0)
 		goto fail_close;
 
 	/* Allocate buffer for page info. */
@@ -1709,8 +2831,16 @@ vy_run_recover(struct vy_run *run, const char *dir,
 		vy_run_acct_page(run, page);
 	}
 
-	/* We don't need to keep metadata file open any longer. */
-	xlog_cursor_close(&cursor, false);
+	if (run->info.bloom_partition_count > 0) {
+		if (vy_run_recover_bloom_partitions(run, &cursor, path) != 0)
+			goto fail_close;
+		/* Keep metadata file open to load bloom partitions. */
+		run->index_fd = cursor.fd;
+		xlog_cursor_close(&cursor, true);
+	} else {
+		/* We don't need to keep metadata file open any longer. */
+		xlog_cursor_close(&cursor, false);
+	}
 
 	/* Prepare data file for reading. */
 	vy_run_snprint_path(path, sizeof(path), dir,
@@ -1730,6 +2860,10 @@ vy_run_recover(struct vy_run *run, const char *dir,
 fail_close:
 	xlog_cursor_close(&cursor, false);
 fail:
+	if (run->index_fd >= 0) {
+		close(run->index_fd);
+		run->index_fd = -1;
+	}
 	vy_run_clear(run);
 	diag_log();
 	say_error("failed to load `%s'", path);
@@ -1920,11 +3054,91 @@ vy_stmt_stat_encode(const struct vy_stmt_stat *stat, char *buf)
 	return buf;
 }
 
+/**
+ * Return the size of DELETE_RANGE statements encoded with
+ * vy_run_range_deletes_encode_array().
+ */
+static size_t
+vy_run_range_deletes_sizeof(struct tuple **range_deletes, uint32_t count)
+{
+	size_t size = mp_sizeof_array(count);
+	for (uint32_t i = 0; i < count; i++) {
+		struct tuple *stmt = range_deletes[i];
+		const char *tmp = vy_stmt_delete_range_end(stmt);
+		mp_next(&tmp);
+		size += mp_sizeof_array(3) +
+			mp_sizeof_uint(vy_stmt_lsn(stmt)) +
+			(tmp - tuple_data(stmt));
+	}
+	return size;
+}
+
+/**
+ * Encode DELETE_RANGE statements as an array of [lsn, begin, end],
+ * see vy_run_info_decode_range_deletes().
+ */
+static char *
+vy_run_range_deletes_encode_array(char *pos, struct tuple **range_deletes,
+				  uint32_t count)
+{
+	pos = mp_encode_array(pos, count);
+	for (uint32_t i = 0; i < count; i++) {
+		struct tuple *stmt = range_deletes[i];
+		const char *tmp = vy_stmt_delete_range_end(stmt);
+		mp_next(&tmp);
+		pos = mp_encode_array(pos, 3);
+		pos = mp_encode_uint(pos, vy_stmt_lsn(stmt));
+		memcpy(pos, tuple_data(stmt), tmp - tuple_data(stmt));
+		pos += tmp - tuple_data(stmt);
+	}
+	return pos;
+}
+
+/**
+ * Encode DELETE_RANGE statements as xrow written to the end of
+ * a .run file. The statements are also stored in the run info,
+ * this copy is only used to rebuild a lost .index file, see
+ * vy_run_rebuild_index().
+ * Allocates using region alloc
+ *
+ * @param range_deletes DELETE_RANGE statements stored in the run
+ * @param count number of DELETE_RANGE statements
+ * @param[out] xrow xrow to fill.
+ * @retval 0 for success
+ * @retval -1 for error
+ */
+static int
+vy_run_range_deletes_encode(struct tuple **range_deletes, uint32_t count,
+			    struct xrow_header *xrow)
+{
+	memset(xrow, 0, sizeof(*xrow));
+	xrow->type = VY_RUN_RANGE_DELETES;
+
+	size_t size = mp_sizeof_map(1) +
+		      mp_sizeof_uint(VY_RUN_INFO_RANGE_DELETES) +
+		      vy_run_range_deletes_sizeof(range_deletes, count);
+	char *pos = region_alloc(&fiber()->gc, size);
+	if (pos == NULL) {
+		diag_set(OutOfMemory, size, "region", "range deletes");
+		return -1;
+	}
+	xrow->body->iov_base = pos;
+	pos = mp_encode_map(pos, 1);
+	pos = mp_encode_uint(pos, VY_RUN_INFO_RANGE_DELETES);
+	pos = vy_run_range_deletes_encode_array(pos, range_deletes, count);
+	xrow->body->iov_len = (void *)pos - xrow->body->iov_base;
+	assert(xrow->body->iov_len == size);
+	xrow->bodycnt = 1;
+	return 0;
+}
+
 /**
  * Encode vy_run_info as xrow
  * Allocates using region alloc
  *
  * @param run_info the run information
+ * @param range_deletes DELETE_RANGE statements stored in the run
+ * @param range_delete_count number of DELETE_RANGE statements
  * @param xrow xrow to fill.
  *
  * @retval  0 success
@@ -1932,6 +3146,7 @@ vy_stmt_stat_encode(const struct vy_stmt_stat *stat, char *buf)
  */
 static int
 vy_run_info_encode(const struct vy_run_info *run_info,
+		   struct tuple **range_deletes, uint32_t range_delete_count,
 		   struct xrow_header *xrow)
 {
 	const char *tmp;
@@ -1945,6 +3160,10 @@ vy_run_info_encode(const struct vy_run_info *run_info,
 	uint32_t key_count = 6;
 	if (run_info->bloom != NULL)
 		key_count++;
+	if (run_info->bloom_partition_count > 0)
+		key_count++;
+	if (range_delete_count > 0)
+		key_count++;
 
 	size_t size = mp_sizeof_map(key_count);
 	size += mp_sizeof_uint(VY_RUN_INFO_MIN_KEY) + min_key_size;
@@ -1960,6 +3179,18 @@ vy_run_info_encode(const struct vy_run_info *run_info,
 			tuple_bloom_size(run_info->bloom);
 	size += mp_sizeof_uint(VY_RUN_INFO_STMT_STAT) +
 		vy_stmt_stat_sizeof(&run_info->stmt_stat);
+	if (run_info->bloom_partition_count > 0) {
+		size += mp_sizeof_uint(VY_RUN_INFO_BLOOM_PARTITIONS) +
+			mp_sizeof_array(run_info->bloom_partition_count);
+		for (uint32_t i = 0; i < run_info->bloom_partition_count; i++)
+			size += mp_sizeof_uint(
+				run_info->bloom_partitions[i].first_page_no);
+	}
+	if (range_delete_count > 0) {
+		size += mp_sizeof_uint(VY_RUN_INFO_RANGE_DELETES) +
+			vy_run_range_deletes_sizeof(range_deletes,
+						    range_delete_count);
+	}
 
 	char *pos = region_alloc(&fiber()->gc, size);
 	if (pos == NULL) {
@@ -1988,6 +3219,18 @@ vy_run_info_encode(const struct vy_run_info *run_info,
 	}
 	pos = mp_encode_uint(pos, VY_RUN_INFO_STMT_STAT);
 	pos = vy_stmt_stat_encode(&run_info->stmt_stat, pos);
+	if (run_info->bloom_partition_count > 0) {
+		pos = mp_encode_uint(pos, VY_RUN_INFO_BLOOM_PARTITIONS);
+		pos = mp_encode_array(pos, run_info->bloom_partition_count);
+		for (uint32_t i = 0; i < run_info->bloom_partition_count; i++)
+			pos = mp_encode_uint(pos,
+				run_info->bloom_partitions[i].first_page_no);
+	}
+	if (range_delete_count > 0) {
+		pos = mp_encode_uint(pos, VY_RUN_INFO_RANGE_DELETES);
+		pos = vy_run_range_deletes_encode_array(pos, range_deletes,
+							range_delete_count);
+	}
 	xrow->body->iov_len = (void *)pos - xrow->body->iov_base;
 	xrow->bodycnt = 1;
 	xrow->type = VY_INDEX_RUN_INFO;
@@ -1996,12 +3239,62 @@ vy_run_info_encode(const struct vy_run_info *run_info,
 
 /* vy_run_info }}} */
 
+/**
+ * Write a bloom filter partition to the index file in a separate
+ * transaction and remember its position so that it can be loaded
+ * on demand after restart.
+ */
+static int
+vy_run_write_bloom_partition(struct xlog *xlog,
+			     struct vy_run_bloom_partition *partition)
+{
+	if (xlog_flush(xlog) < 0)
+		return -1;
+	partition->offset = xlog->offset;
+
+	struct region *region = &fiber()->gc;
+	size_t mem_used = region_used(region);
+	size_t size = mp_sizeof_map(1) + mp_sizeof_uint(VY_RUN_INFO_BLOOM) +
+		      tuple_bloom_size(partition->bloom);
+	char *pos = region_alloc(region, size);
+	if (pos == NULL) {
+		diag_set(OutOfMemory, size, "region", "bloom partition");
+		return -1;
+	}
+	struct xrow_header xrow;
+	memset(&xrow, 0, sizeof(xrow));
+	xrow.body->iov_base = pos;
+	pos = mp_encode_map(pos, 1);
+	pos = mp_encode_uint(pos, VY_RUN_INFO_BLOOM);
+	pos = tuple_bloom_encode(partition->bloom, pos);
+	xrow.body->iov_len = (void *)pos - xrow.body->iov_base;
+	xrow.bodycnt = 1;
+	xrow.type = VY_INDEX_BLOOM;
+
+	xlog_tx_begin(xlog);
+	ssize_t written = xlog_write_row(xlog, &xrow);
+	region_truncate(region, mem_used);
+	if (written < 0) {
+		xlog_tx_rollback(xlog);
+		return -1;
+	}
+	partition->unpacked_size = written;
+	written = xlog_tx_commit(xlog);
+	if (written == 0)
+		written = xlog_flush(xlog);
+	if (written < 0)
+		return -1;
+	partition->size = written;
+	return 0;
+}
+
 /**
  * Write run index to file.
  */
 static int
 vy_run_write_index(struct vy_run *run, const char *dirpath,
-		   uint32_t space_id, uint32_t iid)
+		   uint32_t space_id, uint32_t iid,
+		   struct tuple **range_deletes, uint32_t range_delete_count)
 {
 	char path[PATH_MAX];
 	vy_run_snprint_path(path, sizeof(path), dirpath,
@@ -2023,7 +3316,8 @@ vy_run_write_index(struct vy_run *run, const char *dirpath,
 	size_t mem_used = region_used(region);
 
 	struct xrow_header xrow;
-	if (vy_run_info_encode(&run->info, &xrow) != 0 ||
+	if (vy_run_info_encode(&run->info, range_deletes,
+			       range_delete_count, &xrow) != 0 ||
 	    xlog_write_row(&index_xlog, &xrow) < 0)
 		goto fail_rollback;
 
@@ -2040,6 +3334,12 @@ vy_run_write_index(struct vy_run *run, const char *dirpath,
 	if (xlog_tx_commit(&index_xlog) < 0)
 		goto fail;
 
+	for (uint32_t i = 0; i < run->info.bloom_partition_count; i++) {
+		if (vy_run_write_bloom_partition(&index_xlog,
+					&run->info.bloom_partitions[i]) != 0)
+			goto fail;
+	}
+
 	ERROR_INJECT(ERRINJ_VY_INDEX_FILE_RENAME, {
 		diag_set(ClientError, ER_INJECTION, "vinyl index file rename");
 		xlog_close(&index_xlog, false);
@@ -2062,6 +3362,86 @@ fail:
 	return -1;
 }
 
+/**
+ * Build a bloom filter partition covering pages starting from
+ * @a first_page_no out of the keys accumulated by @a builder
+ * and replace the builder with an empty one.
+ */
+static int
+vy_run_add_bloom_partition(struct vy_run *run, uint32_t first_page_no,
+			   struct tuple_bloom_builder **builder, double fpr)
+{
+	struct vy_run_info *info = &run->info;
+	size_t size = (info->bloom_partition_count + 1) *
+		      sizeof(*info->bloom_partitions);
+	struct vy_run_bloom_partition *partitions;
+	partitions = realloc(info->bloom_partitions, size);
+	if (partitions == NULL) {
+		diag_set(OutOfMemory, size, "realloc",
+			 "struct vy_run_bloom_partition");
+		return -1;
+	}
+	info->bloom_partitions = partitions;
+
+	struct tuple_bloom_builder *next;
+	next = tuple_bloom_builder_new((*builder)->part_count);
+	if (next == NULL)
+		return -1;
+	struct tuple_bloom *bloom = tuple_bloom_new(*builder, fpr);
+	if (bloom == NULL) {
+		tuple_bloom_builder_delete(next);
+		return -1;
+	}
+	tuple_bloom_builder_delete(*builder);
+	*builder = next;
+
+	struct vy_run_bloom_partition *partition;
+	partition = &partitions[info->bloom_partition_count++];
+	memset(partition, 0, sizeof(*partition));
+	partition->first_page_no = first_page_no;
+	partition->bloom = bloom;
+	partition->bloom_size = tuple_bloom_size(bloom);
+	return 0;
+}
+
+/**
+ * Called before starting a new page of a run. If the run has
+ * grown big enough, split off the keys of the previous pages
+ * into a bloom filter partition.
+ */
+static int
+vy_run_split_bloom(struct vy_run *run, struct tuple_bloom_builder **builder,
+		   double fpr)
+{
+	uint32_t page_count = run->info.page_count;
+	if (*builder == NULL || page_count == 0 ||
+	    page_count % VY_RUN_BLOOM_PARTITION_PAGES != 0)
+		return 0;
+	return vy_run_add_bloom_partition(run, page_count -
+					  VY_RUN_BLOOM_PARTITION_PAGES,
+					  builder, fpr);
+}
+
+/**
+ * Build the bloom filter of a run out of the keys accumulated
+ * by @a builder after all pages have been written. Small runs
+ * get a single filter, big ones get the last partition.
+ */
+static int
+vy_run_finish_bloom(struct vy_run *run, struct tuple_bloom_builder **builder,
+		    double fpr)
+{
+	struct vy_run_info *info = &run->info;
+	if (info->bloom_partition_count == 0) {
+		info->bloom = tuple_bloom_new(*builder, fpr);
+		return info->bloom == NULL ? -1 : 0;
+	}
+	uint32_t first_page_no = info->bloom_partition_count *
+				 VY_RUN_BLOOM_PARTITION_PAGES;
+	assert(first_page_no < info->page_count);
+	return vy_run_add_bloom_partition(run, first_page_no, builder, fpr);
+}
+
 int
 vy_run_writer_create(struct vy_run_writer *writer, struct vy_run *run,
 		     const char *dirpath, uint32_t space_id, uint32_t iid,
@@ -2131,6 +3511,8 @@ vy_run_writer_start_page(struct vy_run_writer *writer,
 	if (run->info.page_count >= writer->page_info_capacity &&
 	    vy_run_alloc_page_info(run, &writer->page_info_capacity) != 0)
 		return -1;
+	if (vy_run_split_bloom(run, &writer->bloom, writer->bloom_fpr) != 0)
+		return -1;
 	const char *key = vy_stmt_is_key(first_stmt) ? tuple_data(first_stmt) :
 			  tuple_extract_key(first_stmt, writer->cmp_def, NULL);
 	if (key == NULL)
@@ -2264,6 +3646,41 @@ vy_run_writer_destroy(struct vy_run_writer *writer, bool reuse_fd)
 	ibuf_destroy(&writer->row_index_buf);
 }
 
+void
+vy_run_writer_add_range_deletes(struct vy_run_writer *writer,
+				struct tuple **range_deletes, uint32_t count)
+{
+	assert(writer->range_deletes == NULL);
+	writer->range_deletes = range_deletes;
+	writer->range_delete_count = count;
+}
+
+/**
+ * Write DELETE_RANGE statements to the end of the run file
+ * in a separate transaction, after all pages.
+ * @param writer Run writer.
+ * @retval -1 Memory or IO error.
+ * @retval  0 Success.
+ */
+static int
+vy_run_writer_write_range_deletes(struct vy_run_writer *writer)
+{
+	struct xrow_header xrow;
+	if (vy_run_range_deletes_encode(writer->range_deletes,
+					writer->range_delete_count,
+					&xrow) != 0)
+		return -1;
+	xlog_tx_begin(&writer->data_xlog);
+	if (xlog_write_row(&writer->data_xlog, &xrow) < 0)
+		return -1;
+	ssize_t written = xlog_tx_commit(&writer->data_xlog);
+	if (written == 0)
+		written = xlog_flush(&writer->data_xlog);
+	if (written < 0)
+		return -1;
+	return 0;
+}
+
 int
 vy_run_writer_commit(struct vy_run_writer *writer)
 {
@@ -2275,25 +3692,50 @@ vy_run_writer_commit(struct vy_run_writer *writer)
 		goto out;
 
 	struct vy_run *run = writer->run;
-	if (vy_run_is_empty(run)) {
+	if (run->info.page_count == 0 && writer->range_delete_count == 0) {
 		vy_run_writer_destroy(writer, false);
 		rc = 0;
 		goto out;
 	}
 
-	assert(writer->last_stmt != NULL);
-	const char *key = vy_stmt_is_key(writer->last_stmt) ?
-		          tuple_data(writer->last_stmt) :
-			  tuple_extract_key(writer->last_stmt,
-					    writer->cmp_def, NULL);
-	if (key == NULL)
-		goto out;
+	for (uint32_t i = 0; i < writer->range_delete_count; i++) {
+		int64_t lsn = vy_stmt_lsn(writer->range_deletes[i]);
+		run->info.min_lsn = MIN(run->info.min_lsn, lsn);
+		run->info.max_lsn = MAX(run->info.max_lsn, lsn);
+	}
+
+	const char *key;
+	if (run->info.page_count > 0) {
+		assert(writer->last_stmt != NULL);
+		key = vy_stmt_is_key(writer->last_stmt) ?
+		      tuple_data(writer->last_stmt) :
+		      tuple_extract_key(writer->last_stmt,
+					writer->cmp_def, NULL);
+		if (key == NULL)
+			goto out;
+	} else {
+		/*
+		 * The run stores nothing but range deletions.
+		 * It still needs a data file and key boundaries.
+		 */
+		if (vy_run_writer_create_xlog(writer) != 0)
+			goto out;
+		key = tuple_data(writer->range_deletes[0]);
+		assert(run->info.min_key == NULL);
+		run->info.min_key = vy_key_dup(key);
+		if (run->info.min_key == NULL)
+			goto out;
+	}
 
 	assert(run->info.max_key == NULL);
 	run->info.max_key = vy_key_dup(key);
 	if (run->info.max_key == NULL)
 		goto out;
 
+	if (writer->range_delete_count > 0 &&
+	    vy_run_writer_write_range_deletes(writer) != 0)
+		goto out;
+
 	ERROR_INJECT(ERRINJ_VY_RUN_FILE_RENAME, {
 		diag_set(ClientError, ER_INJECTION, "vinyl run file rename");
 		goto out;
@@ -2304,14 +3746,13 @@ vy_run_writer_commit(struct vy_run_writer *writer)
 	    xlog_rename(&writer->data_xlog) < 0)
 		goto out;
 
-	if (writer->bloom != NULL) {
-		run->info.bloom = tuple_bloom_new(writer->bloom,
-						  writer->bloom_fpr);
-		if (run->info.bloom == NULL)
-			goto out;
-	}
+	if (writer->bloom != NULL && run->info.page_count > 0 &&
+	    vy_run_finish_bloom(run, &writer->bloom, writer->bloom_fpr) != 0)
+		goto out;
 	if (vy_run_write_index(run, writer->dirpath,
-			       writer->space_id, writer->iid) != 0)
+			       writer->space_id, writer->iid,
+			       writer->range_deletes,
+			       writer->range_delete_count) != 0)
 		goto out;
 
 	run->fd = writer->data_xlog.fd;
@@ -2328,11 +3769,46 @@ vy_run_writer_abort(struct vy_run_writer *writer)
 	vy_run_writer_destroy(writer, false);
 }
 
+/**
+ * Decode DELETE_RANGE statements written to the end of a .run
+ * file by vy_run_writer_write_range_deletes().
+ */
+static int
+vy_run_range_deletes_decode(struct vy_run_info *run_info,
+			    struct xrow_header *xrow,
+			    struct tuple_format *key_format)
+{
+	assert(xrow->type == VY_RUN_RANGE_DELETES);
+	if (run_info->range_deletes != NULL) {
+		diag_set(ClientError, ER_INVALID_RUN_FILE,
+			 "Duplicate range deletes");
+		return -1;
+	}
+	const char *pos = xrow->body->iov_base;
+	uint32_t map_size = mp_decode_map(&pos);
+	for (uint32_t i = 0; i < map_size; i++) {
+		uint32_t key = mp_decode_uint(&pos);
+		switch (key) {
+		case VY_RUN_INFO_RANGE_DELETES:
+			if (vy_run_info_decode_range_deletes(run_info, &pos,
+							     key_format) != 0)
+				return -1;
+			break;
+		default:
+			mp_next(&pos);
+			break;
+		}
+	}
+	return 0;
+}
+
 int
 vy_run_rebuild_index(struct vy_run *run, const char *dir,
 		     uint32_t space_id, uint32_t iid,
 		     struct key_def *cmp_def, struct key_def *key_def,
-		     struct tuple_format *format, const struct index_opts *opts)
+		     struct tuple_format *format,
+		     struct tuple_format *key_format,
+		     const struct index_opts *opts)
 {
 	assert(run->info.bloom == NULL);
 	assert(run->page_info == NULL);
@@ -2370,15 +3846,26 @@ vy_run_rebuild_index(struct vy_run *run, const char *dir,
 		page_offset = next_page_offset;
 		next_page_offset = xlog_cursor_pos(&cursor);
 
+		uint64_t row_offset = xlog_cursor_tx_pos(&cursor);
+		struct xrow_header xrow;
+		rc = xlog_cursor_next_row(&cursor, &xrow);
+		if (rc == 0 && xrow.type == VY_RUN_RANGE_DELETES) {
+			/* Not a page, follows all pages of the run. */
+			if (vy_run_range_deletes_decode(&run->info, &xrow,
+							key_format) != 0)
+				goto close_err;
+			continue;
+		}
 		if (run->info.page_count == page_info_capacity &&
 		    vy_run_alloc_page_info(run, &page_info_capacity) != 0)
 			goto close_err;
+		if (vy_run_split_bloom(run, &bloom_builder,
+				       opts->bloom_fpr) != 0)
+			goto close_err;
 		uint32_t page_row_count = 0;
 		uint64_t page_row_index_offset = 0;
-		uint64_t row_offset = xlog_cursor_tx_pos(&cursor);
 
-		struct xrow_header xrow;
-		while ((rc = xlog_cursor_next_row(&cursor, &xrow)) == 0) {
+		for (; rc == 0; rc = xlog_cursor_next_row(&cursor, &xrow)) {
 			if (xrow.type == VY_RUN_ROW_INDEX) {
 				page_row_index_offset = row_offset;
 				row_offset = xlog_cursor_tx_pos(&cursor);
@@ -2432,6 +3919,18 @@ vy_run_rebuild_index(struct vy_run *run, const char *dir,
 		page_min_key = NULL;
 	}
 
+	for (uint32_t i = 0; i < run->info.range_delete_count; i++) {
+		int64_t lsn = vy_stmt_lsn(run->info.range_deletes[i]);
+		max_lsn = MAX(max_lsn, lsn);
+		min_lsn = MIN(min_lsn, lsn);
+	}
+	if (key == NULL && run->info.range_delete_count > 0) {
+		/* See vy_run_writer_commit(). */
+		key = tuple_data(run->info.range_deletes[0]);
+		run->info.min_key = vy_key_dup(key);
+		if (run->info.min_key == NULL)
+			goto close_err;
+	}
 	if (key != NULL) {
 		run->info.max_key = vy_key_dup(key);
 		if (run->info.max_key == NULL)
@@ -2449,9 +3948,8 @@ vy_run_rebuild_index(struct vy_run *run, const char *dir,
 	xlog_cursor_close(&cursor, true);
 
 	if (bloom_builder != NULL) {
-		run->info.bloom = tuple_bloom_new(bloom_builder,
-						  opts->bloom_fpr);
-		if (run->info.bloom == NULL)
+		if (vy_run_finish_bloom(run, &bloom_builder,
+					opts->bloom_fpr) != 0)
 			goto close_err;
 		tuple_bloom_builder_delete(bloom_builder);
 		bloom_builder = NULL;
@@ -2465,7 +3963,9 @@ vy_run_rebuild_index(struct vy_run *run, const char *dir,
 			 path);
 		goto close_err;
 	}
-	if (vy_run_write_index(run, dir, space_id, iid) != 0)
+	if (vy_run_write_index(run, dir, space_id, iid,
+			       (struct tuple **)run->info.range_deletes,
+			       run->info.range_delete_count) != 0)
 		goto close_err;
 	return 0;
 close_err:
@@ -2546,6 +4046,8 @@ vy_slice_stream_search(struct vy_stmt_stream *virt_stream)
 	assert(virt_stream->iface->start == vy_slice_stream_search);
 	struct vy_slice_stream *stream = (struct vy_slice_stream *)virt_stream;
 	assert(stream->page == NULL);
+	if (stream->slice->run->info.page_count == 0)
+		return 0;
 	if (stream->slice->begin == NULL) {
 		/* Already at the beginning */
 		assert(stream->page_no == 0);
@@ -2603,7 +4105,8 @@ vy_slice_stream_next(struct vy_stmt_stream *virt_stream, struct tuple **ret)
 	*ret = NULL;
 
 	/* If the slice is ended, return EOF */
-	if (stream->page_no > stream->slice->last_page_no)
+	if (stream->page_no > stream->slice->last_page_no ||
+	    stream->slice->run->info.page_count == 0)
 		return 0;
 
 	/* If current page is not already read, read it */
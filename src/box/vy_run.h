@@ -51,6 +51,31 @@ extern "C" {
 
 struct vy_history;
 struct vy_run_reader;
+struct vy_page;
+struct mh_vy_page_cache_t;
+
+/**
+ * Cache of decompressed run pages shared by all run iterators
+ * of a vinyl environment, so that a hot page isn't read from
+ * disk and decompressed on each lookup. Pages are evicted in
+ * the LRU order when the cache size exceeds the quota. A page
+ * evicted while used by an iterator is freed by the iterator.
+ * The cache is only accessed from the tx thread.
+ */
+struct vy_page_cache {
+	/** Cached pages, keyed by run id and page number. */
+	struct mh_vy_page_cache_t *hash;
+	/** Cached pages, the most recently used first. */
+	struct rlist lru;
+	/** Memory used by cached pages. */
+	size_t mem_used;
+	/** Max memory that can be used by cached pages. */
+	size_t mem_quota;
+	/** Number of lookups that found a page in the cache. */
+	int64_t hit;
+	/** Number of lookups that had to read a page from disk. */
+	int64_t miss;
+};
 
 /** Part of vinyl environment for run read/write */
 struct vy_run_env {
@@ -69,6 +94,38 @@ struct vy_run_env {
 	 * processing the next read request.
 	 */
 	int next_reader;
+	/**
+	 * Set if reader threads use io_uring to keep many page
+	 * reads in flight instead of doing one blocking read at
+	 * a time.
+	 */
+	bool use_io_uring;
+	/** Set if io_uring reads bypass the OS page cache. */
+	bool use_direct_io;
+	/** Cache of pages read by run iterators. */
+	struct vy_page_cache page_cache;
+};
+
+/**
+ * Bloom filter of statements stored in a range of run pages.
+ *
+ * Bloom filters of big runs are split in partitions, each of
+ * which is stored in the index file in a separate transaction
+ * and loaded on the first lookup in the page range it covers.
+ */
+struct vy_run_bloom_partition {
+	/** Number of the first page covered by the partition. */
+	uint32_t first_page_no;
+	/** Offset of the partition in the index file. */
+	uint64_t offset;
+	/** Size of the partition in the index file. */
+	uint32_t size;
+	/** Size of the partition when unpacked. */
+	uint32_t unpacked_size;
+	/** Size of the encoded bloom filter. */
+	uint32_t bloom_size;
+	/** Bloom filter or NULL if it has not been loaded yet. */
+	struct tuple_bloom *bloom;
 };
 
 /**
@@ -87,8 +144,24 @@ struct vy_run_info {
 	uint32_t page_count;
 	/** Bloom filter of all tuples in run */
 	struct tuple_bloom *bloom;
+	/**
+	 * Partitioned bloom filter, used instead of @bloom
+	 * for runs having many pages.
+	 */
+	struct vy_run_bloom_partition *bloom_partitions;
+	/** Number of bloom filter partitions. */
+	uint32_t bloom_partition_count;
 	/** Statement statistics. */
 	struct vy_stmt_stat stmt_stat;
+	/**
+	 * DELETE_RANGE statements stored in the run. They are
+	 * kept in the index file rather than in pages, because
+	 * every lookup in the run has to check them. Referenced
+	 * by the run.
+	 */
+	const struct tuple **range_deletes;
+	/** Number of DELETE_RANGE statements. */
+	uint32_t range_delete_count;
 };
 
 /**
@@ -121,6 +194,17 @@ struct vy_run {
 	struct vy_page_info *page_info;
 	/** Run data file. */
 	int fd;
+	/**
+	 * Run index file, used for loading bloom filter
+	 * partitions, -1 if the run doesn't need it.
+	 */
+	int index_fd;
+	/**
+	 * Run data file opened with O_DIRECT, used by io_uring
+	 * reads if direct I/O is enabled. Opened on demand,
+	 * -1 if not opened.
+	 */
+	int direct_fd;
 	/** Unique ID of this run. */
 	int64_t id;
 	/** Number of statements in this run. */
@@ -153,6 +237,11 @@ struct vy_run {
 	int refs;
 	/** Number of slices created for this run. */
 	int slice_count;
+	/**
+	 * Set if pages of this run may be stored in the page
+	 * cache, so they must be evicted when the run is deleted.
+	 */
+	bool has_cached_pages;
 	/**
 	 * Counter used on completion of a compaction task to check if
 	 * all slices of the run have been compacted and so the run is
@@ -297,6 +386,15 @@ struct vy_page {
 	uint32_t *row_index;
 	/** Pointer to the page data. */
 	char *data;
+	/** ID of the run the page was read from. */
+	int64_t run_id;
+	/**
+	 * Reference counter. A page is referenced by the page
+	 * cache and by each run iterator that keeps it.
+	 */
+	int refs;
+	/** Link in vy_page_cache::lru, empty if not cached. */
+	struct rlist in_lru;
 };
 
 /**
@@ -315,6 +413,23 @@ vy_run_env_create(struct vy_run_env *env, int read_threads);
 void
 vy_run_env_destroy(struct vy_run_env *env);
 
+/**
+ * Set the max size of the page cache of a vinyl run
+ * environment, evicting pages if it is exceeded. 0 disables
+ * the cache.
+ */
+void
+vy_run_env_set_page_cache(struct vy_run_env *env, size_t quota);
+
+/**
+ * Make reader threads of a vinyl run environment use io_uring.
+ * If @a direct is set, run files are read with O_DIRECT.
+ * Must be called before coio reads are enabled. If io_uring
+ * isn't supported, reader threads fall back on blocking reads.
+ */
+void
+vy_run_env_set_io_uring(struct vy_run_env *env, bool enable, bool direct);
+
 /**
  * Enable coio reads for a vinyl run environment.
  *
@@ -346,9 +461,36 @@ vy_run_page_info(struct vy_run *run, uint32_t pos)
 static inline bool
 vy_run_is_empty(struct vy_run *run)
 {
-	return run->info.page_count == 0;
+	return run->info.page_count == 0 && run->info.range_delete_count == 0;
+}
+
+/**
+ * Return the newest DELETE_RANGE statement of a run visible from
+ * read view @vlsn that covers @stmt or NULL if there's no such one.
+ */
+static inline const struct tuple *
+vy_run_find_range_delete(struct vy_run *run, const struct tuple *stmt,
+			 int64_t vlsn, struct key_def *cmp_def)
+{
+	if (run->info.range_delete_count == 0)
+		return NULL;
+	return vy_stmt_find_range_delete(run->info.range_deletes,
+					 run->info.range_delete_count,
+					 stmt, vlsn, cmp_def);
 }
 
+/**
+ * Make a run reference the given DELETE_RANGE statements.
+ * Must be called from the tx thread after the run has been
+ * written, see vy_run_writer_add_range_deletes().
+ *
+ * @retval  0 Success.
+ * @retval -1 Memory error.
+ */
+int
+vy_run_set_range_deletes(struct vy_run *run, struct tuple **range_deletes,
+			 uint32_t count);
+
 struct vy_run *
 vy_run_new(struct vy_run_env *env, int64_t id);
 
@@ -376,11 +518,13 @@ vy_run_unref(struct vy_run *run)
  * @param dir - path to the vinyl directory
  * @param space_id - space id
  * @param iid - index id
+ * @param key_format - format of DELETE_RANGE statements
  * @return - 0 on sucess, -1 on fail
  */
 int
 vy_run_recover(struct vy_run *run, const char *dir,
-	       uint32_t space_id, uint32_t iid);
+	       uint32_t space_id, uint32_t iid,
+	       struct tuple_format *key_format);
 
 /**
  * Rebuild run index
@@ -391,6 +535,8 @@ vy_run_recover(struct vy_run *run, const char *dir,
  * @param cmp_def - key definition with primary key parts
  * @param key_def - user defined key definition
  * @param format - format for allocating tuples read from disk
+ * @param key_format - format for allocating DELETE_RANGE
+ *                     statements read from disk
  * @param opts - index options
  * @return - 0 on sucess, -1 on fail
  */
@@ -399,6 +545,7 @@ vy_run_rebuild_index(struct vy_run *run, const char *dir,
 		     uint32_t space_id, uint32_t iid,
 		     struct key_def *cmp_def, struct key_def *key_def,
 		     struct tuple_format *format,
+		     struct tuple_format *key_format,
 		     const struct index_opts *opts);
 
 enum vy_file_type {
@@ -548,6 +695,26 @@ vy_run_iterator_skip(struct vy_run_iterator *itr,
 void
 vy_run_iterator_close(struct vy_run_iterator *itr);
 
+/**
+ * Look up a batch of full keys in a run slice. The keys must be
+ * sorted and unique. Statements found for keys[i] are appended
+ * to histories[i] up to the first terminal statement.
+ *
+ * All keys are checked against the bloom filter first, then the
+ * remaining keys are looked up in the page order so that a page
+ * shared by several keys is read only once.
+ *
+ * The caller must pin the slice, because this function yields.
+ * Returns 0 on success, -1 on memory allocation or IO error.
+ */
+NODISCARD int
+vy_slice_lookup_many(struct vy_slice *slice,
+		     struct vy_run_iterator_stat *stat,
+		     const struct vy_read_view **rv,
+		     struct key_def *cmp_def, struct key_def *key_def,
+		     struct tuple_format *format, struct tuple **keys,
+		     struct vy_history **histories, uint32_t key_count);
+
 /**
  * Simple stream over a slice. @see vy_stmt_stream.
  */
@@ -625,6 +792,10 @@ struct vy_run_writer {
 	 * of max key of a finished run.
 	 */
 	struct tuple *last_stmt;
+	/** DELETE_RANGE statements to store in the run index. */
+	struct tuple **range_deletes;
+	/** Number of DELETE_RANGE statements. */
+	uint32_t range_delete_count;
 };
 
 /** Create a run writer to fill a run with statements. */
@@ -645,6 +816,17 @@ vy_run_writer_create(struct vy_run_writer *writer, struct vy_run *run,
 int
 vy_run_writer_append_stmt(struct vy_run_writer *writer, struct tuple *stmt);
 
+/**
+ * Store DELETE_RANGE statements in a run. The statements aren't
+ * copied and must stay valid until the writer is committed.
+ * Since the writer may run in a worker thread, it doesn't make
+ * the run reference them - vy_run_set_range_deletes() must be
+ * called for that after commit.
+ */
+void
+vy_run_writer_add_range_deletes(struct vy_run_writer *writer,
+				struct tuple **range_deletes, uint32_t count);
+
 /**
  * Finalize run writing by writing run index into file. The writer
  * is deleted after call.
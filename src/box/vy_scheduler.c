@@ -1074,8 +1074,15 @@ vy_task_write_run(struct vy_task *task)
 	}
 	wi->iface->stop(wi);
 
-	if (rc == 0)
+	if (rc == 0) {
+		struct tuple **range_deletes;
+		uint32_t range_delete_count;
+		vy_write_iterator_get_range_deletes(wi, &range_deletes,
+						    &range_delete_count);
+		vy_run_writer_add_range_deletes(&writer, range_deletes,
+						range_delete_count);
 		rc = vy_run_writer_commit(&writer);
+	}
 	if (rc != 0)
 		goto fail_abort_writer;
 
@@ -1087,6 +1094,50 @@ fail:
 	return -1;
 }
 
+/**
+ * Extend the key interval [*min_key, *max_key] so that it spans
+ * all keys covered by DELETE_RANGE statements stored in a run.
+ * NULL stands for infinity.
+ */
+static void
+vy_run_range_delete_bounds(struct vy_run *run, struct key_def *cmp_def,
+			   const char **min_key, const char **max_key)
+{
+	for (uint32_t i = 0; i < run->info.range_delete_count; i++) {
+		const struct tuple *stmt = run->info.range_deletes[i];
+		const char *begin = tuple_data(stmt);
+		const char *end = vy_stmt_delete_range_end(stmt);
+		const char *tmp = begin;
+		if (mp_decode_array(&tmp) == 0)
+			*min_key = NULL;
+		else if (*min_key != NULL &&
+			 key_compare(begin, *min_key, cmp_def) < 0)
+			*min_key = begin;
+		tmp = end;
+		if (mp_decode_array(&tmp) == 0)
+			*max_key = NULL;
+		else if (*max_key != NULL &&
+			 key_compare(end, *max_key, cmp_def) > 0)
+			*max_key = end;
+	}
+}
+
+/**
+ * Make a written run reference DELETE_RANGE statements stored
+ * in it. The write iterator doesn't do that, because it runs
+ * in a worker thread.
+ */
+static int
+vy_task_set_range_deletes(struct vy_task *task)
+{
+	struct tuple **range_deletes;
+	uint32_t range_delete_count;
+	vy_write_iterator_get_range_deletes(task->wi, &range_deletes,
+					    &range_delete_count);
+	return vy_run_set_range_deletes(task->new_run, range_deletes,
+					range_delete_count);
+}
+
 static int
 vy_task_dump_execute(struct vy_task *task)
 {
@@ -1108,10 +1159,14 @@ vy_task_dump_complete(struct vy_task *task)
 	struct vy_slice **new_slices, *slice;
 	struct vy_range *range, *begin_range, *end_range;
 	struct tuple *min_key, *max_key;
+	const char *min_key_data, *max_key_data;
 	int i;
 
 	assert(lsm->is_dumping);
 
+	if (vy_task_set_range_deletes(task) != 0)
+		goto fail;
+
 	if (vy_run_is_empty(new_run)) {
 		/*
 		 * In case the run is empty, we can discard the run
@@ -1136,23 +1191,33 @@ vy_task_dump_complete(struct vy_task *task)
 	 * intersecting the run or NULL if the run itersects all
 	 * ranges.
 	 */
-	min_key = vy_key_from_msgpack(key_format, new_run->info.min_key);
-	if (min_key == NULL)
-		goto fail;
-	max_key = vy_key_from_msgpack(key_format, new_run->info.max_key);
-	if (max_key == NULL) {
+	min_key_data = new_run->info.min_key;
+	max_key_data = new_run->info.max_key;
+	vy_run_range_delete_bounds(new_run, lsm->cmp_def,
+				   &min_key_data, &max_key_data);
+	if (min_key_data != NULL) {
+		min_key = vy_key_from_msgpack(key_format, min_key_data);
+		if (min_key == NULL)
+			goto fail;
+		begin_range = vy_range_tree_psearch(&lsm->range_tree, min_key);
 		tuple_unref(min_key);
-		goto fail;
+	} else {
+		begin_range = vy_range_tree_first(&lsm->range_tree);
+	}
+	if (max_key_data != NULL) {
+		max_key = vy_key_from_msgpack(key_format, max_key_data);
+		if (max_key == NULL)
+			goto fail;
+		end_range = vy_range_tree_psearch(&lsm->range_tree, max_key);
+		/*
+		 * If min_key == max_key, the slice has to span over
+		 * at least one range.
+		 */
+		end_range = vy_range_tree_next(&lsm->range_tree, end_range);
+		tuple_unref(max_key);
+	} else {
+		end_range = NULL;
 	}
-	begin_range = vy_range_tree_psearch(&lsm->range_tree, min_key);
-	end_range = vy_range_tree_psearch(&lsm->range_tree, max_key);
-	/*
-	 * If min_key == max_key, the slice has to span over at
-	 * least one range.
-	 */
-	end_range = vy_range_tree_next(&lsm->range_tree, end_range);
-	tuple_unref(min_key);
-	tuple_unref(max_key);
 
 	/*
 	 * For each intersected range allocate a slice of the new run.
@@ -1356,7 +1421,7 @@ vy_task_dump_new(struct vy_scheduler *scheduler, struct vy_worker *worker,
 		if (mem->generation > scheduler->dump_generation)
 			continue;
 		vy_mem_wait_pinned(mem);
-		if (mem->tree.size == 0) {
+		if (vy_mem_is_empty(mem)) {
 			/*
 			 * The tree is empty so we can delete it
 			 * right away, without involving a worker.
@@ -1468,6 +1533,9 @@ vy_task_compaction_complete(struct vy_task *task)
 	struct vy_slice *slice, *next_slice, *new_slice = NULL;
 	struct vy_run *run;
 
+	if (vy_task_set_range_deletes(task) != 0)
+		return -1;
+
 	/*
 	 * Allocate a slice of the new run.
 	 *
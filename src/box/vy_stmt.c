@@ -377,6 +377,58 @@ vy_stmt_new_delete(struct tuple_format *format, const char *tuple_begin,
 				    NULL, 0, IPROTO_DELETE);
 }
 
+struct tuple *
+vy_stmt_new_delete_range(struct tuple_format *format,
+			 const char *begin, const char *begin_end,
+			 const char *end, const char *end_end)
+{
+	assert(vy_stmt_is_key_format(format));
+	mp_tuple_assert(end, end_end);
+	struct iovec iov;
+	iov.iov_base = (char *)end;
+	iov.iov_len = end_end - end;
+	return vy_stmt_new_with_ops(format, begin, begin_end,
+				    &iov, 1, IPROTO_DELETE_RANGE);
+}
+
+const struct tuple *
+vy_stmt_find_range_delete(const struct tuple **range_deletes,
+			  uint32_t count, const struct tuple *stmt,
+			  int64_t vlsn, struct key_def *cmp_def)
+{
+	const struct tuple *result = NULL;
+	for (uint32_t i = 0; i < count; i++) {
+		const struct tuple *range_delete = range_deletes[i];
+		int64_t lsn = vy_stmt_lsn(range_delete);
+		if (lsn > vlsn ||
+		    (result != NULL && lsn <= vy_stmt_lsn(result)))
+			continue;
+		if (vy_stmt_is_covered(stmt, range_delete, cmp_def))
+			result = range_delete;
+	}
+	return result;
+}
+
+struct tuple *
+vy_stmt_new_covered_delete(const struct tuple *stmt,
+			   const struct tuple *range_delete,
+			   struct key_def *cmp_def)
+{
+	struct tuple *result;
+	if (vy_stmt_is_key(stmt)) {
+		const char *key = tuple_data(stmt);
+		result = vy_key_from_msgpack(tuple_format(range_delete), key);
+	} else {
+		result = vy_stmt_extract_key(stmt, cmp_def,
+					     tuple_format(range_delete));
+	}
+	if (result == NULL)
+		return NULL;
+	vy_stmt_set_type(result, IPROTO_DELETE);
+	vy_stmt_set_lsn(result, vy_stmt_lsn(range_delete));
+	return result;
+}
+
 struct tuple *
 vy_stmt_replace_from_upsert(const struct tuple *upsert)
 {
@@ -786,6 +838,11 @@ vy_stmt_snprint(char *buf, int size, const struct tuple *stmt)
 		SNPRINT(total, mp_snprint, buf, size,
 			vy_stmt_upsert_ops(stmt, &mp_size));
 	}
+	if (vy_stmt_type(stmt) == IPROTO_DELETE_RANGE) {
+		SNPRINT(total, snprintf, buf, size, ", end=");
+		SNPRINT(total, mp_snprint, buf, size,
+			vy_stmt_delete_range_end(stmt));
+	}
 	SNPRINT(total, snprintf, buf, size, ", lsn=%lld)",
 		(long long) vy_stmt_lsn(stmt));
 	return total;
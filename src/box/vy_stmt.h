@@ -497,6 +497,86 @@ struct tuple *
 vy_stmt_new_delete(struct tuple_format *format, const char *tuple_begin,
 		   const char *tuple_end);
 
+/**
+ * Create the DELETE_RANGE statement from raw MessagePack data.
+ * The statement deletes all keys k such that begin <= k < end.
+ * Both keys may be partial. An empty @end means that the range
+ * is not bounded from above.
+ *
+ * A DELETE_RANGE statement is stored as a key: the statement
+ * data is the @begin key and the @end key is appended to it,
+ * in the same way UPSERT operations are appended to a tuple.
+ *
+ * @param format Key format.
+ * @param begin, begin_end MessagePack array of @begin key fields.
+ * @param end, end_end MessagePack array of @end key fields.
+ *
+ * @retval NULL     Memory allocation error.
+ * @retval not NULL Success.
+ */
+struct tuple *
+vy_stmt_new_delete_range(struct tuple_format *format,
+			 const char *begin, const char *begin_end,
+			 const char *end, const char *end_end);
+
+/**
+ * Return the end of the range deleted by a DELETE_RANGE
+ * statement (MessagePack array WITH the array header).
+ */
+static inline const char *
+vy_stmt_delete_range_end(const struct tuple *stmt)
+{
+	assert(vy_stmt_type(stmt) == IPROTO_DELETE_RANGE);
+	const char *mp = tuple_data(stmt);
+	mp_next(&mp);
+	return mp;
+}
+
+/**
+ * Return true if the key of statement @stmt falls into the range
+ * deleted by DELETE_RANGE statement @range_delete. LSNs are not
+ * taken into account.
+ */
+static inline bool
+vy_stmt_is_covered(const struct tuple *stmt,
+		   const struct tuple *range_delete, struct key_def *cmp_def)
+{
+	if (vy_stmt_compare(stmt, range_delete, cmp_def) < 0)
+		return false;
+	const char *end = vy_stmt_delete_range_end(range_delete);
+	const char *tmp = end;
+	if (mp_decode_array(&tmp) == 0)
+		return true;
+	return vy_stmt_compare_with_raw_key(stmt, end, cmp_def) < 0;
+}
+
+/**
+ * Find the newest DELETE_RANGE statement visible from read view
+ * @vlsn that covers statement @stmt in the given array.
+ *
+ * @retval NULL     The statement isn't covered.
+ * @retval not NULL The covering statement.
+ */
+const struct tuple *
+vy_stmt_find_range_delete(const struct tuple **range_deletes,
+			  uint32_t count, const struct tuple *stmt,
+			  int64_t vlsn, struct key_def *cmp_def);
+
+/**
+ * Create a DELETE statement for the key of statement @stmt
+ * covered by DELETE_RANGE @range_delete. The new statement
+ * has key format and inherits LSN of @range_delete so that
+ * it can be merged with other statements as if it had been
+ * inserted along with the range deletion.
+ *
+ * @retval NULL     Memory allocation error.
+ * @retval not NULL Success.
+ */
+struct tuple *
+vy_stmt_new_covered_delete(const struct tuple *stmt,
+			   const struct tuple *range_delete,
+			   struct key_def *cmp_def);
+
  /**
  * Create the UPSERT statement from raw MessagePack data.
  * @param tuple_begin MessagePack data that contain an array of fields WITH the
@@ -234,6 +234,8 @@ txv_new(struct vy_tx *tx, struct vy_lsm *lsm,
 	v->is_first_insert = false;
 	v->is_overwritten = false;
 	v->overwritten = NULL;
+	v->range_delete = NULL;
+	rlist_create(&v->in_range_deletes);
 	xm->write_set_size += tuple_size(stmt);
 	return v;
 }
@@ -306,6 +308,7 @@ vy_tx_create(struct tx_manager *xm, struct vy_tx *tx)
 {
 	stailq_create(&tx->log);
 	write_set_new(&tx->write_set);
+	rlist_create(&tx->range_deletes);
 	tx->write_set_version = 0;
 	tx->write_size = 0;
 	tx->xm = xm;
@@ -341,7 +344,8 @@ vy_tx_destroy(struct vy_tx *tx)
 static bool
 vy_tx_is_ro(struct vy_tx *tx)
 {
-	return write_set_empty(&tx->write_set);
+	return write_set_empty(&tx->write_set) &&
+	       rlist_empty(&tx->range_deletes);
 }
 
 /** Return true if the transaction is in read view. */
@@ -642,6 +646,10 @@ vy_tx_prepare(struct vy_tx *tx)
 		if (vy_tx_send_to_read_view(tx, v))
 			return -1;
 	}
+	rlist_foreach_entry(v, &tx->range_deletes, in_range_deletes) {
+		if (vy_tx_send_to_read_view(tx, v))
+			return -1;
+	}
 
 	/*
 	 * Flush transactional changes to the LSM tree.
@@ -732,8 +740,11 @@ vy_tx_prepare(struct vy_tx *tx)
 
 		/* In secondary indexes only REPLACE/DELETE can be written. */
 		vy_stmt_set_lsn(v->stmt, MAX_LSN + tx->psn);
+		const struct tuple *range_delete = NULL;
 		const struct tuple **region_stmt =
 			(type == IPROTO_DELETE) ? &delete : &repsert;
+		if (type == IPROTO_DELETE_RANGE)
+			region_stmt = &range_delete;
 		if (vy_tx_write(lsm, v->mem, v->stmt, region_stmt) != 0)
 			return -1;
 		v->region_stmt = *region_stmt;
@@ -824,6 +835,8 @@ vy_tx_rollback_after_prepare(struct vy_tx *tx)
 	while ((v = write_set_inext(&it)) != NULL) {
 		vy_tx_abort_readers(tx, v);
 	}
+	rlist_foreach_entry(v, &tx->range_deletes, in_range_deletes)
+		vy_tx_abort_readers(tx, v);
 }
 
 void
@@ -849,6 +862,26 @@ vy_tx_begin_statement(struct vy_tx *tx)
 	return stailq_last(&tx->log);
 }
 
+/**
+ * Restore statements overwritten by a DELETE_RANGE statement.
+ * They are looked up in the transaction log starting from the
+ * given entry.
+ */
+static void
+vy_tx_restore_range_deleted(struct vy_tx *tx, struct txv *range_delete,
+			    struct stailq_entry *entry)
+{
+	for (; entry != NULL; entry = stailq_next(entry)) {
+		struct txv *v = stailq_entry(entry, struct txv, next_in_log);
+		if (v->range_delete != range_delete)
+			continue;
+		write_set_insert(&tx->write_set, v);
+		tx->write_size += tuple_size(v->stmt);
+		v->is_overwritten = false;
+		v->range_delete = NULL;
+	}
+}
+
 void
 vy_tx_rollback_statement(struct vy_tx *tx, void *svp)
 {
@@ -860,6 +893,20 @@ vy_tx_rollback_statement(struct vy_tx *tx, void *svp)
 	stailq_reverse(&tail);
 	struct txv *v, *tmp;
 	stailq_foreach_entry_safe(v, tmp, &tail, next_in_log) {
+		if (vy_stmt_type(v->stmt) == IPROTO_DELETE_RANGE) {
+			/*
+			 * Statements overwritten by a range deletion
+			 * precede it in the log, which is reversed.
+			 */
+			struct stailq_entry *next = stailq_next(&v->next_in_log);
+			rlist_del_entry(v, in_range_deletes);
+			vy_tx_restore_range_deleted(tx, v,
+						    stailq_first(&tx->log));
+			vy_tx_restore_range_deleted(tx, v, next);
+			tx->write_set_version++;
+			txv_delete(v);
+			continue;
+		}
 		write_set_remove(&tx->write_set, v);
 		if (v->overwritten != NULL) {
 			/* Restore overwritten statement. */
@@ -1069,15 +1116,81 @@ vy_tx_set_with_colmask(struct vy_tx *tx, struct vy_lsm *lsm,
 	return 0;
 }
 
+int
+vy_tx_delete_range(struct vy_tx *tx, struct vy_lsm *lsm, struct tuple *stmt)
+{
+	assert(lsm->index_id == 0);
+	assert(vy_stmt_type(stmt) == IPROTO_DELETE_RANGE);
+	/* @sa vy_tx_set_with_colmask(). */
+	vy_stmt_set_lsn(stmt, INT64_MAX);
+
+	struct txv *v = txv_new(tx, lsm, stmt, UINT64_MAX);
+	if (v == NULL)
+		return -1;
+	/*
+	 * Leave covered txvs in TX log but remove them from
+	 * write set so that they aren't committed.
+	 */
+	struct write_set_key key = { .lsm = lsm, .stmt = stmt };
+	struct txv *old = write_set_nsearch(&tx->write_set, &key);
+	/* A partial key may match any of a few statements. */
+	while (old != NULL) {
+		struct txv *prev = write_set_prev(&tx->write_set, old);
+		if (prev == NULL || prev->lsm != lsm ||
+		    !vy_stmt_is_covered(prev->stmt, stmt, lsm->cmp_def))
+			break;
+		old = prev;
+	}
+	while (old != NULL && old->lsm == lsm &&
+	       vy_stmt_is_covered(old->stmt, stmt, lsm->cmp_def)) {
+		struct txv *next = write_set_next(&tx->write_set, old);
+		assert(tx->write_size >= tuple_size(old->stmt));
+		tx->write_size -= tuple_size(old->stmt);
+		write_set_remove(&tx->write_set, old);
+		old->is_overwritten = true;
+		old->range_delete = v;
+		old = next;
+	}
+	rlist_add_tail_entry(&tx->range_deletes, v, in_range_deletes);
+	tx->write_set_version++;
+	tx->write_size += tuple_size(stmt);
+	vy_stmt_counter_acct_tuple(&lsm->stat.txw.count, stmt);
+	stailq_add_tail_entry(&tx->log, v, next_in_log);
+	return 0;
+}
+
+const struct tuple *
+vy_tx_find_range_delete(struct vy_tx *tx, struct vy_lsm *lsm,
+			const struct tuple *key)
+{
+	struct txv *v;
+	rlist_foreach_entry_reverse(v, &tx->range_deletes, in_range_deletes) {
+		if (v->lsm == lsm &&
+		    vy_stmt_is_covered(key, v->stmt, lsm->cmp_def))
+			return v->stmt;
+	}
+	return NULL;
+}
+
 void
 tx_manager_abort_writers_for_ddl(struct tx_manager *xm, struct vy_lsm *lsm)
 {
 	struct vy_tx *tx;
 	rlist_foreach_entry(tx, &xm->writers, in_writers) {
-		if (tx->state == VINYL_TX_READY &&
-		    write_set_search_key(&tx->write_set, lsm,
-					 lsm->env->empty_key) != NULL)
+		if (tx->state != VINYL_TX_READY)
+			continue;
+		if (write_set_search_key(&tx->write_set, lsm,
+					 lsm->env->empty_key) != NULL) {
 			tx->state = VINYL_TX_ABORT;
+			continue;
+		}
+		struct txv *v;
+		rlist_foreach_entry(v, &tx->range_deletes, in_range_deletes) {
+			if (v->lsm == lsm) {
+				tx->state = VINYL_TX_ABORT;
+				break;
+			}
+		}
 	}
 }
 
@@ -105,6 +105,17 @@ struct txv {
 	bool is_overwritten;
 	/** txv that was overwritten by the current txv. */
 	struct txv *overwritten;
+	/**
+	 * DELETE_RANGE txv that overwrote the current txv or
+	 * NULL. Used for restoring overwritten statements on
+	 * rollback.
+	 */
+	struct txv *range_delete;
+	/**
+	 * Link in vy_tx::range_deletes. Only used if this is
+	 * a DELETE_RANGE statement.
+	 */
+	struct rlist in_range_deletes;
 };
 
 /**
@@ -149,6 +160,14 @@ struct vy_tx {
 	 * vy_lsm object.
 	 */
 	write_set_t write_set;
+	/**
+	 * DELETE_RANGE statements of the transaction, linked by
+	 * txv::in_range_deletes, in chronological order. They
+	 * aren't stored in @write_set, because they span many
+	 * keys. Statements of @write_set covered by a range
+	 * deletion are removed from it when it's executed.
+	 */
+	struct rlist range_deletes;
 	/**
 	 * Version of write_set state; if the state changes
 	 * (insert/remove), the version is incremented.
@@ -393,6 +412,22 @@ vy_tx_set(struct vy_tx *tx, struct vy_lsm *lsm, struct tuple *stmt)
 	return vy_tx_set_with_colmask(tx, lsm, stmt, UINT64_MAX);
 }
 
+/**
+ * Add a DELETE_RANGE statement to a transaction. All statements
+ * of the transaction covered by it are overwritten.
+ */
+int
+vy_tx_delete_range(struct vy_tx *tx, struct vy_lsm *lsm,
+		   struct tuple *stmt);
+
+/**
+ * Return the newest DELETE_RANGE statement of a transaction that
+ * covers the given key in the given LSM tree or NULL.
+ */
+const struct tuple *
+vy_tx_find_range_delete(struct vy_tx *tx, struct vy_lsm *lsm,
+			const struct tuple *key);
+
 /**
  * Iterator over the write set of a transaction.
  */
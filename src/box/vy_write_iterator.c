@@ -201,6 +201,18 @@ struct vy_write_iterator {
 	 * Last statement returned to the caller, pinned in memory.
 	 */
 	struct tuple *last_stmt;
+	/**
+	 * DELETE_RANGE statements of all sources, referenced by
+	 * the iterator. Those that must be written to the output
+	 * are moved to the beginning of the array on start.
+	 */
+	struct tuple **range_deletes;
+	/** Number of DELETE_RANGE statements. */
+	uint32_t range_delete_count;
+	/** Size of the @range_deletes array. */
+	uint32_t range_delete_capacity;
+	/** Number of DELETE_RANGE statements to write. */
+	uint32_t range_delete_output_count;
 	/**
 	 * Read views of the same key sorted by LSN in descending
 	 * order, starting from INT64_MAX.
@@ -391,6 +403,22 @@ vy_write_iterator_start(struct vy_stmt_stream *vstream)
 {
 	assert(vstream->iface->start == vy_write_iterator_start);
 	struct vy_write_iterator *stream = (struct vy_write_iterator *)vstream;
+	/*
+	 * On major compaction a DELETE_RANGE is only needed if
+	 * there's a read view that doesn't see it, because all
+	 * statements it covers are purged.
+	 */
+	int64_t oldest_vlsn = stream->rv_count > 1 ?
+		stream->read_views[stream->rv_count - 1].vlsn : INT64_MAX;
+	stream->range_delete_output_count = 0;
+	for (uint32_t i = 0; i < stream->range_delete_count; i++) {
+		struct tuple *stmt = stream->range_deletes[i];
+		if (stream->is_last_level && oldest_vlsn >= vy_stmt_lsn(stmt))
+			continue;
+		uint32_t j = stream->range_delete_output_count++;
+		stream->range_deletes[i] = stream->range_deletes[j];
+		stream->range_deletes[j] = stmt;
+	}
 	struct vy_write_src *src;
 	rlist_foreach_entry(src, &stream->src_list, in_src_list) {
 		if (vy_write_iterator_add_src(stream, src) != 0)
@@ -444,9 +472,87 @@ vy_write_iterator_close(struct vy_stmt_stream *vstream)
 	rlist_foreach_entry_safe(src, &stream->src_list, in_src_list, tmp)
 		vy_write_iterator_delete_src(stream, src);
 	vy_source_heap_destroy(&stream->src_heap);
+	for (uint32_t i = 0; i < stream->range_delete_count; i++)
+		tuple_unref(stream->range_deletes[i]);
+	free(stream->range_deletes);
 	free(stream);
 }
 
+/**
+ * Remember a DELETE_RANGE statement of a source. Statements
+ * stored in a mem are copied, because the mem may be deleted
+ * before the iterator.
+ * @return 0 on success or -1 on error (diag is set).
+ */
+static int
+vy_write_iterator_add_range_delete(struct vy_write_iterator *stream,
+				   const struct tuple *stmt)
+{
+	if (stream->range_delete_count == stream->range_delete_capacity) {
+		uint32_t capacity = MAX(stream->range_delete_capacity * 2,
+					8U);
+		size_t size = capacity * sizeof(*stream->range_deletes);
+		struct tuple **range_deletes = realloc(stream->range_deletes,
+						       size);
+		if (range_deletes == NULL) {
+			diag_set(OutOfMemory, size, "realloc",
+				 "range deletes");
+			return -1;
+		}
+		stream->range_deletes = range_deletes;
+		stream->range_delete_capacity = capacity;
+	}
+	struct tuple *copy;
+	if (vy_stmt_is_refable(stmt)) {
+		copy = (struct tuple *)stmt;
+		tuple_ref(copy);
+	} else {
+		copy = vy_stmt_dup(stmt);
+		if (copy == NULL)
+			return -1;
+	}
+	stream->range_deletes[stream->range_delete_count++] = copy;
+	return 0;
+}
+
+/**
+ * Check if all statements of a run are deleted by a DELETE_RANGE
+ * added to the iterator so far so that the run needn't be read.
+ * This is true if the DELETE_RANGE is newer than the run, covers
+ * the whole run, and there's no read view that sees a statement
+ * of the run but not the DELETE_RANGE.
+ */
+static bool
+vy_write_iterator_run_is_deleted(struct vy_write_iterator *stream,
+				 struct vy_run *run)
+{
+	if (run->info.page_count == 0)
+		return false;
+	for (uint32_t i = 0; i < stream->range_delete_count; i++) {
+		struct tuple *stmt = stream->range_deletes[i];
+		int64_t lsn = vy_stmt_lsn(stmt);
+		if (lsn <= run->info.max_lsn)
+			continue;
+		if (key_compare(run->info.min_key, tuple_data(stmt),
+				stream->cmp_def) < 0)
+			continue;
+		const char *end = vy_stmt_delete_range_end(stmt);
+		const char *tmp = end;
+		if (mp_decode_array(&tmp) > 0 &&
+		    key_compare(run->info.max_key, end, stream->cmp_def) >= 0)
+			continue;
+		int rv_i;
+		for (rv_i = 1; rv_i < stream->rv_count; rv_i++) {
+			int64_t vlsn = stream->read_views[rv_i].vlsn;
+			if (vlsn >= run->info.min_lsn && vlsn < lsn)
+				break;
+		}
+		if (rv_i == stream->rv_count)
+			return true;
+	}
+	return false;
+}
+
 /**
  * Add a mem as a source of iterator.
  * @return 0 on success or -1 on error (diag is set).
@@ -455,6 +561,11 @@ NODISCARD int
 vy_write_iterator_new_mem(struct vy_stmt_stream *vstream, struct vy_mem *mem)
 {
 	struct vy_write_iterator *stream = (struct vy_write_iterator *)vstream;
+	for (uint32_t i = 0; i < mem->range_delete_count; i++) {
+		if (vy_write_iterator_add_range_delete(stream,
+					mem->range_deletes[i]) != 0)
+			return -1;
+	}
 	struct vy_write_src *src = vy_write_iterator_new_src(stream);
 	if (src == NULL)
 		return -1;
@@ -472,6 +583,19 @@ vy_write_iterator_new_slice(struct vy_stmt_stream *vstream,
 			    struct tuple_format *disk_format)
 {
 	struct vy_write_iterator *stream = (struct vy_write_iterator *)vstream;
+	struct vy_run *run = slice->run;
+	/*
+	 * Sources are added from newest to oldest so we can
+	 * only check DELETE_RANGE statements of newer sources.
+	 */
+	bool is_deleted = vy_write_iterator_run_is_deleted(stream, run);
+	for (uint32_t i = 0; i < run->info.range_delete_count; i++) {
+		if (vy_write_iterator_add_range_delete(stream,
+					run->info.range_deletes[i]) != 0)
+			return -1;
+	}
+	if (is_deleted)
+		return 0;
 	struct vy_write_src *src = vy_write_iterator_new_src(stream);
 	if (src == NULL)
 		return -1;
@@ -480,6 +604,17 @@ vy_write_iterator_new_slice(struct vy_stmt_stream *vstream,
 	return 0;
 }
 
+void
+vy_write_iterator_get_range_deletes(struct vy_stmt_stream *vstream,
+				    struct tuple ***range_deletes,
+				    uint32_t *count)
+{
+	assert(vstream->iface->start == vy_write_iterator_start);
+	struct vy_write_iterator *stream = (struct vy_write_iterator *)vstream;
+	*range_deletes = stream->range_deletes;
+	*count = stream->range_delete_output_count;
+}
+
 /**
  * Go to the next tuple in terms of sorted (merged) input steams.
  * @return 0 on success or not 0 on error (diag is set).
@@ -544,6 +679,26 @@ vy_write_iterator_push_rv(struct vy_write_iterator *stream,
 	return 0;
 }
 
+/**
+ * Check if a statement needn't be written, because it's a DELETE
+ * produced by a DELETE_RANGE that is written to the output.
+ */
+static bool
+vy_write_iterator_is_range_deleted(struct vy_write_iterator *stream,
+				   struct tuple *stmt)
+{
+	if (vy_stmt_type(stmt) != IPROTO_DELETE ||
+	    (vy_stmt_flags(stmt) & VY_STMT_DEFERRED_DELETE) != 0)
+		return false;
+	for (uint32_t i = 0; i < stream->range_delete_output_count; i++) {
+		struct tuple *range_delete = stream->range_deletes[i];
+		if (vy_stmt_lsn(range_delete) == vy_stmt_lsn(stmt) &&
+		    vy_stmt_is_covered(stmt, range_delete, stream->cmp_def))
+			return true;
+	}
+	return false;
+}
+
 /**
  * Return the next statement from the current key read view
  * statements sequence. Unref the previous statement, if needed.
@@ -560,22 +715,24 @@ static inline struct tuple *
 vy_write_iterator_pop_read_view_stmt(struct vy_write_iterator *stream)
 {
 	struct vy_read_view_stmt *rv;
-	if (stream->rv_used_count == 0)
-		return NULL;
-	/* Find a next non-empty history element. */
-	do {
-		assert(stream->stmt_i + 1 < stream->rv_count);
-		stream->stmt_i++;
-		rv = &stream->read_views[stream->stmt_i];
-		assert(rv->history == NULL);
-	} while (rv->tuple == NULL);
-	assert(stream->rv_used_count > 0);
-	stream->rv_used_count--;
-	if (stream->last_stmt != NULL)
-		vy_stmt_unref_if_possible(stream->last_stmt);
-	stream->last_stmt = rv->tuple;
-	rv->tuple = NULL;
-	return stream->last_stmt;
+	while (stream->rv_used_count > 0) {
+		/* Find a next non-empty history element. */
+		do {
+			assert(stream->stmt_i + 1 < stream->rv_count);
+			stream->stmt_i++;
+			rv = &stream->read_views[stream->stmt_i];
+			assert(rv->history == NULL);
+		} while (rv->tuple == NULL);
+		stream->rv_used_count--;
+		if (stream->last_stmt != NULL)
+			vy_stmt_unref_if_possible(stream->last_stmt);
+		stream->last_stmt = rv->tuple;
+		rv->tuple = NULL;
+		if (!vy_write_iterator_is_range_deleted(stream,
+							stream->last_stmt))
+			return stream->last_stmt;
+	}
+	return NULL;
 }
 
 /**
@@ -629,6 +786,48 @@ vy_write_iterator_deferred_delete(struct vy_write_iterator *stream,
 	return 0;
 }
 
+/**
+ * Find DELETE_RANGE statements covering the given key and return
+ * them sorted by LSN in descending order. The array is allocated
+ * on the fiber region.
+ *
+ * @retval  0 Success.
+ * @retval -1 Memory error.
+ */
+static int
+vy_write_iterator_find_range_deletes(struct vy_write_iterator *stream,
+				     const struct tuple *key,
+				     struct tuple ***range_deletes,
+				     uint32_t *count)
+{
+	*range_deletes = NULL;
+	*count = 0;
+	if (stream->range_delete_count == 0)
+		return 0;
+	size_t size = stream->range_delete_count * sizeof(struct tuple *);
+	struct tuple **found = region_alloc(&fiber()->gc, size);
+	if (found == NULL) {
+		diag_set(OutOfMemory, size, "region", "range deletes");
+		return -1;
+	}
+	uint32_t found_count = 0;
+	for (uint32_t i = 0; i < stream->range_delete_count; i++) {
+		struct tuple *stmt = stream->range_deletes[i];
+		if (!vy_stmt_is_covered(key, stmt, stream->cmp_def))
+			continue;
+		/* Insertion sort, there are usually few of them. */
+		uint32_t j = found_count++;
+		while (j > 0 && vy_stmt_lsn(found[j - 1]) < vy_stmt_lsn(stmt)) {
+			found[j] = found[j - 1];
+			j--;
+		}
+		found[j] = stmt;
+	}
+	*range_deletes = found;
+	*count = found_count;
+	return 0;
+}
+
 /**
  * Build the history of the current key.
  * Apply optimizations 1 and 2 (@sa vy_write_iterator.h).
@@ -672,6 +871,18 @@ vy_write_iterator_build_history(struct vy_write_iterator *stream,
 	struct vy_write_src end_of_key_src;
 	end_of_key_src.is_end_of_key = true;
 	end_of_key_src.tuple = src->tuple;
+	/*
+	 * DELETE_RANGE statements covering the current key.
+	 * Each of them is turned into a DELETE, which is merged
+	 * into the history as if it were read from a source.
+	 */
+	struct tuple **range_deletes;
+	uint32_t range_delete_count, range_delete_i = 0;
+	struct tuple *range_delete_stmt = NULL;
+	if (vy_write_iterator_find_range_deletes(stream, src->tuple,
+						 &range_deletes,
+						 &range_delete_count) != 0)
+		return -1;
 	int rc = vy_source_heap_insert(&stream->src_heap, &end_of_key_src);
 	if (rc) {
 		diag_set(OutOfMemory, sizeof(void *),
@@ -689,10 +900,24 @@ vy_write_iterator_build_history(struct vy_write_iterator *stream,
 	int64_t merge_until_lsn = vy_write_iterator_get_vlsn(stream, 1);
 
 	while (true) {
-		*is_first_insert = vy_stmt_type(src->tuple) == IPROTO_INSERT;
+		struct tuple *stmt = src->tuple;
+		if (range_delete_i < range_delete_count &&
+		    vy_stmt_lsn(range_deletes[range_delete_i]) >
+		    vy_stmt_lsn(stmt)) {
+			stmt = vy_stmt_new_covered_delete(stmt,
+					range_deletes[range_delete_i++],
+					stream->cmp_def);
+			if (stmt == NULL) {
+				rc = -1;
+				break;
+			}
+			range_delete_stmt = stmt;
+		}
+
+		*is_first_insert = vy_stmt_type(stmt) == IPROTO_INSERT;
 
 		if (!stream->is_primary &&
-		    (vy_stmt_flags(src->tuple) & VY_STMT_UPDATE) != 0) {
+		    (vy_stmt_flags(stmt) & VY_STMT_UPDATE) != 0) {
 			/*
 			 * If a REPLACE stored in a secondary index was
 			 * generated by an update operation, it can be
@@ -713,12 +938,12 @@ vy_write_iterator_build_history(struct vy_write_iterator *stream,
 		 */
 		if (stream->is_primary) {
 			rc = vy_write_iterator_deferred_delete(stream,
-							       src->tuple);
+							       stmt);
 			if (rc != 0)
 				break;
 		}
 
-		if (vy_stmt_lsn(src->tuple) > current_rv_lsn) {
+		if (vy_stmt_lsn(stmt) > current_rv_lsn) {
 			/*
 			 * Skip statements invisible to the current read
 			 * view but older than the previous read view,
@@ -726,10 +951,10 @@ vy_write_iterator_build_history(struct vy_write_iterator *stream,
 			 */
 			goto next_lsn;
 		}
-		while (vy_stmt_lsn(src->tuple) <= merge_until_lsn) {
+		while (vy_stmt_lsn(stmt) <= merge_until_lsn) {
 			/*
 			 * Skip read views which see the same
-			 * version of the key, until src->tuple is
+			 * version of the key, until stmt is
 			 * between merge_until_lsn and
 			 * current_rv_lsn.
 			 */
@@ -745,13 +970,13 @@ vy_write_iterator_build_history(struct vy_write_iterator *stream,
 		 * @sa vy_write_iterator for details about this
 		 * and other optimizations.
 		 */
-		if (vy_stmt_type(src->tuple) == IPROTO_DELETE &&
+		if (vy_stmt_type(stmt) == IPROTO_DELETE &&
 		    stream->is_last_level && merge_until_lsn == 0) {
 			current_rv_lsn = 0; /* Force skip */
 			goto next_lsn;
 		}
 
-		rc = vy_write_iterator_push_rv(stream, src->tuple,
+		rc = vy_write_iterator_push_rv(stream, stmt,
 					       current_rv_i);
 		if (rc != 0)
 			break;
@@ -761,9 +986,9 @@ vy_write_iterator_build_history(struct vy_write_iterator *stream,
 		 * Optimization 2: skip statements overwritten
 		 * by a REPLACE or DELETE.
 		 */
-		if (vy_stmt_type(src->tuple) == IPROTO_REPLACE ||
-		    vy_stmt_type(src->tuple) == IPROTO_INSERT ||
-		    vy_stmt_type(src->tuple) == IPROTO_DELETE) {
+		if (vy_stmt_type(stmt) == IPROTO_REPLACE ||
+		    vy_stmt_type(stmt) == IPROTO_INSERT ||
+		    vy_stmt_type(stmt) == IPROTO_DELETE) {
 			current_rv_i++;
 			current_rv_lsn = merge_until_lsn;
 			merge_until_lsn =
@@ -771,6 +996,11 @@ vy_write_iterator_build_history(struct vy_write_iterator *stream,
 							   current_rv_i + 1);
 		}
 next_lsn:
+		if (range_delete_stmt != NULL) {
+			vy_stmt_unref_if_possible(range_delete_stmt);
+			range_delete_stmt = NULL;
+			continue;
+		}
 		rc = vy_write_iterator_merge_step(stream);
 		if (rc != 0)
 			break;
@@ -780,6 +1010,8 @@ next_lsn:
 		if (src->is_end_of_key)
 			break;
 	}
+	if (range_delete_stmt != NULL)
+		vy_stmt_unref_if_possible(range_delete_stmt);
 
 	/*
 	 * No point in keeping the last VY_STMT_DEFERRED_DELETE
@@ -1010,56 +1242,50 @@ vy_write_iterator_next(struct vy_stmt_stream *vstream,
 {
 	assert(vstream->iface->next == vy_write_iterator_next);
 	struct vy_write_iterator *stream = (struct vy_write_iterator *)vstream;
-	/*
-	 * Try to get the next statement from the current key
-	 * read view statements sequence.
-	 */
-	*ret = vy_write_iterator_pop_read_view_stmt(stream);
-	if (*ret != NULL)
-		return 0;
-	/*
-	 * If we didn't generate a deferred DELETE corresponding to
-	 * the last seen VY_STMT_DEFERRED_DELETE statement, we must
-	 * include it into the output, because there still might be
-	 * an overwritten tuple in an older source.
-	 */
-	if (stream->deferred_delete_stmt != NULL) {
-		if (stream->deferred_delete_stmt == stream->last_stmt) {
-			/*
-			 * The statement was returned via a read view.
-			 * Nothing to do.
-			 */
-			vy_stmt_unref_if_possible(stream->deferred_delete_stmt);
-			stream->deferred_delete_stmt = NULL;
-		} else {
-			if (stream->last_stmt != NULL)
-				vy_stmt_unref_if_possible(stream->last_stmt);
-			*ret = stream->last_stmt = stream->deferred_delete_stmt;
-			stream->deferred_delete_stmt = NULL;
-			return 0;
-		}
-	}
-
-	/* Build the next key sequence. */
-	stream->stmt_i = -1;
 	int count = 0;
-
 	while (true) {
-		/* Squash UPSERTs and/or go to the next key */
-		if (vy_write_iterator_build_read_views(stream, &count) != 0)
-			return -1;
 		/*
-		 * next_key() routine could skip the next key, for
-		 * example, if it was truncated by last level
-		 * DELETE or it consisted only from optimized
+		 * Try to get the next statement from the current key
+		 * read view statements sequence.
+		 */
+		*ret = vy_write_iterator_pop_read_view_stmt(stream);
+		if (*ret != NULL)
+			return 0;
+		/*
+		 * If we didn't generate a deferred DELETE corresponding
+		 * to the last seen VY_STMT_DEFERRED_DELETE statement, we
+		 * must include it into the output, because there still
+		 * might be an overwritten tuple in an older source.
+		 */
+		if (stream->deferred_delete_stmt != NULL) {
+			struct tuple *stmt = stream->deferred_delete_stmt;
+			stream->deferred_delete_stmt = NULL;
+			if (stmt == stream->last_stmt) {
+				/*
+				 * The statement was returned via a read
+				 * view. Nothing to do.
+				 */
+				vy_stmt_unref_if_possible(stmt);
+			} else {
+				if (stream->last_stmt != NULL)
+					vy_stmt_unref_if_possible(
+							stream->last_stmt);
+				*ret = stream->last_stmt = stmt;
+				return 0;
+			}
+		}
+		if (stream->src_heap.size == 0)
+			return 0;
+		/*
+		 * Build the next key sequence. It may turn out to be
+		 * empty, for example, if the key was truncated by last
+		 * level DELETE or it consisted only from optimized
 		 * updates. Then try to get the next key.
 		 */
-		if (count != 0 || stream->src_heap.size == 0)
-			break;
+		stream->stmt_i = -1;
+		if (vy_write_iterator_build_read_views(stream, &count) != 0)
+			return -1;
 	}
-	/* Again try to get the statement, after calling next_key(). */
-	*ret = vy_write_iterator_pop_read_view_stmt(stream);
-	return 0;
 }
 
 static const struct vy_stmt_stream_iface vy_slice_stream_iface = {
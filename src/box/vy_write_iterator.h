@@ -190,6 +190,21 @@
  * also turn the first INSERT in the resulting key's history to a
  * REPLACE in case the oldest statement among all sources is not
  * an INSERT.
+ *
+ * ---------------------------------------------------------------
+ * Range deletions: DELETE_RANGE statements aren't returned by the
+ * iterator. Instead, they are collected from all sources when the
+ * sources are added and, for each key covered by a DELETE_RANGE,
+ * a DELETE with the same LSN is merged into the key history, so
+ * that optimizations #1 and #2 purge the deleted statements. Such
+ * a DELETE isn't written to the output, because the DELETE_RANGE
+ * that produced it is, see vy_write_iterator_get_range_deletes().
+ * A DELETE_RANGE is dropped on major compaction unless there is
+ * a read view that doesn't see it.
+ *
+ * If a DELETE_RANGE added from a newer source covers all keys of
+ * a run and there's no read view that sees any statement of the
+ * run but not the DELETE_RANGE, the run isn't read at all.
  */
 
 struct vy_write_iterator;
@@ -268,5 +283,16 @@ vy_write_iterator_new_slice(struct vy_stmt_stream *stream,
 			    struct vy_slice *slice,
 			    struct tuple_format *disk_format);
 
+/**
+ * Get DELETE_RANGE statements that must be written to the output
+ * along with the statements returned by the iterator. May only be
+ * called after the iteration was started. The statements stay
+ * valid until the iterator is closed.
+ */
+void
+vy_write_iterator_get_range_deletes(struct vy_stmt_stream *stream,
+				    struct tuple ***range_deletes,
+				    uint32_t *count);
+
 #endif /* INCLUDES_TARANTOOL_BOX_VY_WRITE_STREAM_H */
 
@@ -105,6 +105,7 @@ enum {
 #define VCLOCK_KEY "VClock"
 #define VERSION_KEY "Version"
 #define PREV_VCLOCK_KEY "PrevVClock"
+#define CHUNKS_KEY "Chunks"
 
 static const char v13[] = "0.13";
 static const char v12[] = "0.12";
@@ -125,6 +126,7 @@ xlog_meta_create(struct xlog_meta *meta, const char *filetype,
 		vclock_copy(&meta->prev_vclock, prev_vclock);
 	else
 		vclock_clear(&meta->prev_vclock);
+	meta->chunk_count = 0;
 }
 
 /**
@@ -158,6 +160,10 @@ xlog_meta_format(const struct xlog_meta *meta, char *buf, int size)
 		SNPRINT(total, snprintf, buf, size, PREV_VCLOCK_KEY ": %s\n",
 			vclock_to_string(&meta->prev_vclock));
 	}
+	if (meta->chunk_count > 0) {
+		SNPRINT(total, snprintf, buf, size, CHUNKS_KEY ": %u\n",
+			(unsigned)meta->chunk_count);
+	}
 	SNPRINT(total, snprintf, buf, size, "\n");
 	assert(total > 0);
 	return total;
@@ -299,6 +305,19 @@ xlog_meta_parse(struct xlog_meta *meta, const char **data,
 			 */
 			if (parse_vclock(val, val_end, &meta->prev_vclock) != 0)
 				return -1;
+		} else if (xlog_meta_key_equal(key, key_end, CHUNKS_KEY)) {
+			/*
+			 * Chunks: <count>
+			 */
+			char *num_end;
+			errno = 0;
+			unsigned long count = strtoul(val, &num_end, 10);
+			if (num_end != val_end || errno != 0 ||
+			    count > UINT32_MAX) {
+				diag_set(XlogError, "can't parse chunk count");
+				return -1;
+			}
+			meta->chunk_count = count;
 		} else if (xlog_meta_key_equal(key, key_end, VERSION_KEY)) {
 			/* Ignore Version: for now */
 		} else {
@@ -655,6 +674,21 @@ xdir_format_filename(struct xdir *dir, int64_t signature,
 	return filename;
 }
 
+char *
+xdir_format_chunk_filename(struct xdir *dir, int64_t signature,
+			   uint32_t chunk_no, enum log_suffix suffix)
+{
+	if (chunk_no == 0)
+		return xdir_format_filename(dir, signature, suffix);
+	static __thread char filename[PATH_MAX + 1];
+	const char *suffix_str = (suffix == INPROGRESS ?
+				  inprogress_suffix : "");
+	snprintf(filename, PATH_MAX, "%s/%020lld%s.%u%s",
+		 dir->dirname, (long long) signature,
+		 dir->filename_ext, (unsigned)chunk_no, suffix_str);
+	return filename;
+}
+
 static void
 xdir_say_gc(int result, int errorno, const char *filename)
 {
@@ -673,12 +707,36 @@ xdir_complete_gc(eio_req *req)
 	return 0;
 }
 
+/**
+ * Remove chunk files of a snapshot written by several threads,
+ * see xdir_create_snap_chunk(). The chunks aren't indexed by
+ * the directory, so probe them one by one until a missing one.
+ */
+static void
+xdir_collect_snap_chunks(struct xdir *dir, int64_t signature,
+			 unsigned flags)
+{
+	for (uint32_t chunk_no = 1; ; chunk_no++) {
+		char *filename = xdir_format_chunk_filename(dir, signature,
+							    chunk_no, NONE);
+		if (access(filename, F_OK) != 0)
+			break;
+		if (flags & XDIR_GC_ASYNC)
+			eio_unlink(filename, 0, xdir_complete_gc, NULL);
+		else
+			xdir_say_gc(unlink(filename), errno, filename);
+	}
+}
+
 void
 xdir_collect_garbage(struct xdir *dir, int64_t signature, unsigned flags)
 {
 	struct vclock *vclock;
 	while ((vclock = vclockset_first(&dir->index)) != NULL &&
 	       vclock_sum(vclock) < signature) {
+		if (dir->type == SNAP)
+			xdir_collect_snap_chunks(dir, vclock_sum(vclock),
+						 flags);
 		char *filename = xdir_format_filename(dir, vclock_sum(vclock),
 						      NONE);
 		if (flags & XDIR_GC_ASYNC)
@@ -957,6 +1015,36 @@ xdir_touch_xlog(struct xdir *dir, const struct vclock *vclock)
 	return 0;
 }
 
+/**
+ * Create a new file for @a dir with the given name and header
+ * and open it in write (append) mode.
+ */
+static int
+xdir_create_xlog_file(struct xdir *dir, struct xlog *xlog,
+		      const char *filename, const struct xlog_meta *meta)
+{
+	if (xlog_create(xlog, filename, dir->open_wflags, meta) != 0)
+		return -1;
+
+	/* Inherit xdir settings. */
+	xlog->sync_is_async = dir->sync_is_async;
+	xlog->sync_interval = dir->sync_interval;
+
+	/* free file cache if dir should be synced */
+	xlog->free_cache = dir->sync_interval != 0 ? true: false;
+	xlog->rate_limit = 0;
+
+	/* Rename xlog file */
+	if (dir->suffix != INPROGRESS && xlog_rename(xlog)) {
+		int save_errno = errno;
+		xlog_close(xlog, false);
+		errno = save_errno;
+		return -1;
+	}
+
+	return 0;
+}
+
 /**
  * In case of error, writes a message to the error log
  * and sets errno.
@@ -982,26 +1070,29 @@ xdir_create_xlog(struct xdir *dir, struct xlog *xlog,
 			 vclock, prev_vclock);
 
 	char *filename = xdir_format_filename(dir, signature, NONE);
-	if (xlog_create(xlog, filename, dir->open_wflags, &meta) != 0)
-		return -1;
-
-	/* Inherit xdir settings. */
-	xlog->sync_is_async = dir->sync_is_async;
-	xlog->sync_interval = dir->sync_interval;
+	return xdir_create_xlog_file(dir, xlog, filename, &meta);
+}
 
-	/* free file cache if dir should be synced */
-	xlog->free_cache = dir->sync_interval != 0 ? true: false;
-	xlog->rate_limit = 0;
+int
+xdir_create_snap_chunk(struct xdir *dir, struct xlog *xlog,
+		       const struct vclock *vclock, uint32_t chunk_no,
+		       uint32_t chunk_count)
+{
+	int64_t signature = vclock_sum(vclock);
+	assert(signature >= 0);
+	assert(!tt_uuid_is_nil(dir->instance_uuid));
+	assert(dir->type == SNAP);
+	assert(chunk_no <= chunk_count);
 
-	/* Rename xlog file */
-	if (dir->suffix != INPROGRESS && xlog_rename(xlog)) {
-		int save_errno = errno;
-		xlog_close(xlog, false);
-		errno = save_errno;
-		return -1;
-	}
+	struct xlog_meta meta;
+	xlog_meta_create(&meta, dir->filetype, dir->instance_uuid,
+			 vclock, NULL);
+	if (chunk_no == 0)
+		meta.chunk_count = chunk_count;
 
-	return 0;
+	char *filename = xdir_format_chunk_filename(dir, signature,
+						    chunk_no, NONE);
+	return xdir_create_xlog_file(dir, xlog, filename, &meta);
 }
 
 ssize_t
@@ -178,6 +178,15 @@ char *
 xdir_format_filename(struct xdir *dir, int64_t signature,
 		     enum log_suffix suffix);
 
+/**
+ * Return the name of chunk @a chunk_no of a snapshot written
+ * by several threads: <signature>.snap.<chunk_no>. Chunk 0
+ * is the main snapshot file, which has the regular name.
+ */
+char *
+xdir_format_chunk_filename(struct xdir *dir, int64_t signature,
+			   uint32_t chunk_no, enum log_suffix suffix);
+
 /**
  * Return true if the given directory index has files whose
  * signature is less than specified.
@@ -209,6 +218,7 @@ enum {
 
 /**
  * Remove files whose signature is less than specified.
+ * Chunk files of removed snapshots are removed too.
  * For possible values of @flags see XDIR_GC_*.
  */
 void
@@ -286,6 +296,13 @@ struct xlog_meta {
 	 * directory for missing WALs.
 	 */
 	struct vclock prev_vclock;
+	/**
+	 * Text file header: number of additional chunk files
+	 * a snapshot is split into, see xdir_create_snap_chunk().
+	 * Zero (the key is not written) for a single-file
+	 * snapshot and for the chunk files themselves.
+	 */
+	uint32_t chunk_count;
 };
 
 /**
@@ -418,6 +435,22 @@ int
 xdir_create_xlog(struct xdir *dir, struct xlog *xlog,
 		 const struct vclock *vclock);
 
+/**
+ * Create a file for chunk @a chunk_no of a snapshot split into
+ * @a chunk_count + 1 files and open it in write (append) mode.
+ * Chunk 0 is the main snapshot file: it is named as usual and
+ * its header lists the number of additional chunks, so that
+ * recovery knows which files to read. The other chunks are
+ * named by xdir_format_chunk_filename().
+ *
+ * @retval 0 if OK
+ * @retval -1 if error
+ */
+int
+xdir_create_snap_chunk(struct xdir *dir, struct xlog *xlog,
+		       const struct vclock *vclock, uint32_t chunk_no,
+		       uint32_t chunk_count);
+
 /**
  * Create new xlog writer based on fd.
  * @param fd            file descriptor
@@ -42,6 +42,12 @@
  */
 bool sse42_enabled_cpu();
 
+/* Check whether CPU and OS support AVX2 (256-bit integer vectors).
+ *
+ * @return	true if AVX2 instructions can be used, false otherwise.
+ */
+bool avx2_enabled_cpu();
+
 #if defined (__x86_64__) || defined (__i386__)
 /* Hardware-calculate CRC32 for the given data buffer.
  *
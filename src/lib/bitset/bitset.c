@@ -80,7 +80,59 @@ tt_bitset_test(struct tt_bitset *bitset, size_t pos)
 
 	assert(page->first_pos <= pos && pos < page->first_pos +
 	       BITSET_PAGE_DATA_SIZE * CHAR_BIT);
-	return bit_test(tt_bitset_page_data(page), pos - page->first_pos);
+	return tt_bitset_page_test(page, pos - page->first_pos);
+}
+
+/**
+ * Replace @a page with a copy of it stored either as a sorted
+ * array with @a capacity slots or, if @a capacity is 0, as a
+ * dense bitmap. Return the new page or NULL on memory error,
+ * in which case @a page is left intact.
+ */
+static struct tt_bitset_page *
+tt_bitset_page_convert(struct tt_bitset *bitset, struct tt_bitset_page *page,
+		       uint32_t capacity)
+{
+	assert(capacity == 0 || capacity >= page->cardinality);
+	size_t size = capacity > 0 ?
+		      tt_bitset_page_array_alloc_size(capacity) :
+		      tt_bitset_page_alloc_size(bitset->realloc);
+	struct tt_bitset_page *copy = bitset->realloc(NULL, size);
+	if (copy == NULL)
+		return NULL;
+
+	if (capacity > 0)
+		tt_bitset_page_create_array(copy, capacity);
+	else
+		tt_bitset_page_create(copy);
+	copy->first_pos = page->first_pos;
+	copy->cardinality = page->cardinality;
+
+	if (tt_bitset_page_is_array(page) && capacity > 0) {
+		memcpy(tt_bitset_page_array(copy), tt_bitset_page_array(page),
+		       page->cardinality * sizeof(uint16_t));
+	} else if (tt_bitset_page_is_array(page)) {
+		/* Sparse -> dense */
+		tt_bitset_page_or(copy, page);
+	} else {
+		/* Dense -> sparse */
+		uint16_t *array = tt_bitset_page_array(copy);
+		struct bit_iterator it;
+		bit_iterator_init(&it, tt_bitset_page_data(page),
+				  BITSET_PAGE_DATA_SIZE, true);
+		size_t offset;
+		while ((offset = bit_iterator_next(&it)) != SIZE_MAX)
+			*array++ = offset;
+		assert(array == tt_bitset_page_array(copy) +
+				copy->cardinality);
+	}
+
+	/* Pages are keyed by first_pos, so the order is kept */
+	tt_bitset_pages_remove(&bitset->pages, page);
+	tt_bitset_pages_insert(&bitset->pages, copy);
+	tt_bitset_page_destroy(page);
+	bitset->realloc(page, 0);
+	return copy;
 }
 
 int
@@ -93,13 +145,14 @@ tt_bitset_set(struct tt_bitset *bitset, size_t pos)
 	struct tt_bitset_page *page =
 		tt_bitset_pages_search(&bitset->pages, &key);
 	if (page == NULL) {
-		/* Allocate a new page */
-		size_t size = tt_bitset_page_alloc_size(bitset->realloc);
+		/* Allocate a new sparse page */
+		size_t size =
+			tt_bitset_page_array_alloc_size(BITSET_PAGE_ARRAY_MIN);
 		page = bitset->realloc(NULL, size);
 		if (page == NULL)
 			return -1;
 
-		tt_bitset_page_create(page);
+		tt_bitset_page_create_array(page, BITSET_PAGE_ARRAY_MIN);
 		page->first_pos = key.first_pos;
 
 		/* Insert the page into pages tree */
@@ -108,10 +161,36 @@ tt_bitset_set(struct tt_bitset *bitset, size_t pos)
 
 	assert(page->first_pos <= pos && pos < page->first_pos +
 	       BITSET_PAGE_DATA_SIZE * CHAR_BIT);
-	bool prev = bit_set(tt_bitset_page_data(page), pos - page->first_pos);
-	if (prev) {
-		/* Value has not changed */
-		return 1;
+	size_t offset = pos - page->first_pos;
+	if (tt_bitset_page_is_array(page)) {
+		uint32_t i = tt_bitset_page_array_lower_bound(page, offset);
+		if (i < page->cardinality &&
+		    tt_bitset_page_array(page)[i] == offset) {
+			/* Value has not changed */
+			return 1;
+		}
+		if (page->cardinality == page->capacity) {
+			/* Grow the array or switch to a bitmap */
+			uint32_t capacity = page->capacity * 2;
+			if (capacity > BITSET_PAGE_ARRAY_MAX)
+				capacity = 0;
+			page = tt_bitset_page_convert(bitset, page, capacity);
+			if (page == NULL)
+				return -1;
+		}
+	}
+	if (tt_bitset_page_is_array(page)) {
+		uint32_t i = tt_bitset_page_array_lower_bound(page, offset);
+		uint16_t *array = tt_bitset_page_array(page);
+		memmove(array + i + 1, array + i,
+			(page->cardinality - i) * sizeof(*array));
+		array[i] = offset;
+	} else {
+		bool prev = bit_set(tt_bitset_page_data(page), offset);
+		if (prev) {
+			/* Value has not changed */
+			return 1;
+		}
 	}
 
 	bitset->cardinality++;
@@ -134,9 +213,19 @@ tt_bitset_clear(struct tt_bitset *bitset, size_t pos)
 
 	assert(page->first_pos <= pos && pos < page->first_pos +
 	       BITSET_PAGE_DATA_SIZE * CHAR_BIT);
-	bool prev = bit_clear(tt_bitset_page_data(page), pos - page->first_pos);
-	if (!prev) {
-		return 0;
+	size_t offset = pos - page->first_pos;
+	if (tt_bitset_page_is_array(page)) {
+		uint32_t i = tt_bitset_page_array_lower_bound(page, offset);
+		uint16_t *array = tt_bitset_page_array(page);
+		if (i >= page->cardinality || array[i] != offset)
+			return 0;
+		memmove(array + i, array + i + 1,
+			(page->cardinality - i - 1) * sizeof(*array));
+	} else {
+		bool prev = bit_clear(tt_bitset_page_data(page), offset);
+		if (!prev) {
+			return 0;
+		}
 	}
 
 	assert(bitset->cardinality > 0);
@@ -150,6 +239,15 @@ tt_bitset_clear(struct tt_bitset *bitset, size_t pos)
 		/* Free the page */
 		tt_bitset_page_destroy(page);
 		bitset->realloc(page, 0);
+	} else if (!tt_bitset_page_is_array(page) &&
+		   page->cardinality <= BITSET_PAGE_ARRAY_MAX / 2) {
+		/*
+		 * Switch back to a sorted array. Leave some room
+		 * for new bits to avoid flapping between formats.
+		 * The bitmap is still valid if there is no memory.
+		 */
+		tt_bitset_page_convert(bitset, page,
+				       BITSET_PAGE_ARRAY_MAX / 2);
 	}
 
 	return 1;
@@ -170,6 +268,13 @@ tt_bitset_info(struct tt_bitset *bitset, struct tt_bitset_info *info)
 	struct tt_bitset_page *page = tt_bitset_pages_first(&bitset->pages);
 	while (page != NULL) {
 		info->pages++;
+		if (tt_bitset_page_is_array(page)) {
+			info->array_pages++;
+			info->total_size +=
+				tt_bitset_page_array_alloc_size(page->capacity);
+		} else {
+			info->total_size += info->page_total_size;
+		}
 		cardinality_check += page->cardinality;
 		page = tt_bitset_pages_next(&bitset->pages, page);
 	}
@@ -211,7 +316,7 @@ tt_bitset_dump(struct tt_bitset *bitset, int verbose, FILE *stream)
 			"utilization = undefined\n");
 	}
 	size_t mem_data  = info.page_data_size * info.pages;
-	size_t mem_total = info.page_total_size * info.pages;
+	size_t mem_total = info.total_size;
 
 	fprintf(stream, "    " "mem_data    = %zu bytes\n", mem_data);
 	fprintf(stream, "    " "mem_total   = %zu bytes "
@@ -242,7 +347,7 @@ tt_bitset_dump(struct tt_bitset *bitset, int verbose, FILE *stream)
 
 		fprintf(stream, "utilization = %8.4f%% (%zu/%zu)",
 			(float) page->cardinality * 1e2 / PAGE_BIT,
-			page->cardinality, PAGE_BIT);
+			(size_t) page->cardinality, PAGE_BIT);
 
 		if (verbose < 2) {
 			fprintf(stream, "\n");
@@ -252,6 +357,16 @@ tt_bitset_dump(struct tt_bitset *bitset, int verbose, FILE *stream)
 
 		fprintf(stream, "vals = {");
 
+		if (tt_bitset_page_is_array(page)) {
+			uint16_t *array = tt_bitset_page_array(page);
+			for (uint32_t i = 0; i < page->cardinality; i++) {
+				fprintf(stream, "%zu, ",
+					page->first_pos + array[i]);
+			}
+			fprintf(stream, "}\n");
+			continue;
+		}
+
 		size_t pos = 0;
 		struct bit_iterator it;
 		bit_iterator_init(&it, bitset_page_data(page),
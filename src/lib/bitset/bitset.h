@@ -68,7 +68,13 @@ extern "C" {
 struct tt_bitset_page {
 	size_t first_pos;
 	rb_node(struct tt_bitset_page) node;
-	size_t cardinality;
+	uint32_t cardinality;
+	/**
+	 * Number of slots in the sorted array of bit offsets
+	 * stored in @a data if the page is sparse, 0 if @a data
+	 * is a dense bitmap.
+	 */
+	uint32_t capacity;
 	uint8_t data[0];
 };
 
@@ -151,12 +157,16 @@ tt_bitset_cardinality(const struct tt_bitset *bitset) {
 struct tt_bitset_info {
 	/** Number of allocated pages */
 	size_t pages;
+	/** Number of pages stored as sorted arrays of offsets */
+	size_t array_pages;
 	/** Data (payload) size of one page (in bytes) */
 	size_t page_data_size;
 	/** Full size of one page (in bytes, including padding and tree data) */
 	size_t page_total_size;
 	/** A multiplier by which an address of page data is aligned **/
 	size_t page_data_alignment;
+	/** Memory used by all pages (in bytes, including tree data) */
+	size_t total_size;
 };
 
 /**
@@ -352,6 +352,13 @@ tt_bitset_iterator_prepare_page(struct tt_bitset_iterator *it)
 	if (it->page->first_pos == SIZE_MAX)
 		return;
 
+	if (it->size == 1 ||
+	    it->conjs[1].page_first_pos > it->page->first_pos) {
+		/* Only one conjunction, nothing to OR */
+		tt_bitset_iterator_conj_prepare_page(&it->conjs[0], it->page);
+		goto done;
+	}
+
 	/* For each conj where conj->page_first_pos == pos */
 	for (size_t c = 0; c < it->size; c++) {
 		if (it->conjs[c].page_first_pos > it->page->first_pos)
@@ -364,6 +371,7 @@ tt_bitset_iterator_prepare_page(struct tt_bitset_iterator *it)
 		tt_bitset_page_or(it->page, it->page_tmp);
 	}
 
+done:
 	/* Init the bit iterator on it->page */
 	bit_iterator_init(&it->page_it, tt_bitset_page_data(it->page),
 		      BITSET_PAGE_DATA_SIZE, true);
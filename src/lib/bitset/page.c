@@ -44,6 +44,24 @@ tt_bitset_page_create(struct tt_bitset_page *page);
 extern inline void
 tt_bitset_page_destroy(struct tt_bitset_page *page);
 
+extern inline size_t
+tt_bitset_page_array_alloc_size(uint32_t capacity);
+
+extern inline void
+tt_bitset_page_create_array(struct tt_bitset_page *page, uint32_t capacity);
+
+extern inline bool
+tt_bitset_page_is_array(const struct tt_bitset_page *page);
+
+extern inline uint16_t *
+tt_bitset_page_array(struct tt_bitset_page *page);
+
+extern inline uint32_t
+tt_bitset_page_array_lower_bound(struct tt_bitset_page *page, size_t offset);
+
+extern inline bool
+tt_bitset_page_test(struct tt_bitset_page *page, size_t offset);
+
 extern inline size_t
 tt_bitset_page_first_pos(size_t pos);
 
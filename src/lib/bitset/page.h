@@ -55,10 +55,27 @@ extern "C" {
 
 enum {
 	/** How many bytes to store in one page */
-	BITSET_PAGE_DATA_SIZE = 160
+	BITSET_PAGE_DATA_SIZE = 160,
+	/** Initial capacity of a sparse (array) page */
+	BITSET_PAGE_ARRAY_MIN = 4,
+	/**
+	 * Max number of offsets to store in a sparse page.
+	 * A page with more bits set is converted to a dense
+	 * bitmap, which takes less memory at this point.
+	 */
+	BITSET_PAGE_ARRAY_MAX = 64,
 };
 
-#if defined(ENABLE_AVX)
+#if defined(ENABLE_AVX) || defined(ENABLE_AVX2) || defined(ENABLE_SSE2)
+#include <immintrin.h>
+#endif
+
+/*
+ * Dense pages are ANDed, NANDed and ORed one machine word at
+ * a time. With AVX2 it is a single vpand/vpandn/vpor per 32
+ * bytes, i.e. 5 instructions per page.
+ */
+#if defined(ENABLE_AVX) || defined(ENABLE_AVX2)
 typedef __m256i tt_bitset_word_t;
 #define BITSET_PAGE_DATA_ALIGNMENT 32
 #elif defined(ENABLE_SSE2)
@@ -129,6 +146,65 @@ tt_bitset_page_destroy(struct tt_bitset_page *page)
 	/* nothing */
 }
 
+inline size_t
+tt_bitset_page_array_alloc_size(uint32_t capacity)
+{
+	assert(capacity > 0 && capacity <= BITSET_PAGE_ARRAY_MAX);
+	return sizeof(struct tt_bitset_page) + capacity * sizeof(uint16_t);
+}
+
+inline void
+tt_bitset_page_create_array(struct tt_bitset_page *page, uint32_t capacity)
+{
+	memset(page, 0, sizeof(*page));
+	page->capacity = capacity;
+}
+
+inline bool
+tt_bitset_page_is_array(const struct tt_bitset_page *page)
+{
+	return page->capacity > 0;
+}
+
+/** Sorted offsets of set bits of a sparse page */
+inline uint16_t *
+tt_bitset_page_array(struct tt_bitset_page *page)
+{
+	assert(tt_bitset_page_is_array(page));
+	return (uint16_t *) page->data;
+}
+
+/**
+ * Return the index of the first offset in a sparse page
+ * which is greater than or equal to @a offset.
+ */
+inline uint32_t
+tt_bitset_page_array_lower_bound(struct tt_bitset_page *page, size_t offset)
+{
+	const uint16_t *array = tt_bitset_page_array(page);
+	uint32_t begin = 0, end = page->cardinality;
+	while (begin < end) {
+		uint32_t mid = begin + (end - begin) / 2;
+		if (array[mid] < offset)
+			begin = mid + 1;
+		else
+			end = mid;
+	}
+	return begin;
+}
+
+/** Test bit @a offset (relative to page->first_pos) of any page */
+inline bool
+tt_bitset_page_test(struct tt_bitset_page *page, size_t offset)
+{
+	assert(offset < BITSET_PAGE_DATA_SIZE * CHAR_BIT);
+	if (!tt_bitset_page_is_array(page))
+		return bit_test(tt_bitset_page_data(page), offset);
+	uint32_t i = tt_bitset_page_array_lower_bound(page, offset);
+	return i < page->cardinality &&
+	       tt_bitset_page_array(page)[i] == offset;
+}
+
 inline size_t
 tt_bitset_page_first_pos(size_t pos) {
 	return pos - (pos % (BITSET_PAGE_DATA_SIZE * CHAR_BIT));
@@ -148,9 +224,33 @@ tt_bitset_page_set_ones(struct tt_bitset_page *page)
 	memset(data, -1, BITSET_PAGE_DATA_SIZE);
 }
 
+/*
+ * Page operations below expect @a dst to be a dense page,
+ * while @a src may be a page of any kind. Dense pages are
+ * processed word by word (one AVX/SSE2 register at a time
+ * when enabled), sparse pages bit by bit.
+ */
+
 inline void
 tt_bitset_page_and(struct tt_bitset_page *dst, struct tt_bitset_page *src)
 {
+	assert(!tt_bitset_page_is_array(dst));
+	if (tt_bitset_page_is_array(src)) {
+		/* The result is a subset of the sparse page */
+		void *data = tt_bitset_page_data(dst);
+		const uint16_t *array = tt_bitset_page_array(src);
+		uint16_t keep[BITSET_PAGE_ARRAY_MAX];
+		uint32_t count = 0;
+		for (uint32_t i = 0; i < src->cardinality; i++) {
+			if (bit_test(data, array[i]))
+				keep[count++] = array[i];
+		}
+		memset(data, 0, BITSET_PAGE_DATA_SIZE);
+		for (uint32_t i = 0; i < count; i++)
+			bit_set(data, keep[i]);
+		return;
+	}
+
 	tt_bitset_word_t *d = (tt_bitset_word_t *) tt_bitset_page_data(dst);
 	tt_bitset_word_t *s = (tt_bitset_word_t *) tt_bitset_page_data(src);
 
@@ -164,6 +264,15 @@ tt_bitset_page_and(struct tt_bitset_page *dst, struct tt_bitset_page *src)
 inline void
 tt_bitset_page_nand(struct tt_bitset_page *dst, struct tt_bitset_page *src)
 {
+	assert(!tt_bitset_page_is_array(dst));
+	if (tt_bitset_page_is_array(src)) {
+		void *data = tt_bitset_page_data(dst);
+		const uint16_t *array = tt_bitset_page_array(src);
+		for (uint32_t i = 0; i < src->cardinality; i++)
+			bit_clear(data, array[i]);
+		return;
+	}
+
 	tt_bitset_word_t *d = (tt_bitset_word_t *) tt_bitset_page_data(dst);
 	tt_bitset_word_t *s = (tt_bitset_word_t *) tt_bitset_page_data(src);
 
@@ -177,6 +286,15 @@ tt_bitset_page_nand(struct tt_bitset_page *dst, struct tt_bitset_page *src)
 inline void
 tt_bitset_page_or(struct tt_bitset_page *dst, struct tt_bitset_page *src)
 {
+	assert(!tt_bitset_page_is_array(dst));
+	if (tt_bitset_page_is_array(src)) {
+		void *data = tt_bitset_page_data(dst);
+		const uint16_t *array = tt_bitset_page_array(src);
+		for (uint32_t i = 0; i < src->cardinality; i++)
+			bit_set(data, array[i]);
+		return;
+	}
+
 	tt_bitset_word_t *d = (tt_bitset_word_t *) tt_bitset_page_data(dst);
 	tt_bitset_word_t *s = (tt_bitset_word_t *) tt_bitset_page_data(src);
 
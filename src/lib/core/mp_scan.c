@@ -0,0 +1,244 @@
+/*
+ * Copyright 2010-2019, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include "mp_scan.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include "trivia/config.h"
+#include "trivia/util.h"
+#include <cpu_feature.h>
+
+#if defined(ENABLE_SSE2) || \
+    (defined(HAVE_CPUID) && (defined(__x86_64__) || defined(__i386__)))
+#include <immintrin.h>
+#endif
+
+#if defined(HAVE_CPUID) && (defined(__x86_64__) || defined(__i386__))
+#define MP_SCAN_HAVE_AVX2 1
+#endif
+
+/**
+ * Return true if @a c is a complete one-byte MessagePack value:
+ * a positive or negative fixint, nil, false or true.
+ */
+static inline bool
+mp_scan_byte_is_value(uint8_t c)
+{
+	return c <= 0x7f || c >= 0xe0 || c == 0xc0 || c == 0xc2 ||
+	       c == 0xc3;
+}
+
+/**
+ * Return the number of leading bytes of @a data that are
+ * one-byte values, at most @a len. All @a len bytes must be
+ * readable.
+ */
+typedef size_t
+(*mp_scan_run_f)(const char *data, size_t len);
+
+static size_t
+mp_scan_run_generic(const char *data, size_t len)
+{
+	size_t i = 0;
+	while (i < len && mp_scan_byte_is_value(data[i]))
+		i++;
+	return i;
+}
+
+#if defined(ENABLE_SSE2)
+static size_t
+mp_scan_run_sse2(const char *data, size_t len)
+{
+	/* Fixints are exactly the bytes > -33 as signed. */
+	const __m128i fixint = _mm_set1_epi8(-33);
+	const __m128i nil = _mm_set1_epi8((char)0xc0);
+	const __m128i mp_false = _mm_set1_epi8((char)0xc2);
+	const __m128i mp_true = _mm_set1_epi8((char)0xc3);
+	size_t i = 0;
+	for (; i + 16 <= len; i += 16) {
+		__m128i v = _mm_loadu_si128((const __m128i *)(data + i));
+		__m128i m = _mm_or_si128(_mm_cmpgt_epi8(v, fixint),
+					 _mm_cmpeq_epi8(v, nil));
+		__m128i b = _mm_or_si128(_mm_cmpeq_epi8(v, mp_false),
+					 _mm_cmpeq_epi8(v, mp_true));
+		m = _mm_or_si128(m, b);
+		uint32_t mask = _mm_movemask_epi8(m);
+		if (mask != 0xffff)
+			return i + __builtin_ctz(~mask);
+	}
+	return i + mp_scan_run_generic(data + i, len - i);
+}
+#endif /* defined(ENABLE_SSE2) */
+
+#if defined(MP_SCAN_HAVE_AVX2)
+__attribute__((target("avx2")))
+static size_t
+mp_scan_run_avx2(const char *data, size_t len)
+{
+	const __m256i fixint = _mm256_set1_epi8(-33);
+	const __m256i nil = _mm256_set1_epi8((char)0xc0);
+	const __m256i mp_false = _mm256_set1_epi8((char)0xc2);
+	const __m256i mp_true = _mm256_set1_epi8((char)0xc3);
+	size_t i = 0;
+	for (; i + 32 <= len; i += 32) {
+		__m256i v = _mm256_loadu_si256((const __m256i *)(data + i));
+		__m256i m = _mm256_or_si256(_mm256_cmpgt_epi8(v, fixint),
+					    _mm256_cmpeq_epi8(v, nil));
+		__m256i b = _mm256_or_si256(_mm256_cmpeq_epi8(v, mp_false),
+					    _mm256_cmpeq_epi8(v, mp_true));
+		m = _mm256_or_si256(m, b);
+		uint32_t mask = _mm256_movemask_epi8(m);
+		if (mask != UINT32_MAX)
+			return i + __builtin_ctz(~mask);
+	}
+	return i + mp_scan_run_generic(data + i, len - i);
+}
+#endif /* defined(MP_SCAN_HAVE_AVX2) */
+
+/** Implementation chosen by mp_scan_init(). */
+static mp_scan_run_f mp_scan_run = mp_scan_run_generic;
+
+void
+mp_scan_init(void)
+{
+#if defined(ENABLE_SSE2)
+	mp_scan_run = mp_scan_run_sse2;
+#endif
+#if defined(MP_SCAN_HAVE_AVX2)
+	if (avx2_enabled_cpu())
+		mp_scan_run = mp_scan_run_avx2;
+#endif
+}
+
+/**
+ * Skip one value. Unlike mp_next(), elements of a container
+ * are scanned rather than decoded one by one.
+ */
+static inline void
+mp_scan_next(const char **data)
+{
+	enum mp_type type = mp_typeof(**data);
+	if (type == MP_ARRAY || type == MP_MAP)
+		mp_scan_skip_wide(data, 1);
+	else
+		mp_next(data);
+}
+
+void
+mp_scan_skip_wide(const char **data, uint32_t count)
+{
+	const char *pos = *data;
+	/*
+	 * Values left to skip including elements of containers.
+	 * Every value takes at least one byte, so it is also
+	 * the number of bytes that can be safely read ahead.
+	 */
+	uint64_t k = count;
+	while (k > 0) {
+		if (k >= MP_SCAN_MIN) {
+			size_t run = mp_scan_run(pos, k);
+			pos += run;
+			k -= run;
+			if (k == 0)
+				break;
+		}
+		switch (mp_typeof(*pos)) {
+		case MP_ARRAY:
+			k += mp_decode_array(&pos);
+			break;
+		case MP_MAP:
+			k += 2 * (uint64_t)mp_decode_map(&pos);
+			break;
+		default:
+			mp_next(&pos);
+		}
+		k--;
+	}
+	*data = pos;
+}
+
+const char *
+mp_scan_offsets(const char *data, uint32_t count, const char *base,
+		uint32_t *offsets)
+{
+	uint32_t i = 0;
+	while (i < count) {
+		if (count - i >= MP_SCAN_MIN) {
+			size_t run = mp_scan_run(data, count - i);
+			for (size_t j = 0; j < run; j++)
+				offsets[i + j] = data + j - base;
+			data += run;
+			i += run;
+			if (i == count)
+				break;
+		}
+		offsets[i++] = data - base;
+		mp_scan_next(&data);
+	}
+	return data;
+}
+
+int
+mp_scan_check(const char **data, const char *end, uint32_t count)
+{
+	const char *pos = *data;
+	/* Values left to check including elements of containers. */
+	uint64_t k = count;
+	while (k > 0) {
+		if (k >= MP_SCAN_MIN) {
+			size_t len = MIN(k, (uint64_t)(end - pos));
+			size_t run = mp_scan_run(pos, len);
+			pos += run;
+			k -= run;
+			if (k == 0)
+				break;
+		}
+		if (pos >= end)
+			return 1;
+		switch (mp_typeof(*pos)) {
+		case MP_ARRAY:
+			if (mp_check_array(pos, end) > 0)
+				return 1;
+			k += mp_decode_array(&pos);
+			break;
+		case MP_MAP:
+			if (mp_check_map(pos, end) > 0)
+				return 1;
+			k += 2 * (uint64_t)mp_decode_map(&pos);
+			break;
+		default:
+			if (mp_check(&pos, end) != 0)
+				return 1;
+		}
+		k--;
+	}
+	*data = pos;
+	return 0;
+}
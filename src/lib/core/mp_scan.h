@@ -0,0 +1,111 @@
+#ifndef TARANTOOL_LIB_CORE_MP_SCAN_H_INCLUDED
+#define TARANTOOL_LIB_CORE_MP_SCAN_H_INCLUDED
+/*
+ * Copyright 2010-2019, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include <stdint.h>
+#include "msgpuck.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+/**
+ * MessagePack scanner: walks a sequence of values in one pass.
+ *
+ * The boundary of a MessagePack value is only known once the
+ * previous one is decoded, but the most common tuple contents -
+ * small integers, nil and booleans - are encoded in a single
+ * byte. The scanner classifies the type bytes of 16 (SSE2) or
+ * 32 (AVX2) values at once and steps over a run of such values
+ * in one go, falling back to the scalar decoder on anything
+ * longer. The vector width is chosen at run time, see
+ * mp_scan_init().
+ */
+
+enum {
+	/**
+	 * Sequences shorter than this are skipped with plain
+	 * mp_next(), the scanner has no gain on them.
+	 */
+	MP_SCAN_MIN = 8,
+};
+
+/**
+ * Choose the fastest scanner implementation supported by
+ * the CPU. Before this is called, the portable one is used.
+ */
+void
+mp_scan_init(void);
+
+/** Skip @a count values, see mp_scan_skip(). */
+void
+mp_scan_skip_wide(const char **data, uint32_t count);
+
+/**
+ * Skip @a count MessagePack values starting at @a data, the
+ * same as calling mp_next() @a count times.
+ */
+static inline void
+mp_scan_skip(const char **data, uint32_t count)
+{
+	if (count >= MP_SCAN_MIN) {
+		mp_scan_skip_wide(data, count);
+		return;
+	}
+	for (uint32_t i = 0; i < count; i++)
+		mp_next(data);
+}
+
+/**
+ * Store the offsets of @a count MessagePack values starting
+ * at @a data relative to @a base into @a offsets.
+ *
+ * @return pointer past the last scanned value.
+ */
+const char *
+mp_scan_offsets(const char *data, uint32_t count, const char *base,
+		uint32_t *offsets);
+
+/**
+ * Check that [*data, end) starts with @a count valid MessagePack
+ * values, the same as calling mp_check() @a count times.
+ *
+ * @retval 0 success, @a data points past the last value.
+ * @retval 1 the data is truncated or malformed.
+ */
+int
+mp_scan_check(const char **data, const char *end, uint32_t count);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
+
+#endif /* TARANTOOL_LIB_CORE_MP_SCAN_H_INCLUDED */
@@ -0,0 +1,347 @@
+/*
+ * Copyright 2010-2019, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include "uring.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <string.h>
+
+#include "diag.h"
+#include "trivia/util.h"
+
+#if defined(HAVE_IO_URING)
+
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static inline unsigned
+uring_load_acquire(const unsigned *p)
+{
+	return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+static inline void
+uring_store_release(unsigned *p, unsigned v)
+{
+	__atomic_store_n(p, v, __ATOMIC_RELEASE);
+}
+
+int
+uring_create(struct uring *ring, unsigned entries)
+{
+	memset(ring, 0, sizeof(*ring));
+	ring->fd = -1;
+	ring->efd = -1;
+
+	struct io_uring_params p;
+	memset(&p, 0, sizeof(p));
+	int fd = syscall(__NR_io_uring_setup, entries, &p);
+	if (fd < 0) {
+		diag_set(SystemError, "io_uring_setup failed");
+		return -1;
+	}
+	ring->fd = fd;
+	ring->sq_entries = p.sq_entries;
+	ring->cq_entries = p.cq_entries;
+	ring->sq_ring_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+	ring->cq_ring_size = p.cq_off.cqes +
+			     p.cq_entries * sizeof(struct io_uring_cqe);
+	bool single_mmap = false;
+#if defined(IORING_FEAT_SINGLE_MMAP)
+	single_mmap = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+	if (single_mmap) {
+		ring->sq_ring_size = MAX(ring->sq_ring_size,
+					 ring->cq_ring_size);
+		ring->cq_ring_size = ring->sq_ring_size;
+	}
+#endif
+	ring->sq_ring = mmap(NULL, ring->sq_ring_size,
+			     PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+			     fd, IORING_OFF_SQ_RING);
+	if (ring->sq_ring == MAP_FAILED) {
+		ring->sq_ring = NULL;
+		diag_set(SystemError, "failed to map io_uring");
+		goto fail;
+	}
+	if (single_mmap) {
+		ring->cq_ring = ring->sq_ring;
+	} else {
+		ring->cq_ring = mmap(NULL, ring->cq_ring_size,
+				     PROT_READ | PROT_WRITE,
+				     MAP_SHARED | MAP_POPULATE,
+				     fd, IORING_OFF_CQ_RING);
+		if (ring->cq_ring == MAP_FAILED) {
+			ring->cq_ring = NULL;
+			diag_set(SystemError, "failed to map io_uring");
+			goto fail;
+		}
+	}
+	ring->sqes = mmap(NULL, p.sq_entries * sizeof(struct io_uring_sqe),
+			  PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+			  fd, IORING_OFF_SQES);
+	if (ring->sqes == MAP_FAILED) {
+		ring->sqes = NULL;
+		diag_set(SystemError, "failed to map io_uring");
+		goto fail;
+	}
+
+	char *sq = ring->sq_ring;
+	ring->sq_head = (unsigned *)(sq + p.sq_off.head);
+	ring->sq_tail = (unsigned *)(sq + p.sq_off.tail);
+	ring->sq_mask = *(unsigned *)(sq + p.sq_off.ring_mask);
+	ring->sq_local_tail = *ring->sq_tail;
+	/*
+	 * Submission queue entries are used in the ring order so
+	 * the index array is an identity map set up once.
+	 */
+	unsigned *array = (unsigned *)(sq + p.sq_off.array);
+	for (unsigned i = 0; i < p.sq_entries; i++)
+		array[i] = i;
+
+	char *cq = ring->cq_ring;
+	ring->cq_head = (unsigned *)(cq + p.cq_off.head);
+	ring->cq_tail = (unsigned *)(cq + p.cq_off.tail);
+	ring->cq_mask = *(unsigned *)(cq + p.cq_off.ring_mask);
+	ring->cqes = cq + p.cq_off.cqes;
+
+	ring->efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (ring->efd < 0) {
+		diag_set(SystemError, "failed to create eventfd");
+		goto fail;
+	}
+	if (syscall(__NR_io_uring_register, ring->fd,
+		    IORING_REGISTER_EVENTFD, &ring->efd, 1) != 0) {
+		diag_set(SystemError, "failed to register io_uring eventfd");
+		goto fail;
+	}
+	return 0;
+fail:
+	uring_destroy(ring);
+	return -1;
+}
+
+void
+uring_destroy(struct uring *ring)
+{
+	if (ring->sqes != NULL)
+		munmap(ring->sqes,
+		       ring->sq_entries * sizeof(struct io_uring_sqe));
+	if (ring->cq_ring != NULL && ring->cq_ring != ring->sq_ring)
+		munmap(ring->cq_ring, ring->cq_ring_size);
+	if (ring->sq_ring != NULL)
+		munmap(ring->sq_ring, ring->sq_ring_size);
+	if (ring->fd >= 0)
+		close(ring->fd);
+	if (ring->efd >= 0)
+		close(ring->efd);
+	memset(ring, 0, sizeof(*ring));
+	ring->fd = -1;
+	ring->efd = -1;
+}
+
+bool
+uring_has_space(struct uring *ring)
+{
+	unsigned head = uring_load_acquire(ring->sq_head);
+	return ring->sq_local_tail - head < ring->sq_entries &&
+	       ring->in_flight < ring->cq_entries;
+}
+
+void
+uring_prep_readv(struct uring *ring, int fd, const struct iovec *iov,
+		 int iovcnt, uint64_t offset, void *user_data)
+{
+	assert(uring_has_space(ring));
+	struct io_uring_sqe *sqe = (struct io_uring_sqe *)ring->sqes +
+				   (ring->sq_local_tail & ring->sq_mask);
+	memset(sqe, 0, sizeof(*sqe));
+	sqe->opcode = IORING_OP_READV;
+	sqe->fd = fd;
+	sqe->addr = (uintptr_t)iov;
+	sqe->len = iovcnt;
+	sqe->off = offset;
+	sqe->user_data = (uintptr_t)user_data;
+	ring->sq_local_tail++;
+	ring->in_flight++;
+}
+
+int
+uring_submit(struct uring *ring)
+{
+	uring_store_release(ring->sq_tail, ring->sq_local_tail);
+	unsigned to_submit = ring->sq_local_tail -
+			     uring_load_acquire(ring->sq_head);
+	while (to_submit > 0) {
+		int rc = syscall(__NR_io_uring_enter, ring->fd,
+				 to_submit, 0, 0, NULL, 0);
+		if (rc < 0) {
+			if (errno == EINTR)
+				continue;
+			diag_set(SystemError, "io_uring_enter failed");
+			return -1;
+		}
+		if (rc == 0) {
+			/*
+			 * The kernel didn't accept any request.
+			 * Don't spin, let the caller retry later.
+			 */
+			errno = EAGAIN;
+			diag_set(SystemError, "io_uring_enter failed");
+			return -1;
+		}
+		to_submit -= MIN((unsigned)rc, to_submit);
+	}
+	return 0;
+}
+
+int
+uring_cancel(struct uring *ring, int res, uring_complete_f cb, void *arg)
+{
+	/*
+	 * The kernel consumes the submission queue only from
+	 * io_uring_enter(), which is called from this thread,
+	 * so the head can't move under our feet and it's safe
+	 * to take back the requests that are still queued.
+	 */
+	unsigned head = uring_load_acquire(ring->sq_head);
+	unsigned tail = ring->sq_local_tail;
+	ring->sq_local_tail = head;
+	uring_store_release(ring->sq_tail, head);
+	int count = 0;
+	for (unsigned i = head; i != tail; i++) {
+		struct io_uring_sqe *sqe = (struct io_uring_sqe *)ring->sqes +
+					   (i & ring->sq_mask);
+		void *user_data = (void *)(uintptr_t)sqe->user_data;
+		assert(ring->in_flight > 0);
+		ring->in_flight--;
+		cb(user_data, res, arg);
+		count++;
+	}
+	return count;
+}
+
+int
+uring_reap(struct uring *ring, uring_complete_f cb, void *arg)
+{
+	eventfd_t value;
+	(void)eventfd_read(ring->efd, &value);
+	int count = 0;
+	unsigned head = *ring->cq_head;
+	unsigned tail = uring_load_acquire(ring->cq_tail);
+	while (head != tail) {
+		struct io_uring_cqe *cqe = (struct io_uring_cqe *)ring->cqes +
+					   (head & ring->cq_mask);
+		void *user_data = (void *)(uintptr_t)cqe->user_data;
+		int res = cqe->res;
+		uring_store_release(ring->cq_head, ++head);
+		assert(ring->in_flight > 0);
+		ring->in_flight--;
+		cb(user_data, res, arg);
+		count++;
+		tail = uring_load_acquire(ring->cq_tail);
+	}
+	return count;
+}
+
+#else /* !defined(HAVE_IO_URING) */
+
+int
+uring_create(struct uring *ring, unsigned entries)
+{
+	(void)entries;
+	memset(ring, 0, sizeof(*ring));
+	ring->fd = -1;
+	ring->efd = -1;
+	errno = ENOSYS;
+	diag_set(SystemError, "io_uring is not supported");
+	return -1;
+}
+
+void
+uring_destroy(struct uring *ring)
+{
+	(void)ring;
+}
+
+bool
+uring_has_space(struct uring *ring)
+{
+	(void)ring;
+	unreachable();
+	return false;
+}
+
+void
+uring_prep_readv(struct uring *ring, int fd, const struct iovec *iov,
+		 int iovcnt, uint64_t offset, void *user_data)
+{
+	(void)ring;
+	(void)fd;
+	(void)iov;
+	(void)iovcnt;
+	(void)offset;
+	(void)user_data;
+	unreachable();
+}
+
+int
+uring_submit(struct uring *ring)
+{
+	(void)ring;
+	unreachable();
+	return -1;
+}
+
+int
+uring_cancel(struct uring *ring, int res, uring_complete_f cb, void *arg)
+{
+	(void)ring;
+	(void)res;
+	(void)cb;
+	(void)arg;
+	unreachable();
+	return 0;
+}
+
+int
+uring_reap(struct uring *ring, uring_complete_f cb, void *arg)
+{
+	(void)ring;
+	(void)cb;
+	(void)arg;
+	unreachable();
+	return 0;
+}
+
+#endif /* !defined(HAVE_IO_URING) */
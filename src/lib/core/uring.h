@@ -0,0 +1,169 @@
+#ifndef TARANTOOL_LIB_CORE_URING_H_INCLUDED
+#define TARANTOOL_LIB_CORE_URING_H_INCLUDED
+/*
+ * Copyright 2010-2019, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/uio.h>
+#include "trivia/config.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+/**
+ * A thin wrapper around a Linux io_uring instance, enough to
+ * submit batches of file reads and reap their completions
+ * without a round trip to a thread pool per request.
+ *
+ * Requests are queued with uring_prep_readv(), which doesn't
+ * enter the kernel, and are passed to the kernel in one system
+ * call by uring_submit(). The kernel signals uring::efd on
+ * completion so that the ring can be polled by an event loop.
+ * Completions are reaped with uring_reap(). The ring isn't
+ * thread-safe: requests must be submitted and reaped from the
+ * same thread.
+ *
+ * On systems without io_uring uring_create() always fails.
+ */
+struct uring {
+	/** File descriptor of the ring, -1 if not created. */
+	int fd;
+	/** eventfd signalled by the kernel on request completion. */
+	int efd;
+	/** Number of submission queue entries. */
+	unsigned sq_entries;
+	/** Number of completion queue entries. */
+	unsigned cq_entries;
+	/** Submission queue ring, mapped from the kernel. */
+	void *sq_ring;
+	size_t sq_ring_size;
+	/** Completion queue ring, mapped from the kernel. */
+	void *cq_ring;
+	size_t cq_ring_size;
+	/** Array of submission queue entries. */
+	void *sqes;
+	/** Pointers into the mapped submission queue ring. */
+	unsigned *sq_head;
+	unsigned *sq_tail;
+	unsigned sq_mask;
+	/** Pointers into the mapped completion queue ring. */
+	unsigned *cq_head;
+	unsigned *cq_tail;
+	unsigned cq_mask;
+	void *cqes;
+	/**
+	 * Tail of the submission queue, including requests that
+	 * were prepared but haven't been passed to the kernel yet.
+	 */
+	unsigned sq_local_tail;
+	/** Number of requests the kernel hasn't completed yet. */
+	unsigned in_flight;
+};
+
+/**
+ * Create an io_uring instance with at least the given number
+ * of submission queue entries.
+ *
+ * @retval  0 Success.
+ * @retval -1 Error, diag is set.
+ */
+int
+uring_create(struct uring *ring, unsigned entries);
+
+/** Destroy an io_uring instance. */
+void
+uring_destroy(struct uring *ring);
+
+/**
+ * Return true if another request can be queued to the ring
+ * without overflowing its submission or completion queues.
+ */
+bool
+uring_has_space(struct uring *ring);
+
+/**
+ * Queue a read at @a offset of @a fd to the given buffers.
+ * The request isn't passed to the kernel until uring_submit()
+ * is called. The buffers and @a iov itself must stay valid
+ * until the request completes. The caller must check that
+ * the ring has space with uring_has_space() first.
+ *
+ * @param user_data Returned along with the completion.
+ */
+void
+uring_prep_readv(struct uring *ring, int fd, const struct iovec *iov,
+		 int iovcnt, uint64_t offset, void *user_data);
+
+/**
+ * Pass all queued requests to the kernel. If the kernel fails
+ * to accept some of them, for example, because it's short of
+ * resources, they stay queued and are passed by the next call.
+ *
+ * @retval  0 Success.
+ * @retval -1 Error, diag and errno are set.
+ */
+int
+uring_submit(struct uring *ring);
+
+/**
+ * Callback invoked by uring_reap() for each completed request.
+ * @a res is the number of bytes read or a negated errno.
+ */
+typedef void
+(*uring_complete_f)(void *user_data, int res, void *arg);
+
+/**
+ * Complete all requests that are queued, but haven't been passed
+ * to the kernel yet, with result @a res, invoking @a cb for each
+ * of them. Used to give up on requests uring_submit() keeps
+ * failing to pass to the kernel.
+ *
+ * @return The number of cancelled requests.
+ */
+int
+uring_cancel(struct uring *ring, int res, uring_complete_f cb, void *arg);
+
+/**
+ * Invoke @a cb for all completed requests and remove them from
+ * the completion queue. Also resets uring::efd. Doesn't block.
+ *
+ * @return The number of reaped requests.
+ */
+int
+uring_reap(struct uring *ring, uring_complete_f cb, void *arg);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
+
+#endif /* TARANTOOL_LIB_CORE_URING_H_INCLUDED */
@@ -49,9 +49,11 @@ bloom_create(struct bloom *bloom, uint32_t number_of_values,
 	uint32_t block_bits = CHAR_BIT * sizeof(struct bloom_block);
 	uint32_t block_count = (bit_count + block_bits - 1) / block_bits;
 
-	bloom->table = calloc(block_count, sizeof(*bloom->table));
-	if (bloom->table == NULL)
+	size_t size = block_count * sizeof(*bloom->table);
+	if (posix_memalign((void **)&bloom->table,
+			   BLOOM_CACHE_LINE, size) != 0)
 		return -1;
+	memset(bloom->table, 0, size);
 
 	bloom->table_size = block_count;
 	bloom->hash_count = hash_count;
@@ -95,8 +97,8 @@ int
 bloom_load_table(struct bloom *bloom, const char *table)
 {
 	size_t size = bloom->table_size * sizeof(struct bloom_block);
-	bloom->table = malloc(size);
-	if (bloom->table == NULL)
+	if (posix_memalign((void **)&bloom->table,
+			   BLOOM_CACHE_LINE, size) != 0)
 		return -1;
 	memcpy(bloom->table, table, size);
 	return 0;
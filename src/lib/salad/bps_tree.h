@@ -141,6 +141,7 @@
  * int bps_tree_insert_get_iterator(tree, new_elem, replaced_elem,
  * 				    inserted_iterator)
  * int bps_tree_delete(tree, elem);
+ * int bps_tree_delete_identical(tree, elem);
  * size_t bps_tree_size(tree);
  * size_t bps_tree_mem_used(tree);
  * bps_tree_elem_t *bps_tree_random(tree, rnd);
@@ -282,6 +283,30 @@
 #define BPS_TREE_IDENTICAL(a, b) (a == b)
 #endif
 
+/**
+ * Optional order preserving projections of elements and keys
+ * onto unsigned 64-bit integers (ordinals), such that
+ *
+ *   a < b => ORD(a) <= ORD(b)
+ *
+ * If defined, search in a block first narrows down the range of
+ * elements to those having the same ordinal as the searched one
+ * using interpolation search. Only ordinals, which are supposed
+ * to be stored inline in elements, are looked at while doing
+ * that, so BPS_TREE_COMPARE and BPS_TREE_COMPARE_KEY are called
+ * only for elements whose ordinals are equal. This pays off for
+ * integer keys, especially monotonically increasing ones.
+ * An ordinal equal to BPS_TREE_ORD_NONE disables the search by
+ * ordinals, e.g. if they are not defined for a particular tree
+ * instance. Both must be defined or undefined. Example:
+ *
+ * #define BPS_TREE_ELEM_ORD(elem, arg) ((elem).hint)
+ * #define BPS_TREE_KEY_ORD(key, arg) ((key)->hint)
+ */
+#if defined(BPS_TREE_ELEM_ORD) != defined(BPS_TREE_KEY_ORD)
+#error "BPS_TREE_ELEM_ORD and BPS_TREE_KEY_ORD must be defined together"
+#endif
+
 /**
  * A switch to define the type of search in an array elements.
  * By default, bps_tree uses binary search to find a particular
@@ -360,6 +385,7 @@ typedef uint32_t bps_tree_block_id_t;
 #define bps_tree_insert _api_name(insert)
 #define bps_tree_insert_get_iterator _api_name(insert_get_iterator)
 #define bps_tree_delete _api_name(delete)
+#define bps_tree_delete_identical _api_name(delete_identical)
 #define bps_tree_size _api_name(size)
 #define bps_tree_mem_used _api_name(mem_used)
 #define bps_tree_random _api_name(random)
@@ -396,6 +422,8 @@ typedef uint32_t bps_tree_block_id_t;
 #define bps_tree_restore_block_ver _bps_tree(restore_block_ver)
 #define bps_tree_root _bps_tree(root)
 #define bps_tree_touch_block _bps_tree(touch_block)
+#define bps_tree_ord_bound _bps_tree(ord_bound)
+#define bps_tree_ord_narrow _bps_tree(ord_narrow)
 #define bps_tree_find_ins_point_key _bps_tree(find_ins_point_key)
 #define bps_tree_find_ins_point_elem _bps_tree(find_ins_point_elem)
 #define bps_tree_find_after_ins_point_key _bps_tree(find_after_ins_point_key)
@@ -642,6 +670,18 @@ bps_tree_insert_get_iterator(struct bps_tree *tree, bps_tree_elem_t new_elem,
 static inline int
 bps_tree_delete(struct bps_tree *tree, bps_tree_elem_t elem);
 
+/**
+ * @brief Delete an element from a tree if the element stored in
+ * the tree is identical to the given one (see BPS_TREE_IDENTICAL).
+ * Unlike bps_tree_delete() doesn't remove an element that is only
+ * equal to the given one according to BPS_TREE_COMPARE.
+ * @param tree - pointer to a tree
+ * @param elem - the element to delete
+ * @return - 0 on success or -1 if the element was not found in tree
+ */
+static inline int
+bps_tree_delete_identical(struct bps_tree *tree, bps_tree_elem_t elem);
+
 /**
  * @brief Get size of tree, i.e. count of elements in tree
  * @param tree - pointer to a tree
@@ -1329,6 +1369,90 @@ bps_tree_random(const struct bps_tree *tree, size_t rnd)
 	return leaf->elems + pos;
 }
 
+#ifdef BPS_TREE_ELEM_ORD
+
+#ifndef BPS_TREE_ORD_NONE
+#define BPS_TREE_ORD_NONE UINT64_MAX
+#endif
+
+/**
+ * Max number of interpolation probes made by bps_tree_ord_bound()
+ * before falling back on binary search.
+ */
+#ifndef BPS_TREE_ORD_PROBES
+#define BPS_TREE_ORD_PROBES 3
+#endif
+
+/**
+ * @brief Find the lowest element in sorted array whose ordinal
+ * is >= than the given one (> if strict is set).
+ * Interpolation search is tried first: on evenly distributed
+ * ordinals it takes one or two probes to find the element.
+ * If it doesn't converge quickly, binary search is used.
+ * @param tree - pointer to a tree
+ * @param begin - the first element of the array
+ * @param end - the element next to the last one of the array
+ * @param ord - ordinal to find
+ * @param strict - find the lowest element with greater ordinal
+ */
+static inline bps_tree_elem_t *
+bps_tree_ord_bound(const struct bps_tree *tree, bps_tree_elem_t *begin,
+		   bps_tree_elem_t *end, uint64_t ord, bool strict)
+{
+	(void)tree;
+	for (int i = 0; i < BPS_TREE_ORD_PROBES && begin != end; i++) {
+		uint64_t lo = BPS_TREE_ELEM_ORD(*begin, tree->arg);
+		uint64_t hi = BPS_TREE_ELEM_ORD(*(end - 1), tree->arg);
+		if (ord < lo || (!strict && ord == lo))
+			return begin;
+		if (ord > hi || (strict && ord == hi))
+			return end;
+		/* Here lo <= ord <= hi and lo < hi. */
+		size_t size = end - begin;
+		size_t pos = (size_t)((double)(ord - lo) / (double)(hi - lo) *
+				      (double)(size - 1));
+		if (pos >= size)
+			pos = size - 1;
+		bps_tree_elem_t *mid = begin + pos;
+		uint64_t mid_ord = BPS_TREE_ELEM_ORD(*mid, tree->arg);
+		if (mid_ord < ord || (strict && mid_ord == ord))
+			begin = mid + 1;
+		else
+			end = mid;
+	}
+	while (begin != end) {
+		bps_tree_elem_t *mid = begin + (end - begin) / 2;
+		uint64_t mid_ord = BPS_TREE_ELEM_ORD(*mid, tree->arg);
+		if (mid_ord < ord || (strict && mid_ord == ord))
+			begin = mid + 1;
+		else
+			end = mid;
+	}
+	return end;
+}
+
+/**
+ * @brief Narrow down a range of sorted array to the elements
+ * that have the given ordinal. All elements to the left of
+ * the range are less than any element or key with this ordinal
+ * while all elements to the right of the range are greater.
+ * @param tree - pointer to a tree
+ * @param[in][out] begin - the first element of the range
+ * @param[in][out] end - the element next to the last one
+ * @param ord - ordinal to find
+ */
+static inline void
+bps_tree_ord_narrow(const struct bps_tree *tree, bps_tree_elem_t **begin,
+		    bps_tree_elem_t **end, uint64_t ord)
+{
+	if (ord == BPS_TREE_ORD_NONE)
+		return;
+	*begin = bps_tree_ord_bound(tree, *begin, *end, ord, false);
+	*end = bps_tree_ord_bound(tree, *begin, *end, ord, true);
+}
+
+#endif /* BPS_TREE_ELEM_ORD */
+
 /**
  * @brief Find the lowest element in sorted array that is >= than the key
  * @param tree - pointer to a tree
@@ -1356,6 +1480,10 @@ bps_tree_find_ins_point_key(const struct bps_tree *tree, bps_tree_elem_t *arr,
 	}
 	return (bps_tree_pos_t)(begin - arr);
 #else
+#ifdef BPS_TREE_ELEM_ORD
+	bps_tree_ord_narrow(tree, &begin, &end,
+			    BPS_TREE_KEY_ORD(key, tree->arg));
+#endif
 	while (begin != end) {
 		bps_tree_elem_t *mid = begin + (end - begin) / 2;
 		int res = BPS_TREE_COMPARE_KEY(*mid, key, tree->arg);
@@ -1401,6 +1529,10 @@ bps_tree_find_ins_point_elem(const struct bps_tree *tree, bps_tree_elem_t *arr,
 	}
 	return (bps_tree_pos_t)(begin - arr);
 #else
+#ifdef BPS_TREE_ELEM_ORD
+	bps_tree_ord_narrow(tree, &begin, &end,
+			    BPS_TREE_ELEM_ORD(elem, tree->arg));
+#endif
 	while (begin != end) {
 		bps_tree_elem_t *mid = begin + (end - begin) / 2;
 		int res = BPS_TREE_COMPARE(*mid, elem, tree->arg);
@@ -1448,6 +1580,10 @@ bps_tree_find_after_ins_point_key(const struct bps_tree *tree,
 	}
 	return (bps_tree_pos_t)(begin - arr);
 #else
+#ifdef BPS_TREE_ELEM_ORD
+	bps_tree_ord_narrow(tree, &begin, &end,
+			    BPS_TREE_KEY_ORD(key, tree->arg));
+#endif
 	while (begin != end) {
 		bps_tree_elem_t *mid = begin + (end - begin) / 2;
 		int res = BPS_TREE_COMPARE_KEY(*mid, key, tree->arg);
@@ -1494,6 +1630,10 @@ bps_tree_find_after_ins_point_elem(const struct bps_tree *tree,
 	}
 	return (bps_tree_pos_t)(begin - arr);
 #else
+#ifdef BPS_TREE_ELEM_ORD
+	bps_tree_ord_narrow(tree, &begin, &end,
+			    BPS_TREE_ELEM_ORD(elem, tree->arg));
+#endif
 	while (begin != end) {
 		bps_tree_elem_t *mid = begin + (end - begin) / 2;
 		int res = BPS_TREE_COMPARE(*mid, elem, tree->arg);
@@ -4516,6 +4656,33 @@ bps_tree_delete(struct bps_tree *tree, bps_tree_elem_t elem)
 	return 0;
 }
 
+/**
+ * @brief Delete an element identical to the given one from a tree.
+ * @param tree - pointer to a tree
+ * @param elem - the element to delete
+ * @return - 0 on success or -1 if the element was not found in tree
+ */
+static inline int
+bps_tree_delete_identical(struct bps_tree *tree, bps_tree_elem_t elem)
+{
+	if (tree->root_id == (bps_tree_block_id_t)(-1))
+		return -1;
+	struct bps_inner_path_elem path[BPS_TREE_MAX_DEPTH];
+	struct bps_leaf_path_elem leaf_path_elem;
+	bool exact;
+	bps_tree_collect_path(tree, elem, path, &leaf_path_elem, &exact);
+
+	if (!exact)
+		return -1;
+	bps_tree_elem_t found =
+		leaf_path_elem.block->elems[leaf_path_elem.insertion_point];
+	if (!BPS_TREE_IDENTICAL(found, elem))
+		return -1;
+
+	bps_tree_process_delete_leaf(tree, &leaf_path_elem);
+	return 0;
+}
+
 /**
  * @brief Recursively find a maximum element in subtree.
  * Used only for debug purposes
@@ -6054,6 +6221,7 @@ bps_tree_debug_check_internal_functions(bool assertme)
 #undef bps_tree_find
 #undef bps_tree_insert
 #undef bps_tree_delete
+#undef bps_tree_delete_identical
 #undef bps_tree_size
 #undef bps_tree_mem_used
 #undef bps_tree_random
@@ -6089,6 +6257,8 @@ bps_tree_debug_check_internal_functions(bool assertme)
 #undef bps_tree_restore_block_ver
 #undef bps_tree_root
 #undef bps_tree_touch_block
+#undef bps_tree_ord_bound
+#undef bps_tree_ord_narrow
 #undef bps_tree_find_ins_point_key
 #undef bps_tree_find_ins_point_elem
 #undef bps_tree_find_after_ins_point_key
@@ -0,0 +1,1204 @@
+/*
+ * *No header guard*: the header is allowed to be included twice
+ * with different sets of defines.
+ */
+/*
+ * Copyright 2010-2019, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include "small/matras.h"
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * Open addressing counterpart of light.h.
+ *
+ * Values are stored in groups of LIGHT_SWISS_GROUP_SIZE slots.
+ * Every group starts with an array of one byte control tags, one
+ * per slot: a slot is either empty, deleted (a tombstone) or full,
+ * in which case its control byte holds 7 high bits of the value
+ * hash. A lookup compares all tags of a group at once (with SSE2
+ * if available) and calls the comparison function only for slots
+ * whose tag matches. Groups are probed linearly starting from the
+ * group determined by the low bits of the hash; the probe stops
+ * at the first group that has an empty slot.
+ *
+ * Unlike light.h, the table never grows in place. When it gets
+ * loaded, a table of a new size is allocated and values are moved
+ * to it progressively: every insertion allocates a few groups of
+ * the new table and then moves a few groups of the old one, so
+ * there is no moment when the whole table is rehashed at once.
+ * While values are being moved, both tables are looked up. The
+ * old table is never modified by migration, only by deletion,
+ * so a frozen iterator keeps seeing a consistent picture.
+ *
+ * The API and the set of defines are the same as in light.h,
+ * but all names use prefix 'light_swiss' instead of 'light':
+ * #define LIGHT_NAME _test
+ * ...
+ * struct light_swiss_test_core hash_table;
+ * light_swiss_test_create(&hash_table, ...);
+ */
+#ifndef LIGHT_NAME
+#error "LIGHT_NAME must be defined"
+#endif
+
+/**
+ * Data type that hash table holds.
+ */
+#ifndef LIGHT_DATA_TYPE
+#error "LIGHT_DATA_TYPE must be defined"
+#endif
+
+/**
+ * Data type that used to for finding values.
+ */
+#ifndef LIGHT_KEY_TYPE
+#error "LIGHT_KEY_TYPE must be defined"
+#endif
+
+/**
+ * Type of optional third parameter of comparing function.
+ * If not needed, simply use #define LIGHT_CMP_ARG_TYPE int
+ */
+#ifndef LIGHT_CMP_ARG_TYPE
+#error "LIGHT_CMP_ARG_TYPE must be defined"
+#endif
+
+/**
+ * Data comparing function. Takes 3 parameters - value1, value2 and
+ * optional value that stored in hash table struct.
+ */
+#ifndef LIGHT_EQUAL
+#error "LIGHT_EQUAL must be defined"
+#endif
+
+/**
+ * Data comparing function. Takes 3 parameters - value, key and
+ * optional value that stored in hash table struct.
+ */
+#ifndef LIGHT_EQUAL_KEY
+#error "LIGHT_EQUAL_KEY must be defined"
+#endif
+
+/**
+ * Tools for name substitution:
+ */
+#ifndef CONCAT4
+#define CONCAT4_R(a, b, c, d) a##b##c##d
+#define CONCAT4(a, b, c, d) CONCAT4_R(a, b, c, d)
+#endif
+
+#ifdef _
+#error '_' must be undefinded!
+#endif
+#define LIGHT_SWISS(name) CONCAT4(light_swiss, LIGHT_NAME, _, name)
+
+#ifndef LIGHT_SWISS_COMMON
+#define LIGHT_SWISS_COMMON
+
+enum {
+	/** Number of slots in a group. */
+	LIGHT_SWISS_GROUP_SIZE = 16,
+	/** Control byte of a slot that has never been used. */
+	LIGHT_SWISS_CTRL_EMPTY = 0x80,
+	/** Control byte of a slot which value was deleted. */
+	LIGHT_SWISS_CTRL_DELETED = 0xFE,
+	/**
+	 * Number of groups of a new table allocated and number
+	 * of groups of an old table moved to the new one on each
+	 * insertion while the table is being resized.
+	 */
+	LIGHT_SWISS_ALLOC_STEP = 8,
+	LIGHT_SWISS_MIGRATE_STEP = 2,
+	/**
+	 * Max number of groups in a table. Limited so that a slot
+	 * number with LIGHT_SWISS_OLD_BIT set never equals end.
+	 */
+	LIGHT_SWISS_MAX_GROUP_COUNT = 1 << 26,
+};
+
+/**
+ * The bit set in a position (see light_swiss_find) of a value
+ * that has not yet been moved from the old table.
+ */
+#define LIGHT_SWISS_OLD_BIT 0x80000000u
+
+/** Control byte of a full slot: 7 high bits of the hash. */
+static inline uint8_t
+light_swiss_tag(uint32_t hash)
+{
+	return hash >> 25;
+}
+
+/**
+ * Return a bit mask of the slots of a group which control
+ * bytes are equal to @a c.
+ */
+static inline uint32_t
+light_swiss_match(const uint8_t *ctrl, uint8_t c)
+{
+#if defined(__SSE2__)
+	__m128i group = _mm_loadu_si128((const __m128i *)ctrl);
+	__m128i cmp = _mm_cmpeq_epi8(group, _mm_set1_epi8((char)c));
+	return (uint32_t)_mm_movemask_epi8(cmp);
+#else
+	uint32_t mask = 0;
+	for (int i = 0; i < LIGHT_SWISS_GROUP_SIZE; i++) {
+		if (ctrl[i] == c)
+			mask |= 1u << i;
+	}
+	return mask;
+#endif
+}
+
+/**
+ * Return a bit mask of the slots of a group that are either
+ * empty or deleted: both have the high bit of the control
+ * byte set, while tags of full slots don't.
+ */
+static inline uint32_t
+light_swiss_match_free(const uint8_t *ctrl)
+{
+#if defined(__SSE2__)
+	__m128i group = _mm_loadu_si128((const __m128i *)ctrl);
+	return (uint32_t)_mm_movemask_epi8(group);
+#else
+	uint32_t mask = 0;
+	for (int i = 0; i < LIGHT_SWISS_GROUP_SIZE; i++) {
+		if (ctrl[i] & 0x80)
+			mask |= 1u << i;
+	}
+	return mask;
+#endif
+}
+
+/** Bit mask of the full slots of a group. */
+static inline uint32_t
+light_swiss_match_full(const uint8_t *ctrl)
+{
+	return ~light_swiss_match_free(ctrl) &
+	       ((1u << LIGHT_SWISS_GROUP_SIZE) - 1);
+}
+
+#endif /* LIGHT_SWISS_COMMON */
+
+/**
+ * A group of slots. Control bytes go first so that probing
+ * a group touches one cache line in most cases.
+ */
+struct LIGHT_SWISS(group) {
+	/* control bytes of slots */
+	uint8_t ctrl[LIGHT_SWISS_GROUP_SIZE];
+	/* full hashes of values, needed to move them on resize */
+	uint32_t hash[LIGHT_SWISS_GROUP_SIZE];
+	/* the values */
+	LIGHT_DATA_TYPE value[LIGHT_SWISS_GROUP_SIZE];
+};
+
+/**
+ * A table of groups. A hash table has one such table normally
+ * and two while it is being resized.
+ */
+struct LIGHT_SWISS(table) {
+	/* dynamic storage for groups, one group per matras block */
+	struct matras mtable;
+	/* number of groups, power of two */
+	uint32_t group_count;
+	/* number of groups allocated so far */
+	uint32_t alloc_count;
+	/* number of full slots */
+	uint32_t count;
+	/* number of full and deleted slots */
+	uint32_t used;
+	/* number of frozen iterators that use the table */
+	uint32_t view_count;
+	/* unique identifier of the table in the hash table */
+	uint32_t generation;
+	/* link in the list of tables that are only used by views */
+	struct LIGHT_SWISS(table) *next_retired;
+};
+
+/**
+ * Type of functions for memory allocation and deallocation
+ */
+typedef void *(*LIGHT_SWISS(extent_alloc_t))(void *ctx);
+typedef void (*LIGHT_SWISS(extent_free_t))(void *ctx, void *extent);
+
+/**
+ * Main struct for holding hash table
+ */
+struct LIGHT_SWISS(core) {
+	/* count of values in hash table */
+	uint32_t count;
+	/* table that receives new values, NULL if nothing inserted yet */
+	struct LIGHT_SWISS(table) *table;
+	/* table that is being allocated to replace the current one */
+	struct LIGHT_SWISS(table) *new_table;
+	/* table which values are being moved to the current one */
+	struct LIGHT_SWISS(table) *old_table;
+	/*
+	 * groups of the old table with lower numbers are already
+	 * moved to the current table and must be ignored
+	 */
+	uint32_t migrate_pos;
+	/* generation of the last created table */
+	uint32_t generation;
+	/* tables that were replaced but still used by frozen iterators */
+	struct LIGHT_SWISS(table) *retired;
+	/* additional parameter for data comparison */
+	LIGHT_CMP_ARG_TYPE arg;
+	/* parameters of matras of new tables */
+	size_t extent_size;
+	LIGHT_SWISS(extent_alloc_t) extent_alloc_func;
+	LIGHT_SWISS(extent_free_t) extent_free_func;
+	void *alloc_ctx;
+};
+
+/**
+ * Iterator, for iterating all values in hash_table.
+ * It also may be used for restoring one value by key.
+ */
+struct LIGHT_SWISS(iterator) {
+	/*
+	 * Current slot in the table being iterated. A frozen
+	 * iterator marks slots of the old table with
+	 * LIGHT_SWISS_OLD_BIT.
+	 */
+	uint32_t slotpos;
+	union {
+		/* generation of the table being iterated */
+		uint32_t generation;
+		/* migrate_pos at the moment of freezing */
+		uint32_t migrate_pos;
+	};
+	/*
+	 * Old and current tables at the moment of freezing,
+	 * the current one is NULL if the iterator isn't frozen.
+	 */
+	struct LIGHT_SWISS(table) *frozen[2];
+	/* Versions of matras memory of the frozen tables */
+	struct matras_view view[2];
+};
+
+/**
+ * Special result of light_swiss_find that means that nothing
+ * was found.
+ */
+static const uint32_t LIGHT_SWISS(end) = 0xFFFFFFFF;
+
+/**
+ * @brief Hash table construction. Fills struct light_swiss members.
+ * @param ht - pointer to a hash table struct
+ * @param extent_size - size of allocating memory blocks
+ * @param extent_alloc_func - memory blocks allocation function
+ * @param extent_free_func - memory blocks allocation function
+ * @param alloc_ctx - argument passed to memory block allocator
+ * @param arg - optional parameter to save for comparing function
+ */
+static inline void
+LIGHT_SWISS(create)(struct LIGHT_SWISS(core) *ht, size_t extent_size,
+		    LIGHT_SWISS(extent_alloc_t) extent_alloc_func,
+		    LIGHT_SWISS(extent_free_t) extent_free_func,
+		    void *alloc_ctx, LIGHT_CMP_ARG_TYPE arg)
+{
+	memset(ht, 0, sizeof(*ht));
+	ht->arg = arg;
+	ht->extent_size = extent_size;
+	ht->extent_alloc_func = extent_alloc_func;
+	ht->extent_free_func = extent_free_func;
+	ht->alloc_ctx = alloc_ctx;
+}
+
+/**
+ * Size of a matras block holding a group: sizeof the group
+ * rounded up to the nearest power of two.
+ */
+static inline uint32_t
+LIGHT_SWISS(block_size)(void)
+{
+	return 1u << (32 - __builtin_clz(sizeof(struct LIGHT_SWISS(group)) - 1));
+}
+
+/**
+ * Create a table of @a group_count groups. No groups are
+ * allocated, see light_swiss_table_alloc.
+ * @return the table or NULL on memory error.
+ */
+static inline struct LIGHT_SWISS(table) *
+LIGHT_SWISS(table_new)(struct LIGHT_SWISS(core) *ht, uint32_t group_count)
+{
+	assert((group_count & (group_count - 1)) == 0);
+	assert(group_count <= LIGHT_SWISS_MAX_GROUP_COUNT);
+	struct LIGHT_SWISS(table) *t =
+		(struct LIGHT_SWISS(table) *)malloc(sizeof(*t));
+	if (t == NULL)
+		return NULL;
+	matras_create(&t->mtable, ht->extent_size, LIGHT_SWISS(block_size)(),
+		      ht->extent_alloc_func, ht->extent_free_func,
+		      ht->alloc_ctx);
+	t->group_count = group_count;
+	t->alloc_count = 0;
+	t->count = 0;
+	t->used = 0;
+	t->view_count = 0;
+	t->generation = ++ht->generation;
+	t->next_retired = NULL;
+	return t;
+}
+
+static inline void
+LIGHT_SWISS(table_delete)(struct LIGHT_SWISS(table) *t)
+{
+	matras_destroy(&t->mtable);
+	free(t);
+}
+
+/**
+ * Free a table that is not needed by the hash table anymore
+ * or retire it until all frozen iterators using it are gone.
+ */
+static inline void
+LIGHT_SWISS(table_release)(struct LIGHT_SWISS(core) *ht,
+			   struct LIGHT_SWISS(table) *t)
+{
+	if (t->view_count == 0) {
+		LIGHT_SWISS(table_delete)(t);
+		return;
+	}
+	t->next_retired = ht->retired;
+	ht->retired = t;
+}
+
+/**
+ * Allocate up to @a step more groups of a table and mark all
+ * their slots empty. The table isn't visible to iterators yet,
+ * so the groups needn't be touched.
+ * @return 0 on success, -1 on memory error.
+ */
+static inline int
+LIGHT_SWISS(table_alloc)(struct LIGHT_SWISS(table) *t, uint32_t step)
+{
+	while (step-- > 0 && t->alloc_count < t->group_count) {
+		matras_id_t id;
+		struct LIGHT_SWISS(group) *group = (struct LIGHT_SWISS(group) *)
+			matras_alloc(&t->mtable, &id);
+		if (group == NULL)
+			return -1;
+		assert(id == t->alloc_count);
+		memset(group->ctrl, LIGHT_SWISS_CTRL_EMPTY, sizeof(group->ctrl));
+		t->alloc_count++;
+	}
+	return 0;
+}
+
+/**
+ * @brief Hash table destruction. Frees all allocated memory
+ * @param ht - pointer to a hash table struct
+ */
+static inline void
+LIGHT_SWISS(destroy)(struct LIGHT_SWISS(core) *ht)
+{
+	if (ht->table != NULL)
+		LIGHT_SWISS(table_delete)(ht->table);
+	if (ht->new_table != NULL)
+		LIGHT_SWISS(table_delete)(ht->new_table);
+	if (ht->old_table != NULL)
+		LIGHT_SWISS(table_delete)(ht->old_table);
+	while (ht->retired != NULL) {
+		struct LIGHT_SWISS(table) *t = ht->retired;
+		ht->retired = t->next_retired;
+		LIGHT_SWISS(table_delete)(t);
+	}
+	ht->table = ht->new_table = ht->old_table = NULL;
+	ht->count = 0;
+}
+
+/**
+ * Number of matras extents used by all tables of the hash table.
+ */
+static inline matras_id_t
+LIGHT_SWISS(extent_count)(const struct LIGHT_SWISS(core) *ht)
+{
+	matras_id_t res = 0;
+	if (ht->table != NULL)
+		res += matras_extent_count(&ht->table->mtable);
+	if (ht->new_table != NULL)
+		res += matras_extent_count(&ht->new_table->mtable);
+	if (ht->old_table != NULL)
+		res += matras_extent_count(&ht->old_table->mtable);
+	for (struct LIGHT_SWISS(table) *t = ht->retired; t != NULL;
+	     t = t->next_retired)
+		res += matras_extent_count(&t->mtable);
+	return res;
+}
+
+/**
+ * First group to probe in a table for a given hash. Groups
+ * below @a lo are ignored (see light_swiss_core::migrate_pos).
+ */
+static inline uint32_t
+LIGHT_SWISS(probe_start)(const struct LIGHT_SWISS(table) *t, uint32_t lo,
+			 uint32_t hash)
+{
+	uint32_t g = hash & (t->group_count - 1);
+	return g < lo ? lo : g;
+}
+
+/** Next group to probe, wrapping around to @a lo. */
+static inline uint32_t
+LIGHT_SWISS(probe_next)(const struct LIGHT_SWISS(table) *t, uint32_t lo,
+			uint32_t g)
+{
+	return g + 1 == t->group_count ? lo : g + 1;
+}
+
+/**
+ * Find a slot of a table holding given hash and value.
+ * Groups below @a lo are ignored.
+ */
+static inline uint32_t
+LIGHT_SWISS(table_find)(const struct LIGHT_SWISS(core) *ht,
+			const struct LIGHT_SWISS(table) *t, uint32_t lo,
+			uint32_t hash, LIGHT_DATA_TYPE value)
+{
+	uint8_t tag = light_swiss_tag(hash);
+	uint32_t g = LIGHT_SWISS(probe_start)(t, lo, hash);
+	for (uint32_t n = t->group_count - lo; n > 0; n--) {
+		const struct LIGHT_SWISS(group) *group =
+			(const struct LIGHT_SWISS(group) *)
+			matras_get(&t->mtable, g);
+		uint32_t match = light_swiss_match(group->ctrl, tag);
+		while (match != 0) {
+			uint32_t i = __builtin_ctz(match);
+			match &= match - 1;
+			if (group->hash[i] == hash &&
+			    LIGHT_EQUAL((group->value[i]), (value), (ht->arg)))
+				return g * LIGHT_SWISS_GROUP_SIZE + i;
+		}
+		if (light_swiss_match(group->ctrl, LIGHT_SWISS_CTRL_EMPTY) != 0)
+			break;
+		g = LIGHT_SWISS(probe_next)(t, lo, g);
+	}
+	return LIGHT_SWISS(end);
+}
+
+/**
+ * Find a slot of a table holding given hash and key.
+ * Groups below @a lo are ignored.
+ */
+static inline uint32_t
+LIGHT_SWISS(table_find_key)(const struct LIGHT_SWISS(core) *ht,
+			    const struct LIGHT_SWISS(table) *t, uint32_t lo,
+			    uint32_t hash, LIGHT_KEY_TYPE key)
+{
+	uint8_t tag = light_swiss_tag(hash);
+	uint32_t g = LIGHT_SWISS(probe_start)(t, lo, hash);
+	for (uint32_t n = t->group_count - lo; n > 0; n--) {
+		const struct LIGHT_SWISS(group) *group =
+			(const struct LIGHT_SWISS(group) *)
+			matras_get(&t->mtable, g);
+		uint32_t match = light_swiss_match(group->ctrl, tag);
+		while (match != 0) {
+			uint32_t i = __builtin_ctz(match);
+			match &= match - 1;
+			if (group->hash[i] == hash &&
+			    LIGHT_EQUAL_KEY((group->value[i]), (key), (ht->arg)))
+				return g * LIGHT_SWISS_GROUP_SIZE + i;
+		}
+		if (light_swiss_match(group->ctrl, LIGHT_SWISS_CTRL_EMPTY) != 0)
+			break;
+		g = LIGHT_SWISS(probe_next)(t, lo, g);
+	}
+	return LIGHT_SWISS(end);
+}
+
+/**
+ * Put a value to the first free slot on its probe sequence.
+ * The value must not be present in the table.
+ * @return slot of the value or light_swiss_end if the table
+ * is full or on memory error.
+ */
+static inline uint32_t
+LIGHT_SWISS(table_insert)(struct LIGHT_SWISS(table) *t, uint32_t hash,
+			  LIGHT_DATA_TYPE value)
+{
+	uint32_t g = LIGHT_SWISS(probe_start)(t, 0, hash);
+	for (uint32_t n = t->group_count; n > 0; n--) {
+		const struct LIGHT_SWISS(group) *group =
+			(const struct LIGHT_SWISS(group) *)
+			matras_get(&t->mtable, g);
+		uint32_t match = light_swiss_match_free(group->ctrl);
+		if (match == 0) {
+			g = LIGHT_SWISS(probe_next)(t, 0, g);
+			continue;
+		}
+		struct LIGHT_SWISS(group) *wgroup = (struct LIGHT_SWISS(group) *)
+			matras_touch(&t->mtable, g);
+		if (wgroup == NULL)
+			return LIGHT_SWISS(end);
+		uint32_t i = __builtin_ctz(match);
+		if (wgroup->ctrl[i] == LIGHT_SWISS_CTRL_EMPTY)
+			t->used++;
+		wgroup->ctrl[i] = light_swiss_tag(hash);
+		wgroup->hash[i] = hash;
+		wgroup->value[i] = value;
+		t->count++;
+		return g * LIGHT_SWISS_GROUP_SIZE + i;
+	}
+	return LIGHT_SWISS(end);
+}
+
+/**
+ * Free a full slot of a table. The slot may be marked empty
+ * only if the group has an empty slot already, since otherwise
+ * it would break probe sequences of values stored further.
+ * @return 0 on success, -1 on memory error.
+ */
+static inline int
+LIGHT_SWISS(table_clear)(struct LIGHT_SWISS(table) *t, uint32_t slot)
+{
+	uint32_t g = slot / LIGHT_SWISS_GROUP_SIZE;
+	uint32_t i = slot % LIGHT_SWISS_GROUP_SIZE;
+	struct LIGHT_SWISS(group) *group = (struct LIGHT_SWISS(group) *)
+		matras_touch(&t->mtable, g);
+	if (group == NULL)
+		return -1;
+	assert(group->ctrl[i] < LIGHT_SWISS_CTRL_EMPTY);
+	if (light_swiss_match(group->ctrl, LIGHT_SWISS_CTRL_EMPTY) != 0) {
+		group->ctrl[i] = LIGHT_SWISS_CTRL_EMPTY;
+		t->used--;
+	} else {
+		group->ctrl[i] = LIGHT_SWISS_CTRL_DELETED;
+	}
+	t->count--;
+	return 0;
+}
+
+/**
+ * Move values of one group of the old table to the current one.
+ * The old table is left intact, the group is just skipped after
+ * migrate_pos is advanced.
+ * @return 0 on success, -1 on memory error.
+ */
+static inline int
+LIGHT_SWISS(migrate_group)(struct LIGHT_SWISS(core) *ht)
+{
+	struct LIGHT_SWISS(table) *old = ht->old_table;
+	const struct LIGHT_SWISS(group) *group =
+		(const struct LIGHT_SWISS(group) *)
+		matras_get(&old->mtable, ht->migrate_pos);
+	uint32_t moved[LIGHT_SWISS_GROUP_SIZE];
+	uint32_t moved_count = 0;
+	uint32_t match = light_swiss_match_full(group->ctrl);
+	while (match != 0) {
+		uint32_t i = __builtin_ctz(match);
+		match &= match - 1;
+		uint32_t slot = LIGHT_SWISS(table_insert)(ht->table,
+							  group->hash[i],
+							  group->value[i]);
+		if (slot == LIGHT_SWISS(end)) {
+			/*
+			 * Roll back. The groups were touched just
+			 * now, so clearing slots can't fail.
+			 */
+			while (moved_count > 0) {
+				int rc = LIGHT_SWISS(table_clear)(
+					ht->table, moved[--moved_count]);
+				assert(rc == 0);
+				(void)rc;
+			}
+			return -1;
+		}
+		moved[moved_count++] = slot;
+	}
+	old->count -= moved_count;
+	ht->migrate_pos++;
+	return 0;
+}
+
+/**
+ * Do a step of resizing: allocate a few groups of a new table or
+ * move a few groups of the old one to the current table. If the
+ * table is not being resized, check if it needs to be.
+ * Memory errors are ignored: the step is retried on next insertion.
+ */
+static inline void
+LIGHT_SWISS(resize_step)(struct LIGHT_SWISS(core) *ht)
+{
+	struct LIGHT_SWISS(table) *t = ht->table;
+	if (ht->old_table == NULL && ht->new_table == NULL) {
+		/* Max load factor is 7/8. */
+		uint64_t capacity = (uint64_t)t->group_count *
+				    LIGHT_SWISS_GROUP_SIZE;
+		if (((uint64_t)t->used + 1) * 8 <= capacity * 7)
+			return;
+		/*
+		 * Size the new table so that it is loaded by 7/16
+		 * after resize. If there are many tombstones, it may
+		 * be of the same size or even smaller.
+		 */
+		uint32_t need = (ht->count + 1 + 6) / 7;
+		uint32_t group_count = 1;
+		while (group_count < need &&
+		       group_count < LIGHT_SWISS_MAX_GROUP_COUNT)
+			group_count *= 2;
+		if (group_count == t->group_count && t->used == t->count)
+			return; /* Nothing to gain. */
+		ht->new_table = LIGHT_SWISS(table_new)(ht, group_count);
+		if (ht->new_table == NULL)
+			return;
+	}
+	if (ht->new_table != NULL) {
+		if (LIGHT_SWISS(table_alloc)(ht->new_table,
+					     LIGHT_SWISS_ALLOC_STEP) != 0)
+			return;
+		if (ht->new_table->alloc_count < ht->new_table->group_count)
+			return;
+		ht->old_table = ht->table;
+		ht->table = ht->new_table;
+		ht->new_table = NULL;
+		ht->migrate_pos = 0;
+	}
+	struct LIGHT_SWISS(table) *old = ht->old_table;
+	for (int i = 0; i < LIGHT_SWISS_MIGRATE_STEP; i++) {
+		if (old->count == 0)
+			break;
+		if (LIGHT_SWISS(migrate_group)(ht) != 0)
+			return;
+	}
+	if (old->count == 0) {
+		ht->old_table = NULL;
+		ht->migrate_pos = 0;
+		LIGHT_SWISS(table_release)(ht, old);
+	}
+}
+
+/**
+ * @brief Find a record with given hash and value
+ * @param ht - pointer to a hash table struct
+ * @param hash - hash to find
+ * @param data - value to find
+ * @return integer ID of found record or light_swiss_end if nothing found
+ */
+static inline uint32_t
+LIGHT_SWISS(find)(const struct LIGHT_SWISS(core) *ht, uint32_t hash,
+		  LIGHT_DATA_TYPE value)
+{
+	if (ht->count == 0)
+		return LIGHT_SWISS(end);
+	uint32_t slot = LIGHT_SWISS(table_find)(ht, ht->table, 0, hash, value);
+	if (slot != LIGHT_SWISS(end) || ht->old_table == NULL)
+		return slot;
+	slot = LIGHT_SWISS(table_find)(ht, ht->old_table, ht->migrate_pos,
+				       hash, value);
+	return slot == LIGHT_SWISS(end) ? slot : slot | LIGHT_SWISS_OLD_BIT;
+}
+
+/**
+ * @brief Find a record with given hash and key
+ * @param ht - pointer to a hash table struct
+ * @param hash - hash to find
+ * @param data - key to find
+ * @return integer ID of found record or light_swiss_end if nothing found
+ */
+static inline uint32_t
+LIGHT_SWISS(find_key)(const struct LIGHT_SWISS(core) *ht, uint32_t hash,
+		      LIGHT_KEY_TYPE key)
+{
+	if (ht->count == 0)
+		return LIGHT_SWISS(end);
+	uint32_t slot = LIGHT_SWISS(table_find_key)(ht, ht->table, 0,
+						    hash, key);
+	if (slot != LIGHT_SWISS(end) || ht->old_table == NULL)
+		return slot;
+	slot = LIGHT_SWISS(table_find_key)(ht, ht->old_table, ht->migrate_pos,
+					   hash, key);
+	return slot == LIGHT_SWISS(end) ? slot : slot | LIGHT_SWISS_OLD_BIT;
+}
+
+/**
+ * Table holding a record with given ID; the ID is stripped
+ * of LIGHT_SWISS_OLD_BIT.
+ */
+static inline struct LIGHT_SWISS(table) *
+LIGHT_SWISS(pos_table)(const struct LIGHT_SWISS(core) *ht, uint32_t *slotpos)
+{
+	if ((*slotpos & LIGHT_SWISS_OLD_BIT) == 0)
+		return ht->table;
+	*slotpos &= ~LIGHT_SWISS_OLD_BIT;
+	return ht->old_table;
+}
+
+/**
+ * @brief Insert a record with given hash and value
+ * @param ht - pointer to a hash table struct
+ * @param hash - hash to insert
+ * @param data - value to insert
+ * @return integer ID of inserted record or light_swiss_end if failed
+ */
+static inline uint32_t
+LIGHT_SWISS(insert)(struct LIGHT_SWISS(core) *ht, uint32_t hash,
+		    LIGHT_DATA_TYPE value)
+{
+	if (ht->table == NULL) {
+		struct LIGHT_SWISS(table) *t = LIGHT_SWISS(table_new)(ht, 1);
+		if (t == NULL)
+			return LIGHT_SWISS(end);
+		if (LIGHT_SWISS(table_alloc)(t, 1) != 0) {
+			LIGHT_SWISS(table_delete)(t);
+			return LIGHT_SWISS(end);
+		}
+		ht->table = t;
+	}
+	/*
+	 * Resize before inserting so that the returned ID stays
+	 * valid until the table is modified next time.
+	 */
+	LIGHT_SWISS(resize_step)(ht);
+	uint32_t slot = LIGHT_SWISS(table_insert)(ht->table, hash, value);
+	if (slot != LIGHT_SWISS(end))
+		ht->count++;
+	return slot;
+}
+
+/**
+ * @brief Replace a record with given hash and value
+ * @param ht - pointer to a hash table struct
+ * @param hash - hash to find
+ * @param data - value to find and replace
+ * @param replaced - pointer to a value that was stored in table before replace
+ * @return integer ID of found record or light_swiss_end if nothing found
+ */
+static inline uint32_t
+LIGHT_SWISS(replace)(struct LIGHT_SWISS(core) *ht, uint32_t hash,
+		     LIGHT_DATA_TYPE value, LIGHT_DATA_TYPE *replaced)
+{
+	uint32_t pos = LIGHT_SWISS(find)(ht, hash, value);
+	if (pos == LIGHT_SWISS(end))
+		return pos;
+	uint32_t slot = pos;
+	struct LIGHT_SWISS(table) *t = LIGHT_SWISS(pos_table)(ht, &slot);
+	struct LIGHT_SWISS(group) *group = (struct LIGHT_SWISS(group) *)
+		matras_touch(&t->mtable, slot / LIGHT_SWISS_GROUP_SIZE);
+	if (group == NULL)
+		return LIGHT_SWISS(end);
+	*replaced = group->value[slot % LIGHT_SWISS_GROUP_SIZE];
+	group->value[slot % LIGHT_SWISS_GROUP_SIZE] = value;
+	return pos;
+}
+
+/**
+ * @brief Delete a record from a hash table by given record ID
+ * @param ht - pointer to a hash table struct
+ * @param slotpos - ID of an record. See LIGHT_SWISS(find) for details.
+ * @return 0 if ok, -1 on memory error (only with freezed iterators)
+ */
+static inline int
+LIGHT_SWISS(delete)(struct LIGHT_SWISS(core) *ht, uint32_t slotpos)
+{
+	struct LIGHT_SWISS(table) *t = LIGHT_SWISS(pos_table)(ht, &slotpos);
+	if (LIGHT_SWISS(table_clear)(t, slotpos) != 0)
+		return -1;
+	ht->count--;
+	return 0;
+}
+
+/**
+ * @brief Delete a record from a hash table by that value and its hash.
+ * @param ht - pointer to a hash table struct
+ * @param slotpos - ID of an record. See LIGHT_SWISS(find) for details.
+ * @return 0 if ok, 1 if not found or -1 on memory error
+ * (only with freezed iterators)
+ */
+static inline int
+LIGHT_SWISS(delete_value)(struct LIGHT_SWISS(core) *ht,
+			  uint32_t hash, LIGHT_DATA_TYPE value)
+{
+	uint32_t slotpos = LIGHT_SWISS(find)(ht, hash, value);
+	if (slotpos == LIGHT_SWISS(end))
+		return 1;
+	return LIGHT_SWISS(delete)(ht, slotpos);
+}
+
+/**
+ * @brief Determine if posision holds a value
+ * @param ht - pointer to a hash table struct
+ * @param slotpos - ID of an record
+ */
+static inline bool
+LIGHT_SWISS(pos_valid)(struct LIGHT_SWISS(core) *ht, uint32_t slotpos)
+{
+	bool is_old = (slotpos & LIGHT_SWISS_OLD_BIT) != 0;
+	struct LIGHT_SWISS(table) *t = LIGHT_SWISS(pos_table)(ht, &slotpos);
+	if (t == NULL)
+		return false;
+	uint32_t g = slotpos / LIGHT_SWISS_GROUP_SIZE;
+	if (g >= t->group_count || (is_old && g < ht->migrate_pos))
+		return false;
+	const struct LIGHT_SWISS(group) *group =
+		(const struct LIGHT_SWISS(group) *)
+		matras_get(&t->mtable, g);
+	return group->ctrl[slotpos % LIGHT_SWISS_GROUP_SIZE] <
+	       LIGHT_SWISS_CTRL_EMPTY;
+}
+
+/**
+ * @brief Get a value from a desired position
+ * @param ht - pointer to a hash table struct
+ * @param slotpos - ID of an record
+ *  ID must be vaild, check it by light_swiss_pos_valid (asserted).
+ */
+static inline LIGHT_DATA_TYPE
+LIGHT_SWISS(get)(struct LIGHT_SWISS(core) *ht, uint32_t slotpos)
+{
+	assert(LIGHT_SWISS(pos_valid)(ht, slotpos));
+	struct LIGHT_SWISS(table) *t = LIGHT_SWISS(pos_table)(ht, &slotpos);
+	const struct LIGHT_SWISS(group) *group =
+		(const struct LIGHT_SWISS(group) *)
+		matras_get(&t->mtable, slotpos / LIGHT_SWISS_GROUP_SIZE);
+	return group->value[slotpos % LIGHT_SWISS_GROUP_SIZE];
+}
+
+/**
+ * @brief Find a record at a random position.
+ * @param ht - pointer to a hash table struct
+ * @param rnd - a random number
+ * @return integer ID of a record or light_swiss_end if the
+ * hash table is empty.
+ */
+static inline uint32_t
+LIGHT_SWISS(random)(const struct LIGHT_SWISS(core) *ht, uint32_t rnd)
+{
+	if (ht->count == 0)
+		return LIGHT_SWISS(end);
+	const struct LIGHT_SWISS(table) *t = ht->table;
+	uint32_t lo = 0;
+	uint32_t old_bit = 0;
+	if (ht->old_table != NULL &&
+	    rnd % ht->count < ht->old_table->count) {
+		t = ht->old_table;
+		lo = ht->migrate_pos;
+		old_bit = LIGHT_SWISS_OLD_BIT;
+	}
+	assert(t->count > 0);
+	uint32_t g = lo + rnd % (t->group_count - lo);
+	while (true) {
+		const struct LIGHT_SWISS(group) *group =
+			(const struct LIGHT_SWISS(group) *)
+			matras_get(&t->mtable, g);
+		uint32_t match = light_swiss_match_full(group->ctrl);
+		if (match != 0)
+			return (g * LIGHT_SWISS_GROUP_SIZE +
+				__builtin_ctz(match)) | old_bit;
+		g = LIGHT_SWISS(probe_next)(t, lo, g);
+	}
+}
+
+/**
+ * @brief Set iterator to the beginning of hash table
+ * @param ht - pointer to a hash table struct
+ * @param itr - iterator to set
+ */
+static inline void
+LIGHT_SWISS(iterator_begin)(const struct LIGHT_SWISS(core) *ht,
+			    struct LIGHT_SWISS(iterator) *itr)
+{
+	itr->frozen[0] = itr->frozen[1] = NULL;
+	itr->slotpos = 0;
+	if (ht->old_table != NULL)
+		itr->generation = ht->old_table->generation;
+	else if (ht->table != NULL)
+		itr->generation = ht->table->generation;
+	else
+		itr->generation = 0;
+}
+
+/**
+ * @brief Set iterator to position determined by key
+ * @param ht - pointer to a hash table struct
+ * @param itr - iterator to set
+ * @param hash - hash to find
+ * @param data - key to find
+ */
+static inline void
+LIGHT_SWISS(iterator_key)(const struct LIGHT_SWISS(core) *ht,
+			  struct LIGHT_SWISS(iterator) *itr,
+			  uint32_t hash, LIGHT_KEY_TYPE data)
+{
+	itr->frozen[0] = itr->frozen[1] = NULL;
+	uint32_t slotpos = LIGHT_SWISS(find_key)(ht, hash, data);
+	itr->slotpos = slotpos;
+	if (slotpos == LIGHT_SWISS(end))
+		return;
+	if ((slotpos & LIGHT_SWISS_OLD_BIT) != 0) {
+		itr->slotpos = slotpos & ~LIGHT_SWISS_OLD_BIT;
+		itr->generation = ht->old_table->generation;
+	} else {
+		itr->generation = ht->table->generation;
+	}
+}
+
+/**
+ * Find the first full slot starting from @a slot in a group
+ * of a table.
+ * @return slot number or light_swiss_end if there are no more
+ * full slots in the group.
+ */
+static inline uint32_t
+LIGHT_SWISS(group_next)(const struct LIGHT_SWISS(group) *group,
+			uint32_t slot)
+{
+	uint32_t i = slot % LIGHT_SWISS_GROUP_SIZE;
+	uint32_t match = light_swiss_match_full(group->ctrl) &
+			 ~((1u << i) - 1);
+	if (match == 0)
+		return LIGHT_SWISS(end);
+	return slot - i + __builtin_ctz(match);
+}
+
+/**
+ * Iteration step of a frozen iterator.
+ */
+static inline LIGHT_DATA_TYPE *
+LIGHT_SWISS(iterator_frozen_next)(struct LIGHT_SWISS(iterator) *itr)
+{
+	while (itr->slotpos != LIGHT_SWISS(end)) {
+		uint32_t old_bit = itr->slotpos & LIGHT_SWISS_OLD_BIT;
+		uint32_t slot = itr->slotpos & ~LIGHT_SWISS_OLD_BIT;
+		int k = old_bit != 0 ? 0 : 1;
+		const struct LIGHT_SWISS(table) *t = itr->frozen[k];
+		const struct matras_view *view = &itr->view[k];
+		uint32_t g = slot / LIGHT_SWISS_GROUP_SIZE;
+		if (g >= view->block_count) {
+			/* The old table is followed by the current one. */
+			itr->slotpos = k == 0 ? 0 : LIGHT_SWISS(end);
+			continue;
+		}
+		struct LIGHT_SWISS(group) *group = (struct LIGHT_SWISS(group) *)
+			matras_view_get(&t->mtable, view, g);
+		slot = LIGHT_SWISS(group_next)(group, slot);
+		if (slot == LIGHT_SWISS(end)) {
+			itr->slotpos = old_bit |
+				       (g + 1) * LIGHT_SWISS_GROUP_SIZE;
+			continue;
+		}
+		itr->slotpos = old_bit | (slot + 1);
+		return &group->value[slot % LIGHT_SWISS_GROUP_SIZE];
+	}
+	return NULL;
+}
+
+/**
+ * @brief Get the value that iterator currently points to
+ * @param ht - pointer to a hash table struct
+ * @param itr - iterator to set
+ * @return poiner to the value or NULL if iteration is complete
+ */
+static inline LIGHT_DATA_TYPE *
+LIGHT_SWISS(iterator_get_and_next)(const struct LIGHT_SWISS(core) *ht,
+				   struct LIGHT_SWISS(iterator) *itr)
+{
+	if (itr->frozen[1] != NULL)
+		return LIGHT_SWISS(iterator_frozen_next)(itr);
+	while (itr->slotpos != LIGHT_SWISS(end)) {
+		/*
+		 * The table may have been resized since the last
+		 * call: find the table by its generation.
+		 */
+		const struct LIGHT_SWISS(table) *t;
+		uint32_t lo = 0;
+		if (ht->old_table != NULL &&
+		    ht->old_table->generation == itr->generation) {
+			t = ht->old_table;
+			lo = ht->migrate_pos;
+		} else if (ht->table != NULL &&
+			   ht->table->generation == itr->generation) {
+			t = ht->table;
+		} else if (ht->table != NULL &&
+			   ht->table->generation > itr->generation) {
+			/* Values were moved to the current table. */
+			itr->generation = ht->table->generation;
+			itr->slotpos = 0;
+			continue;
+		} else {
+			break;
+		}
+		uint32_t slot = itr->slotpos;
+		uint32_t g = slot / LIGHT_SWISS_GROUP_SIZE;
+		if (g < lo) {
+			g = lo;
+			slot = g * LIGHT_SWISS_GROUP_SIZE;
+		}
+		if (g >= t->group_count) {
+			if (t == ht->table)
+				break;
+			/* The old table is followed by the current one. */
+			itr->generation = ht->table->generation;
+			itr->slotpos = 0;
+			continue;
+		}
+		struct LIGHT_SWISS(group) *group = (struct LIGHT_SWISS(group) *)
+			matras_get(&t->mtable, g);
+		slot = LIGHT_SWISS(group_next)(group, slot);
+		if (slot == LIGHT_SWISS(end)) {
+			itr->slotpos = (g + 1) * LIGHT_SWISS_GROUP_SIZE;
+			continue;
+		}
+		itr->slotpos = slot + 1;
+		return &group->value[slot % LIGHT_SWISS_GROUP_SIZE];
+	}
+	itr->slotpos = LIGHT_SWISS(end);
+	return NULL;
+}
+
+/**
+ * @brief Freezes state for given iterator. All following hash table modification
+ * will not apply to that iterator iteration. That iterator should be destroyed
+ * with a light_swiss_iterator_destroy call after usage. The iteration
+ * is restarted from the beginning.
+ * @param ht - pointer to a hash table struct
+ * @param itr - iterator to freeze
+ */
+static inline void
+LIGHT_SWISS(iterator_freeze)(struct LIGHT_SWISS(core) *ht,
+			     struct LIGHT_SWISS(iterator) *itr)
+{
+	assert(itr->frozen[1] == NULL);
+	itr->frozen[0] = ht->old_table;
+	itr->frozen[1] = ht->table;
+	if (ht->table == NULL) {
+		/* Nothing to iterate. */
+		itr->slotpos = LIGHT_SWISS(end);
+		return;
+	}
+	for (int k = 0; k < 2; k++) {
+		struct LIGHT_SWISS(table) *t = itr->frozen[k];
+		if (t == NULL)
+			continue;
+		matras_create_read_view(&t->mtable, &itr->view[k]);
+		t->view_count++;
+	}
+	itr->migrate_pos = ht->migrate_pos;
+	if (ht->old_table != NULL)
+		itr->slotpos = LIGHT_SWISS_OLD_BIT |
+			       ht->migrate_pos * LIGHT_SWISS_GROUP_SIZE;
+	else
+		itr->slotpos = 0;
+}
+
+/**
+ * @brief Destroy an iterator that was frozen before. Useless for not frozen
+ * iterators.
+ * @param ht - pointer to a hash table struct
+ * @param itr - iterator to destroy
+ */
+static inline void
+LIGHT_SWISS(iterator_destroy)(struct LIGHT_SWISS(core) *ht,
+			      struct LIGHT_SWISS(iterator) *itr)
+{
+	for (int k = 0; k < 2; k++) {
+		struct LIGHT_SWISS(table) *t = itr->frozen[k];
+		if (t == NULL)
+			continue;
+		if (itr->frozen[1] != NULL) {
+			matras_destroy_read_view(&t->mtable, &itr->view[k]);
+			t->view_count--;
+		}
+		itr->frozen[k] = NULL;
+	}
+	/* Free retired tables nobody looks at anymore. */
+	struct LIGHT_SWISS(table) **prev = &ht->retired;
+	while (*prev != NULL) {
+		struct LIGHT_SWISS(table) *t = *prev;
+		if (t->view_count == 0) {
+			*prev = t->next_retired;
+			LIGHT_SWISS(table_delete)(t);
+		} else {
+			prev = &t->next_retired;
+		}
+	}
+}
+
+/*
+ * Selfcheck of the internal state of hash table. Used only for debugging.
+ * That means that you should not use this function.
+ * If return not zero, something went terribly wrong.
+ */
+static inline int
+LIGHT_SWISS(selfcheck)(const struct LIGHT_SWISS(core) *ht)
+{
+	int res = 0;
+	uint32_t total = 0;
+	for (int k = 0; k < 2; k++) {
+		const struct LIGHT_SWISS(table) *t =
+			k == 0 ? ht->table : ht->old_table;
+		uint32_t lo = k == 0 ? 0 : ht->migrate_pos;
+		if (t == NULL)
+			continue;
+		uint32_t count = 0, used = 0;
+		for (uint32_t g = 0; g < t->group_count; g++) {
+			const struct LIGHT_SWISS(group) *group =
+				(const struct LIGHT_SWISS(group) *)
+				matras_get(&t->mtable, g);
+			for (uint32_t i = 0; i < LIGHT_SWISS_GROUP_SIZE; i++) {
+				uint8_t c = group->ctrl[i];
+				if (c == LIGHT_SWISS_CTRL_EMPTY)
+					continue;
+				used++;
+				if (c == LIGHT_SWISS_CTRL_DELETED)
+					continue;
+				if (c >= LIGHT_SWISS_CTRL_EMPTY)
+					res |= 1; /* invalid control byte */
+				if (c != light_swiss_tag(group->hash[i]))
+					res |= 2; /* tag mismatch */
+				if (g < lo)
+					continue;
+				count++;
+				uint32_t slot = g * LIGHT_SWISS_GROUP_SIZE + i;
+				if (LIGHT_SWISS(table_find)(ht, t, lo,
+						group->hash[i],
+						group->value[i]) != slot)
+					res |= 4; /* value is unreachable */
+			}
+		}
+		if (count != t->count)
+			res |= 8; /* wrong count */
+		if (used != t->used)
+			res |= 16; /* wrong number of used slots */
+		total += count;
+	}
+	if (total != ht->count)
+		res |= 32; /* wrong total count */
+	return res;
+}
@@ -29,6 +29,8 @@
  * SUCH DAMAGE.
  */
 #include "rtree.h"
+#include "third_party/qsort_arg.h"
+#include <stdlib.h>
 #include <string.h>
 #include <assert.h>
 #include <limits.h>
@@ -951,6 +953,10 @@ rtree_init(struct rtree *tree, unsigned dimension, uint32_t extent_size,
 	tree->version = 0;
 	tree->n_pages = 0;
 	tree->free_pages = 0;
+	tree->build_buf = NULL;
+	tree->build_size = 0;
+	tree->build_capacity = 0;
+	tree->build_pages = 0;
 
 	tree->dimension = dimension;
 	tree->distance_type = distance_type;
@@ -978,6 +984,7 @@ void
 rtree_destroy(struct rtree *tree)
 {
 	rtree_purge(tree);
+	free(tree->build_buf);
 	matras_destroy(&tree->mtab);
 }
 
@@ -1149,6 +1156,204 @@ rtree_number_of_records(const struct rtree *tree) {
 	return tree->n_records;
 }
 
+/*------------------------------------------------------------------------- */
+/* R-tree bulk loading */
+/*------------------------------------------------------------------------- */
+
+int
+rtree_build_reserve(struct rtree *tree, size_t count)
+{
+	if (count <= tree->build_capacity)
+		return 0;
+	char *buf = (char *)realloc(tree->build_buf,
+				    count * tree->page_branch_size);
+	if (buf == NULL)
+		return -1;
+	tree->build_buf = buf;
+	tree->build_capacity = count;
+	return 0;
+}
+
+/**
+ * Return the number of pages rtree_build_end() allocates to
+ * pack @a count records, see rtree_build_level().
+ */
+static size_t
+rtree_build_page_count(const struct rtree *tree, size_t count)
+{
+	if (count == 0)
+		return 0;
+	size_t total = 1; /* root */
+	size_t n = count;
+	while (n > tree->page_max_fill) {
+		n = (n + tree->page_max_fill - 1) / tree->page_max_fill;
+		total += n;
+	}
+	return total;
+}
+
+int
+rtree_build_reserve_pages(struct rtree *tree, size_t count)
+{
+	size_t n_pages = rtree_build_page_count(tree, count);
+	while (tree->build_pages < n_pages) {
+		uint32_t unused_id;
+		struct rtree_page *page = (struct rtree_page *)
+			matras_alloc(&tree->mtab, &unused_id);
+		if (page == NULL)
+			return -1;
+		/* rtree_page_alloc() takes free pages first */
+		rtree_page_free(tree, page);
+		tree->build_pages++;
+	}
+	return 0;
+}
+
+int
+rtree_build_next(struct rtree *tree, const struct rtree_rect *rect,
+		 record_t obj)
+{
+	assert(tree->root == NULL);
+	if (tree->build_size == tree->build_capacity) {
+		size_t capacity = tree->build_capacity > 0 ?
+				  tree->build_capacity * 2 :
+				  RTREE_MAXIMUM_BRANCHES_IN_PAGE;
+		if (rtree_build_reserve(tree, capacity) != 0)
+			return -1;
+	}
+	if (rtree_build_reserve_pages(tree, tree->build_size + 1) != 0)
+		return -1;
+	struct rtree_page_branch *b = (struct rtree_page_branch *)
+		(tree->build_buf + tree->build_size++ * tree->page_branch_size);
+	b->data.record = obj;
+	rtree_rect_copy(&b->rect, rect, tree->dimension);
+	return 0;
+}
+
+static int
+rtree_branch_center_cmp(const void *a, const void *b, void *arg)
+{
+	unsigned axis = *(unsigned *)arg;
+	const struct rtree_page_branch *b1 =
+		(const struct rtree_page_branch *)a;
+	const struct rtree_page_branch *b2 =
+		(const struct rtree_page_branch *)b;
+	/* Compare doubled centers to avoid division */
+	coord_t c1 = b1->rect.coords[axis * 2] + b1->rect.coords[axis * 2 + 1];
+	coord_t c2 = b2->rect.coords[axis * 2] + b2->rect.coords[axis * 2 + 1];
+	return c1 < c2 ? -1 : c1 > c2;
+}
+
+/**
+ * Return the smallest s such that s ^ k >= n.
+ */
+static size_t
+rtree_build_slab_count(size_t n, unsigned k)
+{
+	size_t s = 1;
+	while (true) {
+		size_t p = 1;
+		for (unsigned i = 0; i < k && p < n; i++)
+			p *= s;
+		if (p >= n)
+			return s;
+		s++;
+	}
+}
+
+/**
+ * Sort-Tile-Recursive ordering of @a n branches that are going
+ * to be packed into @a n_pages pages: sort by the center along
+ * @a axis, cut into slabs of whole pages and order every slab
+ * by the remaining axes.
+ */
+static void
+rtree_build_sort(struct rtree *tree, char *branches, size_t n,
+		 size_t n_pages, unsigned axis)
+{
+	qsort_arg(branches, n, tree->page_branch_size,
+		  rtree_branch_center_cmp, &axis);
+	if (axis + 1 == tree->dimension || n_pages <= 1)
+		return;
+	size_t n_slabs = rtree_build_slab_count(n_pages,
+						tree->dimension - axis);
+	size_t slab_pages = (n_pages + n_slabs - 1) / n_slabs;
+	size_t slab_size = slab_pages * tree->page_max_fill;
+	for (size_t i = 0; i < n; i += slab_size) {
+		size_t size = n - i < slab_size ? n - i : slab_size;
+		size_t pages = (size + tree->page_max_fill - 1) /
+			       tree->page_max_fill;
+		rtree_build_sort(tree, branches + i * tree->page_branch_size,
+				 size, pages, axis + 1);
+	}
+}
+
+/**
+ * Pack @a n sorted branches into pages of the next tree level.
+ * Branches pointing to the new pages are stored in place at
+ * the beginning of the array. Return the number of pages.
+ */
+static size_t
+rtree_build_level(struct rtree *tree, char *branches, size_t n)
+{
+	const unsigned max_fill = tree->page_max_fill;
+	size_t n_pages = (n + max_fill - 1) / max_fill;
+	size_t pos = 0;
+	for (size_t i = 0; i < n_pages; i++) {
+		size_t count = n - pos < max_fill ? n - pos : max_fill;
+		if (i + 2 == n_pages &&
+		    n - pos - max_fill < tree->page_min_fill) {
+			/* Don't leave the last page underfilled */
+			count = (n - pos) / 2;
+		}
+		/* Reserved by rtree_build_reserve_pages() */
+		struct rtree_page *page = rtree_page_alloc(tree);
+		assert(page != NULL);
+		tree->n_pages++;
+		page->n = count;
+		memcpy(page->data, branches + pos * tree->page_branch_size,
+		       count * tree->page_branch_size);
+		pos += count;
+		/* i <= pos, so nothing unread is overwritten */
+		struct rtree_page_branch *b = (struct rtree_page_branch *)
+			(branches + i * tree->page_branch_size);
+		b->data.page = page;
+		rtree_page_cover(tree, page, &b->rect);
+	}
+	assert(pos == n);
+	return n_pages;
+}
+
+void
+rtree_build_end(struct rtree *tree)
+{
+	assert(tree->root == NULL);
+	size_t n = tree->build_size;
+	if (n > 0) {
+		tree->n_records = n;
+		while (n > tree->page_max_fill) {
+			size_t n_pages = (n + tree->page_max_fill - 1) /
+					 tree->page_max_fill;
+			rtree_build_sort(tree, tree->build_buf, n, n_pages, 0);
+			n = rtree_build_level(tree, tree->build_buf, n);
+			tree->height++;
+		}
+		tree->root = rtree_page_alloc(tree);
+		assert(tree->root != NULL);
+		tree->n_pages++;
+		tree->root->n = n;
+		memcpy(tree->root->data, tree->build_buf,
+		       n * tree->page_branch_size);
+		tree->height++;
+		tree->version++;
+	}
+	free(tree->build_buf);
+	tree->build_buf = NULL;
+	tree->build_size = 0;
+	tree->build_capacity = 0;
+	tree->build_pages = 0;
+}
+
 #if 0
 #include <stdio.h>
 void
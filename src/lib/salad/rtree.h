@@ -152,6 +152,14 @@ struct rtree
 	void *free_pages;
 	/* Distance type */
 	enum rtree_distance_type distance_type;
+	/* Branches accumulated for bulk loading, see rtree_build_next() */
+	char *build_buf;
+	/* Number of branches in build_buf */
+	size_t build_size;
+	/* Number of branches build_buf can hold */
+	size_t build_capacity;
+	/* Number of free pages reserved for rtree_build_end() */
+	size_t build_pages;
 };
 
 /* Struct for iteration and retrieving rtree values */
@@ -285,6 +293,49 @@ rtree_insert(struct rtree *tree, struct rtree_rect *rect, record_t obj);
 bool
 rtree_remove(struct rtree *tree, const struct rtree_rect *rect, record_t obj);
 
+/**
+ * @brief Reserve memory for bulk loading of @a count records
+ * @return 0 on success, -1 on memory allocation error
+ * @param tree - pointer to a tree
+ * @param count - expected number of records
+ */
+int
+rtree_build_reserve(struct rtree *tree, size_t count);
+
+/**
+ * @brief Reserve pages rtree_build_end() needs to pack @a count
+ * records, so that it cannot fail. rtree_build_next() calls this
+ * function for the records added so far.
+ * @return 0 on success, -1 on page allocation error
+ * @param tree - pointer to a tree
+ * @param count - expected number of records
+ */
+int
+rtree_build_reserve_pages(struct rtree *tree, size_t count);
+
+/**
+ * @brief Add a record for bulk loading. The tree must be empty.
+ * Records are not visible until rtree_build_end() is called.
+ * @return 0 on success, -1 on memory allocation error, in which
+ * case the record isn't added
+ * @param tree - pointer to a tree
+ * @param rect - rectangle of the record
+ * @param obj - record to add
+ */
+int
+rtree_build_next(struct rtree *tree, const struct rtree_rect *rect,
+		 record_t obj);
+
+/**
+ * @brief Build the tree from records added with rtree_build_next()
+ * Records are packed with Sort-Tile-Recursive algorithm, which is
+ * much faster than inserting them one by one and yields nearly
+ * full pages with little overlap.
+ * @param tree - pointer to a tree
+ */
+void
+rtree_build_end(struct rtree *tree);
+
 /**
  * @brief Size of memory used by tree
  * @param tree - pointer to a tree
@@ -47,6 +47,14 @@
  */
 #cmakedefine HAVE_CPUID 1
 
+/*
+ * Defined if the code may use SSE2, AVX or AVX2 instructions
+ * (see cmake/simd.cmake).
+ */
+#cmakedefine ENABLE_SSE2 1
+#cmakedefine ENABLE_AVX 1
+#cmakedefine ENABLE_AVX2 1
+
 /*
  * Defined if gcov instrumentation should be enabled.
  */
@@ -169,6 +177,7 @@
 #cmakedefine HAVE_FALLOCATE 1
 #cmakedefine HAVE_MREMAP 1
 #cmakedefine HAVE_SYNC_FILE_RANGE 1
+#cmakedefine HAVE_IO_URING 1
 
 #cmakedefine HAVE_PRCTL_H 1
 
@@ -6,7 +6,7 @@ local socket = require('socket')
 local fio = require('fio')
 local uuid = require('uuid')
 local msgpack = require('msgpack')
-test:plan(102)
+test:plan(113)
 
 --------------------------------------------------------------------------------
 -- Invalid values
@@ -25,6 +25,17 @@ invalid('memtx_min_tuple_size', 0)
 invalid('memtx_min_tuple_size', -1)
 invalid('memtx_min_tuple_size', 1048281)
 invalid('memtx_min_tuple_size', 1000000000)
+invalid('memtx_snap_threads', 0)
+invalid('memtx_snap_threads', 65)
+invalid('memtx_defrag_threshold', -0.1)
+invalid('memtx_defrag_threshold', 1.5)
+invalid('memtx_huge_pages', '3M')
+invalid('memtx_numa_policy', 'local')
+invalid('memtx_numa_nodes', '1-0')
+invalid('memtx_numa_nodes', '64')
+invalid('net_read_threads', -1)
+invalid('net_read_threads', 65)
+invalid('net_read_view_period', 0)
 invalid('replication', '//guest@localhost:3301')
 invalid('replication_timeout', -1)
 invalid('replication_timeout', 0)
@@ -0,0 +1,48 @@
+test_run = require('test_run').new()
+--
+-- Secondary keys of arbitrary part types are compared with
+-- comparators composed of the part types.
+--
+s = box.schema.space.create('test')
+_ = s:create_index('pk')
+sk = s:create_index('sk', {parts = {2, 'integer', 3, 'number'}, unique = false})
+s:insert{1, 5, 1.5}
+s:insert{2, -3, 2}
+s:insert{3, 5, -1}
+s:insert{4, -3, 0.5}
+s:insert{5, 0, 7}
+sk:select()
+sk:select({5})
+sk:select({-3, 1}, {iterator = 'GE'})
+sk:select({5, 0}, {iterator = 'LT'})
+s:drop()
+--
+-- Nullable parts and collations.
+--
+s = box.schema.space.create('test')
+_ = s:create_index('pk')
+sk = s:create_index('sk', {parts = {{2, 'integer', is_nullable = true}, {3, 'string', collation = 'unicode_ci'}}})
+s:insert{1, box.NULL, 'a'}
+s:insert{2, 10, 'B'}
+s:insert{3, box.NULL, 'a'}
+s:insert{4, 10, 'a'}
+s:insert{5, -1, 'c'}
+s:insert{6, 10, 'b'}
+sk:select()
+sk:select({10})
+sk:select({box.NULL})
+sk:get({10, 'b'})
+s:drop()
+--
+-- Hash keys with integer and boolean parts.
+--
+s = box.schema.space.create('test')
+_ = s:create_index('pk', {type = 'hash', parts = {1, 'integer', 2, 'boolean'}})
+_ = s:create_index('sk', {type = 'hash', parts = {3, 'integer'}})
+s:insert{-1, true, -10}
+s:insert{-1, false, 20}
+s:insert{2, true, 30}
+s:get{-1, false}
+s:get{2, false}
+s.index.sk:get{-10}
+s:drop()
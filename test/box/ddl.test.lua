@@ -270,3 +270,93 @@ box.rollback()
 
 _ = c:get()
 test_latch:drop() -- this is where everything stops
+
+--
+-- Memtx index build yields periodically. Changes made to the
+-- space meanwhile must get to all indexes built by the ALTER.
+--
+s = box.schema.space.create('test_build')
+_ = s:create_index('pk')
+box.begin() for i = 1, 5000 do s:replace{i, i, i} end box.commit()
+mirror = {}
+for i = 1, 5000 do mirror[i] = i end
+ch = fiber.channel(1)
+done = false
+test_run:cmd("setopt delimiter ';'")
+function dml()
+    while not done do
+        local k = math.random(6000)
+        local op = math.random(4)
+        if op == 1 then
+            s:replace{k, k % 100, k}
+            mirror[k] = k % 100
+        elseif op == 2 then
+            s:delete{k}
+            mirror[k] = nil
+        elseif op == 3 then
+            box.begin() s:replace{k, -k, k} box.rollback()
+        else
+            box.begin() s:delete{k} box.rollback()
+        end
+        fiber.sleep(0)
+    end
+    ch:put(true)
+end;
+function check(index, part)
+    local expected = {}
+    for k, v in pairs(mirror) do
+        table.insert(expected, {k, v})
+    end
+    table.sort(expected, function(a, b)
+        if a[part] ~= b[part] then return a[part] < b[part] end
+        return a[1] < b[1]
+    end)
+    local actual = index:select()
+    if #actual ~= #expected then return false end
+    for i = 1, #actual do
+        if actual[i][1] ~= expected[i][1] or
+           actual[i][2] ~= expected[i][2] then
+            return false
+        end
+    end
+    return true
+end;
+test_run:cmd("setopt delimiter ''");
+_ = fiber.create(dml)
+sk = s:create_index('sk', {parts = {2, 'integer'}, unique = false})
+done = true
+ch:get()
+check(s.index.pk, 1)
+check(sk, 2)
+-- Rebuild both the primary and the secondary index.
+done = false
+_ = fiber.create(dml)
+s.index.pk:alter{parts = {3, 'unsigned'}}
+done = true
+ch:get()
+check(s.index.pk, 1)
+check(sk, 2)
+s:drop()
+
+-- A concurrent change that violates the new index constraints
+-- makes the build fail.
+s = box.schema.space.create('test_build')
+_ = s:create_index('pk')
+box.begin() for i = 1, 5000 do s:replace{i, i} end box.commit()
+_ = fiber.create(function() fiber.sleep(0) s:replace{2, 3} end) s:create_index('uk', {parts = {2, 'unsigned'}})
+s.index.uk
+s:get{2}
+s:drop()
+
+-- A change rolled back by a failed on_replace trigger must not
+-- affect the index being built.
+s = box.schema.space.create('test_build')
+_ = s:create_index('pk')
+box.begin() for i = 1, 5000 do s:replace{i, i} end box.commit()
+_ = s:on_replace(function(old, new) if new ~= nil and new[2] < 0 then error('fail') end end)
+_ = fiber.create(function() for i = 1, 5000, 10 do pcall(s.replace, s, {i, -i}) fiber.sleep(0) end ch:put(true) end) sk = s:create_index('sk', {parts = {2, 'integer'}})
+ch:get()
+sk:count()
+sk:min()
+sk:max()
+s:drop()
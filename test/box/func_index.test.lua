@@ -0,0 +1,103 @@
+test_run = require('test_run').new()
+--
+-- Functional indexes.
+--
+box.schema.func.create('lower', {body = 'function(tuple) return {tuple[2]:lower()} end', is_deterministic = true})
+box.schema.func.create('third', {body = 'function(tuple) return tuple[3] end', is_deterministic = true})
+box.schema.func.create('nondet', {body = 'function(tuple) return {tuple[2]} end'})
+box.schema.func.create('noop')
+s = box.schema.space.create('withdata')
+-- Primary key can't be functional.
+s:create_index('pk', {func = 'lower', parts = {{1, 'string'}}})
+pk = s:create_index('pk')
+-- Only TREE and HASH indexes can be functional.
+s:create_index('idx', {type = 'bitset', func = 'lower', parts = {{1, 'string'}}})
+-- The function must be persistent and deterministic.
+s:create_index('idx', {func = 'unknown', parts = {{1, 'string'}}})
+s:create_index('idx', {func = 'nondet', parts = {{1, 'string'}}})
+s:create_index('idx', {func = 'noop', parts = {{1, 'string'}}})
+idx = s:create_index('idx', {func = 'lower', parts = {{1, 'string'}}})
+idx.func_id == box.space._func.index.name:get{'lower'}[1]
+s:insert{1, 'Foo'}
+s:insert{2, 'bar'}
+s:insert{3, 'FOO'}
+s:insert{3, 'Baz'}
+idx:select()
+idx:get{'foo'}
+idx:select({'c'}, {iterator = 'LT'})
+s:replace{1, 'Qux'}
+idx:get{'foo'}
+idx:get{'qux'}
+s:delete{2}
+idx:select()
+-- Changes are rolled back using stored keys.
+box.begin() s:replace{1, 'Foo'} s:delete{3} s:insert{6, 'Six'} box.rollback()
+idx:select()
+-- Keys are stored in memtx memory and counted in the index size.
+bsize = idx:bsize()
+_ = s:insert{7, string.rep('x', 10000)}
+idx:bsize() - bsize >= 10000
+_ = s:delete{7}
+idx:bsize() - bsize < 10000
+-- HASH index can be functional too.
+hidx = s:create_index('hidx', {type = 'hash', func = 'lower', parts = {{1, 'string'}}})
+hidx:get{'qux'}
+hidx:get{'baz'}
+box.begin() s:replace{3, 'Quux'} box.rollback()
+hidx:get{'baz'}
+hidx:get{'quux'}
+s:replace{3, 'Quux'}
+hidx:get{'quux'}
+hidx:get{'baz'}
+s:replace{3, 'Baz'}
+hidx:count()
+-- The function result is validated against the index parts.
+s:create_index('third', {func = 'third', unique = false, parts = {{1, 'unsigned'}}})
+third = s:create_index('third', {func = 'third', unique = false, parts = {{1, 'unsigned', is_nullable = true}}})
+s:insert{4, 'abc', 10}
+s:insert{5, 'def', 'x'}
+third:select()
+third:select{10}
+-- A function can't be dropped or altered while it is in use.
+ok, e = pcall(box.schema.func.drop, 'lower')
+ok, tostring(e):match('function is used by a functional index')
+box.space._func.index.name:update('lower', {{'=', 6, 'function(tuple) return {tuple[2]} end'}})
+-- Keys are computed anew on recovery.
+test_run:cmd('restart server default')
+s = box.space.withdata
+idx = s.index.idx
+idx:select()
+s.index.third:select{10}
+s.index.hidx:get{'baz'}
+s:drop()
+-- Vinyl supports functional indexes.
+test_run = require('test_run').new()
+s = box.schema.space.create('withdata', {engine = 'vinyl'})
+pk = s:create_index('pk')
+s:insert{1, 'Foo'}
+s:insert{2, 'bar'}
+idx = s:create_index('idx', {func = 'lower', parts = {{1, 'string'}}})
+s:insert{3, 'FOO'}
+s:insert{3, 'Baz'}
+idx:select()
+idx:get{'foo'}
+s:replace{1, 'Qux'}
+idx:get{'foo'}
+idx:get{'qux'}
+s:update(2, {{'=', 2, 'Bar2'}})
+_ = s:delete{3}
+idx:select()
+box.begin() s:replace{1, 'Foo'} s:delete{2} box.rollback()
+idx:select()
+box.snapshot()
+s:replace{4, 'Four'}
+idx:select({'c'}, {iterator = 'GE'})
+test_run:cmd('restart server default')
+s = box.space.withdata
+s.index.idx:select()
+s.index.idx:get{'four'}
+s:drop()
+box.schema.func.drop('lower')
+box.schema.func.drop('third')
+box.schema.func.drop('nondet')
+box.schema.func.drop('noop')
@@ -0,0 +1,40 @@
+test_run = require('test_run').new()
+--
+-- Open addressing layout of HASH indexes.
+--
+s = box.schema.space.create('test')
+s:create_index('pk', {type = 'hash', layout = 'linear'})
+pk = s:create_index('pk', {type = 'hash', layout = 'open'})
+sk = s:create_index('sk', {type = 'hash', layout = 'open', parts = {2, 'unsigned'}})
+box.space._index:get{s.id, 0}[5].layout
+-- Insert enough tuples to resize the table several times.
+for i = 1, 10000 do s:insert{i, i * 2} end
+s:count()
+sk:count()
+pk:get{5000}
+sk:get{5000}
+s:insert{1, 3}
+s:insert{10001, 2}
+s:replace{1, 3}
+sk:get{2}
+sk:get{3}
+for i = 1, 10000, 2 do s:delete{i} end
+s:count()
+pk:get{1}
+sk:select{4}
+pk:select({9998}, {iterator = 'EQ'})
+#pk:select({}, {iterator = 'ALL'})
+pk:random(123)[1] % 2
+pk:bsize() > 0
+-- Snapshot and recovery.
+box.snapshot()
+test_run:cmd('restart server default')
+s = box.space.test
+s.index.pk:count()
+s.index.sk:get{8}
+-- Changing the layout rebuilds the index.
+s.index.sk:alter({layout = 'chained'})
+box.space._index:get{s.id, 1}[5].layout
+s.index.sk:count()
+s.index.sk:get{8}
+s:drop()
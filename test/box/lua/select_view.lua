@@ -0,0 +1,9 @@
+#!/usr/bin/env tarantool
+
+box.cfg{
+    listen = os.getenv('LISTEN'),
+    net_read_threads = 2,
+    net_read_view_period = 0.01,
+}
+
+require('console').listen(os.getenv('ADMIN'))
@@ -0,0 +1,53 @@
+test_run = require('test_run').new()
+s = box.schema.space.create('test')
+_ = s:create_index('pk')
+_ = s:create_index('sk', {parts = {2, 'unsigned'}})
+_ = s:create_index('bitset', {type = 'bitset', parts = {3, 'unsigned'}, unique = false})
+pad = string.rep('x', 100)
+box.begin() for i = 1, 20000 do s:insert{i, 20000 - i, i % 4, pad} end box.commit()
+--
+-- Delete most tuples so that each slab is left mostly empty.
+--
+box.begin() for i = 1, 20000 do if i % 10 ~= 0 then s:delete{i} end end box.commit()
+collectgarbage('collect')
+size = box.slab.info().items_size
+box.cfg{memtx_defrag_threshold = 2}
+box.cfg{memtx_defrag_threshold = 0.5}
+--
+-- Remaining tuples are moved to a few dense slabs and the
+-- emptied slabs are given back.
+--
+test_run:wait_cond(function() return box.slab.info().items_size < size - 1024 * 1024 end)
+box.cfg{memtx_defrag_threshold = 0}
+--
+-- All indexes point to the new copies.
+--
+s:count()
+s.index.sk:count()
+s.index.bitset:count(2)
+s:get(10)[2]
+s.index.sk:get(19990)[1]
+ok = true
+for _, t in s:pairs() do if s.index.sk:get(t[2])[1] ~= t[1] or t[4] ~= pad then ok = false end end
+ok
+s:drop()
+--
+-- Spaces with functional indexes are skipped: moving a tuple
+-- would call the function to compute the keys of the copy.
+--
+box.schema.func.create('second', {body = 'function(tuple) return {tuple[2]} end', is_deterministic = true})
+s = box.schema.space.create('test')
+_ = s:create_index('pk')
+_ = s:create_index('fk', {func = 'second', parts = {{1, 'unsigned'}}})
+box.begin() for i = 1, 20000 do s:insert{i, 20000 - i, pad} end box.commit()
+box.begin() for i = 1, 20000 do if i % 10 ~= 0 then s:delete{i} end end box.commit()
+collectgarbage('collect')
+size = box.slab.info().items_size
+box.cfg{memtx_defrag_threshold = 0.5}
+fiber = require('fiber')
+fiber.sleep(0.5)
+box.cfg{memtx_defrag_threshold = 0}
+box.slab.info().items_size == size
+s.index.fk:get(19990)[1]
+s:drop()
+box.schema.func.drop('second')
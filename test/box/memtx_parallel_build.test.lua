@@ -0,0 +1,67 @@
+test_run = require('test_run').new()
+--
+-- Secondary keys are sorted in parallel on recovery. Check that
+-- indexes big enough to be sorted in a coio thread are recovered
+-- properly, including those that have to be sorted in the tx
+-- thread (collation) and those with JSON path parts.
+--
+s = box.schema.space.create('test')
+_ = s:create_index('pk')
+_ = s:create_index('i1', {parts = {2, 'unsigned'}})
+_ = s:create_index('i2', {parts = {3, 'string'}, unique = false})
+_ = s:create_index('i3', {parts = {{3, 'string', collation = 'unicode_ci'}}, unique = false})
+_ = s:create_index('i4', {parts = {{4, 'unsigned', path = 'a'}}})
+N = 100000
+test_run:cmd("setopt delimiter ';'")
+box.begin()
+for i = 1, N do
+    local k = i * 7919 % N
+    local c = i % 2 == 0 and 'k' or 'K'
+    s:replace{i, k, c .. (N - k), {a = N - i}}
+    if i % 1000 == 0 then
+        box.commit()
+        box.begin()
+    end
+end
+box.commit();
+function check(index, key)
+    local prev
+    local count = 0
+    for _, t in index:pairs() do
+        local k = key(t)
+        if prev ~= nil and k < prev then
+            return {t, prev}
+        end
+        prev = k
+        count = count + 1
+    end
+    return count
+end;
+test_run:cmd("setopt delimiter ''");
+check(s.index.i1, function(t) return t[2] end)
+check(s.index.i2, function(t) return t[3] end)
+check(s.index.i3, function(t) return t[3]:lower() end)
+check(s.index.i4, function(t) return t[4].a end)
+box.snapshot()
+test_run:cmd('restart server default')
+s = box.space.test
+test_run:cmd("setopt delimiter ';'")
+function check(index, key)
+    local prev
+    local count = 0
+    for _, t in index:pairs() do
+        local k = key(t)
+        if prev ~= nil and k < prev then
+            return {t, prev}
+        end
+        prev = k
+        count = count + 1
+    end
+    return count
+end;
+test_run:cmd("setopt delimiter ''");
+check(s.index.i1, function(t) return t[2] end)
+check(s.index.i2, function(t) return t[3] end)
+check(s.index.i3, function(t) return t[3]:lower() end)
+check(s.index.i4, function(t) return t[4].a end)
+s:drop()
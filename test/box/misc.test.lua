@@ -92,11 +92,15 @@ t;
 string.match(tostring(box.slab.info()), '^table:') ~= nil;
 box.slab.info().arena_used >= 0;
 box.slab.info().arena_size > 0;
+box.slab.info().arena_page_size > 0;
+box.slab.info().arena_huge_pages;
+box.slab.info().arena_numa_policy;
 string.match(tostring(box.slab.stats()), '^table:') ~= nil;
 t = {};
 for k, v in pairs(box.slab.info()) do
     table.insert(t, k)
 end;
+table.sort(t);
 t;
 box.runtime.info().used > 0;
 box.runtime.info().maxalloc > 0;
@@ -0,0 +1,64 @@
+test_run = require('test_run').new()
+
+--
+-- Multikey indexes.
+--
+s = box.schema.space.create('withdata')
+-- Primary key can't be multikey.
+s:create_index('pk', {parts = {{2, 'str', path = '[*]'}}})
+pk = s:create_index('pk')
+-- Only TREE index can be multikey.
+s:create_index('idx', {type = 'hash', parts = {{2, 'str', path = '[*]'}}})
+-- Only one [*] is allowed in a path.
+s:create_index('idx', {parts = {{2, 'str', path = '[*][*]'}}})
+-- All multikey parts must refer to the same array.
+s:create_index('idx', {parts = {{2, 'str', path = '[*][1]'}, {3, 'str', path = '[*][1]'}}})
+s:create_index('idx', {parts = {{2, 'str', path = '[*][1]'}, {2, 'str', path = '[1][*]'}}})
+idx = s:create_index('idx', {parts = {{2, 'str', path = '[*][1]'}, {2, 'str', path = '[*][2]'}}})
+-- An array can't be indexed by both [*] and exact positions.
+s:create_index('idx2', {parts = {{2, 'str', path = '[1][1]'}}})
+
+s:insert{1, {{'James', 'Bond'}, {'Vasya', 'Pupkin'}}}
+s:insert{2, {{'Ivan', 'Ivanych'}}}
+s:insert{3, {{'Vasya', 'Pupkin'}}}
+-- Equal keys of the same tuple are not duplicates.
+s:insert{3, {{'Jimmy', 'Page'}, {'Jimmy', 'Page'}}}
+-- An empty array produces no keys.
+s:insert{4, {}}
+idx:select()
+idx:get({'James', 'Bond'})
+idx:select({'Vasya'})
+idx:select({'J'}, {iterator = 'GE', limit = 2})
+-- Each array element must have all indexed fields.
+s:insert{5, {{'Anna', 'Karenina'}, {'Anna'}}}
+s:insert{5, 'Anna'}
+s:insert{5}
+
+-- Update.
+s:replace{1, {{'Vasya', 'Pupkin'}, {'John', 'Smith'}}}
+idx:select()
+-- Conflicting replace is rolled back.
+s:replace{3, {{'Xavier', 'X'}, {'John', 'Smith'}}}
+s:replace{2, {{'Ivan', 'Ivanych'}, {'Jimmy', 'Page'}, {'Vasya', 'Pupkin'}}}
+idx:select()
+-- Delete.
+s:delete(2)
+idx:select()
+
+-- Build a multikey index on a non-empty space.
+idx2 = s:create_index('idx2', {parts = {{2, 'str', path = '[*][2]'}}, unique = false})
+idx2:select()
+
+-- Check recovery.
+box.snapshot()
+test_run:cmd('restart server default')
+s = box.space.withdata
+s.index.idx:select()
+s.index.idx2:select()
+s:drop()
+
+-- Vinyl doesn't support multikey indexes.
+s = box.schema.space.create('withdata', {engine = 'vinyl'})
+pk = s:create_index('pk')
+s:create_index('idx', {parts = {{2, 'str', path = '[*][1]'}}})
+s:drop()
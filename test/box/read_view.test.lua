@@ -0,0 +1,107 @@
+fiber = require('fiber')
+test_run = require('test_run').new()
+box.schema.func.create('neg', {body = 'function(t) return {100 - t[1]} end', is_deterministic = true})
+s = box.schema.space.create('test')
+_ = s:create_index('pk')
+_ = s:create_index('sk', {parts = {2, 'unsigned'}, unique = false})
+_ = s:create_index('mk', {parts = {{3, 'unsigned', path = '[*]'}}, unique = false})
+_ = s:create_index('fk', {func = 'neg', parts = {{1, 'unsigned'}}})
+_ = s:create_index('hk', {type = 'hash', parts = {1, 'unsigned'}})
+for i = 1, 5 do s:insert{i, i % 3, {i, i + 10}} end
+d = box.schema.space.create('test_drop')
+_ = d:create_index('pk')
+d:insert{1, 'dropped'}
+tmp = box.schema.space.create('test_tmp', {temporary = true})
+_ = tmp:create_index('pk')
+test_run:cmd("setopt delimiter ';'")
+function scan(rv, ...)
+    local result = {}
+    for _, tuple in rv:pairs(...) do
+        table.insert(result, tuple)
+    end
+    return result
+end;
+test_run:cmd("setopt delimiter ''");
+--
+-- A read view isn't affected by changes made after it was
+-- created.
+--
+rv = box.read_view()
+tostring(rv)
+s:delete{1}
+s:replace{2, 0, {20}}
+s:insert{6, 0, {6, 16}}
+did = d.id
+d:drop()
+scan(rv, s)
+scan(rv, did)
+s:select()
+--
+-- Any TREE index can be read with any key and iterator type.
+--
+scan(rv, s, 'sk', 2)
+scan(rv, s, 'sk', 1, 'REQ')
+scan(rv, s, 1, {1}, {iterator = 'GT'})
+scan(rv, s, s.index.pk, 3, 'LE')
+scan(rv, s, 'pk', nil, box.index.LT)
+scan(rv, s, 'mk', 12)
+scan(rv, s, 'mk', 10, 'GT')
+scan(rv, s, 'fk', 97, 'GE')
+-- A space can be read any number of times.
+#scan(rv, 'test')
+#scan(rv, 'test')
+gen1, param1, state1 = rv:pairs(s)
+gen2, param2, state2 = rv:pairs(s, 'pk', nil, 'REQ')
+gen1(param1, state1)
+gen2(param2, state2)
+gen1(param1, 1)
+-- Errors.
+rv:pairs(s, 'hk')
+rv:pairs(s, 'no_such_index')
+rv:pairs(s, 10)
+rv:pairs(s, 'pk', 'x')
+rv:pairs(s, 'pk', {1, 2})
+rv:pairs(s, 'pk', 1, 'BITS_ALL_SET')
+rv:pairs(s, 'pk', 1, 'NO_SUCH_TYPE')
+rv:pairs('no_such_space')
+select(2, pcall(rv.pairs, rv, tmp)).code == box.error.NO_SUCH_SPACE
+rv:close()
+tostring(rv)
+rv:pairs(s)
+gen1(param1, 2)
+rv:close()
+--
+-- The data can be read while other fibers change it.
+--
+rv = box.read_view()
+count = 0
+for _, t in rv:pairs(s) do s:delete{t[1]} fiber.sleep(0) count = count + 1 end
+count
+s:count()
+rv:close()
+--
+-- Tuples returned by a read view aren't copied. A tuple deleted
+-- from the space stays valid after the view is closed.
+--
+s:insert{1, 1, {1}}
+rv = box.read_view()
+gen, param, state = rv:pairs(s)
+s:delete{1}
+_, t = gen(param, state)
+rv:close()
+fiber.sleep(0)
+collectgarbage()
+t
+t = nil
+collectgarbage()
+rv2 = box.read_view()
+scan(rv2, s)
+gen, param, state = rv2:pairs(s, 'sk')
+rv2:close()
+gen(param, state)
+rv = nil
+rv2 = nil
+collectgarbage()
+s:drop()
+tmp:drop()
+box.schema.func.drop('neg')
@@ -0,0 +1,54 @@
+test_run = require('test_run').new()
+net = require('net.box')
+test_run:cmd("create server select_view with script='box/lua/select_view.lua'")
+test_run:cmd("start server select_view")
+test_run:cmd("switch select_view")
+box.cfg.net_read_threads
+box.cfg{net_read_view_period = 0}
+s = box.schema.space.create('test')
+_ = s:create_index('pk')
+_ = s:create_index('sk', {parts = {2, 'string'}, unique = false})
+h = box.schema.space.create('test_hash')
+_ = h:create_index('pk', {type = 'hash'})
+for i = 1, 6 do s:insert{i, 'v' .. i % 2} h:insert{i} end
+box.schema.user.grant('guest', 'read', 'space', 'test')
+box.schema.user.grant('guest', 'read', 'space', 'test_hash')
+z = box.schema.space.create('test_zstd', {compression = 'zstd'})
+_ = z:create_index('pk')
+_ = z:insert{1, string.rep('x', 200)}
+j = box.schema.space.create('test_json')
+_ = j:create_index('pk')
+_ = j:create_index('sk', {parts = {{2, 'string', path = 'a'}}})
+_ = j:insert{1, {a = 'b'}}
+box.schema.user.grant('guest', 'read', 'space', 'test_zstd')
+box.schema.user.grant('guest', 'read', 'space', 'test_json')
+test_run:cmd("switch default")
+c = net.connect(test_run:eval('select_view', 'return box.cfg.listen')[1])
+--
+-- SELECT requests are served by reader threads, which see
+-- changes with a bounded delay.
+--
+test_run:wait_cond(function() return #c.space.test:select() == 6 end)
+c.space.test:select({3}, {iterator = 'GE', limit = 2})
+c.space.test:select({3}, {iterator = 'LT'})
+c.space.test.index.sk:select({'v0'})
+c.space.test.index.sk:select({'v1'}, {iterator = 'REQ', offset = 1})
+--
+-- Requests that can't be served from the read view are
+-- executed by the tx thread.
+--
+c.space.test_hash:select({2})
+c.space.test:select({'a'})
+c.space.test_zstd:get{1}[2] == string.rep('x', 200)
+c.space.test_json.index.sk:select{'b'}
+--
+-- Access rights are checked against the read view too.
+--
+test_run:cmd("switch select_view")
+box.schema.user.revoke('guest', 'read', 'space', 'test')
+test_run:cmd("switch default")
+test_run:wait_cond(function() return not pcall(c.space.test.select, c.space.test) end)
+c.space.test:select()
+c:close()
+test_run:cmd("stop server select_view")
+test_run:cmd("cleanup server select_view")
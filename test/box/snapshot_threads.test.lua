@@ -0,0 +1,45 @@
+fio = require('fio')
+test_run = require('test_run').new()
+--
+-- Parallel snapshot writer (box.cfg.memtx_snap_threads).
+--
+box.cfg{memtx_snap_threads = 0}
+box.cfg{memtx_snap_threads = 65}
+box.cfg.memtx_snap_threads
+-- A snapshot written by several threads is split into
+-- as many files, which are all loaded on recovery.
+box.cfg{memtx_snap_threads = 4}
+s = box.schema.space.create('test')
+_ = s:create_index('pk')
+_ = s:create_index('sk', {parts = {2, 'unsigned'}})
+for i = 1, 10000 do s:insert{i, 10000 - i} end
+box.snapshot()
+snap = fio.pathjoin(box.cfg.memtx_dir, string.format('%020d.snap', box.info.signature))
+fio.path.exists(snap)
+for i = 1, 3 do assert(fio.path.exists(snap .. '.' .. i)) end
+fio.path.exists(snap .. '.4')
+-- Backup includes all chunks.
+n = 0
+for _, f in ipairs(box.backup.start()) do if f:find('%.snap') then n = n + 1 end end
+n
+box.backup.stop()
+test_run:cmd('restart server default')
+fio = require('fio')
+test_run = require('test_run').new()
+s = box.space.test
+s:count()
+s.index.sk:count()
+s:get{5000}
+s.index.sk:get{1}
+box.cfg.memtx_snap_threads
+-- Chunks are removed along with the snapshot.
+snap = fio.pathjoin(box.cfg.memtx_dir, string.format('%020d.snap', box.info.signature))
+fio.path.exists(snap .. '.1')
+checkpoint_count = box.cfg.checkpoint_count
+box.cfg{checkpoint_count = 1}
+s:insert{10001, 10001}
+box.snapshot()
+test_run:wait_cond(function() return #fio.glob(snap .. '*') == 0 end)
+box.cfg{checkpoint_count = checkpoint_count}
+s:drop()
+
@@ -0,0 +1,42 @@
+env = require('test_run')
+test_run = env.new()
+
+--
+-- Tree index comparison hints must preserve the index order.
+-- Values below are listed in ascending order and cover hint
+-- saturation boundaries, integer/double mix, strings sharing
+-- a long prefix and NULLs.
+--
+s = box.schema.space.create('test')
+_ = s:create_index('pk')
+_ = s:create_index('scalar', {parts = {2, 'scalar', is_nullable = true}, unique = false})
+_ = s:create_index('number', {parts = {3, 'number', is_nullable = true}, unique = false})
+values = {box.NULL, false, true, tonumber64('-9223372036854775808'), -576460752303423489LL, -576460752303423488LL, -576460752303423487LL, -1.5, -1, -0.5, 0, 0.5, 1, 576460752303423487ULL, 576460752303423488ULL, 576460752303423489ULL, 18446744073709551615ULL, 1e300, '', 'a', 'abcdefgh', 'abcdefgh1', 'abcdefgh2', 'abcdefgi', '\255\255\255\255\255\255\255\255\255'}
+numbers = {box.NULL, tonumber64('-9223372036854775808'), -576460752303423489LL, -576460752303423488LL, -1.5, -1, -0.5, 0, 0.5, 1, 576460752303423488ULL, 576460752303423489ULL, 1e300}
+for i = #values, 1, -1 do s:insert{i, values[i], numbers[i]} end
+
+function check_order(idx) local i = 0 for _, t in s.index[idx]:pairs() do i = i + 1 if t[1] ~= i then return false end end return true end
+function check_ge(idx, vals) for i = 2, #vals do local t = s.index[idx]:select(vals[i], {iterator = 'GE', limit = 1})[1] if t == nil or t[1] ~= i then return i end end return true end
+function check_lt(idx, vals) for i = 2, #vals do local t = s.index[idx]:select(vals[i], {iterator = 'LT', limit = 1})[1] if t == nil or t[1] ~= i - 1 then return i end end return true end
+
+check_order('scalar')
+check_ge('scalar', values)
+check_lt('scalar', values)
+check_ge('number', numbers)
+
+-- Check the order after the index is rebuilt on recovery.
+box.snapshot()
+test_run:cmd('restart server default')
+s = box.space.test
+function check_order(idx) local i = 0 for _, t in s.index[idx]:pairs() do i = i + 1 if t[1] ~= i then return false end end return true end
+check_order('scalar')
+s.index.scalar:count(576460752303423488ULL, {iterator = 'GE'})
+s.index.scalar:count('abcdefgh', {iterator = 'GT'})
+s.index.number:count(-0.5, {iterator = 'LE'})
+
+-- Hints don't depend on the field type so altering the type
+-- must not break the index.
+s.index.number:alter({parts = {3, 'scalar', is_nullable = true}})
+s.index.number:count(-0.5, {iterator = 'LE'})
+s.index.number:select(576460752303423488ULL, {iterator = 'EQ'})
+s:drop()
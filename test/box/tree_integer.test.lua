@@ -0,0 +1,27 @@
+--
+-- Integer TREE keys are compared by hints and searched with
+-- interpolation. Check values around the range of precise hints.
+--
+s = box.schema.space.create('test')
+_ = s:create_index('pk', {parts = {1, 'integer'}})
+_ = s:create_index('sk', {parts = {2, 'unsigned'}, unique = false})
+vals = {-9223372036854775808LL, -576460752303423489LL, -576460752303423488LL, -576460752303423487LL, -1, 0, 1, 576460752303423486LL, 576460752303423487LL, 576460752303423488LL, 9223372036854775807LL, 18446744073709551615ULL}
+for i = #vals, 1, -1 do s:insert{vals[i], i % 3} end
+s:count()
+ok = true
+for _, v in ipairs(vals) do ok = ok and s:get{v}[1] == v end
+ok
+r = s:select({}, {iterator = 'GE'})
+ok = #r == #vals
+for i = 1, #r do ok = ok and r[i][1] == vals[i] end
+ok
+s:get{576460752303423489LL} == nil
+s:get{-576460752303423490LL} == nil
+s:select({576460752303423487LL}, {iterator = 'GT'})[1][1] == vals[10]
+s:select({-576460752303423488LL}, {iterator = 'LT'})[1][1] == vals[2]
+s.index.sk:count(1)
+s.index.sk:count(2, {iterator = 'LT'})
+for i = 1, #vals, 2 do s:delete{vals[i]} end
+s:count()
+s:get{vals[1]} == nil and s:get{vals[2]} ~= nil
+s:drop()
@@ -0,0 +1,84 @@
+test_run = require('test_run').new()
+msgpack = require('msgpack')
+net = require('net.box')
+ffi = require('ffi')
+--
+-- Compression of big non-indexed fields in memtx spaces.
+--
+box.schema.space.create('test', {compression = 'lz4'})
+box.schema.space.create('test', {engine = 'vinyl', compression = 'zstd'})
+s = box.schema.space.create('test', {compression = 'zstd'})
+_ = s:create_index('pk')
+_ = s:create_index('sk', {parts = {2, 'string'}})
+doc = string.rep('compressible ', 100)
+_ = s:insert{1, 'a', doc}
+_ = s:insert{2, doc:upper(), {doc, doc}}
+s:insert{3, 'c', 'small'}
+-- Big fields are stored compressed, indexed ones are not.
+s:get{1}:bsize() < #doc / 4
+s:get{2}:bsize() > #doc
+s:get{1}[3] == doc
+s:get{2}[3][2] == doc
+s.index.sk:get{doc:upper()}[1]
+s:get{1}:totable()[3] == doc
+msgpack.decode(msgpack.encode(s:get{1}))[3] == doc
+s:select({}, {iterator = 'GE', limit = 1})[1][3] == doc
+-- Tuples are sent to clients decompressed.
+box.schema.user.grant('guest', 'read', 'space', 'test')
+c = net.connect(box.cfg.listen)
+c.space.test:get{1}[3] == doc
+c.space.test:get{2}[3][1] == doc
+c:close()
+box.schema.user.revoke('guest', 'read', 'space', 'test')
+-- Updates keep or recompress big fields.
+s:update(1, {{'=', 2, 'b'}})[3] == doc
+s:update(1, {{'=', 3, 'x'}})
+s:update(1, {{'=', 3, doc}}):bsize() < #doc / 4
+-- Users can't store values of the extension type reserved for
+-- compressed fields, at any nesting level.
+ffi.cdef('int box_replace(uint32_t space_id, const char *tuple, const char *tuple_end, box_tuple_t **result);')
+ffi.cdef('int box_update(uint32_t space_id, uint32_t index_id, const char *key, const char *key_end, const char *ops, const char *ops_end, int index_base, box_tuple_t **result);')
+test_run:cmd("setopt delimiter ';'")
+function raw(data)
+    local p = ffi.cast('const char *', data)
+    return p, p + #data
+end;
+function raw_replace(tuple)
+    local tuple, tuple_end = raw(tuple)
+    if ffi.C.box_replace(s.id, tuple, tuple_end, nil) ~= 0 then
+        box.error()
+    end
+end;
+function raw_update(key, ops)
+    local key, key_end = raw(key)
+    local ops, ops_end = raw(ops)
+    if ffi.C.box_update(s.id, 0, key, key_end, ops, ops_end, 1, nil) ~= 0 then
+        box.error()
+    end
+end;
+test_run:cmd("setopt delimiter ''");
+ext = '\xc9\x00\x00\x00\x02\x64\x01\x02'
+raw_replace('\x93\x05\xa1e' .. ext)
+raw_replace('\x93\x05\xa1e\x91' .. ext)
+raw_replace('\x93\x05\xa1e\x81\xa1k\xd4\x64\x00')
+raw_update('\x91\x01', '\x91\x93\xa1=\x03' .. ext)
+s:get{5}
+s:get{1}[3] == doc
+-- A compressed field can not be indexed.
+s:create_index('doc', {parts = {3, 'string'}, unique = false})
+-- Compression can be changed only when the space is empty.
+box.space._space:update(s.id, {{'=', 6, {compression = 'none'}}})
+-- Compressed fields survive restart.
+box.snapshot()
+_ = s:replace{4, 'd', doc}
+test_run:cmd('restart server default')
+s = box.space.test
+doc = string.rep('compressible ', 100)
+s:count()
+s:get{1}[3] == doc and s:get{4}[3] == doc
+s:get{1}:bsize() < #doc / 4 and s:get{4}:bsize() < #doc / 4
+s:truncate()
+_ = box.space._space:update(s.id, {{'=', 6, {compression = 'none'}}})
+_ = s:insert{1, 'a', doc}
+s:get{1}:bsize() > #doc
+s:drop()
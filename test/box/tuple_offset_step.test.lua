@@ -0,0 +1,45 @@
+test_run = require('test_run').new()
+box.schema.space.create('test', {engine = 'vinyl', field_offset_step = 16})
+s = box.schema.space.create('test', {field_offset_step = 16})
+_ = s:create_index('pk')
+--
+-- Fields of a wide tuple are looked up starting from the
+-- closest stored offset.
+--
+t = {} for i = 1, 150 do t[i] = i * 10 end
+_ = s:insert(t)
+tuple = s:get(10)
+tuple[17]
+tuple[120]
+tuple[150]
+tuple[151]
+ok = true
+for i = 1, 150 do if tuple[i] ~= i * 10 then ok = false end end
+ok
+s:update(10, {{'=', 120, 5}})[120]
+s:update(10, {{'#', 2, 1}})[120]
+--
+-- Indexed fields use their own offsets.
+--
+_ = s:create_index('sk', {parts = {100, 'unsigned'}})
+s.index.sk:get(1010)[1]
+s.index.sk:get(1010)[130]
+s.index.sk:drop()
+--
+-- Tuples shorter than the step have no stored offsets.
+--
+_ = s:insert{1, 2, 3}
+s:get(1)[3]
+s:get(1)[17]
+_ = s:insert{2, {a = {1, 2}}, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18}
+s:get(2)[17]
+s:get(2)['[2].a[2]']
+--
+-- Tuples survive a restart.
+--
+box.snapshot()
+test_run:cmd('restart server default')
+s = box.space.test
+s:get(10)[120]
+s:get(2)[18]
+s:drop()
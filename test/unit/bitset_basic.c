@@ -195,12 +195,57 @@ void test_get_set()
 	footer();
 }
 
+static
+void test_containers()
+{
+	header();
+
+	struct tt_bitset bm;
+	tt_bitset_create(&bm, realloc);
+	struct tt_bitset_info info;
+
+	/* Sparse pages are stored as sorted arrays */
+	const size_t PAGE_BIT = 1280;
+	for (size_t i = 0; i < 10; i++)
+		fail_if(tt_bitset_set(&bm, 7 * PAGE_BIT + 100 - 3 * i) < 0);
+	tt_bitset_info(&bm, &info);
+	fail_unless(info.pages == 1 && info.array_pages == 1);
+	fail_unless(info.total_size < info.page_total_size);
+
+	/* A page with many bits set becomes a dense bitmap */
+	for (size_t i = 0; i < PAGE_BIT; i += 2)
+		fail_if(tt_bitset_set(&bm, 7 * PAGE_BIT + i) < 0);
+	tt_bitset_info(&bm, &info);
+	fail_unless(info.pages == 1 && info.array_pages == 0);
+	for (size_t i = 0; i < PAGE_BIT; i++) {
+		bool expected = i % 2 == 0 ||
+			(i <= 100 && i >= 73 && (100 - i) % 3 == 0);
+		fail_unless(tt_bitset_test(&bm, 7 * PAGE_BIT + i) == expected);
+	}
+
+	/* And goes back to an array when bits are cleared */
+	for (size_t i = 0; i < PAGE_BIT - 20; i++)
+		fail_if(tt_bitset_clear(&bm, 7 * PAGE_BIT + i) < 0);
+	tt_bitset_info(&bm, &info);
+	fail_unless(info.pages == 1 && info.array_pages == 1);
+	fail_unless(tt_bitset_cardinality(&bm) == 10);
+	for (size_t i = PAGE_BIT - 20; i < PAGE_BIT; i++)
+		fail_unless(tt_bitset_test(&bm, 7 * PAGE_BIT + i) ==
+			    (i % 2 == 0));
+	fail_if(tt_bitset_test(&bm, 7 * PAGE_BIT + 100));
+
+	tt_bitset_destroy(&bm);
+
+	footer();
+}
+
 int main(int argc, char *argv[])
 {
 	setbuf(stdout, NULL);
 	srand(time(NULL));
 	test_cardinality();
 	test_get_set();
+	test_containers();
 
 	return 0;
 }
@@ -70,6 +70,46 @@ compare(type_t a, type_t b);
 #define bps_tree_key_t uint32_t
 #define bps_tree_arg_t int
 #include "salad/bps_tree.h"
+#undef BPS_TREE_NAME
+#undef BPS_TREE_BLOCK_SIZE
+#undef BPS_TREE_EXTENT_SIZE
+#undef BPS_TREE_COMPARE
+#undef BPS_TREE_COMPARE_KEY
+#undef bps_tree_elem_t
+#undef bps_tree_key_t
+#undef bps_tree_arg_t
+
+/* tree for delete_identical test: equal elements may differ */
+#define BPS_TREE_NAME ident
+#define BPS_TREE_BLOCK_SIZE 128 /* value is to low specially for tests */
+#define BPS_TREE_EXTENT_SIZE 2048 /* value is to low specially for tests */
+#define BPS_TREE_COMPARE(a, b, arg) (((a) >> 32) < ((b) >> 32) ? -1 : ((a) >> 32) > ((b) >> 32) ? 1 : 0)
+#define BPS_TREE_COMPARE_KEY(a, b, arg) (((a) >> 32) < (b) ? -1 : ((a) >> 32) > (b) ? 1 : 0)
+#define bps_tree_elem_t uint64_t
+#define bps_tree_key_t uint32_t
+#define bps_tree_arg_t int
+#include "salad/bps_tree.h"
+#undef BPS_TREE_NAME
+#undef BPS_TREE_BLOCK_SIZE
+#undef BPS_TREE_EXTENT_SIZE
+#undef BPS_TREE_COMPARE
+#undef BPS_TREE_COMPARE_KEY
+#undef bps_tree_elem_t
+#undef bps_tree_key_t
+#undef bps_tree_arg_t
+
+/* tree for ordinal_search_check: elements have coarse ordinals */
+#define BPS_TREE_NAME ord
+#define BPS_TREE_BLOCK_SIZE 128 /* value is to low specially for tests */
+#define BPS_TREE_EXTENT_SIZE 2048 /* value is to low specially for tests */
+#define BPS_TREE_COMPARE(a, b, arg) ((a) < (b) ? -1 : (a) > (b) ? 1 : 0)
+#define BPS_TREE_COMPARE_KEY(a, b, arg) ((a) < (b) ? -1 : (a) > (b) ? 1 : 0)
+#define BPS_TREE_ELEM_ORD(elem, arg) ((elem) >> 4)
+#define BPS_TREE_KEY_ORD(key, arg) ((key) >> 4)
+#define bps_tree_elem_t uint64_t
+#define bps_tree_key_t uint64_t
+#define bps_tree_arg_t int
+#include "salad/bps_tree.h"
 
 #define bps_insert_and_check(tree_name, tree, elem, replaced) \
 {\
@@ -771,6 +811,126 @@ approximate_count()
 	footer();
 }
 
+static void
+delete_identical_check()
+{
+	header();
+
+	ident tree;
+	ident_create(&tree, 0, extent_alloc, extent_free, &extents_count);
+	const uint64_t count = 10000;
+	for (uint64_t i = 0; i < count; i++)
+		ident_insert(&tree, (i << 32) | 1, NULL);
+	for (uint64_t i = 0; i < count; i++) {
+		if (ident_delete_identical(&tree, (i << 32) | 2) == 0)
+			fail("equal but not identical element deleted", "true");
+	}
+	if (ident_size(&tree) != count)
+		fail("tree size changed", "true");
+	for (uint64_t i = 0; i < count; i++) {
+		if (ident_delete_identical(&tree, (i << 32) | 1) != 0)
+			fail("identical element not deleted", "true");
+	}
+	if (ident_size(&tree) != 0)
+		fail("tree is not empty", "true");
+	ident_destroy(&tree);
+
+	footer();
+}
+
+/** Position of the lowest element of @a arr >= (> if strict) @a key. */
+static uint64_t
+ordinal_search_expected(const uint64_t *arr, uint64_t count, uint64_t key,
+			bool strict)
+{
+	uint64_t begin = 0, end = count;
+	while (begin != end) {
+		uint64_t mid = begin + (end - begin) / 2;
+		if (arr[mid] < key || (strict && arr[mid] == key))
+			begin = mid + 1;
+		else
+			end = mid;
+	}
+	return end;
+}
+
+static void
+ordinal_search_check()
+{
+	header();
+
+	ord tree;
+	ord_create(&tree, 0, extent_alloc, extent_free, &extents_count);
+	/*
+	 * Mix evenly distributed elements, which interpolation
+	 * search likes most, with dense runs of elements sharing
+	 * the same ordinal and sparse quadratically growing ones.
+	 */
+	const uint64_t count = 30000;
+	uint64_t *arr = (uint64_t *)malloc(count * sizeof(*arr));
+	for (uint64_t i = 0; i < count; i++) {
+		if (i < 10000)
+			arr[i] = i * 100;
+		else if (i < 20000)
+			arr[i] = 1000000 + (i - 10000);
+		else
+			arr[i] = 2000000 + (i - 20000) * (i - 20000) * 1000;
+	}
+	for (uint64_t i = 0; i < count; i++) {
+		uint64_t j = rand() % count;
+		uint64_t tmp = arr[i];
+		arr[i] = arr[j];
+		arr[j] = tmp;
+	}
+	for (uint64_t i = 0; i < count; i++)
+		ord_insert(&tree, arr[i], NULL);
+	if (ord_debug_check(&tree))
+		fail("debug check nonzero", "true");
+	qsort_arg(arr, count, sizeof(*arr), node_comp, NULL);
+
+	for (uint64_t i = 0; i < count; i++) {
+		for (int d = -1; d <= 1; d++) {
+			uint64_t key = arr[i] + d;
+			bool exact;
+			ord_iterator it = ord_lower_bound(&tree, key, &exact);
+			uint64_t *elem = ord_iterator_get_elem(&tree, &it);
+			uint64_t pos = ordinal_search_expected(arr, count,
+							       key, false);
+			bool expected_exact = pos < count && arr[pos] == key;
+			if ((pos == count) != (elem == NULL) ||
+			    (elem != NULL && *elem != arr[pos]) ||
+			    exact != expected_exact)
+				fail("wrong lower bound", "true");
+			it = ord_upper_bound(&tree, key, &exact);
+			elem = ord_iterator_get_elem(&tree, &it);
+			pos = ordinal_search_expected(arr, count, key, true);
+			if ((pos == count) != (elem == NULL) ||
+			    (elem != NULL && *elem != arr[pos]) ||
+			    exact != expected_exact)
+				fail("wrong upper bound", "true");
+		}
+	}
+
+	for (uint64_t i = 0; i < count; i += 2) {
+		if (ord_delete(&tree, arr[i]) != 0)
+			fail("element not deleted", "true");
+	}
+	if (ord_size(&tree) != count / 2)
+		fail("wrong tree size", "true");
+	if (ord_debug_check(&tree))
+		fail("debug check nonzero", "true");
+	for (uint64_t i = 0; i < count; i++) {
+		bool found = ord_find(&tree, arr[i]) != NULL;
+		if (found != (i % 2 == 1))
+			fail("wrong find result", "true");
+	}
+
+	ord_destroy(&tree);
+	free(arr);
+
+	footer();
+}
+
 static void
 insert_get_iterator()
 {
@@ -803,6 +963,8 @@ main(void)
 	printing_test();
 	white_box_test();
 	approximate_count();
+	delete_identical_check();
+	ordinal_search_check();
 	if (extents_count != 0)
 		fail("memory leak!", "true");
 	insert_get_iterator();
@@ -479,7 +479,7 @@ test_path_cmp()
 		{"Data[1][\"Info\"].fname[1]", -1},
 	};
 	header();
-	plan(lengthof(rc) + 3);
+	plan(lengthof(rc) + 6);
 	for (size_t i = 0; i < lengthof(rc); ++i) {
 		const char *path = rc[i].path;
 		int errpos = rc[i].errpos;
@@ -503,6 +503,18 @@ test_path_cmp()
 	ret = json_path_validate(invalid, strlen(invalid), INDEX_BASE);
 	is(ret, 6, "path %s error pos %d expected %d", invalid, ret, 6);
 
+	ret = json_path_multikey_offset(a, a_len, INDEX_BASE);
+	is(ret, (int)a_len, "path %s multikey offset %d expected %d", a, ret,
+	   (int)a_len);
+	ret = json_path_multikey_offset(multikey_a, strlen(multikey_a),
+					INDEX_BASE);
+	is(ret, 4, "path %s multikey offset %d expected %d", multikey_a,
+	   ret, 4);
+	ret = json_path_multikey_offset(multikey_b, strlen(multikey_b),
+					INDEX_BASE);
+	is(ret, 8, "path %s multikey offset %d expected %d", multikey_b,
+	   ret, 8);
+
 	check_plan();
 	footer();
 }
@@ -0,0 +1,114 @@
+#include "mp_scan.h"
+#include "unit.h"
+#include "msgpuck.h"
+#include "trivia/util.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+enum {
+	/** Number of top-level values in a test sequence. */
+	VALUE_COUNT = 1000,
+	/** Max nesting of generated arrays and maps. */
+	MAX_DEPTH = 3,
+};
+
+static char buf[1024 * 1024];
+static uint32_t offsets[VALUE_COUNT];
+static uint32_t expected[VALUE_COUNT];
+
+/**
+ * Encode a random value. Most of them are one-byte values to
+ * let the scanner take long strides, the rest are integers,
+ * strings and nested containers that break the runs.
+ */
+static char *
+gen_value(char *pos, int depth)
+{
+	int r = rand() % 100;
+	if (r < 50)
+		return mp_encode_uint(pos, rand() % 128);
+	if (r < 60)
+		return mp_encode_int(pos, -1 - rand() % 32);
+	if (r < 65)
+		return rand() % 3 == 0 ? mp_encode_nil(pos) :
+		       mp_encode_bool(pos, rand() % 2);
+	if (r < 75)
+		return mp_encode_uint(pos, rand());
+	if (r < 80)
+		return mp_encode_int(pos, -1 - rand());
+	if (r < 88) {
+		char str[40];
+		uint32_t len = rand() % sizeof(str);
+		memset(str, 'x', len);
+		return mp_encode_str(pos, str, len);
+	}
+	if (depth >= MAX_DEPTH || r < 90)
+		return mp_encode_double(pos, rand() / 3.0);
+	uint32_t size = rand() % 40;
+	if (r < 96) {
+		pos = mp_encode_array(pos, size);
+	} else {
+		size = size / 4;
+		pos = mp_encode_map(pos, size);
+		size *= 2;
+	}
+	for (uint32_t i = 0; i < size; i++)
+		pos = gen_value(pos, depth + 1);
+	return pos;
+}
+
+static void
+test_scan(const char *name)
+{
+	srand(1);
+	char *end = buf;
+	for (int i = 0; i < VALUE_COUNT; i++)
+		end = gen_value(end, 0);
+	fail_unless(end < buf + sizeof(buf));
+
+	const char *pos = buf;
+	for (int i = 0; i < VALUE_COUNT; i++) {
+		expected[i] = pos - buf;
+		mp_next(&pos);
+	}
+
+	bool is_ok = true;
+	for (uint32_t i = 0; i < VALUE_COUNT; i += 7) {
+		pos = buf;
+		mp_scan_skip(&pos, i);
+		is_ok = is_ok && pos == buf + expected[i];
+	}
+	pos = buf;
+	mp_scan_skip(&pos, VALUE_COUNT);
+	ok(is_ok && pos == end, "%s: skip", name);
+
+	pos = mp_scan_offsets(buf, VALUE_COUNT, buf, offsets);
+	ok(pos == end && memcmp(offsets, expected, sizeof(offsets)) == 0,
+	   "%s: offsets", name);
+
+	pos = buf;
+	ok(mp_scan_check(&pos, end, VALUE_COUNT) == 0 && pos == end,
+	   "%s: check", name);
+
+	is_ok = true;
+	for (const char *cut = buf; cut < end; cut += 97) {
+		pos = buf;
+		is_ok = is_ok && mp_scan_check(&pos, cut, VALUE_COUNT) != 0;
+	}
+	ok(is_ok, "%s: check truncated", name);
+}
+
+int
+main()
+{
+	header();
+	plan(8);
+
+	test_scan("portable");
+	mp_scan_init();
+	test_scan("native");
+
+	footer();
+	return check_plan();
+}
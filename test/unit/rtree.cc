@@ -277,11 +277,77 @@ neighbor_test()
 }
 
 
+static void
+bulk_load_check()
+{
+	header();
+
+	const size_t counts[] = {0, 1, 5, 26, 100, 1234, 5000};
+	for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); c++) {
+		const size_t count = counts[c];
+		struct rtree tree;
+		rtree_init(&tree, 2, extent_size,
+			   extent_alloc, extent_free, &page_count,
+			   RTREE_EUCLID);
+		struct rtree_rect rect;
+		if (rtree_build_reserve(&tree, count / 2) != 0)
+			fail("reserve", "true");
+		for (size_t i = 1; i <= count; i++) {
+			/* Shuffle the records along the diagonal */
+			size_t k = (i * 7919) % count + 1;
+			rtree_set2d(&rect, k, k, k + 0.5, k + 0.5);
+			if (rtree_build_next(&tree, &rect, (record_t)k) != 0)
+				fail("build next", "true");
+		}
+		/* All pages are reserved by rtree_build_next() */
+		int extent_count = page_count;
+		rtree_build_end(&tree);
+		if (page_count != extent_count)
+			fail("build end allocates no extents", "true");
+		if (rtree_number_of_records(&tree) != count)
+			fail("Tree count mismatch", "true");
+
+		struct rtree_iterator iterator;
+		rtree_iterator_init(&iterator);
+		for (size_t i = 1; i <= count; i++) {
+			rtree_set2d(&rect, i, i, i + 0.5, i + 0.5);
+			if (!rtree_search(&tree, &rect, SOP_EQUALS, &iterator))
+				fail("element in tree", "false");
+			if (rtree_iterator_next(&iterator) != (record_t)i)
+				fail("right search result", "true");
+			if (rtree_iterator_next(&iterator) != NULL)
+				fail("single search result", "true");
+		}
+
+		rtree_set2dp(&rect, 0, 0);
+		rtree_search(&tree, &rect, SOP_NEIGHBOR, &iterator);
+		for (size_t i = 1; i <= count; i++) {
+			if (rtree_iterator_next(&iterator) != (record_t)i)
+				fail("neighbor search result", "true");
+		}
+		if (rtree_iterator_next(&iterator) != NULL)
+			fail("neighbor search end", "true");
+
+		for (size_t i = 1; i <= count; i++) {
+			rtree_set2d(&rect, i, i, i + 0.5, i + 0.5);
+			if (!rtree_remove(&tree, &rect, (record_t)i))
+				fail("delete element in tree", "false");
+		}
+		if (rtree_number_of_records(&tree) != 0)
+			fail("Tree count mismatch", "true");
+		rtree_iterator_destroy(&iterator);
+		rtree_destroy(&tree);
+	}
+
+	footer();
+}
+
 int
 main(void)
 {
 	simple_check();
 	neighbor_test();
+	bulk_load_check();
 	if (page_count != 0) {
 		fail("memory leak!", "true");
 	}
@@ -151,3 +151,46 @@ s:get(-1LL)
 s:get(9007199254740992LL)
 s:get(-9007199254740994LL)
 s:drop()
+
+--
+-- Bloom filters of big runs are split in partitions, each of which
+-- covers a range of pages. After restart, partitions are loaded on
+-- the first lookup in the page range they cover.
+--
+vinyl_cache = box.cfg.vinyl_cache
+box.cfg{vinyl_cache = 0}
+s = box.schema.space.create('test', {engine = 'vinyl'})
+_ = s:create_index('pk', {page_size = 128})
+pad = string.rep('x', 100)
+for i = 1, 2000 do s:replace{i * 2, pad} end
+box.snapshot()
+s.index.pk:stat().disk.pages > 1000
+s.index.pk:stat().disk.bloom_size > 0
+reflects = 0
+function cur_reflects() return box.space.test.index.pk:stat().disk.iterator.bloom.hit end
+function new_reflects() local o = reflects reflects = cur_reflects() return reflects - o end
+_ = new_reflects()
+found = 0
+for i = 1, 2000 do if s:get{i * 2} ~= nil then found = found + 1 end end
+found
+new_reflects() == 0
+for i = 1, 2000 do if s:get{i * 2 + 1} ~= nil then found = found + 1 end end
+found
+new_reflects() > 1900
+test_run:cmd('restart server default')
+vinyl_cache = box.cfg.vinyl_cache
+box.cfg{vinyl_cache = 0}
+s = box.space.test
+reflects = 0
+function cur_reflects() return box.space.test.index.pk:stat().disk.iterator.bloom.hit end
+function new_reflects() local o = reflects reflects = cur_reflects() return reflects - o end
+_ = new_reflects()
+found = 0
+for i = 1, 2000 do if s:get{i * 2} ~= nil then found = found + 1 end end
+found
+new_reflects() == 0
+for i = 1, 2000 do if s:get{i * 2 + 1} ~= nil then found = found + 1 end end
+found
+new_reflects() > 1900
+s:drop()
+box.cfg{vinyl_cache = vinyl_cache}
@@ -0,0 +1,91 @@
+test_run = require('test_run').new()
+fiber = require('fiber')
+
+--
+-- DELETE_RANGE deletes all keys k such that begin <= k < end
+-- with a single statement stored in the primary index.
+--
+s = box.schema.space.create('test', {engine = 'vinyl'})
+pk = s:create_index('pk')
+for i = 1, 10 do s:replace{i} end
+s:delete_range({3}, {7})
+s:select()
+s:get{3}
+s:get{6}
+s:get{7}
+pk:select({5}, {iterator = 'le'})
+s:delete_range({}, {2})
+s:select()
+-- Empty ranges are ignored.
+s:delete_range({8}, {8})
+s:delete_range({9}, {8})
+s:select()
+
+-- Statements inserted after DELETE_RANGE are visible.
+box.begin() s:replace{4} s:delete_range({4}, {8}) s:replace{5} box.commit()
+s:select()
+box.begin() s:delete_range({5}, {9}) s:replace{6} box.rollback()
+s:select()
+
+-- A transaction that read a deleted key is aborted.
+c = fiber.channel(1)
+box.begin() s:get{9} s:replace{11}
+_ = fiber.create(function() s:delete_range({9}, {}) c:put(true) end)
+c:get()
+box.commit()
+s:select()
+
+-- Range deletions are dumped and compacted.
+box.snapshot()
+s:select()
+s:replace{1} s:replace{3} s:replace{9}
+s:delete_range({2}, {6})
+box.snapshot()
+s:select()
+pk:compact()
+while pk:stat().disk.compaction.count == 0 do fiber.sleep(0.001) end
+s:select()
+-- Covered keys and range deletions are purged by major compaction.
+pk:stat().disk.rows
+
+-- Range deletions are persistent.
+s:delete_range({9}, {10})
+box.snapshot()
+s:delete_range({}, {})
+test_run:cmd('restart server default')
+s = box.space.test
+s:select()
+s:drop()
+
+--
+-- Keys are deleted one by one if the space has secondary indexes.
+-- This costs as much as deleting them with separate requests:
+-- every key in the range is read and a DELETE is written to
+-- each index for it.
+--
+s = box.schema.space.create('test', {engine = 'vinyl'})
+_ = s:create_index('pk')
+_ = s:create_index('sk', {parts = {2, 'unsigned'}})
+for i = 1, 5 do s:replace{i, 10 - i} end
+rows = s.index.sk:stat().memory.rows
+s:delete_range({2}, {4})
+s.index.sk:stat().memory.rows - rows
+s.index.sk:select()
+s.index.sk:delete_range({6}, {9})
+-- Spaces with triggers are not supported.
+f = function() end
+_ = s:on_replace(f)
+s:delete_range({1}, {2})
+s:on_replace(nil, f)
+_ = s:before_replace(f)
+s:delete_range({1}, {2})
+s:before_replace(nil, f)
+s:delete_range({1}, {2})
+s:select()
+s:drop()
+
+-- Not supported by memtx.
+s = box.schema.space.create('test', {engine = 'memtx'})
+_ = s:create_index('pk')
+s:delete_range({1}, {2})
+s:drop()
@@ -0,0 +1,72 @@
+test_run = require('test_run').new()
+net_box = require('net.box')
+--
+-- index:get_many() looks up several keys at once.
+--
+test_run:cmd("setopt delimiter ';'")
+function get_many(index, keys)
+    local r = index:get_many(keys)
+    local t = {}
+    for i = 1, #keys do
+        t[i] = r[i] or box.NULL
+    end
+    return t
+end;
+test_run:cmd("setopt delimiter ''");
+s = box.schema.space.create('test', {engine = 'vinyl'})
+pk = s:create_index('pk')
+sk = s:create_index('sk', {parts = {2, 'string'}})
+for i = 1, 100 do s:replace{i, 'v' .. i} end
+box.snapshot()
+for i = 1, 100, 2 do s:replace{i, 'w' .. i} end
+get_many(s, {5, 2, 200, 5, 1})
+get_many(sk, {'v2', 'v1', 'w1'})
+s:get_many({})
+keys = {}
+for i = 100, 1, -1 do table.insert(keys, i) end
+r = s:get_many(keys)
+ok = true
+for i, k in ipairs(keys) do if r[i] == nil or r[i][1] ~= k then ok = false end end
+ok
+-- Transaction changes are visible.
+box.begin() s:replace{200, 'x'} s:delete{2} r = get_many(s, {200, 2}) box.rollback()
+r
+-- Errors.
+s:get_many(1)
+s:get_many({{}})
+s:get_many({{1, 2}})
+sk:get_many({1})
+-- Remote lookups.
+box.schema.user.grant('guest', 'read', 'space', 'test')
+c = net_box.connect(box.cfg.listen)
+get_many(c.space.test, {1, 200, 2})
+get_many(c.space.test.index.sk, {'v4', 'w3'})
+c:close()
+box.schema.user.revoke('guest', 'read', 'space', 'test')
+s:drop()
+-- Keys stored on disk are looked up in a batch: bloom filters are
+-- checked for all keys before reading pages and each page is read
+-- only once.
+s = box.schema.space.create('test', {engine = 'vinyl'})
+pk = s:create_index('pk', {page_size = 1024})
+pad = string.rep('x', 100)
+for i = 1, 200, 2 do s:replace{i, pad} end
+box.snapshot()
+pk:stat().disk.pages > 1
+st1 = pk:stat().disk.iterator
+keys = {}
+for i = 1, 200 do table.insert(keys, i) end
+r = s:get_many(keys)
+found = 0
+for i = 1, 200 do if r[i] ~= nil then found = found + 1 end end
+found
+st2 = pk:stat().disk.iterator
+st2.read.pages - st1.read.pages == pk:stat().disk.pages
+(st2.bloom.hit + st2.bloom.miss) - (st1.bloom.hit + st1.bloom.miss)
+s:drop()
+-- Other engines fall back on one lookup per key.
+s = box.schema.space.create('test', {engine = 'memtx'})
+_ = s:create_index('pk')
+for i = 1, 10 do s:replace{i} end
+get_many(s, {3, 30, 1})
+s:drop()
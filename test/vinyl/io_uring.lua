@@ -0,0 +1,10 @@
+#!/usr/bin/env tarantool
+
+box.cfg{
+    vinyl_io_uring = true,
+    vinyl_io_uring_direct = arg[1] == 'direct',
+    vinyl_read_threads = 2,
+    vinyl_cache = 0,
+}
+
+require('console').listen(os.getenv('ADMIN'))
@@ -0,0 +1,74 @@
+test_run = require('test_run').new()
+--
+-- Reading runs with io_uring. If io_uring isn't supported,
+-- vinyl falls back on blocking reads, so the test must pass
+-- anyway.
+--
+test_run:cmd("create server test with script='vinyl/io_uring.lua'")
+test_run:cmd("start server test with args='buffered'")
+test_run:cmd('switch test')
+box.cfg.vinyl_io_uring
+box.cfg.vinyl_io_uring_direct
+fiber = require('fiber')
+s = box.schema.space.create('test', {engine = 'vinyl'})
+_ = s:create_index('pk', {page_size = 1024})
+for i = 1, 1000 do s:replace{i, string.rep('x', i % 100)} end
+box.snapshot()
+-- Read pages from many fibers concurrently.
+test_run:cmd("setopt delimiter ';'")
+ok = true
+ch = fiber.channel(10)
+for f = 1, 10 do
+    fiber.create(function()
+        for i = f, 1000, 10 do
+            local t = s:get(i)
+            if t == nil or t[2] ~= string.rep('x', i % 100) then
+                ok = false
+            end
+        end
+        ch:put(true)
+    end)
+end;
+for f = 1, 10 do ch:get() end;
+test_run:cmd("setopt delimiter ''");
+ok
+s.index.pk:stat().disk.iterator.read.pages > 0
+s:select({}, {limit = 3})
+s:count()
+s:drop()
+test_run:cmd('switch default')
+test_run:cmd('stop server test')
+test_run:cmd("start server test with args='direct'")
+test_run:cmd('switch test')
+box.cfg.vinyl_io_uring
+box.cfg.vinyl_io_uring_direct
+fiber = require('fiber')
+s = box.schema.space.create('test', {engine = 'vinyl'})
+_ = s:create_index('pk', {page_size = 1024})
+for i = 1, 1000 do s:replace{i, string.rep('x', i % 100)} end
+box.snapshot()
+-- Read pages from many fibers concurrently.
+test_run:cmd("setopt delimiter ';'")
+ok = true
+ch = fiber.channel(10)
+for f = 1, 10 do
+    fiber.create(function()
+        for i = f, 1000, 10 do
+            local t = s:get(i)
+            if t == nil or t[2] ~= string.rep('x', i % 100) then
+                ok = false
+            end
+        end
+        ch:put(true)
+    end)
+end;
+for f = 1, 10 do ch:get() end;
+test_run:cmd("setopt delimiter ''");
+ok
+s.index.pk:stat().disk.iterator.read.pages > 0
+s:select({}, {limit = 3})
+s:count()
+s:drop()
+test_run:cmd('switch default')
+test_run:cmd('stop server test')
+test_run:cmd('cleanup server test')
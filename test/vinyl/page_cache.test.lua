@@ -0,0 +1,30 @@
+test_run = require('test_run').new()
+--
+-- Pages read from disk are stored in the page cache shared
+-- by all run iterators.
+--
+vinyl_cache = box.cfg.vinyl_cache
+-- Disable the tuple cache so that lookups go to disk.
+box.cfg{vinyl_cache = 0, vinyl_page_cache = 1024 * 1024}
+s = box.schema.space.create('test', {engine = 'vinyl'})
+_ = s:create_index('pk', {page_size = 1024})
+for i = 1, 100 do s:replace{i, string.rep('x', 100)} end
+box.snapshot()
+st = box.stat.vinyl().page_cache
+s:get(50)[1]
+box.stat.vinyl().page_cache.miss - st.miss > 0
+box.stat.vinyl().page_cache.used > 0
+st = box.stat.vinyl().page_cache
+pages = s.index.pk:stat().disk.iterator.read.pages
+s:get(50)[1]
+box.stat.vinyl().page_cache.hit - st.hit > 0
+box.stat.vinyl().page_cache.miss - st.miss
+s.index.pk:stat().disk.iterator.read.pages - pages
+-- Shrinking the cache evicts pages.
+box.cfg{vinyl_page_cache = 0}
+box.stat.vinyl().page_cache.used
+pages = s.index.pk:stat().disk.iterator.read.pages
+s:get(50)[1]
+s.index.pk:stat().disk.iterator.read.pages - pages > 0
+s:drop()
+box.cfg{vinyl_cache = vinyl_cache}
@@ -112,6 +112,15 @@ box.snapshot()
 for _, f in pairs(fio.glob(box.cfg.vinyl_dir .. '/' .. test2.id .. '/0/*.index')) do fio.unlink(f) end
 for _, f in pairs(fio.glob(box.cfg.vinyl_dir .. '/' .. test2.id .. '/1/*.index')) do fio.unlink(f) end
 
+-- Range deletions are restored on index rebuild.
+test3 = box.schema.space.create('test3', {engine = 'vinyl'})
+_ = test3:create_index('pk')
+for i = 1, 6 do test3:replace{i} end
+box.snapshot()
+test3:delete_range({2}, {5})
+box.snapshot()
+for _, f in pairs(fio.glob(box.cfg.vinyl_dir .. '/' .. test3.id .. '/0/*.index')) do fio.unlink(f) end
+
 test_run = require('test_run').new()
 test_run:cmd('switch default')
 test_run:cmd('stop server force_recovery')
@@ -136,6 +145,7 @@ new_info.range_count == old_info.range_count
 
 box.space.test2:select()
 box.space.test2.index.sec:select()
+box.space.test3:select()
 test_run:cmd('switch default')
 test_run:cmd('stop server force_recovery')
 test_run:cmd('delete server force_recovery')